@@ -109,6 +109,30 @@ struct ExternalVariable
     choc::value::Value annotation;
 };
 
+//==============================================================================
+/** Describes an external function whose implementation a host must supply
+    before a program can be linked.
+
+    A program declares one of these with e.g. 'external float process (float[] data);'
+    and the host binds a native implementation through
+    Performer::setExternalFunction(). The signatures are restricted by the
+    compiler to primitives, vectors of primitives, and arrays of those, so the
+    call can cross the boundary as a plain C-style call with no marshalling.
+*/
+struct ExternalFunction
+{
+    /** The fully-qualified name of the function. */
+    std::string name;
+
+    /** The return type: void, a primitive, or a vector of primitives. */
+    choc::value::Type returnType;
+
+    /** The parameter types, each a primitive, a vector, or an array of those. */
+    std::vector<choc::value::Type> parameterTypes;
+
+    choc::value::Value annotation;
+};
+
 
 //==============================================================================
 /** This holds a short MIDI message and a frame-based timestamp, and is used in
@@ -134,6 +158,156 @@ struct MIDIEvent
     }
 };
 
+//==============================================================================
+/** Holds a single 64-bit MIDI 2.0 channel-voice packet in Universal MIDI Packet
+    (UMP) form, with a frame-based timestamp.
+
+    This is the high-resolution counterpart of MIDIEvent: a UMP-capable host can
+    pass its packets through unmodified, and MIDI 1.0 messages can be up-converted
+    with fromMIDI1(), which applies the standard bit-scaling rules so the values
+    span the full width of the wider fields. toMIDI1() converts the other way for
+    delivering to byte-oriented destinations, which necessarily discards the extra
+    resolution.
+*/
+struct UMPEvent
+{
+    uint32_t frameIndex = 0;
+
+    /** words[0] holds the message type, group, status, channel and index bytes;
+        words[1] is the 32-bit data word.
+    */
+    uint32_t words[2] = {};
+
+    //==============================================================================
+    /** The standard MIDI 1.0 -> 2.0 up-scalings, which replicate the source bit
+        pattern downwards so that the minimum and maximum map exactly.
+    */
+    static constexpr uint32_t scale7To16 (uint32_t v)     { return (v << 9) | (v << 2) | (v >> 5); }
+    static constexpr uint32_t scale7To32 (uint32_t v)     { return (v << 25) | (v << 18) | (v << 11) | (v << 4) | (v >> 3); }
+    static constexpr uint32_t scale14To32 (uint32_t v)    { return (v << 18) | (v << 4) | (v >> 10); }
+
+    static constexpr uint32_t scale16To7 (uint32_t v)     { return v >> 9; }
+    static constexpr uint32_t scale32To7 (uint32_t v)     { return v >> 25; }
+    static constexpr uint32_t scale32To14 (uint32_t v)    { return v >> 18; }
+
+    //==============================================================================
+    static UMPEvent fromMIDI1 (const MIDIEvent& e)
+    {
+        UMPEvent result;
+        result.frameIndex = e.frameIndex;
+
+        auto status = (uint32_t) e.message.data[0];
+        auto data1  = (uint32_t) e.message.data[1];
+        auto data2  = (uint32_t) e.message.data[2];
+
+        // MIDI 2.0 treats a zero-velocity note-on as a real note-on, so the
+        // 1.0 convention has to become an actual note-off during conversion
+        if ((status & 0xf0) == 0x90 && data2 == 0)
+            status &= 0xefu;
+
+        result.words[0] = (0x4u << 28) | (status << 16);
+
+        switch (status >> 4)
+        {
+            case 0x8:
+            case 0x9:   result.words[0] |= data1 << 8;
+                        result.words[1] = scale7To16 (data2) << 16;    break;
+
+            case 0xa:
+            case 0xb:   result.words[0] |= data1 << 8;
+                        result.words[1] = scale7To32 (data2);          break;
+
+            case 0xc:   result.words[1] = data1 << 24;                 break;
+            case 0xd:   result.words[1] = scale7To32 (data1);          break;
+            case 0xe:   result.words[1] = scale14To32 ((data2 << 7) | data1); break;
+
+            default:    break;
+        }
+
+        return result;
+    }
+
+    MIDIEvent toMIDI1() const
+    {
+        auto status = (uint8_t) ((words[0] >> 16) & 0xff);
+        auto index1 = (uint8_t) ((words[0] >> 8) & 0x7f);
+        uint8_t data1 = 0, data2 = 0;
+
+        switch (status >> 4)
+        {
+            case 0x8:
+            case 0x9:   data1 = index1;
+                        data2 = (uint8_t) scale16To7 (words[1] >> 16); break;
+
+            case 0xa:
+            case 0xb:   data1 = index1;
+                        data2 = (uint8_t) scale32To7 (words[1]);       break;
+
+            case 0xc:   data1 = (uint8_t) ((words[1] >> 24) & 0x7f);   break;
+            case 0xd:   data1 = (uint8_t) scale32To7 (words[1]);       break;
+
+            case 0xe:
+            {
+                auto bend = scale32To14 (words[1]);
+                data1 = (uint8_t) (bend & 0x7f);
+                data2 = (uint8_t) ((bend >> 7) & 0x7f);
+                break;
+            }
+
+            default:    break;
+        }
+
+        return { frameIndex, { status, data1, data2 } };
+    }
+};
+
+//==============================================================================
+/** A time-stamped update to the host's timeline, used where buffers of batched
+    timeline changes are passed into a rendering call.
+
+    A host sends one of these only when something on its timeline actually
+    changes, with a frame timestamp saying where in the block it takes effect,
+    instead of re-sending the tempo and position every block. A tempo ramp is
+    declared once, with its end-point and length, and the receiving program
+    interpolates for itself - so a static timeline costs nothing per block.
+
+    The struct is deliberately flat rather than a union of per-type layouts, so
+    that arrays of these can cross an ABI boundary as plain data. Each event
+    type only reads the fields its Type documentation lists; the rest are
+    ignored. The field meanings match the structs in the soul::timeline library
+    namespace, which is how programs declare the endpoints that receive them.
+*/
+struct TimelineEvent
+{
+    enum class Type  : uint32_t
+    {
+        transportState = 0,  /**< Uses the transportState field. */
+        timeSignature  = 1,  /**< Uses timeSigNumerator and timeSigDenominator. */
+        tempo          = 2,  /**< Uses startBPM; the other tempo fields are ignored. */
+        tempoRamp      = 3,  /**< Uses startBPM, endBPM and rampLengthFrames. */
+        position       = 4   /**< Uses currentFrame, currentQuarterNote and lastBarStartQuarterNote. */
+    };
+
+    /** A sample offset into the current block at which this event takes effect. */
+    uint32_t frameIndex = 0;
+
+    Type type = Type::transportState;
+
+    int32_t transportState = 0;     /**< 0 = stopped, 1 = playing, 2 = recording. */
+    int32_t timeSigNumerator = 4;
+    int32_t timeSigDenominator = 4;
+
+    float startBPM = 120.0f;
+    float endBPM = 120.0f;
+    uint32_t reserved = 0;          /**< Makes the padding before the 64-bit fields explicit. */
+
+    int64_t rampLengthFrames = 0;
+
+    int64_t currentFrame = 0;
+    double currentQuarterNote = 0;
+    double lastBarStartQuarterNote = 0;
+};
+
 //==============================================================================
 /**
     A collection of properties needed by the compiler, linker and loaders when
@@ -149,6 +323,23 @@ struct BuildSettings
     int32_t      sessionID          = 0;
     std::string  mainProcessor;
 
+    /** The number of whole blocks of extra latency that an engine may spend on
+        pipelining the graph across multiple threads for throughput. Zero (the
+        default) keeps single-block latency and disables pipelining.
+    */
+    uint32_t     pipelineLatencyBlocks = 0;
+
+    /** The maximum number of SIMD instruction-set variants a JIT engine may
+        generate for the program's hot kernels. One (the default) targets only
+        the architecture's baseline, so a single binary serving mixed machines
+        runs lowest-common-denominator code; higher values let the engine also
+        emit wider variants (AVX2, AVX-512...) and install the best one the
+        running CPU supports as a one-time dispatch at link time, at the cost
+        of extra code size and link time. Engines that don't multi-version
+        their code ignore this.
+    */
+    uint32_t     maxCodeGenISAVariants = 1;
+
     choc::value::Value customSettings;
 };
 
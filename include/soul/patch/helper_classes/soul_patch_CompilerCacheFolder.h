@@ -45,7 +45,14 @@ struct CompilerCacheFolder final  : public CompilerCache
     {
         juce::ScopedLock sl (lock);
         auto file = getFileForKey (key);
-        file.replaceWithData (sourceData, (size_t) size);
+
+        // written via a temporary which is atomically moved into place, so another
+        // process sharing this folder can never read a half-written entry
+        juce::TemporaryFile temp (file);
+
+        if (temp.getFile().replaceWithData (sourceData, (size_t) size))
+            temp.overwriteTargetFileWithTemporary();
+
         purgeOldestFiles (maxNumFiles);
     }
 
@@ -23,6 +23,69 @@ namespace soul
 namespace patch
 {
 
+//==============================================================================
+/**
+    A process-wide registry of PatchInstance objects, keyed by the URL they were
+    loaded from.
+
+    A DAW session can easily hold a dozen instances of the same .soulpatch, and
+    creating a separate PatchInstance for each means compiling the same program
+    a dozen times. Instances found here are shared instead, so later plugins
+    ride on the first one's compiled program, its cached builds and its pool of
+    linked performers, while every plugin still gets its own player and state.
+
+    The URL is the only identity available before an instance exists; content
+    changes behind an URL are handled by the instance itself, which watches its
+    files and rebuilds, so a shared instance stays as fresh as a private one.
+    The registry holds strong references, capped by dropping the oldest entries.
+*/
+struct PatchInstanceRegistry
+{
+    template <typename CreateInstanceFn>
+    static PatchInstance::Ptr getOrCreate (const std::string& url, CreateInstanceFn&& createInstance)
+    {
+        if (url.empty())
+            return createInstance();
+
+        auto& registry = getInstance();
+        std::lock_guard<std::mutex> l (registry.lock);
+
+        for (auto& entry : registry.entries)
+            if (entry.url == url)
+                return entry.instance;
+
+        auto created = createInstance();
+
+        if (created != nullptr)
+        {
+            if (registry.entries.size() >= maxEntries)
+                registry.entries.erase (registry.entries.begin());
+
+            registry.entries.push_back ({ url, created });
+        }
+
+        return created;
+    }
+
+private:
+    static constexpr size_t maxEntries = 16;
+
+    struct Entry
+    {
+        std::string url;
+        PatchInstance::Ptr instance;
+    };
+
+    std::mutex lock;
+    std::vector<Entry> entries;
+
+    static PatchInstanceRegistry& getInstance()
+    {
+        static PatchInstanceRegistry registry;
+        return registry;
+    }
+};
+
 //==============================================================================
 /**
     This is a juce::AudioProcessor which can told to dynamically load and run different
@@ -426,7 +489,10 @@ struct PatchLibraryDLL
     soul::patch::PatchInstance::Ptr createPatchInstance (const std::string& url)
     {
         if (library->library != nullptr)
-            return soul::patch::PatchInstance::Ptr (library->library->createPatchFromFileBundle (url.c_str()));
+            return PatchInstanceRegistry::getOrCreate (url, [this, &url]
+            {
+                return soul::patch::PatchInstance::Ptr (library->library->createPatchFromFileBundle (url.c_str()));
+            });
 
         return {};
     }
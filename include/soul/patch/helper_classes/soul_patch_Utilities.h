@@ -236,6 +236,7 @@ struct PatchParameterProperties
         unit          = getString ("unit");
         group         = getString ("group");
         textValues    = getString ("text");
+        rampShape     = getString ("rampShape");
         minValue      = endpointAnnotation["min"].getWithDefault<float> (minValue);
         maxValue      = endpointAnnotation["max"].getWithDefault<float> (maxValue);
         step          = endpointAnnotation["step"].getWithDefault<float> (maxValue / static_cast<float> (defaultNumIntervals));
@@ -247,6 +248,7 @@ struct PatchParameterProperties
     }
 
     std::string name, unit, group, textValues;
+    std::string rampShape;   /**< Either empty or "linear" for a linear ramp, or "exponential" for a one-pole approach. */
     float minValue = 0, maxValue = 1.0f, step = 0, initialValue = 0;
     uint32_t rampFrames = 0;
     bool isAutomatable = false, isBoolean = false, isHidden = false;
@@ -116,6 +116,47 @@ public:
     virtual void handleConsoleMessage (uint64_t sampleCount, const char* endpointName, const char* message) = 0;
 };
 
+//==============================================================================
+/**
+    Allows the caller to observe the progress of a compilation and to cancel it.
+
+    If one of these objects is provided to PatchInstance::compileNewPlayerAsync(),
+    its methods will be called from the background compilation thread.
+*/
+class CompilationProgressListener  : public RefCountedBase
+{
+public:
+    using Ptr = RefCountingPtr<CompilationProgressListener>;
+
+    /** Called when the build moves into one of its major stages.
+        The stage names currently used are "parse", "resolve" and "link".
+    */
+    virtual void compilationStageChanged (const char* stageName) = 0;
+
+    /** Polled between compilation passes. Returning true makes the build stop
+        as soon as possible, and the callback will be given a nullptr player.
+    */
+    virtual bool isCancelled() = 0;
+};
+
+//==============================================================================
+/**
+    A callback which receives the result of PatchInstance::compileNewPlayerAsync().
+*/
+class PatchPlayerReadyCallback  : public RefCountedBase
+{
+public:
+    using Ptr = RefCountingPtr<PatchPlayerReadyCallback>;
+
+    /** Called (on a background thread) when an async compilation has finished.
+        If the build was cancelled, the player will be nullptr; otherwise the
+        callee takes ownership of the reference that is passed in, and should
+        check PatchPlayer::isPlayable() before using it, as for the synchronous
+        compileNewPlayer() method.
+    */
+    virtual void playerReady (PatchPlayer*) = 0;
+};
+
 
 //==============================================================================
 /**
@@ -148,6 +189,17 @@ public:
     */
     virtual int64_t getLastModificationTime() = 0;
 
+    /** Tells this instance that a file-watcher has seen a change to one of the
+        patch's files.
+        The library contains no platform file-watching code of its own, since all
+        file access goes through the VirtualFile abstraction, but a host which runs
+        a native watcher over the patch's folder can call this when it fires. The
+        instance will then do a full rescan on its next refresh instead of trusting
+        its cached modification times and manifest hash, so hosts which use a
+        watcher don't need to poll getLastModificationTime() at all.
+    */
+    virtual void notifyExternalFileChange() = 0;
+
     /** Attempts to build a new player for this patch which uses the given config.
         This will always return a new player object, but you should call
         PatchPlayer::isPlayable() on the object before using it to check whether
@@ -160,6 +212,23 @@ public:
                                            SourceFilePreprocessor* preprocessor,
                                            ExternalDataProvider* externalDataProvider,
                                            ConsoleMessageHandler* consoleHandler) = 0;
+
+    /** The asynchronous version of compileNewPlayer().
+        The compilation runs on a shared background thread pool, so a host which
+        loads a session full of patches can kick off all the builds and let them
+        overlap rather than running them back to back. The callback is invoked
+        from the pool thread when the build finishes or is cancelled, and the
+        optional progress listener is told as the build moves between its parse,
+        resolve and link stages. All the object arguments are retained for as
+        long as the build needs them.
+    */
+    virtual void compileNewPlayerAsync (const PatchPlayerConfiguration&,
+                                        CompilerCache* cacheToUse,
+                                        SourceFilePreprocessor* preprocessor,
+                                        ExternalDataProvider* externalDataProvider,
+                                        ConsoleMessageHandler* consoleHandler,
+                                        CompilationProgressListener* progressListener,
+                                        PatchPlayerReadyCallback& callback) = 0;
 };
 
 
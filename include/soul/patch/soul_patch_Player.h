@@ -50,6 +50,55 @@ struct MIDIMessage
     uint8_t data[4];
 };
 
+//==============================================================================
+/** A time-stamped update to the host's timeline: transport state, time signature,
+    tempo or position.
+
+    A host sends these in RenderContext::incomingTimelineEvents, but only when
+    something on its timeline actually changes - each one applies from its
+    timestamp until superseded, so a static timeline involves no events at all.
+    A tempo ramp is declared once, with its end-point and length, and the patch
+    interpolates for itself instead of receiving a fresh tempo every block.
+
+    A patch receives these through input event endpoints declared with the struct
+    types from the soul::timeline library namespace; events of a kind the patch
+    doesn't declare an endpoint for are ignored. The struct is deliberately flat
+    rather than a union, so each event type only reads the fields that its Type
+    documentation lists.
+*/
+struct TimelineEvent
+{
+    enum class Type  : uint32_t
+    {
+        transportState = 0,  /**< Uses the transportState field. */
+        timeSignature  = 1,  /**< Uses timeSigNumerator and timeSigDenominator. */
+        tempo          = 2,  /**< Uses startBPM; the other tempo fields are ignored. */
+        tempoRamp      = 3,  /**< Uses startBPM, endBPM and rampLengthFrames. */
+        position       = 4   /**< Uses currentFrame, currentQuarterNote and lastBarStartQuarterNote. */
+    };
+
+    /** The frame index is a sample offset into the current block of data being
+        processed by a call to PatchPlayer::render().
+    */
+    uint32_t frameIndex = 0;
+
+    Type type = Type::transportState;
+
+    int32_t transportState = 0;     /**< 0 = stopped, 1 = playing, 2 = recording. */
+    int32_t timeSigNumerator = 4;
+    int32_t timeSigDenominator = 4;
+
+    float startBPM = 120.0f;
+    float endBPM = 120.0f;
+    uint32_t reserved = 0;          /**< Makes the padding before the 64-bit fields explicit. */
+
+    int64_t rampLengthFrames = 0;
+
+    int64_t currentFrame = 0;
+    double currentQuarterNote = 0;
+    double lastBarStartQuarterNote = 0;
+};
+
 //==============================================================================
 /** Gives information about one of the patch's buses.
     Currently this is a minimal bus description, just providing the number of
@@ -220,6 +269,15 @@ public:
             maximumMIDIMessagesOut, and numMIDIMessagesOut will return a larger number to
             indicate how many would have been added if it had been possible. */
         uint32_t numMIDIMessagesOut;
+
+        /** An array of timeline events for the render method to process, sorted by
+            frameIndex. May be nullptr if numTimelineEvents is 0, which is the normal
+            state whenever the host's timeline isn't changing. @see TimelineEvent
+        */
+        const TimelineEvent* incomingTimelineEvents;
+
+        /** Number of events to process from the incomingTimelineEvents buffer */
+        uint32_t numTimelineEvents;
     };
 
     /** Renders the next block of audio.
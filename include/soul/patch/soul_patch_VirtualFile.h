@@ -16,6 +16,23 @@ namespace soul
 namespace patch
 {
 
+//==============================================================================
+/**
+    Receives the result of a VirtualFile::readAsync() call.
+    @see VirtualFile::readAsync
+*/
+class VirtualFileReadCallback  : public RefCountedBase
+{
+public:
+    using Ptr = RefCountingPtr<VirtualFileReadCallback>;
+
+    /** Called exactly once per readAsync() call, with the number of bytes
+        successfully read, or -1 if an error occurred. It may be invoked from
+        any thread, including synchronously from inside readAsync() itself.
+    */
+    virtual void readComplete (int64_t bytesRead) = 0;
+};
+
 //==============================================================================
 /**
     Allows the user to define a custom class for representing a file, so that
@@ -53,6 +70,24 @@ public:
         Returns the number of bytes successfully read, or -1 if an error occurred.
     */
     virtual int64_t read (uint64_t startPositionInFile, void* targetBuffer, uint64_t bytesToRead) = 0;
+
+    /** Begins reading a chunk of the file, invoking the callback when done.
+
+        The library may have several of these calls outstanding at once on
+        different files, so an implementation backed by slow or remote storage
+        can overlap the requests' latency rather than serving them one at a
+        time. The target buffer and the callback are guaranteed to stay alive
+        until readComplete() has been invoked.
+
+        The default implementation just performs a synchronous read() and
+        completes the callback before returning, which is perfectly adequate
+        for local filesystems.
+    */
+    virtual void readAsync (uint64_t startPositionInFile, void* targetBuffer, uint64_t bytesToRead,
+                            VirtualFileReadCallback& callback)
+    {
+        callback.readComplete (read (startPositionInFile, targetBuffer, bytesToRead));
+    }
 };
 
 
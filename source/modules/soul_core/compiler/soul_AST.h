@@ -98,6 +98,52 @@ struct AST
         #undef SOUL_DECLARE_ENUM
     };
 
+    /** These predicates, along with the isObjectOfType() members that each AST class
+        declares, let cast() and is_type() identify a node by comparing ObjectType
+        values rather than using dynamic_cast - see checkedPointerCast().
+    */
+    static constexpr bool isModuleObjectType (ObjectType t)
+    {
+        switch (t)
+        {
+            #define SOUL_COMPARE_TYPE(Type)  case ObjectType::Type:
+            SOUL_AST_MODULES (SOUL_COMPARE_TYPE)
+            #undef SOUL_COMPARE_TYPE
+                return true;
+
+            default:
+                return false;
+        }
+    }
+
+    static constexpr bool isStatementObjectType (ObjectType t)
+    {
+        switch (t)
+        {
+            #define SOUL_COMPARE_TYPE(Type)  case ObjectType::Type:
+            SOUL_AST_STATEMENTS (SOUL_COMPARE_TYPE)
+            #undef SOUL_COMPARE_TYPE
+                return true;
+
+            default:
+                return false;
+        }
+    }
+
+    static constexpr bool isExpressionObjectType (ObjectType t)
+    {
+        switch (t)
+        {
+            #define SOUL_COMPARE_TYPE(Type)  case ObjectType::Type:
+            SOUL_AST_EXPRESSIONS (SOUL_COMPARE_TYPE)
+            #undef SOUL_COMPARE_TYPE
+                return true;
+
+            default:
+                return false;
+        }
+    }
+
     static constexpr size_t maxIdentifierLength = 128;
     static constexpr size_t maxInitialiserListLength = 1024 * 64;
     static constexpr size_t maxEndpointArraySize = 256;
@@ -109,6 +155,7 @@ struct AST
     struct Scope;
     struct ModuleBase;
     struct ProcessorBase;
+    struct Function;
     struct FunctionSignature;
     struct Expression;
     struct Statement;
@@ -158,11 +205,52 @@ struct AST
         {
             pool.clear();
             identifiers.clear();
+            specialisedFunctions.clear();
+            resolutionGeneration = 1;
         }
 
         PoolAllocator pool;
         Identifier::Pool identifiers;
         StringDictionary stringDictionary;
+
+        //==============================================================================
+        /** Identifies one specialisation of one generic function: the argument-type
+            signature is baked into the specialised name, whose interned string pointer
+            therefore works as a key without any string comparisons.
+        */
+        struct SpecialisedFunctionKey
+        {
+            const void* genericFunction;
+            const std::string* specialisedName;
+
+            bool operator== (const SpecialisedFunctionKey& other) const
+            {
+                return genericFunction == other.genericFunction
+                        && specialisedName == other.specialisedName;
+            }
+
+            struct Hash
+            {
+                size_t operator() (const SpecialisedFunctionKey& k) const
+                {
+                    return reinterpret_cast<size_t> (k.genericFunction)
+                            ^ (reinterpret_cast<size_t> (k.specialisedName) * 31);
+                }
+            };
+        };
+
+        /** Memo-table of the specialised clones created for generic functions, so that
+            repeated instantiations with identical argument types are shared without
+            re-scanning the parent scope's function list on every call site.
+            @see GenericFunctionResolver
+        */
+        std::unordered_map<SpecialisedFunctionKey, pool_ptr<Function>, SpecialisedFunctionKey::Hash> specialisedFunctions;
+
+        /** Incremented whenever anything is added to the AST or a resolution pass makes
+            progress, so that ResolutionPass can cheaply tell whether re-visiting an
+            unchanged module could possibly achieve anything. @see ModuleBase::lastResolutionGeneration
+        */
+        size_t resolutionGeneration = 1;
     };
 
     //==============================================================================
@@ -188,16 +276,17 @@ struct AST
                         CompileMessage error { "Failed to instantiate generic function "
                                                   + f->originalCallLeadingToSpecialisation->getDescription (f->originalGenericFunction->name),
                                                f->originalCallLeadingToSpecialisation->context.location,
-                                               CompileMessage::Type::error };
+                                               CompileMessage::Type::error,
+                                               CompileMessage::Category::none, nullptr, {} };
 
                         if (location.sourceCode->isInternal)
                         {
                             messages.messages.clear();
 
                             if (isStaticAssertion)
-                                error.description = message.description;
+                                error.description = message.getDescription();
                             else
-                                error.description += ", error: " + message.description;
+                                error.description += ", error: " + message.getDescription();
 
                             messages.messages.push_back (error);
                         }
@@ -225,6 +314,8 @@ struct AST
 
         Scope* getParentScope() const           { return context.parentScope; }
 
+        using CastBaseType = ASTObject;
+
         const ObjectType objectType;
         Context context;
     };
@@ -542,6 +633,8 @@ struct AST
         ModuleBase (ObjectType ot, const Context& c, Identifier moduleName)
             : ASTObject (ot, c), name (moduleName) {}
 
+        static constexpr bool isObjectOfType (ObjectType t)     { return isModuleObjectType (t); }
+
         Scope* getParentScope() const override      { return ASTObject::getParentScope(); }
         ModuleBase* getAsModule() override          { return this; }
 
@@ -608,6 +701,14 @@ struct AST
         Identifier name;
         bool isFullyResolved = false;
 
+        /** The value of Allocator::resolutionGeneration the last time a resolution
+            pass was attempted on this module. If nothing anywhere in the program has
+            changed since then, re-running the error-ignoring passes over this module
+            couldn't make any more progress than last time, so it can be skipped.
+            Zero means "never attempted, or changed since the last attempt".
+        */
+        size_t lastResolutionGeneration = 0;
+
     private:
         size_t countEndpoints (bool countInputs) const
         {
@@ -629,6 +730,8 @@ struct AST
             SOUL_ASSERT (getParentScope() != nullptr);
         }
 
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::Processor || t == ObjectType::Graph; }
+
         Namespace& getNamespace() const
         {
             auto processorNamespace = getParentScope()->getAsNamespace();
@@ -678,6 +781,8 @@ struct AST
     //==============================================================================
     struct Processor   : public ProcessorBase
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::Processor; }
+
         Processor (const Context& c, Identifier moduleName) : ProcessorBase (ObjectType::Processor, c, moduleName) {}
 
         pool_ptr<Function> getRunFunction() const
@@ -730,6 +835,8 @@ struct AST
     //==============================================================================
     struct Graph   : public ProcessorBase
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::Graph; }
+
         Graph (const Context& c, Identifier moduleName) : ProcessorBase (ObjectType::Graph, c, moduleName) {}
 
         void addSpecialisationParameter (VariableDeclaration& v) override
@@ -796,6 +903,8 @@ struct AST
     //==============================================================================
     struct Namespace  : public ModuleBase
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::Namespace; }
+
         Namespace (const Context& c, Identifier moduleName) : ModuleBase (ObjectType::Namespace, c, moduleName) {}
 
         bool isNamespace() const override                                              { return true; }
@@ -825,6 +934,8 @@ struct AST
     {
         Statement (ObjectType ot, const Context& c) : ASTObject (ot, c) {}
 
+        static constexpr bool isObjectOfType (ObjectType t)     { return isStatementObjectType (t); }
+
         virtual const Statement* getAsStatement() const  { return this; }
 
         pool_ptr<Function> getParentFunction() const
@@ -842,6 +953,8 @@ struct AST
     {
         Expression (ObjectType ot, const Context& c, ExpressionKind k)  : Statement (ot, c), kind (k) {}
 
+        static constexpr bool isObjectOfType (ObjectType t)     { return isExpressionObjectType (t); }
+
         virtual bool isResolved() const = 0;
 
         virtual Type getResultType() const                            { SOUL_ASSERT_FALSE; return {}; }
@@ -884,6 +997,9 @@ struct AST
 
                 if (! (dataType.isPrimitive() || dataType.isVector()))
                     context.throwError (Errors::illegalTypeForEndpoint());
+
+                if (dataType.isFloat16())
+                    context.throwError (Errors::float16CannotBeUsedForStream());
             }
 
             if (dataTypes.size() > 1)
@@ -993,6 +1109,8 @@ struct AST
 
     struct EndpointDeclaration  : public ASTObject
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::EndpointDeclaration; }
+
         EndpointDeclaration (const Context& c, bool isInputEndpoint)
             : ASTObject (ObjectType::EndpointDeclaration, c), isInput (isInputEndpoint) {}
 
@@ -1018,6 +1136,8 @@ struct AST
     //==============================================================================
     struct InputEndpointRef  : public Expression
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::InputEndpointRef; }
+
         InputEndpointRef (const Context& c, EndpointDeclaration& i)
             : Expression (ObjectType::InputEndpointRef, c,
                           isEvent (i.getDetails()) ? ExpressionKind::endpoint : ExpressionKind::value), input (i)
@@ -1043,6 +1163,8 @@ struct AST
 
     struct OutputEndpointRef  : public Expression
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::OutputEndpointRef; }
+
         OutputEndpointRef (const Context& c, EndpointDeclaration& o)
             : Expression (ObjectType::OutputEndpointRef, c, ExpressionKind::endpoint), output (o)
         {
@@ -1057,6 +1179,8 @@ struct AST
 
     struct ConnectionEndpointRef  : public Expression
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::ConnectionEndpointRef; }
+
         ConnectionEndpointRef (const Context& c, pool_ptr<ProcessorInstanceRef> p, QualifiedIdentifier& endpoint)
             : Expression (ObjectType::ConnectionEndpointRef, c, ExpressionKind::endpoint),
               parentProcessorInstance (p), endpointName (endpoint)
@@ -1082,6 +1206,8 @@ struct AST
     //==============================================================================
     struct Connection  : public ASTObject
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::Connection; }
+
         Connection (const Context& c, InterpolationType interpolation,
                     Expression& src, Expression& dst, pool_ptr<Expression> delay)
             : ASTObject (ObjectType::Connection, c), interpolationType (interpolation),
@@ -1168,6 +1294,8 @@ struct AST
 
     struct ProcessorInstance  : public ASTObject
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::ProcessorInstance; }
+
         ProcessorInstance (const Context& c) : ASTObject (ObjectType::ProcessorInstance, c) {}
 
         pool_ptr<QualifiedIdentifier> instanceName;
@@ -1182,6 +1310,8 @@ struct AST
                        public Scope
 
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::Function; }
+
         Function (const Context& c) : ASTObject (ObjectType::Function, c) {}
 
         pool_ptr<Expression> returnType;
@@ -1196,6 +1326,11 @@ struct AST
         IntrinsicType intrinsic = IntrinsicType::none;
         bool eventFunction = false;
 
+        /** True for a declaration like 'external float f (float x);' - the body is
+            supplied by the host through the performer's external function API.
+        */
+        bool isExternal = false;
+
         pool_ptr<Block> block;
         pool_ptr<heart::Function> generatedFunction;
 
@@ -1255,6 +1390,8 @@ struct AST
     //==============================================================================
     struct ConcreteType  : public Expression
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::ConcreteType; }
+
         ConcreteType (const Context& c, Type t)
            : Expression (ObjectType::ConcreteType, c, ExpressionKind::type), type (std::move (t))
         {
@@ -1275,11 +1412,15 @@ struct AST
             : Expression (ot, c, ExpressionKind::type), name (typeName)
         {}
 
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::StructDeclaration || t == ObjectType::UsingDeclaration; }
+
         Identifier name;
     };
 
     struct StructDeclaration  : public TypeDeclarationBase
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::StructDeclaration; }
+
         StructDeclaration (const Context& c, Identifier structName)
             : TypeDeclarationBase (ObjectType::StructDeclaration, c, structName)
         {
@@ -1338,6 +1479,8 @@ struct AST
 
     struct UsingDeclaration  : public TypeDeclarationBase
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::UsingDeclaration; }
+
         UsingDeclaration (const Context& c, Identifier usingName, pool_ptr<Expression> target)
             : TypeDeclarationBase (ObjectType::UsingDeclaration, c, usingName), targetType (target)
         {
@@ -1355,6 +1498,8 @@ struct AST
     //==============================================================================
     struct ProcessorAliasDeclaration  : public ASTObject
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::ProcessorAliasDeclaration; }
+
         ProcessorAliasDeclaration (const Context& c, Identifier nm)
             : ASTObject (ObjectType::ProcessorAliasDeclaration, c), name (nm)
         {
@@ -1366,6 +1511,8 @@ struct AST
 
     struct ProcessorRef   : public Expression
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::ProcessorRef; }
+
         ProcessorRef (const Context& c, ProcessorBase& p)
            : Expression (ObjectType::ProcessorRef, c, ExpressionKind::processor), processor (p)
         {
@@ -1380,6 +1527,8 @@ struct AST
 
     struct ProcessorInstanceRef   : public Expression
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::ProcessorInstanceRef; }
+
         ProcessorInstanceRef (const Context& c, ProcessorInstance& p)
            : Expression (ObjectType::ProcessorInstanceRef, c, ExpressionKind::processor), processorInstance (p)
         {
@@ -1396,6 +1545,8 @@ struct AST
     struct Block  : public Statement,
                     public Scope
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::Block; }
+
         Block (const Context& c, pool_ptr<Function> f)
             : Statement (ObjectType::Block, c), functionForWhichThisIsMain (f)
         {
@@ -1443,12 +1594,16 @@ struct AST
     //==============================================================================
     struct NoopStatement  : public Statement
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::NoopStatement; }
+
         NoopStatement (const Context& c)  : Statement (ObjectType::NoopStatement, c) {}
     };
 
     //==============================================================================
     struct LoopStatement  : public Statement
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::LoopStatement; }
+
         LoopStatement (const Context& c, bool isDo)  : Statement (ObjectType::LoopStatement, c), isDoLoop (isDo) {}
 
         pool_ptr<Statement> iterator, body;
@@ -1459,6 +1614,8 @@ struct AST
     //==============================================================================
     struct ReturnStatement  : public Statement
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::ReturnStatement; }
+
         ReturnStatement (const Context& c)  : Statement (ObjectType::ReturnStatement, c) {}
 
         pool_ptr<Expression> returnValue;
@@ -1467,18 +1624,24 @@ struct AST
     //==============================================================================
     struct BreakStatement  : public Statement
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::BreakStatement; }
+
         BreakStatement (const Context& c)  : Statement (ObjectType::BreakStatement, c) {}
     };
 
     //==============================================================================
     struct ContinueStatement  : public Statement
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::ContinueStatement; }
+
         ContinueStatement (const Context& c)  : Statement (ObjectType::ContinueStatement, c) {}
     };
 
     //==============================================================================
     struct IfStatement  : public Statement
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::IfStatement; }
+
         IfStatement (const Context& c, bool isConst, Expression& cond, Statement& t, pool_ptr<Statement> f)
             : Statement (ObjectType::IfStatement, c),
               condition (cond), trueBranch (t), falseBranch (f), isConstIf (isConst) {}
@@ -1492,6 +1655,8 @@ struct AST
     //==============================================================================
     struct TernaryOp  : public Expression
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::TernaryOp; }
+
         TernaryOp (const Context& c, Expression& cond, Expression& trueValue, Expression& falseValue)
             : Expression (ObjectType::TernaryOp, c, ExpressionKind::value),
               condition (cond), trueBranch (trueValue), falseBranch (falseValue) {}
@@ -1518,6 +1683,8 @@ struct AST
     //==============================================================================
     struct Constant  : public Expression
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::Constant; }
+
         Constant (const Context& c, Value v)
             : Expression (ObjectType::Constant, c, ExpressionKind::value), value (std::move (v))
         {
@@ -1540,6 +1707,8 @@ struct AST
     //==============================================================================
     struct QualifiedIdentifier  : public Expression
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::QualifiedIdentifier; }
+
         QualifiedIdentifier (const Context& c, IdentifierPath p)
             : Expression (ObjectType::QualifiedIdentifier, c, ExpressionKind::unknown), path (std::move (p)) {}
 
@@ -1554,6 +1723,8 @@ struct AST
 
     struct SubscriptWithBrackets  : public Expression
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::SubscriptWithBrackets; }
+
         SubscriptWithBrackets (const Context& c, Expression& objectOrType, pool_ptr<Expression> optionalSize)
             : Expression (ObjectType::SubscriptWithBrackets, c, ExpressionKind::unknown), lhs (objectOrType), rhs (optionalSize) {}
 
@@ -1566,6 +1737,8 @@ struct AST
 
     struct SubscriptWithChevrons  : public Expression
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::SubscriptWithChevrons; }
+
         SubscriptWithChevrons (const Context& c, Expression& type, Expression& size)
             : Expression (ObjectType::SubscriptWithChevrons, c, ExpressionKind::unknown), lhs (type), rhs (size) {}
 
@@ -1577,6 +1750,8 @@ struct AST
 
     struct TypeMetaFunction  : public Expression
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::TypeMetaFunction; }
+
         enum class Op
         {
             none,
@@ -1596,6 +1771,7 @@ struct AST
             isFloat,
             isFloat32,
             isFloat64,
+            isFloat16,
             isInt,
             isInt32,
             isInt64,
@@ -1635,6 +1811,7 @@ struct AST
             if (name == "isFloat")          return Op::isFloat;
             if (name == "isFloat32")        return Op::isFloat32;
             if (name == "isFloat64")        return Op::isFloat64;
+            if (name == "isFloat16")        return Op::isFloat16;
             if (name == "isInt")            return Op::isInt;
             if (name == "isInt32")          return Op::isInt32;
             if (name == "isInt64")          return Op::isInt64;
@@ -1669,6 +1846,7 @@ struct AST
                 case Op::isFloat:           return inputType.isFloatingPoint();
                 case Op::isFloat32:         return inputType.isFloat32();
                 case Op::isFloat64:         return inputType.isFloat64();
+                case Op::isFloat16:         return inputType.isFloat16();
                 case Op::isInt:             return inputType.isInteger();
                 case Op::isInt32:           return inputType.isInteger32();
                 case Op::isInt64:           return inputType.isInteger64();
@@ -1796,6 +1974,7 @@ struct AST
                 case Op::isFloat:
                 case Op::isFloat32:
                 case Op::isFloat64:
+                case Op::isFloat16:
                 case Op::isInt:
                 case Op::isInt32:
                 case Op::isInt64:
@@ -1830,6 +2009,8 @@ struct AST
 
     struct DotOperator  : public Expression
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::DotOperator; }
+
         DotOperator (const Context& c, Expression& a, QualifiedIdentifier& b)
            : Expression (ObjectType::DotOperator, c, ExpressionKind::unknown), lhs (a), rhs (b) {}
 
@@ -1842,6 +2023,8 @@ struct AST
     //==============================================================================
     struct VariableDeclaration  : public Statement
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::VariableDeclaration; }
+
         VariableDeclaration (const Context& c, pool_ptr<Expression> type, pool_ptr<Expression> initialiser, bool isConst)
             : Statement (ObjectType::VariableDeclaration, c), declaredType (type), initialValue (initialiser),
               isConstant (isConst)
@@ -1905,6 +2088,8 @@ struct AST
     //==============================================================================
     struct VariableRef  : public Expression
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::VariableRef; }
+
         VariableRef (const Context& c, VariableDeclaration& v)
            : Expression (ObjectType::VariableRef, c, ExpressionKind::value), variable (v)
         {}
@@ -1976,6 +2161,8 @@ struct AST
 
     struct CallOrCast  : public CallOrCastBase
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::CallOrCast; }
+
         CallOrCast (Expression& nameOrTargetType, pool_ptr<CommaSeparatedList> args, bool isMethod)
             : CallOrCastBase (ObjectType::CallOrCast, nameOrTargetType.context, args, isMethod), nameOrType (nameOrTargetType)
         {
@@ -1986,6 +2173,8 @@ struct AST
 
     struct FunctionCall  : public CallOrCastBase
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::FunctionCall; }
+
         FunctionCall (const Context& c, Function& function, pool_ptr<CommaSeparatedList> args, bool isMethod)
             : CallOrCastBase (ObjectType::FunctionCall, c, args, isMethod), targetFunction (function)
         {}
@@ -1998,6 +2187,8 @@ struct AST
 
     struct TypeCast  : public Expression
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::TypeCast; }
+
         TypeCast (const Context& c, Type destType, Expression& sourceValue)
             : Expression (ObjectType::TypeCast, c, ExpressionKind::value),
               targetType (std::move (destType)), source (sourceValue)
@@ -2024,6 +2215,8 @@ struct AST
     //==============================================================================
     struct CommaSeparatedList  : public Expression
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::CommaSeparatedList; }
+
         CommaSeparatedList (const Context& c)
             : Expression (ObjectType::CommaSeparatedList, c, ExpressionKind::unknown)
         {
@@ -2064,6 +2257,8 @@ struct AST
     //==============================================================================
     struct UnaryOperator  : public Expression
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::UnaryOperator; }
+
         UnaryOperator (const Context& c, Expression& s, UnaryOp::Op op)
            : Expression (ObjectType::UnaryOperator, c, ExpressionKind::value), source (s), operation (op) {}
 
@@ -2089,6 +2284,8 @@ struct AST
     //==============================================================================
     struct BinaryOperator  : public Expression
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::BinaryOperator; }
+
         BinaryOperator (const Context& c, Expression& a, Expression& b, BinaryOp::Op op)
            : Expression (ObjectType::BinaryOperator, c, ExpressionKind::value), lhs (a), rhs (b), operation (op)
         {
@@ -2129,6 +2326,8 @@ struct AST
     //==============================================================================
     struct Assignment  : public Expression
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::Assignment; }
+
         Assignment (const Context& c, Expression& dest, Expression& source)
             : Expression (ObjectType::Assignment, c, ExpressionKind::value), target (dest), newValue (source)
         {
@@ -2144,6 +2343,8 @@ struct AST
     //==============================================================================
     struct PreOrPostIncOrDec  : public Expression
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::PreOrPostIncOrDec; }
+
         PreOrPostIncOrDec (const Context& c, Expression& input, bool inc, bool post)
             : Expression (ObjectType::PreOrPostIncOrDec, c, ExpressionKind::value), target (input), isIncrement (inc), isPost (post)
         {
@@ -2160,6 +2361,8 @@ struct AST
     //==============================================================================
     struct ArrayElementRef  : public Expression
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::ArrayElementRef; }
+
         ArrayElementRef (const Context& c, Expression& o, pool_ptr<Expression> start, pool_ptr<Expression> end, bool slice)
             : Expression (ObjectType::ArrayElementRef, c, ExpressionKind::value),
               object (o), startIndex (start), endIndex (end), isSlice (slice)
@@ -2267,6 +2470,8 @@ struct AST
     //==============================================================================
     struct StructMemberRef  : public Expression
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::StructMemberRef; }
+
         StructMemberRef (const Context& c, Expression& o, StructurePtr s, std::string member)
             : Expression (ObjectType::StructMemberRef, c, ExpressionKind::value),
               object (o), structure (s), memberName (std::move (member))
@@ -2286,6 +2491,8 @@ struct AST
     //==============================================================================
     struct AdvanceClock  : public Expression
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::AdvanceClock; }
+
         AdvanceClock (const Context& c)  : Expression (ObjectType::AdvanceClock, c, ExpressionKind::value) {}
 
         bool isResolved() const override            { return true; }
@@ -2295,6 +2502,8 @@ struct AST
     //==============================================================================
     struct WriteToEndpoint  : public Expression
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::WriteToEndpoint; }
+
         WriteToEndpoint (const Context& c, Expression& endpoint, Expression& v)
             : Expression (ObjectType::WriteToEndpoint, c, ExpressionKind::endpoint), target (endpoint), value (v) {}
 
@@ -2308,6 +2517,8 @@ struct AST
     //==============================================================================
     struct ProcessorProperty  : public Expression
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::ProcessorProperty; }
+
         ProcessorProperty (const Context& c, heart::ProcessorProperty::Property prop)
             : Expression (ObjectType::ProcessorProperty, c, ExpressionKind::value), property (prop)
         {
@@ -2324,6 +2535,8 @@ struct AST
     //==============================================================================
     struct StaticAssertion  : public Expression
     {
+        static constexpr bool isObjectOfType (ObjectType t)     { return t == ObjectType::StaticAssertion; }
+
         StaticAssertion (const Context& c, Expression& failureCondition, std::string error)
             : Expression (ObjectType::StaticAssertion, c, ExpressionKind::unknown),
               condition (failureCondition), errorMessage (std::move (error))
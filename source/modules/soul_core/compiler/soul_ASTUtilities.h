@@ -158,6 +158,10 @@ private:
     {
         auto newParentScope = std::addressof (target);
 
+        // The target is gaining new content, so any previous resolution state is stale
+        target.isFullyResolved = false;
+        target.lastResolutionGeneration = 0;
+
         for (auto& f : source.functions)
         {
             target.functions.push_back (f);
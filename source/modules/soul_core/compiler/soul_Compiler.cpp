@@ -66,16 +66,25 @@ void Compiler::addDefaultBuiltInLibrary()
     try
     {
         soul::CompileMessageHandler handler (list);
-        compile (getDefaultLibraryCode());
+
+        // The library is only parsed here: resolution is deferred so that it runs
+        // once, alongside the user's code, rather than the whole growing tree being
+        // re-resolved for each of these modules in turn
+        parseWithoutResolving (getDefaultLibraryCode());
 
         // TODO: when we have import & module support, these will no longer be hard-coded here
-        compile (getSystemModule ("soul.audio.utils"));
-        compile (getSystemModule ("soul.midi"));
-        compile (getSystemModule ("soul.notes"));
-        compile (getSystemModule ("soul.frequency"));
-        compile (getSystemModule ("soul.mixing"));
-        compile (getSystemModule ("soul.oscillators"));
-        compile (getSystemModule ("soul.noise"));
+        parseWithoutResolving (getSystemModule ("soul.audio.utils"));
+        parseWithoutResolving (getSystemModule ("soul.midi"));
+        parseWithoutResolving (getSystemModule ("soul.notes"));
+        parseWithoutResolving (getSystemModule ("soul.frequency"));
+        parseWithoutResolving (getSystemModule ("soul.mixing"));
+        parseWithoutResolving (getSystemModule ("soul.oscillators"));
+        parseWithoutResolving (getSystemModule ("soul.noise"));
+        parseWithoutResolving (getSystemModule ("soul.timeline"));
+
+        // each chunk declares its own "soul" namespace, which have to be folded
+        // together before anything tries to resolve across them
+        ASTUtilities::mergeDuplicateNamespaces (*topLevelNamespace);
     }
     catch (soul::AbortCompilationException)
     {
@@ -113,13 +122,90 @@ static ArrayWithPreallocation<CodeLocation, 4> getHEARTFiles (const BuildBundle&
     return result;
 }
 
+//==============================================================================
+/** A minimal tokeniser which just scans a whole file for lexical errors without
+    building any AST, so that a batch of files can be checked on worker threads
+    before the single-threaded parse begins.
+*/
+struct TokenPrescan final  : public Tokeniser<Keyword::Matcher,
+                                              StandardOperatorMatcher,
+                                              StandardIdentifierMatcher>
+{
+    static void scan (const CodeLocation& code)
+    {
+        TokenPrescan t (code);
+
+        while (! t.matches (Token::eof))
+            t.skip();
+    }
+
+    TokenPrescan (const CodeLocation& code)  : Tokeniser (code) {}
+
+    [[noreturn]] void throwError (const CompileMessage& message) const override
+    {
+        location.throwError (message);
+    }
+};
+
+/** Tokenises each file of a bundle on a thread pool, collecting any lexical errors
+    in per-file message lists which are then merged in source order, so that the
+    messages produced are identical to those of a sequential scan.
+*/
+static bool prescanSourceFilesInParallel (CompileMessageList& messageList, const BuildBundle& bundle)
+{
+    SOUL_LOG_TIME_OF_SCOPE ("parallel prescan");
+
+    struct FileScan
+    {
+        CodeLocation code;
+        CompileMessageList messages;
+    };
+
+    std::vector<FileScan> scans (bundle.sourceFiles.size());
+
+    for (size_t i = 0; i < scans.size(); ++i)
+        scans[i].code = CodeLocation::createFromSourceFile (bundle.sourceFiles[i]);
+
+    {
+        ThreadPool pool (ThreadPool::getRecommendedNumberOfThreads (scans.size()));
+
+        for (auto& scan : scans)
+            pool.addJob ([&scan]
+                         {
+                             try
+                             {
+                                 CompileMessageHandler handler (scan.messages);
+                                 TokenPrescan::scan (scan.code);
+                             }
+                             catch (AbortCompilationException) {}
+                         });
+    }
+
+    for (auto& scan : scans)
+        messageList.add (scan.messages);
+
+    return ! messageList.hasErrors();
+}
+
 static Program buildHEART (CompileMessageList& messageList, CodeLocation code)
 {
+    auto* timing = messageList.timingReport.get();
+
     try
     {
         CompileMessageHandler handler (messageList);
-        auto program = heart::Parser::parse (code);
-        heart::Checker::sanityCheck (program);
+        Program program;
+
+        {
+            BuildTimingReport::Phase timedPhase (timing, "parse");
+            program = heart::Parser::parse (code);
+        }
+
+        {
+            BuildTimingReport::Phase timedPhase (timing, "check");
+            heart::Checker::sanityCheckInParallel (program);
+        }
+
         return program;
     }
     catch (AbortCompilationException) {}
@@ -129,8 +215,19 @@ static Program buildHEART (CompileMessageList& messageList, CodeLocation code)
 
 
 //==============================================================================
-Program Compiler::build (CompileMessageList& messageList, const BuildBundle& bundle)
+Program Compiler::build (CompileMessageList& messageList, const BuildBundle& bundle, const BuildStageMonitor* monitor)
 {
+    auto notifyStage = [=] (const char* stageName)
+    {
+        if (monitor != nullptr && monitor->stageChanged != nullptr)
+            monitor->stageChanged (stageName);
+    };
+
+    auto isCancelled = [=]
+    {
+        return monitor != nullptr && monitor->shouldCancel != nullptr && monitor->shouldCancel();
+    };
+
     sanityCheckBuildSettings (bundle.settings);
 
     auto heartFiles = getHEARTFiles (bundle);
@@ -143,13 +240,143 @@ Program Compiler::build (CompileMessageList& messageList, const BuildBundle& bun
         return buildHEART (messageList, heartFiles.front());
     }
 
+    if (bundle.sourceFiles.size() > 1)
+        if (! prescanSourceFilesInParallel (messageList, bundle))
+            return {};
+
     Compiler c;
+    auto* timing = messageList.timingReport.get();
 
-    for (auto& file : bundle.sourceFiles)
-        if (! c.addCode (messageList, CodeLocation::createFromSourceFile (file)))
+    try
+    {
+        CompileMessageHandler handler (messageList);
+        BuildTimingReport::TrackedPool trackedASTPool (timing, "AST pool", c.allocator.pool);
+
+        notifyStage ("parse");
+
+        {
+            BuildTimingReport::Phase timedParse (timing, "parse");
+
+            // The per-file work (tokenising and building the rough AST) is independent, but
+            // the AST pool and identifier table aren't thread-safe, so after the parallel
+            // prescan the trees are built here in order, and the cross-file resolution
+            // passes are then run just once over the whole bundle rather than once per file.
+            for (auto& file : bundle.sourceFiles)
+            {
+                if (isCancelled())
+                    return {};
+
+                BuildTimingReport::Phase timedFile (timing, file.filename);
+                c.parseWithoutResolving (CodeLocation::createFromSourceFile (file));
+            }
+        }
+
+        if (isCancelled())
             return {};
 
-    return c.link (messageList, bundle.settings);
+        notifyStage ("resolve");
+
+        {
+            BuildTimingReport::Phase timedResolve (timing, "resolve");
+            c.resolveParsedModules();
+        }
+    }
+    catch (AbortCompilationException)
+    {
+        return {};
+    }
+
+    if (isCancelled())
+        return {};
+
+    notifyStage ("link");
+    return c.link (messageList, bundle.settings, monitor);
+}
+
+//==============================================================================
+static std::string getBundleCacheKey (const BuildBundle& bundle)
+{
+    HashBuilder hash;
+    hash << std::to_string (getHEARTFormatVersion())
+         << bundle.settings.mainProcessor
+         << std::to_string (bundle.settings.sampleRate)
+         << std::to_string (bundle.settings.maxBlockSize)
+         << std::to_string (bundle.settings.optimisationLevel);
+
+    for (auto& file : bundle.sourceFiles)
+        hash << file.filename << file.content;
+
+    return "SOULBUILD_" + hash.toString();
+}
+
+static Program readCachedProgram (LinkerCache& cache, const std::string& key)
+{
+    auto size = cache.readItem (key.c_str(), nullptr, 0);
+
+    if (size == 0)
+        return {};
+
+    std::string heartCode;
+    heartCode.resize ((size_t) size);
+
+    if (cache.readItem (key.c_str(), heartCode.data(), size) != size)
+        return {};
+
+    // Entries written by this version are binary-serialised, which avoids re-running
+    // the HEART tokeniser and parser on a cache hit. load() verifies the blob's
+    // content hash, and an intact hash means the entry is byte-for-byte the program
+    // which was checked and stored, so heart::Checker isn't re-run on it either
+    if (heart::Serialiser::isSerialisedProgram (heartCode.data(), heartCode.size()))
+        return heart::Serialiser::load (heartCode.data(), heartCode.size());
+
+    // Textual entries carry no integrity hash, so createFromHEART() gives them the
+    // same full re-validation as any other incoming HEART code.
+    // A stale or corrupted entry mustn't produce errors - just fall back to a full build
+    CompileMessageList cacheMessages;
+    auto program = Program::createFromHEART (cacheMessages, CodeLocation::createFromString (key, std::move (heartCode)));
+
+    if (cacheMessages.hasErrors())
+        return {};
+
+    return program;
+}
+
+Program Compiler::buildWithCache (CompileMessageList& messageList, const BuildBundle& bundle, LinkerCache* cache,
+                                  const BuildStageMonitor* monitor)
+{
+    if (cache == nullptr)
+        return build (messageList, bundle, monitor);
+
+    auto key = getBundleCacheKey (bundle);
+
+    {
+        SOUL_LOG_TIME_OF_SCOPE ("cache lookup");
+        auto cached = readCachedProgram (*cache, key);
+
+        if (! cached.isEmpty())
+            return cached;
+    }
+
+    auto program = build (messageList, bundle, monitor);
+
+    if (! program.isEmpty())
+    {
+        auto binary = heart::Serialiser::save (program);
+
+        if (! binary.empty())
+        {
+            cache->storeItem (key.c_str(), binary.data(), (uint64_t) binary.size());
+        }
+        else
+        {
+            // If the program contains something the binary format can't represent,
+            // the textual dump still works as a (slower) cache entry
+            auto heartCode = program.toHEART();
+            cache->storeItem (key.c_str(), heartCode.data(), (uint64_t) heartCode.size());
+        }
+    }
+
+    return program;
 }
 
 std::vector<pool_ref<AST::ModuleBase>> Compiler::parseTopLevelDeclarations (AST::Allocator& allocator, CodeLocation code,
@@ -163,9 +390,20 @@ void Compiler::compile (CodeLocation code)
 {
     SOUL_LOG_TIME_OF_SCOPE ("compile: " + code.getFilename());
 
+    parseWithoutResolving (std::move (code));
+    resolveParsedModules();
+}
+
+void Compiler::parseWithoutResolving (CodeLocation code)
+{
+    SOUL_LOG_TIME_OF_SCOPE ("parse: " + code.getFilename());
+
     for (auto& m : StructuralParser::parseTopLevelDeclarations (allocator, code, *topLevelNamespace))
         SanityCheckPass::runPreResolution (m);
+}
 
+void Compiler::resolveParsedModules()
+{
     ResolutionPass::run (allocator, *topLevelNamespace, true);
 
     ASTUtilities::mergeDuplicateNamespaces (*topLevelNamespace);
@@ -211,7 +449,7 @@ AST::ProcessorBase& Compiler::findMainProcessor (const BuildSettings& settings)
     return *main;
 }
 
-Program Compiler::link (CompileMessageList& messageList, const BuildSettings& settings)
+Program Compiler::link (CompileMessageList& messageList, const BuildSettings& settings, const BuildStageMonitor* monitor)
 {
     if (messageList.hasErrors())
         return {};
@@ -220,39 +458,174 @@ Program Compiler::link (CompileMessageList& messageList, const BuildSettings& se
     {
         CompileMessageHandler handler (messageList);
         sanityCheckBuildSettings (settings);
-        return link (messageList, findMainProcessor (settings));
+        return link (messageList, findMainProcessor (settings), settings, monitor);
     }
     catch (AbortCompilationException) {}
 
     return {};
 }
 
-Program Compiler::link (CompileMessageList& messageList, AST::ProcessorBase& processorToRun)
+Program Compiler::link (CompileMessageList& messageList, AST::ProcessorBase& processorToRun, const BuildSettings& settings,
+                        const BuildStageMonitor* monitor)
 {
+    auto notifyStage = [=] (const char* stageName)
+    {
+        if (monitor != nullptr && monitor->stageChanged != nullptr)
+            monitor->stageChanged (stageName);
+    };
+
+    auto* timing = messageList.timingReport.get();
+
     try
     {
         SOUL_LOG_TIME_OF_SCOPE ("link time");
+        BuildTimingReport::Phase timedLink (timing, "link");
         CompileMessageHandler handler (messageList);
-        ASTUtilities::resolveHoistedEndpoints (allocator, *topLevelNamespace);
-        ASTUtilities::mergeDuplicateNamespaces (*topLevelNamespace);
-        ResolutionPass::run (allocator, *topLevelNamespace, true);
-        ASTUtilities::removeModulesWithSpecialisationParams (*topLevelNamespace);
-        ResolutionPass::run (allocator, *topLevelNamespace, false);
-        ASTUtilities::connectAnyChildEndpointsNeedingToBeExposed (allocator, processorToRun);
-
+        OptimisationRemarkScope remarkScope (messageList.includeOptimisationRemarks);
+        BuildTimingReport::TrackedPool trackedASTPool (timing, "AST pool", allocator.pool);
+
+        {
+            BuildTimingReport::Phase timedPhase (timing, "resolve");
+            ASTUtilities::resolveHoistedEndpoints (allocator, *topLevelNamespace);
+            ASTUtilities::mergeDuplicateNamespaces (*topLevelNamespace);
+            ++allocator.resolutionGeneration;  // the passes above can alter modules in-place, so give everything one more attempt
+            ResolutionPass::run (allocator, *topLevelNamespace, true);
+            ASTUtilities::removeModulesWithSpecialisationParams (*topLevelNamespace);
+            ResolutionPass::run (allocator, *topLevelNamespace, false);
+            ASTUtilities::connectAnyChildEndpointsNeedingToBeExposed (allocator, processorToRun);
+        }
+
+        notifyStage ("heartgen");
         Program program;
         program.getStringDictionary() = allocator.stringDictionary;  // Bring the existing string dictionary along so that the handles match
-        compileAllModules (*topLevelNamespace, program, processorToRun);
-        heart::Utilities::inlineFunctionsThatUseAdvanceOrStreams<Optimisations> (program);
-        heart::Checker::sanityCheck (program);
+
+        BuildTimingReport::TrackedPool trackedHEARTPool (timing, "HEART pool", program.getAllocator().pool);
+        BuildTimingReport::TrackedPool trackedStatementPool (timing, "HEART statement pool", program.getAllocator().statementPool);
+
+        {
+            BuildTimingReport::Phase timedPhase (timing, "heartgen");
+            compileAllModules (*topLevelNamespace, program, processorToRun);
+            heart::Utilities::inlineFunctionsThatUseAdvanceOrStreams<Optimisations> (program);
+        }
+
+        notifyStage ("check");
+
+        {
+            BuildTimingReport::Phase timedPhase (timing, "check");
+            heart::Checker::sanityCheckInParallel (program);
+        }
+
         reset();
 
         SOUL_LOG (program.getMainProcessor().originalFullName + ": linked HEART",
                   [&] { return program.toHEART(); });
 
-        heart::Checker::testHEARTRoundTrip (program);
-        Optimisations::optimiseFunctionBlocks (program);
-        Optimisations::removeUnusedVariables (program);
+        {
+            BuildTimingReport::Phase timedPhase (timing, "heart round-trip");
+            heart::Checker::testHEARTRoundTrip (program);
+        }
+
+        notifyStage ("optimise");
+
+        {
+            BuildTimingReport::Phase timedOptimise (timing, "optimise");
+
+            {
+                BuildTimingReport::Phase timedPass (timing, "specialise properties");
+                heart::Utilities::specialiseProcessorProperties (program, settings.sampleRate);
+            }
+
+            {
+                BuildTimingReport::Phase timedPass (timing, "inline small functions");
+                Optimisations::inlineSmallFunctions (program);
+            }
+
+            {
+                BuildTimingReport::Phase timedPass (timing, "optimise function blocks");
+                Optimisations::optimiseFunctionBlocks (program);
+            }
+
+            {
+                BuildTimingReport::Phase timedPass (timing, "fuse processor chains");
+                Optimisations::fuseProcessorChains (program);
+            }
+
+            {
+                BuildTimingReport::Phase timedPass (timing, "merge advance blocks");
+                Optimisations::mergeDuplicateAdvanceBlocks (program);
+            }
+
+            {
+                BuildTimingReport::Phase timedPass (timing, "flatten event fan-out");
+                Optimisations::flattenEventFanOut (program);
+            }
+
+            {
+                BuildTimingReport::Phase timedPass (timing, "propagate silence flags");
+                Optimisations::propagateSilenceFlags (program);
+            }
+
+            {
+                BuildTimingReport::Phase timedPass (timing, "evaluate init functions");
+                heart::Interpreter::evaluateInitFunctions (program);
+            }
+
+            {
+                BuildTimingReport::Phase timedPass (timing, "propagate frozen constants");
+                Optimisations::propagateFrozenStateConstants (program);
+            }
+
+            {
+                BuildTimingReport::Phase timedPass (timing, "reorder state layout");
+                Optimisations::reorderStateByAccessFrequency (program);
+            }
+
+            {
+                BuildTimingReport::Phase timedPass (timing, "annotate delay-line accesses");
+                Optimisations::annotateDelayLineAccesses (program);
+            }
+
+            {
+                BuildTimingReport::Phase timedPass (timing, "pad voice state");
+                Optimisations::padVoiceStateToCacheLineStride (program);
+            }
+
+            {
+                BuildTimingReport::Phase timedPass (timing, "remove unused variables");
+                Optimisations::removeUnusedVariables (program);
+            }
+
+            {
+                BuildTimingReport::Phase timedPass (timing, "deduplicate modules");
+                program.deduplicateIdenticalModules();
+            }
+
+            {
+                // After deduplication, so merged modules are only classified once
+                BuildTimingReport::Phase timedPass (timing, "assign code sections");
+                Optimisations::assignCodeSections (program);
+            }
+
+            {
+                BuildTimingReport::Phase timedPass (timing, "assign render stages");
+
+                // A structurally unchanged graph gets its cached schedule replayed
+                // rather than re-derived, which makes relinking a reload of the
+                // same session topology skip the graph analysis
+                for (auto& m : program.getModules())
+                    if (m->isGraph())
+                        heart::Utilities::GraphTopologyCache::get().assignRenderStages (m);
+            }
+
+            {
+                BuildTimingReport::Phase timedPass (timing, "assign connection buffers");
+
+                for (auto& m : program.getModules())
+                    if (m->isGraph())
+                        heart::Utilities::assignConnectionBufferSlots (program, m);
+            }
+        }
+
         return program;
     }
     catch (AbortCompilationException) {}
@@ -21,6 +21,27 @@
 namespace soul
 {
 
+class LinkerCache;
+
+//==============================================================================
+/**
+    An optional set of hooks which a caller can pass to Compiler::build() to be
+    told when the build moves between its major stages, and to abandon it cleanly
+    between them.
+
+    The stage names passed to stageChanged are "parse", "resolve" and "link";
+    the link stage then reports its finer-grained phases as "heartgen", "check"
+    and "optimise".
+    shouldCancel is polled between files and between passes - if it returns true,
+    the build stops and an empty Program is returned without any errors being
+    added to the message list.
+*/
+struct BuildStageMonitor
+{
+    std::function<void(const char* stageName)> stageChanged;
+    std::function<bool()> shouldCancel;
+};
+
 //==============================================================================
 /**
     Compiles and links some source code to create a Program that can be
@@ -39,7 +60,18 @@ public:
         the resulting program.
     */
     static Program build (CompileMessageList& messageList,
-                          const BuildBundle& buildBundle);
+                          const BuildBundle& buildBundle,
+                          const BuildStageMonitor* monitor = nullptr);
+
+    /** The same as build(), but if a cache is supplied, the fully-resolved HEART
+        program is stored in it, keyed by a hash of the bundle's source and settings.
+        Re-building an unchanged bundle is then just a re-load of the linked HEART,
+        which skips the whole SOUL front-end.
+    */
+    static Program buildWithCache (CompileMessageList& messageList,
+                                   const BuildBundle& buildBundle,
+                                   LinkerCache*,
+                                   const BuildStageMonitor* monitor = nullptr);
 
     /** Compiles a chunk of code which is expected to contain a list of top-level
         processor/graph/namespace decls, and these are added to the program.
@@ -50,7 +82,8 @@ public:
         into a single program, which is returned. After calling this, the state
         of the Compiler object is reset to empty.
     */
-    Program link (CompileMessageList& messageList, const BuildSettings&);
+    Program link (CompileMessageList& messageList, const BuildSettings&,
+                  const BuildStageMonitor* monitor = nullptr);
 
     /** Just parses the top-level objects from a chunk of code */
     static std::vector<pool_ref<AST::ModuleBase>> parseTopLevelDeclarations (AST::Allocator&,
@@ -65,7 +98,10 @@ private:
     void reset();
     void addDefaultBuiltInLibrary();
     void compile (CodeLocation);
-    Program link (CompileMessageList&, AST::ProcessorBase& processorToRun);
+    void parseWithoutResolving (CodeLocation);
+    void resolveParsedModules();
+    Program link (CompileMessageList&, AST::ProcessorBase& processorToRun, const BuildSettings&,
+                  const BuildStageMonitor* monitor);
     AST::ProcessorBase& findMainProcessor (const BuildSettings&);
 
     void compileAllModules (const AST::Namespace& parentNamespace, Program&, AST::ProcessorBase& processorToRun);
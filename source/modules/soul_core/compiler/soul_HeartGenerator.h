@@ -31,8 +31,7 @@ struct HEARTGenerator  : public ASTVisitor
                        ArrayView<pool_ref<Module>> targetModules,
                        uint32_t maxNestedExpressionDepth = 255)
     {
-        for (auto& m : sourceModules)
-            SanityCheckPass::runPostResolution (m);
+        runSanityChecks (sourceModules);
 
         std::vector<HEARTGenerator> generators;
 
@@ -46,6 +45,61 @@ struct HEARTGenerator  : public ASTVisitor
 private:
     using super = ASTVisitor;
 
+    /** The post-resolution sanity checks are pure validation - they never mutate the
+        AST or allocate from its pool - so independent modules can be checked on worker
+        threads. Each task collects its diagnostics into a private list and the lists
+        are merged in module order afterwards, keeping the output deterministic.
+    */
+    static void runSanityChecks (ArrayView<pool_ref<AST::ModuleBase>> sourceModules)
+    {
+        if (sourceModules.size() > 1)
+        {
+            struct ModuleCheck
+            {
+                pool_ptr<AST::ModuleBase> module;
+                CompileMessageList messages;
+            };
+
+            std::vector<ModuleCheck> checks (sourceModules.size());
+
+            for (size_t i = 0; i < checks.size(); ++i)
+                checks[i].module = sourceModules[i];
+
+            {
+                ThreadPool pool (ThreadPool::getRecommendedNumberOfThreads (checks.size()));
+
+                for (auto& check : checks)
+                    pool.addJob ([&check]
+                                 {
+                                     try
+                                     {
+                                         CompileMessageHandler handler (check.messages);
+                                         SanityCheckPass::runPostResolution (*check.module);
+                                     }
+                                     catch (AbortCompilationException) {}
+                                 });
+            }
+
+            bool hasErrors = false;
+
+            for (auto& check : checks)
+            {
+                hasErrors = hasErrors || check.messages.hasErrors();
+
+                for (auto& m : check.messages.messages)
+                    emitMessage (m);
+            }
+
+            if (hasErrors)
+                throw AbortCompilationException();
+
+            return;
+        }
+
+        for (auto& m : sourceModules)
+            SanityCheckPass::runPostResolution (m);
+    }
+
     HEARTGenerator (AST::ModuleBase& source, Module& targetModule, uint32_t maxDepth)
         : module (targetModule), builder (targetModule), maxExpressionDepth (maxDepth)
     {
@@ -124,10 +178,11 @@ private:
     }
 
     void addBranchIf (AST::Expression& condition, heart::Block& trueBranch,
-                      heart::Block& falseBranch, pool_ptr<heart::Block> subsequentBranch)
+                      heart::Block& falseBranch, pool_ptr<heart::Block> subsequentBranch,
+                      heart::BranchIf::Likelihood likelihood = heart::BranchIf::Likelihood::unknown)
     {
         builder.addBranchIf (evaluateAsExpression (condition, PrimitiveType::bool_),
-                             trueBranch, falseBranch, subsequentBranch);
+                             trueBranch, falseBranch, subsequentBranch, likelihood);
     }
 
     void visitWithDestination (pool_ptr<heart::Variable> destVar, AST::Statement& s)
@@ -330,6 +385,21 @@ private:
                         i->clockDividerRatio->context.throwError (Errors::ratioMustBeInteger());
                 }
 
+                // A control-rate processor can declare its own default divider with a
+                // [[ division: N ]] annotation, so that every instance runs undersampled
+                // without each graph needing to repeat the "/ N" ratio. An explicit ratio
+                // on the instance overrides the annotation.
+                if (i->clockMultiplierRatio == nullptr && i->clockDividerRatio == nullptr)
+                {
+                    if (auto division = targetProcessor.annotation.findProperty ("division"))
+                    {
+                        if (auto c = division->value->getAsConstant())
+                            p.clockDivider = heart::getClockRatioFromValue (division->value->context, c->value);
+                        else
+                            division->value->context.throwError (Errors::ratioMustBeInteger());
+                    }
+                }
+
                 SOUL_ASSERT (i->specialisationArgs.empty());
 
                 module.processorInstances.push_back (p);
@@ -355,6 +425,11 @@ private:
             af.intrinsicType = f.intrinsic;
             af.annotation = f.annotation.toPlainAnnotation (module.program.getStringDictionary());
             af.location = f.context.location;
+
+            // the flag travels in the annotation, which already survives the HEART
+            // round-trip, cloning and serialisation without any extra plumbing
+            if (f.isExternal)
+                af.annotation.set ("external", true);
         }
     }
 
@@ -389,11 +464,32 @@ private:
                 generateFunction (f);
     }
 
+    /** External functions cross the engine boundary as plain C-style calls, so
+        their signatures are restricted to types with an obvious flat layout:
+        primitives, vectors of primitives, and (for parameters) arrays of those.
+        Structs, strings and bounded ints stay on this side of the boundary.
+    */
+    static bool isTypeAllowedAcrossExternalBoundary (const Type& type, bool isReturnType)
+    {
+        auto t = type.withConstAndRefFlags (false, false);
+
+        if (t.isVoid())
+            return isReturnType;
+
+        if (t.isPrimitiveOrVector())
+            return true;
+
+        return ! isReturnType && t.isArray() && t.getArrayElementType().isPrimitiveOrVector();
+    }
+
     void generateFunction (AST::Function& f)
     {
         auto& af = f.getGeneratedFunction();
         af.returnType = f.returnType->resolveAsType();
 
+        if (f.isExternal && ! isTypeAllowedAcrossExternalBoundary (af.returnType, true))
+            f.context.throwError (Errors::externalFunctionInvalidType (af.returnType.getDescription()));
+
         ifIndex = 0;
         loopIndex = 0;
         builder.beginFunction (af);
@@ -405,6 +501,9 @@ private:
             if (af.functionType.isEvent() && v.getType().isNonConstReference())
                 p->context.throwError (Errors::eventParamsCannotBeNonConstReference());
 
+            if (f.isExternal && ! isTypeAllowedAcrossExternalBoundary (v.getType(), false))
+                p->context.throwError (Errors::externalFunctionInvalidType (v.getType().getDescription()));
+
             builder.addParameter (v);
         }
 
@@ -755,7 +854,8 @@ private:
             SOUL_ASSERT (l.iterator == nullptr);
             builder.beginBlock (continueBlock);
             visitAsStatement (l.body);
-            addBranchIf (*l.condition, continueBlock, breakBlock, breakBlock);
+            addBranchIf (*l.condition, continueBlock, breakBlock, breakBlock,
+                         heart::BranchIf::Likelihood::likelyTrue);
         }
         else
         {
@@ -789,7 +889,8 @@ private:
                 auto& isCounterInRange = builder.createBinaryOp (l.context.location, counterVar,
                                                                  builder.createZeroInitialiser (indexType),
                                                                  BinaryOp::Op::greaterThan);
-                builder.addBranchIf (isCounterInRange, bodyBlock, breakBlock, bodyBlock);
+                builder.addBranchIf (isCounterInRange, bodyBlock, breakBlock, bodyBlock,
+                                     heart::BranchIf::Likelihood::likelyTrue);
                 visitAsStatement (l.body);
                 builder.beginBlock (continueBlock);
                 builder.decrementValue (counterVar);
@@ -803,7 +904,8 @@ private:
                 else if (auto c = l.condition->getAsConstant())
                     builder.addBranch (c->value.getAsBool() ? bodyBlock : breakBlock, bodyBlock);
                 else
-                    addBranchIf (*l.condition, bodyBlock, breakBlock, bodyBlock);
+                    addBranchIf (*l.condition, bodyBlock, breakBlock, bodyBlock,
+                                 heart::BranchIf::Likelihood::likelyTrue);
 
                 visitAsStatement (l.body);
                 builder.beginBlock (continueBlock);
@@ -909,7 +1011,7 @@ private:
         SOUL_ASSERT (call.targetFunction.generatedFunction != nullptr);
         SOUL_ASSERT (call.targetFunction.parameters.size() == numArgs);
 
-        auto& fc = module.allocate<heart::FunctionCall> (call.context.location, targetVariable,
+        auto& fc = module.allocateStatement<heart::FunctionCall> (call.context.location, targetVariable,
                                                          call.targetFunction.generatedFunction);
 
         for (size_t i = 0; i < numArgs; ++i)
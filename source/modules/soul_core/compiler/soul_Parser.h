@@ -36,7 +36,7 @@ namespace Keyword
         X(struct_,    "struct")     X(import,     "import")     X(switch_,  "switch")     X(public_,    "public") \
         X(double_,    "double")     X(private_,   "private")    X(float32,  "float32")    X(float64,    "float64") \
         X(default_,   "default")    X(continue_,  "continue")   X(external, "external")   X(operator_,  "operator") \
-        X(processor,  "processor")  X(namespace_, "namespace")  X(connection, "connection")
+        X(processor,  "processor")  X(namespace_, "namespace")  X(connection, "connection")  X(float16, "float16")
 
     SOUL_KEYWORDS (SOUL_DECLARE_TOKEN)
 
@@ -85,6 +85,8 @@ struct StructuralParser   : public Tokeniser<Keyword::Matcher,
     {
         StructuralParser p (allocator, code, parentNamespace);
         p.parseTopLevelDecls (parentNamespace);
+        ++allocator.resolutionGeneration;
+        parentNamespace.lastResolutionGeneration = 0;
         return parentNamespace.subModules;
     }
 
@@ -96,6 +98,8 @@ struct StructuralParser   : public Tokeniser<Keyword::Matcher,
         StructuralParser p (allocator, itemToClone.context.location, parentNamespace);
         auto newNameID = allocator.identifiers.get (newName);
         p.newNameForFirstDecl = &newNameID;
+        ++allocator.resolutionGeneration;
+        parentNamespace.lastResolutionGeneration = 0;
 
         if (itemToClone.isProcessor())  return p.parseProcessorDecl (parentNamespace);
         if (itemToClone.isGraph())      return p.parseGraphDecl (parentNamespace);
@@ -111,6 +115,8 @@ struct StructuralParser   : public Tokeniser<Keyword::Matcher,
         SOUL_ASSERT (parentModule != nullptr);
 
         parentModule->isFullyResolved = false;
+        parentModule->lastResolutionGeneration = 0;
+        ++allocator.resolutionGeneration;
         StructuralParser p (allocator, functionToClone.context.location, *parentModule);
         auto functionList = parentModule->getFunctionList();
         SOUL_ASSERT (functionList != nullptr);
@@ -138,6 +144,52 @@ private:
     // done more elegantly in future...
     int ignoreGreaterThanToken = 0;
 
+    //==============================================================================
+    /** A bounded, packrat-style memo of speculative parses which have already been
+        tried at a position and failed.
+
+        The generic-bracket ambiguity is resolved by optimistically parsing an
+        expression after a '<' and backtracking when no matching '>' turns up, and
+        in a deeply-nested expression full of comparison operators each '<' gets
+        re-tried once per enclosing speculation, re-scanning the same tokens every
+        time. Remembering the failures, keyed on (token position, rule), means each
+        position can only fail once, which keeps machine-generated pathological
+        inputs linear.
+
+        Only failures are recorded: a successful speculative parse consumes tokens
+        and allocates AST nodes, so replaying one from a cache would mean storing
+        the nodes too - whereas a failed attempt leaves nothing behind but some
+        abandoned pool allocations, making it safe to skip wholesale. The ambient
+        ignoreGreaterThanToken depth doesn't need to be part of the key: an
+        attempt raises it for the duration of its own scan, and the parser only
+        ever tests it against zero, so an attempt's outcome is the same whatever
+        the level it started from. The table is cleared rather than allowed to
+        grow without bound if a big enough file manages to fill it.
+    */
+    enum class SpeculativeRule  { vectorSuffix };
+
+    static constexpr size_t maxSpeculationMemoEntries = 16384;
+    std::unordered_map<const char*, uint32_t> failedSpeculations;
+
+    static uint32_t getSpeculationRuleBit (SpeculativeRule rule)
+    {
+        return 1u << static_cast<uint32_t> (rule);
+    }
+
+    bool hasSpeculationAlreadyFailed (UTF8Reader position, SpeculativeRule rule) const
+    {
+        auto entry = failedSpeculations.find (position.getAddress());
+        return entry != failedSpeculations.end() && (entry->second & getSpeculationRuleBit (rule)) != 0;
+    }
+
+    void rememberFailedSpeculation (UTF8Reader position, SpeculativeRule rule)
+    {
+        if (failedSpeculations.size() >= maxSpeculationMemoEntries)
+            failedSpeculations.clear();
+
+        failedSpeculations[position.getAddress()] |= getSpeculationRuleBit (rule);
+    }
+
     enum class ParseTypeContext
     {
         variableType,
@@ -368,11 +420,8 @@ private:
 
         if (matchIf (Operator::openParen))
         {
-            if (isExternal)
-                declarationContext.throwError (Errors::functionCannotBeExternal());
-
             if (auto functions = module->getFunctionList())
-                functions->push_back (parseFunctionDeclaration (declarationContext, *type, name, context, genericWildcards));
+                functions->push_back (parseFunctionDeclaration (declarationContext, *type, name, context, genericWildcards, isExternal));
             else
                 declarationContext.throwError (module->isGraph() ? Errors::graphCannotContainFunctions()
                                                                  : Errors::noFunctionInThisScope());
@@ -938,17 +987,22 @@ private:
 
     AST::Function& parseFunctionDeclaration (const AST::Context& context, AST::Expression& returnType,
                                              Identifier name, const AST::Context& nameLocation,
-                                             std::vector<pool_ref<AST::QualifiedIdentifier>> genericWildcards)
+                                             std::vector<pool_ref<AST::QualifiedIdentifier>> genericWildcards,
+                                             bool isExternal = false)
     {
         if (AST::isResolvedAsType (returnType) && returnType.getConstness() == AST::Constness::definitelyConst)
             throwError (Errors::functionReturnTypeCannotBeConst());
 
+        if (isExternal && ! genericWildcards.empty())
+            throwError (Errors::externalFunctionCannotBeGeneric());
+
         auto& f = allocate<AST::Function> (context);
         ScopedScope scope (*this, f);
 
         f.name = name;
         f.nameLocation = nameLocation;
         f.returnType = returnType;
+        f.isExternal = isExternal;
         f.genericWildcards = std::move (genericWildcards);
 
         if (f.returnType != nullptr)
@@ -999,7 +1053,12 @@ private:
         }
 
         if (! matchIf (Operator::semicolon))
+        {
+            if (f.isExternal)
+                throwError (Errors::externalFunctionCannotHaveBody());
+
             f.block = parseBlock (f);
+        }
 
         return f;
     }
@@ -1036,7 +1095,7 @@ private:
         if (matches (Operator::openParen))     return matchEndOfStatement (parseFactor());
 
         if (matchesAny (Token::literalInt32, Token::literalInt64, Token::literalFloat64, Token::literalFloat32,
-                        Token::literalString, Operator::minus))
+                        Token::literalFloat16, Token::literalString, Operator::minus))
             return parseExpressionAsStatement (false);
 
         {
@@ -1276,7 +1335,7 @@ private:
                 // Handle the annoying case where some sloppy coder has written a
                 // minus sign without a space after it, e.g. (x -1)
                 if ((matchesAny (Token::literalInt32, Token::literalInt64) && literalIntValue < 0)
-                     || (matchesAny (Token::literalFloat64, Token::literalFloat32) && literalDoubleValue < 0))
+                     || (matchesAny (Token::literalFloat64, Token::literalFloat32, Token::literalFloat16) && literalDoubleValue < 0))
                 {
                     auto context = getContext();
                     a = createBinaryOperator (context, a, parseMultiplyDivide(), BinaryOp::Op::add);
@@ -1327,6 +1386,7 @@ private:
         if (matches (Token::literalInt64))     return createLiteral (Value::createInt64 (literalIntValue));
         if (matches (Token::literalFloat64))   return createLiteral (Value (literalDoubleValue));
         if (matches (Token::literalFloat32))   return createLiteral (Value ((float) literalDoubleValue));
+        if (matches (Token::literalFloat16))   return createLiteral (Value ((float) literalDoubleValue).castToTypeExpectingSuccess (Type (PrimitiveType::float16)));
         if (matches (Token::literalString))    return createLiteral (Value::createStringLiteral (allocator.stringDictionary.getHandleForString (currentStringValue)));
         if (matches (Keyword::true_))          return createLiteral (Value (true));
         if (matches (Keyword::false_))         return createLiteral (Value (false));
@@ -1338,8 +1398,136 @@ private:
         return parseSuffixes (parseQualifiedIdentifier());
     }
 
+    //==============================================================================
+    /** Consumes a long, plain run of numeric literals ("0.25f, -0.5f, ... )") as a
+        single packed array constant.
+
+        Generated sources routinely inline wavetables with tens of thousands of
+        elements, and building a pool-allocated AST::Constant per element inflates
+        every sample to well over a hundred bytes until the list is folded. This
+        scans the values straight into a flat buffer and hands back one Constant
+        holding the whole array - casting a constant array applies the same
+        elementwise conversions downstream that a comma-separated list of literal
+        constants would. Anything other than a literal followed by a comma or the
+        closing paren abandons the scan and re-parses normally, as do short lists,
+        where the generic path's flexibility matters more than its footprint.
+    */
+    static constexpr size_t minLiteralArrayRunLength = 128;
+
+    pool_ptr<AST::Expression> tryParseLiteralArrayRun()
+    {
+        if (! matchesAny (Token::literalInt32, Token::literalInt64, Token::literalFloat32, Token::literalFloat64))
+            return {};
+
+        auto context = getContext();
+        auto startPos = getCurrentTokeniserPosition();
+
+        std::vector<double> floatValues;
+        std::vector<int64_t> intValues;
+        bool allInts = true, hasFloat64 = false, hasInt64 = false, hasImpreciseInt = false;
+
+        for (;;)
+        {
+            if (matches (Token::literalInt32) || matches (Token::literalInt64))
+            {
+                if (matches (Token::literalInt64))
+                    hasInt64 = true;
+
+                if (allInts)
+                    intValues.push_back (literalIntValue);
+
+                // an int this big can't round-trip through a double, so if the rest
+                // of the list turns out to contain floats, the scan has to be abandoned
+                constexpr int64_t maxExactDouble = 1ll << 53;
+
+                if (literalIntValue >= maxExactDouble || literalIntValue <= -maxExactDouble)
+                    hasImpreciseInt = true;
+
+                floatValues.push_back (static_cast<double> (literalIntValue));
+            }
+            else if (matches (Token::literalFloat32))
+            {
+                // pre-rounded to float32, so that promotion to a float64 array
+                // can't change what the literal means
+                floatValues.push_back (static_cast<double> (static_cast<float> (literalDoubleValue)));
+                allInts = false;
+            }
+            else if (matches (Token::literalFloat64))
+            {
+                floatValues.push_back (literalDoubleValue);
+                allInts = false;
+                hasFloat64 = true;
+            }
+            else
+            {
+                break;
+            }
+
+            skip();
+
+            if (matchIf (Operator::comma))
+            {
+                if (floatValues.size() > AST::maxInitialiserListLength)
+                    context.throwError (Errors::tooManyInitialisers());
+
+                continue;
+            }
+
+            if (matches (Operator::closeParen)
+                 && floatValues.size() >= minLiteralArrayRunLength
+                 && ! (hasImpreciseInt && ! allInts))
+            {
+                skip();
+                return allocate<AST::Constant> (context, createLiteralArrayValue (floatValues, intValues, allInts, hasInt64, hasFloat64));
+            }
+
+            break;
+        }
+
+        resetPosition (startPos);
+        return {};
+    }
+
+    static Value createLiteralArrayValue (const std::vector<double>& floatValues, const std::vector<int64_t>& intValues,
+                                          bool allInts, bool hasInt64, bool hasFloat64)
+    {
+        auto size = static_cast<Type::ArraySize> (floatValues.size());
+
+        if (allInts)
+        {
+            if (hasInt64)
+                return Value::createFromRawData (Type (PrimitiveType::int64).createArray (size),
+                                                 intValues.data(), intValues.size() * sizeof (int64_t));
+
+            std::vector<int32_t> narrowed;
+            narrowed.reserve (intValues.size());
+
+            for (auto v : intValues)
+                narrowed.push_back (static_cast<int32_t> (v));
+
+            return Value::createFromRawData (Type (PrimitiveType::int32).createArray (size),
+                                             narrowed.data(), narrowed.size() * sizeof (int32_t));
+        }
+
+        if (hasFloat64)
+            return Value::createFromRawData (Type (PrimitiveType::float64).createArray (size),
+                                             floatValues.data(), floatValues.size() * sizeof (double));
+
+        std::vector<float> narrowed;
+        narrowed.reserve (floatValues.size());
+
+        for (auto v : floatValues)
+            narrowed.push_back (static_cast<float> (v));
+
+        return Value::createFromRawData (Type (PrimitiveType::float32).createArray (size),
+                                         narrowed.data(), narrowed.size() * sizeof (float));
+    }
+
     AST::Expression& parseParenthesisedExpression()
     {
+        if (auto literalArray = tryParseLiteralArrayRun())
+            return *literalArray;
+
         auto& e = parseExpression();
 
         if (matchIf (Operator::closeParen))
@@ -1399,6 +1587,14 @@ private:
     {
         auto& list = allocate<AST::CommaSeparatedList> (getContext());
 
+        if (auto literalArray = tryParseLiteralArrayRun())
+        {
+            // e.g. float[1024] (0.1f, 0.2f, ...) - the whole run becomes the single
+            // argument of the cast, which converts it elementwise
+            list.items.push_back (*literalArray);
+            return list;
+        }
+
         for (;;)
         {
             if (matchIf (Operator::closeParen))
@@ -1594,12 +1790,19 @@ private:
         if (! matchIf (Operator::lessThan))
             return parseArrayTypeSuffixes (elementType, parseContext);
 
+        if (hasSpeculationAlreadyFailed (startPos, SpeculativeRule::vectorSuffix))
+        {
+            resetPosition (startPos);
+            return elementType;
+        }
+
         ++ignoreGreaterThanToken;
         auto size = tryToParseExpressionIgnoringErrors();
         --ignoreGreaterThanToken;
 
         if (size == nullptr || ! matchIf (Operator::greaterThan))
         {
+            rememberFailedSpeculation (startPos, SpeculativeRule::vectorSuffix);
             resetPosition (startPos);
             return elementType;
         }
@@ -1647,6 +1850,7 @@ private:
         if (matchIf (Keyword::float_))   return parseVectorOrArrayTypeSuffixes (createConcreteType (context, PrimitiveType::float32),  parseContext);
         if (matchIf (Keyword::float32))  return parseVectorOrArrayTypeSuffixes (createConcreteType (context, PrimitiveType::float32),  parseContext);
         if (matchIf (Keyword::float64))  return parseVectorOrArrayTypeSuffixes (createConcreteType (context, PrimitiveType::float64),  parseContext);
+        if (matchIf (Keyword::float16))  return parseVectorOrArrayTypeSuffixes (createConcreteType (context, PrimitiveType::float16),  parseContext);
         if (matchIf (Keyword::void_))    return parseVectorOrArrayTypeSuffixes (createConcreteType (context, PrimitiveType::void_),    parseContext);
         if (matchIf (Keyword::int_))     return parseVectorOrArrayTypeSuffixes (createConcreteType (context, PrimitiveType::int32),    parseContext);
         if (matchIf (Keyword::int32))    return parseVectorOrArrayTypeSuffixes (createConcreteType (context, PrimitiveType::int32),    parseContext);
@@ -67,6 +67,26 @@ private:
         if (module.isFullyResolved)
             return runStats;
 
+        // Visiting the submodules with their dependencies first means most of them
+        // resolve completely on their first attempt, leaving the quiescence loop
+        // below to iterate only over genuinely cyclic groups
+        auto orderedSubModules = getSubModulesInDependencyOrder (module);
+
+        std::unordered_set<const AST::ModuleBase*> knownSubModules;
+
+        for (auto& sub : orderedSubModules)
+            knownSubModules.insert (std::addressof (sub.get()));
+
+        // If nothing in the program has changed since a previous attempt on this module
+        // got stuck, there's no point running the error-ignoring passes over it again -
+        // just report that it still contains unresolved items so that the caller doesn't
+        // mark itself as fully resolved.
+        if (ignoreTypeAndConstantErrors && module.lastResolutionGeneration == allocator.resolutionGeneration)
+        {
+            ++runStats.numFailures;
+            return runStats;
+        }
+
         for (;;)
         {
             runStats.clear();
@@ -83,11 +103,27 @@ private:
             if (runStats.numReplaced == 0)
                 tryPass<GenericFunctionResolver> (runStats, true);
 
-            // Can't use a range-based-for here because the array will change during the loop
-            for (size_t i = 0; i < module.getSubModules().size(); ++i)
-                runStats.add (ResolutionPass (allocator, module.getSubModules()[i])
+            // Can't use a range-based-for here because the array can grow during the loop
+            for (size_t i = 0; i < orderedSubModules.size(); ++i)
+                runStats.add (ResolutionPass (allocator, orderedSubModules[i])
                                 .run (ignoreTypeAndConstantErrors));
 
+            // Resolving can append newly-specialised submodules - pick those up and
+            // add them to the schedule for subsequent iterations
+            for (size_t i = 0; i < module.getSubModules().size(); ++i)
+            {
+                auto sub = module.getSubModules()[i];
+
+                if (knownSubModules.insert (std::addressof (sub.get())).second)
+                {
+                    orderedSubModules.push_back (sub);
+                    runStats.add (ResolutionPass (allocator, sub).run (ignoreTypeAndConstantErrors));
+                }
+            }
+
+            if (runStats.numReplaced != 0)
+                ++allocator.resolutionGeneration;
+
             if (runStats.numFailures == 0)
                 break;
 
@@ -95,7 +131,10 @@ private:
             {
                 // failed to resolve anything new, so can't get any further..
                 if (ignoreTypeAndConstantErrors)
+                {
+                    module.lastResolutionGeneration = allocator.resolutionGeneration;
                     return runStats;
+                }
 
                 tryPass<FunctionResolver> (runStats, false);
                 tryPass<QualifiedIdentifierResolver> (runStats, false);
@@ -109,6 +148,7 @@ private:
 
         FullResolver (*this).visitObject (module);
         module.isFullyResolved = true;
+        module.lastResolutionGeneration = allocator.resolutionGeneration;
         return runStats;
     }
 
@@ -121,6 +161,100 @@ private:
         runStats.numReplaced += pass.itemsReplaced;
     }
 
+    //==============================================================================
+    /** Returns a module's submodules ordered so that whenever one refers to a sibling,
+        the sibling is visited first.
+
+        The references are found by scanning for identifier paths whose leading section
+        names a sibling, which over-approximates the true dependencies, but that only
+        affects scheduling - correctness still comes from the quiescence loop. Groups
+        of mutually-dependent modules stay in their original relative order.
+    */
+    static std::vector<pool_ref<AST::ModuleBase>> getSubModulesInDependencyOrder (const AST::ModuleBase& parent)
+    {
+        std::vector<pool_ref<AST::ModuleBase>> result;
+
+        for (auto& m : parent.getSubModules())
+            result.push_back (m);
+
+        if (result.size() < 2)
+            return result;
+
+        std::unordered_map<std::string, size_t> siblingIndexes;
+
+        for (size_t i = 0; i < result.size(); ++i)
+            if (result[i]->name.isValid())
+                siblingIndexes.emplace (result[i]->name.toString(), i);
+
+        struct ReferenceScanner  : public ASTVisitor
+        {
+            using super = ASTVisitor;
+
+            const std::unordered_map<std::string, size_t>* siblingIndexes = nullptr;
+            std::unordered_set<size_t>* dependencies = nullptr;
+            size_t selfIndex = 0;
+
+            void visit (AST::QualifiedIdentifier& q) override
+            {
+                super::visit (q);
+
+                if (! q.path.empty())
+                {
+                    auto sibling = siblingIndexes->find (q.path.getFirstPart().toString());
+
+                    if (sibling != siblingIndexes->end() && sibling->second != selfIndex)
+                        dependencies->insert (sibling->second);
+                }
+            }
+        };
+
+        std::vector<std::unordered_set<size_t>> dependencies (result.size());
+
+        for (size_t i = 0; i < result.size(); ++i)
+        {
+            ReferenceScanner scanner;
+            scanner.siblingIndexes = std::addressof (siblingIndexes);
+            scanner.dependencies = std::addressof (dependencies[i]);
+            scanner.selfIndex = i;
+            scanner.visitObject (result[i].get());
+        }
+
+        std::vector<pool_ref<AST::ModuleBase>> ordered;
+        ordered.reserve (result.size());
+        std::vector<bool> emitted (result.size(), false);
+
+        auto canBeEmitted = [&] (size_t index)
+        {
+            for (auto dep : dependencies[index])
+                if (! emitted[dep])
+                    return false;
+
+            return true;
+        };
+
+        for (bool anyEmitted = true; anyEmitted;)
+        {
+            anyEmitted = false;
+
+            for (size_t i = 0; i < result.size(); ++i)
+            {
+                if (! emitted[i] && canBeEmitted (i))
+                {
+                    emitted[i] = true;
+                    ordered.push_back (result[i]);
+                    anyEmitted = true;
+                }
+            }
+        }
+
+        // Anything left over is part of a dependency cycle
+        for (size_t i = 0; i < result.size(); ++i)
+            if (! emitted[i])
+                ordered.push_back (result[i]);
+
+        return ordered;
+    }
+
     //==============================================================================
     struct ErrorIgnoringRewritingASTVisitor  : public RewritingASTVisitor
     {
@@ -706,9 +840,9 @@ private:
                     return e;
 
                 if (auto c = e->getAsConstant())
-                    if (c != e)
-                        return createConstant (e->context, c->value);
-
+                    if (c != e && ! c->value.getType().isArray())  // array constants stay as variable references
+                        return createConstant (e->context, c->value);   // (see the note in visit(VariableRef)), which
+                                                                        // also avoids cloning big tables at each use
                 return e;
             }
 
@@ -748,6 +882,52 @@ private:
             return e;
         }
 
+        AST::Expression& visit (AST::ArrayElementRef& s) override
+        {
+            super::visit (s);
+
+            if (failIfNotResolved (s) || isUsedAsReference)
+                return s;
+
+            if (auto arrayConstant = s.object->getAsConstant())
+            {
+                auto arrayType = arrayConstant->getResultType();
+
+                if (arrayType.isArrayOrVector() && ! arrayType.isUnsizedArray())
+                {
+                    // Elements of a constant aggregate are read straight out of its packed
+                    // data, so a lookup into a big table never clones the table itself
+                    if (s.isSlice)
+                    {
+                        if (s.isSliceRangeValid())
+                        {
+                            auto range = s.getResolvedSliceRange();
+
+                            if (range.end == range.start + 1)
+                                return createConstant (s.context, arrayConstant->value.getSubElement (range.start));
+
+                            return createConstant (s.context, arrayConstant->value.getSlice (range.start, range.end));
+                        }
+                    }
+                    else if (auto index = s.startIndex->getAsConstant())
+                    {
+                        auto& indexType = index->value.getType();
+
+                        if (indexType.isPrimitiveInteger() || indexType.isBoundedInt())
+                        {
+                            auto fixedIndex = index->value.getAsInt64();
+
+                            // out-of-range indexes are left unfolded for the checks later on to report
+                            if (arrayType.isValidArrayOrVectorIndex (fixedIndex))
+                                return createConstant (s.context, arrayConstant->value.getSubElement (arrayType.convertArrayOrVectorIndexToValidRange (fixedIndex)));
+                        }
+                    }
+                }
+            }
+
+            return s;
+        }
+
         AST::Expression& visit (AST::TernaryOp& t) override
         {
             super::visit (t);
@@ -1989,9 +2169,24 @@ private:
             auto parentScope = genericFunction.getParentScope();
             SOUL_ASSERT (parentScope != nullptr);
 
+            AST::Allocator::SpecialisedFunctionKey cacheKey { std::addressof (genericFunction),
+                                                              std::addressof (specialisedFunctionName.toString()) };
+
+            auto cached = allocator.specialisedFunctions.find (cacheKey);
+
+            if (cached != allocator.specialisedFunctions.end())
+                return cached->second;
+
+            // The memo-table only knows about specialisations made through this path, so
+            // a miss still has to check the scope for ones created any other way
             for (auto& f : parentScope->getFunctions())
+            {
                 if (f->name == specialisedFunctionName && f->originalGenericFunction == genericFunction)
+                {
+                    allocator.specialisedFunctions[cacheKey] = f;
                     return f;
+                }
+            }
 
             auto& newFunction = StructuralParser::cloneFunction (allocator, genericFunction);
             newFunction.name = specialisedFunctionName;
@@ -2007,6 +2202,7 @@ private:
                 return {};
             }
 
+            allocator.specialisedFunctions[cacheKey] = newFunction;
             return newFunction;
         }
 
@@ -2085,14 +2281,17 @@ private:
             if (function.context.location.sourceCode->isInternal)
             {
                 messages.messages.push_back ({ "Could not resolve argument types for function call " + call.getDescription (function.name),
-                                               call.context.location, CompileMessage::Type::error });
+                                               call.context.location, CompileMessage::Type::error,
+                                               CompileMessage::Category::none, nullptr, {} });
             }
             else
             {
                 messages.messages.push_back ({ "Failed to resolve generic function call " + call.getDescription (function.name),
-                                               call.context.location, CompileMessage::Type::error });
+                                               call.context.location, CompileMessage::Type::error,
+                                               CompileMessage::Category::none, nullptr, {} });
 
-                messages.messages.push_back ({ errorMessage, errorLocation.location, CompileMessage::Type::error });
+                messages.messages.push_back ({ errorMessage, errorLocation.location, CompileMessage::Type::error,
+                                               CompileMessage::Category::none, nullptr, {} });
             }
 
             soul::throwError (messages);
@@ -32,10 +32,21 @@ CompileMessageList::~CompileMessageList() = default;
 bool CompileMessage::isWarning() const                  { return type == Type::warning; }
 bool CompileMessage::isError() const                    { return type == Type::error || isInternalCompilerError(); }
 bool CompileMessage::isInternalCompilerError() const    { return type == Type::internalCompilerError; }
+bool CompileMessage::isRemark() const                   { return type == Type::remark; }
 
 CompileMessage CompileMessage::withLocation (CodeLocation l) const
 {
-    return { description, std::move (l), type };
+    auto m = *this;
+    m.location = std::move (l);
+    return m;
+}
+
+std::string CompileMessage::getDescription() const
+{
+    if (unformattedText != nullptr)
+        return CompileMessageHelpers::formatMessage (unformattedText, arguments);
+
+    return description;
 }
 
 std::string CompileMessage::getFullDescriptionWithoutFilename() const
@@ -45,7 +56,7 @@ std::string CompileMessage::getFullDescriptionWithoutFilename() const
     if (hasPosition())
         filename = getPositionString() + ": ";
 
-    return filename + getSeverity() + ": " + description;
+    return filename + getSeverity() + ": " + getDescription();
 }
 
 std::string CompileMessage::getFullDescription() const
@@ -58,7 +69,7 @@ std::string CompileMessage::getFullDescription() const
     if (hasPosition())
         filename += ":" + getPositionString();
 
-    return filename + ": " + getSeverity() + ": " + description;
+    return filename + ": " + getSeverity() + ": " + getDescription();
 }
 
 bool CompileMessage::hasPosition() const
@@ -79,6 +90,7 @@ std::string CompileMessage::getSeverity() const
 {
     if (isError())    return "error";
     if (isWarning())  return "warning";
+    if (isRemark())   return "remark";
 
     SOUL_ASSERT_FALSE;
     return {};
@@ -119,12 +131,17 @@ void CompileMessageList::add (const CompileMessage& message)
 
 void CompileMessageList::addError (const std::string& desc, CodeLocation location)
 {
-    add ({ desc, location, CompileMessage::Type::error });
+    add ({ desc, location, CompileMessage::Type::error, CompileMessage::Category::none, nullptr, {} });
 }
 
 void CompileMessageList::addWarning (const std::string& desc, CodeLocation location)
 {
-    add ({ desc, location, CompileMessage::Type::warning });
+    add ({ desc, location, CompileMessage::Type::warning, CompileMessage::Category::none, nullptr, {} });
+}
+
+void CompileMessageList::addRemark (const std::string& desc, CodeLocation location)
+{
+    add ({ desc, location, CompileMessage::Type::remark, CompileMessage::Category::none, nullptr, {} });
 }
 
 void CompileMessageList::add (const CompileMessageList& other)
@@ -141,7 +158,7 @@ void CompileMessageList::add (const CompileMessageGroup& group)
 
 bool CompileMessageList::hasErrorsOrWarnings() const
 {
-    return ! messages.empty();
+    return hasErrors() || hasWarnings();
 }
 
 bool CompileMessageList::hasErrors() const
@@ -171,6 +188,15 @@ bool CompileMessageList::hasInternalCompilerErrors() const
     return false;
 }
 
+bool CompileMessageList::hasRemarks() const
+{
+    for (auto& m : messages)
+        if (m.isRemark())
+            return true;
+
+    return false;
+}
+
 void CompileMessageList::clear()
 {
     messages.clear();
@@ -269,10 +295,37 @@ void emitMessage (CompileMessage m)
     throwError (messageGroup);
 }
 
+//==============================================================================
+static thread_local bool optimisationRemarksEnabled = false;
+
+OptimisationRemarkScope::OptimisationRemarkScope (bool shouldEnable)
+    : wasEnabled (optimisationRemarksEnabled)
+{
+    optimisationRemarksEnabled = shouldEnable;
+}
+
+OptimisationRemarkScope::~OptimisationRemarkScope()
+{
+    optimisationRemarksEnabled = wasEnabled;
+}
+
+bool areOptimisationRemarksEnabled()
+{
+    return optimisationRemarksEnabled;
+}
+
+void emitOptimisationRemark (CodeLocation location, std::string text)
+{
+    if (optimisationRemarksEnabled)
+        emitMessage ({ std::move (text), std::move (location), CompileMessage::Type::remark,
+                       CompileMessage::Category::none, nullptr, {} });
+}
+
 [[noreturn]] void throwInternalCompilerError (const std::string& message)
 {
     soul::throwError ({ "Internal compiler error: " + choc::text::addDoubleQuotes (message),
-                        CodeLocation(), CompileMessage::Type::internalCompilerError });
+                        CodeLocation(), CompileMessage::Type::internalCompilerError,
+                        CompileMessage::Category::none, nullptr, {} });
 }
 
 [[noreturn]] void throwInternalCompilerError (const char* location, int line)
@@ -27,6 +27,12 @@ struct CompileMessage  final
     bool isWarning() const;
     bool isError() const;
     bool isInternalCompilerError() const;
+    bool isRemark() const;
+
+    /** Returns the human-readable message text, rendering it from the description
+        tables on demand if this message was created lazily by Errors or Warnings.
+    */
+    std::string getDescription() const;
 
     std::string getFullDescription() const;
     std::string getFullDescriptionWithoutFilename() const;
@@ -43,7 +49,14 @@ struct CompileMessage  final
     {
         error,
         warning,
-        internalCompilerError
+        internalCompilerError,
+
+        /** A purely informational note about an optimisation decision - what got
+            inlined, fused etc, and why something that looks optimisable wasn't.
+            Remarks never indicate a problem with the program, and are only emitted
+            when CompileMessageList::includeOptimisationRemarks is set.
+        */
+        remark
     };
 
     enum class Category
@@ -59,6 +72,15 @@ struct CompileMessage  final
     CodeLocation location;
     Type type = Type::error;
     Category category = Category::none;
+
+    /** Messages created by the Errors/Warnings tables don't format their text up-front:
+        they just capture a pointer to the static table entry plus the stringified
+        arguments, and getDescription() does the substitution if anyone actually asks
+        for it. Speculative compiles that only care about success never pay for the
+        formatting. When unformattedText is null, description holds the final text.
+    */
+    const char* unformattedText = nullptr;
+    std::vector<std::string> arguments;
 };
 
 struct CompileMessageGroup
@@ -80,11 +102,13 @@ struct CompileMessageList  final
 
     void addError (const std::string& desc, CodeLocation);
     void addWarning (const std::string& desc, CodeLocation);
+    void addRemark (const std::string& desc, CodeLocation);
 
     bool hasErrors() const;
     bool hasWarnings() const;
     bool hasErrorsOrWarnings() const;
     bool hasInternalCompilerErrors() const;
+    bool hasRemarks() const;
 
     void clear();
 
@@ -100,6 +124,20 @@ struct CompileMessageList  final
 
     /** The raw list of messages. */
     std::vector<CompileMessage> messages;
+
+    /** If a report is attached here before a build, the compiler fills it in with
+        a hierarchical breakdown of the time spent in each pass. Leave it null to
+        skip timing collection entirely.
+    */
+    std::shared_ptr<BuildTimingReport> timingReport;
+
+    /** Set this before a build to make the optimisation passes add remark-type
+        messages to the list describing what they did - which functions were
+        inlined, which connections were fused, and the reason where a likely-looking
+        candidate was left alone. Off by default, as a big graph can produce a lot
+        of them.
+    */
+    bool includeOptimisationRemarks = false;
 };
 
 //==============================================================================
@@ -142,5 +180,29 @@ void emitMessage (const CompileMessageGroup&);
 /** Sends a set of error messages to the current message handler and throws an AbortCompilationException. */
 [[noreturn]] void throwError (const CompileMessageGroup&);
 
+//==============================================================================
+/** An RAII class which enables optimisation remarks on the current thread for as
+    long as it's alive. The compiler creates one of these around its optimisation
+    passes when CompileMessageList::includeOptimisationRemarks is set.
+*/
+struct OptimisationRemarkScope
+{
+    OptimisationRemarkScope (bool shouldEnable);
+    ~OptimisationRemarkScope();
+
+private:
+    const bool wasEnabled;
+};
+
+/** True if a remark emitted now would go anywhere - passes should check this before
+    building a remark string, so that normal builds don't pay for the formatting.
+*/
+bool areOptimisationRemarksEnabled();
+
+/** Sends a remark-type message to the current message handler, if remarks are
+    enabled on this thread.
+*/
+void emitOptimisationRemark (CodeLocation, std::string text);
+
 
 } // namespace soul
@@ -0,0 +1,201 @@
+/*
+    _____ _____ _____ __
+   |   __|     |  |  |  |      The SOUL language
+   |__   |  |  |  |  |  |__    Copyright (c) 2019 - ROLI Ltd.
+   |_____|_____|_____|_____|
+
+   The code in this file is provided under the terms of the ISC license:
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose
+   with or without fee is hereby granted, provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#if ! SOUL_INSIDE_CORE_CPP
+ #error "Don't add this cpp file to your build, it gets included indirectly by soul_core.cpp"
+#endif
+
+#ifndef _WIN32
+ #include <sys/resource.h>
+#endif
+
+namespace soul
+{
+
+CompileTimeBenchmark::Result CompileTimeBenchmark::profileBuild (std::string name, const BuildBundle& bundle)
+{
+    Result result;
+    result.name = std::move (name);
+
+    using clock = std::chrono::high_resolution_clock;
+    auto startTime = clock::now();
+    auto stageStartTime = startTime;
+
+    auto closeCurrentStage = [&] (clock::time_point now)
+    {
+        if (! result.stages.empty())
+            result.stages.back().seconds = std::chrono::duration<double> (now - stageStartTime).count();
+    };
+
+    BuildStageMonitor monitor;
+
+    monitor.stageChanged = [&] (const char* stageName)
+    {
+        auto now = clock::now();
+        closeCurrentStage (now);
+        result.stages.push_back ({ stageName, 0 });
+        stageStartTime = now;
+    };
+
+    CompileMessageList messageList;
+    auto program = Compiler::build (messageList, bundle, std::addressof (monitor));
+
+    auto endTime = clock::now();
+    closeCurrentStage (endTime);
+
+    result.totalSeconds = std::chrono::duration<double> (endTime - startTime).count();
+    result.peakResidentSetBytes = getPeakResidentSetBytes();
+    result.succeeded = ! (program.isEmpty() || messageList.hasErrors());
+    return result;
+}
+
+std::vector<CompileTimeBenchmark::Result> CompileTimeBenchmark::profileBuilds (ArrayView<BuildBundle> bundles)
+{
+    std::vector<Result> results;
+    results.reserve (bundles.size());
+    size_t index = 0;
+
+    for (auto& bundle : bundles)
+    {
+        auto name = ! bundle.sourceFiles.empty() && ! bundle.sourceFiles.front().filename.empty()
+                       ? bundle.sourceFiles.front().filename
+                       : "bundle" + std::to_string (index);
+
+        results.push_back (profileBuild (std::move (name), bundle));
+        ++index;
+    }
+
+    return results;
+}
+
+BuildBundle CompileTimeBenchmark::createSyntheticStressBundle (uint32_t numProcessors,
+                                                               uint32_t numFunctionsPerProcessor)
+{
+    SOUL_ASSERT (numProcessors > 0);
+
+    constexpr choc::text::CodePrinter::NewLine newLine = {};
+    constexpr choc::text::CodePrinter::BlankLine blankLine = {};
+
+    choc::text::CodePrinter code;
+
+    code << "processor Source" << newLine
+         << "{" << newLine
+         << "    output stream float out;" << newLine
+         << "    void run()  { loop { out << 0.0f; advance(); } }" << newLine
+         << "}" << blankLine;
+
+    for (uint32_t i = 0; i < numProcessors; ++i)
+    {
+        code << "processor Stage" << i << newLine
+             << "{" << newLine
+             << "    input stream float in;" << newLine
+             << "    output stream float out;" << newLine;
+
+        for (uint32_t f = 0; f < numFunctionsPerProcessor; ++f)
+        {
+            code << "    float fn" << f << " (float x)  { return x * 0.5f";
+
+            if (f != 0)
+                code << " + fn" << (f - 1) << " (x * 0.25f)";
+
+            code << "; }" << newLine;
+        }
+
+        if (numFunctionsPerProcessor > 0)
+            code << "    void run()  { loop { out << fn" << (numFunctionsPerProcessor - 1)
+                 << " (in); advance(); } }" << newLine;
+        else
+            code << "    void run()  { loop { out << in; advance(); } }" << newLine;
+
+        code << "}" << blankLine;
+    }
+
+    code << "graph Main  [[ main ]]" << newLine
+         << "{" << newLine
+         << "    output stream float out;" << newLine
+         << "    let source = Source;" << newLine;
+
+    for (uint32_t i = 0; i < numProcessors; ++i)
+        code << "    let stage" << i << " = Stage" << i << ";" << newLine;
+
+    code << "    connection" << newLine
+         << "    {" << newLine
+         << "        source.out -> stage0.in;" << newLine;
+
+    for (uint32_t i = 1; i < numProcessors; ++i)
+        code << "        stage" << (i - 1) << ".out -> stage" << i << ".in;" << newLine;
+
+    code << "        stage" << (numProcessors - 1) << ".out -> out;" << newLine
+         << "    }" << newLine
+         << "}" << newLine;
+
+    BuildBundle bundle;
+    bundle.sourceFiles.push_back ({ "stress_" + std::to_string (numProcessors)
+                                      + "x" + std::to_string (numFunctionsPerProcessor) + ".soul",
+                                    code.toString() });
+    bundle.settings.sampleRate = 44100.0;
+    bundle.settings.maxBlockSize = 512;
+    return bundle;
+}
+
+std::string CompileTimeBenchmark::toJSON (ArrayView<Result> results)
+{
+    auto resultArray = choc::value::createEmptyArray();
+
+    for (auto& result : results)
+    {
+        auto stages = choc::value::createObject ({});
+
+        for (auto& stage : result.stages)
+            stages.addMember (stage.name, stage.seconds);
+
+        resultArray.addArrayElement (choc::value::createObject ({},
+                                        "name", result.name,
+                                        "success", result.succeeded,
+                                        "totalSeconds", result.totalSeconds,
+                                        "peakRSSBytes", (int64_t) result.peakResidentSetBytes,
+                                        "stages", stages));
+    }
+
+    return choc::json::toString (choc::value::createObject ({},
+                                    "soulVersion", getLibraryVersion().toString(),
+                                    "results", resultArray));
+}
+
+uint64_t CompileTimeBenchmark::getPeakResidentSetBytes()
+{
+   #ifdef _WIN32
+    return 0;
+   #else
+    rusage usage = {};
+
+    if (getrusage (RUSAGE_SELF, std::addressof (usage)) != 0)
+        return 0;
+
+    // ru_maxrss is in kilobytes on Linux and BSD, but in bytes on Darwin
+   #ifdef __APPLE__
+    return (uint64_t) usage.ru_maxrss;
+   #else
+    return (uint64_t) usage.ru_maxrss * 1024;
+   #endif
+   #endif
+}
+
+} // namespace soul
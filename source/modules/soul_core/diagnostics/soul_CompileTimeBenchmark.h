@@ -0,0 +1,81 @@
+/*
+    _____ _____ _____ __
+   |   __|     |  |  |  |      The SOUL language
+   |__   |  |  |  |  |  |__    Copyright (c) 2019 - ROLI Ltd.
+   |_____|_____|_____|_____|
+
+   The code in this file is provided under the terms of the ISC license:
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose
+   with or without fee is hereby granted, provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+namespace soul
+{
+
+//==============================================================================
+/**
+    Measures where the compiler spends its time, for tracking compile-time
+    regressions between releases.
+
+    A benchmark run compiles a corpus of BuildBundles - typically the example
+    patches plus a few synthetic stress cases from createSyntheticStressBundle() -
+    recording the wall time of each build stage reported through BuildStageMonitor
+    along with the process's peak resident set size. The whole suite can then be
+    emitted as a JSON document for a CI job to diff against previous runs.
+*/
+struct CompileTimeBenchmark
+{
+    /** The wall time spent in one of the compiler's stages. */
+    struct Stage
+    {
+        std::string name;
+        double seconds = 0;
+    };
+
+    /** The measurements taken from one build. */
+    struct Result
+    {
+        std::string name;                   /**< The name that was given to the bundle. */
+        std::vector<Stage> stages;          /**< Per-stage wall times, in the order the stages ran. */
+        double totalSeconds = 0;            /**< Wall time of the whole build. */
+        uint64_t peakResidentSetBytes = 0;  /**< The process's peak RSS when the build finished, or 0 if unavailable. */
+        bool succeeded = false;             /**< False if the build produced errors or an empty program. */
+    };
+
+    /** Builds the bundle once and returns its timings. */
+    static Result profileBuild (std::string name, const BuildBundle&);
+
+    /** Builds each of a set of bundles in turn, returning all the results.
+        The bundles are named "bundle0", "bundle1"... unless their first source
+        file has a filename to use instead.
+    */
+    static std::vector<Result> profileBuilds (ArrayView<BuildBundle>);
+
+    /** Returns a generated bundle containing a chain of processors, each with a
+        pile of functions, for exercising the compiler at sizes well beyond the
+        shipped examples.
+    */
+    static BuildBundle createSyntheticStressBundle (uint32_t numProcessors,
+                                                    uint32_t numFunctionsPerProcessor);
+
+    /** Converts a set of results to a JSON document which also records the
+        library version, so that runs from different releases can be compared.
+    */
+    static std::string toJSON (ArrayView<Result>);
+
+    /** Returns the peak resident set size of the calling process, or zero on
+        platforms where this isn't available.
+    */
+    static uint64_t getPeakResidentSetBytes();
+};
+
+} // namespace soul
@@ -112,6 +112,7 @@ namespace soul
     X(unresolvedAnnotation,                 "Cannot resolve constant value in annotation") \
     X(illegalTypeForEndpoint,               "Only primitives or vectors supported by this endpoint type") \
     X(voidCannotBeUsedForEndpoint,          "void is not a valid endpoint type") \
+    X(float16CannotBeUsedForStream,         "float16 is a storage format, so stream endpoints must use float32 or float64") \
     X(noMultipleTypesOnEndpoint,            "Multiple data types not supported by this endpoint type") \
     X(endpointHasMultipleTypes,             "This endpoint has more than one type") \
     X(incompatibleRatesOnEndpoints,         "Endpoints have incompatible sample rates: $0$ and $1$") \
@@ -176,7 +177,7 @@ namespace soul
     X(latencyOnlyForProcessor,              "The processor.latency value can only be declared in a processor") \
     X(latencyAlreadyDeclared,               "The processor.latency value must not be set more than once") \
     X(cannotReferenceOtherProcessorVar,     "Cannot reference a mutable variable belonging to another processor") \
-    X(externalOnlyAllowedOnStateVars,       "The 'external' flag can only be applied to state variables") \
+    X(externalOnlyAllowedOnStateVars,       "The 'external' flag can only be applied to state variables and function declarations") \
     X(wrongTypeForUnary,                    "Illegal type for unary operator") \
     X(typeTooBig,                           "Type size ($0$) exceeds the maximum permitted ($1$)") \
     X(nonConstInNamespace,                  "Only constant variables can be declared inside a namespace") \
@@ -192,7 +193,9 @@ namespace soul
     X(nonConstArraySize,                    "Expected a constant value for the array size") \
     X(negativeLoopCount,                    "Number of iterations must be a positive number") \
     X(preIncDecCollision,                   "Variables which have the ++ or -- operator applied can not be used twice within the same statement") \
-    X(functionCannotBeExternal,             "A function declaration cannot be marked 'external'") \
+    X(externalFunctionCannotHaveBody,       "External functions are implemented by the host, so cannot declare a body") \
+    X(externalFunctionCannotBeGeneric,      "External functions cannot be generic") \
+    X(externalFunctionInvalidType,          "The type $Q0$ cannot cross an external function boundary") \
     X(noConstOnExternals,                   "External declarations do not require the 'const' keyword") \
     X(usingCannotBeReference,               "Using declarations cannot be references") \
     X(expectedUnqualifiedName,              "This name cannot have a namespace qualifier") \
@@ -356,17 +359,30 @@ private:
     }
 
 public:
-    template <typename... Args>
-    static CompileMessage createMessage (CompileMessage::Category category, CodeLocation location,
-                                         CompileMessage::Type type, const char* text, Args&&... args)
+    /** Renders a description-table entry with a set of stringified arguments - this is
+        what CompileMessage::getDescription() calls when a lazily-created message is
+        actually displayed.
+    */
+    static std::string formatMessage (const char* text, const std::vector<std::string>& stringArgs)
     {
         std::string result (text);
-        std::vector<std::string> stringArgs { convertToString (args)... };
 
         for (size_t i = 0; i < stringArgs.size(); ++i)
             result = replaceArgument (result, i, stringArgs[i]);
 
-        return CompileMessage { trim (result), location, type, category };
+        return trim (result);
+    }
+
+    /** The message captures the table entry and its arguments rather than formatting
+        them - the arguments are stringified here because they usually refer to
+        transient AST objects, but the substitution and trimming is deferred until the
+        text is asked for.
+    */
+    template <typename... Args>
+    static CompileMessage createMessage (CompileMessage::Category category, CodeLocation location,
+                                         CompileMessage::Type type, const char* text, Args&&... args)
+    {
+        return CompileMessage { {}, location, type, category, text, { convertToString (args)... } };
     }
 
     template <typename... Args>
@@ -0,0 +1,173 @@
+/*
+    _____ _____ _____ __
+   |   __|     |  |  |  |      The SOUL language
+   |__   |  |  |  |  |  |__    Copyright (c) 2019 - ROLI Ltd.
+   |_____|_____|_____|_____|
+
+   The code in this file is provided under the terms of the ISC license:
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose
+   with or without fee is hereby granted, provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#if ! SOUL_INSIDE_CORE_CPP
+ #error "Don't add this cpp file to your build, it gets included indirectly by soul_core.cpp"
+#endif
+
+#ifdef __linux__
+ #include <linux/perf_event.h>
+ #include <sys/ioctl.h>
+ #include <sys/syscall.h>
+ #include <unistd.h>
+#endif
+
+namespace soul
+{
+
+PerformanceCounterSet::PerformanceCounterSet() = default;
+PerformanceCounterSet::~PerformanceCounterSet()     { close(); }
+
+#ifdef __linux__
+
+static int openPerfCounter (uint32_t type, uint64_t config, int groupFD)
+{
+    perf_event_attr attr;
+    memset (std::addressof (attr), 0, sizeof (attr));
+    attr.size = sizeof (attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = groupFD < 0 ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+
+    return static_cast<int> (syscall (__NR_perf_event_open, std::addressof (attr), 0, -1, groupFD, 0));
+}
+
+bool PerformanceCounterSet::open()
+{
+    close();
+
+    struct EventDescription { uint32_t type; uint64_t config; };
+
+    // Slot order matches the Counts members. Cycles leads the group; the
+    // cache and branch events are best-effort, as not every core exposes them
+    static constexpr EventDescription events[numCounterSlots] =
+    {
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D
+                               | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                               | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES }
+    };
+
+    int groupFD = -1;
+    uint32_t readIndex = 0;
+
+    for (uint32_t slot = 0; slot < numCounterSlots; ++slot)
+    {
+        auto fd = openPerfCounter (events[slot].type, events[slot].config, groupFD);
+
+        if (fd >= 0)
+        {
+            counterFDs[slot] = fd;
+            readOrder[slot] = static_cast<int> (readIndex++);
+
+            if (groupFD < 0)
+                groupFD = fd;
+        }
+        else if (slot < 2)
+        {
+            // cycles and instructions are the baseline every PMU provides - if
+            // even those are refused, there's no usable access at all
+            close();
+            return false;
+        }
+    }
+
+    numOpenCounters = readIndex;
+    return true;
+}
+
+void PerformanceCounterSet::close()
+{
+    for (auto& fd : counterFDs)
+    {
+        if (fd >= 0)
+            ::close (fd);
+
+        fd = -1;
+    }
+
+    for (auto& index : readOrder)
+        index = -1;
+
+    numOpenCounters = 0;
+}
+
+void PerformanceCounterSet::begin()
+{
+    if (! isOpen())
+        return;
+
+    ioctl (counterFDs[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl (counterFDs[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+PerformanceCounterSet::Counts PerformanceCounterSet::end()
+{
+    Counts counts;
+
+    if (! isOpen())
+        return counts;
+
+    ioctl (counterFDs[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    // PERF_FORMAT_GROUP reads the whole group coherently in creation order:
+    // a count of events, then one value per open counter
+    uint64_t buffer[1 + numCounterSlots] = {};
+
+    if (read (counterFDs[0], buffer, sizeof (buffer)) <= 0)
+        return counts;
+
+    auto getValue = [&] (uint32_t slot) -> uint64_t
+    {
+        auto index = readOrder[slot];
+        return index >= 0 && static_cast<uint64_t> (index) < buffer[0] ? buffer[1 + index] : 0;
+    };
+
+    counts.cycles               = getValue (0);
+    counts.instructions         = getValue (1);
+    counts.l1dCacheMisses       = getValue (2);
+    counts.lastLevelCacheMisses = getValue (3);
+    counts.branchMispredicts    = getValue (4);
+    return counts;
+}
+
+#else
+
+bool PerformanceCounterSet::open()       { return false; }
+void PerformanceCounterSet::close()      {}
+void PerformanceCounterSet::begin()      {}
+
+PerformanceCounterSet::Counts PerformanceCounterSet::end()   { return {}; }
+
+#endif
+
+bool PerformanceCounterSet::isSupported()
+{
+    PerformanceCounterSet probe;
+    return probe.open();
+}
+
+} // namespace soul
@@ -0,0 +1,95 @@
+/*
+    _____ _____ _____ __
+   |   __|     |  |  |  |      The SOUL language
+   |__   |  |  |  |  |  |__    Copyright (c) 2019 - ROLI Ltd.
+   |_____|_____|_____|_____|
+
+   The code in this file is provided under the terms of the ISC license:
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose
+   with or without fee is hereby granted, provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+namespace soul
+{
+
+//==============================================================================
+/**
+    A thread-scoped group of hardware performance counters.
+
+    Wall-clock timings say how long a block took but not why: two processors
+    with the same render time can be compute-bound (high instruction count,
+    few stalls) or memory-bound (modest instruction count, cache misses
+    everywhere), and the fix for each is different. The PMU answers that, and
+    this wraps the counters that matter for render work: cycles, retired
+    instructions, L1 data and last-level cache misses, and branch mispredicts.
+
+    The counters are opened for the calling thread only, so open() must run on
+    the thread being measured, and begin()/end() pairs must stay on that same
+    thread. On Linux this uses perf_event; kernels configured to deny
+    unprivileged perf access make open() fail rather than lie, and on
+    platforms with no accessible PMU interface open() just returns false, so
+    callers can treat counter availability as a soft capability. Counters the
+    hardware doesn't expose (some cores have no last-level miss event) read
+    back as zero while the rest of the group still works.
+
+    An end() costs one counter-group read - a microsecond-scale syscall - so
+    sampling per rendered block is affordable, but per-sample use is not.
+*/
+class PerformanceCounterSet  final
+{
+public:
+    PerformanceCounterSet();
+    ~PerformanceCounterSet();
+
+    PerformanceCounterSet (const PerformanceCounterSet&) = delete;
+    PerformanceCounterSet& operator= (const PerformanceCounterSet&) = delete;
+
+    /** The event deltas measured across one begin()/end() interval. */
+    struct Counts
+    {
+        uint64_t cycles = 0;
+        uint64_t instructions = 0;
+        uint64_t l1dCacheMisses = 0;
+        uint64_t lastLevelCacheMisses = 0;
+        uint64_t branchMispredicts = 0;
+    };
+
+    /** Opens the counter group for the calling thread. Returns false if no
+        usable PMU access is available, in which case the object stays closed
+        and begin()/end() become no-ops.
+    */
+    bool open();
+
+    /** Closes the group, releasing the counters. Safe to call when closed. */
+    void close();
+
+    bool isOpen() const         { return numOpenCounters != 0; }
+
+    /** Probes whether open() would succeed on this thread, without keeping
+        anything open. */
+    static bool isSupported();
+
+    /** Starts a measurement interval on the opening thread. */
+    void begin();
+
+    /** Ends the interval started by begin(), returning the deltas. */
+    Counts end();
+
+private:
+    static constexpr uint32_t numCounterSlots = 5;
+
+    int counterFDs[numCounterSlots] = { -1, -1, -1, -1, -1 };
+    int readOrder[numCounterSlots]  = { -1, -1, -1, -1, -1 };
+    uint32_t numOpenCounters = 0;
+};
+
+} // namespace soul
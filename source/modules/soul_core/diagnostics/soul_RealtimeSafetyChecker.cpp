@@ -0,0 +1,194 @@
+/*
+    _____ _____ _____ __
+   |   __|     |  |  |  |      The SOUL language
+   |__   |  |  |  |  |  |__    Copyright (c) 2019 - ROLI Ltd.
+   |_____|_____|_____|_____|
+
+   The code in this file is provided under the terms of the ISC license:
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose
+   with or without fee is hereby granted, provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#if ! SOUL_INSIDE_CORE_CPP
+ #error "Don't add this cpp file to your build, it gets included indirectly by soul_core.cpp"
+#endif
+
+#if defined (__linux__) || defined (__APPLE__)
+ #define SOUL_HAS_BACKTRACE 1
+ #include <execinfo.h>
+#endif
+
+namespace soul
+{
+
+namespace realtime_safety
+{
+    static thread_local int realtimeSectionDepth = 0;
+
+    // Set while a violation is being reported, so that the strings and log
+    // machinery the report itself uses don't get re-reported as violations
+    static thread_local bool isReporting = false;
+
+    static std::atomic<uint64_t> totalViolations { 0 };
+
+    // After this many reports the checker goes quiet - a violation that fires
+    // every block would otherwise drown the log
+    static constexpr uint64_t maxReports = 100;
+
+    static std::mutex& getReportLock()
+    {
+        static std::mutex lock;
+        return lock;
+    }
+
+    static RealtimeSafetyChecker::ReportFn& getReportFunction()
+    {
+        static RealtimeSafetyChecker::ReportFn reportFn;
+        return reportFn;
+    }
+
+    static void report (const char* kind, std::string detail)
+    {
+        auto count = totalViolations.fetch_add (1) + 1;
+
+        if (count > maxReports)
+            return;
+
+        isReporting = true;
+
+        RealtimeSafetyChecker::Violation violation { kind, std::move (detail),
+                                                     RealtimeSafetyChecker::captureStackTrace() };
+
+        if (count == maxReports)
+            violation.detail += " (violation limit reached - suppressing further reports)";
+
+        {
+            std::lock_guard<std::mutex> lock (getReportLock());
+
+            if (auto& reportFn = getReportFunction())
+                reportFn (violation);
+            else
+                Logger::log ("Realtime safety violation: " + std::string (violation.kind),
+                             violation.detail + (violation.stackTrace.empty() ? std::string()
+                                                                              : "\n" + violation.stackTrace));
+        }
+
+        isReporting = false;
+    }
+}
+
+void RealtimeSafetyChecker::setReportFunction (ReportFn newFunction)
+{
+    std::lock_guard<std::mutex> lock (realtime_safety::getReportLock());
+    realtime_safety::getReportFunction() = std::move (newFunction);
+}
+
+bool RealtimeSafetyChecker::isInRealtimeSection() noexcept
+{
+    return realtime_safety::realtimeSectionDepth > 0;
+}
+
+uint64_t RealtimeSafetyChecker::getNumViolations() noexcept
+{
+    return realtime_safety::totalViolations.load();
+}
+
+RealtimeSafetyChecker::ScopedRealtimeSection::ScopedRealtimeSection() noexcept
+{
+    ++realtime_safety::realtimeSectionDepth;
+}
+
+RealtimeSafetyChecker::ScopedRealtimeSection::~ScopedRealtimeSection()
+{
+    --realtime_safety::realtimeSectionDepth;
+}
+
+void RealtimeSafetyChecker::allocationPerformed (size_t numBytes) noexcept
+{
+    if (isInRealtimeSection() && ! realtime_safety::isReporting)
+        realtime_safety::report ("allocation", std::to_string (numBytes) + " bytes allocated on the render path");
+}
+
+void RealtimeSafetyChecker::lockAcquired (const char* description) noexcept
+{
+    if (isInRealtimeSection() && ! realtime_safety::isReporting)
+        realtime_safety::report ("lock", "mutex acquired on the render path: " + std::string (description));
+}
+
+void RealtimeSafetyChecker::violationDetected (const char* kind, const char* detail) noexcept
+{
+    if (isInRealtimeSection() && ! realtime_safety::isReporting)
+        realtime_safety::report (kind, detail);
+}
+
+std::string RealtimeSafetyChecker::captureStackTrace()
+{
+   #if SOUL_HAS_BACKTRACE
+    void* frames[64];
+    auto numFrames = ::backtrace (frames, 64);
+
+    if (auto symbols = ::backtrace_symbols (frames, numFrames))
+    {
+        std::string trace;
+
+        // Skip the captureStackTrace and report frames themselves
+        for (int i = 2; i < numFrames; ++i)
+        {
+            trace += symbols[i];
+            trace += '\n';
+        }
+
+        ::free (symbols);
+        return trace;
+    }
+   #endif
+
+    return {};
+}
+
+} // namespace soul
+
+//==============================================================================
+#if SOUL_ENABLE_REALTIME_SAFETY_CHECKS
+
+// These interposers replace the global allocator for the whole host process,
+// which is why the flag is strictly for test builds. As well as feeding the
+// safety checker, they keep RenderBenchmark's allocation counter fed for free.
+static void* checkedAllocate (size_t size)
+{
+    soul::RenderBenchmark::getAllocationCount().fetch_add (1, std::memory_order_relaxed);
+    soul::RealtimeSafetyChecker::allocationPerformed (size);
+    return std::malloc (size);
+}
+
+void* operator new (size_t size)
+{
+    if (auto result = checkedAllocate (size))
+        return result;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[] (size_t size)
+{
+    if (auto result = checkedAllocate (size))
+        return result;
+
+    throw std::bad_alloc();
+}
+
+void operator delete (void* ptr) noexcept            { std::free (ptr); }
+void operator delete[] (void* ptr) noexcept          { std::free (ptr); }
+void operator delete (void* ptr, size_t) noexcept    { std::free (ptr); }
+void operator delete[] (void* ptr, size_t) noexcept  { std::free (ptr); }
+
+#endif
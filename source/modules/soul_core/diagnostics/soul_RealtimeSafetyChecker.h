@@ -0,0 +1,107 @@
+/*
+    _____ _____ _____ __
+   |   __|     |  |  |  |      The SOUL language
+   |__   |  |  |  |  |  |__    Copyright (c) 2019 - ROLI Ltd.
+   |_____|_____|_____|_____|
+
+   The code in this file is provided under the terms of the ISC license:
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose
+   with or without fee is hereby granted, provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+//==============================================================================
+/** When this flag is enabled in a test build, soul_core.cpp replaces the global
+    operator new/delete with versions that report any allocation made while a
+    realtime section is active. It's off by default because replacing the global
+    allocator affects the whole host process, which is exactly what you want in
+    a soak test and never in a shipping build.
+*/
+#ifndef SOUL_ENABLE_REALTIME_SAFETY_CHECKS
+ #define SOUL_ENABLE_REALTIME_SAFETY_CHECKS 0
+#endif
+
+namespace soul
+{
+
+//==============================================================================
+/**
+    Catches realtime-safety violations - allocations and lock acquisitions on
+    the render path - in testing, rather than leaving them to show up as
+    glitches on stage.
+
+    The venue's render thread marks each block it renders with a
+    ScopedRealtimeSection. While one is active on a thread, any call to
+    allocationPerformed() or lockAcquired() is reported as a violation with a
+    stack trace (where the platform can produce one). The allocation hook is
+    wired up automatically by building with SOUL_ENABLE_REALTIME_SAFETY_CHECKS=1;
+    the lock hook is for call sites which take a mutex that might be reached
+    from a render thread.
+
+    Reports go to the Logger by default, or to a callback installed with
+    setReportFunction(). Reporting is capped so that a violation which fires
+    every block doesn't flood the log.
+*/
+struct RealtimeSafetyChecker
+{
+    struct Violation
+    {
+        const char* kind;        /**< "allocation", "deallocation" or "lock". */
+        std::string detail;
+        std::string stackTrace;  /**< Empty on platforms without backtrace support. */
+    };
+
+    using ReportFn = std::function<void(const Violation&)>;
+
+    /** Replaces the default Logger-based report handler. Pass nullptr to restore it. */
+    static void setReportFunction (ReportFn);
+
+    /** True while the calling thread is inside a ScopedRealtimeSection. */
+    static bool isInRealtimeSection() noexcept;
+
+    /** Returns the number of violations reported since the process started. */
+    static uint64_t getNumViolations() noexcept;
+
+    /** Marks the calling thread as being on the render path for the lifetime
+        of the object. Sections may nest.
+    */
+    struct ScopedRealtimeSection
+    {
+        ScopedRealtimeSection() noexcept;
+        ~ScopedRealtimeSection();
+
+        ScopedRealtimeSection (const ScopedRealtimeSection&) = delete;
+        ScopedRealtimeSection& operator= (const ScopedRealtimeSection&) = delete;
+    };
+
+    /** Called by the allocator interposer; reports a violation if the calling
+        thread is inside a realtime section.
+    */
+    static void allocationPerformed (size_t numBytes) noexcept;
+
+    /** Call this just before acquiring a mutex which could be reached from a
+        render thread; reports a violation if one currently is.
+    */
+    static void lockAcquired (const char* description) noexcept;
+
+    /** Reports an arbitrary realtime-safety violation if the calling thread is
+        inside a realtime section, for call sites which forbid an operation on
+        the render path that isn't an allocation or a lock.
+    */
+    static void violationDetected (const char* kind, const char* detail) noexcept;
+
+    /** Returns a human-readable stack trace of the calling thread, or an empty
+        string on platforms where this isn't supported.
+    */
+    static std::string captureStackTrace();
+};
+
+} // namespace soul
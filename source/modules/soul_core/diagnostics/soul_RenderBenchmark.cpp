@@ -0,0 +1,182 @@
+/*
+    _____ _____ _____ __
+   |   __|     |  |  |  |      The SOUL language
+   |__   |  |  |  |  |  |__    Copyright (c) 2019 - ROLI Ltd.
+   |_____|_____|_____|_____|
+
+   The code in this file is provided under the terms of the ISC license:
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose
+   with or without fee is hereby granted, provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#if ! SOUL_INSIDE_CORE_CPP
+ #error "Don't add this cpp file to your build, it gets included indirectly by soul_core.cpp"
+#endif
+
+namespace soul
+{
+
+std::atomic<uint64_t>& RenderBenchmark::getAllocationCount()
+{
+    static std::atomic<uint64_t> count { 0 };
+    return count;
+}
+
+RenderBenchmark::Result RenderBenchmark::renderProgram (Performer& performer, const Program& program, const Options& options)
+{
+    SOUL_ASSERT (options.blockSize > 0 && options.sampleRate > 0 && options.numHistogramBuckets > 0);
+
+    Result result;
+
+    CompileMessageList messageList;
+
+    if (! performer.load (messageList, program))
+        return result;
+
+    // Endpoint handles have to be taken between load() and link()
+    struct InputFeed
+    {
+        EndpointHandle handle;
+        uint32_t numChannels;
+    };
+
+    std::vector<InputFeed> inputFeeds;
+    std::vector<EndpointHandle> outputStreams;
+    uint32_t maxInputChannels = 0;
+
+    for (auto& input : performer.getInputEndpoints())
+    {
+        if (auto numChannels = input.getNumAudioChannels())
+        {
+            inputFeeds.push_back ({ performer.getEndpointHandle (input.endpointID), numChannels });
+            maxInputChannels = std::max (maxInputChannels, numChannels);
+        }
+    }
+
+    for (auto& output : performer.getOutputEndpoints())
+        if (output.getNumAudioChannels() != 0)
+            outputStreams.push_back (performer.getEndpointHandle (output.endpointID));
+
+    BuildSettings settings;
+    settings.sampleRate = options.sampleRate;
+    settings.maxBlockSize = options.blockSize;
+
+    if (! performer.link (messageList, settings, nullptr))
+        return result;
+
+    auto totalFrames = (uint64_t) (options.secondsToRender * options.sampleRate);
+    auto numBlocks = (totalFrames + options.blockSize - 1) / options.blockSize;
+
+    // Everything the loop needs is allocated up-front, so that the allocation
+    // counter only sees what the performer itself does per block
+    std::vector<float> silence ((size_t) options.blockSize * maxInputChannels, 0.0f);
+    std::vector<double> blockTimes;
+    blockTimes.reserve ((size_t) numBlocks);
+
+    using clock = std::chrono::high_resolution_clock;
+    auto startTime = clock::now();
+    auto allocationsBefore = getAllocationCount().load (std::memory_order_relaxed);
+
+    for (uint64_t block = 0; block < numBlocks; ++block)
+    {
+        auto blockStart = clock::now();
+
+        performer.prepare (options.blockSize);
+
+        for (auto& feed : inputFeeds)
+        {
+            if (feed.numChannels == 1)
+                performer.setNextInputStreamFrames (feed.handle, choc::value::createArrayView (silence.data(), options.blockSize));
+            else
+                performer.setNextInputStreamFrames (feed.handle, choc::value::create2DArrayView (silence.data(), options.blockSize, feed.numChannels));
+        }
+
+        performer.advance();
+
+        for (auto handle : outputStreams)
+            performer.getOutputStreamFrames (handle);
+
+        blockTimes.push_back (std::chrono::duration<double> (clock::now() - blockStart).count());
+    }
+
+    auto allocationsAfter = getAllocationCount().load (std::memory_order_relaxed);
+    auto endTime = clock::now();
+
+    result.succeeded = true;
+    result.numBlocks = numBlocks;
+    result.secondsRendered = (double) (numBlocks * options.blockSize) / options.sampleRate;
+    result.wallSeconds = std::chrono::duration<double> (endTime - startTime).count();
+    result.realtimeFactor = result.wallSeconds > 0 ? result.secondsRendered / result.wallSeconds : 0;
+    result.allocationsDuringRender = allocationsAfter - allocationsBefore;
+
+    if (blockTimes.empty())
+        return result;
+
+    double total = 0;
+
+    for (auto t : blockTimes)
+        total += t;
+
+    result.averageBlockSeconds = total / (double) blockTimes.size();
+
+    auto sortedTimes = blockTimes;
+    std::sort (sortedTimes.begin(), sortedTimes.end());
+
+    auto percentile = [&] (double p) -> double
+    {
+        auto index = (size_t) (p * (double) (sortedTimes.size() - 1));
+        return sortedTimes[index];
+    };
+
+    result.medianBlockSeconds = percentile (0.5);
+    result.p99BlockSeconds = percentile (0.99);
+    result.worstBlockSeconds = sortedTimes.back();
+
+    result.histogram.assign (options.numHistogramBuckets, 0);
+    result.histogramBucketSeconds = result.worstBlockSeconds / (double) options.numHistogramBuckets;
+
+    if (result.histogramBucketSeconds > 0)
+    {
+        for (auto t : blockTimes)
+        {
+            auto bucket = (size_t) (t / result.histogramBucketSeconds);
+            ++result.histogram[std::min (bucket, result.histogram.size() - 1)];
+        }
+    }
+
+    return result;
+}
+
+std::string RenderBenchmark::toJSON (const Result& result)
+{
+    auto histogram = choc::value::createEmptyArray();
+
+    for (auto count : result.histogram)
+        histogram.addArrayElement ((int64_t) count);
+
+    return choc::json::toString (choc::value::createObject ({},
+                                    "soulVersion", getLibraryVersion().toString(),
+                                    "success", result.succeeded,
+                                    "secondsRendered", result.secondsRendered,
+                                    "wallSeconds", result.wallSeconds,
+                                    "realtimeFactor", result.realtimeFactor,
+                                    "numBlocks", (int64_t) result.numBlocks,
+                                    "averageBlockSeconds", result.averageBlockSeconds,
+                                    "medianBlockSeconds", result.medianBlockSeconds,
+                                    "p99BlockSeconds", result.p99BlockSeconds,
+                                    "worstBlockSeconds", result.worstBlockSeconds,
+                                    "histogramBucketSeconds", result.histogramBucketSeconds,
+                                    "histogram", histogram,
+                                    "allocationsDuringRender", (int64_t) result.allocationsDuringRender));
+}
+
+} // namespace soul
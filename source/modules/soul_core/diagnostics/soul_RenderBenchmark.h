@@ -0,0 +1,89 @@
+/*
+    _____ _____ _____ __
+   |   __|     |  |  |  |      The SOUL language
+   |__   |  |  |  |  |  |__    Copyright (c) 2019 - ROLI Ltd.
+   |_____|_____|_____|_____|
+
+   The code in this file is provided under the terms of the ISC license:
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose
+   with or without fee is hereby granted, provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+namespace soul
+{
+
+//==============================================================================
+/**
+    Renders a program offline as fast as possible and measures how it performed,
+    for quantifying the effect of optimisation work on the runtime.
+
+    The benchmark loads a Program into a caller-supplied Performer, feeds its
+    input streams silence, and renders a fixed number of seconds of audio,
+    timing every block. As well as overall throughput (as a multiple of
+    realtime), it reports the distribution of per-block times - the p99 and
+    worst case are what decide whether a patch glitches, and an average can
+    hide them completely.
+*/
+struct RenderBenchmark
+{
+    struct Options
+    {
+        double sampleRate = 44100.0;
+        uint32_t blockSize = 512;
+        double secondsToRender = 10.0;
+        uint32_t numHistogramBuckets = 50;
+    };
+
+    /** The measurements taken from one render run. */
+    struct Result
+    {
+        bool succeeded = false;              /**< False if the program failed to load or link. */
+        double secondsRendered = 0;          /**< The length of audio that was rendered. */
+        double wallSeconds = 0;              /**< The wall time the render took. */
+        double realtimeFactor = 0;           /**< secondsRendered / wallSeconds - bigger is better. */
+        uint64_t numBlocks = 0;              /**< The number of blocks that were rendered. */
+
+        double averageBlockSeconds = 0;      /**< Mean wall time per block. */
+        double medianBlockSeconds = 0;       /**< Median wall time per block. */
+        double p99BlockSeconds = 0;          /**< 99th-percentile wall time per block. */
+        double worstBlockSeconds = 0;        /**< The slowest block of the run. */
+
+        std::vector<uint64_t> histogram;     /**< Block counts in equal-width time buckets from 0 to the worst case. */
+        double histogramBucketSeconds = 0;   /**< The width of each histogram bucket. */
+
+        uint64_t allocationsDuringRender = 0;  /**< Change in getAllocationCount() over the render loop. */
+    };
+
+    /** Loads and links the program into the given performer and renders it,
+        returning the measurements. The performer is left with the program
+        still loaded.
+    */
+    static Result renderProgram (Performer&, const Program&, const Options&);
+
+    /** Converts a result to a JSON document, for the same kind of CI-style
+        diffing as CompileTimeBenchmark::toJSON().
+    */
+    static std::string toJSON (const Result&);
+
+    /** A counter for allocations made on the render path.
+
+        The library never overrides global operator new itself, so by default
+        this stays at zero and allocationsDuringRender is meaningless. A
+        harness that wants real numbers installs its own counting operator
+        new/delete which increments this; renderProgram() snapshots the counter
+        either side of the render loop, so everything it reports happened while
+        blocks were being rendered.
+    */
+    static std::atomic<uint64_t>& getAllocationCount();
+};
+
+} // namespace soul
@@ -50,6 +50,119 @@ std::string ScopedTimer::getElapsedTimeDescription() const
     return getDescriptionOfTimeInSeconds (getElapsedSeconds());
 }
 
+//==============================================================================
+bool BuildTimingReport::isEmpty() const   { return scopes.empty(); }
+
+double BuildTimingReport::getTotalSeconds() const
+{
+    double total = 0;
+
+    for (auto& s : scopes)
+        total += s.seconds;
+
+    return total;
+}
+
+static std::string getDescriptionOfByteSize (size_t bytes)
+{
+    auto withOneDecimal = [] (size_t numerator, size_t unit, const char* suffix)
+    {
+        return std::to_string (numerator / unit) + "."
+                 + std::to_string ((numerator % unit) * 10 / unit) + suffix;
+    };
+
+    if (bytes >= 1024 * 1024)   return withOneDecimal (bytes, 1024 * 1024, " MB");
+    if (bytes >= 1024)          return withOneDecimal (bytes, 1024, " KB");
+
+    return std::to_string (bytes) + " bytes";
+}
+
+static void appendTimingScopes (std::string& result, const std::vector<BuildTimingReport::Scope>& scopes, size_t depth)
+{
+    for (auto& s : scopes)
+    {
+        result += std::string (depth * 2, ' ') + s.name + ": " + getDescriptionOfTimeInSeconds (s.seconds);
+
+        for (auto& m : s.memory)
+            result += "  [" + m.poolName + ": " + std::to_string (m.stats.numObjects) + " objects, "
+                        + getDescriptionOfByteSize (m.stats.bytesUsed)
+                        + ", peak " + getDescriptionOfByteSize (m.stats.highWaterBytes) + "]";
+
+        result += "\n";
+        appendTimingScopes (result, s.children, depth + 1);
+    }
+}
+
+std::string BuildTimingReport::toString() const
+{
+    std::string result;
+    appendTimingScopes (result, scopes, 0);
+    return result;
+}
+
+void BuildTimingReport::beginScope (std::string name)
+{
+    auto* siblings = &scopes;
+
+    for (auto index : openScopePath)
+        siblings = &(*siblings)[index].children;
+
+    openScopePath.push_back (siblings->size());
+    siblings->push_back ({ std::move (name), 0, {}, {} });
+}
+
+void BuildTimingReport::endScope (double seconds)
+{
+    SOUL_ASSERT (! openScopePath.empty());
+    auto* siblings = &scopes;
+
+    for (size_t i = 0; i + 1 < openScopePath.size(); ++i)
+        siblings = &(*siblings)[openScopePath[i]].children;
+
+    auto& scope = (*siblings)[openScopePath.back()];
+    scope.seconds = seconds;
+
+    for (auto& p : trackedPools)
+        scope.memory.push_back ({ p.first, p.second->getStatistics() });
+
+    openScopePath.pop_back();
+}
+
+BuildTimingReport::Phase::Phase (BuildTimingReport* r, std::string name)  : report (r)
+{
+    if (report != nullptr)
+    {
+        report->beginScope (std::move (name));
+        start = clock::now();
+    }
+}
+
+BuildTimingReport::Phase::~Phase()
+{
+    if (report != nullptr)
+        report->endScope (toSeconds (clock::now() - start));
+}
+
+BuildTimingReport::TrackedPool::TrackedPool (BuildTimingReport* r, std::string name, const PoolAllocator& poolToTrack)
+    : report (r), pool (std::addressof (poolToTrack))
+{
+    if (report != nullptr)
+    {
+        for (auto& p : report->trackedPools)
+            if (p.second == pool)
+                { report = nullptr; return; }   // already being tracked under another registration
+
+        report->trackedPools.push_back ({ std::move (name), pool });
+    }
+}
+
+BuildTimingReport::TrackedPool::~TrackedPool()
+{
+    if (report != nullptr)
+        removeIf (report->trackedPools, [this] (const std::pair<std::string, const PoolAllocator*>& p)
+                                        { return p.second == pool; });
+}
+
 //==============================================================================
 CPULoadMeasurer::CPULoadMeasurer() { reset(); }
 
@@ -44,6 +44,88 @@ private:
 // Helper method to read the bela audio load
 float getBelaLoadFromString (const std::string& input);
 
+//==============================================================================
+/** A hierarchical breakdown of where the time went during a compilation.
+
+    Attach one of these to a CompileMessageList before invoking the compiler and
+    each pass boundary will record a named, nested scope into it, so that a slow
+    build can be broken down after the event without needing a profiler attached
+    to the machine where it happened.
+*/
+struct BuildTimingReport  final
+{
+    /** The statistics of one of the build's pool allocators, captured as a pass ended. */
+    struct PoolSnapshot
+    {
+        std::string poolName;
+        PoolAllocator::Statistics stats;
+    };
+
+    struct Scope
+    {
+        std::string name;
+        double seconds = 0;
+        std::vector<PoolSnapshot> memory;
+        std::vector<Scope> children;
+    };
+
+    std::vector<Scope> scopes;
+
+    bool isEmpty() const;
+    double getTotalSeconds() const;
+
+    /** Returns an indented, human-readable dump of the report. */
+    std::string toString() const;
+
+    //==============================================================================
+    /** RAII helper which times a block and records it as a scope in a report,
+        nesting itself inside whichever Phase is currently open. A null report
+        pointer makes this a no-op, so callers which haven't asked for timings
+        don't pay for them.
+    */
+    struct Phase  final
+    {
+        Phase (BuildTimingReport*, std::string name);
+        ~Phase();
+
+        Phase (const Phase&) = delete;
+        Phase& operator= (const Phase&) = delete;
+
+    private:
+        using clock = std::chrono::high_resolution_clock;
+        BuildTimingReport* report;
+        clock::time_point start;
+    };
+
+    //==============================================================================
+    /** RAII helper which registers a pool allocator with a report for as long as
+        it's alive, so that each Phase which closes in the meantime snapshots the
+        pool's statistics into its scope. The compiler registers the AST and HEART
+        pools this way, which pins a peak-memory regression to both a pass and a
+        structure. A null report, or a pool that's already registered, makes this
+        a no-op.
+    */
+    struct TrackedPool  final
+    {
+        TrackedPool (BuildTimingReport*, std::string name, const PoolAllocator&);
+        ~TrackedPool();
+
+        TrackedPool (const TrackedPool&) = delete;
+        TrackedPool& operator= (const TrackedPool&) = delete;
+
+    private:
+        BuildTimingReport* report;
+        const PoolAllocator* pool;
+    };
+
+private:
+    std::vector<std::pair<std::string, const PoolAllocator*>> trackedPools;
+    std::vector<size_t> openScopePath;
+
+    void beginScope (std::string name);
+    void endScope (double seconds);
+};
+
 //==============================================================================
 /** Keeps a running count of the proportion of time spent in a block. */
 struct CPULoadMeasurer
@@ -0,0 +1,231 @@
+/*
+    _____ _____ _____ __
+   |   __|     |  |  |  |      The SOUL language
+   |__   |  |  |  |  |  |__    Copyright (c) 2019 - ROLI Ltd.
+   |_____|_____|_____|_____|
+
+   The code in this file is provided under the terms of the ISC license:
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose
+   with or without fee is hereby granted, provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#if ! SOUL_INSIDE_CORE_CPP
+ #error "Don't add this cpp file to your build, it gets included indirectly by soul_core.cpp"
+#endif
+
+namespace soul
+{
+
+namespace trace_logger
+{
+    static constexpr uint32_t ringCapacity = 4096;  // records per thread - must be a power of two
+
+    struct ThreadRing
+    {
+        std::array<TraceLogger::Record, ringCapacity> records;
+        std::atomic<uint64_t> writeCount { 0 };
+        uint64_t readCount = 0;                     // owned by the drain thread
+        uint32_t threadID = 0;
+    };
+
+    struct Registry
+    {
+        // Rings are never removed: one may outlive its thread, and keeping it lets
+        // the drain thread finish reading whatever the thread emitted before exiting
+        std::mutex lock;
+        std::vector<std::unique_ptr<ThreadRing>> rings;
+        std::vector<std::string> eventTypeNames;
+
+        std::atomic<bool> enabled { false };
+        std::atomic<uint64_t> droppedRecords { 0 };
+        TraceLogger::ConsumerFn consumer;
+        std::thread drainThread;
+        std::atomic<bool> shouldStopDraining { false };
+
+        static Registry& get()
+        {
+            static Registry registry;
+            return registry;
+        }
+    };
+
+    static ThreadRing& getThreadRing()
+    {
+        static thread_local ThreadRing* ring = []
+        {
+            auto& registry = Registry::get();
+            std::lock_guard<std::mutex> l (registry.lock);
+            auto newRing = std::make_unique<ThreadRing>();
+            newRing->threadID = static_cast<uint32_t> (registry.rings.size());
+            registry.rings.push_back (std::move (newRing));
+            return registry.rings.back().get();
+        }();
+
+        return *ring;
+    }
+
+    static uint64_t getTimeNanos() noexcept
+    {
+        return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>
+                            (std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+    }
+
+    static void drainRing (ThreadRing& ring, const TraceLogger::ConsumerFn& consumer, std::atomic<uint64_t>& dropped)
+    {
+        for (;;)
+        {
+            auto written = ring.writeCount.load (std::memory_order_acquire);
+
+            if (written - ring.readCount > ringCapacity)
+            {
+                dropped += (written - ring.readCount) - ringCapacity;
+                ring.readCount = written - ringCapacity;
+            }
+
+            if (ring.readCount == written)
+                return;
+
+            auto record = ring.records[ring.readCount % ringCapacity];
+
+            // If the producer lapped this slot while it was being copied, the copy
+            // may be torn - go back round and let the overflow handling skip it
+            if (ring.writeCount.load (std::memory_order_acquire) - ring.readCount > ringCapacity)
+                continue;
+
+            ++ring.readCount;
+            consumer (record);
+        }
+    }
+
+    static void drainAllRings (Registry& registry)
+    {
+        // The ring pointers are stable once created, so only the vector walk
+        // needs the lock - the consumer runs outside it
+        std::vector<ThreadRing*> rings;
+
+        {
+            std::lock_guard<std::mutex> l (registry.lock);
+
+            for (auto& r : registry.rings)
+                rings.push_back (r.get());
+        }
+
+        for (auto* r : rings)
+            drainRing (*r, registry.consumer, registry.droppedRecords);
+    }
+
+    static void runDrainThread (Registry& registry)
+    {
+        while (! registry.shouldStopDraining.load())
+        {
+            drainAllRings (registry);
+            std::this_thread::sleep_for (std::chrono::milliseconds (2));
+        }
+
+        // One last sweep picks up anything emitted before disable() flipped the flag
+        drainAllRings (registry);
+    }
+}
+
+//==============================================================================
+uint32_t TraceLogger::registerEventType (const char* name)
+{
+    auto& registry = trace_logger::Registry::get();
+    std::lock_guard<std::mutex> l (registry.lock);
+
+    for (size_t i = 0; i < registry.eventTypeNames.size(); ++i)
+        if (registry.eventTypeNames[i] == name)
+            return static_cast<uint32_t> (i + 1);
+
+    registry.eventTypeNames.push_back (name);
+    return static_cast<uint32_t> (registry.eventTypeNames.size());
+}
+
+std::string TraceLogger::getEventTypeName (uint32_t eventType)
+{
+    auto& registry = trace_logger::Registry::get();
+    std::lock_guard<std::mutex> l (registry.lock);
+
+    if (eventType >= 1 && eventType <= registry.eventTypeNames.size())
+        return registry.eventTypeNames[eventType - 1];
+
+    return {};
+}
+
+void TraceLogger::emit (uint32_t eventType, uint64_t value1, uint64_t value2) noexcept
+{
+    auto& registry = trace_logger::Registry::get();
+
+    if (! registry.enabled.load (std::memory_order_relaxed))
+        return;
+
+    auto& ring = trace_logger::getThreadRing();
+    auto pos = ring.writeCount.load (std::memory_order_relaxed);
+    auto& record = ring.records[pos % trace_logger::ringCapacity];
+
+    record.timeNanos = trace_logger::getTimeNanos();
+    record.eventType = eventType;
+    record.threadID = ring.threadID;
+    record.value1 = value1;
+    record.value2 = value2;
+
+    ring.writeCount.store (pos + 1, std::memory_order_release);
+}
+
+void TraceLogger::prepareCurrentThread()
+{
+    trace_logger::getThreadRing();
+}
+
+void TraceLogger::enable (ConsumerFn consumer)
+{
+    disable();
+    auto& registry = trace_logger::Registry::get();
+
+    {
+        std::lock_guard<std::mutex> l (registry.lock);
+        registry.consumer = std::move (consumer);
+    }
+
+    registry.droppedRecords = 0;
+    registry.shouldStopDraining = false;
+    registry.drainThread = std::thread ([&registry] { trace_logger::runDrainThread (registry); });
+    registry.enabled.store (true, std::memory_order_release);
+}
+
+void TraceLogger::disable()
+{
+    auto& registry = trace_logger::Registry::get();
+
+    if (! registry.enabled.exchange (false))
+        return;
+
+    registry.shouldStopDraining = true;
+
+    if (registry.drainThread.joinable())
+        registry.drainThread.join();
+
+    std::lock_guard<std::mutex> l (registry.lock);
+    registry.consumer = nullptr;
+}
+
+bool TraceLogger::isEnabled() noexcept
+{
+    return trace_logger::Registry::get().enabled.load (std::memory_order_relaxed);
+}
+
+uint64_t TraceLogger::getDroppedRecordCount() noexcept
+{
+    return trace_logger::Registry::get().droppedRecords.load();
+}
+
+} // namespace soul
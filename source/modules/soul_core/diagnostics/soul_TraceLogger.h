@@ -0,0 +1,105 @@
+/*
+    _____ _____ _____ __
+   |   __|     |  |  |  |      The SOUL language
+   |__   |  |  |  |  |  |__    Copyright (c) 2019 - ROLI Ltd.
+   |_____|_____|_____|_____|
+
+   The code in this file is provided under the terms of the ISC license:
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose
+   with or without fee is hereby granted, provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+namespace soul
+{
+
+//==============================================================================
+/**
+    A wait-free structured trace ring for hot-path instrumentation.
+
+    Logger is fine for the compiler, but it formats strings and takes a lock, so
+    the render thread can't touch it. TraceLogger instead writes fixed-size
+    binary records into a per-thread ring with a single release store - no lock,
+    no allocation, no formatting - and a background thread owned by enable()
+    drains the rings and hands the records to a consumer at its leisure.
+
+    Producers never wait: if a ring fills because the drain thread can't keep
+    up, the oldest records are overwritten and counted by
+    getDroppedRecordCount() rather than stalling the emitter.
+
+    Event types are small integers registered up-front with registerEventType(),
+    which keeps a record at 32 bytes and makes emitting one a timestamp plus a
+    handful of plain stores - tens of nanoseconds, cheap enough to leave in
+    production builds behind the SOUL_TRACE macro.
+
+    The one slow path on the producer side is a thread's very first record,
+    which registers its ring under a lock. Threads with realtime constraints
+    should call prepareCurrentThread() during their setup to get that out of
+    the way.
+*/
+class TraceLogger  final
+{
+public:
+    /** One fixed-size trace record. */
+    struct Record
+    {
+        uint64_t timeNanos;         /**< High-resolution clock timestamp. */
+        uint32_t eventType;         /**< An ID from registerEventType(), or 0 if unknown. */
+        uint32_t threadID;          /**< A small per-thread index, stable for the thread's lifetime. */
+        uint64_t value1, value2;    /**< Whatever payload the event type defines. */
+    };
+
+    /** Receives drained records on the background thread, oldest first per ring. */
+    using ConsumerFn = std::function<void(const Record&)>;
+
+    //==============================================================================
+    /** Registers (or looks up) a named event type, returning its ID.
+        This takes a lock, so call it during setup, not from a hot path.
+    */
+    static uint32_t registerEventType (const char* name);
+
+    /** Returns the name an event type was registered with, or an empty string. */
+    static std::string getEventTypeName (uint32_t eventType);
+
+    //==============================================================================
+    /** Appends a record to the calling thread's ring. Wait-free and allocation-free
+        (after the thread's first record), and a no-op when tracing is disabled.
+    */
+    static void emit (uint32_t eventType, uint64_t value1 = 0, uint64_t value2 = 0) noexcept;
+
+    /** Creates and registers the calling thread's ring if it doesn't exist yet,
+        so that its first emit() doesn't have to.
+    */
+    static void prepareCurrentThread();
+
+    //==============================================================================
+    /** Starts tracing: records emitted from now on are drained by a background
+        thread and passed to the consumer. Replaces any previous consumer.
+    */
+    static void enable (ConsumerFn consumer);
+
+    /** Stops tracing, drains whatever is still buffered, and joins the drain thread. */
+    static void disable();
+
+    /** Returns true if a consumer is currently attached. */
+    static bool isEnabled() noexcept;
+
+    /** Returns how many records have been overwritten before the drain thread
+        could read them, since tracing was last enabled.
+    */
+    static uint64_t getDroppedRecordCount() noexcept;
+};
+
+//==============================================================================
+#define SOUL_TRACE(eventType, ...) \
+    if (soul::TraceLogger::isEnabled()) soul::TraceLogger::emit (eventType, ##__VA_ARGS__);
+
+} // namespace soul
@@ -120,9 +120,19 @@ namespace CompileTimeIntrinsicEvaluation
             case IntrinsicType::roundToInt:              return {};
             case IntrinsicType::sum:                     return {};
             case IntrinsicType::product:                 return {};
+            case IntrinsicType::rms:                     return {};
             case IntrinsicType::get_array_size:          return {};
             case IntrinsicType::read:                    return {};
             case IntrinsicType::readLinearInterpolated:  return {};
+            case IntrinsicType::fft:                     return {};
+            case IntrinsicType::ifft:                    return {};
+            case IntrinsicType::convolve:                return {};
+
+            // these are folded by performIntrinsic() itself, as they don't fit
+            // the coerce-everything-to-one-type scheme used here
+            case IntrinsicType::countbits:               return {};
+            case IntrinsicType::clz:                     return {};
+            case IntrinsicType::select:                  return {};
         }
 
         return {};
@@ -131,6 +141,48 @@ namespace CompileTimeIntrinsicEvaluation
 
 Value performIntrinsic (IntrinsicType i, ArrayView<Value> args)
 {
+    // select() mixes a bool condition with two value operands, so it can't go
+    // through the common coerce-to-one-type path below
+    if (i == IntrinsicType::select)
+    {
+        SOUL_ASSERT (args.size() == 3);
+
+        if (args.front().getType().isBool())
+            return args.front().getAsBool() ? args[1] : args[2];
+
+        return {};
+    }
+
+    // the bit-counting intrinsics depend on the exact width of their argument,
+    // which the widening casts below would destroy
+    if (i == IntrinsicType::countbits || i == IntrinsicType::clz)
+    {
+        SOUL_ASSERT (args.size() == 1);
+        const auto& t = args.front().getType();
+
+        if (! t.isPrimitiveInteger())
+            return {};
+
+        auto bits = static_cast<uint64_t> (args.front().getAsInt64());
+
+        if (! t.isInteger64())
+            bits &= 0xffffffffull;
+
+        if (i == IntrinsicType::clz)
+            return Value (bits == 0 ? (t.isInteger64() ? 64 : 32)
+                                    : static_cast<int32_t> (choc::math::countUpperClearBits (bits)) - (t.isInteger64() ? 0 : 32));
+
+        int32_t count = 0;
+
+        while (bits != 0)
+        {
+            count += static_cast<int32_t> (bits & 1);
+            bits >>= 1;
+        }
+
+        return Value (count);
+    }
+
     auto argType = args.front().getType();
 
     for (auto& a : args)
@@ -197,6 +249,13 @@ Value performIntrinsic (IntrinsicType i, ArrayView<Value> args)
     X(get_array_size) \
     X(read) \
     X(readLinearInterpolated) \
+    X(rms) \
+    X(fft) \
+    X(ifft) \
+    X(convolve) \
+    X(countbits) \
+    X(clz) \
+    X(select) \
 
 IntrinsicType getIntrinsicTypeFromName (std::string_view s)
 {
@@ -223,4 +282,85 @@ std::string getFullyQualifiedIntrinsicName (IntrinsicType intrinsic)
                                       getIntrinsicName (intrinsic));
 }
 
+const IntrinsicLoweringInfo& getIntrinsicLoweringInfo (IntrinsicType i)
+{
+    //                                                               lanes  elementwise  reduction  approx  transcendental  fma
+    static constexpr IntrinsicLoweringInfo wideMaths             {     4,      true,      false,    false,      false,      false };
+    static constexpr IntrinsicLoweringInfo hardwareSqrt          {     4,      true,      false,    true,       true,       false };
+    static constexpr IntrinsicLoweringInfo fastTranscendental    {     1,      true,      false,    true,       true,       false };
+    static constexpr IntrinsicLoweringInfo preciseTranscendental {     1,      true,      false,    false,      true,       false };
+    static constexpr IntrinsicLoweringInfo laneReduction         {     4,      false,     true,     false,      false,      true  };
+    static constexpr IntrinsicLoweringInfo scalarElementwise     {     1,      true,      false,    false,      false,      false };
+    static constexpr IntrinsicLoweringInfo blockTransform        {     4,      false,     false,    false,      false,      true  };
+    static constexpr IntrinsicLoweringInfo opaque                {     1,      false,     false,    false,      false,      false };
+
+    switch (i)
+    {
+        // simple lanewise arithmetic and comparisons, which map directly onto SIMD ops
+        case IntrinsicType::abs:
+        case IntrinsicType::min:
+        case IntrinsicType::max:
+        case IntrinsicType::clamp:
+        case IntrinsicType::wrap:
+        case IntrinsicType::fmod:
+        case IntrinsicType::remainder:
+        case IntrinsicType::floor:
+        case IntrinsicType::ceil:
+        case IntrinsicType::roundToInt:
+        case IntrinsicType::isnan:
+        case IntrinsicType::isinf:
+        case IntrinsicType::select:                  return wideMaths;
+
+        // hardware square root, with rsqrt-style estimates available as approximations
+        case IntrinsicType::sqrt:                    return hardwareSqrt;
+
+        // libm-backed functions with well-known polynomial/table approximations
+        case IntrinsicType::pow:
+        case IntrinsicType::exp:
+        case IntrinsicType::log:
+        case IntrinsicType::log10:
+        case IntrinsicType::sin:
+        case IntrinsicType::cos:
+        case IntrinsicType::tan:
+        case IntrinsicType::tanh:                    return fastTranscendental;
+
+        // libm-backed functions usually left at full precision
+        case IntrinsicType::sinh:
+        case IntrinsicType::cosh:
+        case IntrinsicType::asinh:
+        case IntrinsicType::acosh:
+        case IntrinsicType::atanh:
+        case IntrinsicType::asin:
+        case IntrinsicType::acos:
+        case IntrinsicType::atan:
+        case IntrinsicType::atan2:                   return preciseTranscendental;
+
+        // horizontal reductions whose multiply-fed accumulations should become FMA chains
+        case IntrinsicType::sum:
+        case IntrinsicType::product:
+        case IntrinsicType::rms:                     return laneReduction;
+
+        // branchy phase-wrapping arithmetic: lanewise, but best left scalar
+        case IntrinsicType::addModulo2Pi:            return scalarElementwise;
+
+        // single-instruction scalar bit counting (popcnt/lzcnt) - the in-language
+        // bodies are only fallbacks for engines without those instructions
+        case IntrinsicType::countbits:
+        case IntrinsicType::clz:                     return scalarElementwise;
+
+        // whole-buffer transforms which engines should back with optimised native
+        // kernels - the in-language bodies are functional fallbacks, not the fast path
+        case IntrinsicType::fft:
+        case IntrinsicType::ifft:
+        case IntrinsicType::convolve:                return blockTransform;
+
+        case IntrinsicType::none:
+        case IntrinsicType::get_array_size:
+        case IntrinsicType::read:
+        case IntrinsicType::readLinearInterpolated:  break;
+    }
+
+    return opaque;
+}
+
 } // namespace soul
@@ -59,7 +59,14 @@ namespace soul
         product,
         get_array_size,
         read,
-        readLinearInterpolated
+        readLinearInterpolated,
+        rms,
+        fft,
+        ifft,
+        convolve,
+        countbits,
+        clz,
+        select
     };
 
     /** Used for compile-time evaluation of an intrinsic function */
@@ -72,4 +79,49 @@ namespace soul
     const char* getIntrinsicName (IntrinsicType);
     std::string getFullyQualifiedIntrinsicName (IntrinsicType);
 
+    //==============================================================================
+    /** Describes how an intrinsic can be lowered, and what the optimiser and a
+        code-generating backend may assume about it. The table lives in
+        soul_Intrinsics.cpp next to the name mappings, so adding an intrinsic
+        means updating both in the same place.
+    */
+    struct IntrinsicLoweringInfo
+    {
+        /** The number of float32 lanes that a typical 128-bit SIMD unit can
+            process in one instruction for this intrinsic, or 1 where it has to
+            stay scalar (e.g. a libm call).
+        */
+        uint8_t float32SIMDLanes;
+
+        /** True if applying the intrinsic to a vector is just the scalar
+            operation on each lane, so a loop applying it lane-by-lane can be
+            rewritten as one wide operation.
+        */
+        bool isElementwise;
+
+        /** True for horizontal reductions like sum() and product(), which
+            combine the lanes of their argument rather than acting on them
+            independently.
+        */
+        bool isReduction;
+
+        /** True if a faster, less accurate implementation exists which a backend
+            may substitute when fast-maths behaviour is acceptable.
+        */
+        bool hasApproximateVariant;
+
+        /** True for the libm-grade transcendental functions, which are worth
+            narrowing to float32 on targets with no 64-bit FPU.
+            @see Optimisations::narrowFloat64Intrinsics
+        */
+        bool isTranscendental;
+
+        /** True if a multiply feeding this intrinsic's accumulation should be
+            fused into multiply-add chains - e.g. sum (a * b) lowering to FMAs.
+        */
+        bool fusesToMultiplyAdd;
+    };
+
+    const IntrinsicLoweringInfo& getIntrinsicLoweringInfo (IntrinsicType);
+
 }
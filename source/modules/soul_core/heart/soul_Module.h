@@ -84,6 +84,10 @@ public:
     template <typename Type, typename... Args>
     Type& allocate (Args&&... args)         { return allocator.allocate<Type> (std::forward<Args> (args)...); }
 
+    /** @see heart::Allocator::allocateStatement */
+    template <typename Type, typename... Args>
+    Type& allocateStatement (Args&&... args)  { return allocator.allocateStatement<Type> (std::forward<Args> (args)...); }
+
 
 private:
     //==============================================================================
@@ -31,6 +31,12 @@ struct ModuleCloner
     ModuleCloner (const Module& source, Module& dest, FunctionMappings& functions, StructMappings& structs, VariableMappings& vars)
         : oldModule (source), newModule (dest), functionMappings (functions), structMappings (structs), variableMappings (vars)
     {
+        // The number of entries each remapping table will end up holding is known
+        // from the source module's layout, so size them once up-front rather than
+        // letting them rehash repeatedly while the contents are cloned
+        inputMappings.reserve (oldModule.inputs.size());
+        outputMappings.reserve (oldModule.outputs.size());
+        processorInstanceMappings.reserve (oldModule.processorInstances.size());
     }
 
     void createStructPlaceholders()
@@ -48,12 +54,17 @@ struct ModuleCloner
         for (auto& s : oldModule.structs)
             populateClonedStruct (*s);
 
+        newModule.functions.reserve (oldModule.functions.size());
+
         for (auto& f : oldModule.functions)
             newModule.functions.push_back (createNewFunctionObject (f));
     }
 
     void clone()
     {
+        newModule.inputs.reserve (oldModule.inputs.size());
+        newModule.outputs.reserve (oldModule.outputs.size());
+
         for (auto& io : oldModule.inputs)
             newModule.inputs.push_back (clone (io));
 
@@ -62,6 +73,9 @@ struct ModuleCloner
 
         if (oldModule.isGraph())
         {
+            newModule.processorInstances.reserve (oldModule.processorInstances.size());
+            newModule.connections.reserve (oldModule.connections.size());
+
             for (auto& mi : oldModule.processorInstances)
                 newModule.processorInstances.push_back (clone (mi));
 
@@ -69,6 +83,8 @@ struct ModuleCloner
                 newModule.connections.push_back (clone (c));
         }
 
+        newModule.stateVariables.reserve (oldModule.stateVariables.size());
+
         for (auto& v : oldModule.stateVariables)
             newModule.stateVariables.push_back (getRemappedVariable (v));
 
@@ -320,7 +336,7 @@ struct ModuleCloner
 
     heart::Branch& clone (const heart::Branch& old)
     {
-        auto& b = newModule.allocate<heart::Branch> (getRemappedBlock (old.target));
+        auto& b = newModule.allocateStatement<heart::Branch> (getRemappedBlock (old.target));
 
         for (auto& arg : old.targetArgs)
             b.targetArgs.push_back (cloneExpression (arg));
@@ -330,7 +346,7 @@ struct ModuleCloner
 
     heart::BranchIf& clone (const heart::BranchIf& old)
     {
-        auto& b =  newModule.allocate<heart::BranchIf> (cloneExpression (old.condition),
+        auto& b =  newModule.allocateStatement<heart::BranchIf> (cloneExpression (old.condition),
                                                         getRemappedBlock (old.targets[0]),
                                                         getRemappedBlock (old.targets[1]));
 
@@ -340,29 +356,30 @@ struct ModuleCloner
         for (auto& arg : old.targetArgs[1])
             b.targetArgs[1].push_back (cloneExpression (arg));
 
+        b.likelihood = old.likelihood;
         return b;
     }
 
     heart::ReturnVoid& clone (const heart::ReturnVoid&)
     {
-        return newModule.allocate<heart::ReturnVoid>();
+        return newModule.allocateStatement<heart::ReturnVoid>();
     }
 
     heart::ReturnValue& clone (const heart::ReturnValue& old)
     {
-        return newModule.allocate<heart::ReturnValue> (cloneExpression (old.returnValue));
+        return newModule.allocateStatement<heart::ReturnValue> (cloneExpression (old.returnValue));
     }
 
     heart::AssignFromValue& clone (const heart::AssignFromValue& old)
     {
-        return newModule.allocate<heart::AssignFromValue> (old.location,
+        return newModule.allocateStatement<heart::AssignFromValue> (old.location,
                                                            cloneExpression (*old.target),
                                                            cloneExpression (old.source));
     }
 
     heart::FunctionCall& clone (const heart::FunctionCall& old)
     {
-        auto& fc = newModule.allocate<heart::FunctionCall> (old.location,
+        auto& fc = newModule.allocateStatement<heart::FunctionCall> (old.location,
                                                             cloneExpressionPtr (old.target),
                                                             getRemappedFunction (old.getFunction()));
 
@@ -385,14 +402,14 @@ struct ModuleCloner
 
     heart::ReadStream& clone (const heart::ReadStream& old)
     {
-        return newModule.allocate<heart::ReadStream> (old.location,
+        return newModule.allocateStatement<heart::ReadStream> (old.location,
                                                       cloneExpression (*old.target),
                                                       getRemappedInput (old.source));
     }
 
     heart::WriteStream& clone (const heart::WriteStream& old)
     {
-        return newModule.allocate<heart::WriteStream> (old.location,
+        return newModule.allocateStatement<heart::WriteStream> (old.location,
                                                        getRemappedOutput (old.target),
                                                        cloneExpressionPtr (old.element),
                                                        cloneExpression (old.value));
@@ -400,7 +417,7 @@ struct ModuleCloner
 
     heart::AdvanceClock& clone (const heart::AdvanceClock& a)
     {
-        return newModule.allocate<heart::AdvanceClock> (a.location);
+        return newModule.allocateStatement<heart::AdvanceClock> (a.location);
     }
 
     heart::Function& createNewFunctionObject (const heart::Function& old)
@@ -413,6 +430,7 @@ struct ModuleCloner
     void clone (heart::Function& f, const heart::Function& old)
     {
         blockMappings.clear();
+        blockMappings.reserve (old.blocks.size());
 
         f.location = old.location;
         f.returnType = cloneType (old.returnType);
@@ -421,8 +439,12 @@ struct ModuleCloner
         f.intrinsicType = old.intrinsicType;
         f.isExported = old.isExported;
         f.hasNoBody = old.hasNoBody;
+        f.codeSection = old.codeSection;
         f.annotation = old.annotation;
 
+        f.parameters.reserve (old.parameters.size());
+        f.blocks.reserve (old.blocks.size());
+
         for (auto& p : old.parameters)
             f.parameters.push_back (cloneVariable (p));
 
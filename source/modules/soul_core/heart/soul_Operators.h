@@ -78,12 +78,28 @@ namespace UnaryOp
         if (! type.isPrimitive())
             return false;
 
-        if (op == Op::negate)       return type.isInteger() || type.isFloatingPoint();
-        if (op == Op::bitwiseNot)   return type.isInteger();
-        if (op == Op::logicalNot)   return type.isBool();
+        // One flag per (op, primitive) pair, filled in at compile time, so the check
+        // made for every unary op in a program is a single table load
+        static constexpr auto suitablePrimitives = []
+        {
+            std::array<std::array<bool, PrimitiveType::float16 + 1>, (size_t) Op::unknown + 1> table {};
 
-        SOUL_ASSERT_FALSE;
-        return false;
+            for (auto p : { PrimitiveType::int32, PrimitiveType::int64 })
+            {
+                table[(size_t) Op::negate][p] = true;
+                table[(size_t) Op::bitwiseNot][p] = true;
+            }
+
+            // negation is the one arithmetic op that works directly on float16 storage,
+            // as flipping the sign bit is exact at any precision
+            for (auto p : { PrimitiveType::float32, PrimitiveType::float64, PrimitiveType::float16 })
+                table[(size_t) Op::negate][p] = true;
+
+            table[(size_t) Op::logicalNot][PrimitiveType::bool_] = true;
+            return table;
+        }();
+
+        return suitablePrimitives[(size_t) op][(size_t) type.getPrimitiveType().type];
     }
 
     inline bool apply (Value& value, Op op)
@@ -153,42 +169,69 @@ namespace BinaryOp
         return "";
     }
 
-    inline bool isLogicalOperator (Op t) noexcept
+    /** The category that decides which coercion rules an op follows. */
+    enum class Category
     {
-        return t == Op::logicalAnd || t == Op::logicalOr;
-    }
+        arithmetic,
+        bitwise,
+        logical,
+        equality,
+        comparison,
+        unknown
+    };
 
-    inline bool isEqualityOperator (Op t) noexcept
+    /** Returns an op's category as a single load from a compile-time table,
+        rather than running the chain of comparisons that getTypes() and the
+        sanity-checkers would otherwise repeat for every binary op in a program.
+    */
+    inline Category getCategory (Op op) noexcept
     {
-        return t == Op::equals      || t == Op::notEquals;
-    }
+        static constexpr auto categories = []
+        {
+            std::array<Category, (size_t) Op::unknown + 1> table {};
 
-    inline bool isComparisonOperator (Op t) noexcept
-    {
-        return t == Op::lessThan    || t == Op::lessThanOrEqual
-            || t == Op::greaterThan || t == Op::greaterThanOrEqual;
-    }
+            for (auto& c : table)
+                c = Category::unknown;
 
-    inline bool isBitwiseOperator (Op t) noexcept
-    {
-        return t == Op::bitwiseOr  || t == Op::bitwiseAnd || t == Op::bitwiseXor
-            || t == Op::leftShift  || t == Op::rightShift || t == Op::rightShiftUnsigned;
-    }
+            for (auto o : { Op::add, Op::subtract, Op::multiply, Op::divide, Op::modulo })
+                table[(size_t) o] = Category::arithmetic;
 
-    inline bool isArithmeticOperator (Op t) noexcept
-    {
-        return t == Op::add       || t == Op::subtract
-            || t == Op::multiply  || t == Op::divide
-            || t == Op::modulo;
+            for (auto o : { Op::bitwiseOr, Op::bitwiseAnd, Op::bitwiseXor,
+                            Op::leftShift, Op::rightShift, Op::rightShiftUnsigned })
+                table[(size_t) o] = Category::bitwise;
+
+            for (auto o : { Op::logicalOr, Op::logicalAnd })
+                table[(size_t) o] = Category::logical;
+
+            for (auto o : { Op::equals, Op::notEquals })
+                table[(size_t) o] = Category::equality;
+
+            for (auto o : { Op::lessThan, Op::lessThanOrEqual, Op::greaterThan, Op::greaterThanOrEqual })
+                table[(size_t) o] = Category::comparison;
+
+            return table;
+        }();
+
+        return categories[(size_t) op];
     }
 
+    inline bool isLogicalOperator    (Op t) noexcept    { return getCategory (t) == Category::logical; }
+    inline bool isEqualityOperator   (Op t) noexcept    { return getCategory (t) == Category::equality; }
+    inline bool isComparisonOperator (Op t) noexcept    { return getCategory (t) == Category::comparison; }
+    inline bool isBitwiseOperator    (Op t) noexcept    { return getCategory (t) == Category::bitwise; }
+    inline bool isArithmeticOperator (Op t) noexcept    { return getCategory (t) == Category::arithmetic; }
+
     inline TypeRules::BinaryOperatorTypes getTypes (Op op, const Type& a, const Type& b)
     {
-        if (isLogicalOperator (op))       return TypeRules::getTypesForLogicalOp (a, b);
-        if (isBitwiseOperator (op))       return TypeRules::getTypesForBitwiseOp (a, b);
-        if (isEqualityOperator (op))      return TypeRules::getTypesForEqualityOp (a, b);
-        if (isComparisonOperator (op))    return TypeRules::getTypesForComparisonOp (a, b);
-        if (isArithmeticOperator (op))    return TypeRules::getTypesForArithmeticOp (a, b);
+        switch (getCategory (op))
+        {
+            case Category::logical:     return TypeRules::getTypesForLogicalOp (a, b);
+            case Category::bitwise:     return TypeRules::getTypesForBitwiseOp (a, b);
+            case Category::equality:    return TypeRules::getTypesForEqualityOp (a, b);
+            case Category::comparison:  return TypeRules::getTypesForComparisonOp (a, b);
+            case Category::arithmetic:  return TypeRules::getTypesForArithmeticOp (a, b);
+            default:                    break;
+        }
 
         SOUL_ASSERT_FALSE;
         return {};
@@ -137,6 +137,18 @@ struct Program::ProgramImpl  : public RefCountedObject
         return result;
     }
 
+    std::vector<pool_ref<heart::Function>> getExternalFunctions() const
+    {
+        std::vector<pool_ref<heart::Function>> result;
+
+        for (auto& m : modules)
+            for (auto& f : m->functions)
+                if (f->isExternal())
+                    result.push_back (f);
+
+        return result;
+    }
+
     Program clone() const
     {
         Program newProgram;
@@ -146,6 +158,22 @@ struct Program::ProgramImpl  : public RefCountedObject
         ModuleCloner::StructMappings structMappings;
         ModuleCloner::VariableMappings variableMappings;
         std::vector<ModuleCloner> cloners;
+        cloners.reserve (modules.size());
+
+        {
+            size_t totalFunctions = 0, totalStructs = 0, totalStateVariables = 0;
+
+            for (auto& m : modules)
+            {
+                totalFunctions += m->functions.size();
+                totalStructs += m->structs.size();
+                totalStateVariables += m->stateVariables.size();
+            }
+
+            functionMappings.reserve (totalFunctions);
+            structMappings.reserve (totalStructs);
+            variableMappings.reserve (totalStateVariables);
+        }
 
         for (auto& m : modules)
         {
@@ -277,7 +305,7 @@ Program Program::createFromHEART (CompileMessageList& messageList, CodeLocation
     {
         CompileMessageHandler handler (messageList);
         auto program = heart::Parser::parse (std::move (heartCode));
-        heart::Checker::sanityCheck (program);
+        heart::Checker::sanityCheckInParallel (program);
         return program;
     }
     catch (AbortCompilationException) {}
@@ -309,12 +337,85 @@ const StringDictionary& Program::getStringDictionary() const
 ConstantTable& Program::getConstantTable()                                              { return pimpl->constantTable; }
 const ConstantTable& Program::getConstantTable() const                                  { return pimpl->constantTable; }
 std::vector<pool_ref<heart::Variable>> Program::getExternalVariables() const            { return pimpl->getExternalVariables(); }
+std::vector<pool_ref<heart::Function>> Program::getExternalFunctions() const            { return pimpl->getExternalFunctions(); }
 uint32_t Program::getModuleID (Module& m, uint32_t arraySize)                           { return pimpl->getModuleID (m, arraySize); }
 const char* Program::getRootNamespaceName()                                             { return "_root"; }
 std::string Program::stripRootNamespaceFromQualifiedPath (std::string path)             { return TokenisedPathString::removeTopLevelNameIfPresent (path, getRootNamespaceName()); }
 
+size_t Program::deduplicateIdenticalModules()
+{
+    // Identity is judged on the printed HEART with the module's own name erased
+    // from its header - exactly what a back-end will consume - so any difference
+    // in endpoints, annotations or code naturally prevents a merge. Namespaces
+    // stay out of it because their functions are referenced by name from other
+    // modules, and anything with externals stays distinct because externals are
+    // bound to their module's path.
+    std::unordered_map<std::string, pool_ref<Module>> canonicalModules;
+    std::vector<pool_ref<Module>> duplicates;
+    std::unordered_map<std::string, std::string> renames;
+
+    for (auto& m : getModules())
+    {
+        if (m->isNamespace())
+            continue;
+
+        auto hasExternals = std::any_of (m->stateVariables.begin(), m->stateVariables.end(),
+                                         [] (const pool_ref<heart::Variable>& v) { return v->isExternal(); });
+
+        if (hasExternals)
+            continue;
+
+        auto body = heart::Printer::getModuleDump (m);
+        auto namePos = body.find (m->fullName);
+
+        if (namePos == std::string::npos)
+            continue;
+
+        // only the header occurrence is erased: a blanket substring replacement
+        // could mangle another module's name that happens to contain this one
+        body.erase (namePos, m->fullName.length());
+
+        auto existing = canonicalModules.find (body);
+
+        if (existing == canonicalModules.end())
+        {
+            canonicalModules.insert ({ std::move (body), m });
+            continue;
+        }
+
+        renames[m->fullName] = existing->second->fullName;
+        duplicates.push_back (m);
+    }
+
+    if (duplicates.empty())
+        return 0;
+
+    for (auto& m : getModules())
+        if (m->isGraph())
+            for (auto& i : m->processorInstances)
+            {
+                auto renamed = renames.find (i->sourceName);
+
+                if (renamed != renames.end())
+                    i->sourceName = renamed->second;
+            }
+
+    for (auto& d : duplicates)
+        removeModule (d);
+
+    return duplicates.size();
+}
+
 std::string Program::getHash() const
 {
+    // The binary serialisation describes the program's structure completely, so
+    // hashing it gives the same identity as hashing a dump but without paying
+    // for any of the printer's string formatting, and the key doesn't change
+    // when the printed layout does
+    if (auto structuralHash = heart::Serialiser::getStructuralHash (*this))
+        return toHexString (static_cast<int64_t> (structuralHash), 16);
+
+    // A program which the binary format can't represent falls back to the dump
     choc::text::CodePrinter dump;
     heart::Printer::print (*this, dump);
     HashBuilder hash;
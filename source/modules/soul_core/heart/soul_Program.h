@@ -68,6 +68,14 @@ public:
     /** Removes the given module */
     void removeModule (Module&);
 
+    /** Merges structurally identical processor and graph modules, re-pointing the
+        instances that referred to the removed copies at the surviving one.
+        Generic specialisation often produces one clone per call site, so this is
+        worth running after optimisation, when identical clones have converged on
+        identical code. Returns the number of modules removed.
+    */
+    size_t deduplicateIdenticalModules();
+
     /** Returns the module that should be used as the main entry point of the program, or nullptr
         if no suitable module exists.
     */
@@ -92,7 +100,11 @@ public:
     /** Looks for a variable with a (fully-qualified) name. */
     pool_ptr<heart::Variable> findVariableWithName (const std::string& name) const;
 
-    /** Generates a repeatable hash code for the complete state of this program. */
+    /** Generates a repeatable hash code for the complete state of this program.
+        This is intended for use as a cache key: it's computed from the binary
+        serialisation rather than a printed dump, so it's cheap to obtain and
+        stays stable across formatting changes in the HEART printer.
+    */
     std::string getHash() const;
 
     /** Provides access to the program's string dictionary */
@@ -110,6 +122,11 @@ public:
     /** Finds a list of all the externals in the program. */
     std::vector<pool_ref<heart::Variable>> getExternalVariables() const;
 
+    /** Finds a list of all the external functions in the program, whose
+        implementations a host must supply before the program can be linked.
+    */
+    std::vector<pool_ref<heart::Function>> getExternalFunctions() const;
+
     /** Returns an ID for one of the modules in the program (which will be unique
         within the program but not globally). The arraySize indicates how many unique ids
         are required for the module, as a range from the returned value
@@ -74,6 +74,8 @@ struct heart
     struct Printer;
     struct Checker;
     struct Utilities;
+    struct Interpreter;
+    struct Serialiser;
 
     static constexpr const char* getRunFunctionName()               { return "run"; }
     static constexpr const char* getUserInitFunctionName()          { return "init"; }
@@ -95,6 +97,20 @@ struct heart
         template <typename Type, typename... Args>
         Type& allocate (Args&&... args)                       { return pool.allocate<Type> (std::forward<Args> (args)...); }
 
+        /** Statements and terminators are bump-allocated into their own pool, separate
+            from the expressions and types they refer to, so that the instruction stream
+            of a function sits consecutively in memory in emission order rather than
+            being interleaved with its operands - the passes that walk whole blocks
+            statement-by-statement then touch far fewer cache lines.
+        */
+        template <typename Type, typename... Args>
+        Type& allocateStatement (Args&&... args)
+        {
+            static_assert (std::is_base_of<Statement, Type>::value || std::is_base_of<Terminator, Type>::value,
+                           "allocateStatement is only for the statement and terminator types");
+            return statementPool.allocate<Type> (std::forward<Args> (args)...);
+        }
+
         template <typename ValueType>
         Constant& allocateConstant (ValueType value)          { return allocate<heart::Constant> (CodeLocation(), value); }
         Constant& allocateConstant (Value value)              { return allocate<heart::Constant> (CodeLocation(), std::move (value)); }
@@ -103,7 +119,7 @@ struct heart
         template <typename Type>
         Identifier get (const Type& newString)  { return identifiers.get (newString); }
 
-        PoolAllocator pool;
+        PoolAllocator pool, statementPool;
         Identifier::Pool identifiers;
     };
 
@@ -148,6 +164,9 @@ struct heart
                 if (! dataType.isPrimitiveOrVector())
                     errorLocation.throwError (Errors::illegalTypeForEndpoint());
 
+                if (dataType.isFloat16())
+                    errorLocation.throwError (Errors::float16CannotBeUsedForStream());
+
                 if (dataType.isVoid())
                     errorLocation.throwError (Errors::voidCannotBeUsedForEndpoint());
             }
@@ -272,6 +291,13 @@ struct heart
         int64_t clockMultiplier = 1;
         int64_t clockDivider = 1;
         uint32_t arraySize = 1;
+
+        /** The parallel scheduling stage this instance belongs to within its parent graph.
+            Instances sharing a stage have no data dependencies on each other, so an engine
+            may render them concurrently. @see heart::Utilities::assignParallelRenderStages
+        */
+        uint32_t renderStage = 0;
+
         TemporaryDataHolder tempData;
 
         bool hasClockMultiplier() const    { return clockMultiplier != 1; }
@@ -291,9 +317,18 @@ struct heart
     {
         Connection (CodeLocation l) : Object (std::move (l)) {}
 
+        static constexpr uint32_t noBufferSlot = 0xffffffff;
+
         EndpointReference source, dest;
         InterpolationType interpolationType = InterpolationType::none;
         int64_t delayLength = 0;
+
+        /** The index of the pooled intermediate buffer this connection's stream data
+            travels through, or noBufferSlot where no pooled buffer applies (the
+            graph's own endpoints, event connections, and delayed connections).
+            @see heart::Utilities::assignConnectionBufferSlots
+        */
+        uint32_t bufferSlot = noBufferSlot;
     };
 
     template <typename Thrower>
@@ -723,6 +758,22 @@ struct heart
         Type type = Type::normal;
     };
 
+    /** Which region of memory a back-end should place a function's code in.
+
+        Interleaving init(), once-off setup and run-loop code in memory pollutes
+        the instruction cache with bytes that execute once or never, which shows
+        up as icache misses in programs built from many small processors. The
+        classification is derived from the call graph by
+        Optimisations::assignCodeSections(), so a back-end can emit everything
+        marked cold into a separate section away from the render loop.
+    */
+    enum class CodeSection  : uint8_t
+    {
+        unknown = 0,   /**< Not yet classified. */
+        hot,           /**< Reachable from the render path: run() or an event handler. */
+        cold           /**< Only reachable from initialisation, or not at all. */
+    };
+
     //==============================================================================
     struct Function  : public Object
     {
@@ -740,6 +791,7 @@ struct heart
         bool hasNoBody = false;
         bool functionUseTestFlag = false;
         uint64_t localVariableStackSize = 0;
+        CodeSection codeSection = CodeSection::unknown;
 
         void addStateParameter (Variable& param)
         {
@@ -771,6 +823,16 @@ struct heart
             return ioParameter != nullptr;
         }
 
+        /** True for a function whose implementation is supplied by the host at
+            link time, through the performer's external function API. These always
+            have hasNoBody set, and their signatures are restricted to types that
+            can cross the boundary as a plain C-style call.
+        */
+        bool isExternal() const
+        {
+            return annotation.getBool ("external");
+        }
+
         bool hasSameSignature (const Function& other) const
         {
             if (name != other.name || parameters.size() != other.parameters.size())
@@ -997,10 +1059,23 @@ struct heart
 
         }
 
+        /** A hint about which way this branch usually goes at runtime, derived from
+            semantic knowledge during HEART generation - e.g. a loop's continuation
+            test is almost always true, and a wrap-around counter check is almost
+            always false. Back-ends can use this to lay out the hot path contiguously.
+        */
+        enum class Likelihood  : uint8_t
+        {
+            unknown = 0,
+            likelyTrue,
+            likelyFalse
+        };
+
         pool_ref<Expression> condition;
         pool_ref<Block> targets[2];   // index 0 = true, 1 = false
         using ArgListType = ArrayWithPreallocation<pool_ref<Expression>, 4>;
         ArgListType targetArgs[2];
+        Likelihood likelihood = Likelihood::unknown;
     };
 
     struct ReturnVoid  : public Terminator
@@ -88,6 +88,45 @@ struct CallFlowGraph
         return results;
     }
 
+    struct ProcessorStackUsage
+    {
+        pool_ptr<Module> processor;
+        uint64_t maximumStackSize = 0;
+    };
+
+    /** Estimates the worst-case stack usage of each processor in a program, by
+        walking every call sequence that can start from one of the processor's
+        functions. The per-function sizes assume that locals with disjoint
+        lifetimes share slots, so the result is what a reasonable code generator
+        should achieve, and an embedded host can use it to size a render thread's
+        stack. Recursive sequences are abandoned rather than followed forever, so
+        the numbers are only meaningful for a program that has already passed the
+        checker's recursion check.
+    */
+    static std::vector<ProcessorStackUsage> calculateProcessorStackUsage (const Program& program)
+    {
+        for (auto& m : program.getModules())
+            for (auto& f : m->functions)
+                f->localVariableStackSize = 0;
+
+        std::vector<ProcessorStackUsage> results;
+
+        for (auto& m : program.getModules())
+        {
+            if (m->isProcessor())
+            {
+                CallSequenceCheckResults callResults;
+
+                for (auto& f : m->functions)
+                    iterateCallSequences (f, callResults, nullptr, 0);
+
+                results.push_back ({ m, callResults.maximumStackSize });
+            }
+        }
+
+        return results;
+    }
+
 private:
     //==============================================================================
     static void resetVisitedFlags (const heart::Function& f)
@@ -313,18 +352,205 @@ private:
                     iterateCallSequences (call->getFunction(), results, std::addressof (newPrevious), stackSize);
     }
 
+    /** Estimates the number of bytes of stack that a function's local variables
+        need. Locals whose lifetimes never overlap are assumed to share a slot, the
+        way a code generator re-uses spill space - liveness is tracked per block, so
+        two variables only conflict if there's a block in which both are live.
+    */
     static void calculateLocalVariableStackSize (heart::Function& f)
     {
         if (f.localVariableStackSize == 0)
         {
             uint64_t total = 0;
 
-            for (auto& v : f.getAllLocalVariables())
-                total += getAlignedSize<stackItemAlignment> (v->getType().getPackedSizeInBytes());
+            for (auto slotSize : calculateSharedSlotSizes (f))
+                total += slotSize;
 
             f.localVariableStackSize = total;
         }
     }
+
+    /** Packs a function's local variables into shared stack slots, returning the
+        aligned size of each slot. Two locals can share a slot when there's no
+        block in which both are live; the bigger variables are placed first so
+        that smaller ones fill the gaps they leave.
+    */
+    static std::vector<uint64_t> calculateSharedSlotSizes (const heart::Function& f)
+    {
+        auto locals = f.getAllLocalVariables();
+        auto numLocals = locals.size();
+        auto numBlocks = f.blocks.size();
+
+        if (numLocals == 0 || numBlocks == 0)
+            return {};
+
+        std::unordered_map<const heart::Variable*, size_t> localIndexes;
+        std::unordered_map<const heart::Block*, size_t> blockIndexes;
+
+        for (size_t i = 0; i < numLocals; ++i)
+            localIndexes[locals[i].getPointer()] = i;
+
+        for (size_t i = 0; i < numBlocks; ++i)
+            blockIndexes[f.blocks[i].getPointer()] = i;
+
+        using BitSet = std::vector<bool>;
+
+        std::vector<BitSet> upwardExposed  (numBlocks, BitSet (numLocals, false)),
+                            killed         (numBlocks, BitSet (numLocals, false)),
+                            liveIn         (numBlocks, BitSet (numLocals, false)),
+                            blocksWhereLive (numLocals, BitSet (numBlocks, false));
+
+        for (size_t blockNum = 0; blockNum < numBlocks; ++blockNum)
+        {
+            auto& b = f.blocks[blockNum];
+            auto& ue = upwardExposed[blockNum];
+            auto& kills = killed[blockNum];
+
+            auto visitAccess = [&] (pool_ref<heart::Expression>& value, AccessType)
+            {
+                if (auto v = cast<heart::Variable> (value))
+                {
+                    auto local = localIndexes.find (v.get());
+
+                    if (local != localIndexes.end())
+                    {
+                        blocksWhereLive[local->second][blockNum] = true;
+
+                        if (! kills[local->second])
+                            ue[local->second] = true;
+                    }
+                }
+            };
+
+            for (auto s : b->statements)
+            {
+                // As in findUninitialisedVariableUse(), only a direct whole-variable
+                // assignment counts as a kill - a write to a sub-element leaves the
+                // rest of the old value alive
+                pool_ptr<heart::Variable> killTarget;
+
+                if (auto assignment = cast<heart::Assignment> (*s))
+                    killTarget = cast<heart::Variable> (assignment->target);
+
+                s->visitExpressions ([&] (pool_ref<heart::Expression>& value, AccessType mode)
+                {
+                    if (mode == AccessType::write && value.getPointer() == killTarget.get())
+                        return;  // overwriting the whole variable isn't a use of its old value
+
+                    visitAccess (value, mode);
+                });
+
+                if (killTarget != nullptr)
+                {
+                    auto local = localIndexes.find (killTarget.get());
+
+                    if (local != localIndexes.end())
+                    {
+                        blocksWhereLive[local->second][blockNum] = true;
+                        kills[local->second] = true;
+                    }
+                }
+            }
+
+            b->terminator->visitExpressions (visitAccess);
+        }
+
+        liveIn = upwardExposed;
+
+        for (bool anyChanges = true; anyChanges;)
+        {
+            anyChanges = false;
+
+            for (size_t blockNum = numBlocks; blockNum-- != 0;)
+            {
+                for (auto dest : f.blocks[blockNum]->terminator->getDestinationBlocks())
+                {
+                    auto& successorLiveIn = liveIn[blockIndexes[dest.getPointer()]];
+
+                    for (size_t i = 0; i < numLocals; ++i)
+                    {
+                        if (successorLiveIn[i] && ! killed[blockNum][i] && ! liveIn[blockNum][i])
+                        {
+                            liveIn[blockNum][i] = true;
+                            anyChanges = true;
+                        }
+                    }
+                }
+            }
+        }
+
+        for (size_t blockNum = 0; blockNum < numBlocks; ++blockNum)
+        {
+            for (size_t i = 0; i < numLocals; ++i)
+                if (liveIn[blockNum][i])
+                    blocksWhereLive[i][blockNum] = true;
+
+            for (auto dest : f.blocks[blockNum]->terminator->getDestinationBlocks())
+            {
+                auto& successorLiveIn = liveIn[blockIndexes[dest.getPointer()]];
+
+                for (size_t i = 0; i < numLocals; ++i)
+                    if (successorLiveIn[i])
+                        blocksWhereLive[i][blockNum] = true;
+            }
+        }
+
+        auto getSlotSize = [&] (size_t localIndex)
+        {
+            return getAlignedSize<stackItemAlignment> (locals[localIndex]->getType().getPackedSizeInBytes());
+        };
+
+        std::vector<size_t> packingOrder (numLocals);
+        std::iota (packingOrder.begin(), packingOrder.end(), 0);
+        std::sort (packingOrder.begin(), packingOrder.end(),
+                   [&] (size_t a, size_t b) { return getSlotSize (a) > getSlotSize (b); });
+
+        struct Slot
+        {
+            uint64_t size;
+            BitSet blocksWhereOccupied;
+        };
+
+        std::vector<Slot> slots;
+
+        for (auto localIndex : packingOrder)
+        {
+            auto& varLiveBlocks = blocksWhereLive[localIndex];
+            Slot* sharedSlot = nullptr;
+
+            for (auto& slot : slots)
+            {
+                bool overlaps = false;
+
+                for (size_t blockNum = 0; blockNum < numBlocks; ++blockNum)
+                    overlaps = overlaps || (slot.blocksWhereOccupied[blockNum] && varLiveBlocks[blockNum]);
+
+                if (! overlaps)
+                {
+                    sharedSlot = std::addressof (slot);
+                    break;
+                }
+            }
+
+            if (sharedSlot != nullptr)
+            {
+                for (size_t blockNum = 0; blockNum < numBlocks; ++blockNum)
+                    if (varLiveBlocks[blockNum])
+                        sharedSlot->blocksWhereOccupied[blockNum] = true;
+            }
+            else
+            {
+                slots.push_back ({ getSlotSize (localIndex), varLiveBlocks });
+            }
+        }
+
+        std::vector<uint64_t> sizes;
+
+        for (auto& slot : slots)
+            sizes.push_back (slot.size);
+
+        return sizes;
+    }
 };
 
 } // namespace soul
@@ -36,6 +36,84 @@ struct heart::Checker
         checkStreamOperations (program);
     }
 
+    /** A multi-threaded equivalent of sanityCheck().
+
+        The whole-program checks (the main processor's endpoints, the call graph
+        and graph cycles) run on the calling thread, and the per-module checks are
+        sharded across a thread pool, with each module collecting its messages in
+        a private list. The lists are merged in module order before being
+        reported, so the output is deterministic, although a program with errors
+        in several modules may group them by module rather than by check.
+    */
+    static void sanityCheckInParallel (const Program& program)
+    {
+        ignoreUnused (program.getMainProcessor());
+        sanityCheckInputsAndOutputs (program);
+        checkForRecursiveFunctions (program);
+        checkForCyclesInGraphs (program);
+
+        auto& modules = program.getModules();
+
+        if (modules.size() < 2)
+        {
+            for (auto& m : modules)
+                runChecksForModule (program, m);
+
+            return;
+        }
+
+        struct ModuleCheck
+        {
+            ModuleCheck (const Program& p, Module& moduleToCheck)  : program (p), module (moduleToCheck) {}
+
+            const Program& program;
+            Module& module;
+            CompileMessageList messages;
+        };
+
+        std::vector<ModuleCheck> checks;
+        checks.reserve (modules.size());
+
+        for (auto& m : modules)
+            checks.emplace_back (program, m.get());
+
+        {
+            ThreadPool pool (ThreadPool::getRecommendedNumberOfThreads (checks.size()));
+
+            for (auto& check : checks)
+                pool.addJob ([&check]
+                             {
+                                 try
+                                 {
+                                     CompileMessageHandler handler (check.messages);
+                                     runChecksForModule (check.program, check.module);
+                                 }
+                                 catch (AbortCompilationException) {}
+                             });
+        }
+
+        CompileMessageGroup mergedMessages;
+
+        for (auto& check : checks)
+            for (auto& message : check.messages.messages)
+                mergedMessages.messages.push_back (message);
+
+        if (! mergedMessages.messages.empty())
+            soul::throwError (mergedMessages);
+    }
+
+    /** Runs all the checks which only look at a single module, in the same order
+        in which sanityCheck() visits them.
+    */
+    static void runChecksForModule (const Program& program, Module& m)
+    {
+        sanityCheckAdvanceAndStreamCalls (m);
+        checkConnections (program, m);
+        checkForInfiniteLoops (m);
+        checkBlockParameters (m);
+        checkStreamOperations (m);
+    }
+
     static void sanityCheckInputsAndOutputs (const Program& program)
     {
         auto& mainProcessor = program.getMainProcessor();
@@ -57,70 +135,73 @@ struct heart::Checker
     static void checkConnections (const Program& program)
     {
         for (auto& m : program.getModules())
+            checkConnections (program, m);
+    }
+
+    static void checkConnections (const Program& program, Module& m)
+    {
+        if (! m.isGraph())
+            return;
+
+        for (auto& conn : m.connections)
         {
-            if (m->isGraph())
-            {
-                for (auto& conn : m->connections)
-                {
-                    pool_ptr<heart::IODeclaration> sourceOutput, destInput;
-                    size_t sourceInstanceArraySize = 1, destInstanceArraySize = 1;
-                    auto sourceDescription = conn->source.endpointName;
-                    auto destDescription   = conn->dest.endpointName;
+            pool_ptr<heart::IODeclaration> sourceOutput, destInput;
+            size_t sourceInstanceArraySize = 1, destInstanceArraySize = 1;
+            auto sourceDescription = conn->source.endpointName;
+            auto destDescription   = conn->dest.endpointName;
 
-                    if (auto sourceProcessor = conn->source.processor)
-                    {
-                        auto sourceModule = program.findModuleWithName (sourceProcessor->sourceName);
+            if (auto sourceProcessor = conn->source.processor)
+            {
+                auto sourceModule = program.findModuleWithName (sourceProcessor->sourceName);
 
-                        if (sourceModule == nullptr)
-                            conn->location.throwError (Errors::cannotFindProcessor (sourceProcessor->sourceName));
+                if (sourceModule == nullptr)
+                    conn->location.throwError (Errors::cannotFindProcessor (sourceProcessor->sourceName));
 
-                        sourceOutput = sourceModule->findOutput (conn->source.endpointName);
-                        sourceInstanceArraySize = conn->source.endpointIndex.has_value() ? sourceProcessor->arraySize : 1;
-                        sourceDescription = sourceProcessor->instanceName + "." + sourceDescription;
-                    }
-                    else
-                    {
-                        sourceOutput = m->findInput (conn->source.endpointName);
-                    }
+                sourceOutput = sourceModule->findOutput (conn->source.endpointName);
+                sourceInstanceArraySize = conn->source.endpointIndex.has_value() ? sourceProcessor->arraySize : 1;
+                sourceDescription = sourceProcessor->instanceName + "." + sourceDescription;
+            }
+            else
+            {
+                sourceOutput = m.findInput (conn->source.endpointName);
+            }
 
-                    if (auto destProcessor = conn->dest.processor)
-                    {
-                        auto destModule = program.findModuleWithName (destProcessor->sourceName);
+            if (auto destProcessor = conn->dest.processor)
+            {
+                auto destModule = program.findModuleWithName (destProcessor->sourceName);
 
-                        if (destModule == nullptr)
-                            conn->location.throwError (Errors::cannotFindProcessor (destProcessor->sourceName));
+                if (destModule == nullptr)
+                    conn->location.throwError (Errors::cannotFindProcessor (destProcessor->sourceName));
 
-                        destInput = destModule->findInput (conn->dest.endpointName);
-                        destInstanceArraySize = conn->dest.endpointIndex.has_value() ? destProcessor->arraySize : 1;
-                        destDescription = destProcessor->instanceName + "." + destDescription;
-                    }
-                    else
-                    {
-                        destInput = m->findOutput (conn->dest.endpointName);
-                    }
+                destInput = destModule->findInput (conn->dest.endpointName);
+                destInstanceArraySize = conn->dest.endpointIndex.has_value() ? destProcessor->arraySize : 1;
+                destDescription = destProcessor->instanceName + "." + destDescription;
+            }
+            else
+            {
+                destInput = m.findOutput (conn->dest.endpointName);
+            }
 
-                    if (sourceOutput == nullptr)  conn->location.throwError (Errors::cannotFindSource (sourceDescription));
-                    if (destInput == nullptr)     conn->location.throwError (Errors::cannotFindDestination (destDescription));
+            if (sourceOutput == nullptr)  conn->location.throwError (Errors::cannotFindSource (sourceDescription));
+            if (destInput == nullptr)     conn->location.throwError (Errors::cannotFindDestination (destDescription));
 
-                    if (conn->source.endpointIndex && sourceOutput->arraySize <= conn->source.endpointIndex)
-                        conn->location.throwError (Errors::sourceEndpointIndexOutOfRange());
+            if (conn->source.endpointIndex && sourceOutput->arraySize <= conn->source.endpointIndex)
+                conn->location.throwError (Errors::sourceEndpointIndexOutOfRange());
 
-                    if (conn->dest.endpointIndex && destInput->arraySize <= conn->dest.endpointIndex)
-                        conn->location.throwError (Errors::destinationEndpointIndexOutOfRange());
+            if (conn->dest.endpointIndex && destInput->arraySize <= conn->dest.endpointIndex)
+                conn->location.throwError (Errors::destinationEndpointIndexOutOfRange());
 
-                    if (sourceOutput->endpointType != destInput->endpointType)
-                        conn->location.throwError (Errors::cannotConnect (sourceDescription, getEndpointTypeName (sourceOutput->endpointType),
-                                                                          destDescription, getEndpointTypeName (destInput->endpointType)));
+            if (sourceOutput->endpointType != destInput->endpointType)
+                conn->location.throwError (Errors::cannotConnect (sourceDescription, getEndpointTypeName (sourceOutput->endpointType),
+                                                                  destDescription, getEndpointTypeName (destInput->endpointType)));
 
-                    if (! areConnectionTypesCompatible (sourceOutput->isEventEndpoint(),
-                                                        *sourceOutput,
-                                                        sourceInstanceArraySize,
-                                                        *destInput,
-                                                        destInstanceArraySize))
-                        conn->location.throwError (Errors::cannotConnect (sourceDescription, sourceOutput->getTypesDescription(),
-                                                                          destDescription, destInput->getTypesDescription()));
-                }
-            }
+            if (! areConnectionTypesCompatible (sourceOutput->isEventEndpoint(),
+                                                *sourceOutput,
+                                                sourceInstanceArraySize,
+                                                *destInput,
+                                                destInstanceArraySize))
+                conn->location.throwError (Errors::cannotConnect (sourceDescription, sourceOutput->getTypesDescription(),
+                                                                  destDescription, destInput->getTypesDescription()));
         }
     }
 
@@ -165,32 +246,35 @@ struct heart::Checker
     static void sanityCheckAdvanceAndStreamCalls (const Program& program)
     {
         for (auto& m : program.getModules())
+            sanityCheckAdvanceAndStreamCalls (m);
+    }
+
+    static void sanityCheckAdvanceAndStreamCalls (Module& m)
+    {
+        for (auto& f : m.functions)
         {
-            for (auto& f : m->functions)
-            {
-                auto firstAdvanceCall = heart::Utilities::findFirstAdvanceCall (f);
+            auto firstAdvanceCall = heart::Utilities::findFirstAdvanceCall (f);
 
-                if (f->functionType.isRun() && firstAdvanceCall == nullptr)
-                    f->location.throwError (Errors::runFunctionMustCallAdvance());
+            if (f->functionType.isRun() && firstAdvanceCall == nullptr)
+                f->location.throwError (Errors::runFunctionMustCallAdvance());
 
-                if (firstAdvanceCall != nullptr && ! m->isProcessor())
-                    firstAdvanceCall->location.throwError (Errors::advanceCannotBeCalledHere());
+            if (firstAdvanceCall != nullptr && ! m.isProcessor())
+                firstAdvanceCall->location.throwError (Errors::advanceCannotBeCalledHere());
 
-                if (! f->functionType.isSystemInit())
+            if (! f->functionType.isSystemInit())
+            {
+                f->visitStatements<heart::FunctionCall> ([] (heart::FunctionCall& call)
                 {
-                    f->visitStatements<heart::FunctionCall> ([] (heart::FunctionCall& call)
-                    {
-                        auto& target = *call.function;
+                    auto& target = *call.function;
 
-                        if (target.functionType.isRun() || target.functionType.isUserInit() || target.functionType.isEvent())
-                            target.location.throwError (Errors::cannotCallFunction (target.getReadableName()));
-                    });
-                }
-
-                if (f->functionType.isUserInit())
-                    if (auto rw = heart::Utilities::findFirstStreamAccess (f))
-                        rw->location.throwError (Errors::streamsCannotBeUsedDuringInit());
+                    if (target.functionType.isRun() || target.functionType.isUserInit() || target.functionType.isEvent())
+                        target.location.throwError (Errors::cannotCallFunction (target.getReadableName()));
+                });
             }
+
+            if (f->functionType.isUserInit())
+                if (auto rw = heart::Utilities::findFirstStreamAccess (f))
+                    rw->location.throwError (Errors::streamsCannotBeUsedDuringInit());
         }
     }
 
@@ -198,9 +282,14 @@ struct heart::Checker
     static void checkForInfiniteLoops (const Program& program)
     {
         for (auto& m : program.getModules())
-            for (auto& f : m->functions)
-                if (CallFlowGraph::doesFunctionContainInfiniteLoops (f))
-                    f->location.throwError (Errors::functionContainsAnInfiniteLoop (f->getReadableName()));
+            checkForInfiniteLoops (m);
+    }
+
+    static void checkForInfiniteLoops (Module& m)
+    {
+        for (auto& f : m.functions)
+            if (CallFlowGraph::doesFunctionContainInfiniteLoops (f))
+                f->location.throwError (Errors::functionContainsAnInfiniteLoop (f->getReadableName()));
     }
 
     static void checkForRecursiveFunctions (const Program& program)
@@ -225,55 +314,58 @@ struct heart::Checker
     static void checkStreamOperations (const Program& program)
     {
         for (auto& m : program.getModules())
+            checkStreamOperations (m);
+    }
+
+    static void checkStreamOperations (Module& m)
+    {
+        for (auto& f : m.functions)
         {
-            for (auto& f : m->functions)
+            for (auto& b : f->blocks)
             {
-                for (auto& b : f->blocks)
+                for (auto s : b->statements)
                 {
-                    for (auto s : b->statements)
+                    if (auto r = cast<heart::ReadStream> (*s))
                     {
-                        if (auto r = cast<heart::ReadStream> (*s))
-                        {
-                            if (f->functionType.isUserInit())
-                                s->location.throwError (Errors::streamsCannotBeUsedDuringInit());
+                        if (f->functionType.isUserInit())
+                            s->location.throwError (Errors::streamsCannotBeUsedDuringInit());
 
-                            if (! f->functionType.isRun())
-                                s->location.throwError (Errors::streamsCanOnlyBeUsedInRun());
+                        if (! f->functionType.isRun())
+                            s->location.throwError (Errors::streamsCanOnlyBeUsedInRun());
 
-                            if (r->element)
-                            {
-                                if (! r->source->arraySize.has_value())
-                                    s->location.throwError (Errors::endpointIndexInvalid());
+                        if (r->element)
+                        {
+                            if (! r->source->arraySize.has_value())
+                                s->location.throwError (Errors::endpointIndexInvalid());
 
-                                if (r->element->getAsConstant().isValid())
-                                    TypeRules::checkAndGetArrayIndex (r->location, r->element->getAsConstant(), r->source->dataTypes.front().createArray (*r->source->arraySize));
-                            }
+                            if (r->element->getAsConstant().isValid())
+                                TypeRules::checkAndGetArrayIndex (r->location, r->element->getAsConstant(), r->source->dataTypes.front().createArray (*r->source->arraySize));
                         }
+                    }
 
-                        if (auto w = cast<heart::WriteStream> (*s))
+                    if (auto w = cast<heart::WriteStream> (*s))
+                    {
+                        if (f->functionType.isUserInit())
+                            s->location.throwError (Errors::streamsCannotBeUsedDuringInit());
+
+                        if (! (f->functionType.isRun() || w->target->isEventEndpoint()))
+                            s->location.throwError (Errors::streamsCanOnlyBeUsedInRun());
+
+                        if (! w->element)
                         {
-                            if (f->functionType.isUserInit())
-                                s->location.throwError (Errors::streamsCannotBeUsedDuringInit());
-
-                            if (! (f->functionType.isRun() || w->target->isEventEndpoint()))
-                                s->location.throwError (Errors::streamsCanOnlyBeUsedInRun());
-
-                            if (! w->element)
-                            {
-                                if (! w->target->canHandleType (w->value->getType()))
-                                    s->location.throwError (Errors::wrongTypeForEndpoint());
-                            }
-                            else
-                            {
-                                if (! w->target->arraySize.has_value())
-                                    s->location.throwError (Errors::endpointIndexInvalid());
-
-                                if (! w->target->canHandleElementType (w->value->getType()))
-                                    s->location.throwError (Errors::wrongTypeForEndpoint());
-
-                                if (w->element->getAsConstant().isValid())
-                                    TypeRules::checkAndGetArrayIndex (w->location, w->element->getAsConstant(), w->target->dataTypes.front().createArray (*w->target->arraySize));
-                            }
+                            if (! w->target->canHandleType (w->value->getType()))
+                                s->location.throwError (Errors::wrongTypeForEndpoint());
+                        }
+                        else
+                        {
+                            if (! w->target->arraySize.has_value())
+                                s->location.throwError (Errors::endpointIndexInvalid());
+
+                            if (! w->target->canHandleElementType (w->value->getType()))
+                                s->location.throwError (Errors::wrongTypeForEndpoint());
+
+                            if (w->element->getAsConstant().isValid())
+                                TypeRules::checkAndGetArrayIndex (w->location, w->element->getAsConstant(), w->target->dataTypes.front().createArray (*w->target->arraySize));
                         }
                     }
                 }
@@ -284,44 +376,47 @@ struct heart::Checker
     static void checkBlockParameters (const Program& program)
     {
         for (auto& m : program.getModules())
+            checkBlockParameters (m);
+    }
+
+    static void checkBlockParameters (Module& m)
+    {
+        for (auto& f : m.functions)
         {
-            for (auto& f : m->functions)
+            if (! f->blocks.empty())
             {
-                if (! f->blocks.empty())
-                {
-                    if (! f->blocks[0]->parameters.empty())
-                        f->location.throwError (Errors::functionBlockCantBeParameterised (f->blocks[0]->name));
+                if (! f->blocks[0]->parameters.empty())
+                    f->location.throwError (Errors::functionBlockCantBeParameterised (f->blocks[0]->name));
 
-                    for (auto& b : f->blocks)
+                for (auto& b : f->blocks)
+                {
+                    for (auto& param : b->parameters)
                     {
-                        for (auto& param : b->parameters)
-                        {
-                            auto& type = param->getType();
-
-                            if (type.isReference() || type.isVoid())
-                                param->location.throwError (Errors::blockParametersInvalid (b->name));
-                        }
+                        auto& type = param->getType();
 
-                        if (auto branch = cast<heart::Branch> (b->terminator))
-                        {
-                            if (branch->target->parameters.size() != branch->targetArgs.size())
-                                f->location.throwError (Errors::branchInvalidParameters (b->name));
+                        if (type.isReference() || type.isVoid())
+                            param->location.throwError (Errors::blockParametersInvalid (b->name));
+                    }
 
-                            for (size_t n = 0; n < branch->targetArgs.size(); n++)
-                            {
-                                auto& argType = branch->targetArgs[n]->getType();
-                                auto& parameterType = branch->target->parameters[n]->getType();
+                    if (auto branch = cast<heart::Branch> (b->terminator))
+                    {
+                        if (branch->target->parameters.size() != branch->targetArgs.size())
+                            f->location.throwError (Errors::branchInvalidParameters (b->name));
 
-                                if (! TypeRules::canSilentlyCastTo (parameterType, argType))
-                                    f->location.throwError (Errors::branchInvalidParameters (b->name));
-                            }
-                        }
-                        else if (auto branchIf = cast<heart::BranchIf> (b->terminator))
+                        for (size_t n = 0; n < branch->targetArgs.size(); n++)
                         {
-                            if (! branchIf->targetArgs[0].empty() || ! branchIf->targetArgs[1].empty())
-                                f->location.throwError (Errors::notYetImplemented ("BranchIf parameterised blocks"));
+                            auto& argType = branch->targetArgs[n]->getType();
+                            auto& parameterType = branch->target->parameters[n]->getType();
+
+                            if (! TypeRules::canSilentlyCastTo (parameterType, argType))
+                                f->location.throwError (Errors::branchInvalidParameters (b->name));
                         }
                     }
+                    else if (auto branchIf = cast<heart::BranchIf> (b->terminator))
+                    {
+                        if (! branchIf->targetArgs[0].empty() || ! branchIf->targetArgs[1].empty())
+                            f->location.throwError (Errors::notYetImplemented ("BranchIf parameterised blocks"));
+                    }
                 }
             }
         }
@@ -329,9 +424,23 @@ struct heart::Checker
 
     static void checkForCyclesInGraphs (const Program& program)
     {
+        auto& topologyCache = heart::Utilities::GraphTopologyCache::get();
+
         for (auto& m : program.getModules())
-            if (m->isGraph())
-                heart::Utilities::CycleDetector (m).checkAndThrowErrorIfCycleFound();
+        {
+            if (! m->isGraph())
+                continue;
+
+            // A topology which has been through this check before can't have
+            // grown a cycle, so a signature hit makes the traversal redundant
+            auto signature = heart::Utilities::GraphTopologyCache::getTopologySignature (m);
+
+            if (topologyCache.isKnownAcyclic (signature))
+                continue;
+
+            heart::Utilities::CycleDetector (m).checkAndThrowErrorIfCycleFound();
+            topologyCache.recordAcyclic (signature);
+        }
     }
 
     static void testHEARTRoundTrip (const Program& program)
@@ -39,6 +39,7 @@ struct DelayCompensation
                 return 0;
 
             dc.calculateInputLatenciesForAllNodes();
+            dc.rebalanceNodeLatencies();
             dc.addCompensatoryDelaysOnConnections();
         }
         else
@@ -49,6 +50,44 @@ struct DelayCompensation
         return module.latency;
     }
 
+    /** Decouples the render stages of a graph with whole blocks of delay, so that a
+        pipelined engine can run each stage on its own thread, with the stages all
+        processing successive blocks simultaneously.
+
+        Every zero-delay connection that crosses from one render stage to another is
+        given framesPerBlock frames of delay per stage crossed, so during a block no
+        stage reads anything produced by another stage during that same block. Because
+        the extra delay along any path telescopes to the difference of the two stage
+        numbers, parallel paths stay time-aligned. Connections which already carry a
+        delay are left alone - they impose no ordering to begin with.
+
+        The maxExtraBlocksOfLatency budget caps how many stages are decoupled: stages
+        beyond the budget share a pipeline slot and run sequentially. Zero disables
+        the transform. The added latency is included in the module's latency so that
+        hosts compensate for it as usual, and is returned in frames.
+    */
+    static uint32_t applyPipelineDelays (Module& module, uint32_t framesPerBlock, uint32_t maxExtraBlocksOfLatency)
+    {
+        if (! module.isGraph() || framesPerBlock == 0 || maxExtraBlocksOfLatency == 0)
+            return 0;
+
+        auto numStages = heart::Utilities::assignParallelRenderStages (module);
+
+        if (numStages < 2)
+            return 0;
+
+        auto cappedStage = [=] (uint32_t stage)  { return std::min (stage, maxExtraBlocksOfLatency); };
+
+        for (auto& c : module.connections)
+            if (c->delayLength == 0 && c->source.processor != nullptr && c->dest.processor != nullptr)
+                c->delayLength += framesPerBlock * (cappedStage (c->dest.processor->renderStage)
+                                                     - cappedStage (c->source.processor->renderStage));
+
+        auto addedLatency = framesPerBlock * cappedStage (numStages - 1);
+        module.latency += addedLatency;
+        return addedLatency;
+    }
+
 private:
     DelayCompensation (Module& g) : graph (g) {}
 
@@ -90,7 +129,7 @@ private:
         for (auto& instance : graph.processorInstances)
         {
             auto latency = apply (graph.program.getModuleWithName (instance->sourceName));
-            nodes.push_back ({ instance, latency });
+            nodes.push_back ({ instance, latency, 0, {} });
 
             if (latency != 0)
                 anyNodesWithInternalLatency = true;
@@ -143,6 +182,276 @@ private:
         }
     }
 
+    //==============================================================================
+    /** Moves nodes later in time, where doing so is free, to minimise the memory
+        taken by the compensation delays which get inserted.
+
+        calculateInputLatenciesForAllNodes() gives every node the earliest feasible
+        input latency, which concentrates the compensation on each node's outgoing
+        connections. On a node with a wide fan-out that's the worst possible spot:
+        every outgoing connection gets its own delay buffer, where scheduling the
+        node later would replace them all with a single delay on its input. The
+        classic retiming formulation makes this a linear program - choose each node's
+        input latency so that every connection's inserted delay stays non-negative
+        and the graph's own endpoints stay fixed, minimising the total of inserted
+        delay times the byte width of a frame. Its dual is a min-cost flow, so
+        seeding a trivially-feasible flow (each connection carrying its own byte
+        width) and cancelling positive-weight cycles in the residual graph solves it
+        exactly, and the optimal latencies fall out as longest paths from the pinned
+        boundary in the final residual graph. The graphs involved are small, so
+        plain Bellman-Ford is plenty.
+
+        Graphs containing feedback (which is only possible through explicitly-delayed
+        connections) keep the earliest-latency solution, since moving a node inside a
+        feedback loop changes how much delay its connections need, not just where the
+        compensation sits.
+    */
+    void rebalanceNodeLatencies()
+    {
+        if (graphHasFeedback())
+            return;
+
+        buildConstraintEdges();
+
+        for (uint32_t i = 0; i < maxCycleCancellations; ++i)
+        {
+            auto vertexOnCycle = runBellmanFord();
+
+            if (! vertexOnCycle.has_value())
+            {
+                for (size_t n = 0; n < nodes.size(); ++n)
+                    nodes[n].absoluteLatencyAtInput = static_cast<uint32_t> (latencyDistances[n]);
+
+                return;
+            }
+
+            if (! cancelPositiveCycle (*vertexOnCycle))
+                return; // shouldn't happen - leave the earliest-latency solution in place
+        }
+    }
+
+    /** A difference constraint between two node latencies, doubling as an edge in
+        the dual flow network used by rebalanceNodeLatencies(). An index of
+        nodes.size() refers to the graph's own boundary, pinned at latency zero with
+        the overall latency folded into minDifference.
+    */
+    struct ConstraintEdge
+    {
+        size_t from, to;        // latency (to) - latency (from) must be >= minDifference
+        int64_t minDifference;
+        uint64_t flow;          // dual flow, seeded with the connection's bytes-per-frame
+    };
+
+    std::vector<ConstraintEdge> constraintEdges;
+    std::vector<int64_t> latencyDistances;
+    std::vector<size_t> predecessorArcs;
+    static constexpr int64_t unreachable = std::numeric_limits<int64_t>::min();
+    static constexpr uint32_t maxCycleCancellations = 10000;
+
+    bool graphHasFeedback()
+    {
+        // Kahn's algorithm over the node-to-node connections: if peeling off nodes
+        // with no remaining sources can't consume them all, there's a cycle
+        std::vector<uint32_t> numUnprocessedSources (nodes.size());
+        std::vector<size_t> readyNodes;
+        readyNodes.reserve (nodes.size());
+
+        for (size_t i = 0; i < nodes.size(); ++i)
+            numUnprocessedSources[i] = static_cast<uint32_t> (nodes[i].sources.size());
+
+        for (size_t i = 0; i < nodes.size(); ++i)
+            if (numUnprocessedSources[i] == 0)
+                readyNodes.push_back (i);
+
+        size_t numProcessed = 0;
+
+        while (! readyNodes.empty())
+        {
+            auto& processed = nodes[readyNodes.back()];
+            readyNodes.pop_back();
+            ++numProcessed;
+
+            for (size_t i = 0; i < nodes.size(); ++i)
+                for (auto& source : nodes[i].sources)
+                    if (std::addressof (source.node) == std::addressof (processed))
+                        if (--numUnprocessedSources[i] == 0)
+                            readyNodes.push_back (i);
+        }
+
+        return numProcessed != nodes.size();
+    }
+
+    /** Approximates the memory cost of one frame of delay on a connection, so the
+        rebalancing optimises bytes of buffer rather than raw frame counts. */
+    uint64_t getBytesPerFrame (const heart::Connection& c) const
+    {
+        auto getTotalSize = [] (const std::vector<Type>& dataTypes) -> uint64_t
+        {
+            uint64_t total = 0;
+
+            for (auto& t : dataTypes)
+                total += static_cast<uint64_t> (t.getPackedSizeInBytes());
+
+            return std::max (total, static_cast<uint64_t> (1));
+        };
+
+        if (c.source.processor != nullptr)
+            if (auto m = graph.program.findModuleWithName (c.source.processor->sourceName))
+                if (auto output = m->findOutput (c.source.endpointName))
+                    return getTotalSize (output->dataTypes);
+
+        if (c.dest.processor != nullptr)
+            if (auto m = graph.program.findModuleWithName (c.dest.processor->sourceName))
+                if (auto input = m->findInput (c.dest.endpointName))
+                    return getTotalSize (input->dataTypes);
+
+        return sizeof (float);
+    }
+
+    void buildConstraintEdges()
+    {
+        auto boundary = nodes.size();
+        constraintEdges.clear();
+        constraintEdges.reserve (graph.connections.size() + nodes.size());
+
+        auto indexOf = [this] (Node* n) { return static_cast<size_t> (n - nodes.data()); };
+
+        for (auto& c : graph.connections)
+        {
+            auto src = findNode (c->source.processor);
+            auto dst = findNode (c->dest.processor);
+            auto weight = getBytesPerFrame (c);
+
+            if (src != nullptr && dst != nullptr)
+                constraintEdges.push_back ({ indexOf (src), indexOf (dst),
+                                             static_cast<int64_t> (src->internalLatency), weight });
+            else if (src == nullptr && dst != nullptr)
+                constraintEdges.push_back ({ boundary, indexOf (dst), 0, weight });
+            else if (src != nullptr && dst == nullptr)
+                constraintEdges.push_back ({ indexOf (src), boundary,
+                                             static_cast<int64_t> (src->internalLatency)
+                                               - static_cast<int64_t> (graph.latency), weight });
+        }
+
+        // zero-weight edges keeping every node at or after time zero, which also
+        // guarantee that the longest-path pass can reach every node
+        for (size_t i = 0; i < nodes.size(); ++i)
+            constraintEdges.push_back ({ boundary, i, 0, 0 });
+    }
+
+    /** Longest paths from the boundary over the residual arcs: arc index 2*e is
+        edge e traversed forwards (cost minDifference), 2*e+1 is it traversed
+        backwards (cost -minDifference, only available while it carries flow).
+        If the distances settle, there's no positive cycle, latencyDistances holds
+        the longest paths, and this returns nothing. If they fail to settle, it
+        returns a vertex whose predecessor chain leads into a positive cycle.
+    */
+    std::optional<size_t> runBellmanFord()
+    {
+        auto numVertices = nodes.size() + 1;
+        latencyDistances.assign (numVertices, unreachable);
+        predecessorArcs.assign (numVertices, 0);
+        latencyDistances[nodes.size()] = 0;
+
+        for (size_t round = 0; round <= numVertices; ++round)
+        {
+            std::optional<size_t> lastRelaxedVertex;
+
+            for (size_t e = 0; e < constraintEdges.size(); ++e)
+            {
+                auto& edge = constraintEdges[e];
+
+                if (latencyDistances[edge.from] != unreachable
+                     && latencyDistances[edge.to] < latencyDistances[edge.from] + edge.minDifference)
+                {
+                    latencyDistances[edge.to] = latencyDistances[edge.from] + edge.minDifference;
+                    predecessorArcs[edge.to] = e * 2;
+                    lastRelaxedVertex = edge.to;
+                }
+
+                if (edge.flow != 0
+                     && latencyDistances[edge.to] != unreachable
+                     && latencyDistances[edge.from] < latencyDistances[edge.to] - edge.minDifference)
+                {
+                    latencyDistances[edge.from] = latencyDistances[edge.to] - edge.minDifference;
+                    predecessorArcs[edge.from] = e * 2 + 1;
+                    lastRelaxedVertex = edge.from;
+                }
+            }
+
+            if (! lastRelaxedVertex.has_value())
+                return {};
+
+            if (round == numVertices)
+                return lastRelaxedVertex;
+        }
+
+        return {};
+    }
+
+    /** Locates the positive-weight cycle that runBellmanFord() detected and pushes
+        as much flow as possible around it, which removes it from the residual graph.
+    */
+    bool cancelPositiveCycle (size_t vertexOnCycle)
+    {
+        // a vertex relaxed in the final round must lead back into the cycle
+        // within numVertices predecessor steps
+        for (size_t i = 0; i <= nodes.size(); ++i)
+            vertexOnCycle = getPredecessorVertex (vertexOnCycle);
+
+        ArrayWithPreallocation<size_t, 16> cycleArcs;
+        auto v = vertexOnCycle;
+
+        for (;;)
+        {
+            cycleArcs.push_back (predecessorArcs[v]);
+            v = getPredecessorVertex (v);
+
+            if (v == vertexOnCycle)
+                break;
+
+            if (cycleArcs.size() > constraintEdges.size() * 2)
+                return false; // predecessor chain is malformed - bail out
+        }
+
+        auto maxFlow = std::numeric_limits<uint64_t>::max();
+        bool anyBackwardArcs = false;
+
+        for (auto arc : cycleArcs)
+        {
+            if ((arc & 1) != 0)
+            {
+                anyBackwardArcs = true;
+                maxFlow = std::min (maxFlow, constraintEdges[arc / 2].flow);
+            }
+        }
+
+        // a cycle of purely forward arcs would mean the constraints are infeasible,
+        // which can't happen when the earliest-latency solution satisfies them all
+        if (! anyBackwardArcs)
+        {
+            SOUL_ASSERT_FALSE;
+            return false;
+        }
+
+        for (auto arc : cycleArcs)
+        {
+            if ((arc & 1) != 0)
+                constraintEdges[arc / 2].flow -= maxFlow;
+            else
+                constraintEdges[arc / 2].flow += maxFlow;
+        }
+
+        return true;
+    }
+
+    size_t getPredecessorVertex (size_t v) const
+    {
+        auto arc = predecessorArcs[v];
+        auto& edge = constraintEdges[arc / 2];
+        return (arc & 1) != 0 ? edge.to : edge.from;
+    }
+
     uint32_t calculateAbsoluteLatencyOutOfNode (Node& node)
     {
         if (std::find (visitedStack.begin(), visitedStack.end(), std::addressof (node)) != visitedStack.end())
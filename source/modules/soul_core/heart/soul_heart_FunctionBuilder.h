@@ -189,7 +189,7 @@ struct BlockBuilder
     }
 
     template <typename Type, typename... Args>
-    void createStatement (Args&&... args)   { addStatement (module.allocate<Type> (std::forward<Args> (args)...)); }
+    void createStatement (Args&&... args)   { addStatement (module.allocateStatement<Type> (std::forward<Args> (args)...)); }
 
     void addAssignment (heart::Expression& dest, heart::Expression& source)
     {
@@ -260,7 +260,7 @@ struct BlockBuilder
 
     void addFunctionCall (pool_ptr<heart::Expression> dest, heart::Function& function, std::initializer_list<pool_ref<heart::Expression>> args)
     {
-        auto& call = module.allocate<heart::FunctionCall> (CodeLocation(), dest, function);
+        auto& call = module.allocateStatement<heart::FunctionCall> (CodeLocation(), dest, function);
         call.arguments.reserve (args.size());
 
         for (auto& a : args)
@@ -272,7 +272,7 @@ struct BlockBuilder
 
     void addFunctionCall (pool_ptr<heart::Expression> dest, heart::Function& function, heart::FunctionCall::ArgListType&& args)
     {
-        auto& call = module.allocate<heart::FunctionCall> (CodeLocation(), dest, function);
+        auto& call = module.allocateStatement<heart::FunctionCall> (CodeLocation(), dest, function);
         call.arguments = std::move (args);
         SOUL_ASSERT (call.arguments.size() == function.parameters.size());
         addStatement (call);
@@ -307,23 +307,23 @@ struct BlockBuilder
 
     void setReturnTerminator()
     {
-        setTerminator (module.allocate<heart::ReturnVoid>());
+        setTerminator (module.allocateStatement<heart::ReturnVoid>());
     }
 
     void setReturnTerminator (heart::Expression& value)
     {
-        setTerminator (module.allocate<heart::ReturnValue> (value));
+        setTerminator (module.allocateStatement<heart::ReturnValue> (value));
     }
 
     void setBranchTerminator (heart::Block& target)
     {
-        setTerminator (module.allocate<heart::Branch> (target));
+        setTerminator (module.allocateStatement<heart::Branch> (target));
     }
 
     void setBranchIfTerminator (heart::Expression& condition, heart::Block& trueBranch, heart::Block& falseBranch)
     {
         SOUL_ASSERT (std::addressof (trueBranch) != std::addressof (falseBranch));
-        setTerminator (module.allocate<heart::BranchIf> (condition, trueBranch, falseBranch));
+        setTerminator (module.allocateStatement<heart::BranchIf> (condition, trueBranch, falseBranch));
     }
 
     Module& module;
@@ -430,11 +430,11 @@ struct FunctionBuilder  : public BlockBuilder
                     if (! currentFunction->returnType.isVoid())
                         return false;
 
-                    b->terminator = module.allocate<heart::ReturnVoid>();
+                    b->terminator = module.allocateStatement<heart::ReturnVoid>();
                 }
                 else
                 {
-                    b->terminator = module.allocate<heart::Branch> (blocks[i + 1]);
+                    b->terminator = module.allocateStatement<heart::Branch> (blocks[i + 1]);
                 }
             }
         }
@@ -520,22 +520,22 @@ struct FunctionBuilder  : public BlockBuilder
 
     void addReturn()
     {
-        addTerminatorStatement (module.allocate<heart::ReturnVoid>(), nullptr);
+        addTerminatorStatement (module.allocateStatement<heart::ReturnVoid>(), nullptr);
     }
 
     void addReturn (heart::Expression& value)
     {
-        addTerminatorStatement (module.allocate<heart::ReturnValue> (value), nullptr);
+        addTerminatorStatement (module.allocateStatement<heart::ReturnValue> (value), nullptr);
     }
 
     void addBranch (heart::Block& target, pool_ptr<heart::Block> subsequentBlock)
     {
-        addTerminatorStatement (module.allocate<heart::Branch> (target), subsequentBlock);
+        addTerminatorStatement (module.allocateStatement<heart::Branch> (target), subsequentBlock);
     }
 
     void addBranch (heart::Block& target, heart::Branch::ArgListType&& targetArgs, pool_ptr<heart::Block> subsequentBlock)
     {
-        auto& branch = module.allocate<heart::Branch> (target);
+        auto& branch = module.allocateStatement<heart::Branch> (target);
 
         branch.targetArgs = std::move (targetArgs);
 
@@ -544,7 +544,7 @@ struct FunctionBuilder  : public BlockBuilder
 
     void addBranch (heart::Block& target, std::initializer_list<pool_ref<heart::Expression>> targetArgs, pool_ptr<heart::Block> subsequentBlock)
     {
-        auto& branch = module.allocate<heart::Branch> (target);
+        auto& branch = module.allocateStatement<heart::Branch> (target);
 
         for (auto& a : targetArgs)
             branch.targetArgs.push_back (a);
@@ -555,10 +555,12 @@ struct FunctionBuilder  : public BlockBuilder
     void addBranchIf (heart::Expression& condition,
                       heart::Block& trueBranch,
                       heart::Block& falseBranch,
-                      pool_ptr<heart::Block> subsequentBlock)
+                      pool_ptr<heart::Block> subsequentBlock,
+                      heart::BranchIf::Likelihood likelihood = heart::BranchIf::Likelihood::unknown)
     {
-        addTerminatorStatement (module.allocate<heart::BranchIf> (condition, trueBranch, falseBranch),
-                                subsequentBlock);
+        auto& branchIf = module.allocateStatement<heart::BranchIf> (condition, trueBranch, falseBranch);
+        branchIf.likelihood = likelihood;
+        addTerminatorStatement (branchIf, subsequentBlock);
     }
 
     void addBranchIf (heart::Expression& condition,
@@ -568,7 +570,7 @@ struct FunctionBuilder  : public BlockBuilder
                       std::initializer_list<pool_ref<heart::Expression>> falseBranchArgs,
                       pool_ptr<heart::Block> subsequentBlock)
     {
-        auto& branchIf = module.allocate<heart::BranchIf> (condition, trueBranch, falseBranch);
+        auto& branchIf = module.allocateStatement<heart::BranchIf> (condition, trueBranch, falseBranch);
 
         for (auto& a : trueBranchArgs)
             branchIf.targetArgs[0].push_back (a);
@@ -584,12 +586,14 @@ struct FunctionBuilder  : public BlockBuilder
                       heart::BranchIf::ArgListType&& trueBranchArgs,
                       heart::Block& falseBranch,
                       heart::BranchIf::ArgListType&& falseBranchArgs,
-                      pool_ptr<heart::Block> subsequentBlock)
+                      pool_ptr<heart::Block> subsequentBlock,
+                      heart::BranchIf::Likelihood likelihood = heart::BranchIf::Likelihood::unknown)
     {
-        auto& branchIf = module.allocate<heart::BranchIf> (condition, trueBranch, falseBranch);
+        auto& branchIf = module.allocateStatement<heart::BranchIf> (condition, trueBranch, falseBranch);
 
         branchIf.targetArgs[0] = std::move (trueBranchArgs);
         branchIf.targetArgs[1] = std::move (falseBranchArgs);
+        branchIf.likelihood = likelihood;
 
         addTerminatorStatement (branchIf, subsequentBlock);
     }
@@ -635,7 +639,8 @@ struct FunctionBuilder  : public BlockBuilder
             auto& continueBlock  = createNewBlock();
 
             addBranchIf (createEqualsOp (plusOne, createConstantInt32 (limit)),
-                         wrappedBlock, inRangeBlock, inRangeBlock);
+                         wrappedBlock, inRangeBlock, inRangeBlock,
+                         heart::BranchIf::Likelihood::likelyFalse);
 
             addAssignment (dest, plusOne);
             addBranch (continueBlock, wrappedBlock);
@@ -0,0 +1,468 @@
+/*
+    _____ _____ _____ __
+   |   __|     |  |  |  |      The SOUL language
+   |__   |  |  |  |  |  |__    Copyright (c) 2019 - ROLI Ltd.
+   |_____|_____|_____|_____|
+
+   The code in this file is provided under the terms of the ISC license:
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose
+   with or without fee is hereby granted, provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+namespace soul
+{
+
+//==============================================================================
+/**
+    A small interpreter which can execute HEART functions whose behaviour depends
+    only on compile-time-known values.
+
+    Its job is to run each processor's state-initialisation function at link time:
+    when the function has no external inputs, the final state it computes (wavetables,
+    coefficient tables and so on, however loopy the code that builds them) is baked
+    into the state variables' initial values as constants, and the function body is
+    emptied, so the engine no longer has to execute it at startup.
+
+    The evaluation is strictly best-effort: anything it can't be sure about - stream
+    access, externals, processor properties, intrinsics it can't perform, or simply
+    exceeding its execution budget - makes it abandon the module untouched.
+*/
+struct heart::Interpreter
+{
+    /** Attempts to pre-evaluate the state initialisation of every processor in the program. */
+    static void evaluateInitFunctions (Program& program)
+    {
+        for (auto& m : program.getModules())
+            if (m->isProcessor())
+                if (auto initFn = m->findFunction (getSystemInitFunctionName()))
+                    evaluateInitFunction (m, *initFn);
+    }
+
+    /** Attempts to fully evaluate a module's init function, baking the resulting state
+        into the state variables' initial values and emptying the function on success.
+        Returns false, leaving everything unchanged, if the function couldn't be
+        statically evaluated.
+    */
+    static bool evaluateInitFunction (Module& module, Function& fn)
+    {
+        FunctionEvaluator evaluator (module);
+
+        if (! evaluator.evaluate (fn))
+            return false;
+
+        for (auto& v : module.stateVariables)
+            if (! v->isExternal())
+                v->initialValue = module.allocate<heart::Constant> (v->location, evaluator.getStateValue (v));
+
+        fn.blocks.clear();
+        auto& emptyBlock = module.allocate<heart::Block> (module.allocator.get ("@prefolded"));
+        emptyBlock.terminator = module.allocateStatement<heart::ReturnVoid>();
+        fn.blocks.push_back (emptyBlock);
+        return true;
+    }
+
+private:
+    /** Thrown internally to unwind when something can't be statically evaluated.
+        Deliberately not an AbortCompilationException: hitting one of these isn't a
+        user error, it just means the function must keep running at startup instead.
+    */
+    struct NotStaticallyEvaluatable {};
+
+    [[noreturn]] static void giveUp()    { throw NotStaticallyEvaluatable(); }
+
+    //==============================================================================
+    struct FunctionEvaluator
+    {
+        FunctionEvaluator (Module& m) : module (m) {}
+
+        bool evaluate (Function& fn)
+        {
+            try
+            {
+                for (auto& v : module.stateVariables)
+                {
+                    if (v->isExternal())
+                        continue;
+
+                    if (v->initialValue != nullptr)
+                    {
+                        auto initial = v->initialValue->getAsConstant();
+
+                        if (! initial.isValid())
+                            return false;
+
+                        stateValues[v.getPointer()] = std::move (initial);
+                    }
+                    else
+                    {
+                        stateValues[v.getPointer()] = Value::zeroInitialiser (v->getType());
+                    }
+                }
+
+                ArrayWithPreallocation<Value, 4> noArgs;
+                call (fn, noArgs);
+                return true;
+            }
+            catch (NotStaticallyEvaluatable) {}
+
+            return false;
+        }
+
+        Value getStateValue (Variable& v) const
+        {
+            auto found = stateValues.find (std::addressof (v));
+            SOUL_ASSERT (found != stateValues.end());
+            return found->second;
+        }
+
+    private:
+        using LocalScope = std::unordered_map<const Variable*, Value>;
+
+        /** Identifies a storage slot that an lvalue expression resolved to. */
+        struct TargetRef
+        {
+            Value* root;
+            SubElementPath path;
+            bool isWholeValue;
+        };
+
+        Module& module;
+        std::unordered_map<const Variable*, Value> stateValues;
+        uint64_t statementBudget = 4 * 1024 * 1024;
+        int callDepth = 0;
+
+        //==============================================================================
+        Value call (Function& fn, ArrayWithPreallocation<Value, 4>& argValues)
+        {
+            if (fn.hasNoBody)
+                return callIntrinsic (fn, { argValues.begin(), argValues.end() });
+
+            if (++callDepth > 128 || fn.blocks.empty())
+                giveUp();
+
+            SOUL_ASSERT (argValues.size() == fn.parameters.size());
+            LocalScope locals;
+
+            for (size_t i = 0; i < fn.parameters.size(); ++i)
+                locals[fn.parameters[i].getPointer()] = argValues[i];
+
+            auto result = run (fn, locals);
+
+            // Copy the final parameter values back out, so the caller can propagate
+            // any changes made through reference parameters
+            for (size_t i = 0; i < fn.parameters.size(); ++i)
+                if (fn.parameters[i]->getType().isReference())
+                    argValues[i] = locals[fn.parameters[i].getPointer()];
+
+            --callDepth;
+            return result;
+        }
+
+        Value run (Function& fn, LocalScope& locals)
+        {
+            auto block = fn.blocks.front().getPointer();
+
+            for (;;)
+            {
+                for (auto s : block->statements)
+                {
+                    if (--statementBudget == 0)
+                        giveUp();
+
+                    performStatement (*s, locals);
+                }
+
+                auto term = block->terminator;
+
+                if (term == nullptr)
+                    giveUp();
+
+                if (auto branch = cast<heart::Branch> (*term))
+                {
+                    block = std::addressof (moveToBlock (branch->target, branch->targetArgs, locals));
+                    continue;
+                }
+
+                if (auto branchIf = cast<heart::BranchIf> (*term))
+                {
+                    auto taken = evaluateExpression (branchIf->condition, locals).getAsBool() ? 0u : 1u;
+                    block = std::addressof (moveToBlock (branchIf->targets[taken], branchIf->targetArgs[taken], locals));
+                    continue;
+                }
+
+                if (is_type<heart::ReturnVoid> (*term))
+                    return {};
+
+                if (auto ret = cast<heart::ReturnValue> (*term))
+                    return evaluateExpression (ret->returnValue, locals);
+
+                giveUp();
+            }
+        }
+
+        template <typename ArgList>
+        Block& moveToBlock (Block& target, const ArgList& args, LocalScope& locals)
+        {
+            SOUL_ASSERT (args.size() == target.parameters.size());
+            ArrayWithPreallocation<Value, 4> argValues;
+
+            for (auto& arg : args)
+                argValues.push_back (evaluateExpression (arg, locals));
+
+            for (size_t i = 0; i < argValues.size(); ++i)
+                locals[target.parameters[i].getPointer()] = std::move (argValues[i]);
+
+            return target;
+        }
+
+        //==============================================================================
+        void performStatement (Statement& s, LocalScope& locals)
+        {
+            if (auto assign = cast<heart::AssignFromValue> (s))
+            {
+                auto value = evaluateExpression (assign->source, locals);
+                writeToTarget (*assign->target, std::move (value), locals);
+                return;
+            }
+
+            if (auto fnCall = cast<heart::FunctionCall> (s))
+            {
+                auto result = performFunctionCall (fnCall->getFunction(), fnCall->arguments, locals);
+
+                if (fnCall->target != nullptr)
+                    writeToTarget (*fnCall->target, std::move (result), locals);
+
+                return;
+            }
+
+            giveUp();  // streams, advance() etc can never be evaluated statically
+        }
+
+        template <typename ArgList>
+        Value performFunctionCall (Function& fn, const ArgList& args, LocalScope& locals)
+        {
+            SOUL_ASSERT (args.size() == fn.parameters.size() || fn.hasNoBody);
+            ArrayWithPreallocation<Value, 4> argValues;
+            ArrayWithPreallocation<std::pair<size_t, TargetRef>, 4> referenceArgs;
+
+            for (size_t i = 0; i < args.size(); ++i)
+            {
+                argValues.push_back (evaluateExpression (args[i], locals));
+
+                if (i < fn.parameters.size() && fn.parameters[i]->getType().isReference())
+                    referenceArgs.push_back ({ i, resolveTarget (args[i], locals) });
+            }
+
+            auto result = call (fn, argValues);
+
+            // Write the (possibly modified) argument values back through any reference parameters
+            for (auto& refArg : referenceArgs)
+                storeToTargetRef (refArg.second, argValues[refArg.first]);
+
+            return result;
+        }
+
+        Value callIntrinsic (Function& fn, ArrayView<Value> argValues)
+        {
+            if (fn.intrinsicType == IntrinsicType::none)
+                giveUp();
+
+            auto result = performIntrinsic (fn.intrinsicType, argValues);
+
+            if (! result.isValid())
+                giveUp();
+
+            return result;
+        }
+
+        //==============================================================================
+        Value evaluateExpression (Expression& e, LocalScope& locals)
+        {
+            if (auto c = cast<heart::Constant> (e))
+                return c->value;
+
+            if (auto v = cast<heart::Variable> (e))
+                return readVariable (*v, locals);
+
+            if (auto element = cast<heart::ArrayElement> (e))
+            {
+                auto parentValue = evaluateExpression (element->parent, locals);
+
+                if (element->isSlice())
+                    return parentValue.getSlice (element->fixedStartIndex, element->fixedEndIndex);
+
+                return parentValue.getSubElement (getArrayIndex (*element, parentValue.getType(), locals));
+            }
+
+            if (auto member = cast<heart::StructElement> (e))
+                return evaluateExpression (member->parent, locals).getSubElement (member->getMemberIndex());
+
+            if (auto c = cast<heart::TypeCast> (e))
+            {
+                auto result = evaluateExpression (c->source, locals).tryCastToType (c->destType);
+
+                if (! result.isValid())
+                    giveUp();
+
+                return result;
+            }
+
+            if (auto op = cast<heart::UnaryOperator> (e))
+            {
+                auto value = evaluateExpression (op->source, locals);
+
+                if (! UnaryOp::apply (value, op->operation))
+                    giveUp();
+
+                return value;
+            }
+
+            if (auto op = cast<heart::BinaryOperator> (e))
+            {
+                auto a = evaluateExpression (op->lhs, locals);
+                auto b = evaluateExpression (op->rhs, locals);
+
+                if (! BinaryOp::apply (a, b, op->operation, [] (CompileMessage) { giveUp(); }))
+                    giveUp();
+
+                return a;
+            }
+
+            if (auto fnCall = cast<heart::PureFunctionCall> (e))
+                return performFunctionCall (fnCall->function, fnCall->arguments, locals);
+
+            giveUp();  // processor properties etc are only known at run-time
+        }
+
+        Value readVariable (Variable& v, LocalScope& locals)
+        {
+            if (v.isFunctionLocal() || v.isParameter())
+                return getOrCreateLocal (v, locals);
+
+            if (v.isExternal())
+                giveUp();  // external values aren't resolved until the program is loaded
+
+            auto found = stateValues.find (std::addressof (v));
+
+            if (found == stateValues.end())
+                giveUp();
+
+            return found->second;
+        }
+
+        /** Local variables have no implicit initial value in HEART, but they're always
+            fully written before being read in generated code - so a local is lazily
+            given a zero-initialised value the first time it's touched, which gives
+            element-wise writes (e.g. filling a table in a loop) somewhere to land.
+        */
+        Value& getOrCreateLocal (Variable& v, LocalScope& locals)
+        {
+            auto& slot = locals[std::addressof (v)];
+
+            if (! slot.getType().isValid())
+            {
+                if (v.getType().isReference() || ! v.getType().isValid())
+                    giveUp();
+
+                slot = Value::zeroInitialiser (v.getType());
+            }
+
+            return slot;
+        }
+
+        //==============================================================================
+        size_t getArrayIndex (heart::ArrayElement& element, const Type& parentType, LocalScope& locals)
+        {
+            if (! element.isDynamic())
+                return element.fixedStartIndex;
+
+            auto indexValue = evaluateExpression (*element.dynamicIndex, locals);
+            auto index = indexValue.getAsInt64();
+
+            if (index < 0 || ! parentType.isValidArrayOrVectorIndex (index))
+                giveUp();
+
+            return (size_t) index;
+        }
+
+        TargetRef resolveTarget (Expression& e, LocalScope& locals)
+        {
+            if (auto v = cast<heart::Variable> (e))
+            {
+                if (v->isExternal())
+                    giveUp();
+
+                if (v->isFunctionLocal() || v->isParameter())
+                    return { std::addressof (getOrCreateLocal (*v, locals)), {}, true };
+
+                auto found = stateValues.find (v.get());
+
+                if (found == stateValues.end())
+                    giveUp();
+
+                return { std::addressof (found->second), {}, true };
+            }
+
+            if (auto element = cast<heart::ArrayElement> (e))
+            {
+                if (element->isSlice())
+                    giveUp();  // slice assignment is rare enough not to be worth handling
+
+                auto parent = resolveTarget (element->parent, locals);
+                parent.path += getArrayIndex (*element, element->parent->getType(), locals);
+                parent.isWholeValue = false;
+                return parent;
+            }
+
+            if (auto member = cast<heart::StructElement> (e))
+            {
+                auto parent = resolveTarget (member->parent, locals);
+                parent.path += member->getMemberIndex();
+                parent.isWholeValue = false;
+                return parent;
+            }
+
+            giveUp();
+        }
+
+        void writeToTarget (Expression& target, Value&& newValue, LocalScope& locals)
+        {
+            storeToTargetRef (resolveTarget (target, locals), newValue);
+        }
+
+        void storeToTargetRef (const TargetRef& target, const Value& newValue)
+        {
+            if (target.isWholeValue)
+            {
+                auto& type = target.root->getType();
+
+                if (type.isValid() && ! newValue.getType().isIdentical (type))
+                {
+                    auto castValue = newValue.tryCastToType (type);
+
+                    if (! castValue.isValid())
+                        giveUp();
+
+                    *target.root = std::move (castValue);
+                    return;
+                }
+
+                *target.root = newValue;
+                return;
+            }
+
+            target.root->modifySubElementInPlace (target.path, newValue);
+        }
+    };
+};
+
+} // namespace soul
@@ -28,24 +28,663 @@ namespace soul
 struct Optimisations
 {
     static void removeUnusedVariables (Program& program)
+    {
+        auto& modules = program.getModules();
+
+        // These passes only ever mutate statements and local variables within their own
+        // module (the use-counts they share across modules are atomic), so each module
+        // can be handled by a different worker thread.
+        if (modules.size() > 1)
+        {
+            ThreadPool pool (ThreadPool::getRecommendedNumberOfThreads (modules.size()));
+
+            for (auto& m : modules)
+                pool.addJob ([m] { removeUnusedVariables (m); });
+
+            return;  // (the pool's destructor waits for the jobs to finish)
+        }
+
+        for (auto& m : modules)
+            removeUnusedVariables (m);
+    }
+
+    static void removeUnusedVariables (Module& m)
+    {
+        m.rebuildVariableUseCounts();
+
+        for (auto f : m.functions)
+            removeDuplicateConstants (f);
+
+        m.rebuildVariableUseCounts();
+
+        for (auto f : m.functions)
+            convertWriteOnceVariablesToConstants (f);
+
+        m.rebuildVariableUseCounts();
+
+        for (auto f : m.functions)
+            removeUnusedVariables (f);
+
+        removeUnusedStateVariables (m);
+    }
+
+    /** Drops state variables which no function ever reads or writes.
+
+        A constant table whose accesses were all folded to scalars during resolution
+        would otherwise still occupy its full size in every instance's state.
+    */
+    static void removeUnusedStateVariables (Module& m)
+    {
+        removeIf (m.stateVariables, [] (pool_ref<heart::Variable>& v)
+        {
+            return v->role == heart::Variable::Role::state
+                    && v->annotation.isEmpty()
+                    && v->readWriteCount.numReads == 0
+                    && v->readWriteCount.numWrites == 0;
+        });
+    }
+
+    /** Folds state variables which are provably frozen at their initial value
+        into the functions that read them.
+
+        A processor parameter that was pinned when the graph was built - a gain
+        instantiated with a constant level, a filter with a fixed mode - survives
+        HEART generation as a state variable which the init function sets once and
+        which nothing ever writes again (an automatable parameter keeps its event
+        handler, so it still counts as written and is left alone). Once
+        evaluateInitFunctions() has baked the initial values, such a variable is
+        pure configuration: replacing its reads with the constant removes the
+        state load from the per-frame path, lets ordinary block optimisation fold
+        whatever consumed it, and drops the variable from the state struct.
+    */
+    static void propagateFrozenStateConstants (Program& program)
     {
         for (auto& m : program.getModules())
         {
+            if (! m->isProcessor())
+                continue;
+
             m->rebuildVariableUseCounts();
+            std::vector<pool_ref<heart::Variable>> folded;
 
-            for (auto f : m->functions)
-                removeDuplicateConstants (f);
+            for (auto& v : m->stateVariables)
+            {
+                // only whole-value reads of primitives are substituted: a frozen
+                // aggregate would leave constants as the parents of element
+                // accesses, which the later passes don't expect
+                if (v->readWriteCount.numWrites != 0
+                     || v->isExternal()
+                     || ! v->type.isPrimitive()
+                     || v->initialValue == nullptr)
+                    continue;
+
+                auto constant = cast<heart::Constant> (*v->initialValue);
+
+                if (constant == nullptr || ! constant->getType().isIdentical (v->type))
+                    continue;
+
+                for (auto& f : m->functions)
+                    f->visitExpressions ([&] (pool_ref<heart::Expression>& value, AccessType mode)
+                    {
+                        if (mode == AccessType::read && value == v.get())
+                            value = *constant;
+                    });
 
-            m->rebuildVariableUseCounts();
+                folded.push_back (v);
+            }
 
-            for (auto f : m->functions)
-                convertWriteOnceVariablesToConstants (f);
+            if (folded.empty())
+                continue;
 
-            m->rebuildVariableUseCounts();
+            removeFromVector (m->stateVariables, folded);
 
-            for (auto f : m->functions)
-                removeUnusedVariables (f);
+            for (auto& f : m->functions)
+                optimiseFunctionBlocks (f, m->allocator);
+        }
+    }
+
+    /** Marks large, dynamically-indexed state buffers with a prefetch hint, and
+        pads power-of-two-sized ones to break up cache-set aliasing.
+
+        A long delay line or wavetable is read at strides the hardware prefetcher
+        rarely locks onto, particularly when the tap position is modulated. This
+        pass can't issue prefetch instructions itself - native code generation
+        belongs to whichever engine consumes the program - but it can recognise
+        the pattern: a fixed-size state array too big to stay L1-resident which
+        some function indexes dynamically. Each such buffer gets a
+        "prefetchDistance" annotation (in elements), which back-ends can lower to
+        a software prefetch that distance ahead of every dynamic read.
+
+        When such a buffer's packed size is also an exact power of two, the
+        per-voice copies made by replicated processor arrays all land on the same
+        cache-set offsets, so a bank of voices fights over a handful of sets.
+        Inserting one cache line of padding after the buffer skews each copy's
+        layout enough to spread the sets out, at a cost of 64 bytes per voice.
+    */
+    static void annotateDelayLineAccesses (Program& program, uint32_t prefetchDistanceElements = 8)
+    {
+        constexpr uint64_t minBufferSizeInBytes = 4096;  // anything smaller stays L1-resident anyway
+        constexpr size_t cacheLineSizeInInts = 16;
+
+        for (auto& m : program.getModules())
+        {
+            if (! m->isProcessor())
+                continue;
+
+            std::vector<pool_ref<heart::Variable>> buffersToPad;
+
+            for (auto& v : m->stateVariables)
+            {
+                if (v->role != heart::Variable::Role::state
+                     || v->isExternal()
+                     || ! v->type.isFixedSizeArray())
+                    continue;
+
+                auto packedSize = v->type.getPackedSizeInBytes();
+
+                if (packedSize < minBufferSizeInBytes || ! isDynamicallyIndexed (m, v))
+                    continue;
+
+                v->annotation.set ("prefetchDistance", (int32_t) prefetchDistanceElements);
+
+                if (choc::math::isPowerOf2 (packedSize))
+                    buffersToPad.push_back (v);
+            }
+
+            for (auto& buffer : buffersToPad)
+            {
+                auto padName = addSuffixToMakeUnique ("_cachePad", [&] (const std::string& nm)
+                                                                   { return m->findStateVariable (nm) != nullptr; });
+
+                auto& pad = m->allocate<heart::Variable> (buffer->location,
+                                                          Type (PrimitiveType::int32).createArray (cacheLineSizeInInts),
+                                                          m->allocator.get (padName),
+                                                          heart::Variable::Role::state);
+
+                auto pos = std::find (m->stateVariables.begin(), m->stateVariables.end(), buffer);
+                SOUL_ASSERT (pos != m->stateVariables.end());
+                m->stateVariables.insert (pos + 1, pad);
+            }
+        }
+    }
+
+    /** Derives [[ propagates_silence ]] flags for graphs from their contents.
+
+        Library processors whose stream outputs are silent whenever every stream
+        input is silent carry a [[ propagates_silence ]] annotation (gains,
+        mixers - anything with no signal source of its own along the audio
+        path). An engine can use the flag to short-circuit rendering of any
+        flagged node whose inputs are currently silent, which is where the time
+        goes in bus-heavy sessions that spend most of a block rendering
+        nothing. This pass lifts the flag onto graphs: a graph propagates
+        silence when, assuming all its stream inputs silent, every one of its
+        stream outputs can only receive silent data. Graphs can nest, so the
+        sweep repeats until no new flags appear.
+
+        The analysis is conservative - an instance of anything unflagged is
+        assumed to produce signal, and a flagged processor with any potentially
+        live stream input (a modulator, say) is demoted even if that input
+        couldn't actually wake the output.
+    */
+    static void propagateSilenceFlags (Program& program)
+    {
+        static constexpr const char* flagName = "propagates_silence";
+
+        for (bool anyChanges = true; anyChanges;)
+        {
+            anyChanges = false;
+
+            for (auto& g : program.getModules())
+            {
+                if (! g->isGraph() || g->annotation.getBool (flagName))
+                    continue;
+
+                if (graphPropagatesSilence (program, g))
+                {
+                    g->annotation.set (flagName, true);
+                    anyChanges = true;
+                }
+            }
+        }
+    }
+
+    static bool graphPropagatesSilence (Program& program, Module& graph)
+    {
+        // start by trusting every flagged instance, then demote any whose
+        // stream inputs can be fed signal, until that stops changing
+        std::unordered_set<const heart::ProcessorInstance*> silentInstances;
+
+        for (auto& i : graph.processorInstances)
+            if (auto m = program.findModuleWithName (i->sourceName))
+                if (m->annotation.getBool ("propagates_silence"))
+                    silentInstances.insert (i.getPointer());
+
+        auto isStreamSource = [&] (const heart::EndpointReference& ref)
+        {
+            if (ref.processor == nullptr)
+            {
+                if (auto input = graph.findInput (ref.endpointName))
+                    return input->isStreamEndpoint();
+
+                return false;
+            }
+
+            if (auto m = program.findModuleWithName (ref.processor->sourceName))
+                if (auto output = m->findOutput (ref.endpointName))
+                    return output->isStreamEndpoint();
+
+            return false;
+        };
+
+        auto isSilentSource = [&] (const heart::EndpointReference& ref)
+        {
+            return ref.processor == nullptr
+                    || silentInstances.find (ref.processor.get()) != silentInstances.end();
+        };
+
+        for (bool anyChanges = true; anyChanges;)
+        {
+            anyChanges = false;
+
+            for (auto& c : graph.connections)
+            {
+                if (c->dest.processor == nullptr || ! isStreamSource (c->source))
+                    continue;
+
+                if (silentInstances.find (c->dest.processor.get()) != silentInstances.end()
+                     && ! isSilentSource (c->source))
+                {
+                    silentInstances.erase (c->dest.processor.get());
+                    anyChanges = true;
+                }
+            }
+        }
+
+        for (auto& c : graph.connections)
+        {
+            if (c->dest.processor != nullptr)
+                continue;
+
+            auto output = graph.findOutput (c->dest.endpointName);
+
+            if (output != nullptr && output->isStreamEndpoint() && ! isSilentSource (c->source))
+                return false;
+        }
+
+        return true;
+    }
+
+    /** Tidies each graph's event routing into a shape engines can dispatch flatly.
+
+        An event endpoint feeding dozens of consumers (a mod-matrix, a voice
+        bank's note streams) is represented as one connection per consumer,
+        scattered through the graph's connection list in declaration order. Two
+        things happen here. Connections whose destination is a processor that
+        declares the event input but handles none of its types are removed
+        outright - delivering to them can never do anything. The remaining event
+        connections are then stable-sorted so all subscribers of the same source
+        sit contiguously, which lets an engine compile each run into a flat
+        fan-out table: materialise the payload once and loop over the subscriber
+        slots, instead of chasing per-connection forwarding thunks. The sort is
+        stable, so multiple subscribers of one source keep their declared
+        delivery order, and stream connections are left in front in their
+        original relative order.
+    */
+    static void flattenEventFanOut (Program& program)
+    {
+        for (auto& graph : program.getModules())
+        {
+            if (! graph->isGraph())
+                continue;
+
+            auto findSourceModule = [&] (const heart::EndpointReference& ref) -> pool_ptr<Module>
+            {
+                if (ref.processor == nullptr)
+                    return graph;
+
+                return program.findModuleWithName (ref.processor->sourceName);
+            };
+
+            auto isEventConnection = [&] (heart::Connection& c)
+            {
+                if (auto m = findSourceModule (c.source))
+                {
+                    if (auto output = m->findOutput (c.source.endpointName))
+                        return output->isEventEndpoint();
+
+                    if (auto input = m->findInput (c.source.endpointName))
+                        return input->isEventEndpoint();
+                }
+
+                return false;
+            };
+
+            removeIf (graph->connections, [&] (heart::Connection& c)
+            {
+                if (c.dest.processor == nullptr)
+                    return false;
+
+                auto destModule = program.findModuleWithName (c.dest.processor->sourceName);
+
+                if (destModule == nullptr || ! destModule->isProcessor())
+                    return false;
+
+                auto input = destModule->findInput (c.dest.endpointName);
+
+                if (input == nullptr || ! input->isEventEndpoint())
+                    return false;
+
+                for (auto& t : input->dataTypes)
+                    if (destModule->findFunction (heart::getEventFunctionName (c.dest.endpointName, t)) != nullptr)
+                        return false;
+
+                return true;
+            });
+
+            auto getSourceKey = [] (const heart::Connection& c)
+            {
+                auto instanceName = c.source.processor != nullptr ? c.source.processor->instanceName
+                                                                  : std::string();
+                return instanceName + ":" + c.source.endpointName;
+            };
+
+            std::stable_sort (graph->connections.begin(), graph->connections.end(),
+                              [&] (const pool_ref<heart::Connection>& a, const pool_ref<heart::Connection>& b)
+                              {
+                                  auto aIsEvent = isEventConnection (a.getReference());
+                                  auto bIsEvent = isEventConnection (b.getReference());
+
+                                  if (aIsEvent != bIsEvent)
+                                      return ! aIsEvent;
+
+                                  return aIsEvent && getSourceKey (a.getReference()) < getSourceKey (b.getReference());
+                              });
+        }
+    }
+
+    /** Rounds the state of per-voice processor instances up to a whole number
+        of cache lines.
+
+        When a graph instantiates a processor as an array (a bank of voices),
+        engines allocate the voices' state blobs back to back, so with an
+        arbitrary state size the tail of one voice shares a cache line with the
+        head of the next. That's harmless for serial rendering, but it becomes
+        false sharing the moment voices of the same render stage run on
+        different threads (@see heart::Utilities::assignParallelRenderStages).
+        Appending a pad which rounds each voice's packed state up to a multiple
+        of 64 bytes keeps every voice in its own set of lines - provided the
+        engine also aligns the first voice, which is what
+        Performer::getStateMemoryAlignment() lets a host confirm. Only modules
+        actually instantiated with an array size greater than one pay the cost.
+    */
+    static void padVoiceStateToCacheLineStride (Program& program)
+    {
+        std::unordered_set<const Module*> alreadyHandled;
+
+        for (auto& graph : program.getModules())
+            if (graph->isGraph())
+                for (auto& instance : graph->processorInstances)
+                    if (instance->arraySize > 1)
+                        padReplicatedModuleState (program, instance->sourceName, alreadyHandled);
+    }
+
+    static void padReplicatedModuleState (Program& program, const std::string& moduleName,
+                                          std::unordered_set<const Module*>& alreadyHandled)
+    {
+        constexpr uint64_t cacheLineSize = 64;
+        static constexpr const char* padName = "_voiceStridePad";
+
+        auto m = program.findModuleWithName (moduleName);
+
+        if (m == nullptr || ! alreadyHandled.insert (m.get()).second)
+            return;
+
+        // an arrayed graph replicates each of its sub-processors per voice, so
+        // every processor underneath it gets the same treatment as a directly
+        // arrayed one
+        if (m->isGraph())
+        {
+            for (auto& instance : m->processorInstances)
+                padReplicatedModuleState (program, instance->sourceName, alreadyHandled);
+
+            return;
+        }
+
+        if (! m->isProcessor() || m->stateVariables.empty()
+             || m->findStateVariable (padName) != nullptr)
+            return;
+
+        uint64_t stateSize = 0;
+
+        for (auto& v : m->stateVariables)
+            stateSize += v->type.getPackedSizeInBytes();
+
+        auto remainder = stateSize % cacheLineSize;
+
+        // a state size that isn't a multiple of the pad element leaves the
+        // exact stride up to the engine's own struct padding anyway
+        if (remainder == 0 || (cacheLineSize - remainder) % sizeof (int32_t) != 0)
+            return;
+
+        auto padElements = (cacheLineSize - remainder) / sizeof (int32_t);
+
+        m->stateVariables.push_back (m->allocate<heart::Variable> (CodeLocation(),
+                                                                   Type (PrimitiveType::int32).createArray ((Type::ArraySize) padElements),
+                                                                   m->allocator.get (padName),
+                                                                   heart::Variable::Role::state));
+    }
+
+    /** Partitions every function into hot and cold code sections.
+
+        Generated modules otherwise interleave init(), once-off setup and run-loop
+        code in memory, so one-shot code shares instruction-cache lines with the
+        render loop - visible as icache misses in programs built from many small
+        processors. Classification walks the call graph: run() and the event
+        handlers seed the hot set and everything they can reach joins it, then
+        whatever is left - the init functions, helpers only they call, and
+        unreachable code - is cold. A function reachable from both sides counts
+        as hot, since placing it away from the render loop is the mistake that
+        costs per block. Back-ends read heart::Function::codeSection and emit the
+        cold set into a separate region; within a hot function, the BranchIf
+        likelihood hints already mark which blocks belong off the main path.
+    */
+    static void assignCodeSections (Program& program)
+    {
+        for (auto& m : program.getModules())
+            for (auto& f : m->functions)
+                f->codeSection = heart::CodeSection::unknown;
+
+        for (auto& m : program.getModules())
+            for (auto& f : m->functions)
+                if (f->functionType.isRun() || f->functionType.isEvent())
+                    markCallTreeHot (f);
+
+        for (auto& m : program.getModules())
+            for (auto& f : m->functions)
+                if (f->codeSection == heart::CodeSection::unknown)
+                    f->codeSection = heart::CodeSection::cold;
+    }
+
+    static void markCallTreeHot (heart::Function& f)
+    {
+        if (f.codeSection == heart::CodeSection::hot)
+            return;
+
+        f.codeSection = heart::CodeSection::hot;
+
+        for (auto& b : f.blocks)
+            for (auto s : b->statements)
+                if (auto call = cast<heart::FunctionCall> (*s))
+                    markCallTreeHot (call->getFunction());
+    }
+
+    /** Reorders each processor's state variables so the frequently-touched ones
+        sit together at the front of the state layout.
+
+        Engines lay a processor's state out in stateVariables order, so a phase
+        accumulator declared after a big configuration table ends up a long way
+        from the other per-frame members and drags an extra cache line into
+        every frame. This sorts the list by how often each variable is sighted
+        outside the init functions - accesses in run() weighted well above
+        event handlers, init-only data counting as cold - so the hot members
+        pack into the fewest lines and the cold configuration tail stays out of
+        the way. The sort is stable, so equally-ranked members keep their
+        declaration order, and a processor can opt out of any reordering with a
+        [[ fixed_layout ]] annotation.
+    */
+    static void reorderStateByAccessFrequency (Program& program)
+    {
+        // chosen so that one access per frame outranks a handful of accesses
+        // in an occasionally-fired event handler
+        constexpr uint64_t runFunctionWeight = 16;
+
+        for (auto& m : program.getModules())
+        {
+            if (! m->isProcessor() || m->stateVariables.size() < 2)
+                continue;
+
+            if (m->annotation.getBool ("fixed_layout"))
+                continue;
+
+            std::unordered_map<const heart::Variable*, uint64_t> accessFrequency;
+
+            for (auto& f : m->functions)
+            {
+                if (f->functionType.isSystemInit() || f->functionType.isUserInit())
+                    continue;
+
+                auto weight = f->functionType.isRun() ? runFunctionWeight : 1;
+
+                f->visitExpressions ([&] (pool_ref<heart::Expression>& e, AccessType)
+                {
+                    if (auto v = cast<heart::Variable> (e))
+                        if (v->isState())
+                            accessFrequency[v.get()] += weight;
+                });
+            }
+
+            auto getFrequency = [&] (const pool_ref<heart::Variable>& v) -> uint64_t
+            {
+                auto found = accessFrequency.find (v.getPointer());
+                return found != accessFrequency.end() ? found->second : 0;
+            };
+
+            std::stable_sort (m->stateVariables.begin(), m->stateVariables.end(),
+                              [&] (const pool_ref<heart::Variable>& a, const pool_ref<heart::Variable>& b)
+                              {
+                                  return getFrequency (a) > getFrequency (b);
+                              });
+        }
+    }
+
+    /** Merges duplicate advance-only blocks, so run() keeps fewer resume points.
+
+        Every block containing an advance is a resume point in the state machine
+        a back-end generates for run(): execution parks there at the end of a
+        frame, and the next frame re-enters through a dispatch branch over all
+        such points. Inlining and processor fusion routinely leave several
+        blocks which do nothing but advance and jump to the same place - one
+        per original call site - and each of them widens that dispatch without
+        changing behaviour. Blocks with identical advance-only bodies and the
+        same argument-free branch destination are collapsed into one, keeping
+        the resume table as small as the control flow actually requires.
+    */
+    static void mergeDuplicateAdvanceBlocks (Program& program)
+    {
+        for (auto& m : program.getModules())
+            if (m->isProcessor())
+                for (auto& f : m->functions)
+                    mergeDuplicateAdvanceBlocks (f, m->allocator);
+    }
+
+    static void mergeDuplicateAdvanceBlocks (heart::Function& f, heart::Allocator& allocator)
+    {
+        struct MergableBlock
+        {
+            pool_ref<heart::Block> block;
+            heart::Block* destination;
+            size_t numAdvances;
+        };
+
+        // a block is mergable when its body is nothing but advance calls and it
+        // ends in a plain branch carrying no arguments
+        auto getMergableBlock = [] (pool_ref<heart::Block> b) -> MergableBlock
+        {
+            if (! b->parameters.empty() || b->doNotOptimiseAway)
+                return { b, nullptr, 0 };
+
+            size_t numAdvances = 0;
+
+            for (auto s : b->statements)
+            {
+                if (! is_type<heart::AdvanceClock> (*s))
+                    return { b, nullptr, 0 };
+
+                ++numAdvances;
+            }
+
+            if (numAdvances == 0 || b->terminator == nullptr)
+                return { b, nullptr, 0 };
+
+            auto branch = cast<heart::Branch> (*b->terminator);
+
+            if (branch == nullptr || branch->isParameterised())
+                return { b, nullptr, 0 };
+
+            return { b, branch->target.getPointer(), numAdvances };
+        };
+
+        std::vector<MergableBlock> keptBlocks;
+        std::vector<pool_ref<heart::Block>> duplicates;
+
+        for (auto& b : f.blocks)
+        {
+            auto candidate = getMergableBlock (b);
+
+            if (candidate.destination == nullptr)
+                continue;
+
+            auto existing = std::find_if (keptBlocks.begin(), keptBlocks.end(), [&] (const MergableBlock& kept)
+                                          {
+                                              return kept.destination == candidate.destination
+                                                      && kept.numAdvances == candidate.numAdvances;
+                                          });
+
+            if (existing == keptBlocks.end())
+            {
+                keptBlocks.push_back (candidate);
+                continue;
+            }
+
+            for (auto& other : f.blocks)
+                if (other->terminator != nullptr)
+                    for (auto& dest : other->terminator->getDestinationBlocks())
+                        if (dest == b.get())
+                            dest = existing->block;
+
+            duplicates.push_back (b);
         }
+
+        if (duplicates.empty())
+            return;
+
+        removeFromVector (f.blocks, duplicates);
+        simplifyBlockGraph (f, allocator);
+    }
+
+    static bool isDynamicallyIndexed (Module& m, heart::Variable& v)
+    {
+        bool found = false;
+
+        for (auto& f : m.functions)
+            f->visitExpressions ([&] (pool_ref<heart::Expression>& e, AccessType)
+            {
+                if (auto ae = cast<heart::ArrayElement> (e))
+                    if (ae->isDynamic() && ae->parent.getPointer() == std::addressof (v))
+                        found = true;
+            });
+
+        return found;
     }
 
     static void removeUnusedFunctions (Program& program, Module& mainModule)
@@ -158,593 +797,2914 @@ struct Optimisations
 
     static void optimiseFunctionBlocks (heart::Function& f, heart::Allocator& allocator)
     {
-        f.rebuildBlockPredecessors();
-        eliminateEmptyAndUnreachableBlocks (f, allocator);
-        eliminateUnreachableBlockCycles (f);
-        mergeAdjacentBlocks (f);
-    }
+        simplifyBlockGraph (f, allocator);
 
-    static void makeFunctionCallInline (Program& program, heart::Function& parentFunction,
-                                        size_t blockIndex, heart::FunctionCall& call)
-    {
-        SOUL_ASSERT (heart::Utilities::canFunctionBeInlined (program, parentFunction, call));
-        SOUL_ASSERT (contains (parentFunction.blocks[blockIndex]->statements, std::addressof (call)));
+        // the SSA construction needs a fully-reachable graph, so it runs after the
+        // first clean-up, and any forwarding blocks it adds which end up carrying
+        // nothing are tidied away by a second pass over the graph
+        if (promoteLocalsToSSA (f, allocator))
+            simplifyBlockGraph (f, allocator);
 
-        Inliner (program.getModuleContainingFunction (call.getFunction()),
-                 parentFunction, blockIndex, call, call.getFunction()).perform();
+        hoistLoopInvariantAssignments (f);
+        eliminateRedundantLoadsAndStores (f);
     }
 
-    static bool inlineAllCallsToFunction (Program& program, heart::Function& functionToInline)
+    static void simplifyBlockGraph (heart::Function& f, heart::Allocator& allocator)
     {
-        bool anyChanged = false;
-
-        for (auto& m : program.getModules())
+        // Each of these transformations can expose more work for the others - threading
+        // a jump can empty a block, which lets its neighbours merge, which can leave a
+        // constant branch - so keep going round until the graph stops shrinking
+        for (;;)
         {
-            for (auto& f : m->functions)
-            {
-                auto result = inlineAllCallsToFunction (program, f, functionToInline);
+            f.rebuildBlockPredecessors();
 
-                if (result == InlineResult::failed)
-                    return false;
+            bool anyChanges = simplifyBranches (f, allocator);
+            anyChanges = eliminateEmptyAndUnreachableBlocks (f, allocator) || anyChanges;
+            anyChanges = eliminateUnreachableBlockCycles (f) || anyChanges;
+            anyChanges = mergeAdjacentBlocks (f) || anyChanges;
 
-                if (result == InlineResult::ok)
-                    anyChanged = true;
-            }
+            if (! anyChanges)
+                break;
         }
+    }
 
-        if (! anyChanged)
+    /** Rewrites a function's promotable mutable locals into SSA form.
+
+        convertWriteOnceVariablesToConstants only catches variables with a single
+        store; this is the general construction. Every whole-variable store becomes
+        a fresh single-assignment value, reads are rewritten to use whichever value
+        reaches them, and where paths carrying different values merge, the merged
+        value becomes a block parameter. Parameter placement uses the iterated
+        dominance frontiers of the stores, pruned by block-level liveness so that no
+        parameter is created for a value which is dead on entry to its merge block.
+
+        Only a plain branch can carry block arguments, so a conditional edge into a
+        merge which needs them is split with an empty forwarding block - the block
+        simplification passes that run afterwards tidy up any splits left carrying
+        nothing.
+
+        A variable is only promoted when every access to it is a whole-variable read
+        or store: reference types, partial writes and variables passed to reference
+        parameters keep their memory form, as does anything read before any store
+        reaches it only through unreachable code.
+    */
+    static bool promoteLocalsToSSA (heart::Function& f, heart::Allocator& allocator)
+    {
+        // a single-block function has no merges, and the block-local load/store
+        // elimination pass already achieves everything SSA would
+        if (f.blocks.size() < 2)
             return false;
 
-        removeItem (program.getModuleContainingFunction (functionToInline).functions, functionToInline);
-        return true;
-    }
+        BlockDominatorTree tree;
 
-    static void garbageCollectStringDictionary (Program& program)
-    {
+        if (! tree.build (f))
+            return false;
+
+        auto numBlocks = tree.order.size();
+
+        // Find the variables where every access is a whole-variable read or store.
+        // A statement's own target is the only place a write is acceptable - any
+        // other non-read access (a partial write, or a reference argument) means
+        // the variable has to stay in memory form.
+        std::vector<heart::Variable*> candidates;
+        std::unordered_map<heart::Variable*, size_t> candidateIndices;
+        std::unordered_set<heart::Variable*> rejected;
+
+        auto isPromotableRole = [] (heart::Variable& v)
+        {
+            return v.isMutableLocal() && ! v.type.isReference() && v.initialValue == nullptr;
+        };
+
+        auto getWholeStoreTarget = [] (heart::Statement& s) -> heart::Variable*
+        {
+            if (auto a = cast<heart::Assignment> (s))
+                if (auto targetVar = cast<heart::Variable> (a->target))
+                    return targetVar.get();
+
+            return {};
+        };
+
+        for (auto& b : f.blocks)
+        {
+            for (auto s : b->statements)
+            {
+                auto storeTarget = getWholeStoreTarget (*s);
+
+                s->visitExpressions ([&] (pool_ref<heart::Expression>& value, AccessType mode)
+                {
+                    if (auto v = cast<heart::Variable> (value))
+                    {
+                        if (! isPromotableRole (*v))
+                            return;
+
+                        if (mode != AccessType::read && ! (mode == AccessType::write && v.get() == storeTarget))
+                        {
+                            rejected.insert (v.get());
+                            return;
+                        }
+
+                        if (candidateIndices.find (v.get()) == candidateIndices.end())
+                        {
+                            candidateIndices[v.get()] = candidates.size();
+                            candidates.push_back (v.get());
+                        }
+                    }
+                });
+            }
+        }
+
+        removeIf (candidates, [&] (heart::Variable* v) { return rejected.find (v) != rejected.end(); });
+
+        if (candidates.empty())
+            return false;
+
+        candidateIndices.clear();
+
+        for (size_t i = 0; i < candidates.size(); ++i)
+            candidateIndices[candidates[i]] = i;
+
+        auto numVars = candidates.size();
+
+        // Block-level liveness: a variable is upward-exposed in a block if it can be
+        // read there before any store, and live-in if an upward-exposed read is
+        // reachable without passing a store.
+        std::vector<std::vector<bool>> liveIn (numBlocks, std::vector<bool> (numVars, false)),
+                                       upwardExposed (numBlocks, std::vector<bool> (numVars, false)),
+                                       storedIn (numBlocks, std::vector<bool> (numVars, false));
+        std::vector<std::vector<size_t>> defBlocks (numVars);
+
+        auto getCandidateIndex = [&] (heart::Expression& e) -> ptrdiff_t
+        {
+            if (auto v = cast<heart::Variable> (e))
+            {
+                auto found = candidateIndices.find (v.get());
+
+                if (found != candidateIndices.end())
+                    return (ptrdiff_t) found->second;
+            }
+
+            return -1;
+        };
+
+        for (size_t blockIndex = 0; blockIndex < numBlocks; ++blockIndex)
+        {
+            auto& block = tree.order[blockIndex].get();
+
+            auto noteReads = [&] (pool_ref<heart::Expression>& value, AccessType mode)
+            {
+                if (mode == AccessType::read)
+                    if (auto index = getCandidateIndex (value); index >= 0)
+                        if (! storedIn[blockIndex][(size_t) index])
+                            upwardExposed[blockIndex][(size_t) index] = true;
+            };
+
+            for (auto s : block.statements)
+            {
+                s->visitExpressions (noteReads);
+
+                if (auto storeTarget = getWholeStoreTarget (*s))
+                {
+                    if (auto index = getCandidateIndex (*storeTarget); index >= 0)
+                    {
+                        storedIn[blockIndex][(size_t) index] = true;
+
+                        if (! contains (defBlocks[(size_t) index], blockIndex))
+                            defBlocks[(size_t) index].push_back (blockIndex);
+                    }
+                }
+            }
+
+            if (block.terminator != nullptr)
+                block.terminator->visitExpressions (noteReads);
+        }
+
+        liveIn = upwardExposed;
+
+        for (bool changed = true; changed;)
+        {
+            changed = false;
+
+            for (size_t blockIndex = numBlocks; blockIndex-- != 0;)
+            {
+                auto& block = tree.order[blockIndex].get();
+
+                if (block.terminator == nullptr)
+                    continue;
+
+                for (auto& destination : block.terminator->getDestinationBlocks())
+                {
+                    auto& successorLiveIn = liveIn[tree.indexOf[destination.getPointer()]];
+
+                    for (size_t i = 0; i < numVars; ++i)
+                    {
+                        if (successorLiveIn[i] && ! storedIn[blockIndex][i] && ! liveIn[blockIndex][i])
+                        {
+                            liveIn[blockIndex][i] = true;
+                            changed = true;
+                        }
+                    }
+                }
+            }
+        }
+
+        // Phi placement: block parameters go at the iterated dominance frontier of
+        // each variable's stores, skipping frontier blocks it isn't live into. The
+        // entry block isn't allowed parameters, so a variable whose frontier reaches
+        // it just stays unpromoted.
+        std::vector<std::vector<std::pair<size_t, pool_ref<heart::Variable>>>> blockPhis (numBlocks);
+        std::vector<bool> promoted (numVars, false);
+        size_t phiNameIndex = 0;
+
+        for (size_t i = 0; i < numVars; ++i)
+        {
+            auto& v = *candidates[i];
+            std::vector<size_t> worklist (defBlocks[i]), phiBlocks;
+            std::vector<bool> hasPhi (numBlocks, false);
+            bool canPromote = true;
+
+            while (canPromote && ! worklist.empty())
+            {
+                auto definingBlock = worklist.back();
+                worklist.pop_back();
+
+                for (auto frontierBlock : tree.dominanceFrontiers[definingBlock])
+                {
+                    if (! hasPhi[frontierBlock] && liveIn[frontierBlock][i])
+                    {
+                        if (frontierBlock == 0)
+                        {
+                            canPromote = false;
+                            break;
+                        }
+
+                        hasPhi[frontierBlock] = true;
+                        phiBlocks.push_back (frontierBlock);
+                        worklist.push_back (frontierBlock);
+                    }
+                }
+            }
+
+            if (! canPromote)
+                continue;
+
+            promoted[i] = true;
+
+            for (auto blockIndex : phiBlocks)
+            {
+                auto& param = allocator.allocate<heart::Variable> (v.location, v.type,
+                                                                   allocator.get ("_phi" + std::to_string (phiNameIndex++)),
+                                                                   heart::Variable::Role::parameter);
+                tree.order[blockIndex]->addParameter (param);
+                blockPhis[blockIndex].push_back ({ i, param });
+            }
+        }
+
+        if (std::find (promoted.begin(), promoted.end(), true) == promoted.end())
+            return false;
+
+        // Renaming: walk the dominator tree carrying the value that each variable
+        // currently holds, rewriting reads, turning each store into a fresh
+        // single-assignment value, and passing the reaching values into successor
+        // block parameters as branch arguments. A read that no store reaches gets
+        // the zero-initialised value the language guarantees.
+        struct Frame
+        {
+            size_t blockIndex;
+            std::vector<heart::Expression*> reachingValues;
+        };
+
+        std::unordered_set<std::string> blockNames;
+
+        for (auto& b : f.blocks)
+            blockNames.insert (b->name.toString());
+
+        size_t splitNameIndex = 0;
+        std::vector<pool_ref<heart::Block>> splitBlocks;
+        std::vector<Frame> stack;
+        stack.push_back ({ 0, std::vector<heart::Expression*> (numVars, nullptr) });
+
+        while (! stack.empty())
+        {
+            auto frame = std::move (stack.back());
+            stack.pop_back();
+
+            auto& block = tree.order[frame.blockIndex].get();
+            auto& reachingValues = frame.reachingValues;
+
+            auto getReachingValue = [&] (size_t index) -> heart::Expression&
+            {
+                if (reachingValues[index] == nullptr)
+                    reachingValues[index] = std::addressof (allocator.allocateZeroInitialiser (candidates[index]->type));
+
+                return *reachingValues[index];
+            };
+
+            auto rewriteReads = [&] (pool_ref<heart::Expression>& value, AccessType mode)
+            {
+                if (mode == AccessType::read)
+                    if (auto index = getCandidateIndex (value); index >= 0 && promoted[(size_t) index])
+                        value = getReachingValue ((size_t) index);
+            };
+
+            // A block parameter is only in scope within its own block, so each merged
+            // value is immediately copied into a single-assignment local which the
+            // dominated blocks can read - the same pattern the HEART generator uses.
+            // (iterating backwards keeps the front-inserted copies in parameter order)
+            for (size_t p = blockPhis[frame.blockIndex].size(); p-- != 0;)
+            {
+                auto& phi = blockPhis[frame.blockIndex][p];
+                auto& param = phi.second.get();
+                auto& phiValue = allocator.allocate<heart::Variable> (param.location, param.type,
+                                                                      heart::Variable::Role::constant);
+                block.statements.insertFront (allocator.allocateStatement<heart::AssignFromValue> (param.location, phiValue, param));
+                reachingValues[phi.first] = std::addressof (phiValue);
+            }
+
+            for (auto s : block.statements)
+            {
+                s->visitExpressions (rewriteReads);
+
+                if (auto storeTarget = getWholeStoreTarget (*s))
+                {
+                    if (auto index = getCandidateIndex (*storeTarget); index >= 0 && promoted[(size_t) index])
+                    {
+                        auto assignment = cast<heart::Assignment> (*s);
+                        auto& ssaValue = allocator.allocate<heart::Variable> (storeTarget->location, storeTarget->type,
+                                                                              heart::Variable::Role::constant);
+                        assignment->target = ssaValue;
+                        reachingValues[(size_t) index] = std::addressof (ssaValue);
+                    }
+                }
+            }
+
+            if (block.terminator != nullptr)
+            {
+                block.terminator->visitExpressions (rewriteReads);
+
+                auto getArgsForTarget = [&] (heart::Block& target) -> heart::Branch::ArgListType
+                {
+                    heart::Branch::ArgListType args;
+
+                    for (auto& phi : blockPhis[tree.indexOf[std::addressof (target)]])
+                        args.push_back (getReachingValue (phi.first));
+
+                    return args;
+                };
+
+                if (auto branch = cast<heart::Branch> (*block.terminator))
+                {
+                    for (auto& arg : getArgsForTarget (branch->target))
+                        branch->targetArgs.push_back (arg);
+                }
+                else if (auto branchIf = cast<heart::BranchIf> (*block.terminator))
+                {
+                    // a conditional branch can't carry block arguments, so any edge
+                    // that needs them is routed through a forwarding block
+                    pool_ptr<heart::Block> previousSplit;
+                    auto previousTarget = branchIf->targets[0];
+
+                    for (size_t slot = 0; slot < 2; ++slot)
+                    {
+                        auto target = branchIf->targets[slot];
+
+                        if (slot == 1 && target == previousTarget && previousSplit != nullptr)
+                        {
+                            branchIf->targets[1] = *previousSplit;
+                            continue;
+                        }
+
+                        auto args = getArgsForTarget (target);
+
+                        if (args.empty())
+                            continue;
+
+                        std::string splitName;
+
+                        do
+                            splitName = "@_ssa_edge_" + std::to_string (splitNameIndex++);
+                        while (blockNames.find (splitName) != blockNames.end());
+
+                        auto& split = allocator.allocate<heart::Block> (allocator.get (splitName));
+                        auto& splitBranch = allocator.allocateStatement<heart::Branch> (target);
+                        splitBranch.targetArgs = std::move (args);
+                        split.terminator = splitBranch;
+                        splitBlocks.push_back (split);
+                        branchIf->targets[slot] = split;
+
+                        if (slot == 0)
+                            previousSplit = split;
+                    }
+                }
+            }
+
+            for (auto child : tree.treeChildren[frame.blockIndex])
+                stack.push_back ({ child, frame.reachingValues });
+        }
+
+        for (auto& b : splitBlocks)
+            f.blocks.push_back (b);
+
+        f.rebuildBlockPredecessors();
+        return true;
+    }
+
+    /** Performs block-local forwarding of stored values and removal of dead stores.
+
+        When a whole variable is assigned a constant or another whole variable, later
+        reads of it in the same block are rewritten to use the stored value directly,
+        so repeated reads of a state member within one iteration stop being memory
+        traffic. A whole-variable store which is overwritten before anything could have
+        observed it is removed. Both are invalidated conservatively: a function call or
+        advance() forgets everything (the callee may touch any state), a partial write
+        or stream read forgets the variable it touches, and forwarding stops if the
+        source variable itself is reassigned. Nothing is tracked across block
+        boundaries - between blocks, the loop-invariant hoisting pass does the lifting.
+    */
+    static bool eliminateRedundantLoadsAndStores (heart::Function& f)
+    {
+        bool anyChanges = false;
+
+        for (auto& b : f.blocks)
+        {
+            // The value known to be held by each variable - the source of its last
+            // whole-variable store, when that source was a constant or a variable.
+            std::unordered_map<heart::Variable*, heart::Expression*> knownValues;
+
+            // Whole-variable stores that nothing has observed yet: if the same
+            // variable is wholly stored again first, the earlier store was dead.
+            std::unordered_map<heart::Variable*, heart::Statement*> unobservedStores;
+            std::unordered_set<heart::Statement*> deadStores;
+
+            auto forgetValuesSourcedFrom = [&] (heart::Variable& v)
+            {
+                for (auto i = knownValues.begin(); i != knownValues.end();)
+                {
+                    if (auto sourceVar = cast<heart::Variable> (*i->second); sourceVar != nullptr && sourceVar.get() == std::addressof (v))
+                        i = knownValues.erase (i);
+                    else
+                        ++i;
+                }
+            };
+
+            auto forgetVariable = [&] (heart::Variable& v)
+            {
+                knownValues.erase (std::addressof (v));
+                unobservedStores.erase (std::addressof (v));
+                forgetValuesSourcedFrom (v);
+            };
+
+            auto forgetEverything = [&]
+            {
+                knownValues.clear();
+                unobservedStores.clear();
+            };
+
+            auto canBeTracked = [] (heart::Variable& v)
+            {
+                return (v.isState() || v.isFunctionLocal()) && ! v.type.isReference();
+            };
+
+            for (auto s : b->statements)
+            {
+                s->visitExpressions ([&] (pool_ref<heart::Expression>& value, AccessType mode)
+                {
+                    if (auto v = cast<heart::Variable> (value))
+                    {
+                        // a pure write isn't an observation, so it doesn't keep an
+                        // earlier store alive
+                        if (mode != AccessType::write)
+                            unobservedStores.erase (v.get());
+
+                        if (mode == AccessType::read)
+                        {
+                            auto known = knownValues.find (v.get());
+
+                            if (known != knownValues.end())
+                            {
+                                value = *known->second;
+                                anyChanges = true;
+                            }
+                        }
+                    }
+                });
+
+                if (auto assignment = cast<heart::AssignFromValue> (*s))
+                {
+                    if (auto targetVar = cast<heart::Variable> (*assignment->target); targetVar != nullptr && canBeTracked (*targetVar))
+                    {
+                        auto previousStore = unobservedStores.find (targetVar.get());
+
+                        if (previousStore != unobservedStores.end())
+                        {
+                            deadStores.insert (previousStore->second);
+                            anyChanges = true;
+                        }
+
+                        forgetVariable (*targetVar);
+                        unobservedStores[targetVar.get()] = s;
+
+                        auto& source = assignment->source.get();
+
+                        if ((is_type<heart::Constant> (source)
+                              || (is_type<heart::Variable> (source)
+                                   && canBeTracked (static_cast<heart::Variable&> (source))
+                                   && std::addressof (source) != static_cast<heart::Expression*> (targetVar.get())))
+                             && source.getType().isIdentical (targetVar->type))
+                            knownValues[targetVar.get()] = std::addressof (source);
+
+                        continue;
+                    }
+
+                    if (auto rootVar = assignment->target->getRootVariable())
+                        forgetVariable (*rootVar);
+
+                    continue;
+                }
+
+                if (is_type<heart::FunctionCall> (*s) || is_type<heart::AdvanceClock> (*s))
+                {
+                    forgetEverything();
+                    continue;
+                }
+
+                if (auto read = cast<heart::ReadStream> (*s))
+                    if (auto rootVar = read->target->getRootVariable())
+                        forgetVariable (*rootVar);
+            }
+
+            if (! deadStores.empty())
+                b->statements.removeMatches ([&] (heart::Statement& s) { return deadStores.find (std::addressof (s)) != deadStores.end(); });
+        }
+
+        return anyChanges;
+    }
+
+    /** Hoists assignments whose value can't change between loop iterations out into
+        the block that enters the loop.
+
+        This is deliberately conservative: only whole-variable assignments of pure,
+        loop-invariant expressions in a loop's header block are moved, and only when
+        the loop has a unique external predecessor ending in a plain branch to hoist
+        them into. The header runs whenever the loop is entered, so moving its
+        invariant work into that predecessor changes how often it runs, not whether.
+    */
+    static bool hoistLoopInvariantAssignments (heart::Function& f)
+    {
+        f.rebuildBlockPredecessors();
+        f.rebuildVariableUseCounts();
+
+        bool anyChanges = false;
+
+        for (auto& loop : findLoopBlockGroups (f))
+            anyChanges = hoistInvariantsOutOfLoop (loop) || anyChanges;
+
+        return anyChanges;
+    }
+
+    static void makeFunctionCallInline (Program& program, heart::Function& parentFunction,
+                                        size_t blockIndex, heart::FunctionCall& call)
+    {
+        SOUL_ASSERT (heart::Utilities::canFunctionBeInlined (program, parentFunction, call));
+        SOUL_ASSERT (contains (parentFunction.blocks[blockIndex]->statements, std::addressof (call)));
+
+        Inliner (program.getModuleContainingFunction (call.getFunction()),
+                 parentFunction, blockIndex, call, call.getFunction()).perform();
+    }
+
+    /** Inlines calls to functions which a simple cost model decides are worth it.
+
+        Functions which use advance() or streams have to be inlined for correctness and
+        are handled unconditionally elsewhere; this pass is purely about performance.
+        A function is inlined everywhere when its body is so small that the call
+        overhead outweighs it, or when the total code growth from duplicating it into
+        its callers stays within a fixed budget - so a two-line helper disappears into
+        every call site, while a big shared table-lookup routine keeps its single copy
+        and its instruction-cache footprint. Sizes and call counts are measured once
+        up-front, which keeps the model simple at the cost of slightly stale numbers
+        as inlining proceeds.
+    */
+    static void inlineSmallFunctions (Program& program)
+    {
+        // below this many statements, a call sequence is dearer than the body itself
+        constexpr size_t alwaysInlineSize = 6;
+
+        // the most extra statements we'll accept duplicating per function
+        constexpr size_t duplicationBudget = 60;
+
+        std::unordered_map<const heart::Function*, size_t> numCallSites;
+
+        for (auto& m : program.getModules())
+            for (auto& f : m->functions)
+                f->visitStatements<heart::FunctionCall> ([&] (heart::FunctionCall& call)
+                                                         { ++numCallSites[std::addressof (call.getFunction())]; });
+
+        auto getFunctionSize = [] (heart::Function& f)
+        {
+            size_t size = f.blocks.size();
+
+            for (auto& b : f.blocks)
+                for (auto s : b->statements)
+                {
+                    ignoreUnused (s);
+                    ++size;
+                }
+
+            return size;
+        };
+
+        auto callsItself = [] (heart::Function& f)
+        {
+            bool result = false;
+            f.visitStatements<heart::FunctionCall> ([&] (heart::FunctionCall& call)
+                                                    { result = result || std::addressof (call.getFunction()) == std::addressof (f); });
+            return result;
+        };
+
+        for (auto& m : program.getModules())
+        {
+            auto functions = m->functions;  // inlining removes entries, so iterate a copy
+
+            for (auto& f : functions)
+            {
+                if (! f->functionType.isNormal() || f->isExported || f->hasNoBody || callsItself (f))
+                    continue;
+
+                auto calls = numCallSites.find (f.getPointer());
+
+                if (calls == numCallSites.end())
+                    continue;
+
+                auto size = getFunctionSize (f);
+
+                auto describeCallSites = [] (size_t n) { return std::to_string (n) + (n == 1 ? " call site" : " call sites"); };
+
+                if (size <= alwaysInlineSize || size * (calls->second - 1) <= duplicationBudget)
+                {
+                    if (inlineAllCallsToFunction (program, f) && areOptimisationRemarksEnabled())
+                        emitOptimisationRemark (f->location,
+                                                "inlined function '" + f->name.toString() + "' into its "
+                                                  + describeCallSites (calls->second));
+                }
+                else if (areOptimisationRemarksEnabled())
+                {
+                    emitOptimisationRemark (f->location,
+                                            "not inlining function '" + f->name.toString() + "': duplicating its "
+                                              + std::to_string (size) + " statements into "
+                                              + describeCallSites (calls->second) + " would exceed the code-growth budget");
+                }
+            }
+        }
+
+        flattenLeafCallChains (program);
+    }
+
+    /** Inlines small leaf functions, repeating until the call graph stops changing.
+
+        This accepts more code growth than inlineSmallFunctions(): absorbing a leaf
+        removes a whole frame from the deepest call path, which matters on embedded
+        targets where render-thread stacks are sized from the worst case. Each round
+        can turn a caller into a new leaf, so chains of small helpers collapse
+        upwards one level per iteration.
+    */
+    static void flattenLeafCallChains (Program& program)
+    {
+        // the largest leaf body worth duplicating in exchange for removing its frame
+        constexpr size_t leafInlineSize = 12;
+
+        auto getFunctionSize = [] (heart::Function& f)
+        {
+            size_t size = f.blocks.size();
+
+            for (auto& b : f.blocks)
+                for (auto s : b->statements)
+                {
+                    ignoreUnused (s);
+                    ++size;
+                }
+
+            return size;
+        };
+
+        auto isLeaf = [] (heart::Function& f)
+        {
+            bool result = true;
+            f.visitStatements<heart::FunctionCall> ([&] (heart::FunctionCall&) { result = false; });
+            return result;
+        };
+
+        for (;;)
+        {
+            bool anyInlined = false;
+
+            for (auto& m : program.getModules())
+            {
+                auto functions = m->functions;  // inlining removes entries, so iterate a copy
+
+                for (auto& f : functions)
+                {
+                    if (! f->functionType.isNormal() || f->isExported || f->hasNoBody)
+                        continue;
+
+                    if (isLeaf (f) && getFunctionSize (f) <= leafInlineSize)
+                    {
+                        if (inlineAllCallsToFunction (program, f))
+                        {
+                            anyInlined = true;
+
+                            if (areOptimisationRemarksEnabled())
+                                emitOptimisationRemark (f->location,
+                                                        "inlined leaf function '" + f->name.toString() + "' to flatten its call chain");
+                        }
+                    }
+                }
+            }
+
+            if (! anyInlined)
+                break;
+        }
+    }
+
+    static bool inlineAllCallsToFunction (Program& program, heart::Function& functionToInline)
+    {
+        bool anyChanged = false;
+
+        for (auto& m : program.getModules())
+        {
+            for (auto& f : m->functions)
+            {
+                auto result = inlineAllCallsToFunction (program, f, functionToInline);
+
+                if (result == InlineResult::failed)
+                    return false;
+
+                if (result == InlineResult::ok)
+                    anyChanged = true;
+            }
+        }
+
+        if (! anyChanged)
+            return false;
+
+        removeItem (program.getModuleContainingFunction (functionToInline).functions, functionToInline);
+        return true;
+    }
+
+    static void garbageCollectStringDictionary (Program& program)
+    {
         std::vector<StringDictionary::Handle> handlesUsed;
 
-        for (auto& m : program.getModules())
-            for (auto f : m->functions)
-                f->visitExpressions ([&] (pool_ref<heart::Expression>& e, AccessType)
-                                     {
-                                         if (auto c = cast<heart::Constant> (e))
-                                         {
-                                             const auto& type = c->value.getType();
+        for (auto& m : program.getModules())
+            for (auto f : m->functions)
+                f->visitExpressions ([&] (pool_ref<heart::Expression>& e, AccessType)
+                                     {
+                                         if (auto c = cast<heart::Constant> (e))
+                                         {
+                                             const auto& type = c->value.getType();
+
+                                             if (type.isStringLiteral())
+                                             {
+                                                 auto handle = c->value.getStringLiteral();
+
+                                                 if (! contains (handlesUsed, handle))
+                                                     handlesUsed.push_back (handle);
+                                             }
+                                         }
+                                     });
+
+        program.getStringDictionary()
+            .removeIf ([&] (const StringDictionary::Item& item) { return ! contains (handlesUsed, item.handle); });
+    }
+
+    //==============================================================================
+    /** Fuses pairs of processor instances that are joined by a plain stream
+        connection into a single combined processor.
+
+        Every graph connection materialises an intermediate buffer which the
+        upstream run() fills and the downstream run() re-reads a moment later. For
+        chains of small per-frame processors (gain -> filter -> pan), that buffer
+        traffic can cost more than the arithmetic itself, so where it's provably
+        safe the two run() loops are woven into one and the value crosses between
+        them in a local variable instead.
+
+        Only the straightforward shape is touched: a zero-delay, non-interpolated
+        stream connection whose two endpoints have no other readers or writers,
+        joining two plain instances (no arrays, no clock ratio changes) of
+        different processors whose run() functions have settled into the canonical
+        form of some optional init blocks falling into a single self-looping block
+        that ends with the function's only advance. The block-level optimisations
+        are what produce that form, so this pass runs after them. It repeats until
+        nothing more can be combined, so a linear chain of simple processors
+        collapses pairwise into a handful of fused kernels.
+    */
+    static void fuseProcessorChains (Program& program)
+    {
+        // each successful fusion rewrites the graph it was found in, so just
+        // restart the scan until a whole pass finds nothing left to combine
+        while (fuseFirstFusableConnection (program))
+        {}
+
+        if (areOptimisationRemarksEnabled())
+            reportUnfusedConnections (program);
+    }
+
+
+private:
+    //==============================================================================
+    /** The dominator tree and dominance frontiers of a function's block graph,
+        computed with the Cooper-Harvey-Kennedy iterative algorithm over a reverse
+        postorder numbering. All the index vectors are indexed by position in
+        `order`, whose first entry is always the function's entry block.
+    */
+    struct BlockDominatorTree
+    {
+        std::vector<pool_ref<heart::Block>> order;
+        std::unordered_map<heart::Block*, size_t> indexOf;
+        std::vector<size_t> immediateDominator;
+        std::vector<std::vector<size_t>> dominanceFrontiers, treeChildren;
+
+        /** Returns false if the graph contains unreachable blocks, which the caller
+            should remove before trying to reason about dominance.
+        */
+        bool build (heart::Function& f)
+        {
+            f.rebuildBlockPredecessors();
+
+            std::unordered_set<heart::Block*> visited;
+            std::vector<std::pair<heart::Block*, size_t>> visitStack;
+            std::vector<pool_ref<heart::Block>> postorder;
+            postorder.reserve (f.blocks.size());
+
+            auto& entry = f.blocks.front().get();
+            visited.insert (std::addressof (entry));
+            visitStack.push_back ({ std::addressof (entry), 0 });
+
+            while (! visitStack.empty())
+            {
+                auto& top = visitStack.back();
+                auto destinations = top.first->terminator != nullptr ? top.first->terminator->getDestinationBlocks()
+                                                                     : ArrayView<pool_ref<heart::Block>>();
+
+                if (top.second < destinations.size())
+                {
+                    auto& next = destinations[top.second++].get();
+
+                    if (visited.insert (std::addressof (next)).second)
+                        visitStack.push_back ({ std::addressof (next), 0 });
+
+                    continue;
+                }
+
+                postorder.push_back (*top.first);
+                visitStack.pop_back();
+            }
+
+            if (postorder.size() != f.blocks.size())
+                return false;
+
+            order.assign (postorder.rbegin(), postorder.rend());
+
+            for (size_t i = 0; i < order.size(); ++i)
+                indexOf[order[i].getPointer()] = i;
+
+            auto numBlocks = order.size();
+            auto undefined = numBlocks;
+            immediateDominator.assign (numBlocks, undefined);
+            immediateDominator[0] = 0;
+
+            auto intersect = [this] (size_t a, size_t b)
+            {
+                while (a != b)
+                {
+                    while (a > b)  a = immediateDominator[a];
+                    while (b > a)  b = immediateDominator[b];
+                }
+
+                return a;
+            };
+
+            for (bool changed = true; changed;)
+            {
+                changed = false;
+
+                for (size_t i = 1; i < numBlocks; ++i)
+                {
+                    auto newIdom = undefined;
+
+                    for (auto& pred : order[i]->predecessors)
+                    {
+                        auto p = indexOf[pred.getPointer()];
+
+                        if (immediateDominator[p] != undefined)
+                            newIdom = newIdom == undefined ? p : intersect (p, newIdom);
+                    }
+
+                    if (newIdom != undefined && immediateDominator[i] != newIdom)
+                    {
+                        immediateDominator[i] = newIdom;
+                        changed = true;
+                    }
+                }
+            }
+
+            dominanceFrontiers.resize (numBlocks);
+            treeChildren.resize (numBlocks);
+
+            for (size_t i = 0; i < numBlocks; ++i)
+            {
+                if (i != 0)
+                    treeChildren[immediateDominator[i]].push_back (i);
+
+                if (order[i]->predecessors.size() < 2)
+                    continue;
+
+                for (auto& pred : order[i]->predecessors)
+                {
+                    for (auto runner = indexOf[pred.getPointer()]; runner != immediateDominator[i]; runner = immediateDominator[runner])
+                        if (! contains (dominanceFrontiers[runner], i))
+                            dominanceFrontiers[runner].push_back (i);
+                }
+            }
+
+            return true;
+        }
+    };
+
+    //==============================================================================
+    /** Returns the groups of blocks that form cycles in the function's control-flow
+        graph, using an iterative version of Tarjan's SCC algorithm.
+    */
+    static std::vector<std::vector<heart::Block*>> findLoopBlockGroups (heart::Function& f)
+    {
+        struct BlockState
+        {
+            int index = -1, lowLink = 0;
+            bool onStack = false;
+        };
+
+        struct Frame
+        {
+            heart::Block* block;
+            size_t nextSuccessor;
+        };
+
+        std::unordered_map<heart::Block*, BlockState> states;
+        states.reserve (f.blocks.size() * 2);
+        std::vector<heart::Block*> sccStack;
+        std::vector<Frame> visitStack;
+        std::vector<std::vector<heart::Block*>> result;
+        int nextIndex = 0;
+
+        for (auto& rootRef : f.blocks)
+        {
+            auto root = rootRef.getPointer();
+
+            if (states[root].index >= 0)
+                continue;
+
+            visitStack.push_back ({ root, 0 });
+
+            while (! visitStack.empty())
+            {
+                auto b = visitStack.back().block;
+                auto& state = states[b];
+
+                if (state.index < 0)
+                {
+                    state.index = state.lowLink = nextIndex++;
+                    sccStack.push_back (b);
+                    state.onStack = true;
+                }
+
+                bool descended = false;
+
+                if (auto terminator = b->terminator.get())
+                {
+                    auto destinations = terminator->getDestinationBlocks();
+
+                    while (visitStack.back().nextSuccessor < destinations.size())
+                    {
+                        auto succ = destinations[visitStack.back().nextSuccessor++].getPointer();
+                        auto& succState = states[succ];
+
+                        if (succState.index < 0)
+                        {
+                            visitStack.push_back ({ succ, 0 });
+                            descended = true;
+                            break;
+                        }
+
+                        if (succState.onStack)
+                            state.lowLink = std::min (state.lowLink, succState.index);
+                    }
+                }
+
+                if (descended)
+                    continue;
+
+                if (state.lowLink == state.index)
+                {
+                    std::vector<heart::Block*> group;
+
+                    for (;;)
+                    {
+                        auto top = sccStack.back();
+                        sccStack.pop_back();
+                        states[top].onStack = false;
+                        group.push_back (top);
+
+                        if (top == b)
+                            break;
+                    }
+
+                    bool isLoop = group.size() > 1;
+
+                    if (! isLoop)
+                        if (auto terminator = b->terminator.get())
+                            for (auto& d : terminator->getDestinationBlocks())
+                                if (d.getPointer() == b)
+                                    isLoop = true;
+
+                    if (isLoop)
+                        result.push_back (std::move (group));
+                }
+
+                visitStack.pop_back();
+
+                if (! visitStack.empty())
+                {
+                    auto& parentState = states[visitStack.back().block];
+                    parentState.lowLink = std::min (parentState.lowLink, state.lowLink);
+                }
+            }
+        }
+
+        return result;
+    }
+
+    /** True if evaluating this expression inside the given loop must give the same
+        answer on every iteration - i.e. it's built purely from constants, calls to
+        pure functions, and locals that nothing in the loop writes to.
+    */
+    static bool isLoopInvariant (heart::Expression& e, const std::unordered_set<const heart::Variable*>& writtenInLoop)
+    {
+        if (is_type<heart::Constant> (e))
+            return true;
+
+        if (auto v = cast<heart::Variable> (e))
+            return v->isFunctionLocal() && writtenInLoop.find (v.get()) == writtenInLoop.end();
+
+        if (auto c = cast<heart::TypeCast> (e))
+            return isLoopInvariant (c->source, writtenInLoop);
+
+        if (auto u = cast<heart::UnaryOperator> (e))
+            return isLoopInvariant (u->source, writtenInLoop);
+
+        if (auto b = cast<heart::BinaryOperator> (e))
+            return isLoopInvariant (b->lhs, writtenInLoop) && isLoopInvariant (b->rhs, writtenInLoop);
+
+        if (auto call = cast<heart::PureFunctionCall> (e))
+        {
+            if (call->function.mayHaveSideEffects())
+                return false;
+
+            for (auto& arg : call->arguments)
+                if (! isLoopInvariant (arg, writtenInLoop))
+                    return false;
+
+            return true;
+        }
+
+        return false;
+    }
+
+    static bool hoistInvariantsOutOfLoop (const std::vector<heart::Block*>& loopBlocks)
+    {
+        std::unordered_set<const heart::Block*> loopSet (loopBlocks.begin(), loopBlocks.end());
+
+        // The loop's header is the one block inside it that entry edges arrive at -
+        // give up on irreducible multiple-entry loops
+        heart::Block* header = nullptr;
+
+        for (auto b : loopBlocks)
+        {
+            for (auto& pred : b->predecessors)
+            {
+                if (loopSet.find (pred.getPointer()) == loopSet.end())
+                {
+                    if (header != nullptr && header != b)
+                        return false;
+
+                    header = b;
+                }
+            }
+        }
+
+        if (header == nullptr || ! header->parameters.empty())
+            return false;
+
+        // ..and to have somewhere to put the hoisted work, the header needs a unique
+        // external predecessor which falls straight into it
+        heart::Block* preheader = nullptr;
+
+        for (auto& pred : header->predecessors)
+        {
+            auto p = pred.getPointer();
+
+            if (loopSet.find (p) != loopSet.end())
+                continue;
+
+            if (preheader != nullptr)
+                return false;
+
+            preheader = p;
+        }
+
+        if (preheader == nullptr)
+            return false;
+
+        auto entryBranch = cast<heart::Branch> (preheader->terminator);
+
+        if (entryBranch == nullptr || ! entryBranch->targetArgs.empty())
+            return false;
+
+        // Collect every variable that anything inside the loop can write to, including
+        // reference arguments of function calls
+        std::unordered_set<const heart::Variable*> writtenInLoop;
+
+        for (auto b : loopBlocks)
+            for (auto s : b->statements)
+                s->visitExpressions ([&] (pool_ref<heart::Expression>& value, AccessType mode)
+                                     {
+                                         if (mode != AccessType::read)
+                                             if (auto v = value->getRootVariable())
+                                                 writtenInLoop.insert (v.get());
+                                     });
+
+        bool anyHoisted = false;
+
+        // A hoisted assignment removes its target from the written set, which can make
+        // later statements that read it hoistable too, so repeat until settled
+        for (bool changed = true; changed;)
+        {
+            changed = false;
+            LinkedList<heart::Statement>::Iterator previous;
+
+            for (auto i = header->statements.begin(); i != nullptr;)
+            {
+                auto current = *i;
+                ++i;
+                bool shouldHoist = false;
+
+                if (auto assignment = cast<heart::AssignFromValue> (*current))
+                    if (auto target = cast<heart::Variable> (assignment->target))
+                        shouldHoist = target->isFunctionLocal()
+                                        && target->readWriteCount.numWrites == 1
+                                        && isLoopInvariant (assignment->source, writtenInLoop);
+
+                if (shouldHoist)
+                {
+                    auto& assignment = *cast<heart::AssignFromValue> (*current);
+                    header->statements.removeNext (previous);
+                    current->nextObject = nullptr;
+                    preheader->statements.append (*current);
+                    writtenInLoop.erase (cast<heart::Variable> (assignment.target).get());
+                    changed = anyHoisted = true;
+                }
+                else
+                {
+                    previous = LinkedList<heart::Statement>::Iterator (*current);
+                }
+            }
+        }
+
+        return anyHoisted;
+    }
+
+    //==============================================================================
+    /** Turns conditional branches whose condition is a compile-time constant, or whose
+        two destinations have collapsed into the same block, into plain unconditional
+        branches, so that the block elimination passes can fold the dead path away.
+    */
+    static bool simplifyBranches (heart::Function& f, heart::Allocator& allocator)
+    {
+        bool anyChanges = false;
+
+        for (auto b : f.blocks)
+        {
+            if (auto branchIf = cast<heart::BranchIf> (b->terminator))
+            {
+                size_t takenTarget;
+
+                if (! branchIf->isConditional())
+                {
+                    takenTarget = 0;
+                }
+                else
+                {
+                    auto constant = branchIf->condition->getAsConstant();
+
+                    if (! constant.isValid())
+                        continue;
+
+                    takenTarget = constant.getAsBool() ? 0u : 1u;
+                }
+
+                auto& branch = allocator.allocateStatement<heart::Branch> (branchIf->targets[takenTarget]);
+                branch.targetArgs = branchIf->targetArgs[takenTarget];
+                b->terminator = branch;
+                anyChanges = true;
+            }
+        }
+
+        return anyChanges;
+    }
+
+    static bool eliminateEmptyAndUnreachableBlocks (heart::Function& f, heart::Allocator& allocator)
+    {
+        return heart::Utilities::removeBlocks (f, [&] (heart::Block& b) -> bool
+        {
+            if (b.doNotOptimiseAway || f.blocks.front() == b)
+                return false;
+
+            if (b.predecessors.empty())
+                return true;
+
+            if (b.terminator != nullptr && b.terminator->isParameterised())
+                return false;
+
+            // a parameterised block can't be bypassed - its predecessors' branches
+            // carry arguments for it
+            if (! b.parameters.empty())
+                return false;
+
+            if (! b.statements.empty())
+                return false;
+
+            if (b.terminator == nullptr)
+                return false;
+
+            auto destinations = b.terminator->getDestinationBlocks();
+            auto numDestinations = destinations.size();
+
+            if (numDestinations > 1)
+                return false;
+
+            if (numDestinations == 1)
+            {
+                if (b == destinations.front())
+                    return false;
+
+                for (auto pred : b.predecessors)
+                    heart::Utilities::replaceBlockDestination (pred, b, destinations.front());
+
+                return true;
+            }
+
+            if (is_type<heart::ReturnVoid> (b.terminator))
+            {
+                if (heart::Utilities::areAllTerminatorsUnconditional (b.predecessors))
+                {
+                    for (auto pred : b.predecessors)
+                        pred->terminator = allocator.allocateStatement<heart::ReturnVoid>();
+
+                    return true;
+                }
+            }
+
+            return false;
+        });
+    }
+
+    //==============================================================================
+    static bool eliminateUnreachableBlockCycles (heart::Function& f)
+    {
+        return heart::Utilities::removeBlocks (f, [&] (heart::Block& b) -> bool
+        {
+            return f.blocks.front() != b
+                    && ! isReachableFrom (f, b, f.blocks.front());
+        });
+    }
+
+    static bool isReachableFrom (heart::Function& f, heart::Block& dest, heart::Block& source)
+    {
+        bool result = false;
+
+        CallFlowGraph::visitUpstreamBlocks (f, dest,
+            [&] (heart::Block& b) -> bool
+            {
+                if (std::addressof (b) == std::addressof (source)) { result = true; return false; }
+                return true;
+            });
+
+        return result;
+    }
+
+    //==============================================================================
+    static bool mergeAdjacentBlocks (heart::Function& f)
+    {
+        return heart::Utilities::removeBlocks (f, [&] (heart::Block& b) -> bool
+        {
+            if (b.predecessors.size() != 1 || b.doNotOptimiseAway || (! b.parameters.empty()))
+                return false;
+
+            auto pred = b.predecessors.front();
+
+            if (pred == b || pred->terminator->isConditional())
+                return false;
+
+            SOUL_ASSERT (*pred->terminator->getDestinationBlocks().begin() == b);
+
+            if (auto first = b.statements.begin())
+                if (*first != nullptr)
+                    pred->statements.append (**first);
+
+            pred->terminator = b.terminator;
+            return true;
+        });
+    }
+
+    //==============================================================================
+    static void recursivelyFlagFunctionUse (heart::Function& sourceFn)
+    {
+        if (! sourceFn.functionUseTestFlag)
+        {
+            sourceFn.functionUseTestFlag = true;
+
+            sourceFn.visitStatements<heart::FunctionCall> ([] (heart::FunctionCall& fc)
+            {
+                recursivelyFlagFunctionUse (fc.getFunction());
+            });
+
+            sourceFn.visitExpressions ([] (pool_ref<heart::Expression>& value, AccessType)
+            {
+                if (auto fc = cast<heart::PureFunctionCall> (value))
+                    recursivelyFlagFunctionUse (fc->function);
+            });
+        }
+    }
+
+    static void removeCallsToVoidFunctionsWithoutSideEffects (Program& program)
+    {
+        for (auto& m : program.getModules())
+            for (auto& f : m->functions)
+                for (auto& b : f->blocks)
+                    b->statements.removeMatches ([] (heart::Statement& s)
+                                                 {
+                                                     if (auto call = cast<heart::FunctionCall> (s))
+                                                         return call->target == nullptr && ! call->getFunction().mayHaveSideEffects();
+
+                                                     return false;
+                                                 });
+    }
+
+    static void recursivelyFlagStructUse (const Type& type)
+    {
+        if (type.isStruct())
+        {
+            if (! type.getStructRef().activeUseFlag)
+            {
+                type.getStructRef().activeUseFlag = true;
+
+                for (auto& m : type.getStructRef().getMembers())
+                    recursivelyFlagStructUse (m.type);
+            }
+        }
+        else if (type.isArray())
+        {
+            recursivelyFlagStructUse (type.getArrayElementType());
+        }
+    }
+
+    //==============================================================================
+    static bool findAndReplaceFirstDuplicateConstant (heart::Function& f)
+    {
+        for (auto b : f.blocks)
+        {
+            LinkedList<heart::Statement>::Iterator last;
+
+            for (auto s : b->statements)
+            {
+                if (auto a = cast<heart::AssignFromValue> (*s))
+                {
+                    if (auto target = cast<heart::Variable> (a->target))
+                    {
+                        if (target->isConstant())
+                        {
+                            if (auto source = cast<heart::Variable> (a->source))
+                            {
+                                if (source->isConstant())
+                                {
+                                    b->statements.removeNext (last);
+
+                                    f.visitExpressions ([target, source] (pool_ref<heart::Expression>& value, AccessType mode)
+                                    {
+                                        if (value == target && mode == AccessType::read)
+                                            value = *source;
+                                    });
+
+                                    return true;
+                                }
+                            }
+                        }
+                    }
+                }
+
+                last = *s;
+            }
+        }
+
+        return false;
+    }
+
+    static void removeDuplicateConstants (heart::Function& f)
+    {
+        while (findAndReplaceFirstDuplicateConstant (f))
+        {}
+    }
+
+    static void removeUnusedVariables (heart::Function& f)
+    {
+        for (auto b : f.blocks)
+        {
+            b->statements.removeMatches ([] (heart::Statement& s)
+            {
+                if (auto a = cast<heart::Assignment> (s))
+                    if (auto target = cast<heart::Variable> (a->target))
+                        return target->readWriteCount.numReads == 0 && target->isFunctionLocal();
+
+                // a partial write to a local which is never read is just as dead as a
+                // whole-variable store, and mustn't be the only store left behind: a
+                // sub-element write can't act as the variable's first declaration
+                if (auto a = cast<heart::AssignFromValue> (s))
+                    if (auto root = a->target->getRootVariable())
+                        return root->readWriteCount.numReads == 0
+                                && root->isFunctionLocal()
+                                && ! root->type.isReference();
+
+                return false;
+            });
+        }
+    }
+
+    static void convertWriteOnceVariablesToConstants (heart::Function& f)
+    {
+        f.visitStatements<heart::Assignment> ([] (heart::Assignment& a)
+        {
+            if (auto target = cast<heart::Variable> (a.target))
+                if (target->readWriteCount.numWrites == 1 && target->isMutableLocal())
+                    target->role = heart::Variable::Role::constant;
+        });
+    }
+
+    struct Inliner
+    {
+        Inliner (Module& m, heart::Function& parentFn, size_t block,
+                 heart::FunctionCall& fc, heart::Function& targetFn)
+            : module (m), parentFunction (parentFn), call (fc), blockIndex (block), targetFunction (targetFn)
+        {
+            inlinedFnName = addSuffixToMakeUnique ("_inlined_" + targetFunction.name.toString(),
+                                                   [&] (const std::string& nm)
+                                                   {
+                                                       return heart::Utilities::findBlock (parentFn, "@" + nm) != nullptr;
+                                                   });
+        }
+
+        void perform()
+        {
+            StringBuilderWithPreallocation<> endBlockName ("@");
+            endBlockName.append (inlinedFnName).append ("_end");
+
+            auto& postBlock = heart::Utilities::splitBlock (module, parentFunction, blockIndex, call, endBlockName);
+            postCallResumeBlock = postBlock;
+            auto& preBlock = parentFunction.blocks[blockIndex].get();
+
+            preBlock.statements.remove (call);
+
+            if (! targetFunction.returnType.isVoid())
+            {
+                StringBuilderWithPreallocation<> retvalName (inlinedFnName);
+                retvalName.append ("_retval");
+
+                returnValueVar = BlockBuilder::createVariable (module, targetFunction.returnType,
+                                                               module.allocator.get (retvalName.view()),
+                                                               heart::Variable::Role::mutableLocal);
+
+                postBlock.statements.insertFront (module.allocateStatement<heart::AssignFromValue> (call.location, *call.target, *returnValueVar));
+            }
+
+            {
+                BlockBuilder builder (module, preBlock);
+
+                for (size_t i = 0; i < targetFunction.parameters.size(); ++i)
+                {
+                    auto& param = targetFunction.parameters[i].get();
+
+                    // a reference parameter must alias the caller's lvalue rather than
+                    // copying it, so the inlined body uses the argument directly
+                    if (param.type.isReference())
+                    {
+                        aliasedParams[param] = call.arguments[i];
+                        continue;
+                    }
+
+                    StringBuilderWithPreallocation<> newParamName (inlinedFnName);
+                    newParamName.append ("_param_").appendSafeIdentifierName (param.name.toString());
+
+                    auto& localParamVar = builder.createVariable (param.type, newParamName.view(), heart::Variable::Role::mutableLocal);
+                    builder.addAssignment (localParamVar, call.arguments[i]);
+                    remappedVariables[param] = localParamVar;
+                }
+            }
+
+            newBlocks.reserve (targetFunction.blocks.size());
+
+            for (auto& b : targetFunction.blocks)
+            {
+                // NB: the name of the first block must be "@" + inlinedFnName, since that's what the unique
+                // name picker will look for to make sure there's not a block name clash
+                StringBuilderWithPreallocation<> name ("@");
+                name.append (inlinedFnName);
+
+                if (! newBlocks.empty())
+                    name.append ('_').append (static_cast<int64_t> (newBlocks.size()));
+
+                auto& newBlock = module.allocate<heart::Block> (module.allocator.get (name.view()));
+                newBlocks.push_back (newBlock);
+                remappedBlocks[b] = newBlock;
+            }
+
+            parentFunction.blocks.insert (getIteratorForIndex (parentFunction.blocks, blockIndex + 1),
+                                          newBlocks.begin(), newBlocks.end());
+
+            preBlock.terminator = module.allocateStatement<heart::Branch> (newBlocks.front());
+
+            for (size_t i = 0; i < newBlocks.size(); ++i)
+                cloneBlock (newBlocks[i], targetFunction.blocks[i]);
+        }
+
+        void cloneBlock (heart::Block& target, const heart::Block& source)
+        {
+            for (auto& p : source.parameters)
+                target.parameters.push_back (getRemappedVariable (p));
+
+            LinkedList<heart::Statement>::Iterator last;
+
+            for (auto s : source.statements)
+                last = target.statements.insertAfter (last, cloneStatement (*s));
+
+            if (auto returnValue = cast<heart::ReturnValue> (source.terminator))
+                target.statements.insertAfter (last, module.allocateStatement<heart::AssignFromValue> (source.location, *returnValueVar,
+                                                                                              cloneExpression (returnValue->returnValue)));
+
+            target.terminator = cloneTerminator (*source.terminator);
+        }
+
+        heart::Statement& cloneStatement (heart::Statement& s)
+        {
+            #define SOUL_CLONE_STATEMENT(Type)     if (auto t = cast<const heart::Type> (s)) return clone (*t);
+            SOUL_HEART_STATEMENTS (SOUL_CLONE_STATEMENT)
+            #undef SOUL_CLONE_STATEMENT
+            SOUL_ASSERT_FALSE;
+            return s;
+        }
+
+        heart::Terminator& cloneTerminator (heart::Terminator& s)
+        {
+            #define SOUL_CLONE_TERMINATOR(Type)    if (auto t = cast<const heart::Type> (s)) return clone (*t);
+            SOUL_HEART_TERMINATORS (SOUL_CLONE_TERMINATOR)
+            #undef SOUL_CLONE_TERMINATOR
+            SOUL_ASSERT_FALSE;
+            return s;
+        }
+
+        heart::Branch& clone (const heart::Branch& old)
+        {
+            auto& b = module.allocateStatement<heart::Branch> (*remappedBlocks[old.target]);
+
+            for (auto& arg : old.targetArgs)
+                b.targetArgs.push_back (cloneExpression (arg));
+
+            return b;
+        }
+
+        heart::BranchIf& clone (const heart::BranchIf& old)
+        {
+            auto& b = module.allocateStatement<heart::BranchIf> (cloneExpression (old.condition),
+                                                        *remappedBlocks[old.targets[0]],
+                                                        *remappedBlocks[old.targets[1]]);
+            b.likelihood = old.likelihood;
+
+            for (auto& arg : old.targetArgs[0])
+                b.targetArgs[0].push_back (cloneExpression (arg));
+
+            for (auto& arg : old.targetArgs[1])
+                b.targetArgs[1].push_back (cloneExpression (arg));
+
+            return b;
+        }
+
+        heart::Terminator& clone (const heart::ReturnVoid&)    { return module.allocateStatement<heart::Branch> (*postCallResumeBlock); }
+        heart::Terminator& clone (const heart::ReturnValue&)   { return module.allocateStatement<heart::Branch> (*postCallResumeBlock); }
+
+        heart::AssignFromValue& clone (const heart::AssignFromValue& old)
+        {
+            return module.allocateStatement<heart::AssignFromValue> (old.location,
+                                                            cloneExpression (*old.target),
+                                                            cloneExpression (old.source));
+        }
+
+        heart::FunctionCall& clone (const heart::FunctionCall& old)
+        {
+            auto& fc = module.allocateStatement<heart::FunctionCall> (old.location, cloneExpressionPtr (old.target), old.getFunction());
+
+            for (auto& arg : old.arguments)
+                fc.arguments.push_back (cloneExpression (arg));
+
+            return fc;
+        }
+
+        heart::PureFunctionCall& clone (const heart::PureFunctionCall& old)
+        {
+            auto& fc = module.allocate<heart::PureFunctionCall> (old.location, old.function);
+
+            for (auto& arg : old.arguments)
+                fc.arguments.push_back (cloneExpression (arg));
+
+            return fc;
+        }
+
+        heart::ReadStream& clone (const heart::ReadStream& old)
+        {
+            return module.allocateStatement<heart::ReadStream> (old.location, cloneExpression (*old.target), old.source);
+        }
+
+        heart::WriteStream& clone (const heart::WriteStream& old)
+        {
+            return module.allocateStatement<heart::WriteStream> (old.location, old.target,
+                                                        cloneExpressionPtr (old.element),
+                                                        cloneExpression (old.value));
+        }
+
+        heart::AdvanceClock& clone (const heart::AdvanceClock& a)
+        {
+            return module.allocateStatement<heart::AdvanceClock> (a.location);
+        }
+
+        heart::Expression& cloneExpression (heart::Expression& old)
+        {
+            if (auto c = cast<heart::Constant> (old))
+                return module.allocate<heart::Constant> (c->location, c->value);
+
+            if (auto b = cast<heart::BinaryOperator> (old))
+                return module.allocate<heart::BinaryOperator> (b->location,
+                                                               cloneExpression (b->lhs),
+                                                               cloneExpression (b->rhs),
+                                                               b->operation);
+
+            if (auto u = cast<heart::UnaryOperator> (old))
+                return module.allocate<heart::UnaryOperator> (u->location, cloneExpression (u->source), u->operation);
+
+            if (auto t = cast<heart::TypeCast> (old))
+                return module.allocate<heart::TypeCast> (t->location, cloneExpression (t->source), t->destType);
+
+            if (auto f = cast<heart::PureFunctionCall> (old))
+                return clone (*f);
+
+            if (auto v = cast<heart::Variable> (old))
+            {
+                if (auto alias = aliasedParams.find (*v); alias != aliasedParams.end())
+                    return *alias->second;
+
+                return getRemappedVariable (*v);
+            }
+
+            if (auto s = cast<heart::ArrayElement> (old))
+                return cloneArrayElement (*s);
+
+            if (auto s = cast<heart::StructElement> (old))
+                return cloneStructElement (*s);
+
+            auto pp = cast<heart::ProcessorProperty> (old);
+            return module.allocate<heart::ProcessorProperty> (pp->location, pp->property);
+        }
+
+        pool_ptr<heart::Expression> cloneExpressionPtr (pool_ptr<heart::Expression> old)
+        {
+            if (old != nullptr)
+                return cloneExpression (*old);
+
+            return {};
+        }
+
+        heart::Variable& getRemappedVariable (heart::Variable& old)
+        {
+            if (old.isFunctionLocal() || old.isParameter())
+            {
+                auto& v = remappedVariables[old];
+
+                if (v == nullptr)
+                {
+                    auto getNewName = [this, &old]() -> Identifier
+                    {
+                        StringBuilderWithPreallocation<> newName (inlinedFnName);
+                        newName.append ('_').appendSafeIdentifierName (old.name.toString());
+                        return module.allocator.get (newName.view());
+                    };
+
+                    v = module.allocate<heart::Variable> (old.location, old.type,
+                                                          old.name.isValid() ? getNewName() : Identifier(),
+                                                          old.role);
+                    v->annotation = old.annotation;
+                }
+
+                return *v;
+            }
+
+            return old;
+        }
+
+        heart::ArrayElement& cloneArrayElement (const heart::ArrayElement& old)
+        {
+            auto& s = module.allocate<heart::ArrayElement> (old.location,
+                                                            cloneExpression (old.parent),
+                                                            old.fixedStartIndex,
+                                                            old.fixedEndIndex);
+
+            s.dynamicIndex = cloneExpressionPtr (old.dynamicIndex);
+            s.suppressWrapWarning = old.suppressWrapWarning;
+            s.isRangeTrusted = old.isRangeTrusted;
+            return s;
+        }
+
+        heart::StructElement& cloneStructElement (const heart::StructElement& old)
+        {
+            return module.allocate<heart::StructElement> (old.location,
+                                                          cloneExpression (old.parent),
+                                                          old.memberName);
+        }
+
+        Module& module;
+        heart::Function& parentFunction;
+        heart::FunctionCall& call;
+        size_t blockIndex;
+        heart::Function& targetFunction;
+        std::string inlinedFnName;
+        std::vector<pool_ref<heart::Block>> newBlocks;
+        std::unordered_map<pool_ref<heart::Block>, pool_ptr<heart::Block>> remappedBlocks;
+        std::unordered_map<pool_ref<heart::Variable>, pool_ptr<heart::Variable>> remappedVariables;
+        std::unordered_map<pool_ref<heart::Variable>, pool_ptr<heart::Expression>> aliasedParams;
+        pool_ptr<heart::Block> postCallResumeBlock;
+        pool_ptr<heart::Variable> returnValueVar;
+    };
+
+    enum class InlineResult { ok, failed, noneFound };
+
+    static InlineResult inlineNextCall (Program& program, heart::Function& parentFunction, heart::Function& functionToInline)
+    {
+        for (size_t blockIndex = 0; blockIndex < parentFunction.blocks.size(); ++blockIndex)
+        {
+            for (auto s : parentFunction.blocks[blockIndex]->statements)
+            {
+                if (auto call = cast<heart::FunctionCall> (*s))
+                {
+                    if (call->function == functionToInline)
+                    {
+                        if (! heart::Utilities::canFunctionBeInlined (program, parentFunction, *call))
+                            return InlineResult::failed;
+
+                        makeFunctionCallInline (program, parentFunction, blockIndex, *call);
+                        return InlineResult::ok;
+                    }
+                }
+            }
+        }
+
+        return InlineResult::noneFound;
+    }
+
+    static InlineResult inlineAllCallsToFunction (Program& program, heart::Function& parentFunction, heart::Function& functionToInline)
+    {
+        if (functionToInline.isExported || ! functionToInline.functionType.isNormal())
+            return InlineResult::failed;
+
+        bool anyChanged = false;
+
+        for (;;)
+        {
+            auto result = inlineNextCall (program, parentFunction, functionToInline);
+
+            if (result == InlineResult::failed)
+                return result;
+
+            if (result == InlineResult::noneFound)
+                return anyChanged ? InlineResult::ok
+                                  : InlineResult::noneFound;
+
+            anyChanged = true;
+        }
+    }
+
+    //==============================================================================
+    /** Rebuilds every float64 transcendental intrinsic so that it casts down to
+        float32, calls the float32 intrinsic, and casts the result back.
+
+        This is intended for embedded targets with no 64-bit FPU, where a patch
+        (or the library code it pulls in) calling the float64 overloads would
+        otherwise drop into software emulation. Because the redirection happens
+        in the intrinsic's own body, every call site is narrowed without being
+        touched, and a backend which maps intrinsics to native code sees a plain
+        float32 intrinsic call.
+    */
+    static void narrowFloat64Intrinsics (Program& program)
+    {
+        for (auto& m : program.getModules())
+        {
+            // iterate a copy, as creating float32 counterparts appends to the list
+            auto functions = m->functions;
+
+            for (auto f : functions)
+                if (isNarrowableTranscendental (f->intrinsicType) && isFloat64OnlyFunction (f))
+                    redirectToFloat32Intrinsic (m, f);
+        }
+    }
+
+    static bool isNarrowableTranscendental (IntrinsicType t)
+    {
+        return getIntrinsicLoweringInfo (t).isTranscendental;
+    }
+
+    static bool isFloat64OnlyFunction (const heart::Function& f)
+    {
+        if (! (f.functionType.isIntrinsic() && f.returnType.isPrimitive() && f.returnType.isFloat64()))
+            return false;
+
+        for (auto& param : f.parameters)
+            if (! (param->getType().isPrimitive() && param->getType().isFloat64()))
+                return false;
+
+        return ! f.parameters.empty();
+    }
+
+    static void redirectToFloat32Intrinsic (Module& m, heart::Function& f)
+    {
+        auto& counterpart = getOrCreateFloat32Intrinsic (m, f);
+
+        f.blocks.clear();
+        f.hasNoBody = true;
+
+        // The function must stop being an intrinsic, or a backend which maps
+        // intrinsics to native code would bypass the redirecting body
+        f.intrinsicType = IntrinsicType::none;
+        f.functionType = heart::FunctionType::normal();
+
+        FunctionBuilder::populateFunctionBody (m, f, [&] (FunctionBuilder& builder)
+        {
+            heart::FunctionCall::ArgListType args;
+
+            for (auto& param : f.parameters)
+                args.push_back (builder.createRegisterVariable (builder.createCast ({}, param.get(), PrimitiveType::float32)));
+
+            auto& result = builder.createRegisterVariable (Type (PrimitiveType::float32));
+            builder.addFunctionCall (result, counterpart, std::move (args));
+            builder.addReturn (builder.createCast ({}, result, PrimitiveType::float64));
+        });
+    }
+
+    static heart::Function& getOrCreateFloat32Intrinsic (Module& m, const heart::Function& original)
+    {
+        for (auto f : m.functions)
+            if (f->intrinsicType == original.intrinsicType
+                 && f->functionType.isIntrinsic()
+                 && f->returnType.isPrimitive() && f->returnType.isFloat32())
+                return f;
+
+        // The float32 specialisation was never instantiated by the program, so
+        // declare it here - intrinsics are mapped by their type rather than by
+        // their body, so a bodyless declaration is all that's needed
+        auto& fn = m.allocate<heart::Function>();
+        fn.name = m.allocator.get (original.name.toString() + "_f32");
+        fn.returnType = PrimitiveType::float32;
+        fn.functionType = heart::FunctionType::intrinsic();
+        fn.intrinsicType = original.intrinsicType;
+        fn.hasNoBody = true;
+
+        for (size_t i = 0; i < original.parameters.size(); ++i)
+            fn.parameters.push_back (BlockBuilder::createVariable (m, PrimitiveType::float32,
+                                                                   "v" + std::to_string (i),
+                                                                   heart::Variable::Role::parameter));
+
+        m.functions.push_back (fn);
+        return fn;
+    }
+
+    //==============================================================================
+    /** Transposes fixed-size arrays-of-structs in processor state into
+        structs-of-arrays, rewriting the accesses to match.
+
+        A state array like `FilterState[32] voices` is laid out with each voice's
+        members interleaved, so a loop over the voices touching one member strides
+        through memory and defeats vectorisation. This pass turns the array into a
+        struct whose members are per-field arrays, so `voices[i].gain` becomes
+        `voices.gain[i]` and a per-voice loop reads one contiguous lane per field.
+
+        A variable is only transposed when its element struct contains nothing but
+        primitives and vectors, and every use of it is a single-element member
+        access - whole-struct copies, slices or passing the array around leave the
+        layout untouched. This changes the state's memory layout, which is why
+        it's opt-in rather than part of the normal optimisation pipeline.
+    */
+    static void convertStateArraysToStructureOfArrays (Program& program)
+    {
+        for (auto& m : program.getModules())
+        {
+            if (! m->isProcessor())
+                continue;
+
+            for (auto& v : m->stateVariables)
+            {
+                if (! isStructureOfArraysCandidate (v))
+                    continue;
+
+                if (areAllUsesTransposable (m, v))
+                {
+                    transposeStateArray (m, v);
+
+                    if (areOptimisationRemarksEnabled())
+                        emitOptimisationRemark (v->location,
+                                                "state array '" + v->name.toString() + "' transposed to a vectorisable structure-of-arrays layout");
+                }
+                else if (areOptimisationRemarksEnabled())
+                {
+                    emitOptimisationRemark (v->location,
+                                            "state array '" + v->name.toString() + "' kept in array-of-structures layout: "
+                                              "it's used somewhere as a whole struct or array rather than one member per element");
+                }
+            }
+        }
+    }
+
+    static bool isStructureOfArraysCandidate (heart::Variable& v)
+    {
+        if (v.role != heart::Variable::Role::state || v.initialValue != nullptr)
+            return false;
+
+        const auto& type = v.getType();
+
+        if (! (type.isFixedSizeArray() && type.getElementType().isStruct()))
+            return false;
+
+        for (auto& member : type.getElementType().getStructRef().getMembers())
+            if (! (member.type.isPrimitive() || member.type.isVector()))
+                return false;
+
+        return true;
+    }
+
+    static bool isTransposableAccess (heart::Expression& e, const heart::Variable& v)
+    {
+        if (auto se = cast<heart::StructElement> (e))
+            if (auto ae = cast<heart::ArrayElement> (se->parent))
+                return ae->parent.getPointer() == std::addressof (v) && ae->isSingleElement();
+
+        return false;
+    }
+
+    static bool areAllUsesTransposable (Module& m, heart::Variable& v)
+    {
+        // Each transposable use sights the variable exactly once (as the parent of
+        // its array access), so any extra sighting means the whole array or one of
+        // its elements is being used directly somewhere
+        size_t sightings = 0, transposableUses = 0;
+
+        for (auto& f : m.functions)
+            f->visitExpressions ([&] (pool_ref<heart::Expression>& e, AccessType)
+            {
+                if (e.getPointer() == std::addressof (v))
+                    ++sightings;
+                else if (isTransposableAccess (e, v))
+                    ++transposableUses;
+            });
+
+        for (auto& sv : m.stateVariables)
+            if (sv != v && sv->initialValue != nullptr && sv->initialValue->readsVariable (v))
+                return false;
+
+        return sightings > 0 && sightings == transposableUses;
+    }
+
+    static void transposeStateArray (Module& m, heart::Variable& v)
+    {
+        const auto& arrayType = v.getType();
+        auto numElements = arrayType.getArraySize();
+        auto& oldStruct = arrayType.getElementType().getStructRef();
+
+        auto soaName = addSuffixToMakeUnique (oldStruct.getName() + "_soa",
+                                              [&] (const std::string& nm) { return m.findStruct (nm) != nullptr; });
+        auto& soaStruct = m.addStruct (soaName);
+
+        for (auto& member : oldStruct.getMembers())
+            soaStruct.addMember (member.type.createArray (numElements), member.name);
+
+        v.type = Type::createStruct (soaStruct);
+
+        for (auto& f : m.functions)
+            f->visitExpressions ([&] (pool_ref<heart::Expression>& e, AccessType)
+            {
+                auto se = cast<heart::StructElement> (e);
+
+                if (se == nullptr)
+                    return;
+
+                auto ae = cast<heart::ArrayElement> (se->parent);
+
+                if (ae == nullptr || ae->parent.getPointer() != std::addressof (v))
+                    return;
 
-                                             if (type.isStringLiteral())
-                                             {
-                                                 auto handle = c->value.getStringLiteral();
+                auto& memberLane = m.allocate<heart::StructElement> (se->location, v, se->memberName);
 
-                                                 if (! contains (handlesUsed, handle))
-                                                     handlesUsed.push_back (handle);
-                                             }
-                                         }
-                                     });
+                if (ae->isDynamic())
+                {
+                    auto& element = m.allocate<heart::ArrayElement> (ae->location, memberLane, *ae->dynamicIndex);
+                    element.isRangeTrusted = ae->isRangeTrusted;
+                    element.suppressWrapWarning = ae->suppressWrapWarning;
+                    e = element;
+                }
+                else
+                {
+                    e = m.allocate<heart::ArrayElement> (ae->location, memberLane, ae->fixedStartIndex);
+                }
+            });
+    }
+
+    //==============================================================================
+    static bool fuseFirstFusableConnection (Program& program)
+    {
+        auto modules = program.getModules();
+
+        for (auto& m : modules)
+            if (m->isGraph())
+                for (auto& c : m->connections)
+                    if (tryToFuseConnection (program, m, c))
+                        return true;
 
-        removeIf (program.getStringDictionary().strings,
-                  [&] (const StringDictionary::Item& item) { return ! contains (handlesUsed, item.handle); });
+        return false;
     }
 
+    /** The shape of run() function that the fusion pass knows how to weave: a
+        straight line of init blocks falling into a single self-looping block
+        whose final statement is the function's only advance. Only the loop block
+        can carry parameters, as every other block on the chain has a single
+        predecessor.
+    */
+    struct FusableRunShape
+    {
+        pool_ptr<heart::Function> run;
+        std::vector<pool_ref<heart::Block>> initBlocks;
+        pool_ptr<heart::Block> loopBlock;
+    };
 
-private:
-    static bool eliminateEmptyAndUnreachableBlocks (heart::Function& f, heart::Allocator& allocator)
+    static bool analyseFusableRunShape (heart::Function& f, FusableRunShape& result)
     {
-        return heart::Utilities::removeBlocks (f, [&] (heart::Block& b) -> bool
-        {
-            if (b.doNotOptimiseAway || f.blocks.front() == b)
-                return false;
+        if (f.blocks.empty())
+            return false;
 
-            if (b.predecessors.empty())
-                return true;
+        std::vector<pool_ref<heart::Block>> chain;
+        pool_ptr<heart::Block> current (f.blocks.front());
+        size_t loopStart = 0;
 
-            if (b.terminator != nullptr && b.terminator->isParameterised())
-                return false;
+        for (;;)
+        {
+            bool closedLoop = false;
 
-            if (! b.statements.empty())
-                return false;
+            for (size_t i = 0; i < chain.size(); ++i)
+            {
+                if (chain[i].getPointer() == current.get())
+                {
+                    loopStart = i;
+                    closedLoop = true;
+                    break;
+                }
+            }
 
-            if (b.terminator == nullptr)
-                return false;
+            if (closedLoop)
+                break;
 
-            auto destinations = b.terminator->getDestinationBlocks();
-            auto numDestinations = destinations.size();
+            // anything conditional, or a return, means this isn't a plain endless loop
+            auto branch = cast<heart::Branch> (current->terminator);
 
-            if (numDestinations > 1)
+            if (branch == nullptr)
                 return false;
 
-            if (numDestinations == 1)
-            {
-                if (b == destinations.front())
-                    return false;
+            chain.push_back (*current);
+            current = branch->target;
+        }
 
-                for (auto pred : b.predecessors)
-                    heart::Utilities::replaceBlockDestination (pred, b, destinations.front());
+        // the whole function must lie on the chain, and the loop must have been
+        // merged down to the single final block branching back to itself
+        if (chain.size() != f.blocks.size() || loopStart != chain.size() - 1)
+            return false;
 
-                return true;
-            }
+        for (size_t i = 0; i + 1 < chain.size(); ++i)
+            if (! chain[i]->parameters.empty())
+                return false;
 
-            if (is_type<heart::ReturnVoid> (b.terminator))
-            {
-                if (heart::Utilities::areAllTerminatorsUnconditional (b.predecessors))
-                {
-                    for (auto pred : b.predecessors)
-                        pred->terminator = allocator.allocate<heart::ReturnVoid>();
+        auto& loopBlock = chain.back().get();
 
-                    return true;
-                }
-            }
+        size_t numAdvances = 0;
+        f.visitStatements<heart::AdvanceClock> ([&] (heart::AdvanceClock&) { ++numAdvances; });
+
+        auto lastStatement = loopBlock.statements.getLast();
 
+        if (numAdvances != 1 || lastStatement == nullptr || ! is_type<heart::AdvanceClock> (**lastStatement))
             return false;
-        });
+
+        result.run = f;
+        result.loopBlock = loopBlock;
+        result.initBlocks.assign (chain.begin(), chain.end() - 1);
+        return true;
     }
 
-    //==============================================================================
-    static bool eliminateUnreachableBlockCycles (heart::Function& f)
+    /** Returns the module's only write to the given output, as long as it's a
+        whole-value write sitting inside the canonical run loop.
+    */
+    static pool_ptr<heart::WriteStream> findSingleWriteToOutput (Module& m, const FusableRunShape& shape,
+                                                                 const heart::OutputDeclaration& output)
     {
-        return heart::Utilities::removeBlocks (f, [&] (heart::Block& b) -> bool
-        {
-            return f.blocks.front() != b
-                    && ! isReachableFrom (f, b, f.blocks.front());
-        });
+        size_t totalWrites = 0;
+
+        for (auto& f : m.functions)
+            f->visitStatements<heart::WriteStream> ([&] (heart::WriteStream& w)
+                                                    {
+                                                        if (w.target == output)
+                                                            ++totalWrites;
+                                                    });
+
+        if (totalWrites != 1)
+            return {};
+
+        for (auto s : shape.loopBlock->statements)
+            if (auto w = cast<heart::WriteStream> (*s))
+                if (w->target == output && w->element == nullptr)
+                    return w;
+
+        return {};
     }
 
-    static bool isReachableFrom (heart::Function& f, heart::Block& dest, heart::Block& source)
+    /** Returns the module's only read from the given input, as long as it's a
+        whole-value read sitting inside the canonical run loop.
+    */
+    static pool_ptr<heart::ReadStream> findSingleReadFromInput (Module& m, const FusableRunShape& shape,
+                                                                const heart::InputDeclaration& input)
     {
-        bool result = false;
+        size_t totalReads = 0;
 
-        CallFlowGraph::visitUpstreamBlocks (f, dest,
-            [&] (heart::Block& b) -> bool
-            {
-                if (std::addressof (b) == std::addressof (source)) { result = true; return false; }
-                return true;
-            });
+        for (auto& f : m.functions)
+            f->visitStatements<heart::ReadStream> ([&] (heart::ReadStream& r)
+                                                   {
+                                                       if (r.source == input)
+                                                           ++totalReads;
+                                                   });
 
-        return result;
+        if (totalReads != 1)
+            return {};
+
+        for (auto s : shape.loopBlock->statements)
+            if (auto r = cast<heart::ReadStream> (*s))
+                if (r->source == input && r->element == nullptr)
+                    return r;
+
+        return {};
     }
 
-    //==============================================================================
-    static bool mergeAdjacentBlocks (heart::Function& f)
+    /** Checks for the clashes between two modules' contents which renaming can't
+        resolve: struct declarations can't be renamed once allocated, and an event
+        endpoint's name is welded to the names of its handler functions.
+        (Types that the two processors share via a namespace live in that
+        namespace's module, so they never clash here.)
+    */
+    static bool canMergeModuleContents (Module& sourceModule, Module& destModule,
+                                        const heart::OutputDeclaration& fusedOutput,
+                                        const heart::InputDeclaration& fusedInput)
     {
-        return heart::Utilities::removeBlocks (f, [&] (heart::Block& b) -> bool
-        {
-            if (b.predecessors.size() != 1 || b.doNotOptimiseAway || (! b.parameters.empty()))
+        for (auto& s : sourceModule.structs)
+            if (destModule.findStruct (s->getName()) != nullptr)
                 return false;
 
-            auto pred = b.predecessors.front();
-
-            if (pred == b || pred->terminator->isConditional())
+        for (auto& f : sourceModule.functions)
+            if (f->functionType.isEvent() && destModule.findFunction (f->name.toString()) != nullptr)
                 return false;
 
-            SOUL_ASSERT (*pred->terminator->getDestinationBlocks().begin() == b);
+        auto hasUnresolvableClash = [&] (const heart::IODeclaration& e)
+        {
+            auto name = e.name.toString();
 
-            if (auto first = b.statements.begin())
-                if (*first != nullptr)
-                    pred->statements.append (**first);
+            for (auto& io : destModule.inputs)
+                if (io != fusedInput && io->name.toString() == name)
+                    return e.isEventEndpoint() || io->isEventEndpoint();
 
-            pred->terminator = b.terminator;
-            return true;
-        });
+            for (auto& io : destModule.outputs)
+                if (io->name.toString() == name)
+                    return e.isEventEndpoint() || io->isEventEndpoint();
+
+            return false;
+        };
+
+        for (auto& io : sourceModule.inputs)
+            if (hasUnresolvableClash (io))
+                return false;
+
+        for (auto& io : sourceModule.outputs)
+            if (io != fusedOutput && hasUnresolvableClash (io))
+                return false;
+
+        return true;
     }
 
-    //==============================================================================
-    static void recursivelyFlagFunctionUse (heart::Function& sourceFn)
+    static bool tryToFuseConnection (Program& program, Module& graph, heart::Connection& connection,
+                                     const char** blockerReason = nullptr)
     {
-        if (! sourceFn.functionUseTestFlag)
+        auto blocked = [=] (const char* reason)
         {
-            sourceFn.functionUseTestFlag = true;
+            if (blockerReason != nullptr)
+                *blockerReason = reason;
 
-            sourceFn.visitStatements<heart::FunctionCall> ([] (heart::FunctionCall& fc)
-            {
-                recursivelyFlagFunctionUse (fc.getFunction());
-            });
+            return false;
+        };
 
-            sourceFn.visitExpressions ([] (pool_ref<heart::Expression>& value, AccessType)
-            {
-                if (auto fc = cast<heart::PureFunctionCall> (value))
-                    recursivelyFlagFunctionUse (fc->function);
-            });
+        if (connection.delayLength != 0 || connection.interpolationType != InterpolationType::none)
+            return blocked ("the connection has a delay or interpolation stage");
+
+        auto sourceInstance = connection.source.processor;
+        auto destInstance   = connection.dest.processor;
+
+        if (sourceInstance == nullptr || destInstance == nullptr)
+            return blocked ("one end is the graph's own endpoint");
+
+        if (sourceInstance == destInstance)
+            return blocked ("it would form a zero-delay loop on a single instance");
+
+        if (connection.source.endpointIndex.has_value() || connection.dest.endpointIndex.has_value())
+            return blocked ("the connection addresses a single element of an endpoint array");
+
+        if (sourceInstance->arraySize != 1 || destInstance->arraySize != 1)
+            return blocked ("one of the processors is an instance array");
+
+        if (sourceInstance->hasClockMultiplier() || sourceInstance->hasClockDivider()
+             || destInstance->hasClockMultiplier() || destInstance->hasClockDivider())
+            return blocked ("the processors run at different clock rates");
+
+        auto sourceModule = program.findModuleWithName (sourceInstance->sourceName);
+        auto destModule   = program.findModuleWithName (destInstance->sourceName);
+
+        // two instances of the same processor can't be merged, as their clones'
+        // structs would collide
+        if (sourceModule == nullptr || destModule == nullptr || ! sourceModule->isProcessor() || ! destModule->isProcessor())
+            return blocked ("both ends must be plain processor instances");
+
+        if (sourceModule == destModule)
+            return blocked ("both ends are instances of the same processor");
+
+        auto fusedOutput = sourceModule->findOutput (connection.source.endpointName);
+        auto fusedInput  = destModule->findInput (connection.dest.endpointName);
+
+        if (fusedOutput == nullptr || fusedInput == nullptr
+             || ! fusedOutput->isStreamEndpoint() || ! fusedInput->isStreamEndpoint()
+             || fusedOutput->arraySize.has_value() || fusedInput->arraySize.has_value()
+             || fusedOutput->dataTypes.size() != 1 || fusedInput->dataTypes.size() != 1
+             || ! fusedOutput->dataTypes.front().isIdentical (fusedInput->dataTypes.front()))
+            return blocked ("the endpoints aren't a matching pair of simple streams");
+
+        // the fused endpoints must have no other users (multiple stream writers are
+        // summed, so a second one changes the value), and there must be no second
+        // connection between the pair, which would turn into a zero-delay self-loop
+        size_t connectionsFromOutput = 0, connectionsToInput = 0, connectionsBetweenPair = 0;
+
+        for (auto& c : graph.connections)
+        {
+            if (c->source.processor == sourceInstance && c->source.endpointName == connection.source.endpointName)
+                ++connectionsFromOutput;
+
+            if (c->dest.processor == destInstance && c->dest.endpointName == connection.dest.endpointName)
+                ++connectionsToInput;
+
+            if ((c->source.processor == sourceInstance && c->dest.processor == destInstance)
+                 || (c->source.processor == destInstance && c->dest.processor == sourceInstance))
+                ++connectionsBetweenPair;
         }
-    }
 
-    static void removeCallsToVoidFunctionsWithoutSideEffects (Program& program)
-    {
-        for (auto& m : program.getModules())
-            for (auto& f : m->functions)
-                for (auto& b : f->blocks)
-                    b->statements.removeMatches ([] (heart::Statement& s)
-                                                 {
-                                                     if (auto call = cast<heart::FunctionCall> (s))
-                                                         return call->target == nullptr && ! call->getFunction().mayHaveSideEffects();
+        if (connectionsFromOutput != 1 || connectionsToInput != 1 || connectionsBetweenPair != 1)
+            return blocked ("the endpoints have other connections, or the pair is connected more than once");
 
-                                                     return false;
-                                                 });
+        auto sourceRun = sourceModule->findRunFunction();
+        auto destRun   = destModule->findRunFunction();
+
+        FusableRunShape sourceShape, destShape;
+
+        if (sourceRun == nullptr || destRun == nullptr
+             || ! analyseFusableRunShape (*sourceRun, sourceShape)
+             || ! analyseFusableRunShape (*destRun, destShape))
+            return blocked ("a run() function isn't in the canonical single-loop, single-advance form");
+
+        if (findSingleWriteToOutput (*sourceModule, sourceShape, *fusedOutput) == nullptr
+             || findSingleReadFromInput (*destModule, destShape, *fusedInput) == nullptr)
+            return blocked ("the stream is written or read somewhere other than once inside the run loop");
+
+        if (! canMergeModuleContents (*sourceModule, *destModule, *fusedOutput, *fusedInput))
+            return blocked ("the modules' structs, event handlers or endpoint names would clash when merged");
+
+        if (areOptimisationRemarksEnabled())
+            emitOptimisationRemark (connection.location,
+                                    "fused processor '" + sourceInstance->instanceName + "' into '" + destInstance->instanceName
+                                      + "' across the " + connection.source.endpointName + " -> " + connection.dest.endpointName + " connection");
+
+        performFusion (program, graph, connection, *sourceModule, *destModule);
+        return true;
     }
 
-    static void recursivelyFlagStructUse (const Type& type)
+    /** Explains what stopped each of the graph's remaining processor-to-processor
+        connections from fusing. Only called once fuseProcessorChains() has reached
+        its fixed point, so none of the re-checks here can actually fuse anything.
+    */
+    static void reportUnfusedConnections (Program& program)
     {
-        if (type.isStruct())
+        for (auto& m : program.getModules())
         {
-            if (! type.getStructRef().activeUseFlag)
+            if (! m->isGraph())
+                continue;
+
+            for (auto& c : m->connections)
             {
-                type.getStructRef().activeUseFlag = true;
+                if (c->source.processor == nullptr || c->dest.processor == nullptr)
+                    continue;
 
-                for (auto& m : type.getStructRef().getMembers())
-                    recursivelyFlagStructUse (m.type);
+                const char* reason = nullptr;
+
+                if (! tryToFuseConnection (program, m, c, &reason) && reason != nullptr)
+                    emitOptimisationRemark (c->location,
+                                            "not fusing connection '" + c->source.processor->instanceName + "." + c->source.endpointName
+                                              + " -> " + c->dest.processor->instanceName + "." + c->dest.endpointName + "': " + reason);
             }
         }
-        else if (type.isArray())
+    }
+
+    /** The cloner's mapping tables have to cover every object a module can refer
+        to, so when cloning a single module rather than a whole program, anything
+        living in the other modules (intrinsics, namespace functions, shared
+        structs and constants) is mapped onto itself.
+    */
+    static void addIdentityMappingsForOtherModules (Program& program, const Module& moduleBeingCloned,
+                                                    ModuleCloner::FunctionMappings& functions,
+                                                    ModuleCloner::StructMappings& structs,
+                                                    ModuleCloner::VariableMappings& variables)
+    {
+        for (auto& m : program.getModules())
         {
-            recursivelyFlagStructUse (type.getArrayElementType());
+            if (m == moduleBeingCloned)
+                continue;
+
+            for (auto& f : m->functions)
+                functions[f] = f;
+
+            for (auto& s : m->structs)
+                structs[s.get()] = s;
+
+            for (auto& v : m->stateVariables)
+                variables[v] = v;
         }
     }
 
-    //==============================================================================
-    static bool findAndReplaceFirstDuplicateConstant (heart::Function& f)
+    /** Merges the two processors joined by the given (already fully validated)
+        connection into a new fused module, and rewires the graph to use it.
+    */
+    static void performFusion (Program& program, Module& graph, heart::Connection& connection,
+                               Module& sourceModule, Module& destModule)
     {
-        for (auto b : f.blocks)
+        auto& sourceInstance = *connection.source.processor;
+        auto& destInstance   = *connection.dest.processor;
+
+        // must be appended after the main graph, so that it can't be mistaken for
+        // the main processor if the program is re-linked
+        auto& fused = program.addProcessor (-1);
+
+        fused.shortName = addSuffixToMakeUnique (sourceModule.shortName + "_" + destModule.shortName,
+                                                 [&] (const std::string& nm)
+                                                 {
+                                                     return program.findModuleWithName (TokenisedPathString::join (Program::getRootNamespaceName(), nm)) != nullptr;
+                                                 });
+        fused.fullName = TokenisedPathString::join (Program::getRootNamespaceName(), fused.shortName);
+        fused.originalFullName = fused.shortName;
+        fused.sampleRate = destModule.sampleRate;
+
+        // The cloner expects an empty target module, so the downstream processor is
+        // cloned straight into the fused module and the upstream one goes via a
+        // temporary whose contents are then appended. All objects live in the
+        // program-wide pool, so they safely outlive the temporary module itself.
+        ModuleCloner::FunctionMappings destFunctionMappings, sourceFunctionMappings;
+        ModuleCloner::StructMappings destStructMappings, sourceStructMappings;
+        ModuleCloner::VariableMappings destVariableMappings, sourceVariableMappings;
+
+        addIdentityMappingsForOtherModules (program, destModule, destFunctionMappings, destStructMappings, destVariableMappings);
+
         {
-            LinkedList<heart::Statement>::Iterator last;
+            ModuleCloner cloner (destModule, fused, destFunctionMappings, destStructMappings, destVariableMappings);
+            cloner.createStructPlaceholders();
+            cloner.cloneStructAndFunctionPlaceholders();
+            cloner.clone();
+        }
 
-            for (auto s : b->statements)
-            {
-                if (auto a = cast<heart::AssignFromValue> (*s))
-                {
-                    if (auto target = cast<heart::Variable> (a->target))
-                    {
-                        if (target->isConstant())
-                        {
-                            if (auto source = cast<heart::Variable> (a->source))
-                            {
-                                if (source->isConstant())
-                                {
-                                    b->statements.removeNext (last);
+        auto fusedInputClone = fused.findInput (connection.dest.endpointName);
 
-                                    f.visitExpressions ([target, source] (pool_ref<heart::Expression>& value, AccessType mode)
-                                    {
-                                        if (value == target && mode == AccessType::read)
-                                            value = *source;
-                                    });
+        auto& temp = program.addProcessor (-1);
+        temp.shortName = fused.shortName + "_tmp";
+        temp.fullName = fused.fullName + "_tmp";
+        temp.originalFullName = temp.shortName;
 
-                                    return true;
-                                }
-                            }
-                        }
-                    }
-                }
+        addIdentityMappingsForOtherModules (program, sourceModule, sourceFunctionMappings, sourceStructMappings, sourceVariableMappings);
 
-                last = *s;
-            }
+        {
+            ModuleCloner cloner (sourceModule, temp, sourceFunctionMappings, sourceStructMappings, sourceVariableMappings);
+            cloner.createStructPlaceholders();
+            cloner.cloneStructAndFunctionPlaceholders();
+            cloner.clone();
         }
 
-        return false;
-    }
+        auto fusedOutputClone = temp.findOutput (connection.source.endpointName);
 
-    static void removeDuplicateConstants (heart::Function& f)
-    {
-        while (findAndReplaceFirstDuplicateConstant (f))
-        {}
-    }
+        auto sourceSideInputs    = temp.inputs;
+        auto sourceSideOutputs   = temp.outputs;
+        auto sourceSideFunctions = temp.functions;
+        auto sourceSideStateVars = temp.stateVariables;
 
-    static void removeUnusedVariables (heart::Function& f)
-    {
-        for (auto b : f.blocks)
+        appendVector (fused.inputs, temp.inputs);
+        appendVector (fused.outputs, temp.outputs);
+        appendVector (fused.functions, temp.functions);
+        appendVector (fused.stateVariables, temp.stateVariables);
+        appendVector (fused.structs, temp.structs);
+        program.removeModule (temp);
+
+        fused.latency = sourceModule.latency + destModule.latency;
+
+        // silence-transparency survives fusion only when both halves have it
+        if (sourceModule.annotation.getBool ("propagates_silence")
+             && destModule.annotation.getBool ("propagates_silence"))
+            fused.annotation.set ("propagates_silence", true);
+
+        auto getMappedFunction = [] (ModuleCloner::FunctionMappings& mappings, pool_ptr<heart::Function> f) -> pool_ptr<heart::Function>
         {
-            b->statements.removeMatches ([] (heart::Statement& s)
-            {
-                if (auto a = cast<heart::Assignment> (s))
-                    if (auto target = cast<heart::Variable> (a->target))
-                        return target->readWriteCount.numReads == 0 && target->isFunctionLocal();
+            if (f == nullptr)
+                return {};
+
+            auto found = mappings.find (*f);
+            return found != mappings.end() ? found->second : pool_ptr<heart::Function>();
+        };
+
+        auto sourceRunClone  = getMappedFunction (sourceFunctionMappings, sourceModule.findRunFunction());
+        auto destRunClone    = getMappedFunction (destFunctionMappings, destModule.findRunFunction());
+        auto sourceInitClone = getMappedFunction (sourceFunctionMappings, sourceModule.findFunction (heart::getSystemInitFunctionName()));
+        auto destInitClone   = getMappedFunction (destFunctionMappings, destModule.findFunction (heart::getSystemInitFunctionName()));
+
+        //==============================================================================
+        // resolve the name clashes between the two sets of clones - everything on the
+        // upstream side gets an instance-name prefix where it collides
 
-                return false;
-            });
+        if (sourceInitClone != nullptr)
+        {
+            sourceInitClone->name = fused.allocator.get (addSuffixToMakeUnique ("_initialise_a",
+                                        [&] (const std::string& nm) { return fused.findFunction (nm) != nullptr; }));
+            sourceInitClone->functionType = heart::FunctionType::normal();
         }
-    }
 
-    static void convertWriteOnceVariablesToConstants (heart::Function& f)
-    {
-        f.visitStatements<heart::Assignment> ([] (heart::Assignment& a)
+        if (destInitClone != nullptr)
         {
-            if (auto target = cast<heart::Variable> (a.target))
-                if (target->readWriteCount.numWrites == 1 && target->isMutableLocal())
-                    target->role = heart::Variable::Role::constant;
-        });
-    }
+            destInitClone->name = fused.allocator.get (addSuffixToMakeUnique ("_initialise_b",
+                                      [&] (const std::string& nm) { return fused.findFunction (nm) != nullptr; }));
+            destInitClone->functionType = heart::FunctionType::normal();
+        }
 
-    struct Inliner
-    {
-        Inliner (Module& m, heart::Function& parentFn, size_t block,
-                 heart::FunctionCall& fc, heart::Function& targetFn)
-            : module (m), parentFunction (parentFn), call (fc), blockIndex (block), targetFunction (targetFn)
+        for (auto& f : sourceSideFunctions)
         {
-            inlinedFnName = addSuffixToMakeUnique ("_inlined_" + targetFunction.name.toString(),
-                                                   [&] (const std::string& nm)
-                                                   {
-                                                       return heart::Utilities::findBlock (parentFn, "@" + nm) != nullptr;
-                                                   });
+            bool clashes = false;
+
+            for (auto& other : fused.functions)
+                if (other != f && other->name.toString() == f->name.toString())
+                    clashes = true;
+
+            if (clashes)
+                f->name = fused.allocator.get (addSuffixToMakeUnique (sourceInstance.instanceName + "_" + f->name.toString(),
+                              [&] (const std::string& nm) { return fused.findFunction (nm) != nullptr; }));
         }
 
-        void perform()
+        for (auto& v : sourceSideStateVars)
         {
-            auto& postBlock = heart::Utilities::splitBlock (module, parentFunction, blockIndex, call, "@" + inlinedFnName + "_end");
-            postCallResumeBlock = postBlock;
-            auto& preBlock = parentFunction.blocks[blockIndex].get();
+            bool clashes = false;
 
-            preBlock.statements.remove (call);
+            for (auto& other : fused.stateVariables)
+                if (other != v && other->name.toString() == v->name.toString())
+                    clashes = true;
 
-            if (! targetFunction.returnType.isVoid())
-            {
-                returnValueVar = BlockBuilder::createVariable (module, targetFunction.returnType,
-                                                               module.allocator.get (inlinedFnName + "_retval"),
-                                                               heart::Variable::Role::mutableLocal);
+            if (clashes)
+                v->name = fused.allocator.get (addSuffixToMakeUnique (sourceInstance.instanceName + "_" + v->name.toString(),
+                              [&] (const std::string& nm) { return fused.findStateVariable (nm) != nullptr; }));
+        }
 
-                postBlock.statements.insertFront (module.allocate<heart::AssignFromValue> (call.location, *call.target, *returnValueVar));
-            }
+        //==============================================================================
+        // drop the two fused endpoints, rename any upstream endpoints which collide
+        // with downstream ones, and renumber what's left
 
-            {
-                BlockBuilder builder (module, preBlock);
+        removeItem (fused.outputs, *fusedOutputClone);
+        removeItem (fused.inputs, *fusedInputClone);
 
-                for (size_t i = 0; i < targetFunction.parameters.size(); ++i)
-                {
-                    auto& param = targetFunction.parameters[i].get();
-                    auto newParamName = inlinedFnName + "_param_" + makeSafeIdentifierName (param.name.toString());
-                    auto& localParamVar = builder.createMutableLocalVariable (param.type, newParamName);
-                    builder.addAssignment (localParamVar, call.arguments[i]);
-                    remappedVariables[param] = localParamVar;
-                }
-            }
+        std::unordered_map<std::string, std::string> sourceEndpointRenames;
 
-            newBlocks.reserve (targetFunction.blocks.size());
+        auto renameSourceEndpointIfClashing = [&] (heart::IODeclaration& e)
+        {
+            bool clashes = false;
 
-            for (auto& b : targetFunction.blocks)
+            for (auto& io : fused.inputs)
+                if (io != e && io->name.toString() == e.name.toString())
+                    clashes = true;
+
+            for (auto& io : fused.outputs)
+                if (io != e && io->name.toString() == e.name.toString())
+                    clashes = true;
+
+            if (clashes)
             {
-                // NB: the name of the first block must be "@" + inlinedFnName, since that's what the unique
-                // name picker will look for to make sure there's not a block name clash
-                auto name = "@" + inlinedFnName + (newBlocks.empty() ? std::string() : ("_" + std::to_string (newBlocks.size())));
-                auto& newBlock = module.allocate<heart::Block> (module.allocator.get (name));
-                newBlocks.push_back (newBlock);
-                remappedBlocks[b] = newBlock;
+                auto oldName = e.name.toString();
+                auto newName = addSuffixToMakeUnique (sourceInstance.instanceName + "_" + oldName,
+                                                      [&] (const std::string& nm)
+                                                      {
+                                                          return fused.findInput (nm) != nullptr || fused.findOutput (nm) != nullptr;
+                                                      });
+                e.name = fused.allocator.get (newName);
+                sourceEndpointRenames[oldName] = newName;
             }
+        };
 
-            parentFunction.blocks.insert (getIteratorForIndex (parentFunction.blocks, blockIndex + 1),
-                                          newBlocks.begin(), newBlocks.end());
+        for (auto& io : sourceSideInputs)
+            renameSourceEndpointIfClashing (io);
 
-            preBlock.terminator = module.allocate<heart::Branch> (newBlocks.front());
+        for (auto& io : sourceSideOutputs)
+            if (io != *fusedOutputClone)
+                renameSourceEndpointIfClashing (io);
 
-            for (size_t i = 0; i < newBlocks.size(); ++i)
-                cloneBlock (newBlocks[i], targetFunction.blocks[i]);
-        }
+        for (size_t i = 0; i < fused.inputs.size(); ++i)
+            fused.inputs[i]->index = (uint32_t) i;
 
-        void cloneBlock (heart::Block& target, const heart::Block& source)
-        {
-            LinkedList<heart::Statement>::Iterator last;
+        for (size_t i = 0; i < fused.outputs.size(); ++i)
+            fused.outputs[i]->index = (uint32_t) i;
 
-            for (auto s : source.statements)
-                last = target.statements.insertAfter (last, cloneStatement (*s));
+        //==============================================================================
+        // weave the two run() loops into one
 
-            if (auto returnValue = cast<heart::ReturnValue> (source.terminator))
-                target.statements.insertAfter (last, module.allocate<heart::AssignFromValue> (source.location, *returnValueVar,
-                                                                                              cloneExpression (returnValue->returnValue)));
+        FusableRunShape sourceShape, destShape;
+        bool shapesOK = analyseFusableRunShape (*sourceRunClone, sourceShape)
+                          && analyseFusableRunShape (*destRunClone, destShape);
+        SOUL_ASSERT (shapesOK); ignoreUnused (shapesOK);
 
-            target.terminator = cloneTerminator (*source.terminator);
-        }
+        auto streamWrite = findSingleWriteToOutput (fused, sourceShape, *fusedOutputClone);
+        auto streamRead  = findSingleReadFromInput (fused, destShape, *fusedInputClone);
+        SOUL_ASSERT (streamWrite != nullptr && streamRead != nullptr);
 
-        heart::Statement& cloneStatement (heart::Statement& s)
+        // the local which carries the value that used to cross the connection
+        std::unordered_set<std::string> usedVariableNames;
+
+        for (auto& v : fused.stateVariables)
+            usedVariableNames.insert (v->name.toString());
+
+        auto collectVariableNames = [&] (heart::Function& f)
         {
-            #define SOUL_CLONE_STATEMENT(Type)     if (auto t = cast<const heart::Type> (s)) return clone (*t);
-            SOUL_HEART_STATEMENTS (SOUL_CLONE_STATEMENT)
-            #undef SOUL_CLONE_STATEMENT
-            SOUL_ASSERT_FALSE;
-            return s;
-        }
+            f.visitExpressions ([&] (pool_ref<heart::Expression>& e, AccessType)
+                                {
+                                    if (auto v = cast<heart::Variable> (e))
+                                        if (v->name.isValid())
+                                            usedVariableNames.insert (v->name.toString());
+                                });
+        };
 
-        heart::Terminator& cloneTerminator (heart::Terminator& s)
+        collectVariableNames (*sourceRunClone);
+        collectVariableNames (*destRunClone);
+
+        auto& fusedValue = fused.allocate<heart::Variable> (connection.location,
+                                                            fusedOutputClone->dataTypes.front(),
+                                                            fused.allocator.get (addSuffixToMakeUnique ("_fused_" + connection.source.endpointName,
+                                                                                     [&] (const std::string& nm) { return usedVariableNames.find (nm) != usedVariableNames.end(); })),
+                                                            heart::Variable::Role::mutableLocal);
+
+        auto& fusedLoop = fused.allocate<heart::Block> (fused.allocator.get ("@loop"));
+
+        for (auto& p : sourceShape.loopBlock->parameters)
+            fusedLoop.parameters.push_back (p);
+
+        for (auto& p : destShape.loopBlock->parameters)
         {
-            #define SOUL_CLONE_TERMINATOR(Type)    if (auto t = cast<const heart::Type> (s)) return clone (*t);
-            SOUL_HEART_TERMINATORS (SOUL_CLONE_TERMINATOR)
-            #undef SOUL_CLONE_TERMINATOR
-            SOUL_ASSERT_FALSE;
-            return s;
+            auto unique = addSuffixToMakeUnique (p->name.toString(),
+                              [&] (const std::string& nm)
+                              {
+                                  for (auto& existing : fusedLoop.parameters)
+                                      if (existing->name.toString() == nm)
+                                          return true;
+
+                                  return false;
+                              });
+
+            if (unique != p->name.toString())
+                p->name = fused.allocator.get (unique);
+
+            fusedLoop.parameters.push_back (p);
         }
 
-        heart::Branch& clone (const heart::Branch& old)
+        auto sourceAdvance = *sourceShape.loopBlock->statements.getLast();
+        std::vector<heart::Statement*> wovenStatements;
+
+        for (auto s : sourceShape.loopBlock->statements)
         {
-            return module.allocate<heart::Branch> (*remappedBlocks[old.target]);
+            if (s == sourceAdvance)   // the upstream advance is subsumed by the downstream one
+                continue;
+
+            if (s == streamWrite.get())
+                wovenStatements.push_back (std::addressof (fused.allocateStatement<heart::AssignFromValue> (s->location, fusedValue, streamWrite->value)));
+            else
+                wovenStatements.push_back (s);
         }
 
-        heart::BranchIf& clone (const heart::BranchIf& old)
+        for (auto s : destShape.loopBlock->statements)
         {
-            return module.allocate<heart::BranchIf> (cloneExpression (old.condition),
-                                                     *remappedBlocks[old.targets[0]],
-                                                     *remappedBlocks[old.targets[1]]);
+            if (s == streamRead.get())
+                wovenStatements.push_back (std::addressof (fused.allocateStatement<heart::AssignFromValue> (s->location, *streamRead->target, fusedValue)));
+            else
+                wovenStatements.push_back (s);   // this includes the one remaining advance, still last
         }
 
-        heart::Terminator& clone (const heart::ReturnVoid&)    { return module.allocate<heart::Branch> (*postCallResumeBlock); }
-        heart::Terminator& clone (const heart::ReturnValue&)   { return module.allocate<heart::Branch> (*postCallResumeBlock); }
+        LinkedList<heart::Statement>::Iterator tail;
 
-        heart::AssignFromValue& clone (const heart::AssignFromValue& old)
+        for (auto s : wovenStatements)
         {
-            return module.allocate<heart::AssignFromValue> (old.location,
-                                                            cloneExpression (*old.target),
-                                                            cloneExpression (old.source));
+            if (tail == nullptr)
+            {
+                fusedLoop.statements.insertFront (*s);
+                tail = LinkedList<heart::Statement>::Iterator (*s);
+            }
+            else
+            {
+                tail.insertAfter (*s);
+                ++tail;
+            }
         }
 
-        heart::FunctionCall& clone (const heart::FunctionCall& old)
-        {
-            auto& fc = module.allocate<heart::FunctionCall> (old.location, cloneExpressionPtr (old.target), old.getFunction());
+        auto& backEdge = fused.allocateStatement<heart::Branch> (fusedLoop);
 
-            for (auto& arg : old.arguments)
-                fc.arguments.push_back (cloneExpression (arg));
+        for (auto& a : cast<heart::Branch> (sourceShape.loopBlock->terminator)->targetArgs)
+            backEdge.targetArgs.push_back (a);
 
-            return fc;
-        }
+        for (auto& a : cast<heart::Branch> (destShape.loopBlock->terminator)->targetArgs)
+            backEdge.targetArgs.push_back (a);
 
-        heart::PureFunctionCall& clone (const heart::PureFunctionCall& old)
-        {
-            auto& fc = module.allocate<heart::PureFunctionCall> (old.location, old.function);
+        fusedLoop.terminator = backEdge;
 
-            for (auto& arg : old.arguments)
-                fc.arguments.push_back (cloneExpression (arg));
+        // chain the two init regions together ahead of the loop, carrying both sets
+        // of loop-entry arguments on the final branch into it
+        heart::Branch::ArgListType loopEntryArgs;
 
-            return fc;
-        }
+        if (! sourceShape.initBlocks.empty())
+            for (auto& a : cast<heart::Branch> (sourceShape.initBlocks.back()->terminator)->targetArgs)
+                loopEntryArgs.push_back (a);
 
-        heart::ReadStream& clone (const heart::ReadStream& old)
+        if (! destShape.initBlocks.empty())
+            for (auto& a : cast<heart::Branch> (destShape.initBlocks.back()->terminator)->targetArgs)
+                loopEntryArgs.push_back (a);
+
+        std::vector<pool_ref<heart::Block>> newBlocks;
+
+        for (auto& b : sourceShape.initBlocks)
+            newBlocks.push_back (b);
+
+        for (auto& b : destShape.initBlocks)
+            newBlocks.push_back (b);
+
+        if (! sourceShape.initBlocks.empty() && ! destShape.initBlocks.empty())
         {
-            return module.allocate<heart::ReadStream> (old.location, cloneExpression (*old.target), old.source);
+            auto& bridge = *cast<heart::Branch> (sourceShape.initBlocks.back()->terminator);
+            bridge.target = destShape.initBlocks.front();
+            bridge.targetArgs.clear();
         }
 
-        heart::WriteStream& clone (const heart::WriteStream& old)
+        if (! newBlocks.empty())
         {
-            return module.allocate<heart::WriteStream> (old.location, old.target,
-                                                        cloneExpressionPtr (old.element),
-                                                        cloneExpression (old.value));
+            auto& entry = *cast<heart::Branch> (newBlocks.back()->terminator);
+            entry.target = fusedLoop;
+            entry.targetArgs = loopEntryArgs;
         }
-
-        heart::AdvanceClock& clone (const heart::AdvanceClock& a)
+        else
         {
-            return module.allocate<heart::AdvanceClock> (a.location);
+            // an entry block can't take parameters, so two init-free loops can't have any either
+            SOUL_ASSERT (fusedLoop.parameters.empty());
         }
 
-        heart::Expression& cloneExpression (heart::Expression& old)
-        {
-            if (auto c = cast<heart::Constant> (old))
-                return module.allocate<heart::Constant> (c->location, c->value);
+        newBlocks.push_back (fusedLoop);
 
-            if (auto b = cast<heart::BinaryOperator> (old))
-                return module.allocate<heart::BinaryOperator> (b->location,
-                                                               cloneExpression (b->lhs),
-                                                               cloneExpression (b->rhs),
-                                                               b->operation);
+        size_t blockCounter = 0;
 
-            if (auto u = cast<heart::UnaryOperator> (old))
-                return module.allocate<heart::UnaryOperator> (u->location, cloneExpression (u->source), u->operation);
+        for (auto& b : newBlocks)
+            b->name = fused.allocator.get ("@fused_" + std::to_string (blockCounter++));
 
-            if (auto t = cast<heart::TypeCast> (old))
-                return module.allocate<heart::TypeCast> (t->location, cloneExpression (t->source), t->destType);
+        removeItem (fused.functions, *sourceRunClone);
+        removeItem (fused.functions, *destRunClone);
 
-            if (auto f = cast<heart::PureFunctionCall> (old))
-                return clone (*f);
+        auto& newRun = fused.allocate<heart::Function>();
+        newRun.name = fused.allocator.get (heart::getRunFunctionName());
+        newRun.returnType = destRunClone->returnType;
+        newRun.functionType = heart::FunctionType::run();
+        newRun.blocks = std::move (newBlocks);
+        fused.functions.push_back (newRun);
+        newRun.rebuildBlockPredecessors();
 
-            if (auto v = cast<heart::Variable> (old))
-                return getRemappedVariable (*v);
+        // re-running the block optimisations merges the chained init regions back
+        // into one block, which also restores the canonical shape so that a fused
+        // processor can immediately be fused again with the next link in the chain
+        optimiseFunctionBlocks (newRun, fused.allocator);
 
-            if (auto s = cast<heart::ArrayElement> (old))
-                return cloneArrayElement (*s);
+        //==============================================================================
+        // give the fused module a system init which runs both halves' ones in order
 
-            if (auto s = cast<heart::StructElement> (old))
-                return cloneStructElement (*s);
+        if (sourceInitClone != nullptr || destInitClone != nullptr)
+        {
+            auto& initFn = fused.allocate<heart::Function>();
+            initFn.name = fused.allocator.get (heart::getSystemInitFunctionName());
+            initFn.returnType = PrimitiveType::void_;
+            initFn.functionType = heart::FunctionType::systemInit();
 
-            auto pp = cast<heart::ProcessorProperty> (old);
-            return module.allocate<heart::ProcessorProperty> (pp->location, pp->property);
-        }
+            auto& entryBlock = fused.allocate<heart::Block> (fused.allocator.get ("@entry"));
 
-        pool_ptr<heart::Expression> cloneExpressionPtr (pool_ptr<heart::Expression> old)
-        {
-            if (old != nullptr)
-                return cloneExpression (*old);
+            if (sourceInitClone != nullptr)
+                entryBlock.statements.append (fused.allocateStatement<heart::FunctionCall> (sourceInitClone->location, nullptr, sourceInitClone));
 
-            return {};
+            if (destInitClone != nullptr)
+                entryBlock.statements.append (fused.allocateStatement<heart::FunctionCall> (destInitClone->location, nullptr, destInitClone));
+
+            entryBlock.terminator = fused.allocateStatement<heart::ReturnVoid>();
+            initFn.blocks.push_back (entryBlock);
+            fused.functions.push_back (initFn);
+            initFn.rebuildBlockPredecessors();
         }
 
-        heart::Variable& getRemappedVariable (heart::Variable& old)
-        {
-            if (old.isFunctionLocal() || old.isParameter())
-            {
-                auto& v = remappedVariables[old];
+        fused.rebuildBlockPredecessors();
+        fused.rebuildVariableUseCounts();
 
-                if (v == nullptr)
-                {
-                    v = module.allocate<heart::Variable> (old.location, old.type,
-                                                          old.name.isValid() ? module.allocator.get (inlinedFnName + "_" + makeSafeIdentifierName (old.name.toString()))
-                                                                             : Identifier(),
-                                                          old.role);
-                    v->annotation = old.annotation;
-                }
+        //==============================================================================
+        // swap the two instances in the graph for a single fused one
 
-                return *v;
-            }
+        auto& fusedInstance = graph.allocate<heart::ProcessorInstance>();
+        fusedInstance.instanceName = addSuffixToMakeUnique (sourceInstance.instanceName + "_" + destInstance.instanceName,
+                                         [&] (const std::string& nm)
+                                         {
+                                             for (auto& p : graph.processorInstances)
+                                                 if (p->instanceName == nm)
+                                                     return true;
 
-            return old;
-        }
+                                             return false;
+                                         });
+        fusedInstance.sourceName = fused.fullName;
+        graph.processorInstances.push_back (fusedInstance);
 
-        heart::ArrayElement& cloneArrayElement (const heart::ArrayElement& old)
+        auto remapEndpointReference = [&] (heart::EndpointReference& ref)
         {
-            auto& s = module.allocate<heart::ArrayElement> (old.location,
-                                                            cloneExpression (old.parent),
-                                                            old.fixedStartIndex,
-                                                            old.fixedEndIndex);
+            if (ref.processor == sourceInstance)
+            {
+                ref.processor = fusedInstance;
+                auto renamed = sourceEndpointRenames.find (ref.endpointName);
 
-            s.dynamicIndex = cloneExpressionPtr (old.dynamicIndex);
-            s.suppressWrapWarning = old.suppressWrapWarning;
-            s.isRangeTrusted = old.isRangeTrusted;
-            return s;
-        }
+                if (renamed != sourceEndpointRenames.end())
+                    ref.endpointName = renamed->second;
+            }
+            else if (ref.processor == destInstance)
+            {
+                ref.processor = fusedInstance;
+            }
+        };
 
-        heart::StructElement& cloneStructElement (const heart::StructElement& old)
+        for (auto& c : graph.connections)
         {
-            return module.allocate<heart::StructElement> (old.location,
-                                                          cloneExpression (old.parent),
-                                                          old.memberName);
+            if (c != connection)
+            {
+                remapEndpointReference (c->source);
+                remapEndpointReference (c->dest);
+            }
         }
 
-        Module& module;
-        heart::Function& parentFunction;
-        heart::FunctionCall& call;
-        size_t blockIndex;
-        heart::Function& targetFunction;
-        std::string inlinedFnName;
-        std::vector<pool_ref<heart::Block>> newBlocks;
-        std::unordered_map<pool_ref<heart::Block>, pool_ptr<heart::Block>> remappedBlocks;
-        std::unordered_map<pool_ref<heart::Variable>, pool_ptr<heart::Variable>> remappedVariables;
-        pool_ptr<heart::Block> postCallResumeBlock;
-        pool_ptr<heart::Variable> returnValueVar;
-    };
+        removeItem (graph.connections, connection);
+        removeItem (graph.processorInstances, sourceInstance);
+        removeItem (graph.processorInstances, destInstance);
 
-    enum class InlineResult { ok, failed, noneFound };
+        // the original processors can go once nothing instantiates them any more
+        auto mainProcessor = program.findMainProcessor();
 
-    static InlineResult inlineNextCall (Program& program, heart::Function& parentFunction, heart::Function& functionToInline)
-    {
-        for (size_t blockIndex = 0; blockIndex < parentFunction.blocks.size(); ++blockIndex)
+        auto removeIfUnreferenced = [&] (Module& m)
         {
-            for (auto s : parentFunction.blocks[blockIndex]->statements)
-            {
-                if (auto call = cast<heart::FunctionCall> (*s))
-                {
-                    if (call->function == functionToInline)
-                    {
-                        if (! heart::Utilities::canFunctionBeInlined (program, parentFunction, *call))
-                            return InlineResult::failed;
+            if (mainProcessor.get() == std::addressof (m))
+                return;
 
-                        makeFunctionCallInline (program, parentFunction, blockIndex, *call);
-                        return InlineResult::ok;
-                    }
-                }
-            }
-        }
+            for (auto& other : program.getModules())
+                if (other->isGraph())
+                    for (auto& instance : other->processorInstances)
+                        if (instance->sourceName == m.fullName)
+                            return;
 
-        return InlineResult::noneFound;
+            program.removeModule (m);
+        };
+
+        removeIfUnreferenced (sourceModule);
+        removeIfUnreferenced (destModule);
     }
 
-    static InlineResult inlineAllCallsToFunction (Program& program, heart::Function& parentFunction, heart::Function& functionToInline)
+    //==============================================================================
+    /** Rebuilds the float32 sin/cos intrinsics as linearly-interpolated lookups
+        into a constant table covering one period.
+
+        This trades a little accuracy for a large, predictable speedup on targets
+        whose libm transcendentals are slow, so it's opt-in via a target profile
+        rather than part of the normal optimisation pipeline. The table has
+        tableSize + 1 entries (the first is repeated at the end) so that the
+        interpolation never needs a second wrap.
+    */
+    static void replaceTranscendentalsWithTableLookups (Program& program, uint32_t tableSize = 2048)
     {
-        if (functionToInline.isExported || ! functionToInline.functionType.isNormal())
-            return InlineResult::failed;
+        SOUL_ASSERT (tableSize >= 16);
 
-        bool anyChanged = false;
+        for (auto& m : program.getModules())
+            for (auto f : m->functions)
+                if ((f->intrinsicType == IntrinsicType::sin || f->intrinsicType == IntrinsicType::cos)
+                      && f->functionType.isIntrinsic()
+                      && f->returnType.isPrimitive() && f->returnType.isFloat32()
+                      && f->parameters.size() == 1
+                      && f->parameters.front()->getType().isPrimitive()
+                      && f->parameters.front()->getType().isFloat32())
+                    replaceBodyWithTableLookup (m, f, tableSize);
+    }
 
-        for (;;)
+    static void replaceBodyWithTableLookup (Module& m, heart::Function& f, uint32_t tableSize)
+    {
+        std::vector<Value> entries;
+        entries.reserve (tableSize + 1);
+
+        for (uint32_t i = 0; i <= tableSize; ++i)
         {
-            auto result = inlineNextCall (program, parentFunction, functionToInline);
+            auto phase = twoPi * (double) i / (double) tableSize;
+            entries.push_back (Value ((float) (f.intrinsicType == IntrinsicType::sin ? std::sin (phase)
+                                                                                     : std::cos (phase))));
+        }
 
-            if (result == InlineResult::failed)
-                return result;
+        auto tableValue = Value::createArrayOrVector (Type (PrimitiveType::float32).createArray (tableSize + 1), entries);
 
-            if (result == InlineResult::noneFound)
-                return anyChanged ? InlineResult::ok
-                                  : InlineResult::noneFound;
+        f.blocks.clear();
+        f.hasNoBody = true;
 
-            anyChanged = true;
-        }
+        // Demote the function from intrinsic to normal, so that backends use the
+        // table body instead of mapping the call to their native implementation
+        f.intrinsicType = IntrinsicType::none;
+        f.functionType = heart::FunctionType::normal();
+
+        FunctionBuilder::populateFunctionBody (m, f, [&] (FunctionBuilder& builder)
+        {
+            auto& input = f.parameters.front().get();
+            auto& table = builder.createRegisterVariable (builder.createConstant (std::move (tableValue)), "table");
+            auto& sizeConst = builder.createConstantInt32 (tableSize);
+
+            auto& phase = builder.createRegisterVariable (
+                              builder.createBinaryOp ({}, input, builder.createConstant (Value ((float) (tableSize / twoPi))),
+                                                      BinaryOp::Op::multiply), "phase");
+
+            auto& truncated = builder.createRegisterVariable (builder.createCast ({}, phase, PrimitiveType::int32), "truncated");
+            auto& fracRaw = builder.createRegisterVariable (
+                                builder.createSubtract (phase, builder.createCast ({}, truncated, PrimitiveType::float32)), "fracRaw");
+
+            auto& frac  = builder.createMutableLocalVariable (PrimitiveType::float32, "frac");
+            auto& index = builder.createMutableLocalVariable (PrimitiveType::int32, "index");
+
+            builder.addAssignment (frac, fracRaw);
+            builder.addAssignment (index, builder.createWrapInt32 (truncated, sizeConst));
+
+            // A float-to-int cast truncates towards zero, so a negative input leaves
+            // the fractional part negative - shift down to the previous table entry
+            auto& negative = builder.createBlock ("@negativeFrac");
+            auto& lookup   = builder.createBlock ("@lookup");
+
+            builder.addBranchIf (builder.createComparisonOp (fracRaw, builder.createConstant (Value (0.0f)), BinaryOp::Op::lessThan),
+                                 negative, lookup, negative);
+
+            builder.addAssignment (frac, builder.createAdd (fracRaw, builder.createConstant (Value (1.0f))));
+            builder.addAssignment (index, builder.createWrapInt32 (
+                                       builder.createRegisterVariable (
+                                           builder.createSubtract (truncated, builder.createConstantInt32 (1))), sizeConst));
+            builder.beginBlock (lookup);
+
+            auto& sample1 = builder.createRegisterVariable (builder.createTrustedDynamicSubElement (table, index), "sample1");
+            auto& nextIndex = builder.createRegisterVariable (builder.createAdd (index, builder.createConstantInt32 (1)), "nextIndex");
+            auto& sample2 = builder.createRegisterVariable (builder.createTrustedDynamicSubElement (table, nextIndex), "sample2");
+
+            auto& difference = builder.createSubtract (sample2, sample1);
+            builder.addReturn (builder.createAdd (sample1, builder.createBinaryOp ({}, difference, frac, BinaryOp::Op::multiply)));
+        });
     }
 };
 
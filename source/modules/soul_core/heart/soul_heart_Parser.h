@@ -97,11 +97,32 @@ struct FunctionParseState
         currentBlock = &b;
     }
 
+    void addVariable (heart::Variable& v)
+    {
+        variables.push_back (v);
+
+        if (v.name.isValid())
+            variableLookup.emplace (std::string_view (v.name.toString()), v);
+    }
+
+    pool_ptr<heart::Variable> findVariable (const std::string& name) const
+    {
+        auto v = variableLookup.find (name);
+
+        if (v != variableLookup.end())
+            return v->second.get();
+
+        return {};
+    }
+
     heart::Function& function;
     std::vector<BlockCode> blocks;
     std::vector<pool_ref<heart::Variable>> variables;
     BlockCode* currentBlock = nullptr;
 
+    // The keys are views onto interned Identifier strings, which outlive the parser
+    std::unordered_map<std::string_view, pool_ref<heart::Variable>> variableLookup;
+    std::unordered_map<std::string_view, pool_ref<heart::Block>> blockLookup;
 };
 
 //==============================================================================
@@ -140,6 +161,16 @@ private:
     Program program;
     pool_ptr<Module> module;
 
+    // Per-scope symbol tables, so that resolving a reference doesn't have to re-scan
+    // the declaration lists - reloading a large cached program makes one of these
+    // lookups for almost every identifier in the file. The keys are views onto
+    // strings owned by the module being parsed, which outlive the parser.
+    std::unordered_map<std::string_view, pool_ref<heart::ProcessorInstance>> processorInstanceLookup;
+    std::unordered_map<std::string_view, pool_ref<heart::Variable>> stateVariableLookup;
+    std::unordered_map<std::string_view, std::vector<pool_ref<heart::Function>>> functionLookup;
+    std::unordered_map<std::string, std::vector<pool_ref<heart::Function>>> qualifiedFunctionLookup;
+    bool qualifiedFunctionLookupIsBuilt = false;
+
     //==============================================================================
     Parser (const CodeLocation& text)  : Tokeniser (text) {}
     ~Parser() override = default;
@@ -172,6 +203,7 @@ private:
     {
         ScannedTopLevelItem newItem (newModule);
         module = newModule;
+        processorInstanceLookup.clear();
         newModule.fullName = readQualifiedIdentifier();
         newModule.originalFullName = newModule.fullName;
         newModule.shortName = TokenisedPathString (newModule.fullName).getLastPart();
@@ -240,6 +272,23 @@ private:
         prepareToRescan (item);
         SOUL_ASSERT (module->inputs.size()  == item.inputDecls.size());
         SOUL_ASSERT (module->outputs.size() == item.outputDecls.size());
+
+        // All of this module's declarations are known by this point, so the symbol
+        // tables that the function bodies will do their lookups in can be built
+        // once here, pre-sized to their final entry counts
+        functionLookup.clear();
+        functionLookup.reserve (module->functions.size());
+
+        for (auto& fn : module->functions)
+            functionLookup[std::string_view (fn->name.toString())].push_back (fn);
+
+        stateVariableLookup.clear();
+        stateVariableLookup.reserve (module->stateVariables.size());
+
+        for (auto& v : module->stateVariables)
+            if (v->name.isValid())
+                stateVariableLookup.emplace (std::string_view (v->name.toString()), v);
+
         parseTopLevelItems (item);
         module.reset();
     }
@@ -416,6 +465,7 @@ private:
         if (matches (Token::literalInt64))     { auto v = literalIntValue;    skip(); return Value::createInt64 (v); }
         if (matches (Token::literalFloat32))   { auto v = literalDoubleValue; skip(); return Value ((float) v); }
         if (matches (Token::literalFloat64))   { auto v = literalDoubleValue; skip(); return Value (v); }
+        if (matches (Token::literalFloat16))   { auto v = literalDoubleValue; skip(); return Value ((float) v); }  // annotations hold float16 values at float32
         if (matches (Token::literalString))    { auto v = program.getStringDictionary().getHandleForString (currentStringValue); skip(); return Value::createStringLiteral(v); }
         if (matchIf ("true"))                  return Value (true);
         if (matchIf ("false"))                 return Value (false);
@@ -433,13 +483,13 @@ private:
     {
         auto name = readQualifiedIdentifier();
 
-        for (auto m : module->processorInstances)
-            if (m->instanceName == name)
-                location.throwError (Errors::duplicateProcessor (name));
+        if (processorInstanceLookup.find (name) != processorInstanceLookup.end())
+            location.throwError (Errors::duplicateProcessor (name));
 
         auto& mi = module->allocate<heart::ProcessorInstance>();
         module->processorInstances.push_back (mi);
         mi.instanceName = name;
+        processorInstanceLookup.emplace (std::string_view (mi.instanceName), mi);
         expect (HEARTOperator::assign);
         mi.sourceName = readQualifiedIdentifier();
 
@@ -532,21 +582,12 @@ private:
 
     pool_ptr<heart::ProcessorInstance> findProcessorInstance (const std::string& instanceName)
     {
-        pool_ptr<heart::ProcessorInstance> result;
-
-        for (auto m : module->processorInstances)
-        {
-            if (m->instanceName == instanceName)
-            {
-                result = m;
-                break;
-            }
-        }
+        auto result = processorInstanceLookup.find (instanceName);
 
-        if (result == nullptr)
+        if (result == processorInstanceLookup.end())
             throwError (Errors::cannotFindProcessor (instanceName));
 
-        return result;
+        return result->second.get();
     }
 
     void scanStateVariable (ScannedTopLevelItem& item, bool isConstant)
@@ -735,11 +776,11 @@ private:
         {
             auto name = readBlockName();
 
-            for (auto& b : state.blocks)
-                if (b.block.name == name)
-                    throwError (Errors::nameInUse (name));
+            if (state.blockLookup.find (name.toString()) != state.blockLookup.end())
+                throwError (Errors::nameInUse (name));
 
             auto& block = builder.createBlock (name);
+            state.blockLookup.emplace (std::string_view (block.name.toString()), block);
 
             if (matchIf (HEARTOperator::openParen))
             {
@@ -798,7 +839,7 @@ private:
 
             auto& newVar = builder.createVariable (type, newVariableName, isConst ? heart::Variable::Role::constant
                                                                                   : heart::Variable::Role::mutableLocal);
-            state.variables.push_back (newVar);
+            state.addVariable (newVar);
             return newVar;
         }
     };
@@ -930,15 +971,39 @@ private:
     {
         if (! containsChar (name, ':'))
         {
-            for (auto& fn : module->functions)
-                if (fn->name == name && functionArgTypesMatch (fn, argTypes))
-                    return fn;
+            auto overloads = functionLookup.find (name);
+
+            if (overloads != functionLookup.end())
+                for (auto& fn : overloads->second)
+                    if (functionArgTypesMatch (fn, argTypes))
+                        return fn;
         }
         else
         {
-            for (auto& m : program.getModules())
-                for (auto& fn : m->functions)
-                    if (TokenisedPathString::join (m->fullName, fn->name) == name && functionArgTypesMatch (fn, argTypes))
+            if (! qualifiedFunctionLookupIsBuilt)
+            {
+                // Every module's function declarations exist before any bodies are
+                // parsed, so this table only needs building once, on the first
+                // qualified reference
+                size_t totalFunctions = 0;
+
+                for (auto& m : program.getModules())
+                    totalFunctions += m->functions.size();
+
+                qualifiedFunctionLookup.reserve (totalFunctions);
+
+                for (auto& m : program.getModules())
+                    for (auto& fn : m->functions)
+                        qualifiedFunctionLookup[TokenisedPathString::join (m->fullName, fn->name)].push_back (fn);
+
+                qualifiedFunctionLookupIsBuilt = true;
+            }
+
+            auto overloads = qualifiedFunctionLookup.find (name);
+
+            if (overloads != qualifiedFunctionLookup.end())
+                for (auto& fn : overloads->second)
+                    if (functionArgTypesMatch (fn, argTypes))
                         return fn;
         }
 
@@ -965,8 +1030,9 @@ private:
             expect (HEARTOperator::colon);
             auto& falseBranch = readBlockNameAndFind (state);
             auto falseBranchArgs = parseOptionalBranchArgs<heart::BranchIf::ArgListType> (state);
+            auto likelihood = parseOptionalBranchLikelihood();
             expectSemicolon();
-            builder.addBranchIf (condition, trueBranch, std::move (trueBranchArgs), falseBranch, std::move (falseBranchArgs), {});
+            builder.addBranchIf (condition, trueBranch, std::move (trueBranchArgs), falseBranch, std::move (falseBranchArgs), {}, likelihood);
             return true;
         }
 
@@ -1016,6 +1082,18 @@ private:
         return args;
     }
 
+    heart::BranchIf::Likelihood parseOptionalBranchLikelihood()
+    {
+        Annotation annotation;
+        parseAnnotation (annotation);
+
+        if (annotation.hasValue ("likely"))
+            return annotation.getBool ("likely") ? heart::BranchIf::Likelihood::likelyTrue
+                                                 : heart::BranchIf::Likelihood::likelyFalse;
+
+        return heart::BranchIf::Likelihood::unknown;
+    }
+
     void parseReadStream (FunctionParseState& state, FunctionBuilder& builder, const AssignmentTarget& target)
     {
         auto name = parseIdentifier();
@@ -1079,9 +1157,10 @@ private:
 
     pool_ptr<heart::Block> findBlock (const FunctionParseState& state, Identifier name)
     {
-        for (auto& b : state.blocks)
-            if (b.block.name == name)
-                return b.block;
+        auto b = state.blockLookup.find (name.toString());
+
+        if (b != state.blockLookup.end())
+            return b->second.get();
 
         return {};
     }
@@ -1101,18 +1180,20 @@ private:
             return program.findVariableWithName (TokenisedPathString::join (path.getParentPath(), "$" + variableName));
         }
 
-        for (auto& v : state.variables)
-            if (v->name == name)
-                return v;
+        if (auto v = state.findVariable (name))
+            return v;
 
         for (auto& parameter : state.function.parameters)
             if (parameter->name == name)
                 return parameter;
 
         if (includeStateVariables)
-            for (auto& v : module->stateVariables)
-                if (v->name == name)
-                    return v;
+        {
+            auto v = stateVariableLookup.find (name);
+
+            if (v != stateVariableLookup.end())
+                return v->second.get();
+        }
 
         if (state.currentBlock != nullptr)
         {
@@ -1296,6 +1377,7 @@ private:
         if (matches (Token::literalInt64))   return parseConstantAsExpression (state, PrimitiveType::int64);
         if (matches (Token::literalFloat32)) return parseConstantAsExpression (state, PrimitiveType::float32);
         if (matches (Token::literalFloat64)) return parseConstantAsExpression (state, PrimitiveType::float64);
+        if (matches (Token::literalFloat16)) return parseConstantAsExpression (state, PrimitiveType::float16);
         if (matches (Token::literalString))  return parseConstantAsExpression (state, Type::createStringLiteral());
 
         return parseConstantAsExpression (state, readValueType());
@@ -1311,6 +1393,12 @@ private:
         if (matchIf ("_ninf64"))    return soul::Value (-std::numeric_limits<double>::infinity());
         if (matchIf ("_nan64"))     return soul::Value ( std::numeric_limits<double>::quiet_NaN());
 
+        auto toFloat16 = [] (float f)  { return soul::Value (f).castToTypeExpectingSuccess (Type (PrimitiveType::float16)); };
+
+        if (matchIf ("_inf16"))     return toFloat16 ( std::numeric_limits<float>::infinity());
+        if (matchIf ("_ninf16"))    return toFloat16 (-std::numeric_limits<float>::infinity());
+        if (matchIf ("_nan16"))     return toFloat16 ( std::numeric_limits<float>::quiet_NaN());
+
         return {};
     }
 
@@ -1453,6 +1541,21 @@ private:
                 return castValue (Value (val), requiredType);
             }
 
+            if (requiredType.isFloat16())
+            {
+                if (matchIf (Token::literalInt32) || matchIf (Token::literalInt64))
+                    return castValue (Value ((float) literalIntValue), requiredType);
+
+                auto infOrNaN = parseNaNandInfinityTokens();
+
+                if (infOrNaN.isValid())
+                    return castValue (infOrNaN, requiredType);
+
+                auto val = literalDoubleValue;
+                expect (Token::literalFloat16);
+                return castValue (Value ((float) val), requiredType);
+            }
+
             if (requiredType.isInteger32())
             {
                 auto val = literalIntValue;
@@ -1615,6 +1718,7 @@ private:
     {
         if (matchIf ("float32"))  return parseVectorOrArrayTypeSuffixes (PrimitiveType::float32);
         if (matchIf ("float64"))  return parseVectorOrArrayTypeSuffixes (PrimitiveType::float64);
+        if (matchIf ("float16"))  return parseVectorOrArrayTypeSuffixes (PrimitiveType::float16);
         if (matchIf ("fixed"))    return parseVectorOrArrayTypeSuffixes (PrimitiveType::fixed);
         if (matchIf ("void"))     return parseVectorOrArrayTypeSuffixes (PrimitiveType::void_);
         if (matchIf ("int32"))    return parseVectorOrArrayTypeSuffixes (PrimitiveType::int32);
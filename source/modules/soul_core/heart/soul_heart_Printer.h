@@ -24,19 +24,32 @@ namespace soul
 //==============================================================================
 struct heart::Printer
 {
-    static void print (const Program& p, choc::text::CodePrinter& out)
+    template <typename OutputStream>
+    static void print (const Program& p, OutputStream& out)
     {
         out << '#' << getHEARTFormatVersionPrefix() << ' ' << getHEARTFormatVersion() << blankLine;
 
         for (auto& module : p.getModules())
-            PrinterStream (module, out).printAll();
+            PrinterStream<OutputStream> (module, out).printAll();
     }
 
     static std::string getDump (const Program& p)
     {
-        choc::text::CodePrinter out;
+        // Dumps of big linked programs are on the cache-storage path, so rather than
+        // going through CodePrinter's line-by-line accumulation, write straight into
+        // a single string sized from the program's statistics.
+        DirectStream out;
+        out.buffer.reserve (estimateDumpSize (p));
         print (p, out);
-        return out.toString();
+        return std::move (out.buffer);
+    }
+
+    /** Prints a single module, e.g. for structural comparison against others. */
+    static std::string getModuleDump (const Module& m)
+    {
+        DirectStream out;
+        PrinterStream<DirectStream> (m, out).printAll();
+        return std::move (out.buffer);
     }
 
 private:
@@ -44,13 +57,173 @@ private:
     static constexpr choc::text::CodePrinter::BlankLine blankLine = {};
     static constexpr choc::text::CodePrinter::SectionBreak sectionBreak = {};
 
+    //==============================================================================
+    /** A minimal drop-in for the CodePrinter interface which appends directly to one
+        preallocated string, tracking indentation itself instead of buffering lines.
+    */
+    struct DirectStream
+    {
+        std::string buffer;
+        size_t indentLevel = 0;
+        bool atLineStart = true;
+
+        struct Indent
+        {
+            Indent (DirectStream& s, size_t amountToAdd, char openBrace, char cb)
+                : owner (s), amount (amountToAdd), closeBrace (cb)
+            {
+                if (openBrace != 0)
+                    owner << openBrace << choc::text::CodePrinter::NewLine();
+
+                owner.indentLevel += amount;
+            }
+
+            Indent (Indent&&) = default;
+            Indent (const Indent&) = delete;
+
+            ~Indent()
+            {
+                owner.indentLevel -= amount;
+
+                if (closeBrace != 0)
+                    owner << closeBrace;
+            }
+
+            DirectStream& owner;
+            size_t amount;
+            char closeBrace;
+        };
+
+        [[nodiscard]] Indent createIndent (size_t amount)            { return { *this, amount, 0, 0 }; }
+        [[nodiscard]] Indent createIndentWithBraces (size_t amount)  { return { *this, amount, '{', '}' }; }
+
+        void write (std::string_view text)
+        {
+            for (;;)
+            {
+                auto newlinePos = text.find ('\n');
+                auto segment = text.substr (0, newlinePos);
+
+                if (! segment.empty())
+                {
+                    if (atLineStart)
+                    {
+                        buffer.append (indentLevel, ' ');
+                        atLineStart = false;
+                    }
+
+                    buffer.append (segment);
+                }
+
+                if (newlinePos == std::string_view::npos)
+                    return;
+
+                buffer += '\n';
+                atLineStart = true;
+                text.remove_prefix (newlinePos + 1);
+            }
+        }
+
+        void ensureBlankLine()
+        {
+            if (! buffer.empty())
+            {
+                if (! atLineStart)
+                {
+                    buffer += '\n';
+                    atLineStart = true;
+                }
+
+                if (buffer.size() < 2 || buffer[buffer.size() - 2] != '\n')
+                    buffer += '\n';
+            }
+        }
+
+        DirectStream& operator<< (const std::string& s)     { write (s); return *this; }
+        DirectStream& operator<< (std::string_view s)       { write (s); return *this; }
+        DirectStream& operator<< (const char* s)            { write (s); return *this; }
+        DirectStream& operator<< (char c)                   { write (std::string_view (std::addressof (c), 1)); return *this; }
+        DirectStream& operator<< (double v)                 { writeFloat (v); return *this; }
+        DirectStream& operator<< (float v)                  { writeFloat (v); return *this; }
+
+        template <typename FloatType>
+        void writeFloat (FloatType v)
+        {
+            // formatting into the stack buffer avoids a heap-allocated temporary
+            // for every number, which adds up fast when a program embeds large
+            // tables of constants
+            choc::text::FloatToStringBuffer<FloatType> formatted (v);
+            write (std::string_view (formatted.begin(), (size_t) (formatted.end() - formatted.begin())));
+        }
+
+        template <typename IntegerType>
+        DirectStream& operator<< (IntegerType v)            { write (std::to_string (v)); return *this; }
+
+        DirectStream& operator<< (const choc::text::CodePrinter::NewLine&)
+        {
+            buffer += '\n';
+            atLineStart = true;
+            return *this;
+        }
+
+        DirectStream& operator<< (const choc::text::CodePrinter::BlankLine&)
+        {
+            ensureBlankLine();
+            return *this;
+        }
+
+        DirectStream& operator<< (const choc::text::CodePrinter::SectionBreak&)
+        {
+            ensureBlankLine();
+            write ("//==============================================================================");
+            buffer += '\n';
+            atLineStart = true;
+            return *this;
+        }
+    };
+
+    static size_t estimateDumpSize (const Program& p)
+    {
+        size_t total = 256;
+
+        for (auto& m : p.getModules())
+        {
+            total += 256 + m->fullName.length()
+                      + 96 * (m->inputs.size() + m->outputs.size())
+                      + 80 * (m->connections.size() + m->processorInstances.size())
+                      + 64 * m->stateVariables.size();
+
+            for (auto& s : m->structs)
+                total += 64 + 48 * s->getNumMembers();
+
+            for (auto& f : m->functions)
+            {
+                total += 160;
+
+                for (auto& b : f->blocks)
+                {
+                    total += 32;
+
+                    for (auto statement : b->statements)
+                    {
+                        ignoreUnused (statement);
+                        total += 56;
+                    }
+                }
+            }
+        }
+
+        return total;
+    }
+
+    template <typename OutputStream>
     struct PrinterStream
     {
-        PrinterStream (const Module& m, choc::text::CodePrinter& o)
+        PrinterStream (const Module& m, OutputStream& o)
            : module (m), out (o) {}
 
         const Module& module;
-        choc::text::CodePrinter& out;
+        OutputStream& out;
 
         std::unordered_map<pool_ref<heart::Variable>, std::string> localVariableNames;
         std::vector<std::string> allVisibleVariables;
@@ -381,13 +554,13 @@ private:
         {
             struct Printer  : public ValuePrinter
             {
-                Printer (choc::text::CodePrinter& s) : outStream (s) {}
+                Printer (OutputStream& s) : outStream (s) {}
 
                 void print (std::string_view s) override    { outStream << s; }
                 void printFloat32 (float value) override    { if (value == 0) print ("0.0f"); else ValuePrinter::printFloat32 (value); }
                 void printFloat64 (double value) override   { if (value == 0) print ("0.0");  else ValuePrinter::printFloat64 (value); }
 
-                choc::text::CodePrinter& outStream;
+                OutputStream& outStream;
             };
 
             Printer p { out };
@@ -576,6 +749,11 @@ private:
 
             if (! b.targetArgs[1].empty())
                 printArgList (b.targetArgs[1]);
+
+            if (b.likelihood == heart::BranchIf::Likelihood::likelyTrue)
+                out << " [[ likely: true ]]";
+            else if (b.likelihood == heart::BranchIf::Likelihood::likelyFalse)
+                out << " [[ likely: false ]]";
         }
 
         void printDescription (const heart::ReturnVoid&) const
@@ -0,0 +1,1622 @@
+/*
+    _____ _____ _____ __
+   |   __|     |  |  |  |      The SOUL language
+   |__   |  |  |  |  |  |__    Copyright (c) 2019 - ROLI Ltd.
+   |_____|_____|_____|_____|
+
+   The code in this file is provided under the terms of the ISC license:
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose
+   with or without fee is hereby granted, provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+namespace soul
+{
+
+//==============================================================================
+/**
+    Saves and reloads a fully-linked Program as a compact, versioned binary blob.
+
+    The LinkerCache stores programs between runs, and reloading the textual HEART
+    dump means running the whole tokeniser and heart::Parser again. This format
+    instead writes tables of strings, structs, functions and variables followed by
+    typed records for each statement and expression, so a cached program can be
+    reconstituted in a single linear pass over the data with no tokenising.
+
+    Code locations are not preserved, which matches the text dump (whose locations
+    point into the dump itself rather than the original source). The blob is only
+    ever read back from a local cache, so it uses native endianness and performs
+    bounds-checking rather than full semantic validation - anything inconsistent
+    just makes load() return an empty program, and the caller falls back to a
+    normal build.
+
+    The blob ends with a hash of everything before it, which load() verifies
+    before reading anything else. A program was fully checked before it was
+    saved, so an intact hash lets the caller treat the reloaded program as
+    trusted input and skip re-running the heart::Checker on it.
+*/
+struct heart::Serialiser
+{
+    /** Serialises a linked program, returning an empty vector if it contains
+        something the binary format can't represent (in which case the caller
+        should store the textual dump instead).
+    */
+    static std::vector<char> save (const Program& program)
+    {
+        try
+        {
+            Saver saver (program);
+            saver.writeProgram();
+            saver.out.write (hashContents (saver.out.data.data(), saver.out.data.size()));
+            return std::move (saver.out.data);
+        }
+        catch (BadFormatError) {}
+
+        return {};
+    }
+
+    /** Returns true if this chunk of data starts with the binary format's header. */
+    static bool isSerialisedProgram (const void* data, size_t size)
+    {
+        uint32_t magic = 0;
+
+        if (data == nullptr || size < sizeof (magic))
+            return false;
+
+        memcpy (std::addressof (magic), data, sizeof (magic));
+        return magic == magicNumber;
+    }
+
+    /** Returns a hash of a program's complete structure.
+
+        This is computed from the binary serialisation rather than a printed
+        dump, so it skips all the string formatting that a textual hash pays
+        for, and it doesn't change when the printer's layout does. Returns 0
+        for a program which the binary format can't represent, in which case
+        the caller has to fall back to hashing the dump.
+    */
+    static uint64_t getStructuralHash (const Program& program)
+    {
+        try
+        {
+            Saver saver (program);
+            saver.writeProgram();
+            return hashContents (saver.out.data.data(), saver.out.data.size());
+        }
+        catch (BadFormatError) {}
+
+        return 0;
+    }
+
+    /** Reloads a program saved by save(), returning an empty program if the data
+        is truncated, corrupted, or was written by a different format version.
+        A non-empty result means the trailing content hash was intact, so the
+        program is byte-for-byte what save() was given.
+    */
+    static Program load (const void* data, size_t size)
+    {
+        constexpr auto hashSize = sizeof (uint64_t);
+
+        if (data == nullptr || size <= hashSize)
+            return {};
+
+        // Verifying the hash up-front means a damaged entry is rejected outright
+        // rather than being caught (or missed) piecemeal by the record parsing
+        auto payloadSize = size - hashSize;
+        uint64_t storedHash = 0;
+        memcpy (std::addressof (storedHash), static_cast<const char*> (data) + payloadSize, hashSize);
+
+        if (storedHash != hashContents (data, payloadSize))
+            return {};
+
+        try
+        {
+            Loader loader (data, payloadSize);
+            loader.readProgram();
+            return loader.program;
+        }
+        catch (BadFormatError) {}
+
+        return {};
+    }
+
+private:
+    //==============================================================================
+    // The leading zero byte guarantees that a blob can never be mistaken for a
+    // textual HEART dump, which always starts with '#'
+    static constexpr uint32_t magicNumber = 0x42484300;
+    static constexpr uint32_t binaryFormatVersion = 3;
+
+    struct BadFormatError {};
+
+    [[noreturn]] static void fail()     { throw BadFormatError(); }
+
+    // FNV-1a, which is cheap enough to run over the whole blob on every load
+    static uint64_t hashContents (const void* data, size_t size)
+    {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        auto* bytes = static_cast<const uint8_t*> (data);
+
+        for (size_t i = 0; i < size; ++i)
+            hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+
+        return hash;
+    }
+
+    enum class TypeCode : uint8_t
+    {
+        invalid = 0, primitive, vector, array, wrap, clamp, structure, stringLiteral
+    };
+
+    enum class ExpressionCode : uint8_t
+    {
+        constant = 1, variable, arrayElement, structElement, typeCast,
+        unaryOp, binaryOp, pureFunctionCall, processorProperty
+    };
+
+    enum class StatementCode : uint8_t
+    {
+        assignFromValue = 1, functionCall, readStream, writeStream, advanceClock
+    };
+
+    enum class TerminatorCode : uint8_t
+    {
+        branch = 1, branchIf, returnVoid, returnValue
+    };
+
+    //==============================================================================
+    struct OutputBuffer
+    {
+        std::vector<char> data;
+
+        void writeBytes (const void* source, size_t size)
+        {
+            data.insert (data.end(), static_cast<const char*> (source),
+                                     static_cast<const char*> (source) + size);
+        }
+
+        template <typename PrimitiveType>
+        void write (PrimitiveType value)
+        {
+            static_assert (std::is_trivially_copyable<PrimitiveType>::value, "");
+            writeBytes (std::addressof (value), sizeof (value));
+        }
+
+        void writeBool (bool b)                     { write (static_cast<uint8_t> (b ? 1 : 0)); }
+        void writeCount (size_t count)              { write (static_cast<uint32_t> (count)); }
+
+        void writeString (const std::string& s)
+        {
+            writeCount (s.length());
+            writeBytes (s.data(), s.length());
+        }
+    };
+
+    struct InputBuffer
+    {
+        InputBuffer (const void* source, size_t size)
+            : position (static_cast<const uint8_t*> (source)), end (position + size)
+        {
+            if (source == nullptr)
+                fail();
+        }
+
+        const uint8_t* position;
+        const uint8_t* end;
+
+        void readBytes (void* dest, size_t size)
+        {
+            if (size > static_cast<size_t> (end - position))
+                fail();
+
+            memcpy (dest, position, size);
+            position += size;
+        }
+
+        template <typename PrimitiveType>
+        PrimitiveType read()
+        {
+            static_assert (std::is_trivially_copyable<PrimitiveType>::value, "");
+            PrimitiveType result;
+            readBytes (std::addressof (result), sizeof (result));
+            return result;
+        }
+
+        bool readBool()                             { return read<uint8_t>() != 0; }
+
+        size_t readCount()
+        {
+            // No valid count can exceed the number of bytes remaining, so this also
+            // stops corrupted data from triggering enormous allocations
+            auto count = read<uint32_t>();
+
+            if (count > static_cast<size_t> (end - position))
+                fail();
+
+            return count;
+        }
+
+        size_t readIndex (size_t numItems)
+        {
+            auto index = read<uint32_t>();
+
+            if (index >= numItems)
+                fail();
+
+            return index;
+        }
+
+        std::string readString()
+        {
+            auto length = readCount();
+            std::string s (length, 0);
+            readBytes (s.data(), length);
+            return s;
+        }
+    };
+
+    //==============================================================================
+    struct Saver
+    {
+        Saver (const Program& p) : program (p) {}
+
+        Program program;  // kept by value as the traversal needs non-const access
+        OutputBuffer out;
+
+        std::unordered_map<const Structure*, uint32_t> structIndexes;
+        std::unordered_map<const heart::Function*, uint32_t> functionIndexes;
+        std::unordered_map<const heart::Variable*, uint32_t> variableIndexes;
+        Module* currentModule = nullptr;
+
+        void writeProgram()
+        {
+            out.write (magicNumber);
+            out.write (binaryFormatVersion);
+            out.write (getHEARTFormatVersion());
+
+            writeStringDictionary();
+
+            auto& modules = program.getModules();
+            out.writeCount (modules.size());
+
+            for (auto& m : modules)
+            {
+                if (m->isProcessor())       out.write (static_cast<uint8_t> (0));
+                else if (m->isGraph())      out.write (static_cast<uint8_t> (1));
+                else                        out.write (static_cast<uint8_t> (2));
+
+                out.writeString (m->shortName);
+                out.writeString (m->fullName);
+                out.writeString (m->originalFullName);
+            }
+
+            writeStructs();
+            writeConstantTable();
+
+            for (auto& m : modules)
+                writeModuleContents (m);
+
+            for (auto& m : modules)
+            {
+                out.writeCount (m->functions.size());
+
+                for (auto& f : m->functions)
+                    writeFunctionDeclaration (f);
+            }
+
+            for (auto& m : modules)
+                for (auto& f : m->functions)
+                    writeFunctionBody (m, f);
+        }
+
+        void writeStringDictionary()
+        {
+            auto& dictionary = program.getStringDictionary();
+            out.writeCount (dictionary.size());
+
+            dictionary.forEach ([this] (const StringDictionary::Item& s)
+            {
+                out.write (s.handle.handle);
+                out.writeString (s.text);
+            });
+        }
+
+        void writeConstantTable()
+        {
+            auto& table = program.getConstantTable();
+            out.writeCount (table.size());
+
+            // An item whose data is an element-aligned subrange of a larger item is
+            // written as a reference into that parent rather than as a second copy of
+            // the bytes. Parents are written before the items that point into them so
+            // the reader can slice as it goes - a parent is always strictly larger
+            // than the items it contains, so such an ordering always exists.
+            std::unordered_map<ConstantTable::Handle, ConstantTable::SubRangeInfo> sharedItems;
+            std::unordered_set<ConstantTable::Handle> written;
+            std::vector<const ConstantTable::Item*> pending;
+
+            for (auto& item : table)
+            {
+                if (auto parent = table.findContainingItem (item.handle))
+                {
+                    sharedItems[item.handle] = *parent;
+                    pending.push_back (std::addressof (item));
+                }
+                else
+                {
+                    out.write (static_cast<int64_t> (item.handle));
+                    out.writeBool (false);
+                    writeValue (*item.value);
+                    written.insert (item.handle);
+                }
+            }
+
+            while (! pending.empty())
+            {
+                auto numPending = pending.size();
+
+                for (auto i = pending.begin(); i != pending.end();)
+                {
+                    auto& shared = sharedItems[(*i)->handle];
+
+                    if (written.find (shared.parent) != written.end())
+                    {
+                        out.write (static_cast<int64_t> ((*i)->handle));
+                        out.writeBool (true);
+                        out.write (static_cast<int64_t> (shared.parent));
+                        out.writeCount (shared.startElement);
+                        out.writeCount (shared.numElements);
+                        written.insert ((*i)->handle);
+                        i = pending.erase (i);
+                    }
+                    else
+                    {
+                        ++i;
+                    }
+                }
+
+                SOUL_ASSERT (pending.size() < numPending);
+            }
+        }
+
+        void writeStructs()
+        {
+            size_t total = 0;
+
+            for (auto& m : program.getModules())
+                total += m->structs.size();
+
+            out.writeCount (total);
+
+            for (uint32_t moduleIndex = 0; moduleIndex < program.getModules().size(); ++moduleIndex)
+            {
+                for (auto& s : program.getModules()[moduleIndex]->structs)
+                {
+                    structIndexes[s.get()] = static_cast<uint32_t> (structIndexes.size());
+                    out.write (moduleIndex);
+                    out.writeString (s->getName());
+                }
+            }
+
+            // Members are written as a second pass, as they may refer to structs
+            // which are declared later
+            for (auto& m : program.getModules())
+            {
+                for (auto& s : m->structs)
+                {
+                    out.writeCount (s->getNumMembers());
+
+                    for (auto& member : s->getMembers())
+                    {
+                        writeType (member.type);
+                        out.writeString (member.name);
+                    }
+                }
+            }
+        }
+
+        void writeModuleContents (Module& m)
+        {
+            writeAnnotation (m.annotation);
+            out.write (m.sampleRate);
+            out.write (m.latency);
+
+            out.writeCount (m.inputs.size());
+            for (auto& io : m.inputs)    writeIODeclaration (io);
+
+            out.writeCount (m.outputs.size());
+            for (auto& io : m.outputs)   writeIODeclaration (io);
+
+            out.writeCount (m.processorInstances.size());
+
+            for (auto& p : m.processorInstances)
+            {
+                out.writeString (p->instanceName);
+                out.writeString (p->sourceName);
+                out.write (p->clockMultiplier);
+                out.write (p->clockDivider);
+                out.write (p->arraySize);
+                out.write (p->renderStage);
+            }
+
+            out.writeCount (m.connections.size());
+
+            for (auto& c : m.connections)
+            {
+                writeEndpointReference (m, c->source);
+                writeEndpointReference (m, c->dest);
+                out.write (static_cast<uint8_t> (c->interpolationType));
+                out.write (c->delayLength);
+            }
+
+            out.writeCount (m.stateVariables.size());
+
+            for (auto& v : m.stateVariables)
+                writeVariableDeclaration (v);
+        }
+
+        void writeIODeclaration (heart::IODeclaration& io)
+        {
+            out.writeString (io.name.toString());
+            out.write (io.index);
+            out.write (static_cast<uint8_t> (io.endpointType));
+
+            out.writeCount (io.dataTypes.size());
+
+            for (auto& t : io.dataTypes)
+                writeType (t);
+
+            out.writeBool (io.arraySize.has_value());
+
+            if (io.arraySize.has_value())
+                out.write (*io.arraySize);
+
+            writeAnnotation (io.annotation);
+        }
+
+        void writeEndpointReference (Module& m, heart::EndpointReference& ref)
+        {
+            uint32_t processorIndex = 0;
+
+            if (ref.processor != nullptr)
+            {
+                auto i = std::find (m.processorInstances.begin(), m.processorInstances.end(), pool_ref<heart::ProcessorInstance> (*ref.processor));
+
+                if (i == m.processorInstances.end())
+                    fail();
+
+                processorIndex = static_cast<uint32_t> (1 + std::distance (m.processorInstances.begin(), i));
+            }
+
+            out.write (processorIndex);
+            out.writeString (ref.endpointName);
+            out.writeBool (ref.endpointIndex.has_value());
+
+            if (ref.endpointIndex.has_value())
+                out.write (static_cast<uint64_t> (*ref.endpointIndex));
+        }
+
+        void writeVariableDeclaration (heart::Variable& v)
+        {
+            variableIndexes[std::addressof (v)] = static_cast<uint32_t> (variableIndexes.size());
+
+            out.write (static_cast<uint8_t> (v.role));
+            writeType (v.type);
+            out.writeBool (v.name.isValid());
+
+            if (v.name.isValid())
+                out.writeString (v.name.toString());
+
+            writeAnnotation (v.annotation);
+            out.write (static_cast<int64_t> (v.externalHandle));
+        }
+
+        void writeFunctionDeclaration (heart::Function& f)
+        {
+            functionIndexes[std::addressof (f)] = static_cast<uint32_t> (functionIndexes.size());
+
+            out.writeString (f.name.toString());
+            writeType (f.returnType);
+            out.write (static_cast<uint8_t> (f.functionType.type));
+            out.write (static_cast<int32_t> (f.intrinsicType));
+            writeAnnotation (f.annotation);
+            out.writeBool (f.isExported);
+            out.writeBool (f.hasNoBody);
+        }
+
+        void writeFunctionBody (Module& m, heart::Function& f)
+        {
+            currentModule = std::addressof (m);
+
+            // All the variables this function declares get their table entries
+            // written up-front, so the body can refer to them (and to state
+            // variables from any module) by index
+            std::vector<pool_ref<heart::Variable>> localVariables;
+
+            auto addLocalVariable = [&] (heart::Variable& v)
+            {
+                if (variableIndexes.find (std::addressof (v)) == variableIndexes.end())
+                {
+                    localVariables.push_back (v);
+                    variableIndexes[std::addressof (v)] = static_cast<uint32_t> (variableIndexes.size());
+                }
+            };
+
+            for (auto& p : f.parameters)
+                addLocalVariable (p);
+
+            for (auto& b : f.blocks)
+                for (auto& p : b->parameters)
+                    addLocalVariable (p);
+
+            f.visitExpressions ([&] (pool_ref<heart::Expression>& e, AccessType)
+                                {
+                                    if (auto v = cast<heart::Variable> (e))
+                                        addLocalVariable (*v);
+                                });
+
+            out.writeCount (localVariables.size());
+
+            for (auto& v : localVariables)
+            {
+                out.write (static_cast<uint8_t> (v->role));
+                writeType (v->type);
+                out.writeBool (v->name.isValid());
+
+                if (v->name.isValid())
+                    out.writeString (v->name.toString());
+
+                writeAnnotation (v->annotation);
+                out.write (static_cast<int64_t> (v->externalHandle));
+            }
+
+            out.writeCount (f.parameters.size());
+
+            for (auto& p : f.parameters)
+                writeVariableReference (p);
+
+            writeNullableVariable (f.stateParameter);
+            writeNullableVariable (f.ioParameter);
+
+            std::unordered_map<const heart::Block*, uint32_t> blockIndexes;
+            out.writeCount (f.blocks.size());
+
+            for (auto& b : f.blocks)
+            {
+                blockIndexes[std::addressof (b.get())] = static_cast<uint32_t> (blockIndexes.size());
+                out.writeString (b->name.toString());
+            }
+
+            for (auto& b : f.blocks)
+            {
+                out.writeBool (b->doNotOptimiseAway);
+                out.writeCount (b->parameters.size());
+
+                for (auto& p : b->parameters)
+                    writeVariableReference (p);
+
+                size_t numStatements = 0;
+
+                for (auto s : b->statements)
+                {
+                    ignoreUnused (s);
+                    ++numStatements;
+                }
+
+                out.writeCount (numStatements);
+
+                for (auto s : b->statements)
+                    writeStatement (*s);
+
+                if (b->terminator == nullptr)
+                    fail();
+
+                writeTerminator (*b->terminator, blockIndexes);
+            }
+        }
+
+        void writeStatement (heart::Statement& s)
+        {
+            if (auto a = cast<heart::AssignFromValue> (s))
+            {
+                out.write (StatementCode::assignFromValue);
+                writeExpression (*a->target);
+                writeExpression (a->source);
+                return;
+            }
+
+            if (auto call = cast<heart::FunctionCall> (s))
+            {
+                out.write (StatementCode::functionCall);
+                writeNullableExpression (call->target);
+                out.write (getFunctionIndex (call->getFunction()));
+                out.writeCount (call->arguments.size());
+
+                for (auto& arg : call->arguments)
+                    writeExpression (arg);
+
+                return;
+            }
+
+            if (auto r = cast<heart::ReadStream> (s))
+            {
+                out.write (StatementCode::readStream);
+                writeExpression (*r->target);
+                out.write (getIOIndex (currentModule->inputs, r->source));
+                writeNullableExpression (r->element);
+                return;
+            }
+
+            if (auto w = cast<heart::WriteStream> (s))
+            {
+                out.write (StatementCode::writeStream);
+                out.write (getIOIndex (currentModule->outputs, w->target));
+                writeNullableExpression (w->element);
+                writeExpression (w->value);
+                return;
+            }
+
+            if (is_type<heart::AdvanceClock> (s))
+            {
+                out.write (StatementCode::advanceClock);
+                return;
+            }
+
+            fail();
+        }
+
+        void writeTerminator (heart::Terminator& t, const std::unordered_map<const heart::Block*, uint32_t>& blockIndexes)
+        {
+            auto getBlockIndex = [&] (heart::Block& b) -> uint32_t
+            {
+                auto i = blockIndexes.find (std::addressof (b));
+
+                if (i == blockIndexes.end())
+                    fail();
+
+                return i->second;
+            };
+
+            if (auto b = cast<heart::Branch> (t))
+            {
+                out.write (TerminatorCode::branch);
+                out.write (getBlockIndex (b->target));
+                out.writeCount (b->targetArgs.size());
+
+                for (auto& arg : b->targetArgs)
+                    writeExpression (arg);
+
+                return;
+            }
+
+            if (auto b = cast<heart::BranchIf> (t))
+            {
+                out.write (TerminatorCode::branchIf);
+                writeExpression (b->condition);
+                out.write (getBlockIndex (b->targets[0]));
+                out.write (getBlockIndex (b->targets[1]));
+
+                for (auto& args : b->targetArgs)
+                {
+                    out.writeCount (args.size());
+
+                    for (auto& arg : args)
+                        writeExpression (arg);
+                }
+
+                out.write (static_cast<uint8_t> (b->likelihood));
+                return;
+            }
+
+            if (is_type<heart::ReturnVoid> (t))
+            {
+                out.write (TerminatorCode::returnVoid);
+                return;
+            }
+
+            if (auto r = cast<heart::ReturnValue> (t))
+            {
+                out.write (TerminatorCode::returnValue);
+                writeExpression (r->returnValue);
+                return;
+            }
+
+            fail();
+        }
+
+        void writeExpression (heart::Expression& e)
+        {
+            if (auto c = cast<heart::Constant> (e))
+            {
+                out.write (ExpressionCode::constant);
+                writeValue (c->value);
+                return;
+            }
+
+            if (auto v = cast<heart::Variable> (e))
+            {
+                out.write (ExpressionCode::variable);
+                writeVariableReference (*v);
+                return;
+            }
+
+            if (auto a = cast<heart::ArrayElement> (e))
+            {
+                out.write (ExpressionCode::arrayElement);
+                writeExpression (a->parent);
+                out.writeBool (a->isDynamic());
+
+                if (a->isDynamic())
+                {
+                    writeExpression (*a->dynamicIndex);
+                }
+                else
+                {
+                    out.write (static_cast<uint64_t> (a->fixedStartIndex));
+                    out.write (static_cast<uint64_t> (a->fixedEndIndex));
+                }
+
+                out.writeBool (a->isRangeTrusted);
+                out.writeBool (a->suppressWrapWarning);
+                return;
+            }
+
+            if (auto s = cast<heart::StructElement> (e))
+            {
+                out.write (ExpressionCode::structElement);
+                writeExpression (s->parent);
+                out.writeString (s->memberName);
+                return;
+            }
+
+            if (auto t = cast<heart::TypeCast> (e))
+            {
+                out.write (ExpressionCode::typeCast);
+                writeExpression (t->source);
+                writeType (t->destType);
+                return;
+            }
+
+            if (auto u = cast<heart::UnaryOperator> (e))
+            {
+                out.write (ExpressionCode::unaryOp);
+                writeExpression (u->source);
+                out.write (static_cast<uint8_t> (u->operation));
+                return;
+            }
+
+            if (auto b = cast<heart::BinaryOperator> (e))
+            {
+                out.write (ExpressionCode::binaryOp);
+                writeExpression (b->lhs);
+                writeExpression (b->rhs);
+                out.write (static_cast<uint8_t> (b->operation));
+                return;
+            }
+
+            if (auto call = cast<heart::PureFunctionCall> (e))
+            {
+                out.write (ExpressionCode::pureFunctionCall);
+                out.write (getFunctionIndex (call->function));
+                out.writeCount (call->arguments.size());
+
+                for (auto& arg : call->arguments)
+                    writeExpression (arg);
+
+                return;
+            }
+
+            if (auto p = cast<heart::ProcessorProperty> (e))
+            {
+                out.write (ExpressionCode::processorProperty);
+                out.write (static_cast<uint8_t> (p->property));
+                return;
+            }
+
+            fail();
+        }
+
+        void writeNullableExpression (pool_ptr<heart::Expression> e)
+        {
+            out.writeBool (e != nullptr);
+
+            if (e != nullptr)
+                writeExpression (*e);
+        }
+
+        void writeVariableReference (heart::Variable& v)
+        {
+            auto i = variableIndexes.find (std::addressof (v));
+
+            if (i == variableIndexes.end())
+                fail();
+
+            out.write (i->second);
+        }
+
+        void writeNullableVariable (pool_ptr<heart::Variable> v)
+        {
+            out.writeBool (v != nullptr);
+
+            if (v != nullptr)
+                writeVariableReference (*v);
+        }
+
+        uint32_t getFunctionIndex (heart::Function& f)
+        {
+            auto i = functionIndexes.find (std::addressof (f));
+
+            if (i == functionIndexes.end())
+                fail();
+
+            return i->second;
+        }
+
+        template <typename DeclarationList, typename Declaration>
+        static uint32_t getIOIndex (const DeclarationList& declarations, const Declaration& io)
+        {
+            for (size_t i = 0; i < declarations.size(); ++i)
+                if (declarations[i] == io)
+                    return static_cast<uint32_t> (i);
+
+            fail();
+        }
+
+        void writeType (const Type& t)
+        {
+            out.write (static_cast<uint8_t> ((t.isConst() ? 1 : 0) | (t.isReference() ? 2 : 0)));
+            writeTypeWithoutFlags (t);
+        }
+
+        // Array element types are written without a flags byte, to match
+        // readTypeWithoutFlags() on the loading side
+        void writeTypeWithoutFlags (const Type& t)
+        {
+            if (t.isArray())
+            {
+                out.write (TypeCode::array);
+                writeTypeWithoutFlags (t.getArrayElementType().withConstAndRefFlags (false, false));
+                out.write (static_cast<uint32_t> (t.isUnsizedArray() ? 0 : t.getArraySize()));
+            }
+            else if (t.isVector())
+            {
+                out.write (TypeCode::vector);
+                out.write (static_cast<uint8_t> (t.getVectorElementType().type));
+                out.write (static_cast<uint32_t> (t.getVectorSize()));
+            }
+            else if (t.isWrapped() || t.isClamped())
+            {
+                out.write (t.isWrapped() ? TypeCode::wrap : TypeCode::clamp);
+                out.write (t.getBoundedIntLimit());
+            }
+            else if (t.isStruct())
+            {
+                auto i = structIndexes.find (std::addressof (t.getStructRef()));
+
+                if (i == structIndexes.end())
+                    fail();
+
+                out.write (TypeCode::structure);
+                out.write (i->second);
+            }
+            else if (t.isStringLiteral())
+            {
+                out.write (TypeCode::stringLiteral);
+            }
+            else if (t.isPrimitive())
+            {
+                out.write (TypeCode::primitive);
+                out.write (static_cast<uint8_t> (t.getPrimitiveType().type));
+            }
+            else if (! t.isValid())
+            {
+                out.write (TypeCode::invalid);
+            }
+            else
+            {
+                fail();
+            }
+        }
+
+        void writeValue (const Value& v)
+        {
+            writeType (v.getType());
+            out.writeCount (v.getPackedDataSize());
+            out.writeBytes (v.getPackedData(), v.getPackedDataSize());
+        }
+
+        void writeAnnotation (const Annotation& a)
+        {
+            auto names = a.getNames();
+            out.writeCount (names.size());
+
+            for (auto& name : names)
+            {
+                out.writeString (name);
+                auto value = a.getValue (name);
+
+                if (value.getType().isStringLiteral())
+                {
+                    out.writeBool (true);
+                    out.writeString (std::string (a.getDictionary().getStringForHandle (value.getStringLiteral())));
+                }
+                else
+                {
+                    out.writeBool (false);
+                    writeValue (value);
+                }
+            }
+        }
+    };
+
+    //==============================================================================
+    struct Loader
+    {
+        Loader (const void* data, size_t size) : in (data, size) {}
+
+        InputBuffer in;
+        Program program;
+
+        std::vector<StructurePtr> structures;
+        std::vector<pool_ptr<heart::Function>> functions;
+        std::vector<pool_ptr<heart::Variable>> variables;
+
+        void readProgram()
+        {
+            if (in.read<uint32_t>() != magicNumber
+                 || in.read<uint32_t>() != binaryFormatVersion
+                 || in.read<int64_t>() != getHEARTFormatVersion())
+                fail();
+
+            readStringDictionary();
+
+            auto numModules = in.readCount();
+
+            for (size_t i = 0; i < numModules; ++i)
+            {
+                auto moduleType = in.read<uint8_t>();
+
+                auto& m = moduleType == 0 ? program.addProcessor()
+                        : moduleType == 1 ? program.addGraph()
+                        : moduleType == 2 ? program.addNamespace()
+                        : (fail(), program.addNamespace());
+
+                m.shortName = in.readString();
+                m.fullName = in.readString();
+                m.originalFullName = in.readString();
+            }
+
+            readStructs();
+            readConstantTable();
+
+            for (auto& m : program.getModules())
+                readModuleContents (m);
+
+            for (auto& m : program.getModules())
+            {
+                auto numFunctions = in.readCount();
+
+                for (size_t i = 0; i < numFunctions; ++i)
+                    readFunctionDeclaration (m);
+            }
+
+            for (auto& m : program.getModules())
+            {
+                for (auto& f : m->functions)
+                    readFunctionBody (m, f);
+
+                m->rebuildBlockPredecessors();
+            }
+        }
+
+        void readStringDictionary()
+        {
+            auto& dictionary = program.getStringDictionary();
+            auto numStrings = in.readCount();
+
+            for (size_t i = 0; i < numStrings; ++i)
+            {
+                auto handle = in.read<uint32_t>();
+                auto text = in.readString();
+
+                // The dictionary allocates handles sequentially, so re-adding the
+                // strings in their original order must reproduce the stored handles
+                if (dictionary.getHandleForString (text).handle != handle)
+                    fail();
+            }
+        }
+
+        void readConstantTable()
+        {
+            auto& table = program.getConstantTable();
+            auto numItems = in.readCount();
+
+            for (size_t i = 0; i < numItems; ++i)
+            {
+                auto handle = static_cast<ConstantTable::Handle> (in.read<int64_t>());
+
+                if (in.readBool())
+                {
+                    // The item is a subrange of a previously-read parent item
+                    auto parentHandle = static_cast<ConstantTable::Handle> (in.read<int64_t>());
+                    auto start = in.readCount();
+                    auto num = in.readCount();
+                    auto parent = table.getValueForHandle (parentHandle);
+
+                    if (parent == nullptr
+                         || ! parent->getType().isFixedSizeArray()
+                         || start + num > parent->getType().getArraySize())
+                        fail();
+
+                    table.addItem ({ handle, std::make_unique<Value> (parent->getSlice (start, start + num)) });
+                }
+                else
+                {
+                    table.addItem ({ handle, std::make_unique<Value> (readValue()) });
+                }
+            }
+        }
+
+        void readStructs()
+        {
+            auto numStructs = in.readCount();
+
+            for (size_t i = 0; i < numStructs; ++i)
+            {
+                auto moduleIndex = in.readIndex (program.getModules().size());
+                auto& m = program.getModules()[moduleIndex].get();
+                structures.push_back (StructurePtr (std::addressof (m.addStruct (in.readString()))));
+            }
+
+            for (auto& s : structures)
+            {
+                auto numMembers = in.readCount();
+
+                for (size_t i = 0; i < numMembers; ++i)
+                {
+                    auto type = readType();
+                    s->addMember (std::move (type), in.readString());
+                }
+            }
+        }
+
+        void readModuleContents (Module& m)
+        {
+            readAnnotation (m.annotation);
+            m.sampleRate = in.read<double>();
+            m.latency = in.read<uint32_t>();
+
+            auto numInputs = in.readCount();
+
+            for (size_t i = 0; i < numInputs; ++i)
+            {
+                auto& io = m.allocate<heart::InputDeclaration> (CodeLocation());
+                readIODeclaration (io);
+                m.inputs.push_back (io);
+            }
+
+            auto numOutputs = in.readCount();
+
+            for (size_t i = 0; i < numOutputs; ++i)
+            {
+                auto& io = m.allocate<heart::OutputDeclaration> (CodeLocation());
+                readIODeclaration (io);
+                m.outputs.push_back (io);
+            }
+
+            auto numInstances = in.readCount();
+
+            for (size_t i = 0; i < numInstances; ++i)
+            {
+                auto& p = m.allocate<heart::ProcessorInstance>();
+                p.instanceName = in.readString();
+                p.sourceName = in.readString();
+                p.clockMultiplier = in.read<int64_t>();
+                p.clockDivider = in.read<int64_t>();
+                p.arraySize = in.read<uint32_t>();
+                p.renderStage = in.read<uint32_t>();
+                m.processorInstances.push_back (p);
+            }
+
+            auto numConnections = in.readCount();
+
+            for (size_t i = 0; i < numConnections; ++i)
+            {
+                auto& c = m.allocate<heart::Connection> (CodeLocation());
+                readEndpointReference (m, c.source);
+                readEndpointReference (m, c.dest);
+                c.interpolationType = static_cast<InterpolationType> (in.read<uint8_t>());
+                c.delayLength = in.read<int64_t>();
+                m.connections.push_back (c);
+            }
+
+            auto numStateVariables = in.readCount();
+
+            for (size_t i = 0; i < numStateVariables; ++i)
+                m.stateVariables.push_back (readVariableDeclaration (m));
+        }
+
+        void readIODeclaration (heart::IODeclaration& io)
+        {
+            io.name = program.getAllocator().get (in.readString());
+            io.index = in.read<uint32_t>();
+            io.endpointType = static_cast<EndpointType> (in.read<uint8_t>());
+
+            auto numTypes = in.readCount();
+
+            for (size_t i = 0; i < numTypes; ++i)
+                io.dataTypes.push_back (readType());
+
+            if (in.readBool())
+                io.arraySize = in.read<uint32_t>();
+
+            readAnnotation (io.annotation);
+        }
+
+        void readEndpointReference (Module& m, heart::EndpointReference& ref)
+        {
+            auto processorIndex = in.read<uint32_t>();
+
+            if (processorIndex != 0)
+            {
+                if (processorIndex > m.processorInstances.size())
+                    fail();
+
+                ref.processor = m.processorInstances[processorIndex - 1];
+            }
+
+            ref.endpointName = in.readString();
+
+            if (in.readBool())
+                ref.endpointIndex = static_cast<size_t> (in.read<uint64_t>());
+        }
+
+        heart::Variable& readVariableDeclaration (Module& m)
+        {
+            auto role = static_cast<heart::Variable::Role> (in.read<uint8_t>());
+
+            if (role > heart::Variable::Role::external)
+                fail();
+
+            auto type = readType();
+            Identifier name;
+
+            if (in.readBool())
+                name = program.getAllocator().get (in.readString());
+
+            auto& v = name.isValid() ? m.allocate<heart::Variable> (CodeLocation(), std::move (type), name, role)
+                                     : m.allocate<heart::Variable> (CodeLocation(), std::move (type), role);
+
+            readAnnotation (v.annotation);
+            v.externalHandle = static_cast<ConstantTable::Handle> (in.read<int64_t>());
+            variables.push_back (v);
+            return v;
+        }
+
+        void readFunctionDeclaration (Module& m)
+        {
+            auto& f = m.allocate<heart::Function>();
+            f.name = program.getAllocator().get (in.readString());
+            f.returnType = readType();
+
+            auto functionType = in.read<uint8_t>();
+
+            if (functionType > static_cast<uint8_t> (heart::FunctionType::Type::intrinsic))
+                fail();
+
+            f.functionType.type = static_cast<heart::FunctionType::Type> (functionType);
+            f.intrinsicType = static_cast<IntrinsicType> (in.read<int32_t>());
+            readAnnotation (f.annotation);
+            f.isExported = in.readBool();
+            f.hasNoBody = in.readBool();
+
+            m.functions.push_back (f);
+            functions.push_back (f);
+        }
+
+        void readFunctionBody (Module& m, heart::Function& f)
+        {
+            auto numLocalVariables = in.readCount();
+
+            for (size_t i = 0; i < numLocalVariables; ++i)
+                readVariableDeclaration (m);
+
+            auto numParameters = in.readCount();
+
+            for (size_t i = 0; i < numParameters; ++i)
+                f.parameters.push_back (readVariableReference());
+
+            if (in.readBool())  f.stateParameter = readVariableReference();
+            if (in.readBool())  f.ioParameter = readVariableReference();
+
+            std::vector<pool_ref<heart::Block>> blocks;
+            auto numBlocks = in.readCount();
+
+            for (size_t i = 0; i < numBlocks; ++i)
+            {
+                auto name = in.readString();
+
+                if (name.empty() || name[0] != '@')
+                    fail();
+
+                auto& b = m.allocate<heart::Block> (program.getAllocator().get (name));
+                blocks.push_back (b);
+                f.blocks.push_back (b);
+            }
+
+            for (auto& b : blocks)
+            {
+                b->doNotOptimiseAway = in.readBool();
+
+                auto numBlockParams = in.readCount();
+
+                for (size_t i = 0; i < numBlockParams; ++i)
+                    b->parameters.push_back (readVariableReference());
+
+                auto numStatements = in.readCount();
+                LinkedList<heart::Statement>::Iterator last;
+
+                for (size_t i = 0; i < numStatements; ++i)
+                {
+                    auto& s = readStatement (m);
+
+                    if (last == nullptr)
+                        b->statements.append (s);
+                    else
+                        last.insertAfter (s);
+
+                    last = s;
+                }
+
+                b->terminator = readTerminator (m, blocks);
+            }
+        }
+
+        heart::Statement& readStatement (Module& m)
+        {
+            switch (in.read<StatementCode>())
+            {
+                case StatementCode::assignFromValue:
+                {
+                    auto& target = readExpression (m);
+                    auto& source = readExpression (m);
+                    return m.allocateStatement<heart::AssignFromValue> (CodeLocation(), target, source);
+                }
+
+                case StatementCode::functionCall:
+                {
+                    auto target = readNullableExpression (m);
+                    auto& fn = readFunctionReference();
+                    auto& call = m.allocateStatement<heart::FunctionCall> (CodeLocation(), target, fn);
+                    auto numArgs = in.readCount();
+
+                    for (size_t i = 0; i < numArgs; ++i)
+                        call.arguments.push_back (readExpression (m));
+
+                    return call;
+                }
+
+                case StatementCode::readStream:
+                {
+                    auto& target = readExpression (m);
+                    auto inputIndex = in.readIndex (m.inputs.size());
+                    auto& r = m.allocateStatement<heart::ReadStream> (CodeLocation(), target, m.inputs[inputIndex]);
+                    r.element = readNullableExpression (m);
+                    return r;
+                }
+
+                case StatementCode::writeStream:
+                {
+                    auto outputIndex = in.readIndex (m.outputs.size());
+                    auto element = readNullableExpression (m);
+                    auto& value = readExpression (m);
+                    return m.allocateStatement<heart::WriteStream> (CodeLocation(), m.outputs[outputIndex], element, value);
+                }
+
+                case StatementCode::advanceClock:
+                    return m.allocateStatement<heart::AdvanceClock> (CodeLocation());
+
+                default:
+                    fail();
+            }
+        }
+
+        heart::Terminator& readTerminator (Module& m, const std::vector<pool_ref<heart::Block>>& blocks)
+        {
+            auto readBlockReference = [&] () -> heart::Block&
+            {
+                return blocks[in.readIndex (blocks.size())];
+            };
+
+            switch (in.read<TerminatorCode>())
+            {
+                case TerminatorCode::branch:
+                {
+                    auto& b = m.allocateStatement<heart::Branch> (readBlockReference());
+                    auto numArgs = in.readCount();
+
+                    for (size_t i = 0; i < numArgs; ++i)
+                        b.targetArgs.push_back (readExpression (m));
+
+                    return b;
+                }
+
+                case TerminatorCode::branchIf:
+                {
+                    auto& condition = readExpression (m);
+                    auto& trueBlock = readBlockReference();
+                    auto& falseBlock = readBlockReference();
+
+                    if (std::addressof (trueBlock) == std::addressof (falseBlock))
+                        fail();
+
+                    auto& b = m.allocateStatement<heart::BranchIf> (condition, trueBlock, falseBlock);
+
+                    for (auto& args : b.targetArgs)
+                    {
+                        auto numArgs = in.readCount();
+
+                        for (size_t i = 0; i < numArgs; ++i)
+                            args.push_back (readExpression (m));
+                    }
+
+                    auto likelihood = in.read<uint8_t>();
+
+                    if (likelihood > static_cast<uint8_t> (heart::BranchIf::Likelihood::likelyFalse))
+                        fail();
+
+                    b.likelihood = static_cast<heart::BranchIf::Likelihood> (likelihood);
+                    return b;
+                }
+
+                case TerminatorCode::returnVoid:
+                    return m.allocateStatement<heart::ReturnVoid>();
+
+                case TerminatorCode::returnValue:
+                    return m.allocateStatement<heart::ReturnValue> (readExpression (m));
+
+                default:
+                    fail();
+            }
+        }
+
+        heart::Expression& readExpression (Module& m)
+        {
+            switch (in.read<ExpressionCode>())
+            {
+                case ExpressionCode::constant:
+                    return m.allocate<heart::Constant> (CodeLocation(), readValue());
+
+                case ExpressionCode::variable:
+                    return readVariableReference();
+
+                case ExpressionCode::arrayElement:
+                {
+                    auto& parent = readExpression (m);
+
+                    if (! parent.getType().isArrayOrVector())
+                        fail();
+
+                    pool_ptr<heart::ArrayElement> element;
+
+                    if (in.readBool())
+                    {
+                        auto& index = readExpression (m);
+                        element = m.allocate<heart::ArrayElement> (CodeLocation(), parent, index);
+                    }
+                    else
+                    {
+                        auto start = static_cast<size_t> (in.read<uint64_t>());
+                        auto end = static_cast<size_t> (in.read<uint64_t>());
+                        element = m.allocate<heart::ArrayElement> (CodeLocation(), parent, start, end);
+                    }
+
+                    element->isRangeTrusted = in.readBool();
+                    element->suppressWrapWarning = in.readBool();
+                    return *element;
+                }
+
+                case ExpressionCode::structElement:
+                {
+                    auto& parent = readExpression (m);
+                    auto memberName = in.readString();
+
+                    if (! (parent.getType().isStruct() && parent.getType().getStructRef().hasMemberWithName (memberName)))
+                        fail();
+
+                    return m.allocate<heart::StructElement> (CodeLocation(), parent, std::move (memberName));
+                }
+
+                case ExpressionCode::typeCast:
+                {
+                    auto& source = readExpression (m);
+                    return m.allocate<heart::TypeCast> (CodeLocation(), source, readType());
+                }
+
+                case ExpressionCode::unaryOp:
+                {
+                    auto& source = readExpression (m);
+                    auto op = static_cast<UnaryOp::Op> (in.read<uint8_t>());
+                    return m.allocate<heart::UnaryOperator> (CodeLocation(), source, op);
+                }
+
+                case ExpressionCode::binaryOp:
+                {
+                    auto& lhs = readExpression (m);
+                    auto& rhs = readExpression (m);
+                    auto op = static_cast<BinaryOp::Op> (in.read<uint8_t>());
+                    return m.allocate<heart::BinaryOperator> (CodeLocation(), lhs, rhs, op);
+                }
+
+                case ExpressionCode::pureFunctionCall:
+                {
+                    auto& call = m.allocate<heart::PureFunctionCall> (CodeLocation(), readFunctionReference());
+                    auto numArgs = in.readCount();
+
+                    for (size_t i = 0; i < numArgs; ++i)
+                        call.arguments.push_back (readExpression (m));
+
+                    return call;
+                }
+
+                case ExpressionCode::processorProperty:
+                {
+                    auto property = in.read<uint8_t>();
+
+                    if (property > static_cast<uint8_t> (heart::ProcessorProperty::Property::latency))
+                        fail();
+
+                    return m.allocate<heart::ProcessorProperty> (CodeLocation(),
+                                                                 static_cast<heart::ProcessorProperty::Property> (property));
+                }
+
+                default:
+                    fail();
+            }
+        }
+
+        pool_ptr<heart::Expression> readNullableExpression (Module& m)
+        {
+            if (in.readBool())
+                return readExpression (m);
+
+            return {};
+        }
+
+        heart::Variable& readVariableReference()
+        {
+            return *variables[in.readIndex (variables.size())];
+        }
+
+        heart::Function& readFunctionReference()
+        {
+            return *functions[in.readIndex (functions.size())];
+        }
+
+        Type readType()
+        {
+            auto flags = in.read<uint8_t>();
+
+            if (flags > 3)
+                fail();
+
+            auto type = readTypeWithoutFlags();
+            return type.withConstAndRefFlags ((flags & 1) != 0, (flags & 2) != 0);
+        }
+
+        Type readTypeWithoutFlags()
+        {
+            auto code = in.read<TypeCode>();
+
+            switch (code)
+            {
+                case TypeCode::invalid:
+                    return {};
+
+                case TypeCode::primitive:
+                    return Type (readPrimitiveType());
+
+                case TypeCode::vector:
+                {
+                    auto primitive = readPrimitiveType();
+                    auto size = in.read<uint32_t>();
+
+                    if (! (Type::isLegalVectorSize (static_cast<int64_t> (size)) && Type (primitive).canBeVectorElementType()))
+                        fail();
+
+                    return Type::createVector (primitive, size);
+                }
+
+                case TypeCode::array:
+                {
+                    auto elementType = readTypeWithoutFlags();
+                    auto size = in.read<uint32_t>();
+
+                    if (! elementType.canBeArrayElementType())
+                        fail();
+
+                    if (size == 0)
+                        return elementType.createUnsizedArray();
+
+                    if (size > Type::maxArraySize)
+                        fail();
+
+                    return elementType.createArray (size);
+                }
+
+                case TypeCode::wrap:
+                case TypeCode::clamp:
+                {
+                    auto limit = in.read<Type::BoundedIntSize>();
+
+                    if (! Type::isLegalBoundedIntSize (limit))
+                        fail();
+
+                    return code == TypeCode::wrap ? Type::createWrappedInt (limit)
+                                                  : Type::createClampedInt (limit);
+                }
+
+                case TypeCode::structure:
+                    return Type::createStruct (*structures[in.readIndex (structures.size())]);
+
+                case TypeCode::stringLiteral:
+                    return Type::createStringLiteral();
+
+                default:
+                    fail();
+            }
+        }
+
+        PrimitiveType readPrimitiveType()
+        {
+            auto primitive = in.read<uint8_t>();
+
+            if (primitive > PrimitiveType::float16)
+                fail();
+
+            return static_cast<PrimitiveType::Primitive> (primitive);
+        }
+
+        Value readValue()
+        {
+            auto type = readType();
+
+            if (! type.isValid())
+                fail();
+
+            auto size = in.readCount();
+            auto value = Value::zeroInitialiser (type);
+
+            if (size != value.getPackedDataSize())
+                fail();
+
+            in.readBytes (value.getPackedData(), size);
+            return value;
+        }
+
+        void readAnnotation (Annotation& a)
+        {
+            auto numProperties = in.readCount();
+
+            for (size_t i = 0; i < numProperties; ++i)
+            {
+                auto name = in.readString();
+
+                if (in.readBool())
+                    a.set (name, in.readString());
+                else
+                    a.set (name, readValue(), StringDictionary());
+            }
+        }
+    };
+};
+
+} // namespace soul
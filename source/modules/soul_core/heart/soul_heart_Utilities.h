@@ -234,7 +234,7 @@ struct heart::Utilities
     }
 
     //==============================================================================
-    static inline Block& insertBlock (Module& module, Function& f, size_t blockIndex, const std::string& name)
+    static inline Block& insertBlock (Module& module, Function& f, size_t blockIndex, std::string_view name)
     {
         SOUL_ASSERT (blockIndex <= f.blocks.size());
         auto& newBlock = module.allocate<Block> (module.allocator.get (name));
@@ -244,7 +244,7 @@ struct heart::Utilities
 
     static inline Block& splitBlock (Module& module, Function& f, size_t blockIndex,
                                      LinkedList<Statement>::Iterator lastStatementOfFirstBlock,
-                                     const std::string& newSecondBlockName)
+                                     std::string_view newSecondBlockName)
     {
         auto& oldBlock = f.blocks[blockIndex].get();
         auto& newBlock = insertBlock (module, f, blockIndex + 1, newSecondBlockName);
@@ -456,6 +456,418 @@ struct heart::Utilities
         static std::string getProcessorName (const heart::ProcessorInstance& p)  { return p.instanceName; }
         static const CodeLocation& getContext (const heart::Connection& c)       { return c.location; }
     };
+
+    //==============================================================================
+    /** Assigns a renderStage index to every processor instance in a graph module.
+
+        The stages form a topological layering of the connection graph: an instance's
+        stage is one greater than the latest stage among the instances feeding it, so
+        all the instances that share a stage are mutually independent of each other.
+        A multi-threaded engine can therefore render the members of a stage concurrently,
+        and only needs a handoff between the worker threads at each stage boundary.
+        Connections with a delay don't impose an ordering, because their data is
+        always read at least a block late.
+
+        The graph must already have been checked for feedback cycles.
+        Returns the total number of stages that were assigned.
+    */
+    static uint32_t assignParallelRenderStages (Module& graph)
+    {
+        SOUL_ASSERT (graph.isGraph());
+
+        for (auto& p : graph.processorInstances)
+            p->renderStage = 0;
+
+        // Being acyclic, repeatedly pushing each destination one stage beyond its
+        // sources must reach a fixed point within processorInstances.size() sweeps
+        for (;;)
+        {
+            bool anyChanges = false;
+
+            for (auto& c : graph.connections)
+            {
+                if (c->delayLength != 0 || c->source.processor == nullptr || c->dest.processor == nullptr)
+                    continue;
+
+                if (c->source.processor == c->dest.processor)
+                    continue;
+
+                auto requiredStage = c->source.processor->renderStage + 1;
+
+                if (c->dest.processor->renderStage < requiredStage)
+                {
+                    c->dest.processor->renderStage = requiredStage;
+                    anyChanges = true;
+                }
+            }
+
+            if (! anyChanges)
+                break;
+        }
+
+        uint32_t numStages = 0;
+
+        for (auto& p : graph.processorInstances)
+            numStages = std::max (numStages, p->renderStage + 1);
+
+        return numStages;
+    }
+
+    //==============================================================================
+    /** Describes a processor-instance array which qualifies for data-parallel
+        offload. @see findOffloadableArrays
+    */
+    struct OffloadableArray
+    {
+        pool_ref<heart::ProcessorInstance> instance;
+        pool_ref<Module> processor;
+    };
+
+    /** Finds the processor-instance arrays in a graph which an engine could
+        hand to an OffloadBackend.
+
+        An array qualifies when every instance runs the same processor in
+        lockstep with the graph's clock and a whole block can be rendered with
+        no mid-block host interaction: the instance must have no clock
+        multiplier or divider, and the processor may only expose stream and
+        value endpoints - an event endpoint would need servicing at arbitrary
+        frame offsets inside a block, which is exactly the interaction that a
+        block-granularity transfer model can't afford. Nested graphs are left
+        on the CPU path, as their internal scheduling doesn't flatten into a
+        single kernel.
+
+        The size threshold keeps small arrays on the CPU, where the fixed cost
+        of a round-trip transfer would outweigh the parallel win.
+    */
+    static std::vector<OffloadableArray> findOffloadableArrays (Module& graph, uint32_t minimumArraySize = 16)
+    {
+        SOUL_ASSERT (graph.isGraph());
+        std::vector<OffloadableArray> results;
+
+        for (auto& instance : graph.processorInstances)
+        {
+            if (instance->arraySize < minimumArraySize)
+                continue;
+
+            if (instance->hasClockMultiplier() || instance->hasClockDivider())
+                continue;
+
+            auto source = graph.program.findModuleWithName (instance->sourceName);
+
+            if (source == nullptr || ! source->isProcessor())
+                continue;
+
+            auto hasEventEndpoints = false;
+
+            for (auto& i : source->inputs)
+                hasEventEndpoints = hasEventEndpoints || i->isEventEndpoint();
+
+            for (auto& o : source->outputs)
+                hasEventEndpoints = hasEventEndpoints || o->isEventEndpoint();
+
+            if (hasEventEndpoints)
+                continue;
+
+            results.push_back ({ instance, pool_ref<Module> (*source) });
+        }
+
+        return results;
+    }
+
+    //==============================================================================
+    /** Assigns every stream connection in a graph to a slot in a shared pool of
+        intermediate block buffers.
+
+        One buffer per connection makes a mid-size graph's working set far larger
+        than what is ever live at once: a connection's data is only alive from the
+        render stage that writes it to the stage that reads it. Treating those
+        stage ranges as lifetimes and running the linear scan that register
+        allocators use lets connections whose lifetimes don't overlap share a
+        slot, provided they carry the same frame type - so an engine which sizes
+        its buffer pool by slot instead of by connection keeps the working set
+        close to the graph's true high-water mark.
+
+        Connections to or from the graph's own endpoints use the session's
+        endpoint buffers, and delayed connections need a persistent delay line,
+        so neither takes a slot. Render stages must already have been assigned.
+        Returns the number of slots the pool needs.
+    */
+    static uint32_t assignConnectionBufferSlots (Program& program, Module& graph)
+    {
+        SOUL_ASSERT (graph.isGraph());
+
+        // type keys are short enough that the builder's inline storage keeps
+        // them off the heap for typical graphs
+        using TypeKey = StringBuilderWithPreallocation<128>;
+
+        struct Candidate
+        {
+            heart::Connection* connection;
+            uint32_t firstStage, lastStage;
+            TypeKey typeKey;
+        };
+
+        std::vector<Candidate> candidates;
+
+        for (auto& c : graph.connections)
+        {
+            c->bufferSlot = heart::Connection::noBufferSlot;
+
+            if (c->delayLength != 0 || c->source.processor == nullptr || c->dest.processor == nullptr)
+                continue;
+
+            auto sourceModule = program.findModuleWithName (c->source.processor->sourceName);
+
+            if (sourceModule == nullptr)
+                continue;
+
+            auto output = sourceModule->findOutput (c->source.endpointName);
+
+            if (output == nullptr || ! output->isStreamEndpoint())
+                continue;
+
+            TypeKey typeKey;
+            typeKey.append (static_cast<int64_t> (c->source.processor->arraySize));
+
+            for (auto& t : output->dataTypes)
+                typeKey.append ('/').append (program.getFullyQualifiedTypeDescription (t));
+
+            candidates.push_back ({ c.getPointer(),
+                                    c->source.processor->renderStage,
+                                    c->dest.processor->renderStage,
+                                    std::move (typeKey) });
+        }
+
+        std::stable_sort (candidates.begin(), candidates.end(),
+                          [] (const Candidate& a, const Candidate& b) { return a.firstStage < b.firstStage; });
+
+        struct Slot
+        {
+            uint32_t lastStage;
+            TypeKey typeKey;
+        };
+
+        std::vector<Slot> slots;
+
+        for (auto& candidate : candidates)
+        {
+            uint32_t chosen = heart::Connection::noBufferSlot;
+
+            // A slot can be taken over once its last reader's stage is strictly
+            // earlier than this connection's writer, and only for the same type
+            for (uint32_t i = 0; i < slots.size(); ++i)
+            {
+                if (slots[i].lastStage < candidate.firstStage && slots[i].typeKey == candidate.typeKey)
+                {
+                    chosen = i;
+                    break;
+                }
+            }
+
+            if (chosen == heart::Connection::noBufferSlot)
+            {
+                chosen = static_cast<uint32_t> (slots.size());
+                slots.push_back ({ candidate.lastStage, candidate.typeKey });
+            }
+            else
+            {
+                slots[chosen].lastStage = candidate.lastStage;
+            }
+
+            candidate.connection->bufferSlot = chosen;
+        }
+
+        return static_cast<uint32_t> (slots.size());
+    }
+
+    //==============================================================================
+    /** A process-wide cache of link-time graph schedules, keyed by a signature of
+        the connection topology.
+
+        Session reloads mostly relink programs whose wiring is identical but whose
+        parameter values differ, and for those the per-graph analysis - the feedback
+        cycle check and the parallel render-stage layering - comes out the same
+        every time. Each entry records the stage assignment for a topology that has
+        been analysed before, so a structurally unchanged graph has its schedule
+        replayed instead of re-derived, and the cycle check can be skipped because
+        a cached topology has already passed it. Guarded by a lock, since linking
+        never happens on a render thread.
+    */
+    struct GraphTopologyCache
+    {
+        static GraphTopologyCache& get()
+        {
+            static GraphTopologyCache cache;
+            return cache;
+        }
+
+        /** Returns a signature covering everything the schedule depends on: the
+            instances in declaration order, their sources, array sizes and clock
+            ratios, and every connection's endpoints and delay. The code inside
+            the processors doesn't affect it.
+        */
+        static std::string getTopologySignature (const Module& graph)
+        {
+            SOUL_ASSERT (graph.isGraph());
+            HashBuilder hash;
+
+            for (auto& p : graph.processorInstances)
+                hash << p->instanceName << '/' << p->sourceName << '/'
+                     << static_cast<int64_t> (p->arraySize) << '/'
+                     << static_cast<int64_t> (p->clockMultiplier) << '/'
+                     << static_cast<int64_t> (p->clockDivider) << ';';
+
+            for (auto& c : graph.connections)
+            {
+                auto describeEnd = [&hash] (const heart::EndpointReference& e)
+                {
+                    if (e.processor != nullptr)
+                        hash << e.processor->instanceName;
+
+                    hash << '.' << e.endpointName;
+
+                    if (e.endpointIndex.has_value())
+                        hash << static_cast<int64_t> (*e.endpointIndex);
+                };
+
+                describeEnd (c->source);
+                hash << '>';
+                describeEnd (c->dest);
+                hash << '/' << static_cast<int64_t> (c->delayLength) << ';';
+            }
+
+            return hash.toString();
+        }
+
+        /** True if a graph with this signature has been analysed before, which
+            also means that its cycle check passed. @see heart::Checker
+        */
+        bool isKnownAcyclic (const std::string& signature)
+        {
+            std::lock_guard<std::mutex> l (lock);
+            return acyclicSignatures.find (signature) != acyclicSignatures.end()
+                    || schedules.find (signature) != schedules.end();
+        }
+
+        void recordAcyclic (const std::string& signature)
+        {
+            std::lock_guard<std::mutex> l (lock);
+            acyclicSignatures.insert (signature);
+        }
+
+        /** Replays a cached render-stage layering onto the graph if its topology
+            has been scheduled before, or derives one and caches it. Returns the
+            number of stages. @see assignParallelRenderStages
+        */
+        uint32_t assignRenderStages (Module& graph)
+        {
+            auto signature = getTopologySignature (graph);
+
+            {
+                std::lock_guard<std::mutex> l (lock);
+                auto cached = schedules.find (signature);
+
+                if (cached != schedules.end()
+                     && cached->second.stages.size() == graph.processorInstances.size())
+                {
+                    size_t i = 0;
+
+                    for (auto& p : graph.processorInstances)
+                        p->renderStage = cached->second.stages[i++];
+
+                    return cached->second.numStages;
+                }
+            }
+
+            auto numStages = assignParallelRenderStages (graph);
+
+            CachedSchedule schedule;
+            schedule.numStages = numStages;
+            schedule.stages.reserve (graph.processorInstances.size());
+
+            for (auto& p : graph.processorInstances)
+                schedule.stages.push_back (p->renderStage);
+
+            std::lock_guard<std::mutex> l (lock);
+            schedules[signature] = std::move (schedule);
+            return numStages;
+        }
+
+    private:
+        struct CachedSchedule
+        {
+            std::vector<uint32_t> stages;   // one per instance, in declaration order
+            uint32_t numStages = 0;
+        };
+
+        std::mutex lock;
+        std::unordered_map<std::string, CachedSchedule> schedules;
+        std::unordered_set<std::string> acyclicSignatures;
+    };
+
+    //==============================================================================
+    /** Specialises the program for the sample rate that the venue declared at link time.
+
+        The rate is propagated from the main processor down through each graph's clock
+        multipliers, and any module whose resulting rate is unambiguous has its
+        processor.frequency and processor.period expressions folded to constants, which
+        lets the downstream optimisation passes treat rate-derived coefficients as
+        compile-time values. A module that's instantiated at more than one rate is
+        left untouched, as are the id/session/latency properties, which can change
+        after linking.
+    */
+    static void specialiseProcessorProperties (Program& program, double mainSampleRate)
+    {
+        if (mainSampleRate <= 0)
+            return;
+
+        std::unordered_map<Module*, double> rates;
+        std::unordered_set<Module*> ambiguousModules;
+
+        std::function<void(Module&, double)> propagateRate = [&] (Module& m, double rate)
+        {
+            auto existing = rates.find (std::addressof (m));
+
+            if (existing != rates.end())
+            {
+                if (existing->second != rate)
+                    ambiguousModules.insert (std::addressof (m));
+
+                return;
+            }
+
+            rates[std::addressof (m)] = rate;
+
+            if (m.isGraph())
+                for (auto& instance : m.processorInstances)
+                    if (auto sub = program.findModuleWithName (instance->sourceName))
+                        propagateRate (*sub, rate * instance->getClockRatio());
+        };
+
+        propagateRate (program.getMainProcessor(), mainSampleRate);
+
+        for (auto& m : program.getModules())
+        {
+            auto rate = rates.find (m.getPointer());
+
+            if (rate == rates.end() || ambiguousModules.find (m.getPointer()) != ambiguousModules.end())
+                continue;
+
+            m->sampleRate = rate->second;
+
+            for (auto& f : m->functions)
+                f->visitExpressions ([&] (pool_ref<heart::Expression>& value, AccessType)
+                {
+                    if (auto pp = cast<heart::ProcessorProperty> (value))
+                    {
+                        if (pp->property == heart::ProcessorProperty::Property::frequency)
+                            value = m->allocate<heart::Constant> (pp->location, Value (rate->second));
+                        else if (pp->property == heart::ProcessorProperty::Property::period)
+                            value = m->allocate<heart::Constant> (pp->location, Value (1.0 / rate->second));
+                    }
+                });
+        }
+    }
 };
 
 }
@@ -27,11 +27,13 @@ namespace soul
 */
 static inline CodeLocation getDefaultLibraryCode()
 {
-    return SourceCodeText::createInternal ("SOUL built-in library",
-                                           #include "soul_library_intrinsics.h"
-                                           #include "soul_library_trig.h"
-                                           );
-
+    // SourceCodeText is immutable and refcounted, so one copy of the library
+    // source is shared read-only by every compilation in the process
+    static const SourceCodeText::Ptr code = SourceCodeText::createInternal ("SOUL built-in library",
+                                                                            #include "soul_library_intrinsics.h"
+                                                                            #include "soul_library_trig.h"
+                                                                            );
+    return CodeLocation (code);
 }
 
 static inline const char* getSystemModuleCode (const std::string& moduleName)
@@ -64,13 +66,32 @@ static inline const char* getSystemModuleCode (const std::string& moduleName)
         #include "soul_library_noise.h"
         ;
 
+    if (moduleName == "soul.timeline") return
+        #include "soul_library_timeline.h"
+        ;
+
     return nullptr;
 }
 
 static inline CodeLocation getSystemModule (const std::string& moduleName)
 {
-    if (auto code = getSystemModuleCode (moduleName))
-        return SourceCodeText::createInternal (moduleName, code);
+    // as with getDefaultLibraryCode(), each module's source is wrapped once per
+    // process and the immutable text shared across compilations
+    static const std::unordered_map<std::string, SourceCodeText::Ptr> cachedModules = []
+    {
+        std::unordered_map<std::string, SourceCodeText::Ptr> modules;
+
+        for (auto name : { "soul.audio.utils", "soul.midi", "soul.notes", "soul.frequency",
+                           "soul.mixing", "soul.oscillators", "soul.noise", "soul.timeline" })
+            modules[name] = SourceCodeText::createInternal (name, getSystemModuleCode (name));
+
+        return modules;
+    }();
+
+    auto found = cachedModules.find (moduleName);
+
+    if (found != cachedModules.end())
+        return CodeLocation (found->second);
 
     return {};
 }
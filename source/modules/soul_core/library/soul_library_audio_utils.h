@@ -100,6 +100,64 @@ namespace soul::pan_law
         return (sin ((1.0f - pan) * quarterPi),
                 sin ((1.0f + pan) * quarterPi));
     }
+
+    //==============================================================================
+    /** A mono-to-stereo panner which applies the centre3dB() constant-power law
+        using a table of gain pairs built once at startup.
+
+        Moving the pan position then costs a table lookup and a lerp between the
+        two nearest entries instead of two sin() calls, and the audio path itself
+        is a single multiply per channel - with hundreds of these in a session,
+        that's the difference that matters. A tableSize of 64 keeps the
+        interpolated gains within a fraction of a dB of the exact law.
+
+        Pan positions arrive as events in the range -1.0 (hard left) to
+        1.0 (hard right), and start at centre.
+    */
+    processor TablePanner (int tableSize)  [[ propagates_silence ]]
+    {
+        input  stream float in;
+        output stream float<2> out;
+        input  event float pan;   /**< Send these events to move the pan position (-1.0 to 1.0) */
+
+        event pan (float newPosition)
+        {
+            let scaled = (clamp (newPosition, -1.0f, 1.0f) * 0.5f + 0.5f) * float (tableSize - 1);
+            let index = int (scaled);
+            let frac = scaled - float (index);
+            let entry = wrap<tableSize> (index);
+            let next = wrap<tableSize> (min (index + 1, tableSize - 1));
+
+            gains = gainTable[entry] + (gainTable[next] - gainTable[entry]) * frac;
+        }
+
+        float<2>[tableSize] gainTable;
+        float<2> gains;
+
+        void initialiseGainTable()
+        {
+            wrap<tableSize> i;
+
+            loop (tableSize)
+            {
+                gainTable[i] = centre3dB (float (i) * (2.0f / float (tableSize - 1)) - 1.0f);
+                ++i;
+            }
+
+            gains = centre3dB (0.0f);
+        }
+
+        void run()
+        {
+            initialiseGainTable();
+
+            loop
+            {
+                out << gains * in;
+                advance();
+            }
+        }
+    }
 }
 
 /** This namespace contains delay related helper function */
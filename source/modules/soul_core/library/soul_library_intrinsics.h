@@ -75,6 +75,61 @@ namespace soul::intrinsics
     /** Rounds a floating point number up or down to the nearest integer. */
     int64 roundToInt (float64 n)    [[intrin: "roundToInt"]]                       { return int64 (n + (n < 0 ? -0.5 : 0.5)); }
 
+    /** Returns one of two values depending on a condition.
+
+        Unlike the ternary operator this is an ordinary function call, so both values
+        are always evaluated, and a backend is free to lower it to a branch-free
+        conditional-select instruction - useful in phase and clipping logic running
+        at audio rate, where a data-dependent branch is likely to mispredict.
+    */
+    T.removeReference select<T> (bool condition, T trueValue, T falseValue)  [[intrin: "select"]]
+    {
+        static_assert (T.isScalar, "select() only works with scalar types");
+        return condition ? trueValue : falseValue;
+    }
+
+    /** Returns the number of set bits in an integer value. */
+    int32 countbits (int32 n)  [[intrin: "countbits"]]
+    {
+        var v = n;
+        v = v - ((v >>> 1) & 0x55555555);
+        v = (v & 0x33333333) + ((v >>> 2) & 0x33333333);
+        return (((v + (v >>> 4)) & 0x0f0f0f0f) * 0x01010101) >>> 24;
+    }
+
+    /** Returns the number of set bits in an integer value. */
+    int32 countbits (int64 n)  [[intrin: "countbits"]]
+    {
+        return countbits (int32 (n)) + countbits (int32 (n >>> 32));
+    }
+
+    /** Returns the number of leading zero bits in an integer value, so clz (1) == 31,
+        and clz (0) is the full width of the type. */
+    int32 clz (int32 n)  [[intrin: "clz"]]
+    {
+        var v = n;
+        v |= v >>> 1;
+        v |= v >>> 2;
+        v |= v >>> 4;
+        v |= v >>> 8;
+        v |= v >>> 16;
+        return countbits (~v);
+    }
+
+    /** Returns the number of leading zero bits in an integer value, so clz (1L) == 63,
+        and clz (0L) is the full width of the type. */
+    int32 clz (int64 n)  [[intrin: "clz"]]
+    {
+        var v = n;
+        v |= v >>> 1;
+        v |= v >>> 2;
+        v |= v >>> 4;
+        v |= v >>> 8;
+        v |= v >>> 16;
+        v |= v >>> 32;
+        return countbits (~v);
+    }
+
     /** Returns true if the floating point argument is a NaN. */
     bool isnan<T> (T n)  [[intrin: "isnan"]]       { static_assert (T.isPrimitive && T.primitiveType.isFloat, "isnan() only works with floating point types"); return false; }
     /** Returns true if the floating point argument is an INF. */
@@ -223,6 +278,131 @@ namespace soul::intrinsics
         }
     }
 
+    /** Returns the smallest value in an array or vector of scalar values. */
+    T.elementType min<T> (T t)
+    {
+        static_assert (T.isArray || T.isVector, "min() only works with arrays or vectors");
+        static_assert (T.elementType.isPrimitive, "min() only works with arrays of primitive values");
+
+        if const (T.isFixedSizeArray || T.isVector)
+        {
+            var lowest = t[0];
+            wrap<t.size> i;
+
+            loop (t.size - 1)
+            {
+                let v = t[++i];
+
+                if (v < lowest)
+                    lowest = v;
+            }
+
+            return lowest;
+        }
+        else
+        {
+            if (t.size == 0)
+                return T.elementType();
+
+            var lowest = t[0];
+
+            for (int i = 1; i < t.size; ++i)
+            {
+                let v = t[i];
+
+                if (v < lowest)
+                    lowest = v;
+            }
+
+            return lowest;
+        }
+    }
+
+    /** Returns the largest value in an array or vector of scalar values. */
+    T.elementType max<T> (T t)
+    {
+        static_assert (T.isArray || T.isVector, "max() only works with arrays or vectors");
+        static_assert (T.elementType.isPrimitive, "max() only works with arrays of primitive values");
+
+        if const (T.isFixedSizeArray || T.isVector)
+        {
+            var highest = t[0];
+            wrap<t.size> i;
+
+            loop (t.size - 1)
+            {
+                let v = t[++i];
+
+                if (v > highest)
+                    highest = v;
+            }
+
+            return highest;
+        }
+        else
+        {
+            if (t.size == 0)
+                return T.elementType();
+
+            var highest = t[0];
+
+            for (int i = 1; i < t.size; ++i)
+            {
+                let v = t[i];
+
+                if (v > highest)
+                    highest = v;
+            }
+
+            return highest;
+        }
+    }
+
+    /** Returns the root-mean-square of an array or vector of floating point values.
+
+        The sum of squares is a chain of independent multiply-adds, so for vectors
+        it goes through sum()'s balanced tree, which a backend can lower to wide
+        FMA lanes rather than one serial dependency chain.
+    */
+    T.elementType rms<T> (T t)  [[intrin: "rms"]]
+    {
+        static_assert (T.isArray || T.isVector, "rms() only works with arrays or vectors");
+        static_assert (T.elementType.isScalar && T.elementType.primitiveType.isFloat, "rms() only works with arrays of floating point values");
+
+        if const (T.isVector)
+        {
+            return sqrt (sum (t * t) / T.elementType (t.size));
+        }
+        else if const (T.isFixedSizeArray)
+        {
+            var total = t[0] * t[0];
+            wrap<t.size> i;
+
+            loop (t.size - 1)
+            {
+                let v = t[++i];
+                total += v * v;
+            }
+
+            return sqrt (total / T.elementType (t.size));
+        }
+        else
+        {
+            if (t.size == 0)
+                return T.elementType();
+
+            var total = t[0] * t[0];
+
+            for (int i = 1; i < t.size; ++i)
+            {
+                let v = t[i];
+                total += v * v;
+            }
+
+            return sqrt (total / T.elementType (t.size));
+        }
+    }
+
     /** Reads an element from an array, allowing the index to be any type of floating point type.
         If a floating point index is used, it will be rounded down to an integer index - for an
         interpolated read operation, see readLinearInterpolated(). Indexes beyond the range of the
@@ -259,6 +439,101 @@ namespace soul::intrinsics
         return sample1 + (sample2 - sample1) * Array.elementType (index - IndexType (intIndex));
     }
 
+    /** Performs a real forward FFT from an input buffer to an output buffer.
+
+        The input is a power-of-two number of real samples, and the output packs the
+        spectrum as [real parts, imaginary parts], matching soul::DFT::forward().
+        The body here is a plain O(N^2) transform: a performer back-end is expected
+        to substitute an optimised native FFT kernel for it.
+    */
+    void fft<SampleBuffer> (const SampleBuffer& inputData, SampleBuffer& outputData)  [[intrin: "fft"]]
+    {
+        static_assert (SampleBuffer.isFixedSizeArray || SampleBuffer.isVector, "The buffers for fft() must be fixed size arrays");
+        static_assert (SampleBuffer.elementType.isFloat && SampleBuffer.elementType.isPrimitive, "The element type for fft() must be floating point");
+
+        let harmonics = inputData.size / 2;
+
+        SampleBuffer inputImag, outputReal, outputImag;
+
+        performComplexFourier (inputData, inputImag, outputReal, outputImag, 1.0f / float (harmonics));
+
+        outputData[0:harmonics]             = outputReal[0:harmonics];
+        outputData[harmonics:harmonics * 2] = outputImag[0:harmonics];
+    }
+
+    /** Performs a real inverse FFT from an input buffer to an output buffer.
+
+        The input spectrum is packed as [real parts, imaginary parts], matching the
+        output of fft(). As with fft(), the O(N^2) body is only a fallback for
+        engines with no native kernel.
+    */
+    void ifft<SampleBuffer> (const SampleBuffer& inputData, SampleBuffer& outputData)  [[intrin: "ifft"]]
+    {
+        static_assert (SampleBuffer.isFixedSizeArray || SampleBuffer.isVector, "The buffers for ifft() must be fixed size arrays");
+        static_assert (SampleBuffer.elementType.isFloat && SampleBuffer.elementType.isPrimitive, "The element type for ifft() must be floating point");
+
+        let harmonics = inputData.size / 2;
+
+        SampleBuffer inputReal, inputImag, outputReal;
+
+        inputReal[0:harmonics] = inputData[harmonics:harmonics * 2];
+        inputImag[0:harmonics] = inputData[0:harmonics];
+
+        performComplexFourier (inputReal, inputImag, outputReal, outputData, 1.0f);
+    }
+
+    /** Convolves an input buffer with a kernel, writing the full convolution of
+        input.size + kernel.size - 1 samples to the output buffer.
+
+        The direct O(N*M) body is the fallback: a performer back-end is expected to
+        substitute a partitioned FFT-based kernel, which is what makes long
+        impulse responses (e.g. convolution reverbs) viable.
+    */
+    void convolve<InputBuffer, KernelBuffer, OutputBuffer> (const InputBuffer& inputData, const KernelBuffer& kernelData, OutputBuffer& outputData)  [[intrin: "convolve"]]
+    {
+        static_assert (InputBuffer.isFixedSizeArray || InputBuffer.isVector, "The buffers for convolve() must be fixed size arrays");
+        static_assert (KernelBuffer.isFixedSizeArray || KernelBuffer.isVector, "The buffers for convolve() must be fixed size arrays");
+        static_assert (OutputBuffer.isFixedSizeArray || OutputBuffer.isVector, "The buffers for convolve() must be fixed size arrays");
+        static_assert (InputBuffer.elementType.isFloat && InputBuffer.elementType.isPrimitive, "The element type for convolve() must be floating point");
+        static_assert (KernelBuffer.elementType.isFloat && KernelBuffer.elementType.isPrimitive, "The element type for convolve() must be floating point");
+        static_assert (OutputBuffer.elementType.isFloat && OutputBuffer.elementType.isPrimitive, "The element type for convolve() must be floating point");
+
+        for (int i = 0; i < outputData.size; ++i)
+            outputData.at (i) = OutputBuffer.elementType();
+
+        for (int i = 0; i < inputData.size; ++i)
+            for (int j = 0; j < kernelData.size; ++j)
+                outputData.at (i + j) += OutputBuffer.elementType (inputData.at (i) * kernelData.at (j));
+    }
+
+    /** For internal use by fft() and ifft(): performs a O(N^2) complex DFT. */
+    void performComplexFourier<SampleBuffer> (const SampleBuffer& inputReal,
+                                              const SampleBuffer& inputImag,
+                                              SampleBuffer& outputReal,
+                                              SampleBuffer& outputImag,
+                                              SampleBuffer.elementType scaleFactor)
+    {
+        let size = SampleBuffer.size;
+
+        for (int i = 0; i < size; ++i)
+        {
+            float64 sumReal, sumImag;
+
+            for (int j = 0; j < size; ++j)
+            {
+                let angle = SampleBuffer.elementType (twoPi * j * i / size);
+                let sinAngle = sin (angle);
+                let cosAngle = cos (angle);
+
+                sumReal += inputImag.at(j) * cosAngle + inputReal.at(j) * sinAngle;
+                sumImag += inputImag.at(j) * sinAngle - inputReal.at(j) * cosAngle;
+            }
+
+            outputImag.at(i) = SampleBuffer.elementType (sumImag) * scaleFactor;
+            outputReal.at(i) = SampleBuffer.elementType (sumReal) * scaleFactor;
+        }
+    }
+
     // NB: this is used internally, not something you'd want to call from user code
     int get_array_size<Array> (const Array& array) [[intrin: "get_array_size"]];
 }
@@ -107,6 +107,98 @@ namespace soul::midi
             return float (value - 8192) / (8192.0f / bendRange);
         }
     }
+
+    //==============================================================================
+    /** This type represents a single 64-bit MIDI 2.0 channel-voice packet in
+        Universal MIDI Packet (UMP) form. Use it for an input event endpoint which
+        should receive high-resolution MIDI: hosts up-convert MIDI 1.0 bytes to
+        this with the standard scaling rules, so the same endpoint works with both
+        kinds of source, and full-width controller data arrives unsquashed.
+    */
+    struct UMPMessage
+    {
+        int word0;  /**< bits 31-28 message type, 27-24 group, 23-20 status, 19-16 channel, 15-8 and 7-0 the index bytes */
+        int word1;  /**< the 32-bit data word, e.g. velocity in the top 16 bits for note messages */
+    }
+
+    int getGroup (UMPMessage m)       { return (m.word0 >> 24) & 0xf; }
+    int getStatus (UMPMessage m)      { return (m.word0 >> 20) & 0xf; }
+    int getChannel (UMPMessage m)     { return (m.word0 >> 16) & 0xf; }
+    int getIndex1 (UMPMessage m)      { return (m.word0 >> 8) & 0xff; }
+    int getIndex2 (UMPMessage m)      { return m.word0 & 0xff; }
+
+    /** The MIDI 2.0 counterpart of MPEParser: receives UMP channel-voice packets
+        and emits the same soul::note_events stream, but with velocities,
+        controllers and pitch-bends taken from the full-width data word rather
+        than 7-bit values, so nothing is quantised on the way in.
+    */
+    processor UMPParser  [[ main: false ]]
+    {
+        input event UMPMessage parseUMP;
+
+        output event (soul::note_events::NoteOn,
+                      soul::note_events::NoteOff,
+                      soul::note_events::PitchBend,
+                      soul::note_events::Pressure,
+                      soul::note_events::Slide,
+                      soul::note_events::Control) eventOut;
+
+        let MPESlideControllerID = 74;
+
+        event parseUMP (UMPMessage message)
+        {
+            let status  = message.getStatus();
+            let channel = message.getChannel();
+
+            if (status == 0x8)
+            {
+                eventOut << soul::note_events::NoteOff (channel, float (message.getIndex1()), normalise16 ((message.word1 >> 16) & 0xffff));
+            }
+            else if (status == 0x9)
+            {
+                // unlike MIDI 1.0, a zero-velocity note-on is a genuine note-on in MIDI 2.0
+                eventOut << soul::note_events::NoteOn (channel, float (message.getIndex1()), normalise16 ((message.word1 >> 16) & 0xffff));
+            }
+            else if (status == 0xb)
+            {
+                if (message.getIndex1() == MPESlideControllerID)
+                    eventOut << soul::note_events::Slide (channel, normalise32 (message.word1));
+                else
+                    eventOut << soul::note_events::Control (channel, message.getIndex1(), normalise32 (message.word1));
+            }
+            else if (status == 0xd)
+            {
+                eventOut << soul::note_events::Pressure (channel, normalise32 (message.word1));
+            }
+            else if (status == 0xe)
+            {
+                eventOut << soul::note_events::PitchBend (channel, translateBendSemitones (message.word1));
+            }
+        }
+
+        float normalise16 (int i)
+        {
+            return float (i) * (1.0f / 65535.0f);
+        }
+
+        float normalise32 (int i)
+        {
+            // the data word is an unsigned 32-bit value, which won't fit in an
+            // int, so it gets combined from its two halves
+            let hi = (i >> 16) & 0xffff;
+            let lo = i & 0xffff;
+            return (float (hi) * 65536.0f + float (lo)) * (1.0f / 4294967295.0f);
+        }
+
+        float translateBendSemitones (int i)
+        {
+            let bendRange = 48.0f;
+            let hi = (i >> 16) & 0xffff;
+            let lo = i & 0xffff;
+            let value = float (hi) * 65536.0f + float (lo);
+            return (value - 2147483648.0f) * (bendRange / 2147483648.0f);
+        }
+    }
 }
 
 )library"
@@ -23,14 +23,19 @@
 */
 R"library(
 
-/** Utility processors for common tasks like mixing together sources. */
+/** Utility processors for common tasks like mixing together sources.
+
+    These are all silence-transparent: the [[ propagates_silence ]] annotation
+    tells an engine that while every stream input is silent, the output is too,
+    so rendering them can be short-circuited.
+*/
 namespace soul::mixers
 {
     //==============================================================================
     /** Simple processor which simply sums two sources together with fixed gains
         for each source.
     */
-    processor FixedSum (using SampleType, float gain1, float gain2)
+    processor FixedSum (using SampleType, float gain1, float gain2)  [[ propagates_silence ]]
     {
         input  stream SampleType in1, in2;
         output stream SampleType out;
@@ -49,7 +54,7 @@ namespace soul::mixers
     /** Simple processor which simply sums two sources together with streams for the
         gains to apply to each source.
     */
-    processor DynamicSum (using SampleType)
+    processor DynamicSum (using SampleType)  [[ propagates_silence ]]
     {
         input  stream SampleType in1, in2;
         input  stream float gain1, gain2;
@@ -75,7 +80,7 @@ namespace soul::mixers
         The mix stream is expected to contain values between 0 and mixRange,
         where mix = 0 produces 100% in1, and mix = mixRange produces 100% in2.
     */
-    processor DynamicMix (using SampleType, float mixRange)
+    processor DynamicMix (using SampleType, float mixRange)  [[ propagates_silence ]]
     {
         input  stream SampleType in1, in2;
         input  stream float mix;
@@ -90,6 +95,56 @@ namespace soul::mixers
             }
         }
     }
+
+    //==============================================================================
+    /** Sums any number of input streams into a single output stream.
+
+        The AccumulatorType parameter sets the type the additions are done in, so
+        a float32 stem bus can be summed in float64 (e.g. MultiSum (float, float64, 64))
+        without losing low-order bits the way a long chain of float32 adds does.
+        The reduction is a balanced tree rather than a left-to-right fold, which
+        keeps the adds independent of each other - a backend can then turn the
+        tree levels into parallel SIMD sums instead of one serial dependency chain.
+    */
+    processor MultiSum (using SampleType, using AccumulatorType, int numInputs)  [[ propagates_silence ]]
+    {
+        input  stream SampleType in[numInputs];
+        output stream SampleType out;
+
+        AccumulatorType treeSum<ArrayType> (ArrayType values)
+        {
+            if const (values.size == 1)
+                return AccumulatorType (values[0]);
+            else if const (values.size == 2)
+                return AccumulatorType (values[0]) + AccumulatorType (values[1]);
+            else if const (ArrayType.elementType.isPrimitive)
+            {
+                let half = values.size / 2;
+                return treeSum (values[0 : half]) + treeSum (values[half :]);
+            }
+            else
+            {
+                // Slicing arrays of vectors isn't supported yet, so vector sample
+                // types fall back to a linear sum, still in the accumulator type
+                var total = AccumulatorType (values[0]);
+                wrap<values.size> i;
+
+                loop (values.size - 1)
+                    total += AccumulatorType (values[++i]);
+
+                return total;
+            }
+        }
+
+        void run()
+        {
+            loop
+            {
+                out << SampleType (treeSum (in));
+                advance();
+            }
+        }
+    }
 }
 
 //==============================================================================
@@ -98,7 +153,7 @@ namespace soul::gain
 {
     //==============================================================================
     /** Simple processor which applies a fixed gain to a signal. */
-    processor FixedGain (using SampleType, float fixedGain)
+    processor FixedGain (using SampleType, float fixedGain)  [[ propagates_silence ]]
     {
         input  stream SampleType in;
         output stream SampleType out;
@@ -115,7 +170,7 @@ namespace soul::gain
 
     //==============================================================================
     /** Simple processor which applies a changable gain level to a signal. */
-    processor DynamicGain (using SampleType)
+    processor DynamicGain (using SampleType)  [[ propagates_silence ]]
     {
         input  stream SampleType in;
         output stream SampleType out;
@@ -131,6 +186,60 @@ namespace soul::gain
         }
     }
 
+    //==============================================================================
+    /** Applies a gain which moves to new levels in short linear ramps.
+
+        The gain arrives as events rather than a stream: when a new level comes
+        in, it's ramped to over rampSamples frames to avoid a click, and once
+        reached, the render loop collapses back to a single multiply per frame
+        with no per-sample increment bookkeeping - which is the state a channel
+        strip's faders spend almost all of their time in. Compare DynamicGain,
+        which pays for a gain stream on every frame whether it's moving or not.
+
+        The gain starts at zero, so send an initial event to un-mute it.
+    */
+    processor RampedGain (using SampleType, int rampSamples)  [[ propagates_silence ]]
+    {
+        input  stream SampleType in;
+        output stream SampleType out;
+        input  event float gain;   /**< Send these events to change the gain level */
+
+        event gain (float newLevel)
+        {
+            targetGain = newLevel;
+            increment = (targetGain - currentGain) / float (rampSamples);
+            remainingRampSamples = rampSamples;
+        }
+
+        float targetGain, currentGain, increment;
+        int remainingRampSamples;
+
+        void run()
+        {
+            loop
+            {
+                // steady state: just a multiply per frame
+                while (remainingRampSamples == 0)
+                {
+                    out << in * currentGain;
+                    advance();
+                }
+
+                // ramping towards a new level
+                while (remainingRampSamples != 0)
+                {
+                    if (--remainingRampSamples == 0)
+                        currentGain = targetGain;
+                    else
+                        currentGain += increment;
+
+                    out << in * currentGain;
+                    advance();
+                }
+            }
+        }
+    }
+
     //==============================================================================
     /** Converts an input event parameter in decibels to a smoothed stream of
         raw gain levels.
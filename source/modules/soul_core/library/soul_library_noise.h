@@ -59,6 +59,34 @@ namespace soul::random
     {
         return (float (getNextInt32 (state)) * (2.0f / 2147483647.0f)) - 1.0f;
     }
+
+    //==============================================================================
+    /** Returns the value at the given position of a counter-based random sequence.
+
+        Unlike getNextInt32(), there's no serial dependency between positions - the
+        result is a hash (a SplitMix64-style finaliser) of the seed and position - so
+        a loop filling a block of values from consecutive positions can be vectorised.
+        Each seed selects an independent sequence.
+    */
+    int32 getInt32AtPosition (int64 seed, int64 position)
+    {
+        var z = seed + position * 0x9E3779B97F4A7C15L;
+        z = (z ^ (z >>> 30)) * 0xBF58476D1CE4E5B9L;
+        z = (z ^ (z >>> 27)) * 0x94D049BB133111EBL;
+        return int32 (z ^ (z >>> 31));
+    }
+
+    /** Returns the value 0 to 1 at the given position of a counter-based random sequence. */
+    float getUnipolarAtPosition (int64 seed, int64 position)
+    {
+        return (float (getInt32AtPosition (seed, position)) * (0.5f / 2147483648.0f)) + 0.5f;
+    }
+
+    /** Returns the value -1 to 1 at the given position of a counter-based random sequence. */
+    float getBipolarAtPosition (int64 seed, int64 position)
+    {
+        return float (getInt32AtPosition (seed, position)) * (1.0f / 2147483648.0f);
+    }
 }
 
 /**
@@ -144,6 +172,102 @@ namespace soul::noise
             }
         }
     }
+
+    //==============================================================================
+    /** White noise generator which renders a whole block of samples per update.
+
+        Because the samples come from a counter-based random sequence rather than a
+        sequential PRNG, every sample in the block is independent of the others, so
+        the block-filling loop can be vectorised - unlike White, where each frame's
+        value depends on the previous one.
+    */
+    processor WhiteBlock (int blockSize)
+    {
+        output stream float out;
+
+        void run()
+        {
+            let seed = int64 (processor.id + 40);
+            int64 position;
+            float[blockSize] block;
+
+            loop
+            {
+                wrap<blockSize> i;
+
+                loop (blockSize)
+                {
+                    block[i] = random::getBipolarAtPosition (seed, position + i);
+                    ++i;
+                }
+
+                position += blockSize;
+                wrap<blockSize> j;
+
+                loop (blockSize)
+                {
+                    out << block[j];
+                    ++j;
+                    advance();
+                }
+            }
+        }
+    }
+
+    //==============================================================================
+    /** Pink noise generator which renders a whole block of samples per update.
+
+        A block of independent counter-based white noise samples is generated first
+        (a vectorisable loop, as in WhiteBlock), then shaped to a roughly 1/f
+        spectrum by a bank of three one-pole filters - a Paul Kellet style
+        approximation - leaving only that cheap filter recurrence as serial work.
+        The output level is roughly -1 to 1.
+    */
+    processor PinkBlock (int blockSize)
+    {
+        output stream float out;
+
+        void run()
+        {
+            let seed = int64 (processor.id + 50);
+            int64 position;
+            float[blockSize] block;
+            float b0, b1, b2;
+
+            loop
+            {
+                wrap<blockSize> i;
+
+                loop (blockSize)
+                {
+                    block[i] = random::getBipolarAtPosition (seed, position + i);
+                    ++i;
+                }
+
+                position += blockSize;
+                wrap<blockSize> j;
+
+                loop (blockSize)
+                {
+                    let white = block[j];
+                    b0 = 0.99765f * b0 + white * 0.0990460f;
+                    b1 = 0.96300f * b1 + white * 0.2965164f;
+                    b2 = 0.57000f * b2 + white * 1.0526913f;
+                    block[j] = (b0 + b1 + b2 + white * 0.1848f) * 0.105f;
+                    ++j;
+                }
+
+                wrap<blockSize> k;
+
+                loop (blockSize)
+                {
+                    out << block[k];
+                    ++k;
+                    advance();
+                }
+            }
+        }
+    }
 }
 
 )library"
@@ -163,6 +163,84 @@ namespace soul::oscillator
         }
     }
 
+    //==============================================================================
+    /** Renders a whole bank of wavetable oscillators as a single processor.
+
+        Building a large additive bank out of individual oscillator processors costs
+        a graph node, stream plumbing and a transcendental call per voice. This
+        processor instead keeps the per-oscillator phases, increments and gains in
+        flat parallel arrays and renders every voice from a shared wavetable inside
+        one loop per frame - a layout which a backend can turn into SIMD operations.
+
+        The wavetable holds a single cycle of a sine wave by default, and can be
+        replaced with an arbitrary single-cycle waveform by sending an event to
+        the table input.
+    */
+    processor WavetableBank (using SampleType, int numOscillators, int tableSize)
+    {
+        output stream SampleType out;
+
+        input event float[numOscillators] frequencies; /**< Send these events to change the oscillator frequencies in Hz */
+        input event float[numOscillators] levels;      /**< Send these events to change the oscillator gain levels */
+        input event float[tableSize] table;            /**< Send these events to replace the single-cycle wavetable */
+
+        event frequencies (float[numOscillators] newFrequencies)
+        {
+            wrap<numOscillators> i;
+
+            loop (numOscillators)
+            {
+                phaseIncrements[i] = float (newFrequencies[i] * processor.period);
+                ++i;
+            }
+        }
+
+        event levels (float[numOscillators] newLevels)      { gains = newLevels; }
+        event table (float[tableSize] newTable)             { wavetable = newTable; }
+
+        float[numOscillators] phases, phaseIncrements, gains;
+        float[tableSize] wavetable;
+
+        void initialiseSineTable()
+        {
+            wrap<tableSize> i;
+
+            loop (tableSize)
+            {
+                wavetable[i] = float (sin (float (i) * float (twoPi / tableSize)));
+                ++i;
+            }
+        }
+
+        void run()
+        {
+            initialiseSineTable();
+
+            loop
+            {
+                float total;
+                wrap<numOscillators> i;
+
+                loop (numOscillators)
+                {
+                    let phase = phases[i];
+                    total += gains[i] * wavetable.readLinearInterpolated (phase * float (tableSize));
+
+                    var next = phase + phaseIncrements[i];
+
+                    if (next >= 1.0f)
+                        next -= 1.0f;
+
+                    phases[i] = next;
+                    ++i;
+                }
+
+                out << SampleType (total);
+                advance();
+            }
+        }
+    }
+
     //==============================================================================
     /** Some PolyBLEP (Polynomial Band-Limited Step) functions, mainly for use by the oscillator classes. */
     namespace polyblep
@@ -0,0 +1,136 @@
+/*
+    _____ _____ _____ __
+   |   __|     |  |  |  |      The SOUL language
+   |__   |  |  |  |  |  |__    Copyright (c) 2019 - ROLI Ltd.
+   |_____|_____|_____|_____|
+
+   The code in this file is provided under the terms of the ISC license:
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose
+   with or without fee is hereby granted, provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/*  The following string literal forms part of a set of SOUL code chunks that form
+    the built-in library. (See the soul::getBuiltInLibraryCode() function)
+*/
+R"library(
+
+/** Types and helpers for following a host's timeline: tempo, time signature,
+    transport state and playback position.
+
+    A processor receives these by declaring input event endpoints whose types are
+    the structs below - a host which understands them (such as the patch player)
+    will spot the endpoints by their shape and route its timeline to them.
+
+    The updates arrive only when something actually changes, timestamped within
+    the block, rather than being re-sent every block: a static timeline costs a
+    processor nothing per frame, and a tempo ramp is declared once as a TempoRamp
+    so the processor can interpolate for itself instead of receiving a stream of
+    tiny tempo steps.
+*/
+namespace soul::timeline
+{
+    //==============================================================================
+    /** A time signature, e.g. 3/4 is { 3, 4 }. */
+    struct TimeSignature
+    {
+        int numerator;
+        int denominator;
+    }
+
+    /** Returns the number of quarter-notes that one beat of this signature lasts. */
+    float quarterNotesPerBeat (TimeSignature timeSig)     { return 4.0f / float (timeSig.denominator); }
+
+    /** Returns the number of beats of this signature that fit in one quarter-note. */
+    float beatsPerQuarterNote (TimeSignature timeSig)     { return float (timeSig.denominator) * 0.25f; }
+
+    //==============================================================================
+    /** A tempo, as quarter-notes per minute. */
+    struct Tempo
+    {
+        float bpm;
+    }
+
+    /** Returns the duration of one quarter-note in seconds. */
+    float secondsPerQuarterNote (Tempo tempo)             { return tempo.bpm > 0 ? 60.0f / tempo.bpm : 0.0f; }
+
+    /** Returns the duration of one beat of the given signature in seconds. */
+    float secondsPerBeat (Tempo tempo, TimeSignature timeSig)
+    {
+        return secondsPerQuarterNote (tempo) * quarterNotesPerBeat (timeSig);
+    }
+
+    /** Returns the duration of one quarter-note in frames at the given sample rate. */
+    float64 framesPerQuarterNote (Tempo tempo, float64 sampleRate)
+    {
+        return sampleRate * secondsPerQuarterNote (tempo);
+    }
+
+    //==============================================================================
+    /** Declares a linear tempo ramp: the tempo moves from startBPM to endBPM over
+        rampLengthFrames frames, then holds at endBPM.
+
+        A host sends one of these at the start of a ramp instead of a run of
+        per-block Tempo updates, and the receiver interpolates with getBPMAtFrame().
+    */
+    struct TempoRamp
+    {
+        float startBPM;
+        float endBPM;
+        int64 rampLengthFrames;
+    }
+
+    /** Returns a ramp's tempo a given number of frames after its start. */
+    float getBPMAtFrame (TempoRamp ramp, int64 framesIntoRamp)
+    {
+        if (ramp.rampLengthFrames <= 0 || framesIntoRamp >= ramp.rampLengthFrames)
+            return ramp.endBPM;
+
+        if (framesIntoRamp <= 0)
+            return ramp.startBPM;
+
+        return ramp.startBPM + (ramp.endBPM - ramp.startBPM)
+                                 * float (framesIntoRamp) / float (ramp.rampLengthFrames);
+    }
+
+    //==============================================================================
+    /** Describes whether the host's transport is stopped, playing or recording. */
+    struct TransportState
+    {
+        /** 0 = stopped, 1 = playing, 2 = recording. */
+        int state;
+    }
+
+    bool isStopped   (TransportState transportState)      { return transportState.state == 0; }
+    bool isPlaying   (TransportState transportState)      { return transportState.state == 1; }
+    bool isRecording (TransportState transportState)      { return transportState.state == 2; }
+
+    //==============================================================================
+    /** A position along the host's timeline. */
+    struct Position
+    {
+        /** The frame index, from the start of the host's timeline. */
+        int64 currentFrame;
+
+        /** The number of (possibly fractional) quarter-notes from the start of
+            the host's timeline.
+        */
+        float64 currentQuarterNote;
+
+        /** The position of the start of the current bar, in quarter-notes from
+            the start of the host's timeline, so a processor can work out where
+            it is within the bar.
+        */
+        float64 lastBarStartQuarterNote;
+    }
+}
+
+)library"
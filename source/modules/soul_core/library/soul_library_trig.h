@@ -92,4 +92,89 @@ namespace soul::intrinsics
     }
 }
 
+//==============================================================================
+/** Fast approximations of the trigonometric functions.
+
+    These trade the last few digits of accuracy for a short, branch-free sequence
+    of multiplies and adds, which makes them a better fit than the precise
+    intrinsics for LFOs, panners and other modulation tasks where errors of this
+    size are inaudible. Each function documents its valid input range and peak
+    absolute error. They work on both primitive and vector floating point types,
+    and because they're pure polynomial or rational evaluations they inline and
+    fold to constants when called with compile-time arguments.
+*/
+namespace soul::trig::fast
+{
+    /** Approximates sin(x) for x in the range [-pi, pi], with a peak absolute error
+        below 1.4e-5. Arguments outside that range are not folded back into it, so
+        wrap them first, or use sinPhase() for free-running phases.
+    */
+    T sin<T> (T x)
+    {
+        static_assert (T.isPrimitive || T.isVector, "sin() only works with floating point types");
+        static_assert (T.primitiveType.isFloat, "sin() only works with floating point types");
+
+        let x2 = x * x;
+
+        return x * (T (0.999998257) + x2 * (T (-0.1666509514) + x2 * (T (0.008318880636) + x2 * (T (-0.0001940042413) + x2 * T (2.209400658e-06)))));
+    }
+
+    /** Approximates cos(x) for x in the range [-pi, pi], with a peak absolute error
+        below 4.6e-5. Arguments outside that range are not folded back into it, so
+        wrap them first, or use cosPhase() for free-running phases.
+    */
+    T cos<T> (T x)
+    {
+        static_assert (T.isPrimitive || T.isVector, "cos() only works with floating point types");
+        static_assert (T.primitiveType.isFloat, "cos() only works with floating point types");
+
+        let x2 = x * x;
+
+        return T (0.9999814281) + x2 * (T (-0.4998323223) + x2 * (T (0.04151214345) + x2 * (T (-0.001341594705) + x2 * T (1.890131182e-05))));
+    }
+
+    /** Approximates tan(x) for x in the range [-pi/4, pi/4] using a Pade approximant,
+        with a peak absolute error below 1.4e-8. The error grows quickly beyond that
+        range as the poles of tan are approached.
+    */
+    T tan<T> (T x)
+    {
+        static_assert (T.isPrimitive || T.isVector, "tan() only works with floating point types");
+        static_assert (T.primitiveType.isFloat, "tan() only works with floating point types");
+
+        let x2 = x * x;
+
+        return x * (T (945) + x2 * (x2 - T (105)))
+                 / (T (945) + x2 * (T (15) * x2 - T (420)));
+    }
+
+    /** Approximates sin (twoPi * phase) for a normalised phase, where one cycle runs
+        from 0 to 1. The phase is folded with a floor() rather than radian range
+        reduction, so any finite phase is valid - free-running phase accumulators can
+        be fed in directly without wrapping. Peak absolute error is below 1.4e-5.
+    */
+    T sinPhase<T> (T phase)
+    {
+        static_assert (T.isPrimitive || T.isVector, "sinPhase() only works with floating point types");
+        static_assert (T.primitiveType.isFloat, "sinPhase() only works with floating point types");
+
+        let u = phase - floor (phase + T (0.5));
+        let u2 = u * u;
+
+        return u * (T (6.283174355) + u2 * (T (-41.33780406) + u2 * (T (81.46371941) + u2 * (T (-75.00156145) + u2 * T (33.72044547)))));
+    }
+
+    /** Approximates cos (twoPi * phase) for a normalised phase, where one cycle runs
+        from 0 to 1. Like sinPhase(), any finite phase is valid, and the peak absolute
+        error is below 1.4e-5.
+    */
+    T cosPhase<T> (T phase)
+    {
+        static_assert (T.isPrimitive || T.isVector, "cosPhase() only works with floating point types");
+        static_assert (T.primitiveType.isFloat, "cosPhase() only works with floating point types");
+
+        return sinPhase (phase + T (0.25));
+    }
+}
+
 )library"
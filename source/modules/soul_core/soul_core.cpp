@@ -37,6 +37,7 @@
 
 #if SOUL_INTEL
  #include <xmmintrin.h>
+ #include <emmintrin.h>
 #endif
 
 #ifdef __APPLE__
@@ -62,6 +63,7 @@
 #include "utilities/soul_AudioDataGeneration.cpp"
 #include "types/soul_Struct.cpp"
 #include "types/soul_StringDictionary.cpp"
+#include "types/soul_RuntimeStringPool.cpp"
 #include "types/soul_ConstantTable.cpp"
 #include "types/soul_Value.cpp"
 #include "types/soul_Annotation.cpp"
@@ -70,6 +72,7 @@
 #include "heart/soul_heart_Printer.h"
 #include "heart/soul_heart_Parser.h"
 #include "heart/soul_heart_Checker.h"
+#include "heart/soul_heart_Serialisation.h"
 #include "types/soul_Type.cpp"
 #include "library/soul_library.h"
 #include "compiler/soul_ASTVisitor.h"
@@ -80,14 +83,20 @@
 #include "compiler/soul_Compiler.cpp"
 #include "heart/soul_Intrinsics.cpp"
 #include "heart/soul_heart_FunctionBuilder.cpp"
-#include "heart/soul_ModuleCloner.h"
 #include "heart/soul_Module.cpp"
 #include "heart/soul_Program.cpp"
 #include "venue/soul_ThreadedVenue.cpp"
+#include "venue/soul_SharedMemoryVenue.cpp"
+#include "venue/soul_CompileServer.cpp"
 #include "diagnostics/soul_CodeLocation.cpp"
 #include "diagnostics/soul_Logging.cpp"
+#include "diagnostics/soul_TraceLogger.cpp"
+#include "diagnostics/soul_PerformanceCounters.cpp"
 #include "diagnostics/soul_CompileMessageList.cpp"
 #include "diagnostics/soul_Timing.cpp"
+#include "diagnostics/soul_CompileTimeBenchmark.cpp"
+#include "diagnostics/soul_RenderBenchmark.cpp"
+#include "diagnostics/soul_RealtimeSafetyChecker.cpp"
 #include "venue/soul_Endpoints.cpp"
 
 #ifdef __clang__
@@ -46,15 +46,18 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <array>
 #include <unordered_map>
+#include <unordered_set>
 #include <algorithm>
 #include <functional>
 #include <mutex>
 #include <memory>
 #include <cstring>
 #include <cmath>
+#include <type_traits>
 #include <cstddef>
 #include <atomic>
 #include <limits>
@@ -62,6 +65,14 @@
 #include <cassert>
 #include <random>
 #include <optional>
+#include <thread>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+
+#if SOUL_INTEL
+ #include <xmmintrin.h>
+#endif
 
 #include "utilities/soul_DebugUtilities.h"
 
@@ -81,7 +92,7 @@
 namespace soul
 {
     static inline constexpr Version getLibraryVersion()                   { return { 0, 9, 0 }; }
-    static inline constexpr int64_t getHEARTFormatVersion()               { return 1; }
+    static inline constexpr int64_t getHEARTFormatVersion()               { return 4; }
     static inline constexpr const char* getHEARTFormatVersionPrefix()     { return "SOUL"; }
 
     struct Identifier;
@@ -103,12 +114,17 @@ namespace soul
 #include "utilities/soul_ObjectHandleList.h"
 #include "utilities/soul_PoolAllocator.h"
 #include "utilities/soul_FIFO.h"
+#include "utilities/soul_BufferOperations.h"
 #include "utilities/soul_ChannelSetFIFO.h"
 #include "utilities/soul_Resampler.h"
 #include "utilities/soul_AccessCount.h"
+#include "utilities/soul_ThreadPool.h"
 
 #include "diagnostics/soul_Logging.h"
+#include "diagnostics/soul_TraceLogger.h"
+#include "diagnostics/soul_PerformanceCounters.h"
 #include "diagnostics/soul_Timing.h"
+#include "diagnostics/soul_RealtimeSafetyChecker.h"
 #include "diagnostics/soul_CodeLocation.h"
 #include "diagnostics/soul_CompileMessageList.h"
 #include "diagnostics/soul_Errors.h"
@@ -117,12 +133,14 @@ namespace soul
 #include "types/soul_Type.h"
 #include "types/soul_Struct.h"
 #include "types/soul_StringDictionary.h"
+#include "types/soul_RuntimeStringPool.h"
 #include "types/soul_ConstantTable.h"
 #include "types/soul_Value.h"
 #include "types/soul_Annotation.h"
 #include "types/soul_TypeRules.h"
 #include "types/soul_EndpointType.h"
 #include "types/soul_InterpolationType.h"
+#include "utilities/soul_StreamInterpolator.h"
 
 #include "heart/soul_Operators.h"
 #include "heart/soul_Intrinsics.h"
@@ -131,18 +149,26 @@ namespace soul
 #include "heart/soul_Module.h"
 #include "heart/soul_heart_Utilities.h"
 #include "heart/soul_heart_FunctionBuilder.h"
+#include "heart/soul_ModuleCloner.h"
 #include "heart/soul_heart_CallFlowGraph.h"
 #include "heart/soul_heart_Optimisations.h"
+#include "heart/soul_heart_Interpreter.h"
 #include "heart/soul_heart_DelayCompensation.h"
 
 #include "compiler/soul_AST.h"
 #include "compiler/soul_Compiler.h"
+#include "diagnostics/soul_CompileTimeBenchmark.h"
 
 #include "venue/soul_Endpoints.h"
 #include "venue/soul_Performer.h"
 #include "venue/soul_Venue.h"
+#include "venue/soul_CompileServer.h"
+#include "diagnostics/soul_RenderBenchmark.h"
 
+#include "utilities/soul_LinkerCacheFolder.h"
+#include "utilities/soul_PageBackedAllocator.h"
 #include "utilities/soul_EventQueue.h"
+#include "utilities/soul_StreamingSampleSource.h"
 #include "utilities/soul_AudioDataGeneration.h"
 #include "utilities/soul_AudioMIDIWrapper.h"
 #include "utilities/soul_DumpConstant.h"
@@ -36,12 +36,18 @@ namespace soul
         if (! value.isValid())
             return 0;
 
-        for (auto& i : items)
-            if (value == *i.value)
-                return i.handle;
+        // Comparing content hashes first avoids doing a full data comparison
+        // against every existing item - with many large identical wavetables,
+        // that linear byte-by-byte scan used to dominate insertion time
+        auto hash = getHashForValue (value);
+
+        for (size_t i = 0; i < items.size(); ++i)
+            if (itemHashes[i] == hash && value == *items[i].value)
+                return items[i].handle;
 
         auto handle = nextIndex++;
         items.push_back ({ handle, std::make_unique<Value> (std::move (value)) });
+        itemHashes.push_back (hash);
         return handle;
     }
 
@@ -61,6 +67,62 @@ namespace soul
     void ConstantTable::addItem (Item i)
     {
         nextIndex = std::max (nextIndex, i.handle + 1);
+        itemHashes.push_back (getHashForValue (*i.value));
         items.push_back (std::move (i));
     }
+
+    uint64_t ConstantTable::getHashForValue (const Value& value)
+    {
+        // FNV-1a over the packed data, seeded with its size
+        uint64_t hash = 0xcbf29ce484222325ull ^ (uint64_t) value.getPackedDataSize();
+        auto data = static_cast<const uint8_t*> (value.getPackedData());
+
+        for (size_t i = 0; i < value.getPackedDataSize(); ++i)
+            hash = (hash ^ data[i]) * 0x100000001b3ull;
+
+        return hash;
+    }
+
+    std::optional<ConstantTable::SubRangeInfo> ConstantTable::findContainingItem (Handle handle) const
+    {
+        const Item* child = nullptr;
+
+        for (auto& i : items)
+            if (i.handle == handle)
+                child = std::addressof (i);
+
+        if (child == nullptr || ! child->value->getType().isFixedSizeArray())
+            return {};
+
+        auto& childType = child->value->getType();
+        auto childSize = child->value->getPackedDataSize();
+        auto childData = static_cast<const uint8_t*> (child->value->getPackedData());
+
+        if (childSize == 0)
+            return {};
+
+        auto elementSize = childSize / childType.getArraySize();
+
+        for (auto& i : items)
+        {
+            if (std::addressof (i) == child
+                 || ! i.value->getType().isFixedSizeArray()
+                 || i.value->getPackedDataSize() <= childSize
+                 || ! i.value->getType().getArrayElementType().isIdentical (childType.getArrayElementType()))
+                continue;
+
+            auto parentData = static_cast<const uint8_t*> (i.value->getPackedData());
+            auto maxStart = i.value->getPackedDataSize() - childSize;
+
+            for (size_t offset = 0; offset <= maxStart; offset += elementSize)
+            {
+                if (std::memcmp (parentData + offset, childData, childSize) == 0)
+                    return SubRangeInfo { i.handle,
+                                          offset / elementSize,
+                                          (size_t) childType.getArraySize() };
+            }
+        }
+
+        return {};
+    }
 }
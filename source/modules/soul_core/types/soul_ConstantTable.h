@@ -52,9 +52,28 @@ public:
     /** Manually adds an item - obviously to be used with care. */
     void addItem (Item);
 
+    //==============================================================================
+    /** Describes where one item's data lies inside a larger item's data. */
+    struct SubRangeInfo
+    {
+        Handle parent;
+        size_t startElement, numElements;
+    };
+
+    /** If this handle refers to an array whose content also appears, element-aligned,
+        inside a larger array in the table, this returns where it lies - so a backend
+        or serialiser can store the bytes once and point the smaller table into the
+        larger allocation. Returns nothing if the data isn't shared. The parent is
+        always strictly bigger than the child, so chains of results can't cycle.
+    */
+    std::optional<SubRangeInfo> findContainingItem (Handle) const;
+
 private:
     ArrayWithPreallocation<Item, 32> items;
+    ArrayWithPreallocation<uint64_t, 32> itemHashes;
     Handle nextIndex = 1;
+
+    static uint64_t getHashForValue (const Value&);
 };
 
 
@@ -24,6 +24,9 @@ namespace soul
 //==============================================================================
 /**
     A basic scalar type. For complex types, see the Type class.
+
+    Note that float16 is a storage-only format: values can be held, copied and
+    cast, but arithmetic involving them is performed at float32 precision.
     @see Type, TypeRules
 */
 struct PrimitiveType  final
@@ -37,7 +40,11 @@ struct PrimitiveType  final
         fixed,
         int32,
         int64,
-        bool_
+        bool_,
+
+        // NB: new primitives must be added at the end of this list, as the
+        // enum values are baked into serialised programs
+        float16
     };
 
     constexpr PrimitiveType() = default;
@@ -53,6 +60,7 @@ struct PrimitiveType  final
     bool isVoid() const;
     bool isFloat32() const;
     bool isFloat64() const;
+    bool isFloat16() const;
     bool isFloatingPoint() const;
     bool isFixed() const;
     bool isInteger() const;
@@ -0,0 +1,129 @@
+/*
+    _____ _____ _____ __
+   |   __|     |  |  |  |      The SOUL language
+   |__   |  |  |  |  |  |__    Copyright (c) 2019 - ROLI Ltd.
+   |_____|_____|_____|_____|
+
+   The code in this file is provided under the terms of the ISC license:
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose
+   with or without fee is hereby granted, provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#if ! SOUL_INSIDE_CORE_CPP
+ #error "Don't add this cpp file to your build, it gets included indirectly by soul_core.cpp"
+#endif
+
+namespace soul
+{
+
+RuntimeStringPool::RuntimeStringPool() = default;
+RuntimeStringPool::~RuntimeStringPool() = default;
+
+void RuntimeStringPool::initialise (const soul::StringDictionary& source,
+                                    size_t extraStringCapacity,
+                                    size_t extraCharacterCapacity)
+{
+    items.clear();
+    characters.clear();
+    nextIndex = 1;
+
+    size_t totalCharacters = 0;
+
+    source.forEach ([&] (const soul::StringDictionary::Item& item)
+    {
+        totalCharacters += item.text.length();
+    });
+
+    items.reserve (source.size() + extraStringCapacity);
+    characters.reserve (totalCharacters + extraCharacterCapacity);
+
+    // The source dictionary iterates in handle order, which keeps the item
+    // table sorted for getStringForHandle's binary search.
+    source.forEach ([&] (const soul::StringDictionary::Item& item)
+    {
+        SOUL_ASSERT (items.empty() || items.back().handle < item.handle);
+
+        auto start = (uint32_t) characters.size();
+        characters.insert (characters.end(), item.text.begin(), item.text.end());
+        items.push_back ({ item.handle, start, (uint32_t) item.text.length() });
+
+        if (item.handle.handle >= nextIndex)
+            nextIndex = item.handle.handle + 1;
+    });
+}
+
+size_t RuntimeStringPool::size() const
+{
+    return items.size();
+}
+
+std::string_view RuntimeStringPool::getText (const Item& item) const
+{
+    return std::string_view (characters.data() + item.start, item.length);
+}
+
+RuntimeStringPool::Handle RuntimeStringPool::getHandleForString (std::string_view text)
+{
+    if (text.empty())
+        return {};
+
+    for (auto& item : items)
+        if (getText (item) == text)
+            return item.handle;
+
+    // A miss on the render path would mean growing the pool mid-block, which is
+    // exactly what this class exists to rule out - so it's reported and refused
+    if (RealtimeSafetyChecker::isInRealtimeSection())
+    {
+        RealtimeSafetyChecker::violationDetected ("string-pool",
+                                                  "unknown string requested on the render path");
+        return {};
+    }
+
+    if (items.size() < items.capacity() && characters.size() + text.length() <= characters.capacity())
+    {
+        auto start = (uint32_t) characters.size();
+        characters.insert (characters.end(), text.begin(), text.end());
+
+        auto handle = Handle { nextIndex++ };
+        items.push_back ({ handle, start, (uint32_t) text.length() });
+        return handle;
+    }
+
+    return {};
+}
+
+std::string_view RuntimeStringPool::getStringForHandle (Handle handle) const
+{
+    if (handle == Handle())
+        return {};
+
+    size_t low = 0, high = items.size();
+
+    while (low < high)
+    {
+        auto mid = (low + high) / 2;
+
+        if (items[mid].handle == handle)
+            return getText (items[mid]);
+
+        if (items[mid].handle < handle)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    SOUL_ASSERT_FALSE;
+    return {};
+}
+
+} // namespace soul
@@ -0,0 +1,89 @@
+/*
+    _____ _____ _____ __
+   |   __|     |  |  |  |      The SOUL language
+   |__   |  |  |  |  |  |__    Copyright (c) 2019 - ROLI Ltd.
+   |_____|_____|_____|_____|
+
+   The code in this file is provided under the terms of the ISC license:
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose
+   with or without fee is hereby granted, provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+namespace soul
+{
+
+//==============================================================================
+/** A fixed-capacity, allocation-free string dictionary for the render path.
+
+    Events whose payloads include strings resolve them through a StringDictionary,
+    and the standard dictionary allocates whenever it meets a new string - which
+    must never happen while a block is being rendered. This pool is populated once
+    at link time with every statically known string in the program, packing the
+    characters into one preallocated arena, after which lookups in both directions
+    touch only that arena and never allocate.
+
+    Handles keep the same values as the dictionary the pool was populated from, so
+    handles already baked into compiled program data, and comparisons between
+    them, behave identically whichever dictionary resolves them.
+
+    The guarantee is that the render path never inserts: asking for a string that
+    isn't in the pool returns the empty handle, and if it happens inside a
+    realtime section the RealtimeSafetyChecker reports it as a violation rather
+    than letting it pass silently. Non-realtime threads may still add strings -
+    preparing an event to send, say - and those insertions use the spare capacity
+    reserved by initialise(), so they don't allocate either; once that's exhausted
+    they also return the empty handle.
+*/
+class RuntimeStringPool final : public choc::value::StringDictionary
+{
+public:
+    RuntimeStringPool();
+    ~RuntimeStringPool() override;
+
+    RuntimeStringPool (const RuntimeStringPool&) = delete;
+    RuntimeStringPool& operator= (const RuntimeStringPool&) = delete;
+
+    /** Builds the pool from the given dictionary, preserving its handle values,
+        and reserves room for the given number of additional strings and
+        characters for dynamic use. This is the only method which allocates, so
+        it must be called before rendering starts.
+    */
+    void initialise (const soul::StringDictionary& source,
+                     size_t extraStringCapacity = 64,
+                     size_t extraCharacterCapacity = 4096);
+
+    /** Returns the handle of a string already in the pool, or the empty handle
+        for an unknown one on the render path - reporting the miss to the
+        RealtimeSafetyChecker. Off the render path, an unknown string is added
+        into the reserved capacity if any remains.
+    */
+    Handle getHandleForString (std::string_view) override;
+
+    std::string_view getStringForHandle (Handle) const override;
+
+    size_t size() const;
+
+private:
+    struct Item
+    {
+        Handle handle;
+        uint32_t start = 0, length = 0;   // a span of the character arena
+    };
+
+    std::vector<Item> items;              // kept in handle order for binary-searched resolution
+    std::vector<char> characters;
+    uint32_t nextIndex = 1;
+
+    std::string_view getText (const Item&) const;
+};
+
+} // namespace soul
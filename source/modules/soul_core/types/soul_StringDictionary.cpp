@@ -27,17 +27,75 @@ namespace soul
     StringDictionary::StringDictionary() = default;
     StringDictionary::~StringDictionary() = default;
 
+    StringDictionary::StringDictionary (const StringDictionary& other)
+    {
+        other.freeze();
+        sharedBase = other.sharedBase;
+        nextIndex = other.nextIndex;
+    }
+
+    StringDictionary& StringDictionary::operator= (const StringDictionary& other)
+    {
+        other.freeze();
+        sharedBase = other.sharedBase;
+        localStrings.clear();
+        nextIndex = other.nextIndex;
+        return *this;
+    }
+
+    void StringDictionary::freeze() const
+    {
+        if (localStrings.empty())
+            return;
+
+        auto frozen = std::make_shared<std::vector<Item>>();
+        frozen->reserve (size());
+
+        if (sharedBase != nullptr)
+            frozen->insert (frozen->end(), sharedBase->begin(), sharedBase->end());
+
+        for (auto& s : localStrings)
+            frozen->push_back (std::move (s));
+
+        sharedBase = std::move (frozen);
+        localStrings.clear();
+    }
+
+    size_t StringDictionary::size() const
+    {
+        return (sharedBase != nullptr ? sharedBase->size() : 0) + localStrings.size();
+    }
+
+    const StringDictionary::Item* StringDictionary::findItem (Handle handle) const
+    {
+        if (sharedBase != nullptr)
+            for (auto& s : *sharedBase)
+                if (s.handle == handle)
+                    return std::addressof (s);
+
+        for (auto& s : localStrings)
+            if (s.handle == handle)
+                return std::addressof (s);
+
+        return {};
+    }
+
     StringDictionary::Handle StringDictionary::getHandleForString (std::string_view text)
     {
         if (text.empty())
             return {};
 
-        for (auto& s : strings)
+        if (sharedBase != nullptr)
+            for (auto& s : *sharedBase)
+                if (s.text == text)
+                    return s.handle;
+
+        for (auto& s : localStrings)
             if (s.text == text)
                 return s.handle;
 
         auto handle = StringDictionary::Handle { nextIndex++ };
-        strings.push_back ({ handle, std::string (text) });
+        localStrings.push_back ({ handle, std::string (text) });
         return handle;
     }
 
@@ -46,9 +104,8 @@ namespace soul
         if (handle == Handle())
             return {};
 
-        for (auto& s : strings)
-            if (s.handle == handle)
-                return s.text;
+        if (auto item = findItem (handle))
+            return item->text;
 
         SOUL_ASSERT_FALSE;
         return {};
@@ -22,13 +22,26 @@ namespace soul
 {
 
 //==============================================================================
-/** Holds a map of strings to integer handles. */
+/** Holds a map of strings to integer handles.
+
+    Copying a dictionary doesn't duplicate its contents: the items are frozen into
+    an immutable base which both copies then share, and each copy only stores the
+    strings added after the fork. Handles are issued sequentially across the base
+    and the local additions, so they remain stable across clones - cloning a
+    Program for specialisation or multi-instance playback doesn't copy every
+    string it has accumulated.
+*/
 class StringDictionary  : public choc::value::StringDictionary
 {
 public:
     StringDictionary();
     ~StringDictionary() override;
 
+    StringDictionary (const StringDictionary&);
+    StringDictionary& operator= (const StringDictionary&);
+    StringDictionary (StringDictionary&&) = default;
+    StringDictionary& operator= (StringDictionary&&) = default;
+
     Handle getHandleForString (std::string_view) override;
     std::string_view getStringForHandle (Handle) const override;
 
@@ -38,10 +51,46 @@ public:
         std::string text;
     };
 
-    std::vector<Item> strings;
+    size_t size() const;
+
+    /** Calls the given functor for each item, in handle order. */
+    template <typename Fn>
+    void forEach (Fn&& fn) const
+    {
+        if (sharedBase != nullptr)
+            for (auto& s : *sharedBase)
+                fn (s);
+
+        for (auto& s : localStrings)
+            fn (s);
+    }
+
+    /** Removes all the items matching the given predicate. If the base is shared
+        with other dictionaries, it's materialised first, so they aren't affected.
+    */
+    template <typename Pred>
+    void removeIf (Pred&& shouldRemove)
+    {
+        std::vector<Item> remaining;
+        remaining.reserve (size());
+
+        forEach ([&] (const Item& s)
+        {
+            if (! shouldRemove (s))
+                remaining.push_back (s);
+        });
+
+        sharedBase.reset();
+        localStrings = std::move (remaining);
+    }
 
 private:
+    mutable std::shared_ptr<const std::vector<Item>> sharedBase;
+    mutable std::vector<Item> localStrings;
     uint32_t nextIndex = 1;
+
+    const Item* findItem (Handle) const;
+    void freeze() const;
 };
 
 
@@ -35,13 +35,18 @@ bool PrimitiveType::isValid() const                 { return type != Primitive::
 bool PrimitiveType::isVoid() const                  { return type == Primitive::void_; }
 bool PrimitiveType::isFloat32() const               { return type == Primitive::float32; }
 bool PrimitiveType::isFloat64() const               { return type == Primitive::float64; }
+bool PrimitiveType::isFloat16() const               { return type == Primitive::float16; }
+
+// float16 is deliberately not included here: it's a storage format, and keeping it
+// out of isFloatingPoint() means every arithmetic code path has to opt into it
 bool PrimitiveType::isFloatingPoint() const         { return isFloat32() || isFloat64(); }
+
 bool PrimitiveType::isFixed() const                 { return type == Primitive::fixed; }
 bool PrimitiveType::isInteger() const               { return type == Primitive::int32 || type == Primitive::int64; }
 bool PrimitiveType::isInteger32() const             { return type == Primitive::int32; }
 bool PrimitiveType::isInteger64() const             { return type == Primitive::int64; }
 bool PrimitiveType::isBool() const                  { return type == Primitive::bool_; }
-bool PrimitiveType::canBeVectorElementType() const  { return isInteger() || isFloatingPoint() || isFixed() || isBool(); }
+bool PrimitiveType::canBeVectorElementType() const  { return isInteger() || isFloatingPoint() || isFloat16() || isFixed() || isBool(); }
 bool PrimitiveType::canBeArrayElementType() const   { return isValid() && ! isVoid(); }
 
 const char* PrimitiveType::getDescription() const
@@ -51,6 +56,7 @@ const char* PrimitiveType::getDescription() const
         case Primitive::void_:          return "void";
         case Primitive::float32:        return "float32";
         case Primitive::float64:        return "float64";
+        case Primitive::float16:        return "float16";
         case Primitive::fixed:          return "fixed";
         case Primitive::int32:          return "int32";
         case Primitive::int64:          return "int64";
@@ -66,6 +72,7 @@ const char* PrimitiveType::getShortIdentifierDescription() const
         case Primitive::void_:          return "v";
         case Primitive::float32:        return "f32";
         case Primitive::float64:        return "f64";
+        case Primitive::float16:        return "f16";
         case Primitive::fixed:          return "fix";
         case Primitive::int32:          return "i32";
         case Primitive::int64:          return "i64";
@@ -81,6 +88,7 @@ size_t PrimitiveType::getPackedSizeInBytes() const
         case Primitive::void_:          return 1;
         case Primitive::float32:        return 4;
         case Primitive::float64:        return 8;
+        case Primitive::float16:        return 2;
         case Primitive::fixed:          return 4;
         case Primitive::int32:          return 4;
         case Primitive::int64:          return 8;
@@ -104,6 +112,20 @@ Type Type::parse (std::string text)
 //==============================================================================
 bool Type::isEqual (const Type& other, int flags) const
 {
+    // Two types with identical encodings are equal under any combination of flags,
+    // so the overwhelmingly common same-type comparison is just a few integer
+    // compares and a structure pointer compare, and never needs to materialise
+    // temporary element types for the array recursion below.
+    if (category == other.category
+         && arrayElementCategory == other.arrayElementCategory
+         && isRef == other.isRef
+         && isConstant == other.isConstant
+         && primitiveType == other.primitiveType
+         && boundingSize == other.boundingSize
+         && arrayElementBoundingSize == other.arrayElementBoundingSize
+         && structure == other.structure)
+        return true;
+
     if (primitiveType != other.primitiveType)
     {
         if ((flags & treatStringAsInt32) != 0)
@@ -190,6 +212,7 @@ bool Type::isValid() const                { return category != Category::invalid
 bool Type::isVoid() const                 { return primitiveType.isVoid(); }
 bool Type::isFloat32() const              { return primitiveType.isFloat32(); }
 bool Type::isFloat64() const              { return primitiveType.isFloat64(); }
+bool Type::isFloat16() const              { return primitiveType.isFloat16(); }
 bool Type::isFloatingPoint() const        { return primitiveType.isFloatingPoint(); }
 bool Type::isInteger() const              { return primitiveType.isInteger(); }
 bool Type::isInteger32() const            { return primitiveType.isInteger32(); }
@@ -478,13 +501,26 @@ size_t Type::getPackedSizeInBytes() const
 {
     if (isVector())         return primitiveType.getPackedSizeInBytes() * static_cast<size_t> (getVectorSize());
     if (isUnsizedArray())   return sizeof (void*);
-    if (isArray())          return getArrayElementType().getPackedSizeInBytes() * static_cast<size_t> (getArraySize());
+    if (isArray())          return getArrayElementSizeInBytes() * static_cast<size_t> (getArraySize());
     if (isStruct())         return structure->getPackedSizeInBytes();
     if (isStringLiteral())  return sizeof (StringDictionary::Handle);
 
     return primitiveType.getPackedSizeInBytes();
 }
 
+size_t Type::getArrayElementSizeInBytes() const
+{
+    SOUL_ASSERT (isArray());
+
+    switch (arrayElementCategory)
+    {
+        case Category::vector:         return primitiveType.getPackedSizeInBytes() * static_cast<size_t> (arrayElementBoundingSize);
+        case Category::structure:      return structure->getPackedSizeInBytes();
+        case Category::stringLiteral:  return sizeof (StringDictionary::Handle);
+        default:                       return primitiveType.getPackedSizeInBytes();
+    }
+}
+
 bool Type::isPackedSizeTooBig() const
 {
     return getPackedSizeInBytes() > maxPackedObjectSize;
@@ -498,6 +534,7 @@ choc::value::Type Type::getExternalType() const
         if (isInteger64())  return choc::value::Type::createInt64();
         if (isFloat32())    return choc::value::Type::createFloat32();
         if (isFloat64())    return choc::value::Type::createFloat64();
+        if (isFloat16())    return choc::value::Type::createFloat32();  // external APIs see float16 data at float32 width
         if (isBool())       return choc::value::Type::createBool();
     }
 
@@ -509,6 +546,7 @@ choc::value::Type Type::getExternalType() const
         if (isInteger64())  return choc::value::Type::createVector<int64_t> (size);
         if (isFloat32())    return choc::value::Type::createVector<float>   (size);
         if (isFloat64())    return choc::value::Type::createVector<double>  (size);
+        if (isFloat16())    return choc::value::Type::createVector<float>   (size);
         if (isBool())       return choc::value::Type::createVector<bool>    (size);
     }
 
@@ -44,6 +44,7 @@ struct Type  final
     bool isVoid() const;
     bool isFloat32() const;
     bool isFloat64() const;
+    bool isFloat16() const;
     bool isFloatingPoint() const;
     bool isInteger() const;
     bool isInteger32() const;
@@ -243,6 +244,7 @@ private:
     explicit Type (Category);
     explicit Type (Structure&);
     bool isSizedType() const;
+    size_t getArrayElementSizeInBytes() const;
     static Type createSizedType (PrimitiveType, Category, ArraySize);
 
     bool operator== (const Type&) = delete; // the semantics of these are unclear: use isEqual() instead
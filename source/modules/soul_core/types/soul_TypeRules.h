@@ -50,6 +50,15 @@ struct TypeRules
             if (dest.isVoid() || source.isVoid())
                 return CastType::notPossible;
 
+            // float16 is a storage-only format: widening it never loses anything,
+            // but every conversion into it has to be requested explicitly
+            if (source.isFloat16())
+                return dest.isFloatingPoint() ? CastType::primitiveNumericLossless
+                                              : CastType::primitiveNumericReduction;
+
+            if (dest.isFloat16())
+                return CastType::primitiveNumericReduction;
+
             if (dest.isInteger32() && source.isInteger64())
                 return CastType::primitiveNumericReduction;
 
@@ -222,6 +231,12 @@ struct TypeRules
                 return value.getAsFloat() == static_cast<float> (value.getAsInt32());
         }
 
+        if (dest.isFloat16() && (type.isFloatingPoint() || type.isInteger()))
+        {
+            auto halfValue = value.tryCastToType (Type (PrimitiveType::float16));
+            return halfValue.isValid() && halfValue.getAsDouble() == value.getAsDouble();
+        }
+
         if (dest.isInteger())
         {
             if (type.isFloat64())
@@ -303,11 +318,26 @@ struct TypeRules
         return isTypeSuitableForBinaryOp (a) && isTypeSuitableForBinaryOp (b);
     }
 
+    /** Returns the float32-based equivalent for float16 operands, which arithmetic
+        is always performed with - the narrow format is for storage, not compute.
+    */
+    static Type getFloat16ComputeType (const Type& t)
+    {
+        if (! t.isFloat16())
+            return t;
+
+        return t.isVector() ? Type::createVector (PrimitiveType::float32, t.getVectorSize())
+                            : Type (PrimitiveType::float32);
+    }
+
     static BinaryOperatorTypes getTypesForArithmeticOp (const Type& a, const Type& b)
     {
         if (a.isReference())  return getTypesForArithmeticOp (a.removeReference(), b);
         if (b.isReference())  return getTypesForArithmeticOp (a, b.removeReference());
 
+        if (a.isFloat16() || b.isFloat16())
+            return getTypesForArithmeticOp (getFloat16ComputeType (a), getFloat16ComputeType (b));
+
         if (areTypesSuitableForBinaryOp (a, b))
         {
             if (a.isIdentical (b))
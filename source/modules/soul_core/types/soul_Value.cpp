@@ -25,6 +25,90 @@
 namespace soul
 {
 
+//==============================================================================
+// Software conversions between IEEE-754 binary16 and float32, used for float16
+// storage - round-to-nearest-even, with subnormals, infinities and NaNs preserved
+static uint16_t convertFloat32ToFloat16Bits (float value)
+{
+    uint32_t bits;
+    memcpy (std::addressof (bits), std::addressof (value), sizeof (bits));
+
+    auto sign     = static_cast<uint16_t> ((bits >> 16) & 0x8000u);
+    auto exponent = static_cast<int32_t> ((bits >> 23) & 0xffu);
+    auto mantissa = bits & 0x007fffffu;
+
+    if (exponent == 0xff)  // infinity or NaN
+        return static_cast<uint16_t> (sign | 0x7c00u | (mantissa != 0 ? (0x0200u | (mantissa >> 13)) : 0));
+
+    auto halfExponent = exponent - 127 + 15;
+
+    if (halfExponent >= 0x1f)  // too big: round up to infinity
+        return static_cast<uint16_t> (sign | 0x7c00u);
+
+    if (halfExponent <= 0)
+    {
+        if (halfExponent < -10)  // too small even for a subnormal: flush to zero
+            return sign;
+
+        mantissa |= 0x00800000u;
+        auto shift = static_cast<uint32_t> (14 - halfExponent);
+        auto rounding = (1u << (shift - 1)) - 1 + ((mantissa >> shift) & 1u);
+        return static_cast<uint16_t> (sign | ((mantissa + rounding) >> shift));
+    }
+
+    mantissa += 0x0fffu + ((mantissa >> 13) & 1u);
+
+    if ((mantissa & 0x00800000u) != 0)  // rounding carried into the exponent
+    {
+        mantissa = 0;
+
+        if (++halfExponent >= 0x1f)
+            return static_cast<uint16_t> (sign | 0x7c00u);
+    }
+
+    return static_cast<uint16_t> (sign | static_cast<uint32_t> (halfExponent << 10) | (mantissa >> 13));
+}
+
+static float convertFloat16BitsToFloat32 (uint16_t value)
+{
+    auto sign     = static_cast<uint32_t> (value & 0x8000u) << 16;
+    auto exponent = static_cast<uint32_t> (value >> 10) & 0x1fu;
+    auto mantissa = static_cast<uint32_t> (value & 0x03ffu);
+    uint32_t bits;
+
+    if (exponent == 0)
+    {
+        if (mantissa == 0)
+        {
+            bits = sign;
+        }
+        else  // subnormal: renormalise
+        {
+            auto e = 127 - 15 + 1;
+
+            while ((mantissa & 0x0400u) == 0)
+            {
+                mantissa <<= 1;
+                --e;
+            }
+
+            bits = sign | (static_cast<uint32_t> (e) << 23) | ((mantissa & 0x03ffu) << 13);
+        }
+    }
+    else if (exponent == 0x1f)  // infinity or NaN
+    {
+        bits = sign | 0x7f800000u | (mantissa << 13);
+    }
+    else
+    {
+        bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+    }
+
+    float result;
+    memcpy (std::addressof (result), std::addressof (bits), sizeof (result));
+    return result;
+}
+
 //==============================================================================
 struct Value::PackedData
 {
@@ -44,6 +128,7 @@ struct Value::PackedData
             if (type.isBool())         return p.printBool (getAs<uint8_t>() != 0);
             if (type.isFloat32())      return p.printFloat32 (getAs<float>());
             if (type.isFloat64())      return p.printFloat64 (getAs<double>());
+            if (type.isFloat16())      return p.printFloat16 (convertFloat16BitsToFloat32 (getAs<uint16_t>()));
         }
 
         if (type.isBoundedInt())     return p.printInt32 (getAs<Type::BoundedIntSize>());
@@ -118,7 +203,7 @@ struct Value::PackedData
 
         if (type.isBool())           return getAs<uint8_t>() != 0;
         if (type.isInteger())        return getAsInt64() != 0;
-        if (type.isFloatingPoint())  return getAsDouble() != 0;
+        if (type.isFloatingPoint() || type.isFloat16())  return getAsDouble() != 0;
 
         SOUL_ASSERT_FALSE;
         return false;
@@ -130,6 +215,7 @@ struct Value::PackedData
 
         if (type.isFloat32())        return getAs<float>();
         if (type.isFloat64())        return getAs<double>();
+        if (type.isFloat16())        return convertFloat16BitsToFloat32 (getAs<uint16_t>());
         if (type.isBool())           return getAs<uint8_t>() != 0 ? 1.0 : 0.0;
         if (type.isInteger())        return static_cast<double> (getAsInt64());
 
@@ -144,7 +230,7 @@ struct Value::PackedData
         if (type.isInteger32())      return getAs<int32_t>();
         if (type.isInteger64())      return getAs<int64_t>();
         if (type.isBool())           return getAs<uint8_t>() != 0 ? 1 : 0;
-        if (type.isFloatingPoint())  return static_cast<int64_t> (getAsDouble());
+        if (type.isFloatingPoint() || type.isFloat16())  return static_cast<int64_t> (getAsDouble());
 
         SOUL_ASSERT_FALSE;
         return {};
@@ -183,6 +269,7 @@ struct Value::PackedData
             if (type.isInteger64())     return setAs (other.type.isFloatingPoint() ? (int64_t) other.getAsDouble() : (int64_t) other.getAsInt64());
             if (type.isFloat32())       return setAs ((float) other.getAsDouble());
             if (type.isFloat64())       return setAs (other.getAsDouble());
+            if (type.isFloat16())       return setAs (convertFloat32ToFloat16Bits ((float) other.getAsDouble()));
             if (type.isBool())          return setAs (other.getAsBool() ? (uint8_t) 1 : (uint8_t) 0);
 
             SOUL_ASSERT_FALSE;
@@ -299,6 +386,7 @@ struct Value::PackedData
             if (type.isInteger64())      return negateAs<int64_t>();
             if (type.isFloat32())        return negateAs<float>();
             if (type.isFloat64())        return negateAs<double>();
+            if (type.isFloat16())        return setAs (static_cast<uint16_t> (getAs<uint16_t>() ^ 0x8000u));  // IEEE sign-flip is exact
         }
 
         SOUL_ASSERT_FALSE;
@@ -593,7 +681,7 @@ void Value::copyValue (const Value& source)
 
 bool Value::canNegate() const
 {
-    return type.isFloatingPoint() || type.isInteger();
+    return type.isFloatingPoint() || type.isFloat16() || type.isInteger();
 }
 
 Value Value::negated() const
@@ -817,6 +905,7 @@ choc::value::Value Value::toExternalValue (const ConstantTable& constantTable, c
                 if (sourceType.isInteger64())   return choc::value::createInt64 (source.getAsInt64());
                 if (sourceType.isFloat32())     return choc::value::createFloat32 (source.getAsFloat());
                 if (sourceType.isFloat64())     return choc::value::createFloat64 (source.getAsDouble());
+                if (sourceType.isFloat16())     return choc::value::createFloat32 (source.getAsFloat());
                 if (sourceType.isBool())        return choc::value::createBool (source.getAsBool());
             }
 
@@ -832,6 +921,7 @@ choc::value::Value Value::toExternalValue (const ConstantTable& constantTable, c
                 if (elementType.isInteger64())   return choc::value::createVector (size, [&] (uint32_t index)  { return source.getSubElement (index).getAsInt64(); });
                 if (elementType.isFloat32())     return choc::value::createVector (size, [&] (uint32_t index)  { return source.getSubElement (index).getAsFloat(); });
                 if (elementType.isFloat64())     return choc::value::createVector (size, [&] (uint32_t index)  { return source.getSubElement (index).getAsDouble(); });
+                if (elementType.isFloat16())     return choc::value::createVector (size, [&] (uint32_t index)  { return source.getSubElement (index).getAsFloat(); });
                 if (elementType.isBool())        return choc::value::createVector (size, [&] (uint32_t index)  { return source.getSubElement (index).getAsBool(); });
             }
 
@@ -882,7 +972,14 @@ void ValuePrinter::printFloat32 (float value)
     if (std::isnan (value))     return print ("_nan32");
     if (std::isinf (value))     return print (value > 0 ? "_inf32" : "_ninf32");
 
-    return print (choc::text::floatToString (value) + "f");
+    // formatted on the stack to avoid allocating two temporary strings per
+    // number when printing big constant tables
+    choc::text::FloatToStringBuffer<float> formatted (value);
+    char text[40];
+    auto length = (size_t) (formatted.end() - formatted.begin());
+    memcpy (text, formatted.begin(), length);
+    text[length++] = 'f';
+    return print (std::string_view (text, length));
 }
 
 void ValuePrinter::printFloat64 (double value)
@@ -891,7 +988,26 @@ void ValuePrinter::printFloat64 (double value)
     if (std::isnan (value))     return print ("_nan64");
     if (std::isinf (value))     return print (value > 0 ? "_inf64" : "_ninf64");
 
-    return print (choc::text::floatToString (value));
+    choc::text::FloatToStringBuffer<double> formatted (value);
+    return print (std::string_view (formatted.begin(), (size_t) (formatted.end() - formatted.begin())));
+}
+
+void ValuePrinter::printFloat16 (float value)
+{
+    if (value == 0)             return print ("0");
+    if (std::isnan (value))     return print ("_nan16");
+    if (std::isinf (value))     return print (value > 0 ? "_inf16" : "_ninf16");
+
+    // the value arrives widened to float32, so the float32 shortest-form text
+    // plus an f16 suffix round-trips the stored half exactly
+    choc::text::FloatToStringBuffer<float> formatted (value);
+    char text[40];
+    auto length = (size_t) (formatted.end() - formatted.begin());
+    memcpy (text, formatted.begin(), length);
+    text[length++] = 'f';
+    text[length++] = '1';
+    text[length++] = '6';
+    return print (std::string_view (text, length));
 }
 
 void ValuePrinter::beginStructMembers (const Type&)       { print ("{ "); }
@@ -171,8 +171,15 @@ struct Value  final
     choc::value::Value toExternalValue (const ConstantTable&, const StringDictionary&) const;
 
 private:
+    /** Values no bigger than this live entirely inside the object without touching the
+        heap. Constant folding churns through enormous numbers of temporary Values, and
+        32 bytes covers every scalar plus the vector and small-struct sizes that
+        dominate that traffic.
+    */
+    static constexpr size_t inlineStorageSize = 32;
+
     Type type;
-    ArrayWithPreallocation<uint8_t, 8> allocatedData;
+    ArrayWithPreallocation<uint8_t, inlineStorageSize> allocatedData;
 
     struct PackedData;
     PackedData getData() const;
@@ -191,6 +198,7 @@ struct ValuePrinter
     virtual void printInt64 (int64_t);
     virtual void printFloat32 (float);
     virtual void printFloat64 (double);
+    virtual void printFloat16 (float);
     virtual void printBool (bool);
 
     virtual void printZeroInitialiser (const Type&);
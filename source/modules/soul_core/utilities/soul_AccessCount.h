@@ -29,9 +29,26 @@ enum class AccessType
     readWrite
 };
 
+/** Counts the reads and writes of a variable or struct member.
+
+    The counters are relaxed atomics so that use-counts can be rebuilt for several
+    modules concurrently - a function may reference constants in another module's
+    namespace, so counters can be hit from more than one thread at once. Each count
+    is only read after the threads doing the counting have been joined.
+*/
 struct ReadWriteCount
 {
-    uint32_t numReads = 0, numWrites = 0;
+    ReadWriteCount() = default;
+    ReadWriteCount (const ReadWriteCount& other)  : numReads (other.numReads.load()), numWrites (other.numWrites.load()) {}
+
+    ReadWriteCount& operator= (const ReadWriteCount& other)
+    {
+        numReads = other.numReads.load();
+        numWrites = other.numWrites.load();
+        return *this;
+    }
+
+    std::atomic<uint32_t> numReads { 0 }, numWrites { 0 };
 
     void reset() noexcept
     {
@@ -39,10 +56,10 @@ struct ReadWriteCount
         numWrites = 0;
     }
 
-    void increment (AccessType mode)
+    void increment (AccessType mode) noexcept
     {
-        if (mode != AccessType::write) ++numReads;
-        if (mode != AccessType::read)  ++numWrites;
+        if (mode != AccessType::write) numReads.fetch_add (1, std::memory_order_relaxed);
+        if (mode != AccessType::read)  numWrites.fetch_add (1, std::memory_order_relaxed);
     }
 };
 
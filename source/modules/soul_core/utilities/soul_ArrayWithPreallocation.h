@@ -60,8 +60,15 @@ struct ArrayWithPreallocation
             items = getPreallocatedSpace();
             numActive = other.numActive;
 
-            for (size_t i = 0; i < numActive; ++i)
-                new (items + i) Item (std::move (other.items[i]));
+            if constexpr (std::is_trivially_copyable<Item>::value)
+            {
+                memcpy (static_cast<void*> (items), other.items, numActive * sizeof (Item));
+            }
+            else
+            {
+                for (size_t i = 0; i < numActive; ++i)
+                    new (items + i) Item (std::move (other.items[i]));
+            }
         }
     }
 
@@ -90,8 +97,15 @@ struct ArrayWithPreallocation
         {
             numActive = other.numActive;
 
-            for (size_t i = 0; i < numActive; ++i)
-                new (items + i) Item (std::move (other.items[i]));
+            if constexpr (std::is_trivially_copyable<Item>::value)
+            {
+                memcpy (static_cast<void*> (items), other.items, numActive * sizeof (Item));
+            }
+            else
+            {
+                for (size_t i = 0; i < numActive; ++i)
+                    new (items + i) Item (std::move (other.items[i]));
+            }
         }
 
         return *this;
@@ -238,8 +252,16 @@ struct ArrayWithPreallocation
         {
             reserve (newSize);
 
-            while (numActive < newSize)
-                new (items + numActive++) Item (Item());
+            if constexpr (std::is_trivially_copyable<Item>::value)
+            {
+                memset (static_cast<void*> (items + numActive), 0, (newSize - numActive) * sizeof (Item));
+                numActive = newSize;
+            }
+            else
+            {
+                while (numActive < newSize)
+                    new (items + numActive++) Item (Item());
+            }
         }
         else
         {
@@ -268,10 +290,17 @@ struct ArrayWithPreallocation
             {
                 auto* newObjects = reinterpret_cast<Item*> (new char[minSize * sizeof (Item)]);
 
-                for (size_t i = 0; i < numActive; ++i)
+                if constexpr (std::is_trivially_copyable<Item>::value)
+                {
+                    memcpy (static_cast<void*> (newObjects), items, numActive * sizeof (Item));
+                }
+                else
                 {
-                    new (newObjects + i) Item (std::move (items[i]));
-                    items[i].~Item();
+                    for (size_t i = 0; i < numActive; ++i)
+                    {
+                        new (newObjects + i) Item (std::move (items[i]));
+                        items[i].~Item();
+                    }
                 }
 
                 freeIfHeapAllocated();
@@ -121,16 +121,21 @@ namespace WaveGenerators
 template <typename ChannelSet>
 choc::value::Value createArrayFromChannelSet (ChannelSet source, uint32_t targetNumChans)
 {
-    if (targetNumChans <= source.getNumChannels())
-        return choc::value::createArray (source.getNumFrames(), targetNumChans,
-                                         [&] (uint32_t frame, uint32_t chan) { return source.getSample (chan, frame); });
+    auto numFrames = source.getNumFrames();
+
+    // Allocate the packed result up-front and interleave straight into its raw data
+    // with the block-wise kernels, rather than pushing every sample of what may be a
+    // very large sample library through the per-element value-building API.
+    choc::value::Value result (choc::value::Type::createArray (choc::value::Type::createVector<float> (targetNumChans), numFrames));
 
-    if (source.getNumChannels() == 1 && targetNumChans == 2)
-        return choc::value::createArray (source.getNumFrames(), targetNumChans,
-                                         [&] (uint32_t frame, uint32_t) { return source.getSample (0, frame); });
+    if (targetNumChans <= source.getNumChannels())
+        interleaveInto (choc::buffer::createInterleavedView (static_cast<float*> (result.getRawData()), targetNumChans, numFrames),
+                        source.getChannelRange ({ 0, targetNumChans }));
+    else
+        interleaveInto (choc::buffer::createInterleavedView (static_cast<float*> (result.getRawData()), targetNumChans, numFrames),
+                        source);
 
-    return choc::value::createArray (source.getNumFrames(), targetNumChans,
-                                     [&] (uint32_t frame, uint32_t chan) { return source.getSampleIfInRange (chan, frame); });
+    return result;
 }
 
 choc::value::Value convertChannelSetToArray (choc::buffer::ChannelArrayView<const float> source)
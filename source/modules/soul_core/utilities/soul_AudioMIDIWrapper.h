@@ -40,6 +40,8 @@ struct AudioMIDIWrapper
         totalFramesRendered = 0;
         preRenderOperations.clear();
         postRenderOperations.clear();
+        parameterChangeOperations.clear();
+        drainChangedParameters = nullptr;
         numInputChannelsExpected = 0;
         numOutputChannelsExpected = 0;
         maxBlockSize = 0;
@@ -50,25 +52,237 @@ struct AudioMIDIWrapper
     */
     using GetNewParameterValueFn = std::function<std::function<const float*()>(const EndpointDetails& inputEndpoint)>;
 
+    /** Describes how a parameter stream's value changes should be smoothed.
+        @see GetRampPropertiesForStreamFn
+    */
+    struct RampProperties
+    {
+        uint32_t rampFrames = 0;       /**< The number of frames over which a value change is spread. */
+        bool isExponential = false;    /**< If true, the value approaches its target exponentially rather than linearly. */
+    };
+
     /**
     */
-    using GetRampLengthForSparseStreamFn = std::function<uint32_t(const EndpointDetails&)>;
+    using GetRampPropertiesForStreamFn = std::function<RampProperties(const EndpointDetails&)>;
 
     /**
     */
     using HandleUnusedEventFn = std::function<bool(uint64_t eventTime, const std::string& endpointName, const choc::value::ValueView&)>;
 
+    /** An optional way for the host to say which parameters have changed, instead
+        of having every parameter polled on every block.
+
+        When one of these is supplied to buildRenderingPipeline(), the wrapper no
+        longer asks each parameter whether it has a new value each block: instead
+        it calls this once per chunk, and the host invokes the supplied function
+        with the index of each parameter that has changed since the last call.
+        Indices follow the order in which the parameter endpoints were handed to
+        GetNewParameterValueFn. With hundreds of parameters this turns a
+        per-block scan of all of them into a visit to just the dirty ones.
+    */
+    using DrainChangedParametersFn = std::function<void(const std::function<void(uint32_t parameterIndex)>&)>;
+
+    //==============================================================================
+    /** Renders sample-accurate ramps for a parameter stream, so that patches get smooth
+        parameter trajectories without every .soul file containing its own smoothing
+        boilerplate.
+
+        The generator writes a full block of frames on each call: a linear ramp uses a
+        constant per-frame increment, and an exponential one applies a one-pole
+        coefficient chosen to land within 0.1% of the target over the declared ramp
+        length, snapping to the exact target on the final frame.
+    */
+    struct ParameterRampGenerator
+    {
+        ParameterRampGenerator (uint32_t maxFramesPerBlock, RampProperties properties)
+            : rampLength (std::max (1u, properties.rampFrames)),
+              isExponential (properties.isExponential)
+        {
+            frames.resize (maxFramesPerBlock);
+        }
+
+        void setTarget (float newTarget)
+        {
+            if (! initialised)
+            {
+                // The first value received is the parameter's starting point, not a change to smooth
+                initialised = true;
+                currentValue = newTarget;
+                targetValue = newTarget;
+                return;
+            }
+
+            targetValue = newTarget;
+            framesRemaining = rampLength;
+
+            if (isExponential)
+                coefficient = std::exp (std::log (0.001f) / (float) rampLength);
+            else
+                increment = (targetValue - currentValue) / (float) rampLength;
+        }
+
+        choc::value::ValueView getNextBlock (uint32_t numFrames)
+        {
+            SOUL_ASSERT (numFrames <= frames.size());
+            auto* d = frames.data();
+
+            if (framesRemaining == 0)
+            {
+                std::fill (d, d + numFrames, currentValue);
+            }
+            else
+            {
+                for (uint32_t i = 0; i < numFrames; ++i)
+                {
+                    if (framesRemaining != 0)
+                    {
+                        if (isExponential)
+                            currentValue = targetValue + coefficient * (currentValue - targetValue);
+                        else
+                            currentValue += increment;
+
+                        if (--framesRemaining == 0)
+                            currentValue = targetValue;
+                    }
+
+                    d[i] = currentValue;
+                }
+            }
+
+            return choc::value::createArrayView (d, numFrames);
+        }
+
+        std::vector<float> frames;
+        float currentValue = 0, targetValue = 0, increment = 0, coefficient = 0;
+        uint32_t rampLength, framesRemaining = 0;
+        bool isExponential, initialised = false;
+    };
+
+    //==============================================================================
+    /** Converts incoming TimelineEvents into events of the soul::timeline struct
+        types that one endpoint declares.
+
+        The endpoint's event types are inspected once at setup: for each timeline
+        struct it accepts, a value of that exact type is prepared up-front, so
+        per-event delivery just pokes the members and hands the value over, with
+        no type building or name lookups on the rendering thread. Events of a
+        kind the endpoint doesn't declare are simply dropped.
+    */
+    struct TimelineEventSender
+    {
+        static TimelineEventSender create (const EndpointDetails& endpoint)
+        {
+            TimelineEventSender s;
+
+            for (auto& type : endpoint.dataTypes)
+            {
+                if (isTimelineTimeSignature (type))        s.timeSignature  = choc::value::Value (type);
+                else if (isTimelineTempo (type))           s.tempo          = choc::value::Value (type);
+                else if (isTimelineTempoRamp (type))       s.tempoRamp      = choc::value::Value (type);
+                else if (isTimelineTransportState (type))  s.transportState = choc::value::Value (type);
+                else if (isTimelinePosition (type))        s.position       = choc::value::Value (type);
+            }
+
+            return s;
+        }
+
+        void send (Performer& perf, EndpointHandle endpointHandle, const TimelineEvent& e)
+        {
+            switch (e.type)
+            {
+                case TimelineEvent::Type::transportState:
+                    if (transportState.isObject())
+                    {
+                        transportState.getObjectMemberAt (0).value.set (e.transportState);
+                        perf.addInputEvent (endpointHandle, transportState);
+                    }
+                    break;
+
+                case TimelineEvent::Type::timeSignature:
+                    if (timeSignature.isObject())
+                    {
+                        timeSignature.getObjectMemberAt (0).value.set (e.timeSigNumerator);
+                        timeSignature.getObjectMemberAt (1).value.set (e.timeSigDenominator);
+                        perf.addInputEvent (endpointHandle, timeSignature);
+                    }
+                    break;
+
+                case TimelineEvent::Type::tempo:
+                    if (tempo.isObject())
+                    {
+                        tempo.getObjectMemberAt (0).value.set (e.startBPM);
+                        perf.addInputEvent (endpointHandle, tempo);
+                    }
+                    // an endpoint which only understands ramps still gets plain
+                    // tempo changes, as zero-length ramps
+                    else if (tempoRamp.isObject())
+                    {
+                        tempoRamp.getObjectMemberAt (0).value.set (e.startBPM);
+                        tempoRamp.getObjectMemberAt (1).value.set (e.startBPM);
+                        tempoRamp.getObjectMemberAt (2).value.set ((int64_t) 0);
+                        perf.addInputEvent (endpointHandle, tempoRamp);
+                    }
+                    break;
+
+                case TimelineEvent::Type::tempoRamp:
+                    if (tempoRamp.isObject())
+                    {
+                        tempoRamp.getObjectMemberAt (0).value.set (e.startBPM);
+                        tempoRamp.getObjectMemberAt (1).value.set (e.endBPM);
+                        tempoRamp.getObjectMemberAt (2).value.set (e.rampLengthFrames);
+                        perf.addInputEvent (endpointHandle, tempoRamp);
+                    }
+                    // ...and one which only understands plain tempo changes gets
+                    // the ramp's end-point as a step
+                    else if (tempo.isObject())
+                    {
+                        tempo.getObjectMemberAt (0).value.set (e.endBPM);
+                        perf.addInputEvent (endpointHandle, tempo);
+                    }
+                    break;
+
+                case TimelineEvent::Type::position:
+                    if (position.isObject())
+                    {
+                        position.getObjectMemberAt (0).value.set (e.currentFrame);
+                        position.getObjectMemberAt (1).value.set (e.currentQuarterNote);
+                        position.getObjectMemberAt (2).value.set (e.lastBarStartQuarterNote);
+                        perf.addInputEvent (endpointHandle, position);
+                    }
+                    break;
+
+                default:
+                    break;
+            }
+        }
+
+        choc::value::Value timeSignature, tempo, tempoRamp, transportState, position;
+    };
+
     /**
     */
     void buildRenderingPipeline (uint32_t processorMaxBlockSize,
                                  GetNewParameterValueFn&& getNewParameterValueFn,
-                                 GetRampLengthForSparseStreamFn&& getRampLengthForSparseStreamFn,
-                                 HandleUnusedEventFn&& handleUnusedEventFn)
+                                 GetRampPropertiesForStreamFn&& getRampPropertiesForStreamFn,
+                                 HandleUnusedEventFn&& handleUnusedEventFn,
+                                 DrainChangedParametersFn&& drainChangedParametersFn = {})
     {
         SOUL_ASSERT (processorMaxBlockSize > 0);
         reset();
         auto& perf = performer;
         maxBlockSize = std::min (512u, processorMaxBlockSize);
+        drainChangedParameters = std::move (drainChangedParametersFn);
+
+        // Each parameter's change-handling op goes into parameterChangeOperations.
+        // Without a drain function it also becomes a per-block polling op, which
+        // is the classic behaviour; with one, it only runs when its index is drained.
+        auto addParameterChangeOperation = [this] (std::function<void(RenderContext&)> op)
+        {
+            parameterChangeOperations.push_back (op);
+
+            if (drainChangedParameters == nullptr)
+                preRenderOperations.push_back (std::move (op));
+        };
 
         for (auto& inputEndpoint : perf.getInputEndpoints())
         {
@@ -83,7 +297,7 @@ struct AudioMIDIWrapper
 
                         if (isEvent (inputEndpoint))
                         {
-                            preRenderOperations.push_back ([&perf, endpointHandle, floatValue, getNewValueForParamIfChanged] (RenderContext&) mutable
+                            addParameterChangeOperation ([&perf, endpointHandle, floatValue, getNewValueForParamIfChanged] (RenderContext&) mutable
                             {
                                 if (auto newValue = getNewValueForParamIfChanged())
                                 {
@@ -94,21 +308,27 @@ struct AudioMIDIWrapper
                         }
                         else if (isStream (inputEndpoint))
                         {
-                            SOUL_ASSERT (getRampLengthForSparseStreamFn != nullptr);
-                            auto rampFrames = getRampLengthForSparseStreamFn (inputEndpoint);
+                            SOUL_ASSERT (getRampPropertiesForStreamFn != nullptr);
+                            auto smoother = std::make_shared<ParameterRampGenerator> (maxBlockSize, getRampPropertiesForStreamFn (inputEndpoint));
 
-                            preRenderOperations.push_back ([&perf, endpointHandle, floatValue, getNewValueForParamIfChanged, rampFrames] (RenderContext&) mutable
+                            addParameterChangeOperation ([smoother, getNewValueForParamIfChanged] (RenderContext&)
                             {
                                 if (auto newValue = getNewValueForParamIfChanged())
-                                {
-                                    floatValue.getViewReference().set (*newValue);
-                                    perf.setSparseInputStreamTarget (endpointHandle, floatValue, rampFrames);
-                                }
+                                    smoother->setTarget (*newValue);
+                            });
+
+                            // The ramp is synthesised centrally here rather than handed to the
+                            // performer as a sparse target, so every engine gets the same
+                            // sample-accurate trajectory with the declared shape. It has to
+                            // feed the stream every block, whether or not the target moved.
+                            preRenderOperations.push_back ([&perf, endpointHandle, smoother] (RenderContext& rc)
+                            {
+                                perf.setNextInputStreamFrames (endpointHandle, smoother->getNextBlock (rc.inputChannels.getNumFrames()));
                             });
                         }
                         else if (isValue (inputEndpoint))
                         {
-                            preRenderOperations.push_back ([&perf, endpointHandle, floatValue, getNewValueForParamIfChanged] (RenderContext&) mutable
+                            addParameterChangeOperation ([&perf, endpointHandle, floatValue, getNewValueForParamIfChanged] (RenderContext&) mutable
                             {
                                 if (auto newValue = getNewValueForParamIfChanged())
                                 {
@@ -120,18 +340,79 @@ struct AudioMIDIWrapper
                     }
                 }
             }
+            else if (isTimelineEventEndpoint (inputEndpoint))
+            {
+                auto endpointHandle = perf.getEndpointHandle (inputEndpoint.endpointID);
+                auto sender = TimelineEventSender::create (inputEndpoint);
+
+                // Each chunk delivers just the events whose timestamps fall inside
+                // it, so an unchanging timeline adds no per-block work at all
+                preRenderOperations.push_back ([&perf, endpointHandle, sender] (RenderContext& rc) mutable
+                {
+                    auto chunkStart = rc.frameOffset;
+                    auto chunkEnd = chunkStart + rc.inputChannels.getNumFrames();
+
+                    for (uint32_t i = 0; i < rc.timelineInCount; ++i)
+                    {
+                        auto& e = rc.timelineIn[i];
+
+                        if (e.frameIndex >= chunkStart && e.frameIndex < chunkEnd)
+                            sender.send (perf, endpointHandle, e);
+                    }
+                });
+            }
             else if (isMIDIEventEndpoint (inputEndpoint))
             {
                 auto endpointHandle = perf.getEndpointHandle (inputEndpoint.endpointID);
-                choc::value::Value midiEvent (inputEndpoint.getSingleEventType());
 
-                preRenderOperations.push_back ([&perf, endpointHandle, midiEvent] (RenderContext& rc) mutable
+                preRenderOperations.push_back ([&perf, endpointHandle,
+                                                packedMessages = std::vector<int32_t>()] (RenderContext& rc) mutable
                 {
+                    if (rc.midiInCount == 0)
+                        return;
+
+                    // the standard MIDI message struct has a fixed layout holding one
+                    // packed int32, so the whole block's messages can go over as a
+                    // plain array with no per-message value wrapping, and the performer
+                    // only does its queue housekeeping once however dense the stream is
+                    if (packedMessages.size() < rc.midiInCount)
+                        packedMessages.resize (rc.midiInCount);
+
+                    for (uint32_t i = 0; i < rc.midiInCount; ++i)
+                        packedMessages[i] = rc.midiIn[i].getPackedMIDIData();
+
+                    perf.addInputMIDIMessages (endpointHandle, packedMessages.data(), nullptr, rc.midiInCount);
+                });
+            }
+            else if (isUMPEventEndpoint (inputEndpoint))
+            {
+                auto endpointHandle = perf.getEndpointHandle (inputEndpoint.endpointID);
+                choc::value::Value umpEvent (inputEndpoint.getSingleEventType());
+
+                preRenderOperations.push_back ([&perf, endpointHandle, umpEvent,
+                                                events = std::vector<choc::value::Value>(),
+                                                views = std::vector<choc::value::ValueView>()] (RenderContext& rc) mutable
+                {
+                    if (rc.midiInCount == 0)
+                        return;
+
+                    while (events.size() < rc.midiInCount)
+                        events.push_back (umpEvent);
+
+                    views.clear();
+
+                    // the incoming 1.0 bytes are up-converted with the standard
+                    // scaling rules, so the program sees full-width values, and
+                    // the whole block's worth goes to the performer as one batch
                     for (uint32_t i = 0; i < rc.midiInCount; ++i)
                     {
-                        midiEvent.getObjectMemberAt (0).value.set (rc.midiIn[i].getPackedMIDIData());
-                        perf.addInputEvent (endpointHandle, midiEvent);
+                        auto ump = UMPEvent::fromMIDI1 (rc.midiIn[i]);
+                        events[i].getObjectMemberAt (0).value.set ((int32_t) ump.words[0]);
+                        events[i].getObjectMemberAt (1).value.set ((int32_t) ump.words[1]);
+                        views.push_back (events[i].getViewReference());
                     }
+
+                    perf.addInputEvents (endpointHandle, views.data(), nullptr, rc.midiInCount);
                 });
             }
             else if (auto numSourceChans = inputEndpoint.getNumAudioChannels())
@@ -195,6 +476,29 @@ struct AudioMIDIWrapper
                     });
                 });
             }
+            else if (isUMPEventEndpoint (outputEndpoint))
+            {
+                auto endpointHandle = perf.getEndpointHandle (outputEndpoint.endpointID);
+
+                postRenderOperations.push_back ([&perf, endpointHandle] (RenderContext& rc)
+                {
+                    perf.iterateOutputEvents (endpointHandle, [&rc] (uint32_t frameOffset, const choc::value::ValueView& event) -> bool
+                    {
+                        if (rc.midiOutCount < rc.midiOutCapacity)
+                        {
+                            // delivering to a byte-oriented destination, so the
+                            // packet gets down-converted (losing the extra width)
+                            UMPEvent ump;
+                            ump.frameIndex = rc.frameOffset + frameOffset;
+                            ump.words[0] = (uint32_t) event["word0"].getInt32();
+                            ump.words[1] = (uint32_t) event["word1"].getInt32();
+                            rc.midiOut[rc.midiOutCount++] = ump.toMIDI1();
+                        }
+
+                        return true;
+                    });
+                });
+            }
             else if (auto numChans = outputEndpoint.getNumAudioChannels())
             {
                 auto endpointHandle = perf.getEndpointHandle (outputEndpoint.endpointID);
@@ -237,16 +541,27 @@ struct AudioMIDIWrapper
                  MIDIEvent* midiOut,
                  uint32_t midiInCount,
                  uint32_t midiOutCapacity,
-                 uint32_t& numMIDIOutMessages)
+                 uint32_t& numMIDIOutMessages,
+                 const TimelineEvent* timelineIn = nullptr,
+                 uint32_t timelineInCount = 0)
     {
         SOUL_ASSERT (input.getNumFrames() == output.getNumFrames() && maxBlockSize != 0);
 
         RenderContext context { totalFramesRendered, input, output, midiIn, midiOut, 0, midiInCount, 0, midiOutCapacity };
+        context.timelineIn = timelineIn;
+        context.timelineInCount = timelineInCount;
 
         context.iterateInBlocks (maxBlockSize, [&] (RenderContext& rc)
         {
             performer.prepare (rc.inputChannels.getNumFrames());
 
+            if (drainChangedParameters != nullptr)
+                drainChangedParameters ([this, &rc] (uint32_t parameterIndex)
+                {
+                    if (parameterIndex < parameterChangeOperations.size())
+                        parameterChangeOperations[parameterIndex] (rc);
+                });
+
             for (auto& op : preRenderOperations)
                 op (rc);
 
@@ -254,7 +569,8 @@ struct AudioMIDIWrapper
 
             for (auto& op : postRenderOperations)
                 op (rc);
-        });
+        },
+        eventSplittingPolicy);
 
         numMIDIOutMessages = context.midiOutCount;
         totalFramesRendered += input.getNumFrames();
@@ -272,15 +588,64 @@ struct AudioMIDIWrapper
         MIDIEvent* midiOut;
         uint32_t frameOffset = 0, midiInCount = 0, midiOutCount = 0, midiOutCapacity = 0;
 
+        /** The whole block's batch of timeline events; timestamps are offsets into
+            the block, and each chunk picks out the ones that fall inside it. Like
+            MIDI, a timeline event lands with frame accuracy bounded by the chunk
+            splitting below.
+        */
+        const TimelineEvent* timelineIn = nullptr;
+        uint32_t timelineInCount = 0;
+
+        /** Controls how a device callback gets split into sub-chunks around its
+            incoming events.
+
+            Splitting at every event boundary keeps events sample-accurate, but
+            with dense automation the number of chunks - and the fixed cost each
+            one pays in prepare/advance overhead - grows without limit. This
+            trades a bounded amount of timing accuracy for a bounded chunk count.
+        */
+        struct EventSplittingPolicy
+        {
+            /** An event closer than this to the start of the current chunk is
+                delivered with that chunk, arriving at most this many frames
+                early, instead of paying for a chunk of its own. Zero splits at
+                every event boundary.
+            */
+            uint32_t coalesceThresholdFrames = 16;
+
+            /** Once this many chunks have been rendered for one block, the
+                remaining events are folded into the start of whichever chunk
+                covers them rather than creating any more.
+            */
+            uint32_t maxChunksPerBlock = 64;
+        };
+
         template <typename RenderBlockFn>
-        void iterateInBlocks (uint32_t maxFramesPerBlock, RenderBlockFn&& render)
+        void iterateInBlocks (uint32_t maxFramesPerBlock, RenderBlockFn&& render, EventSplittingPolicy policy = {})
         {
             auto framesRemaining = inputChannels.getNumFrames();
             auto context = *this;
 
+            // the overwhelmingly common case is a block with no events at all,
+            // which can skip the chunking below completely
+            if (midiInCount == 0 && framesRemaining <= maxFramesPerBlock)
+            {
+                if (framesRemaining != 0)
+                {
+                    render (context);
+                    frameOffset += framesRemaining;
+                    midiOutCount = context.midiOutCount;
+                }
+
+                return;
+            }
+
+            uint32_t chunksRendered = 0;
+
             while (framesRemaining != 0)
             {
                 auto framesToDo = std::min (maxFramesPerBlock, framesRemaining);
+                auto canSplit = chunksRendered + 1 < policy.maxChunksPerBlock;
                 context.midiIn = midiIn;
                 context.midiInCount = 0;
 
@@ -290,8 +655,20 @@ struct AudioMIDIWrapper
 
                     if (time > frameOffset)
                     {
-                        framesToDo = std::min (framesToDo, time - frameOffset);
-                        break;
+                        auto distance = time - frameOffset;
+
+                        if (distance >= framesToDo)
+                            break;
+
+                        if (canSplit && distance >= policy.coalesceThresholdFrames)
+                        {
+                            framesToDo = distance;
+                            break;
+                        }
+
+                        // the event is close enough (or the chunk budget is
+                        // spent), so it's folded into this chunk and delivered
+                        // at its start
                     }
 
                     ++midiIn;
@@ -304,6 +681,7 @@ struct AudioMIDIWrapper
 
                 render (context);
 
+                ++chunksRendered;
                 frameOffset += framesToDo;
                 framesRemaining -= framesToDo;
                 context.totalFramesRendered += framesToDo;
@@ -314,6 +692,11 @@ struct AudioMIDIWrapper
         }
     };
 
+    /** Hosts can tune this to trade event timing accuracy against per-chunk
+        rendering overhead. @see RenderContext::EventSplittingPolicy
+    */
+    RenderContext::EventSplittingPolicy eventSplittingPolicy;
+
 private:
     //==============================================================================
     Performer& performer;
@@ -321,6 +704,8 @@ private:
     uint64_t totalFramesRendered = 0;
     std::vector<std::function<void(RenderContext&)>> preRenderOperations;
     std::vector<std::function<void(RenderContext&)>> postRenderOperations;
+    std::vector<std::function<void(RenderContext&)>> parameterChangeOperations;
+    DrainChangedParametersFn drainChangedParameters;
     uint32_t numInputChannelsExpected = 0, numOutputChannelsExpected = 0;
     uint32_t maxBlockSize = 0;
 };
@@ -0,0 +1,230 @@
+/*
+    _____ _____ _____ __
+   |   __|     |  |  |  |      The SOUL language
+   |__   |  |  |  |  |  |__    Copyright (c) 2019 - ROLI Ltd.
+   |_____|_____|_____|_____|
+
+   The code in this file is provided under the terms of the ISC license:
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose
+   with or without fee is hereby granted, provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#if SOUL_ARM64 || SOUL_ARM32
+ #include <arm_neon.h>
+#endif
+
+namespace soul
+{
+
+/**
+    Vectorised versions of the per-block sample buffer operations.
+
+    choc's generic copy/add/applyGain go through getSample() one sample at a
+    time, which is what every block of audio passing through the audio-MIDI
+    wrapper and the players pays. The functions here take the same buffer view
+    types, but when a channel's samples are contiguous - which they always are
+    for the separate-channel and full-width interleaved views the render path
+    uses - the work drops into flat SIMD kernels, with fused copy-with-gain and
+    add-with-gain variants so the mix path touches memory once instead of twice.
+
+    The kernels are selected per-architecture at compile time with the same
+    SOUL_INTEL / SOUL_ARM macros the rest of the module uses; anything with a
+    non-contiguous stride or a non-float sample type falls back to the scalar
+    loop.
+*/
+struct BufferOperations
+{
+    //==============================================================================
+    template <typename DestView, typename SourceView>
+    static void copyBuffer (DestView&& dest, const SourceView& source)
+    {
+        perform (dest, source, [] (float* d, const float* s, size_t n) { memcpy (d, s, n * sizeof (float)); },
+                               [] (auto& d, auto s) { d = s; });
+    }
+
+    template <typename DestView, typename SourceView>
+    static void addBuffer (DestView&& dest, const SourceView& source)
+    {
+        perform (dest, source, [] (float* d, const float* s, size_t n) { addFlat (d, s, n); },
+                               [] (auto& d, auto s) { d += s; });
+    }
+
+    template <typename DestView, typename SourceView>
+    static void copyBufferWithGain (DestView&& dest, const SourceView& source, float gain)
+    {
+        perform (dest, source, [=] (float* d, const float* s, size_t n) { copyWithGainFlat (d, s, gain, n); },
+                               [=] (auto& d, auto s) { d = s * gain; });
+    }
+
+    template <typename DestView, typename SourceView>
+    static void addBufferWithGain (DestView&& dest, const SourceView& source, float gain)
+    {
+        perform (dest, source, [=] (float* d, const float* s, size_t n) { addWithGainFlat (d, s, gain, n); },
+                               [=] (auto& d, auto s) { d += s * gain; });
+    }
+
+    template <typename BufferView>
+    static void applyGainToBuffer (BufferView&& buffer, float gain)
+    {
+        auto numChannels = buffer.getNumChannels();
+        auto numFrames = (size_t) buffer.getNumFrames();
+
+        for (decltype (numChannels) channel = 0; channel < numChannels; ++channel)
+        {
+            auto i = buffer.getIterator (channel);
+
+            if (i.stride == 1)
+            {
+                applyGainFlat (i.sample, gain, numFrames);
+                continue;
+            }
+
+            for (size_t frame = 0; frame < numFrames; ++frame)
+            {
+                *i *= gain;
+                ++i;
+            }
+        }
+    }
+
+    //==============================================================================
+    /** The flat kernels are public so code which has already established that its
+        data is contiguous (e.g. via a FixedFrameLayout) can call them directly.
+        Each processes n samples; dest and source must not partially overlap.
+    */
+    static void addFlat (float* dest, const float* source, size_t n)
+    {
+        size_t i = 0;
+
+       #if SOUL_INTEL
+        for (; i + 4 <= n; i += 4)
+            _mm_storeu_ps (dest + i, _mm_add_ps (_mm_loadu_ps (dest + i), _mm_loadu_ps (source + i)));
+       #elif SOUL_ARM64 || SOUL_ARM32
+        for (; i + 4 <= n; i += 4)
+            vst1q_f32 (dest + i, vaddq_f32 (vld1q_f32 (dest + i), vld1q_f32 (source + i)));
+       #endif
+
+        for (; i < n; ++i)
+            dest[i] += source[i];
+    }
+
+    static void copyWithGainFlat (float* dest, const float* source, float gain, size_t n)
+    {
+        size_t i = 0;
+
+       #if SOUL_INTEL
+        auto g = _mm_set1_ps (gain);
+
+        for (; i + 4 <= n; i += 4)
+            _mm_storeu_ps (dest + i, _mm_mul_ps (_mm_loadu_ps (source + i), g));
+       #elif SOUL_ARM64 || SOUL_ARM32
+        auto g = vdupq_n_f32 (gain);
+
+        for (; i + 4 <= n; i += 4)
+            vst1q_f32 (dest + i, vmulq_f32 (vld1q_f32 (source + i), g));
+       #endif
+
+        for (; i < n; ++i)
+            dest[i] = source[i] * gain;
+    }
+
+    static void addWithGainFlat (float* dest, const float* source, float gain, size_t n)
+    {
+        size_t i = 0;
+
+       #if SOUL_INTEL
+        auto g = _mm_set1_ps (gain);
+
+        for (; i + 4 <= n; i += 4)
+            _mm_storeu_ps (dest + i, _mm_add_ps (_mm_loadu_ps (dest + i),
+                                                 _mm_mul_ps (_mm_loadu_ps (source + i), g)));
+       #elif SOUL_ARM64 || SOUL_ARM32
+        auto g = vdupq_n_f32 (gain);
+
+        for (; i + 4 <= n; i += 4)
+            vst1q_f32 (dest + i, vmlaq_f32 (vld1q_f32 (dest + i), vld1q_f32 (source + i), g));
+       #endif
+
+        for (; i < n; ++i)
+            dest[i] += source[i] * gain;
+    }
+
+    static void applyGainFlat (float* data, float gain, size_t n)
+    {
+        size_t i = 0;
+
+       #if SOUL_INTEL
+        auto g = _mm_set1_ps (gain);
+
+        for (; i + 4 <= n; i += 4)
+            _mm_storeu_ps (data + i, _mm_mul_ps (_mm_loadu_ps (data + i), g));
+       #elif SOUL_ARM64 || SOUL_ARM32
+        auto g = vdupq_n_f32 (gain);
+
+        for (; i + 4 <= n; i += 4)
+            vst1q_f32 (data + i, vmulq_f32 (vld1q_f32 (data + i), g));
+       #endif
+
+        for (; i < n; ++i)
+            data[i] *= gain;
+    }
+
+private:
+    //==============================================================================
+    /** Runs one of the operations channel by channel, taking the flat kernel when
+        both sides of a channel are contiguous and the strided scalar loop when not.
+        A pair of full-width interleaved views is a single contiguous span, so it
+        collapses to one flat call covering every channel at once.
+    */
+    template <typename DestView, typename SourceView, typename FlatOp, typename SampleOp>
+    static void perform (DestView& dest, const SourceView& source, FlatOp&& flat, SampleOp&& perSample)
+    {
+        auto numChannels = dest.getNumChannels();
+        auto numFrames = (size_t) dest.getNumFrames();
+        SOUL_ASSERT (numChannels == source.getNumChannels() && dest.getNumFrames() == source.getNumFrames());
+
+        if (numChannels > 1)
+        {
+            auto d = dest.getIterator (0);
+            auto s = source.getIterator (0);
+
+            if (d.stride == numChannels && s.stride == numChannels
+                 && dest.getIterator (1).sample == d.sample + 1
+                 && source.getIterator (1).sample == s.sample + 1)
+            {
+                flat (d.sample, s.sample, numFrames * numChannels);
+                return;
+            }
+        }
+
+        for (decltype (numChannels) channel = 0; channel < numChannels; ++channel)
+        {
+            auto d = dest.getIterator (channel);
+            auto s = source.getIterator (channel);
+
+            if (d.stride == 1 && s.stride == 1)
+            {
+                flat (d.sample, s.sample, numFrames);
+                continue;
+            }
+
+            for (size_t frame = 0; frame < numFrames; ++frame)
+            {
+                perSample (*d, *s);
+                ++d;
+                ++s;
+            }
+        }
+    }
+};
+
+} // namespace soul
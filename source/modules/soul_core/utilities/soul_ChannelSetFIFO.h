@@ -21,6 +21,161 @@
 namespace soul
 {
 
+//==============================================================================
+// Layout conversion between interleaved storage and channel-array buffers sits on
+// the device callback path (and on the bulk audio-data import path), so rather
+// than the generic per-sample copy, these kernels move whole frames, with
+// specialised inner loops for the common channel counts. When the channel counts
+// don't match, they fall back to copyRemappingChannels() and its up/down-mixing rules.
+
+template <typename SourceType>
+void interleaveInto (choc::buffer::InterleavedView<float> dest, const SourceType& source)
+{
+    auto numChans = dest.getNumChannels();
+
+    if (numChans != source.getNumChannels())
+        return copyRemappingChannels (dest, source);
+
+    auto numFrames = dest.getNumFrames();
+    auto d = dest.data.data;
+    auto stride = dest.data.stride;
+
+    if (numChans == 2)
+    {
+        auto s0 = source.data.getIterator (0);
+        auto s1 = source.data.getIterator (1);
+        uint32_t i = 0;
+
+       #if SOUL_INTEL
+        if (stride == 2 && s0.stride == 1 && s1.stride == 1)
+        {
+            for (; i + 4 <= numFrames; i += 4)
+            {
+                auto left  = _mm_loadu_ps (s0.sample + i);
+                auto right = _mm_loadu_ps (s1.sample + i);
+                _mm_storeu_ps (d + 2 * i,     _mm_unpacklo_ps (left, right));
+                _mm_storeu_ps (d + 2 * i + 4, _mm_unpackhi_ps (left, right));
+            }
+
+            s0.sample += i;
+            s1.sample += i;
+        }
+       #endif
+
+        for (; i < numFrames; ++i)
+        {
+            auto frame = d + stride * i;
+            frame[0] = *s0; ++s0;
+            frame[1] = *s1; ++s1;
+        }
+    }
+    else if (numChans == 4)
+    {
+        auto s0 = source.data.getIterator (0);
+        auto s1 = source.data.getIterator (1);
+        auto s2 = source.data.getIterator (2);
+        auto s3 = source.data.getIterator (3);
+
+        for (uint32_t i = 0; i < numFrames; ++i)
+        {
+            d[0] = *s0; ++s0;
+            d[1] = *s1; ++s1;
+            d[2] = *s2; ++s2;
+            d[3] = *s3; ++s3;
+            d += stride;
+        }
+    }
+    else
+    {
+        for (uint32_t ch = 0; ch < numChans; ++ch)
+        {
+            auto src = source.data.getIterator (ch);
+            auto dst = d + ch;
+
+            for (uint32_t i = 0; i < numFrames; ++i)
+            {
+                *dst = *src;
+                ++src;
+                dst += stride;
+            }
+        }
+    }
+}
+
+template <typename DestType>
+void deinterleaveInto (DestType&& dest, choc::buffer::InterleavedView<const float> source)
+{
+    auto numChans = source.getNumChannels();
+
+    if (numChans != dest.getNumChannels())
+        return copyRemappingChannels (dest, source);
+
+    auto numFrames = source.getNumFrames();
+    auto s = source.data.data;
+    auto stride = source.data.stride;
+
+    if (numChans == 2)
+    {
+        auto d0 = dest.data.getIterator (0);
+        auto d1 = dest.data.getIterator (1);
+        uint32_t i = 0;
+
+       #if SOUL_INTEL
+        if (stride == 2 && d0.stride == 1 && d1.stride == 1)
+        {
+            for (; i + 4 <= numFrames; i += 4)
+            {
+                auto frames01 = _mm_loadu_ps (s + 2 * i);
+                auto frames23 = _mm_loadu_ps (s + 2 * i + 4);
+                _mm_storeu_ps (d0.sample + i, _mm_shuffle_ps (frames01, frames23, _MM_SHUFFLE (2, 0, 2, 0)));
+                _mm_storeu_ps (d1.sample + i, _mm_shuffle_ps (frames01, frames23, _MM_SHUFFLE (3, 1, 3, 1)));
+            }
+
+            d0.sample += i;
+            d1.sample += i;
+        }
+       #endif
+
+        for (; i < numFrames; ++i)
+        {
+            auto frame = s + stride * i;
+            *d0 = frame[0]; ++d0;
+            *d1 = frame[1]; ++d1;
+        }
+    }
+    else if (numChans == 4)
+    {
+        auto d0 = dest.data.getIterator (0);
+        auto d1 = dest.data.getIterator (1);
+        auto d2 = dest.data.getIterator (2);
+        auto d3 = dest.data.getIterator (3);
+
+        for (uint32_t i = 0; i < numFrames; ++i)
+        {
+            *d0 = s[0]; ++d0;
+            *d1 = s[1]; ++d1;
+            *d2 = s[2]; ++d2;
+            *d3 = s[3]; ++d3;
+            s += stride;
+        }
+    }
+    else
+    {
+        for (uint32_t ch = 0; ch < numChans; ++ch)
+        {
+            auto dst = dest.data.getIterator (ch);
+            auto src = s + ch;
+
+            for (uint32_t i = 0; i < numFrames; ++i)
+            {
+                *dst = *src;
+                ++dst;
+                src += stride;
+            }
+        }
+    }
+}
+
 //==============================================================================
 struct ChannelSetFIFO
 {
@@ -67,12 +222,12 @@ struct ChannelSetFIFO
         if (w.failed())
             return false;
 
-        copyRemappingChannels (buffer.getFrameRange ({ (uint32_t) w.startIndex1, (uint32_t) (w.startIndex1 + w.blockSize1) }),
-                               sourceData.getStart ((uint32_t) w.blockSize1));
+        interleaveInto (buffer.getFrameRange ({ (uint32_t) w.startIndex1, (uint32_t) (w.startIndex1 + w.blockSize1) }),
+                        sourceData.getStart ((uint32_t) w.blockSize1));
 
         if (w.blockSize2 != 0)
-            copyRemappingChannels (buffer.getStart ((uint32_t) w.blockSize2),
-                                   sourceData.getFrameRange ({ (uint32_t) w.blockSize1, (uint32_t) (w.blockSize1 + w.blockSize2) }));
+            interleaveInto (buffer.getStart ((uint32_t) w.blockSize2),
+                            sourceData.getFrameRange ({ (uint32_t) w.blockSize1, (uint32_t) (w.blockSize1 + w.blockSize2) }));
 
         return true;
     }
@@ -94,12 +249,12 @@ struct ChannelSetFIFO
             return false;
         }
 
-        copyRemappingChannels (dest.getStart ((uint32_t) r.blockSize1),
-                               buffer.getFrameRange ({ (uint32_t) r.startIndex1, (uint32_t) (r.startIndex1 + r.blockSize1) }));
+        deinterleaveInto (dest.getStart ((uint32_t) r.blockSize1),
+                          buffer.getFrameRange ({ (uint32_t) r.startIndex1, (uint32_t) (r.startIndex1 + r.blockSize1) }));
 
         if (r.blockSize2 != 0)
-            copyRemappingChannels (dest.getFrameRange ({ (uint32_t) r.blockSize1, (uint32_t) (r.blockSize1 + r.blockSize2) }),
-                                   buffer.getStart ((uint32_t) r.blockSize2));
+            deinterleaveInto (dest.getFrameRange ({ (uint32_t) r.blockSize1, (uint32_t) (r.blockSize1 + r.blockSize2) }),
+                              buffer.getStart ((uint32_t) r.blockSize2));
 
         return true;
     }
@@ -76,4 +76,102 @@ struct EventFIFO
     Type eventType;
 };
 
+//==============================================================================
+/** A bounded, lock-free FIFO for time-stamped events, which any number of
+    threads may push to concurrently, with a single consumer popping.
+
+    Unlike EventFIFO this needs no external serialisation of the producers, so
+    several UI or control threads can feed events straight to the audio thread.
+    The slots are pre-filled with zero-initialised values of the event type, so
+    neither pushing nor popping allocates. Events come out in the order that
+    their pushes completed, each with its timestamp untouched.
+*/
+struct MultiProducerEventFIFO
+{
+    MultiProducerEventFIFO (const Type& type)
+       : slots (std::make_unique<Slot[]> (capacity)), eventType (type)
+    {
+        auto emptyValue = Value::zeroInitialiser (eventType);
+
+        for (uint32_t i = 0; i < capacity; i++)
+        {
+            slots[i].sequence.store (i, std::memory_order_relaxed);
+            slots[i].event.time = 0;
+            slots[i].event.value = emptyValue;
+        }
+    }
+
+    using Event = EventFIFO<uint64_t>::Event;
+
+    /** Attempts to push an event; this may be called from any thread.
+        Returns false if the FIFO was full, in which case the event is discarded.
+    */
+    bool pushEvent (uint64_t eventTime, const soul::Value& value) noexcept
+    {
+        SOUL_ASSERT (value.getType().isIdentical (eventType));
+        auto pos = writePos.load (std::memory_order_relaxed);
+
+        for (;;)
+        {
+            auto& slot = getSlot (pos);
+            auto sequence = slot.sequence.load (std::memory_order_acquire);
+
+            if (sequence == pos)
+            {
+                // Claim this slot - on failure pos is reloaded and we retry
+                if (writePos.compare_exchange_weak (pos, pos + 1, std::memory_order_relaxed))
+                {
+                    slot.event.time = eventTime;
+                    slot.event.value.copyValue (value);
+                    slot.sequence.store (pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (sequence < pos)
+            {
+                return false; // the consumer hasn't freed this slot yet, so the FIFO is full
+            }
+            else
+            {
+                pos = writePos.load (std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /** Pops the next available event into the given functor, which takes a
+        (uint64_t time, const soul::Value& value) pair.
+        This must only ever be called by a single consumer thread.
+        Returns false if the FIFO was empty.
+    */
+    template <typename HandleEventFn>
+    bool popNextEvent (HandleEventFn&& handleEvent) noexcept
+    {
+        auto& slot = getSlot (readPos);
+
+        if (slot.sequence.load (std::memory_order_acquire) != readPos + 1)
+            return false;
+
+        handleEvent (slot.event.time, slot.event.value);
+        slot.sequence.store (readPos + capacity, std::memory_order_release);
+        ++readPos;
+        return true;
+    }
+
+    static constexpr uint32_t capacity = 1024;
+
+private:
+    struct Slot
+    {
+        std::atomic<uint64_t> sequence { 0 };
+        Event event;
+    };
+
+    Slot& getSlot (uint64_t pos) noexcept    { return slots[pos % capacity]; }
+
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<uint64_t> writePos { 0 };
+    uint64_t readPos = 0;  // only ever touched by the consumer thread
+    Type eventType;
+};
+
 }
@@ -23,26 +23,28 @@ namespace soul
 
 //==============================================================================
 /** A single-reader, single-writer threaded FIFO.
+
+    The read and write positions are monotonic counters kept on separate cache
+    lines, so the reader and writer cores don't false-share. When enough data or
+    space is already available, a read or write operation reserves its batch of
+    slots, fills them, and publishes the whole batch with a single release store,
+    without touching the mutex - the lock and condition variable only come into
+    play when an operation actually has to wait for the other side.
 */
 struct FIFO
 {
-    FIFO (int size) : totalSize (size), freeSize (size - 1) {}
-
-    std::mutex lock;
-    std::condition_variable changed;
-    int totalSize, validStart = 0, validSize = 0, freeSize = 0;
-    bool isCancelled = false;
+    FIFO (int size) : totalSize (size) {}
 
     int getTotalSize() const noexcept    { return totalSize; }
-    int getFreeSpace() const noexcept    { return freeSize; }
-    int getNumReady() const noexcept     { return validSize; }
+    int getFreeSpace() const noexcept    { return totalSize - 1 - getNumReady(); }
+    int getNumReady() const noexcept     { return (int) (writePos.load (std::memory_order_acquire)
+                                                          - readPos.load (std::memory_order_acquire)); }
 
     void reset()
     {
         std::lock_guard<std::mutex> l (lock);
-        validStart = 0;
-        validSize = 0;
-        freeSize = totalSize - 1;
+        readPos = 0;
+        writePos = 0;
         isCancelled = false;
         changed.notify_all();
     }
@@ -60,26 +62,26 @@ struct FIFO
         ReadOperation (FIFO& f, int numWanted, std::chrono::high_resolution_clock::time_point deadline) : fifo (f)
         {
             SOUL_ASSERT (numWanted > 0 && numWanted <= f.totalSize);
-            std::unique_lock<std::mutex> l (f.lock);
+            auto read = f.readPos.load (std::memory_order_relaxed);
 
-            while (f.validSize < numWanted)
-                if (! f.waitForChange (l, deadline))
+            if (f.writePos.load (std::memory_order_acquire) - read < (uint64_t) numWanted)
+                if (! f.waitUntil (deadline, [&f, read, numWanted]
+                                   { return f.writePos.load (std::memory_order_seq_cst) - read >= (uint64_t) numWanted; }))
                     return;
 
-            startIndex1 = f.validStart;
+            startIndex1 = (int) (read % (uint64_t) f.totalSize);
             blockSize1 = std::min (f.totalSize - startIndex1, numWanted);
             blockSize2 = std::max (0, numWanted - blockSize1);
         }
 
         ~ReadOperation()
         {
-            std::lock_guard<std::mutex> l (fifo.lock);
-            auto numDone = blockSize1 + blockSize2;
-            auto newStart = fifo.validStart + numDone;
-            fifo.validStart = newStart >= fifo.totalSize ? (newStart - fifo.totalSize) : newStart;
-            fifo.validSize -= numDone;
-            fifo.freeSize += numDone;
-            fifo.changed.notify_all();
+            if (auto numDone = blockSize1 + blockSize2)
+            {
+                fifo.readPos.store (fifo.readPos.load (std::memory_order_relaxed) + (uint64_t) numDone,
+                                    std::memory_order_seq_cst);
+                fifo.notifyWaiters();
+            }
         }
 
         bool failed() const         { return blockSize1 == 0; }
@@ -94,25 +96,31 @@ struct FIFO
         WriteOperation (FIFO& f, int numToWrite, std::chrono::high_resolution_clock::time_point deadline) : fifo (f)
         {
             SOUL_ASSERT (numToWrite > 0 && numToWrite <= f.totalSize);
-            std::unique_lock<std::mutex> l (f.lock);
+            auto write = f.writePos.load (std::memory_order_relaxed);
 
-            while (f.freeSize < numToWrite)
-                if (! f.waitForChange (l, deadline))
+            auto getFree = [&f, write] (std::memory_order order)
+            {
+                return f.totalSize - 1 - (int) (write - f.readPos.load (order));
+            };
+
+            if (getFree (std::memory_order_acquire) < numToWrite)
+                if (! f.waitUntil (deadline, [&getFree, numToWrite]
+                                   { return getFree (std::memory_order_seq_cst) >= numToWrite; }))
                     return;
 
-            auto freeStart = f.validStart + f.validSize;
-            startIndex1 = freeStart >= f.totalSize ? freeStart - f.totalSize : freeStart;
+            startIndex1 = (int) (write % (uint64_t) f.totalSize);
             blockSize1 = std::min (f.totalSize - startIndex1, numToWrite);
             blockSize2 = std::max (0, numToWrite - blockSize1);
         }
 
         ~WriteOperation()
         {
-            std::lock_guard<std::mutex> l (fifo.lock);
-            auto numDone = blockSize1 + blockSize2;
-            fifo.validSize += numDone;
-            fifo.freeSize -= numDone;
-            fifo.changed.notify_all();
+            if (auto numDone = blockSize1 + blockSize2)
+            {
+                fifo.writePos.store (fifo.writePos.load (std::memory_order_relaxed) + (uint64_t) numDone,
+                                     std::memory_order_seq_cst);
+                fifo.notifyWaiters();
+            }
         }
 
         bool failed() const         { return blockSize1 == 0; }
@@ -122,11 +130,51 @@ struct FIFO
     };
 
 private:
-    bool waitForChange (std::unique_lock<std::mutex>& l,
-                        std::chrono::high_resolution_clock::time_point deadline)
+    template <typename IsReadyFn>
+    bool waitUntil (std::chrono::high_resolution_clock::time_point deadline, IsReadyFn&& isReady)
+    {
+        std::unique_lock<std::mutex> l (lock);
+        numWaiting.fetch_add (1, std::memory_order_seq_cst);
+        bool success;
+
+        for (;;)
+        {
+            if (isReady())                  { success = true;  break; }
+            if (isCancelled)                { success = false; break; }
+
+            if (changed.wait_until (l, deadline) == std::cv_status::timeout)
+            {
+                success = isReady();
+                break;
+            }
+        }
+
+        numWaiting.fetch_sub (1, std::memory_order_relaxed);
+        return success;
+    }
+
+    // A publishing thread uses a seq_cst store of its position followed by this
+    // waiter-count check; a would-be waiter registers itself with a seq_cst
+    // increment before re-testing the positions. That Dekker-style handshake means
+    // either the publisher sees the waiter and notifies it, or the waiter sees the
+    // freshly published position and never sleeps.
+    void notifyWaiters()
     {
-        return ! (isCancelled || changed.wait_until (l, deadline) == std::cv_status::timeout);
+        if (numWaiting.load (std::memory_order_seq_cst) != 0)
+        {
+            std::lock_guard<std::mutex> l (lock);
+            changed.notify_all();
+        }
     }
+
+    alignas (64) std::atomic<uint64_t> readPos { 0 };
+    alignas (64) std::atomic<uint64_t> writePos { 0 };
+    alignas (64) std::atomic<int> numWaiting { 0 };
+
+    int totalSize;
+    std::mutex lock;
+    std::condition_variable changed;
+    bool isCancelled = false;
 };
 
 } // namespace soul
@@ -39,6 +39,11 @@ struct Identifier  final
     bool operator== (const std::string& other) const                { SOUL_ASSERT (isValid()); return *name == other; }
     bool operator!= (const std::string& other) const                { SOUL_ASSERT (isValid()); return *name != other; }
 
+    /** Identifiers from the same pool are interned, so a hash of the pointer is as
+        good as a hash of the name itself, without looking at any characters.
+    */
+    static size_t getRawPointerHash (const Identifier& i) noexcept  { return reinterpret_cast<size_t> (i.name); }
+
     //==============================================================================
     struct Pool  final
     {
@@ -50,36 +55,18 @@ struct Identifier  final
         {
             SOUL_ASSERT (! newString.empty());
 
-            size_t s = 0;
-            size_t e = strings.size();
-
-            while (s < e)
-            {
-                auto* elem = strings[s].get();
-
-                if (*elem == newString)
-                    return Identifier (elem);
-
-                auto halfway = (s + e) / 2;
-                bool isBeforeHalfway = (newString < *strings[halfway]);
+            auto existing = strings.find (newString);
 
-                if (halfway == s)
-                {
-                    if (! isBeforeHalfway)
-                        ++s;
+            if (existing != strings.end())
+                return Identifier (existing->second.get());
 
-                    break;
-                }
+            auto sharedString = std::make_unique<std::string> (newString);
+            auto* stringPointer = sharedString.get();
 
-                if (isBeforeHalfway)
-                    e = halfway;
-                else
-                    s = halfway;
-            }
-
-            auto* sharedString = new std::string (newString);
-            strings.insert (strings.begin() + (int) s, std::unique_ptr<std::string> (sharedString));
-            return Identifier (sharedString);
+            // NB: the key views the heap-allocated string, whose address is stable
+            // for the lifetime of the pool
+            strings.emplace (std::string_view (*stringPointer), std::move (sharedString));
+            return Identifier (stringPointer);
         }
 
         Identifier get (const Identifier& i)
@@ -96,7 +83,7 @@ struct Identifier  final
         }
 
     private:
-        std::vector<std::unique_ptr<std::string>> strings;
+        std::unordered_map<std::string_view, std::unique_ptr<std::string>> strings;
     };
 
 private:
@@ -285,3 +272,12 @@ struct IdentifierPath  final
 
 
 } // namespace soul
+
+namespace std
+{
+    template <>
+    struct hash<soul::Identifier>
+    {
+        size_t operator() (const soul::Identifier& i) const noexcept   { return soul::Identifier::getRawPointerHash (i); }
+    };
+}
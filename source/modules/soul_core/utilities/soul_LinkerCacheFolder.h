@@ -0,0 +1,207 @@
+/*
+    _____ _____ _____ __
+   |   __|     |  |  |  |      The SOUL language
+   |__   |  |  |  |  |  |__    Copyright (c) 2019 - ROLI Ltd.
+   |_____|_____|_____|_____|
+
+   The code in this file is provided under the terms of the ISC license:
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose
+   with or without fee is hereby granted, provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+namespace soul
+{
+
+//==============================================================================
+/**
+    A LinkerCache which stores its entries as files under a folder, and which is
+    safe for many processes to share.
+
+    Writes go to a uniquely-named temporary file which is then renamed into
+    place: the rename is atomic on the filesystems we care about, so a reader
+    can never see a half-written entry, and neither reads nor writes take any
+    lock. Entries are sharded into subfolders by the leading characters of the
+    key so that no single directory grows unboundedly, and the whole layout
+    lives under a generation folder whose name can be bumped if the format
+    ever changes.
+
+    The cache is bounded by total size: a sweep orders the entries by their
+    timestamp (which a successful read refreshes, making the sweep LRU) and
+    deletes the oldest until the budget is met. Concurrent sweeps from other
+    processes are harmless - a file that has already gone just gets skipped.
+*/
+struct LinkerCacheFolder final  : public LinkerCache
+{
+    /** Creates a cache under the given folder, creating it if needed.
+        maxTotalBytes bounds the combined size of the cached entries.
+    */
+    LinkerCacheFolder (std::string cacheFolder, uint64_t maxTotalBytes = 256 * 1024 * 1024)
+        : root (std::filesystem::path (std::move (cacheFolder)) / getGenerationFolderName()),
+          maxTotalSize (maxTotalBytes)
+    {
+        std::error_code errorIgnored;
+        std::filesystem::create_directories (root, errorIgnored);
+
+        std::random_device seed;
+        temporaryNamePrefix = "tmp_" + toHexString ((int64_t) ((((uint64_t) seed()) << 32) ^ (uint64_t) seed())) + "_";
+    }
+
+    ~LinkerCacheFolder() override = default;
+
+    void storeItem (const char* key, const void* sourceData, uint64_t size) override
+    {
+        SOUL_ASSERT (sourceData != nullptr && size != 0);
+
+        std::error_code errorIgnored;
+        auto target = getPathForKey (key);
+        std::filesystem::create_directories (target.parent_path(), errorIgnored);
+
+        // the temporary name is unique to this process and write, so concurrent
+        // stores of the same key just race benignly on the final rename
+        auto temporary = target.parent_path() / (temporaryNamePrefix + std::to_string (++temporaryNameCounter));
+
+        {
+            std::ofstream out (temporary, std::ios::binary | std::ios::trunc);
+
+            if (! out.write (static_cast<const char*> (sourceData), (std::streamsize) size))
+            {
+                out.close();
+                std::filesystem::remove (temporary, errorIgnored);
+                return;
+            }
+        }
+
+        std::filesystem::rename (temporary, target, errorIgnored);
+
+        if (errorIgnored)
+            std::filesystem::remove (temporary, errorIgnored);
+
+        purgeIfOverBudget();
+    }
+
+    uint64_t readItem (const char* key, void* destAddress, uint64_t destSize) override
+    {
+        auto path = getPathForKey (key);
+
+        std::error_code errorCode;
+        auto fileSize = (uint64_t) std::filesystem::file_size (path, errorCode);
+
+        if (errorCode || fileSize == 0)
+            return 0;
+
+        if (destAddress == nullptr || destSize < fileSize)
+            return fileSize;
+
+        {
+            std::ifstream in (path, std::ios::binary);
+
+            if (! in.read (static_cast<char*> (destAddress), (std::streamsize) fileSize))
+                return 0;
+        }
+
+        // refresh the timestamp so the eviction sweep treats this as recently used
+        std::filesystem::last_write_time (path, std::filesystem::file_time_type::clock::now(), errorCode);
+        return fileSize;
+    }
+
+    /** Deletes least-recently-used entries until the cache fits in the given budget. */
+    void purgeToFitSize (uint64_t maxTotalBytes)
+    {
+        // one sweep at a time per instance is plenty - other processes sweeping
+        // concurrently just means some deletions fail harmlessly
+        std::lock_guard<std::mutex> l (purgeLock);
+
+        struct Entry
+        {
+            std::filesystem::path path;
+            std::filesystem::file_time_type lastUsed;
+            uint64_t size;
+
+            bool operator< (const Entry& other) const    { return lastUsed < other.lastUsed; }
+        };
+
+        std::vector<Entry> entries;
+        uint64_t totalSize = 0;
+        std::error_code errorIgnored;
+
+        for (auto& file : std::filesystem::recursive_directory_iterator (root, errorIgnored))
+        {
+            std::error_code entryError;
+
+            if (! file.is_regular_file (entryError))
+                continue;
+
+            auto size = (uint64_t) file.file_size (entryError);
+
+            if (entryError)
+                continue;
+
+            auto lastUsed = file.last_write_time (entryError);
+
+            if (entryError)
+                continue;
+
+            entries.push_back ({ file.path(), lastUsed, size });
+            totalSize += size;
+        }
+
+        if (totalSize <= maxTotalBytes)
+            return;
+
+        std::sort (entries.begin(), entries.end());
+
+        for (auto& entry : entries)
+        {
+            if (totalSize <= maxTotalBytes)
+                break;
+
+            std::filesystem::remove (entry.path, errorIgnored);
+            totalSize -= entry.size;
+        }
+    }
+
+private:
+    //==============================================================================
+    std::filesystem::path root;
+    uint64_t maxTotalSize;
+    std::string temporaryNamePrefix;
+    std::atomic<uint64_t> temporaryNameCounter { 0 };
+    std::atomic<uint32_t> storesSincePurge { 0 };
+    std::mutex purgeLock;
+
+    static constexpr const char* getGenerationFolderName()    { return "soul_cache_v1"; }
+
+    std::filesystem::path getPathForKey (const char* key) const
+    {
+        SOUL_ASSERT (key != nullptr);
+
+        // the keys are alphanumeric hash strings, but anything unexpected gets
+        // stripped rather than ending up in a filename
+        auto safeKey = makeSafeIdentifierName (key);
+        SOUL_ASSERT (safeKey.length() > 2);
+
+        // shard by the tail of the key, which is the most uniformly-distributed
+        // part of the hash strings the compiler produces
+        auto shard = safeKey.substr (safeKey.length() - 2);
+        return root / shard / safeKey;
+    }
+
+    void purgeIfOverBudget()
+    {
+        // scanning the whole tree on every store would make dense write bursts
+        // quadratic, so the sweep runs on the first store and every 64th after that
+        if ((storesSincePurge++ & 63u) == 0)
+            purgeToFitSize (maxTotalSize);
+    }
+};
+
+} // namespace soul
@@ -34,7 +34,67 @@ bool inExceptionHandler()
    #endif
 }
 
-ScopedDisableDenormals::ScopedDisableDenormals() noexcept  : oldFlags (getFPMode())
+std::string getCPUFeatureDescription()
+{
+   #if SOUL_ARM64
+    // NEON is architecturally guaranteed on arm64, so the name says it all
+    return "arm64";
+   #elif SOUL_ARM32
+    #if __ARM_NEON__
+     return "arm32_neon";
+    #else
+     return "arm32";
+    #endif
+   #else
+    std::string features = "x86";
+
+    #if defined (__GNUC__) || defined (__clang__)
+     if (__builtin_cpu_supports ("sse4.2"))   features += "_sse42";
+     if (__builtin_cpu_supports ("avx"))      features += "_avx";
+     if (__builtin_cpu_supports ("avx2"))     features += "_avx2";
+     if (__builtin_cpu_supports ("fma"))      features += "_fma";
+     if (__builtin_cpu_supports ("avx512f"))  features += "_avx512f";
+    #endif
+
+    return features;
+   #endif
+}
+
+CPUISATier getHighestSupportedISATier()
+{
+   #if SOUL_ARM64 || SOUL_ARM32
+    // NEON is the only tier these architectures distinguish, and it's the baseline
+    return CPUISATier::baseline;
+   #else
+    #if defined (__GNUC__) || defined (__clang__)
+     if (__builtin_cpu_supports ("avx512f"))                                 return CPUISATier::avx512;
+     if (__builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma"))  return CPUISATier::avx2_fma;
+     if (__builtin_cpu_supports ("avx"))                                     return CPUISATier::avx;
+     if (__builtin_cpu_supports ("sse4.2"))                                  return CPUISATier::sse42;
+    #endif
+
+    return CPUISATier::baseline;
+   #endif
+}
+
+const char* getISATierName (CPUISATier tier)
+{
+    switch (tier)
+    {
+        case CPUISATier::sse42:     return "sse42";
+        case CPUISATier::avx:       return "avx";
+        case CPUISATier::avx2_fma:  return "avx2_fma";
+        case CPUISATier::avx512:    return "avx512";
+        case CPUISATier::baseline:
+        default:                    return "baseline";
+    }
+}
+
+ScopedDisableDenormals::ScopedDisableDenormals() noexcept  : ScopedDisableDenormals (true)
+{
+}
+
+ScopedDisableDenormals::ScopedDisableDenormals (bool shouldFlush) noexcept  : oldFlags (getFPMode())
 {
    #if SOUL_ARM64 || SOUL_ARM32
     constexpr intptr_t mask = 1 << 24;
@@ -42,7 +102,8 @@ ScopedDisableDenormals::ScopedDisableDenormals() noexcept  : oldFlags (getFPMode
     constexpr intptr_t mask = 0x8040;
    #endif
 
-    setFPMode (oldFlags | mask);
+    if (shouldFlush)
+        setFPMode (oldFlags | mask);
 }
 
 ScopedDisableDenormals::~ScopedDisableDenormals() noexcept
@@ -64,6 +64,45 @@ void ignoreUnused (Types&&...) noexcept {}
 /** Returns whether an exception is in the process of being unwound. */
 bool inExceptionHandler();
 
+/** Returns a short string describing the architecture and the SIMD feature set
+    of the CPU this process is running on, e.g. "x86_sse42_avx2_fma".
+
+    The description only changes when code generated for this machine would no
+    longer be valid on another, so it's suitable for keying caches of compiled
+    code that are shared between machines.
+*/
+std::string getCPUFeatureDescription();
+
+//==============================================================================
+/** The SIMD instruction-set tiers that generated code can be specialised for,
+    in increasing order of capability, so that comparing two tiers numerically
+    means "at least as capable as".
+
+    These deliberately name the bundles that matter for kernel selection rather
+    than individual CPUID flags: each tier implies the ones below it, as they do
+    in real processors, which is what makes a one-time "highest supported tier"
+    probe a safe dispatch key.
+*/
+enum class CPUISATier
+{
+    baseline = 0,   /**< The architecture's guaranteed floor: SSE2 on x86_64, NEON on arm64. */
+    sse42,          /**< x86 with SSE4.2. */
+    avx,            /**< x86 with 256-bit AVX float. */
+    avx2_fma,       /**< x86 with AVX2 integer ops and FMA. */
+    avx512          /**< x86 with the AVX-512 foundation set. */
+};
+
+/** Returns the widest ISA tier the running CPU supports. The answer can't
+    change for the life of the process, so callers may sample it once and bake
+    the resulting dispatch decision in permanently.
+*/
+CPUISATier getHighestSupportedISATier();
+
+/** Returns a short lowercase name for a tier, e.g. "avx2_fma", matching the
+    feature fragments used by getCPUFeatureDescription().
+*/
+const char* getISATierName (CPUISATier);
+
 //==============================================================================
 /** Rounds-up a size to a value which is a multiple of the given granularity. */
 template <int granularity, typename SizeType>
@@ -156,6 +195,13 @@ struct TemporaryDataHolder
 struct ScopedDisableDenormals
 {
     ScopedDisableDenormals() noexcept;
+
+    /** Like the default constructor, but only sets the flush-to-zero flags when
+        shouldFlush is true, so callers with a runtime option don't need two code
+        paths. The previous FP mode is restored on destruction either way.
+    */
+    explicit ScopedDisableDenormals (bool shouldFlush) noexcept;
+
     ~ScopedDisableDenormals() noexcept;
 
 private:
@@ -25,44 +25,77 @@ namespace soul
 /** Tracks a list of pointers, giving them opaque 32-bit handles which can be
     converted back to pointers in O(1), and which adds a custom mask to the handle
     to help avoid clashes between handles for different types of object.
+
+    Internally this is a generational slot-map: the live pointers sit in one
+    dense array (so iterating them touches contiguous memory with no null-slot
+    skipping), and a handle encodes a slot index plus a generation counter. A
+    slot's generation is bumped each time it's freed, so a stale handle held
+    after its object was deregistered decodes to a mismatched generation and
+    dereferences to nullptr instead of whatever object recycled the slot. The
+    handle lookup is two array reads and a compare - no searching - which
+    matters because endpoint handles get dereferenced per event on the audio
+    path.
+
+    The generation counter is 8 bits, so a stale handle only becomes ambiguous
+    after its exact slot has been recycled 256 times - and misuse of that kind
+    is already an assertion failure in debug builds.
 */
 template <typename Type, typename HandleType, uint32_t maskBits>
 struct ObjectHandleList
 {
     Type* getFrom (HandleType handle) const noexcept
     {
-        auto index = ((uint32_t) (uint64_t) handle) ^ maskBits;
-        return index < objects.size() ? objects[index] : nullptr;
+        auto decoded = ((uint32_t) (uint64_t) handle) ^ maskBits;
+        auto index = decoded & indexMask;
+
+        if (index >= slots.size())
+            return nullptr;
+
+        auto& slot = slots[index];
+
+        if (slot.generation != (uint8_t) (decoded >> indexBits) || ! slot.isLive())
+            return nullptr;
+
+        return liveObjects[slot.denseIndex].object;
     }
 
     HandleType registerObject (Type* o)
     {
         SOUL_ASSERT (o != nullptr);
-        SOUL_ASSERT (! contains (objects, o));
 
-        for (auto& slot : objects)
+       #if SOUL_DEBUG
+        for (auto& entry : liveObjects)
+            SOUL_ASSERT (entry.object != o);
+       #endif
+
+        uint32_t slotIndex;
+
+        if (firstFreeSlot != invalidIndex)
         {
-            if (slot == nullptr)
-            {
-                slot = o;
-                return getHandleForSlot (std::addressof (slot));
-            }
+            slotIndex = firstFreeSlot;
+            firstFreeSlot = slots[slotIndex].denseIndex;
+        }
+        else
+        {
+            slotIndex = (uint32_t) slots.size();
+            SOUL_ASSERT (slotIndex <= indexMask);
+            slots.push_back ({});
         }
 
-        auto handle = ((uint64_t) objects.size()) ^ maskBits;
-        objects.push_back (o);
-        return (HandleType) handle;
+        slots[slotIndex].denseIndex = (uint32_t) liveObjects.size();
+        slots[slotIndex].live = true;
+        liveObjects.push_back ({ o, slotIndex });
+        return getHandleForSlot (slotIndex);
     }
 
     HandleType findExistingHandle (Type* o) const noexcept
     {
         SOUL_ASSERT (o != nullptr);
 
-        for (auto& slot : objects)
-            if (slot == o)
-                return getHandleForSlot (std::addressof (slot));
+        for (auto& entry : liveObjects)
+            if (entry.object == o)
+                return getHandleForSlot (entry.slotIndex);
 
-        SOUL_ASSERT_FALSE;
         return {};
     }
 
@@ -82,32 +115,84 @@ struct ObjectHandleList
     void deregisterObject (Type* o)
     {
         SOUL_ASSERT (o != nullptr);
-        auto it = std::find (objects.begin(), objects.end(), o);
 
-        if (it != objects.end())
-            *it = nullptr;
-        else
-            SOUL_ASSERT_FALSE;
+        for (auto& entry : liveObjects)
+        {
+            if (entry.object == o)
+            {
+                releaseSlot (entry.slotIndex);
+                return;
+            }
+        }
+
+        SOUL_ASSERT_FALSE;
     }
 
-    size_t count() const
+    size_t count() const                    { return liveObjects.size(); }
+
+    /** Calls a functor for each live object. The objects are stored densely,
+        so this walks one contiguous array regardless of how fragmented the
+        handle space has become.
+    */
+    template <typename Fn>
+    void visitObjects (Fn&& visit) const
+    {
+        for (auto& entry : liveObjects)
+            visit (*entry.object);
+    }
+
+private:
+    static constexpr uint32_t indexBits = 24,
+                              indexMask = (1u << indexBits) - 1,
+                              invalidIndex = indexMask;
+
+    struct Slot
     {
-        size_t result = 0;
+        // for a live slot this indexes liveObjects; for a freed one it chains
+        // to the next free slot
+        uint32_t denseIndex = 0;
+        uint8_t generation = 0;
+        bool live = false;
 
-        for (auto* o : objects)
-            if (o != nullptr)
-                ++result;
+        bool isLive() const noexcept        { return live; }
+    };
 
-        return result;
+    struct DenseEntry
+    {
+        Type* object;
+        uint32_t slotIndex;
+    };
+
+    HandleType getHandleForSlot (uint32_t slotIndex) const noexcept
+    {
+        auto& slot = slots[slotIndex];
+        return (HandleType) (uint64_t) ((slotIndex | ((uint32_t) slot.generation << indexBits)) ^ maskBits);
     }
 
-private:
-    HandleType getHandleForSlot (Type* const* slot) const noexcept
+    void releaseSlot (uint32_t slotIndex)
     {
-        return (HandleType) (uint64_t) ((uint32_t) (slot - std::addressof (objects.front())) ^ maskBits);
+        auto denseIndex = slots[slotIndex].denseIndex;
+
+        // swap-remove from the dense array, re-pointing the slot of whichever
+        // entry got moved into the gap
+        if (denseIndex + 1 < liveObjects.size())
+        {
+            liveObjects[denseIndex] = liveObjects.back();
+            slots[liveObjects[denseIndex].slotIndex].denseIndex = denseIndex;
+        }
+
+        liveObjects.pop_back();
+
+        auto& slot = slots[slotIndex];
+        slot.live = false;
+        slot.generation++;
+        slot.denseIndex = firstFreeSlot;
+        firstFreeSlot = slotIndex;
     }
 
-    std::vector<Type*> objects;
+    std::vector<Slot> slots;
+    std::vector<DenseEntry> liveObjects;
+    uint32_t firstFreeSlot = invalidIndex;
 };
 
 } // namespace soul
@@ -0,0 +1,146 @@
+/*
+    _____ _____ _____ __
+   |   __|     |  |  |  |      The SOUL language
+   |__   |  |  |  |  |  |__    Copyright (c) 2019 - ROLI Ltd.
+   |_____|_____|_____|_____|
+
+   The code in this file is provided under the terms of the ISC license:
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose
+   with or without fee is hereby granted, provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#if defined (__linux__) || defined (__APPLE__)
+ #include <sys/mman.h>
+#endif
+
+namespace soul
+{
+
+//==============================================================================
+/**
+    A ProgramMemoryAllocator which hands out whole pages mapped directly from
+    the OS, with optional huge pages and optional locking into physical memory.
+
+    Blocks come from anonymous mmap, so they're always page-aligned - well past
+    the 64-byte guarantee the interface requires. On Linux, requesting huge
+    pages maps with MAP_HUGETLB so that a multi-megabyte state or constant
+    block spans a handful of TLB entries instead of thousands; if the system
+    has no huge pages available the mapping silently falls back to normal
+    pages rather than failing the load. Locking uses mlock to keep the pages
+    resident, which stops a session that has sat idle from taking page faults
+    on the render thread when it wakes - since locked memory is a limited
+    resource, a failed mlock is also treated as a fallback rather than an
+    error, and can be spotted via getLockFailureCount().
+
+    On platforms without these facilities the allocator degrades to plain
+    64-byte-aligned heap allocation, so it's always safe to install.
+*/
+struct PageBackedAllocator final  : public ProgramMemoryAllocator
+{
+    struct Options
+    {
+        bool useHugePages = false;     /**< Back allocations with 2MB pages where the OS supports it. */
+        bool lockInMemory = false;     /**< Keep the pages physically resident via mlock. */
+    };
+
+    PageBackedAllocator() = default;
+    explicit PageBackedAllocator (Options o)  : options (o) {}
+
+    ~PageBackedAllocator() override
+    {
+        SOUL_ASSERT (allocatedBlockCount == 0);  // blocks should all have been returned before the allocator dies
+    }
+
+    void* allocate (uint64_t size, Purpose) override
+    {
+        if (size == 0)
+            return nullptr;
+
+       #if defined (__linux__) || defined (__APPLE__)
+        void* address = MAP_FAILED;
+
+       #if defined (__linux__) && defined (MAP_HUGETLB)
+        if (options.useHugePages && size >= hugePageSize)
+            address = ::mmap (nullptr, (size_t) roundUpTo (size, hugePageSize),
+                              PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+       #endif
+
+        bool isHuge = address != MAP_FAILED;
+
+        if (! isHuge)
+            address = ::mmap (nullptr, (size_t) roundUpTo (size, pageSize),
+                              PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (address == MAP_FAILED)
+            return nullptr;
+
+        if (options.lockInMemory)
+            if (::mlock (address, (size_t) size) != 0)
+                ++lockFailureCount;
+
+        if (isHuge)
+            hugeBlocks.insert (address);
+
+        ++allocatedBlockCount;
+        return address;
+       #else
+        ++allocatedBlockCount;
+        return ::operator new ((size_t) size, std::align_val_t (64), std::nothrow);
+       #endif
+    }
+
+    void deallocate (void* address, uint64_t size, Purpose) override
+    {
+        if (address == nullptr)
+            return;
+
+        --allocatedBlockCount;
+
+       #if defined (__linux__) || defined (__APPLE__)
+        auto huge = hugeBlocks.find (address);
+
+        if (huge != hugeBlocks.end())
+        {
+            hugeBlocks.erase (huge);
+            ::munmap (address, (size_t) roundUpTo (size, hugePageSize));
+            return;
+        }
+
+        ::munmap (address, (size_t) roundUpTo (size, pageSize));
+       #else
+        ignoreUnused (size);
+        ::operator delete (address, std::align_val_t (64), std::nothrow_t());
+       #endif
+    }
+
+    /** Returns the number of allocations for which mlock was requested but
+        refused - usually a sign that RLIMIT_MEMLOCK needs raising.
+    */
+    uint32_t getLockFailureCount() const        { return lockFailureCount; }
+
+private:
+    static constexpr uint64_t pageSize     = 4096;
+    static constexpr uint64_t hugePageSize = 2 * 1024 * 1024;
+
+    static uint64_t roundUpTo (uint64_t size, uint64_t granularity)
+    {
+        return ((size + granularity - 1) / granularity) * granularity;
+    }
+
+    Options options;
+    std::unordered_set<void*> hugeBlocks;
+    uint32_t allocatedBlockCount = 0, lockFailureCount = 0;
+};
+
+} // namespace soul
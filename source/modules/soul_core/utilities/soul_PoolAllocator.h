@@ -142,11 +142,42 @@ template <typename T1, typename T2> bool operator!= (pool_ptr<T1> p1, pool_ref<T
 template <typename T1, typename T2> bool operator== (pool_ref<T1> p1, pool_ref<T2> p2) noexcept  { return p1.getPointer() == p2.getPointer(); }
 template <typename T1, typename T2> bool operator!= (pool_ref<T1> p1, pool_ref<T2> p2) noexcept  { return p1.getPointer() != p2.getPointer(); }
 
+//==============================================================================
+/** The checked down-casts performed by cast() and is_type() use dynamic_cast unless
+    the target class provides a cheaper way of identifying itself.
+
+    A hierarchy whose objects carry their own type discriminator can opt in by giving
+    its root class a CastBaseType typedef, storing a discriminator in an objectType
+    member, and giving each class a static isObjectOfType() function which checks a
+    discriminator value against the set of classes derived from it. The AST classes
+    do this, and since the compiler passes cast almost every node they visit, being
+    able to compare a couple of enums instead of taking a trip through the RTTI
+    machinery is a worthwhile saving on big programs.
+*/
+template <typename TargetType, typename SrcType, typename = void>
+struct HasCastDiscriminator  : public std::false_type {};
+
+template <typename TargetType, typename SrcType>
+struct HasCastDiscriminator<TargetType, SrcType,
+                            std::void_t<decltype (TargetType::isObjectOfType (std::declval<const SrcType&>().objectType)),
+                                        typename TargetType::CastBaseType>>  : public std::true_type {};
+
+template <typename TargetType, typename SrcType>
+inline TargetType* checkedPointerCast (SrcType* object)
+{
+    if constexpr (HasCastDiscriminator<TargetType, SrcType>::value)
+        return object != nullptr && TargetType::isObjectOfType (object->objectType)
+                 ? static_cast<TargetType*> (static_cast<typename TargetType::CastBaseType*> (object))
+                 : nullptr;
+    else
+        return dynamic_cast<TargetType*> (object);
+}
+
 template <typename TargetType, typename SrcType>
 inline pool_ptr<TargetType> cast (pool_ptr<SrcType> object)
 {
     pool_ptr<TargetType> p;
-    p.reset (dynamic_cast<TargetType*> (object.get()));
+    p.reset (checkedPointerCast<TargetType> (object.get()));
     return p;
 }
 
@@ -154,7 +185,7 @@ template <typename TargetType, typename SrcType>
 inline pool_ptr<TargetType> cast (pool_ref<SrcType> object)
 {
     pool_ptr<TargetType> p;
-    p.reset (dynamic_cast<TargetType*> (object.getPointer()));
+    p.reset (checkedPointerCast<TargetType> (object.getPointer()));
     return p;
 }
 
@@ -162,7 +193,7 @@ template <typename TargetType, typename SrcType>
 inline pool_ptr<TargetType> cast (SrcType& object)
 {
     pool_ptr<TargetType> p;
-    p.reset (dynamic_cast<TargetType*> (&object));
+    p.reset (checkedPointerCast<TargetType> (&object));
     return p;
 }
 
@@ -175,7 +206,7 @@ inline bool is_type (pool_ptr<SrcType> object)
     if constexpr (std::is_same<TargetType, SrcType>::value)
         return true;
     else
-        return dynamic_cast<TargetType*> (object.get()) != nullptr;
+        return checkedPointerCast<TargetType> (object.get()) != nullptr;
 }
 
 template <typename TargetType, typename SrcType>
@@ -186,7 +217,7 @@ inline bool is_type (pool_ref<SrcType> object)
     if constexpr (std::is_same<TargetType, SrcType>::value)
         return true;
     else
-        return dynamic_cast<TargetType*> (object.getPointer()) != nullptr;
+        return checkedPointerCast<TargetType> (object.getPointer()) != nullptr;
 }
 
 template <typename TargetType, typename SrcType>
@@ -197,7 +228,7 @@ inline bool is_type (SrcType& object)
     if constexpr (std::is_same<TargetType, SrcType>::value)
         return true;
     else
-        return dynamic_cast<TargetType*> (&object) != nullptr;
+        return checkedPointerCast<TargetType> (&object) != nullptr;
 }
 
 //==============================================================================
@@ -226,14 +257,62 @@ public:
     PoolAllocator (PoolAllocator&&) = default;
     PoolAllocator& operator= (PoolAllocator&&) = default;
 
-    /** Clears the pool (deleting all the objects in it) */
+    /** Clears the pool (destroying all the objects in it).
+
+        The memory blocks that the pool has accumulated are retained and re-used by
+        subsequent allocations, so that repeatedly re-compiling (e.g. in a live-coding
+        session) doesn't thrash the system allocator - use releaseAllMemory() if you
+        actually want to free them. Blocks which only ever contained trivially-destructible
+        objects are reset without walking their contents at all.
+    */
     void clear()
+    {
+        for (auto& p : pools)
+            p->reset();
+
+        numObjectsAllocated = 0;
+        bytesAllocated = 0;
+
+        if (pools.empty())
+        {
+            pools.reserve (32);
+            addNewPool();
+        }
+        else
+        {
+            currentPoolIndex = 0;
+            currentPool = pools.front().get();
+        }
+    }
+
+    /** Destroys all the objects in the pool and frees all its memory blocks. */
+    void releaseAllMemory()
     {
         pools.clear();
         pools.reserve (32);
+        numObjectsAllocated = 0;
+        bytesAllocated = 0;
         addNewPool();
     }
 
+    /** A snapshot of how much the pool is holding.  @see getStatistics() */
+    struct Statistics
+    {
+        size_t numObjects = 0;       /**< The number of objects currently alive in the pool. */
+        size_t bytesUsed = 0;        /**< The bytes those objects occupy, including per-item headers and padding. */
+        size_t bytesReserved = 0;    /**< The total capacity of the blocks the pool has allocated from the system. */
+        size_t highWaterBytes = 0;   /**< The largest bytesUsed the pool has ever reached - this survives clear(),
+                                          so it reports the peak across repeated compilations. */
+    };
+
+    /** Returns the pool's current usage. The counters are maintained incrementally,
+        so this is cheap enough to call at every compiler pass boundary.
+    */
+    Statistics getStatistics() const
+    {
+        return { numObjectsAllocated, bytesAllocated, pools.size() * poolSize, highWaterBytes };
+    }
+
     /** Allocates a new object for the pool, returning a reference to it. */
     template <typename Type, typename... Args>
     Type& allocate (Args&&... args)
@@ -244,7 +323,10 @@ public:
 
         // NB: the constructor may throw, so we have to be careful not to register its destructor until afterwards
         if constexpr (! std::is_trivially_destructible<Type>::value)
+        {
             newItem.destructor = [] (void* t) { static_cast<Type*> (t)->~Type(); };
+            currentPool->containsItemsNeedingDestruction = true;
+        }
 
         return *newObject;
     }
@@ -271,15 +353,28 @@ private:
 
         ~Pool()
         {
-            for (size_t i = 0; i < nextSlot;)
+            reset();
+        }
+
+        /** Destroys the objects in this block and marks all its space as free for re-use. */
+        void reset()
+        {
+            if (containsItemsNeedingDestruction)
             {
-                auto item = getItem (i);
+                for (size_t i = 0; i < nextSlot;)
+                {
+                    auto item = getItem (i);
 
-                if (item->destructor != nullptr)
-                    item->destructor (&item->item);
+                    if (item->destructor != nullptr)
+                        item->destructor (&item->item);
 
-                i += item->size;
+                    i += item->size;
+                }
+
+                containsItemsNeedingDestruction = false;
             }
+
+            nextSlot = 0;
         }
 
         bool hasSpaceFor (size_t size) const
@@ -306,26 +401,42 @@ private:
         PoolItem* getItem (size_t byteOffset) noexcept  { return reinterpret_cast<PoolItem*> (space.data() + byteOffset); }
 
         size_t nextSlot = 0;
+        bool containsItemsNeedingDestruction = false;
         alignas(poolItemAlignment) std::array<char, poolSize> space;
     };
 
     std::vector<std::unique_ptr<Pool>> pools;
     Pool* currentPool = nullptr;
+    size_t currentPoolIndex = 0;
+    size_t numObjectsAllocated = 0, bytesAllocated = 0, highWaterBytes = 0;
 
     void addNewPool()
     {
         currentPool = new Pool();
         pools.emplace_back (currentPool);
+        currentPoolIndex = pools.size() - 1;
     }
 
     PoolItem& allocateSpaceForObject (size_t size)
     {
         if (! currentPool->hasSpaceFor (size))
         {
-            addNewPool();
+            // Move on to the next of the blocks retained by clear() before
+            // resorting to allocating a fresh one
+            if (++currentPoolIndex < pools.size())
+                currentPool = pools[currentPoolIndex].get();
+            else
+                addNewPool();
+
             SOUL_ASSERT (currentPool->hasSpaceFor (size));
         }
 
+        ++numObjectsAllocated;
+        bytesAllocated += getAlignedSize<poolItemAlignment> (size + itemHeaderSize);
+
+        if (bytesAllocated > highWaterBytes)
+            highWaterBytes = bytesAllocated;
+
         return currentPool->createItem (size);
     }
 };
@@ -23,21 +23,29 @@ namespace soul
 
 //==============================================================================
 /** A base class for intrusively-reference-counted objects, suitable for use by RefCountedPtr.
-    Note that the counter is non-atomic!
+
+    The counter is atomic so that objects shared across modules (structures, types,
+    source-code text) can have their counts bumped from worker threads while read-only
+    passes are sharded across a thread pool. Relaxed increments and an acquire/release
+    decrement keep the cost negligible on the single-threaded paths.
 */
 struct RefCountedObject
 {
     RefCountedObject() = default;
     RefCountedObject (const RefCountedObject&) noexcept {}
     RefCountedObject (RefCountedObject&&) noexcept {}
+    RefCountedObject& operator= (const RefCountedObject&) noexcept { return *this; }
+    RefCountedObject& operator= (RefCountedObject&&) noexcept { return *this; }
     ~RefCountedObject() = default;
 
-    uint32_t refCount = 0;
+    std::atomic<uint32_t> refCount { 0 };
 };
 
 //==============================================================================
 /** A smart pointer for referring to classes that inherit from RefCountedObject.
-    Note that this is intended to be fast, not thread-safe!
+
+    The pointer itself is not synchronised - only the underlying object's refcount
+    is safe to adjust from multiple threads.
 */
 template <typename ObjectType>
 struct RefCountedPtr  final
@@ -47,7 +55,7 @@ struct RefCountedPtr  final
     ~RefCountedPtr()   { decIfNotNull (object); }
 
     explicit RefCountedPtr (ObjectType* o) noexcept         : object (o) { incIfNotNull (o); }
-    RefCountedPtr (ObjectType& o) noexcept                  : object (std::addressof (o)) { o.refCount++; }
+    RefCountedPtr (ObjectType& o) noexcept                  : object (std::addressof (o)) { o.refCount.fetch_add (1, std::memory_order_relaxed); }
     RefCountedPtr (const RefCountedPtr& other) noexcept     : object (other.object) { incIfNotNull (object); }
     RefCountedPtr (RefCountedPtr&& other) noexcept          : object (other.object) { other.object = nullptr; }
 
@@ -95,16 +103,17 @@ private:
     static void incIfNotNull (ObjectType* o) noexcept
     {
         if (o != nullptr)
-            o->refCount++;
+            o->refCount.fetch_add (1, std::memory_order_relaxed);
     }
 
     static void decIfNotNull (ObjectType* o)
     {
         if (o != nullptr)
         {
-            SOUL_ASSERT (o->refCount > 0);
+            auto oldCount = o->refCount.fetch_sub (1, std::memory_order_acq_rel);
+            SOUL_ASSERT (oldCount > 0);
 
-            if (--(o->refCount) == 0)
+            if (oldCount == 1)
                 delete o;
         }
     }
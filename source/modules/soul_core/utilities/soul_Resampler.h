@@ -21,7 +21,39 @@
 namespace soul
 {
 
-/** A sinc interpolator that can resample a chunk of audio data to fit a new number of frames. */
+template <typename SampleType>
+inline SampleType resamplerDotProduct (const SampleType* samples, const SampleType* weights, int num) noexcept
+{
+    auto sum = SampleType();
+
+    for (int i = 0; i < num; ++i)
+        sum += samples[i] * weights[i];
+
+    return sum;
+}
+
+#if SOUL_INTEL
+inline float resamplerDotProduct (const float* samples, const float* weights, int num) noexcept
+{
+    auto sum = _mm_setzero_ps();
+    int i = 0;
+
+    for (; i + 4 <= num; i += 4)
+        sum = _mm_add_ps (sum, _mm_mul_ps (_mm_loadu_ps (samples + i),
+                                           _mm_loadu_ps (weights + i)));
+
+    float lanes[4];
+    _mm_storeu_ps (lanes, sum);
+    auto total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+
+    for (; i < num; ++i)
+        total += samples[i] * weights[i];
+
+    return total;
+}
+#endif
+
+/** A windowed-sinc polyphase resampler that can resample a chunk of audio data to fit a new number of frames. */
 template <typename DestType, typename SourceType>
 void resampleToFit (DestType&& dest, const SourceType& source, int zeroCrossings = 50)
 {
@@ -45,48 +77,73 @@ void resampleToFit (DestType&& dest, const SourceType& source, int zeroCrossings
             }
         }
 
-        static void resample (choc::buffer::MonoView<SampleType> dest, const choc::buffer::MonoView<SampleType>& source, float ratio, int zeroCrossings) noexcept
+        static void resample (choc::buffer::MonoView<SampleType> dest, const choc::buffer::MonoView<SampleType>& source, float ratio, int zeroCrossings)
         {
             SOUL_ASSERT (source.data.stride == 1);
             auto sampleIncrement = double (source.getNumFrames()) / double (dest.getNumFrames());
             auto dst = dest.data;
 
-            for (choc::buffer::FrameCount i = 0; i < dest.getNumFrames(); ++i)
+            // Tabulate the windowed-sinc kernel at a fixed set of phases, so the
+            // per-sample work becomes a couple of dot-products over contiguous taps
+            // instead of evaluating sin/cos for each one. Adjacent phase rows are
+            // interpolated, which keeps the error far below the kernel's own sidelobes.
+            auto crossings = int (float (zeroCrossings) / ratio);
+            auto numTaps = 2 * crossings + 1;
+            std::vector<SampleType> table (size_t (numPhases + 1) * size_t (numTaps));
+
+            for (int p = 0; p <= numPhases; ++p)
             {
-                *dst.data = static_cast<SampleType> (ratio * getBandlimitedSample (source, sampleIncrement * i, ratio, zeroCrossings));
-                dst.data += dst.stride;
+                auto frac = SampleType (p) / SampleType (numPhases);
+                auto row = table.data() + size_t (p) * size_t (numTaps);
+
+                for (int j = 0; j < numTaps; ++j)
+                    row[j] = windowedSinc (frac + SampleType (ratio) * SampleType (j - crossings), SampleType (zeroCrossings));
             }
-        }
 
-        static SampleType getBandlimitedSample (const choc::buffer::MonoView<SampleType>& source, double pos, float ratio, int numZeroCrossings) noexcept
-        {
-            auto intPos  = (int64_t) pos;
-            auto fracPos = (float) (pos - (double) intPos);
-            auto result = SampleType();
-            auto floatZeroCrossings = SampleType (numZeroCrossings);
             auto data = source.data.data;
             auto numFrames = source.getNumFrames();
 
-            if (fracPos > 0)
-            {
-                fracPos = 1.0f - fracPos;
-                ++intPos;
-            }
-
-            int crossings = int (float (numZeroCrossings) / ratio);
-
-            for (int i = -crossings; i <= crossings; ++i)
+            for (choc::buffer::FrameCount i = 0; i < dest.getNumFrames(); ++i)
             {
-                auto sincPosition = SampleType (fracPos + (ratio * float (i)));
-                auto samplePosition = (uint32_t) (intPos + i);
-
-                if (samplePosition < numFrames)
-                    result += static_cast<SampleType> (data[samplePosition] * windowedSinc (sincPosition, floatZeroCrossings));
+                auto pos = sampleIncrement * i;
+                auto base = (int64_t) std::ceil (pos);
+                auto phase = ((double) base - pos) * numPhases;
+                auto phaseIndex = std::min ((int) phase, numPhases - 1);
+                auto phaseFrac = SampleType (phase - phaseIndex);
+
+                auto w0 = table.data() + size_t (phaseIndex) * size_t (numTaps);
+                auto w1 = w0 + numTaps;
+                auto start = base - crossings;
+                SampleType sample0, sample1;
+
+                if (start >= 0 && start + numTaps <= (int64_t) numFrames)
+                {
+                    sample0 = resamplerDotProduct (data + start, w0, numTaps);
+                    sample1 = resamplerDotProduct (data + start, w1, numTaps);
+                }
+                else
+                {
+                    sample0 = sample1 = SampleType();
+
+                    for (int j = 0; j < numTaps; ++j)
+                    {
+                        auto samplePosition = (uint64_t) (start + j);
+
+                        if (samplePosition < numFrames)
+                        {
+                            sample0 += data[samplePosition] * w0[j];
+                            sample1 += data[samplePosition] * w1[j];
+                        }
+                    }
+                }
+
+                *dst.data = static_cast<SampleType> (ratio * (sample0 + phaseFrac * (sample1 - sample0)));
+                dst.data += dst.stride;
             }
-
-            return result;
         }
 
+        enum { numPhases = 256 };
+
         static SampleType windowedSinc (SampleType f, SampleType numZeroCrossings) noexcept
         {
             if (f == SampleType())
@@ -0,0 +1,327 @@
+/*
+    _____ _____ _____ __
+   |   __|     |  |  |  |      The SOUL language
+   |__   |  |  |  |  |  |__    Copyright (c) 2019 - ROLI Ltd.
+   |_____|_____|_____|_____|
+
+   The code in this file is provided under the terms of the ISC license:
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose
+   with or without fee is hereby granted, provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+namespace soul
+{
+
+//==============================================================================
+/** A single-channel kernel for a rate-converting stream connection.
+
+    A connection which crosses a clock boundary has a fixed integer rate ratio,
+    and its interpolation mode is a compile-time constant, so there's no reason
+    for a render loop to re-decide either of them per sample. An engine should
+    create one of these per rate-converting connection (per channel) when it
+    links a graph: createUpsampler()/createDownsampler() pick the implementation
+    for the connection's mode once, and process() then converts a whole block
+    with no per-sample dispatch.
+
+    The non-specific modes are resolved here too: fast becomes linear, best
+    becomes sinc, and none falls back to latch, so callers can hand over a
+    connection's InterpolationType untranslated.
+
+    Creation allocates (the sinc kernels tabulate their filter), so build these
+    at link time, not on the render thread. process() is allocation-free.
+*/
+struct StreamInterpolator
+{
+    virtual ~StreamInterpolator() = default;
+
+    /** Converts a block, reading numSourceFrames samples and writing
+        numSourceFrames * factor (upsampling) or numSourceFrames / factor
+        (downsampling, which requires numSourceFrames to be a multiple of the
+        factor) samples to dest.
+    */
+    virtual void process (const float* source, uint32_t numSourceFrames, float* dest) noexcept = 0;
+
+    /** Clears any filter or ramp history, as if freshly created. */
+    virtual void reset() noexcept = 0;
+
+    /** Creates a kernel converting one stream sample into factor samples. */
+    static std::unique_ptr<StreamInterpolator> createUpsampler (InterpolationType, uint32_t factor);
+
+    /** Creates a kernel converting factor stream samples into one sample. */
+    static std::unique_ptr<StreamInterpolator> createDownsampler (InterpolationType, uint32_t factor);
+};
+
+//==============================================================================
+namespace stream_interpolators
+{
+    /** Repeats each source sample across its group of output frames. */
+    struct LatchUpsampler  final : public StreamInterpolator
+    {
+        LatchUpsampler (uint32_t f) : factor (f) {}
+
+        void process (const float* source, uint32_t numSourceFrames, float* dest) noexcept override
+        {
+            for (uint32_t i = 0; i < numSourceFrames; ++i)
+            {
+                auto value = source[i];
+
+                for (uint32_t j = 0; j < factor; ++j)
+                    *dest++ = value;
+            }
+        }
+
+        void reset() noexcept override {}
+
+        const uint32_t factor;
+    };
+
+    /** Ramps linearly from each source sample to the next, keeping one sample
+        of history so the ramp is continuous across block boundaries.
+    */
+    struct LinearUpsampler  final : public StreamInterpolator
+    {
+        LinearUpsampler (uint32_t f) : factor (f), step (1.0f / static_cast<float> (f)) {}
+
+        void process (const float* source, uint32_t numSourceFrames, float* dest) noexcept override
+        {
+            auto previous = lastSample;
+
+            for (uint32_t i = 0; i < numSourceFrames; ++i)
+            {
+                auto next = source[i];
+                auto increment = (next - previous) * step;
+                auto value = previous;
+
+                for (uint32_t j = 0; j < factor; ++j)
+                {
+                    value += increment;
+                    *dest++ = value;
+                }
+
+                previous = next;
+            }
+
+            lastSample = previous;
+        }
+
+        void reset() noexcept override      { lastSample = 0; }
+
+        const uint32_t factor;
+        const float step;
+        float lastSample = 0;
+    };
+
+    /** Shared tap history and windowed-sinc table for the polyphase kernels.
+
+        An integer ratio means the filter only ever lands on factor distinct
+        phases, so unlike the free-ratio resampler the table holds exactly one
+        row per phase and no phase interpolation is needed.
+    */
+    struct SincKernelBase  : public StreamInterpolator
+    {
+        SincKernelBase (uint32_t numPhasesToUse, uint32_t tapsPerPhase, float cutoff, float gain)
+            : numPhases (numPhasesToUse), numTaps (tapsPerPhase)
+        {
+            table.resize (numPhases * numTaps);
+            history.resize (numTaps * 2, 0);
+
+            auto crossings = static_cast<float> (numTaps) * cutoff * 0.5f;
+
+            for (uint32_t p = 0; p < numPhases; ++p)
+            {
+                auto frac = static_cast<float> (p) / static_cast<float> (numPhases);
+
+                for (uint32_t j = 0; j < numTaps; ++j)
+                {
+                    auto position = (static_cast<float> (j) - static_cast<float> (numTaps - 1) * 0.5f + frac) * cutoff;
+                    table[p * numTaps + j] = gain * windowedSinc (position, crossings);
+                }
+            }
+        }
+
+        void reset() noexcept override
+        {
+            std::fill (history.begin(), history.end(), 0.0f);
+            historyPos = 0;
+        }
+
+        /** The history is kept twice over, so the taps are always contiguous
+            and the dot-product never has to wrap.
+        */
+        void pushHistory (float sample) noexcept
+        {
+            history[historyPos] = sample;
+            history[historyPos + numTaps] = sample;
+            historyPos = (historyPos + 1) % numTaps;
+        }
+
+        float applyPhase (uint32_t phase) const noexcept
+        {
+            return resamplerDotProduct (history.data() + historyPos,
+                                        table.data() + phase * numTaps,
+                                        static_cast<int> (numTaps));
+        }
+
+        static float windowedSinc (float f, float numZeroCrossings) noexcept
+        {
+            if (f == 0)
+                return 1.0f;
+
+            if (f > numZeroCrossings || f < -numZeroCrossings)
+                return 0;
+
+            f *= float (soul::pi);
+            auto window = 0.5f + 0.5f * std::cos (f / numZeroCrossings);
+            return window * std::sin (f) / f;
+        }
+
+        const uint32_t numPhases, numTaps;
+        std::vector<float> table, history;
+        uint32_t historyPos = 0;
+    };
+
+    /** Polyphase windowed-sinc interpolation: each source sample enters the
+        history once, and each of the factor output frames is one dot-product
+        against its phase's taps.
+    */
+    struct SincUpsampler  final : public SincKernelBase
+    {
+        static constexpr uint32_t tapsPerPhase = 16;
+
+        SincUpsampler (uint32_t f)
+            : SincKernelBase (f, tapsPerPhase, 1.0f, 1.0f), factor (f) {}
+
+        void process (const float* source, uint32_t numSourceFrames, float* dest) noexcept override
+        {
+            for (uint32_t i = 0; i < numSourceFrames; ++i)
+            {
+                pushHistory (source[i]);
+
+                for (uint32_t phase = 0; phase < factor; ++phase)
+                    *dest++ = applyPhase (factor - 1 - phase);
+            }
+        }
+
+        const uint32_t factor;
+    };
+
+    /** Decimation by taking the first sample of each group. */
+    struct LatchDownsampler  final : public StreamInterpolator
+    {
+        LatchDownsampler (uint32_t f) : factor (f) {}
+
+        void process (const float* source, uint32_t numSourceFrames, float* dest) noexcept override
+        {
+            SOUL_ASSERT (numSourceFrames % factor == 0);
+
+            for (uint32_t i = 0; i < numSourceFrames; i += factor)
+                *dest++ = source[i];
+        }
+
+        void reset() noexcept override {}
+
+        const uint32_t factor;
+    };
+
+    /** Decimation by averaging each group, which gives a crude but cheap
+        first-order lowpass before the rate drop.
+    */
+    struct LinearDownsampler  final : public StreamInterpolator
+    {
+        LinearDownsampler (uint32_t f) : factor (f), scale (1.0f / static_cast<float> (f)) {}
+
+        void process (const float* source, uint32_t numSourceFrames, float* dest) noexcept override
+        {
+            SOUL_ASSERT (numSourceFrames % factor == 0);
+
+            for (uint32_t i = 0; i < numSourceFrames; i += factor)
+            {
+                float sum = 0;
+
+                for (uint32_t j = 0; j < factor; ++j)
+                    sum += source[i + j];
+
+                *dest++ = sum * scale;
+            }
+        }
+
+        void reset() noexcept override {}
+
+        const uint32_t factor;
+        const float scale;
+    };
+
+    /** Windowed-sinc lowpass decimation: every source sample enters the
+        history, and one dot-product per output frame applies a filter whose
+        cutoff sits at the destination's Nyquist.
+    */
+    struct SincDownsampler  final : public SincKernelBase
+    {
+        static constexpr uint32_t tapsPerFactor = 16;
+
+        SincDownsampler (uint32_t f)
+            : SincKernelBase (1, tapsPerFactor * f,
+                              1.0f / static_cast<float> (f),
+                              1.0f / static_cast<float> (f)),
+              factor (f) {}
+
+        void process (const float* source, uint32_t numSourceFrames, float* dest) noexcept override
+        {
+            SOUL_ASSERT (numSourceFrames % factor == 0);
+
+            for (uint32_t i = 0; i < numSourceFrames; i += factor)
+            {
+                for (uint32_t j = 0; j < factor; ++j)
+                    pushHistory (source[i + j]);
+
+                *dest++ = applyPhase (0);
+            }
+        }
+
+        const uint32_t factor;
+    };
+}
+
+//==============================================================================
+inline std::unique_ptr<StreamInterpolator> StreamInterpolator::createUpsampler (InterpolationType type, uint32_t factor)
+{
+    SOUL_ASSERT (factor > 1);
+
+    switch (type)
+    {
+        case InterpolationType::linear:
+        case InterpolationType::fast:    return std::make_unique<stream_interpolators::LinearUpsampler> (factor);
+        case InterpolationType::sinc:
+        case InterpolationType::best:    return std::make_unique<stream_interpolators::SincUpsampler> (factor);
+        case InterpolationType::latch:
+        case InterpolationType::none:
+        default:                         return std::make_unique<stream_interpolators::LatchUpsampler> (factor);
+    }
+}
+
+inline std::unique_ptr<StreamInterpolator> StreamInterpolator::createDownsampler (InterpolationType type, uint32_t factor)
+{
+    SOUL_ASSERT (factor > 1);
+
+    switch (type)
+    {
+        case InterpolationType::linear:
+        case InterpolationType::fast:    return std::make_unique<stream_interpolators::LinearDownsampler> (factor);
+        case InterpolationType::sinc:
+        case InterpolationType::best:    return std::make_unique<stream_interpolators::SincDownsampler> (factor);
+        case InterpolationType::latch:
+        case InterpolationType::none:
+        default:                         return std::make_unique<stream_interpolators::LatchDownsampler> (factor);
+    }
+}
+
+} // namespace soul
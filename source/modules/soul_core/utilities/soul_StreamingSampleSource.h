@@ -0,0 +1,189 @@
+/*
+    _____ _____ _____ __
+   |   __|     |  |  |  |      The SOUL language
+   |__   |  |  |  |  |  |__    Copyright (c) 2019 - ROLI Ltd.
+   |_____|_____|_____|_____|
+
+   The code in this file is provided under the terms of the ISC license:
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose
+   with or without fee is hereby granted, provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+namespace soul
+{
+
+//==============================================================================
+/** Streams long sample content into an input stream endpoint through a
+    read-ahead FIFO, so a program can play material of any length without it
+    being memory-resident the way an external variable requires.
+
+    The host supplies a reader function which produces frames for a given
+    source position - typically by decoding from disk - and this object runs it
+    on its own background thread, keeping a ChannelSetFIFO of the given
+    read-ahead depth topped up. On the render side, attachToSession() registers
+    an endpoint service callback which pulls exactly one block per render
+    callback out of the FIFO and hands it to setNextInputStreamFrames(), so the
+    render thread never waits for the disk: if the reader falls behind, the
+    block plays as silence and getStarvedBlockCount() ticks up.
+
+    The reader decides what happens at the end of the material - it can wrap
+    its position to loop, or keep returning zero frames, which parks the reader
+    thread and leaves the endpoint playing silence. The object must outlive the
+    session's use of the callback, so destroy it only after the session has
+    stopped or unloaded the program.
+*/
+struct StreamingSampleSource
+{
+    /** Produces frames starting at the given source position into the
+        destination view, returning how many frames it wrote. This is called on
+        the background reader thread, so it's free to block on I/O. Returning
+        fewer frames than the view holds is fine; returning 0 means no data is
+        available at that position.
+    */
+    using ReadSourceFramesFn = std::function<uint32_t (uint64_t sourceFrameIndex, choc::buffer::ChannelArrayView<float> dest)>;
+
+    StreamingSampleSource (uint32_t numChannelsToUse, uint32_t readAheadFrames, ReadSourceFramesFn readerToUse)
+        : numChannels (numChannelsToUse),
+          fifo (numChannelsToUse, readAheadFrames),
+          reader (std::move (readerToUse)),
+          readChunkFrames (std::max (256u, readAheadFrames / 4))
+    {
+        readerThread = std::thread ([this] { runReaderThread(); });
+    }
+
+    ~StreamingSampleSource()
+    {
+        shouldStop = true;
+        fifo.cancel();
+
+        {
+            std::lock_guard<std::mutex> l (readerWakeupLock);
+            readerWakeup.notify_all();
+        }
+
+        readerThread.join();
+    }
+
+    /** Attaches this source to an input stream endpoint of a loaded session.
+        This must be called after load() and before link(), like the other
+        endpoint attachments. Returns false if the endpoint isn't a float
+        stream with this source's channel count.
+    */
+    bool attachToSession (Venue::Session& session, const EndpointID& endpointID)
+    {
+        if (! containsEndpoint (session.getInputEndpoints(), endpointID))
+            return false;
+
+        auto& details = findDetailsForID (session.getInputEndpoints(), endpointID);
+
+        if (! isStream (details))
+            return false;
+
+        auto& frameType = details.getFrameType();
+
+        if (! (frameType.isFloat() || (frameType.isVector() && frameType.getElementType().isFloat())))
+            return false;
+
+        if (details.getNumAudioChannels() != numChannels)
+            return false;
+
+        return session.setInputEndpointServiceCallback (endpointID,
+                                                        [this] (Venue::Session& s, EndpointHandle handle)
+                                                        {
+                                                            serviceRenderCallback (s, handle);
+                                                        });
+    }
+
+    /** Returns how many render blocks have been played as silence because the
+        reader couldn't keep the FIFO filled.
+    */
+    uint64_t getStarvedBlockCount() const       { return starvedBlocks.load (std::memory_order_relaxed); }
+
+private:
+    //==============================================================================
+    void serviceRenderCallback (Venue::Session& session, EndpointHandle handle)
+    {
+        // The block size only becomes known once the session is linked, so the
+        // staging buffer is sized lazily on the first callback.
+        if (renderBlock.getNumFrames() == 0)
+        {
+            auto blockSize = session.getStatus().blockSize;
+
+            if (blockSize == 0)
+                return;
+
+            renderBlock = choc::buffer::InterleavedBuffer<float> (numChannels, blockSize);
+            renderBlock.clear();
+        }
+
+        // A deadline of now means this fails immediately rather than waiting for
+        // the reader; readBlocking() clears the destination on failure, so a
+        // starved block turns into silence instead of a stall.
+        if (! fifo.readBlocking (renderBlock.getView(), std::chrono::high_resolution_clock::now()))
+            starvedBlocks.fetch_add (1, std::memory_order_relaxed);
+
+        auto numFrames = renderBlock.getNumFrames();
+        auto* data = renderBlock.getView().data.data;
+
+        if (numChannels == 1)
+            session.setNextInputStreamFrames (handle, choc::value::createArrayView (data, numFrames));
+        else
+            session.setNextInputStreamFrames (handle, choc::value::create2DArrayView (data, numFrames, numChannels));
+    }
+
+    void runReaderThread()
+    {
+        choc::buffer::ChannelArrayBuffer<float> chunk (numChannels, readChunkFrames);
+
+        while (! shouldStop.load())
+        {
+            auto numRead = reader (nextSourceFrame, chunk.getView());
+
+            if (numRead == 0)
+            {
+                // Nothing available at this position - park briefly rather than
+                // spinning against a source that has nothing to say.
+                std::unique_lock<std::mutex> l (readerWakeupLock);
+
+                if (! shouldStop.load())
+                    readerWakeup.wait_for (l, std::chrono::milliseconds (50));
+
+                continue;
+            }
+
+            nextSourceFrame += numRead;
+
+            // This blocks until the render thread has consumed enough to make
+            // space; cancelling the FIFO in the destructor unblocks it.
+            fifo.writeBlocking (chunk.getView().getStart (numRead),
+                                std::chrono::high_resolution_clock::now() + std::chrono::hours (1));
+        }
+    }
+
+    //==============================================================================
+    uint32_t numChannels;
+    ChannelSetFIFO fifo;
+    ReadSourceFramesFn reader;
+    uint32_t readChunkFrames;
+
+    choc::buffer::InterleavedBuffer<float> renderBlock;
+    uint64_t nextSourceFrame = 0;
+
+    std::atomic<bool> shouldStop { false };
+    std::atomic<uint64_t> starvedBlocks { 0 };
+
+    std::thread readerThread;
+    std::mutex readerWakeupLock;
+    std::condition_variable readerWakeup;
+};
+
+} // namespace soul
@@ -227,17 +227,9 @@ std::string loadFileAsString (const char* filename)
 
 std::string makeSafeIdentifierName (std::string s)
 {
-    for (auto& c : s)
-        if (containsChar (" ,./;", c))
-            c = '_';
-
-    s.erase (std::remove_if (s.begin(), s.end(), [&] (char c) { return ! isSafeIdentifierChar (c); }), s.end());
-
-    // Identifiers can't start with a digit
-    if (isDigit (s[0]))
-        s = "_" + s;
-
-    return s;
+    StringBuilderWithPreallocation<> result;
+    result.appendSafeIdentifierName (s);
+    return result.toString();
 }
 
 bool isSafeIdentifierName (std::string s)
@@ -388,6 +380,19 @@ HashBuilder& HashBuilder::operator<< (const std::string& s) noexcept
     return *this;
 }
 
+HashBuilder& HashBuilder::operator<< (int64_t n) noexcept
+{
+    // hashed as its decimal digits, so the stream matches older code
+    // which formatted numbers with std::to_string before hashing them
+    char digits[24];
+    auto result = std::to_chars (digits, digits + sizeof (digits), n);
+
+    for (auto* d = digits; d != result.ptr; ++d)
+        *this << *d;
+
+    return *this;
+}
+
 HashBuilder& HashBuilder::operator<< (ArrayView<char> s) noexcept
 {
     for (auto c : s)
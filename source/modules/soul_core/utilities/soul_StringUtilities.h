@@ -23,6 +23,7 @@ namespace soul
 
 bool isWhitespace (char);
 bool isDigit (char);
+bool isSafeIdentifierChar (char);
 
 std::string repeatedCharacter (char, size_t num);
 std::string padded (const std::string&, int minSize);
@@ -106,6 +107,83 @@ static std::string addSuffixToMakeUnique (const std::string& name, IsAlreadyUsed
     return nameToUse;
 }
 
+//==============================================================================
+/**
+    A string builder with embedded storage, for assembling short strings without
+    touching the heap.
+
+    The compiler spends a lot of its time gluing names together - mangled inlined
+    variables, unique block labels, qualified paths - and almost all of them come
+    out well under 64 characters, so the default capacity keeps the whole job
+    inline. Anything longer just spills onto the heap, the same way that
+    ArrayWithPreallocation does.
+*/
+template <size_t preallocatedChars = 64>
+struct StringBuilderWithPreallocation
+{
+    StringBuilderWithPreallocation() = default;
+    StringBuilderWithPreallocation (std::string_view initialContent)    { append (initialContent); }
+
+    StringBuilderWithPreallocation& append (char c)
+    {
+        chars.push_back (c);
+        return *this;
+    }
+
+    StringBuilderWithPreallocation& append (std::string_view text)
+    {
+        chars.reserve (chars.size() + text.length());
+
+        for (auto c : text)
+            chars.push_back (c);
+
+        return *this;
+    }
+
+    StringBuilderWithPreallocation& append (int64_t n)
+    {
+        char digits[24];
+        auto result = std::to_chars (digits, digits + sizeof (digits), n);
+        return append (std::string_view (digits, static_cast<size_t> (result.ptr - digits)));
+    }
+
+    /** Appends text with the same cleaning rules as makeSafeIdentifierName(),
+        without the temporary strings that the free function creates.
+    */
+    StringBuilderWithPreallocation& appendSafeIdentifierName (std::string_view text)
+    {
+        for (auto c : text)
+        {
+            if (containsChar (" ,./;", c))
+                c = '_';
+            else if (! isSafeIdentifierChar (c))
+                continue;
+
+            // Identifiers can't start with a digit
+            if (chars.empty() && isDigit (c))
+                chars.push_back ('_');
+
+            chars.push_back (c);
+        }
+
+        return *this;
+    }
+
+    bool empty() const                      { return chars.empty(); }
+    size_t length() const                   { return chars.size(); }
+
+    std::string_view view() const           { return { chars.data(), chars.size() }; }
+    operator std::string_view() const       { return view(); }
+    std::string toString() const            { return std::string (view()); }
+
+    bool operator== (const StringBuilderWithPreallocation& other) const   { return view() == other.view(); }
+    bool operator!= (const StringBuilderWithPreallocation& other) const   { return view() != other.view(); }
+
+private:
+    ArrayWithPreallocation<char, preallocatedChars> chars;
+};
+
+//==============================================================================
 std::string toStringWithDecPlaces (double n, size_t numDecPlaces);
 std::string getDescriptionOfTimeInSeconds (double numSeconds);
 std::string toHexString (int64_t value);
@@ -166,6 +244,7 @@ struct HashBuilder
     HashBuilder& operator<< (char) noexcept;
     HashBuilder& operator<< (const std::string&) noexcept;
     HashBuilder& operator<< (ArrayView<char>) noexcept;
+    HashBuilder& operator<< (int64_t) noexcept;
 
     std::string toString() const;
 
@@ -0,0 +1,125 @@
+/*
+    _____ _____ _____ __
+   |   __|     |  |  |  |      The SOUL language
+   |__   |  |  |  |  |  |__    Copyright (c) 2019 - ROLI Ltd.
+   |_____|_____|_____|_____|
+
+   The code in this file is provided under the terms of the ISC license:
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose
+   with or without fee is hereby granted, provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+namespace soul
+{
+
+//==============================================================================
+/** A simple fixed-size pool of worker threads to which jobs can be added.
+
+    Jobs are run in the order in which they were added. The destructor blocks
+    until all pending jobs have finished, so a scoped ThreadPool can be used
+    to fork out a batch of independent tasks and join them again.
+*/
+struct ThreadPool  final
+{
+    ThreadPool (size_t numThreads)
+    {
+        SOUL_ASSERT (numThreads > 0);
+        threads.reserve (numThreads);
+
+        for (size_t i = 0; i < numThreads; ++i)
+            threads.emplace_back ([this] { runJobs(); });
+    }
+
+    ~ThreadPool()
+    {
+        waitForAllJobsToFinish();
+    }
+
+    ThreadPool (const ThreadPool&) = delete;
+    ThreadPool& operator= (const ThreadPool&) = delete;
+
+    /** Returns a sensible pool size for a given number of independent jobs,
+        never exceeding the number of hardware threads available.
+    */
+    static size_t getRecommendedNumberOfThreads (size_t numJobs)
+    {
+        auto numCores = static_cast<size_t> (std::thread::hardware_concurrency());
+
+        if (numCores == 0)
+            numCores = 1;
+
+        return std::max (static_cast<size_t> (1), std::min (numJobs, numCores));
+    }
+
+    /** Adds a job to the queue. Jobs must not throw - any exceptions must be
+        caught and stored by the job itself.
+    */
+    void addJob (std::function<void()> job)
+    {
+        {
+            std::lock_guard<std::mutex> lock (queueLock);
+            SOUL_ASSERT (! shouldExit);
+            jobQueue.push_back (std::move (job));
+        }
+
+        queueChanged.notify_one();
+    }
+
+    /** Waits for the queue to drain, then joins all the worker threads.
+        After calling this, no more jobs may be added.
+    */
+    void waitForAllJobsToFinish()
+    {
+        {
+            std::lock_guard<std::mutex> lock (queueLock);
+            shouldExit = true;
+        }
+
+        queueChanged.notify_all();
+
+        for (auto& t : threads)
+            if (t.joinable())
+                t.join();
+
+        threads.clear();
+    }
+
+private:
+    void runJobs()
+    {
+        for (;;)
+        {
+            std::function<void()> job;
+
+            {
+                std::unique_lock<std::mutex> lock (queueLock);
+                queueChanged.wait (lock, [this] { return nextJob < jobQueue.size() || shouldExit; });
+
+                if (nextJob >= jobQueue.size())
+                    return;
+
+                job = std::move (jobQueue[nextJob++]);
+            }
+
+            job();
+        }
+    }
+
+    std::vector<std::thread> threads;
+    std::vector<std::function<void()>> jobQueue;
+    size_t nextJob = 0;
+    std::mutex queueLock;
+    std::condition_variable queueChanged;
+    bool shouldExit = false;
+};
+
+} // namespace soul
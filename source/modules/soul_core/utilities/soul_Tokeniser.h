@@ -62,6 +62,7 @@ namespace Token
     SOUL_DECLARE_TOKEN (literalInt64,   "$integer64")
     SOUL_DECLARE_TOKEN (literalFloat32, "$float32")
     SOUL_DECLARE_TOKEN (literalFloat64, "$float64")
+    SOUL_DECLARE_TOKEN (literalFloat16, "$float16")
     SOUL_DECLARE_TOKEN (literalString,  "$string literal")
     SOUL_DECLARE_TOKEN (identifier,     "$identifier")
 }
@@ -145,12 +146,19 @@ private:
     {
         if (IdentifierMatcher::isIdentifierStart (*input))
         {
-            auto end = input;
-            int len = 1;
+            // Identifier characters are always single-byte, so the rest of the span can
+            // be scanned as raw bytes without paying for UTF8 decoding - any lead byte
+            // of a multi-byte sequence is >= 128, which can't be an identifier character
+            auto start = input.getAddress();
+            auto end = start + 1;
 
-            while (IdentifierMatcher::isIdentifierBody (*++end))
-                if (++len > (int) maxIdentifierLength)
-                    throwError (Errors::identifierTooLong());
+            while (IdentifierMatcher::isIdentifierBody (static_cast<UnicodeChar> (static_cast<unsigned char> (*end))))
+                ++end;
+
+            auto len = static_cast<int> (end - start);
+
+            if (len > (int) maxIdentifierLength)
+                throwError (Errors::identifierTooLong());
 
             if (auto keyword = KeywordList::match (len, input))
             {
@@ -158,8 +166,8 @@ private:
                 return keyword;
             }
 
-            currentStringValue = std::string (input.getAddress(), end.getAddress());
-            input = end;
+            currentStringValue = std::string (start, end);
+            input = UTF8Reader (end);
             return Token::identifier;
         }
 
@@ -305,12 +313,59 @@ private:
                                                });
     }
 
+    /** If the next eight bytes are all ASCII digits, returns true and their
+        combined value, folded with a few word-sized multiplies rather than a
+        multiply-accumulate step per digit. The bytes are checked individually
+        first, so the word-sized load can never overrun the buffer.
+    */
+    static bool readEightDigits (const char* p, uint32_t& result)
+    {
+        for (int i = 0; i < 8; ++i)
+            if (p[i] < '0' || p[i] > '9')
+                return false;
+
+       #if defined (__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        uint64_t chunk;
+        memcpy (std::addressof (chunk), p, sizeof (chunk));
+
+        chunk = ((chunk & 0x0f0f0f0f0f0f0f0full) * 2561) >> 8;
+        chunk = ((chunk & 0x00ff00ff00ff00ffull) * 6553601) >> 16;
+        result = (uint32_t) (((chunk & 0x0000ffff0000ffffull) * 42949672960001ull) >> 32);
+       #else
+        uint32_t v = 0;
+
+        for (int i = 0; i < 8; ++i)
+            v = v * 10 + (uint32_t) (p[i] - '0');
+
+        result = v;
+       #endif
+
+        return true;
+    }
+
     template <int base, typename GetNextDigitFn>
     bool parseIntegerWithBase (UTF8Reader t, GetNextDigitFn&& getNextDigit)
     {
         uint64_t v = 0;
         size_t numDigits = 0;
 
+        if constexpr (base == 10)
+        {
+            // long decimal runs (big generated tables are full of them) get
+            // consumed eight digits at a time
+            uint32_t chunk;
+
+            while (readEightDigits (t.getAddress(), chunk))
+            {
+                if (v > (std::numeric_limits<uint64_t>::max() - chunk) / 100000000)
+                    throwError (Errors::integerLiteralTooLarge());
+
+                v = v * 100000000 + chunk;
+                numDigits += 8;
+                t += 8;
+            }
+        }
+
         for (;;)
         {
             auto possibleDigit = getNextDigit (*t);
@@ -346,6 +401,7 @@ private:
     TokenType parseSuffixForFloatLiteral()
     {
         if (input.advanceIfStartsWith ("f64", "_f64"))              return Token::literalFloat64;
+        if (input.advanceIfStartsWith ("f16", "_f16"))              return Token::literalFloat16;
         if (input.advanceIfStartsWith ("f32", "_f32", "f", "_f"))   return Token::literalFloat32;
 
         return Token::literalFloat64;
@@ -379,7 +435,17 @@ private:
         if (! (hasExponent || hasPoint))
             return false;
 
+       #if defined (__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611
+        // from_chars converts the already-scanned span in place, skipping the
+        // temporary string and locale machinery that std::stod drags in
+        auto parseResult = std::from_chars (input.getAddress(), t.getAddress(), literalDoubleValue);
+
+        if (parseResult.ec == std::errc::result_out_of_range)
+            literalDoubleValue = std::stod (std::string (input.getAddress(), t.getAddress()));
+       #else
         literalDoubleValue = std::stod (std::string (input.getAddress(), t.getAddress()));
+       #endif
+
         input = t;
         literalType = parseSuffixForFloatLiteral();
         checkCharacterImmediatelyAfterLiteral();
@@ -190,9 +190,25 @@ bool UTF8Reader::advanceIfStartsWith (const char* text)
 
 UTF8Reader UTF8Reader::find (const char* searchString) const
 {
-    for (auto t = *this;; ++t)
-        if (t.startsWith (searchString) || t.isEmpty())
-            return t;
+    SOUL_ASSERT (searchString != nullptr && searchString[0] != 0);
+
+    // Let strchr race through the buffer looking for the first byte (the runtime's
+    // version will use whatever vector tricks the CPU has), and only check the rest
+    // of the search string on candidate positions
+    for (auto t = data;;)
+    {
+        auto candidate = std::strchr (t, searchString[0]);
+
+        if (candidate == nullptr)
+            return UTF8Reader (t + std::strlen (t));
+
+        UTF8Reader result (candidate);
+
+        if (result.startsWith (searchString))
+            return result;
+
+        t = candidate + 1;
+    }
 }
 
 bool UTF8Reader::isWhitespace() const noexcept          { return soul::isWhitespace (*data); }
@@ -200,18 +216,65 @@ bool UTF8Reader::isDigit() const noexcept               { return soul::isDigit (
 
 UTF8Reader UTF8Reader::findEndOfWhitespace() const
 {
-    auto t = *this;
+    auto t = data;
+
+   #if SOUL_INTEL
+    // Skip any unaligned prefix a byte at a time, then whole aligned 16-byte blocks
+    // at once. An aligned block can't straddle a page boundary, so it's safe to read
+    // past the terminating null, which just shows up as a non-whitespace byte.
+    while (! isAlignedPointer<16> (t) && soul::isWhitespace (*t))
+        ++t;
+
+    if (isAlignedPointer<16> (t))
+    {
+        auto isAllWhitespace = [] (const char* p)
+        {
+            auto block = _mm_load_si128 (reinterpret_cast<const __m128i*> (p));
+            auto whitespace = _mm_or_si128 (_mm_cmpeq_epi8 (block, _mm_set1_epi8 (' ')),
+                                            _mm_and_si128 (_mm_cmpgt_epi8 (block, _mm_set1_epi8 (8)),
+                                                           _mm_cmplt_epi8 (block, _mm_set1_epi8 (14))));
+            return _mm_movemask_epi8 (whitespace) == 0xffff;
+        };
+
+        while (isAllWhitespace (t))
+            t += 16;
+    }
+   #endif
 
-    while (t.isWhitespace())
+    while (soul::isWhitespace (*t))
         ++t;
 
-    return t;
+    return UTF8Reader (t);
 }
 
 const char* UTF8Reader::findInvalidData() const
 {
     for (auto t = data; *t != 0;)
     {
+       #if SOUL_INTEL
+        // Almost everything this scans is plain ASCII, which needs no validation
+        // at all, so whole aligned 16-byte blocks with no high bits are skipped in
+        // one test. As in findEndOfWhitespace(), an aligned block can't straddle a
+        // page boundary, and a null terminator shows up in the same test that
+        // catches multi-byte sequences, so the block read can't overrun.
+        if (isAlignedPointer<16> (t))
+        {
+            auto isAllPlainASCII = [] (const char* p)
+            {
+                auto block = _mm_load_si128 (reinterpret_cast<const __m128i*> (p));
+                auto highBitsOrNulls = _mm_movemask_epi8 (block)
+                                        | _mm_movemask_epi8 (_mm_cmpeq_epi8 (block, _mm_setzero_si128()));
+                return highBitsOrNulls == 0;
+            };
+
+            while (isAllPlainASCII (t))
+                t += 16;
+
+            if (*t == 0)
+                break;
+        }
+       #endif
+
         auto byte = (signed char) *t++;
 
         if (byte < 0)
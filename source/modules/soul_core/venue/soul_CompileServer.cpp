@@ -0,0 +1,345 @@
+/*
+    _____ _____ _____ __
+   |   __|     |  |  |  |      The SOUL language
+   |__   |  |  |  |  |  |__    Copyright (c) 2019 - ROLI Ltd.
+   |_____|_____|_____|_____|
+
+   The code in this file is provided under the terms of the ISC license:
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose
+   with or without fee is hereby granted, provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#if ! SOUL_INSIDE_CORE_CPP
+ #error "Don't add this cpp file to your build, it gets included indirectly by soul_core.cpp"
+#endif
+
+#if defined (__linux__) || defined (__APPLE__)
+ #include <sys/socket.h>
+ #include <sys/un.h>
+ #include <poll.h>
+ #include <unistd.h>
+#endif
+
+namespace soul
+{
+
+#if defined (__linux__) || defined (__APPLE__)
+
+//==============================================================================
+namespace compile_server_impl
+{
+    //==============================================================================
+    /** Keeps every linked program the server has produced, so a bundle which
+        hasn't changed since it was last seen skips the whole front-end.
+    */
+    struct MemoryLinkerCache  : public LinkerCache
+    {
+        void storeItem (const char* key, const void* sourceData, uint64_t size) override
+        {
+            auto& item = items[key];
+            item.assign (static_cast<const char*> (sourceData),
+                         static_cast<const char*> (sourceData) + size);
+        }
+
+        uint64_t readItem (const char* key, void* destAddress, uint64_t destSize) override
+        {
+            auto item = items.find (key);
+
+            if (item == items.end())
+                return 0;
+
+            auto size = (uint64_t) item->second.size();
+
+            if (destAddress != nullptr && destSize >= size)
+                std::memcpy (destAddress, item->second.data(), (size_t) size);
+
+            return size;
+        }
+
+        std::unordered_map<std::string, std::vector<char>> items;
+    };
+
+    //==============================================================================
+    // The wire format is a uint32 little-endian byte count followed by that many
+    // bytes of JSON, in both directions.
+
+    static bool writeFully (int fd, const void* data, size_t size)
+    {
+        auto d = static_cast<const char*> (data);
+
+        while (size != 0)
+        {
+            // MSG_NOSIGNAL turns a write to a disconnected peer into a plain error
+            // return rather than a process-wide SIGPIPE, which would otherwise kill
+            // a resident server whenever a client gives up before reading its reply.
+            auto written = ::send (fd, d, size, MSG_NOSIGNAL);
+
+            if (written <= 0)
+                return false;
+
+            d += written;
+            size -= (size_t) written;
+        }
+
+        return true;
+    }
+
+    static bool readFully (int fd, void* data, size_t size)
+    {
+        auto d = static_cast<char*> (data);
+
+        while (size != 0)
+        {
+            auto numRead = ::read (fd, d, size);
+
+            if (numRead <= 0)
+                return false;
+
+            d += numRead;
+            size -= (size_t) numRead;
+        }
+
+        return true;
+    }
+
+    static bool writeFrame (int fd, const std::string& content)
+    {
+        uint32_t size = (uint32_t) content.size();
+
+        return writeFully (fd, std::addressof (size), sizeof (size))
+                && writeFully (fd, content.data(), content.size());
+    }
+
+    static bool readFrame (int fd, std::string& content)
+    {
+        uint32_t size = 0;
+
+        if (! readFully (fd, std::addressof (size), sizeof (size)))
+            return false;
+
+        content.resize (size);
+        return readFully (fd, content.data(), size);
+    }
+
+    //==============================================================================
+    static choc::value::Value bundleToValue (const BuildBundle& bundle)
+    {
+        auto files = choc::value::createEmptyArray();
+
+        for (auto& f : bundle.sourceFiles)
+            files.addArrayElement (choc::value::createObject ({},
+                                      "name", f.filename,
+                                      "content", f.content));
+
+        return choc::value::createObject ({},
+                  "sampleRate",            bundle.settings.sampleRate,
+                  "maxBlockSize",          (int64_t) bundle.settings.maxBlockSize,
+                  "maxStateSize",          (int64_t) bundle.settings.maxStateSize,
+                  "optimisationLevel",     (int64_t) bundle.settings.optimisationLevel,
+                  "sessionID",             (int64_t) bundle.settings.sessionID,
+                  "pipelineLatencyBlocks", (int64_t) bundle.settings.pipelineLatencyBlocks,
+                  "mainProcessor",         bundle.settings.mainProcessor,
+                  "customSettings",        bundle.settings.customSettings,
+                  "files",                 files);
+    }
+
+    static BuildBundle valueToBundle (const choc::value::ValueView& v)
+    {
+        BuildBundle bundle;
+        bundle.settings.sampleRate            = v["sampleRate"].getWithDefault (0.0);
+        bundle.settings.maxBlockSize          = (uint32_t) v["maxBlockSize"].getWithDefault ((int64_t) 0);
+        bundle.settings.maxStateSize          = (size_t)   v["maxStateSize"].getWithDefault ((int64_t) 0);
+        bundle.settings.optimisationLevel     = (int)      v["optimisationLevel"].getWithDefault ((int64_t) -1);
+        bundle.settings.sessionID             = (int32_t)  v["sessionID"].getWithDefault ((int64_t) 0);
+        bundle.settings.pipelineLatencyBlocks = (uint32_t) v["pipelineLatencyBlocks"].getWithDefault ((int64_t) 0);
+        bundle.settings.mainProcessor         = v["mainProcessor"].getWithDefault (std::string());
+        bundle.settings.customSettings        = choc::value::Value (v["customSettings"]);
+
+        auto files = v["files"];
+
+        for (uint32_t i = 0; i < files.size(); ++i)
+            bundle.sourceFiles.push_back ({ files[i]["name"].getWithDefault (std::string()),
+                                            files[i]["content"].getWithDefault (std::string()) });
+
+        return bundle;
+    }
+
+    //==============================================================================
+    static std::string handleCompileRequest (const std::string& request, LinkerCache& cache)
+    {
+        CompileMessageList messages;
+        Program program;
+
+        try
+        {
+            auto bundle = valueToBundle (choc::json::parse (request));
+            program = Compiler::buildWithCache (messages, bundle, std::addressof (cache));
+        }
+        catch (const std::exception& e)
+        {
+            messages.addError (e.what(), {});
+        }
+        catch (AbortCompilationException) {}
+
+        auto messageArray = choc::value::createEmptyArray();
+
+        for (auto& m : messages.messages)
+            messageArray.addArrayElement (choc::value::createObject ({},
+                                             "severity", m.getSeverity(),
+                                             "description", m.getFullDescription()));
+
+        bool ok = ! (messages.hasErrors() || program.isEmpty());
+
+        return choc::json::toString (choc::value::createObject ({},
+                                        "ok", ok,
+                                        "heart", ok ? program.toHEART() : std::string(),
+                                        "messages", messageArray));
+    }
+
+    //==============================================================================
+    static int createBoundListeningSocket (const std::string& socketPath)
+    {
+        sockaddr_un address = {};
+
+        if (socketPath.length() >= sizeof (address.sun_path))
+            return -1;
+
+        auto fd = ::socket (AF_UNIX, SOCK_STREAM, 0);
+
+        if (fd < 0)
+            return -1;
+
+        ::unlink (socketPath.c_str());
+        address.sun_family = AF_UNIX;
+        std::memcpy (address.sun_path, socketPath.c_str(), socketPath.length() + 1);
+
+        if (::bind (fd, reinterpret_cast<sockaddr*> (std::addressof (address)), sizeof (address)) != 0
+             || ::listen (fd, 4) != 0)
+        {
+            ::close (fd);
+            return -1;
+        }
+
+        return fd;
+    }
+
+    static bool waitForActivity (int fd, const std::function<bool()>& shouldKeepRunning)
+    {
+        for (;;)
+        {
+            if (shouldKeepRunning != nullptr && ! shouldKeepRunning())
+                return false;
+
+            pollfd p = { fd, POLLIN, 0 };
+            auto result = ::poll (std::addressof (p), 1, 200);
+
+            if (result > 0)
+                return true;
+
+            if (result < 0 && errno != EINTR)
+                return false;
+        }
+    }
+}
+
+bool CompileServer::runServer (const std::string& socketPath, const std::function<bool()>& shouldKeepRunning)
+{
+    using namespace compile_server_impl;
+
+    auto listenFD = createBoundListeningSocket (socketPath);
+
+    if (listenFD < 0)
+        return false;
+
+    MemoryLinkerCache cache;
+
+    while (waitForActivity (listenFD, shouldKeepRunning))
+    {
+        auto connection = ::accept (listenFD, nullptr, nullptr);
+
+        if (connection < 0)
+            continue;
+
+        std::string request;
+
+        while (readFrame (connection, request))
+            if (! writeFrame (connection, handleCompileRequest (request, cache)))
+                break;
+
+        ::close (connection);
+    }
+
+    ::close (listenFD);
+    ::unlink (socketPath.c_str());
+    return true;
+}
+
+CompileServer::Response CompileServer::compileOnServer (const std::string& socketPath, const BuildBundle& bundle)
+{
+    using namespace compile_server_impl;
+    Response response;
+
+    sockaddr_un address = {};
+
+    if (socketPath.length() >= sizeof (address.sun_path))
+        return response;
+
+    auto fd = ::socket (AF_UNIX, SOCK_STREAM, 0);
+
+    if (fd < 0)
+        return response;
+
+    address.sun_family = AF_UNIX;
+    std::memcpy (address.sun_path, socketPath.c_str(), socketPath.length() + 1);
+
+    std::string reply;
+
+    if (::connect (fd, reinterpret_cast<sockaddr*> (std::addressof (address)), sizeof (address)) == 0
+         && writeFrame (fd, choc::json::toString (bundleToValue (bundle)))
+         && readFrame (fd, reply))
+    {
+        try
+        {
+            auto v = choc::json::parse (reply);
+            response.compiledOK = v["ok"].getWithDefault (false);
+            response.heart = v["heart"].getWithDefault (std::string());
+
+            auto messages = v["messages"];
+
+            for (uint32_t i = 0; i < messages.size(); ++i)
+                response.messages.push_back ({ messages[i]["severity"].getWithDefault (std::string()),
+                                               messages[i]["description"].getWithDefault (std::string()) });
+
+            response.communicationOK = true;
+        }
+        catch (const std::exception&) {}
+    }
+
+    ::close (fd);
+    return response;
+}
+
+#else
+
+bool CompileServer::runServer (const std::string&, const std::function<bool()>&)
+{
+    return false;
+}
+
+CompileServer::Response CompileServer::compileOnServer (const std::string&, const BuildBundle&)
+{
+    return {};
+}
+
+#endif
+
+} // namespace soul
@@ -0,0 +1,77 @@
+/*
+    _____ _____ _____ __
+   |   __|     |  |  |  |      The SOUL language
+   |__   |  |  |  |  |  |__    Copyright (c) 2019 - ROLI Ltd.
+   |_____|_____|_____|_____|
+
+   The code in this file is provided under the terms of the ISC license:
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose
+   with or without fee is hereby granted, provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+namespace soul
+{
+
+//==============================================================================
+/**
+    A long-lived compile service which accepts BuildBundles over a local socket
+    and returns the serialised HEART of the linked program plus any diagnostics.
+
+    A pipeline which shells out once per compile pays process startup, library
+    parsing and allocator warm-up for every patch it validates. Keeping one
+    server process resident amortises all of that: the in-process LinkerCache
+    keeps the linked HEART of every bundle it has seen, and the compiler's
+    internal memo caches stay warm between requests, so re-validating a mostly
+    unchanged corpus is dominated by the few patches that actually changed.
+
+    The transport is deliberately minimal - a stream of length-prefixed JSON
+    messages over a Unix-domain socket, one response per request, served
+    sequentially - because the intended client is a build script, not a DAW.
+    Like the sandboxed venue in soul_SharedMemoryVenue.cpp this is only
+    implemented for POSIX systems; elsewhere runServer() just returns false.
+*/
+struct CompileServer
+{
+    /** One diagnostic from a compile, flattened to text so that a client
+        doesn't need to reconstruct CodeLocations to print it.
+    */
+    struct Message
+    {
+        std::string severity;         /**< "error", "warning" or "internal compiler error". */
+        std::string description;      /**< The full description, including any file/line/column prefix. */
+    };
+
+    struct Response
+    {
+        /** False if the server couldn't be reached or the reply was malformed -
+            in which case nothing can be said about the bundle itself.
+        */
+        bool communicationOK = false;
+
+        bool compiledOK = false;
+        std::string heart;            /**< The serialised HEART of the linked program, empty on failure. */
+        std::vector<Message> messages;
+    };
+
+    //==============================================================================
+    /** Creates the socket and serves compile requests until shouldKeepRunning
+        (polled between requests, if supplied) returns false. Returns false if
+        the socket couldn't be created, or on platforms with no implementation.
+    */
+    static bool runServer (const std::string& socketPath,
+                           const std::function<bool()>& shouldKeepRunning = {});
+
+    /** Sends a bundle to a running server and waits for its response. */
+    static Response compileOnServer (const std::string& socketPath, const BuildBundle&);
+};
+
+} // namespace soul
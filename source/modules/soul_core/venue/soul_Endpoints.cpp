@@ -53,9 +53,155 @@ Type createMIDIEventEndpointType()
     return Type::createStruct (*s);
 }
 
+bool isUMPMessageStruct (const choc::value::Type& type)
+{
+    if (! type.isObject())
+        return false;
+
+    return endsWith (type.getObjectClassName(), "UMPMessage")
+            && type.getNumElements() == 2
+            && type.getObjectMember (0).name == "word0"
+            && type.getObjectMember (0).type.isInt32()
+            && type.getObjectMember (1).name == "word1"
+            && type.getObjectMember (1).type.isInt32();
+}
+
+bool isUMPEventEndpoint (const EndpointDetails& details)
+{
+    return isEvent (details)
+            && details.dataTypes.size() == 1
+            && isUMPMessageStruct (details.dataTypes.front())
+            && ! isConsoleEndpoint (details.name);
+}
+
+Type createUMPEventEndpointType()
+{
+    StructurePtr s (*new Structure ("UMPMessage", nullptr));
+    s->getMembers().push_back ({ PrimitiveType::int32, "word0", {} });
+    s->getMembers().push_back ({ PrimitiveType::int32, "word1", {} });
+    return Type::createStruct (*s);
+}
+
+FixedFrameLayout FixedFrameLayout::fromFrameType (const choc::value::Type& frameType)
+{
+    FixedFrameLayout layout;
+
+    auto getScalarFormat = [] (const choc::value::Type& t)
+    {
+        if (t.isFloat32())   return SampleFormat::float32;
+        if (t.isFloat64())   return SampleFormat::float64;
+        if (t.isInt32())     return SampleFormat::int32;
+        if (t.isInt64())     return SampleFormat::int64;
+
+        return SampleFormat::unknown;
+    };
+
+    if (frameType.isPrimitive())
+    {
+        layout.format = getScalarFormat (frameType);
+        layout.numChannels = 1;
+    }
+    else if (frameType.isVector())
+    {
+        layout.format = getScalarFormat (frameType.getElementType());
+        layout.numChannels = frameType.getNumElements();
+    }
+    else if (isMIDIMessageStruct (frameType))
+    {
+        layout.format = SampleFormat::int32;
+        layout.numChannels = 1;
+        layout.isMIDIMessage = true;
+    }
+
+    if (layout.format != SampleFormat::unknown)
+        layout.bytesPerFrame = (uint32_t) frameType.getValueDataSize();
+
+    return layout;
+}
+
+EndpointDescriptorTable buildEndpointDescriptorTable (ArrayView<const EndpointDetails> inputs,
+                                                      ArrayView<const EndpointDetails> outputs)
+{
+    EndpointDescriptorTable table;
+    table.descriptors.reserve (inputs.size() + outputs.size());
+
+    auto intern = [&] (std::string_view s) -> EndpointDescriptor::StringRef
+    {
+        if (s.empty())
+            return {};
+
+        // the pool stays small enough that a substring search is cheaper than
+        // keeping a side map, and it dedupes repeated units and group names
+        auto existing = table.stringPool.find (s);
+
+        if (existing != std::string::npos)
+            return { (uint32_t) existing, (uint32_t) s.length() };
+
+        EndpointDescriptor::StringRef ref { (uint32_t) table.stringPool.length(), (uint32_t) s.length() };
+        table.stringPool.append (s);
+        return ref;
+    };
+
+    auto add = [&] (const EndpointDetails& details, bool isInput)
+    {
+        EndpointDescriptor d;
+        d.endpointID      = intern (details.endpointID.toString());
+        d.endpointType    = details.endpointType;
+        d.numAudioChannels = details.getNumAudioChannels();
+        d.isInput         = isInput;
+        d.isParameter     = isInput && isParameterInput (details);
+        d.isMIDI          = isMIDIEventEndpoint (details);
+        d.isConsole       = isConsoleEndpoint (details.name);
+
+        const auto& annotation = details.annotation;
+        auto displayName = annotation.getString ("name");
+        d.displayName = intern (displayName.empty() ? details.name : displayName);
+
+        auto defaultNumIntervals = 1000.0;
+        auto text = annotation.getString ("text");
+
+        if (! text.empty())
+        {
+            auto items = choc::text::splitString (choc::text::removeDoubleQuotes (text), '|', false);
+
+            if (items.size() > 1)
+            {
+                defaultNumIntervals = (double) items.size() - 1;
+                d.maxValue = (float) defaultNumIntervals;
+            }
+        }
+
+        d.unit         = intern (annotation.getString ("unit"));
+        d.group        = intern (annotation.getString ("group"));
+        d.textValues   = intern (text);
+        d.minValue     = (float) annotation.getDouble ("min", d.minValue);
+        d.maxValue     = (float) annotation.getDouble ("max", d.maxValue);
+        d.step         = (float) annotation.getDouble ("step", d.maxValue / defaultNumIntervals);
+        d.initialValue = (float) annotation.getDouble ("init", d.minValue);
+
+        auto rampFrames = annotation.getInt64 ("rampFrames");
+        d.rampFrames = rampFrames > 0 ? (uint32_t) rampFrames : 0;
+
+        d.isExponentialRamp = annotation.getString ("rampShape") == "exponential";
+        d.isAutomatable     = annotation.getBool ("automatable", true);
+        d.isBoolean         = annotation.getBool ("boolean");
+        d.isHidden          = annotation.getBool ("hidden");
+
+        table.descriptors.push_back (std::move (d));
+    };
+
+    for (auto& details : inputs)
+        add (details, true);
+
+    for (auto& details : outputs)
+        add (details, false);
+
+    return table;
+}
+
 bool isParameterInput (const EndpointDetails& details)
 {
-    if (isEvent (details) && ! isMIDIEventEndpoint (details))
+    if (isEvent (details) && ! isMIDIEventEndpoint (details) && ! isTimelineEventEndpoint (details))
         return true;
 
     if (isStream (details) && details.annotation.hasValue ("name"))
@@ -67,4 +213,73 @@ bool isParameterInput (const EndpointDetails& details)
     return false;
 }
 
+//==============================================================================
+static bool isTimelineStruct (const choc::value::Type& type, const char* suffix,
+                              std::initializer_list<std::pair<const char*, bool(choc::value::Type::*)() const>> members)
+{
+    if (! type.isObject() || ! endsWith (type.getObjectClassName(), suffix)
+         || type.getNumElements() != members.size())
+        return false;
+
+    uint32_t index = 0;
+
+    for (auto& m : members)
+    {
+        const auto& member = type.getObjectMember (index++);
+
+        if (member.name != m.first || ! (member.type.*m.second)())
+            return false;
+    }
+
+    return true;
+}
+
+bool isTimelineTimeSignature (const choc::value::Type& type)
+{
+    return isTimelineStruct (type, "TimeSignature",
+                             { { "numerator",   &choc::value::Type::isInt32 },
+                               { "denominator", &choc::value::Type::isInt32 } });
+}
+
+bool isTimelineTempo (const choc::value::Type& type)
+{
+    return isTimelineStruct (type, "Tempo",
+                             { { "bpm", &choc::value::Type::isFloat32 } });
+}
+
+bool isTimelineTempoRamp (const choc::value::Type& type)
+{
+    return isTimelineStruct (type, "TempoRamp",
+                             { { "startBPM",         &choc::value::Type::isFloat32 },
+                               { "endBPM",           &choc::value::Type::isFloat32 },
+                               { "rampLengthFrames", &choc::value::Type::isInt64 } });
+}
+
+bool isTimelineTransportState (const choc::value::Type& type)
+{
+    return isTimelineStruct (type, "TransportState",
+                             { { "state", &choc::value::Type::isInt32 } });
+}
+
+bool isTimelinePosition (const choc::value::Type& type)
+{
+    return isTimelineStruct (type, "Position",
+                             { { "currentFrame",            &choc::value::Type::isInt64 },
+                               { "currentQuarterNote",      &choc::value::Type::isFloat64 },
+                               { "lastBarStartQuarterNote", &choc::value::Type::isFloat64 } });
+}
+
+bool isTimelineEventEndpoint (const EndpointDetails& details)
+{
+    if (! isEvent (details) || isConsoleEndpoint (details.name))
+        return false;
+
+    for (auto& type : details.dataTypes)
+        if (isTimelineTimeSignature (type) || isTimelineTempo (type) || isTimelineTempoRamp (type)
+             || isTimelineTransportState (type) || isTimelinePosition (type))
+            return true;
+
+    return false;
+}
+
 } // namespace soul
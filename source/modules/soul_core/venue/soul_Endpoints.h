@@ -63,10 +63,328 @@ EndpointID findFirstOutputOfType (VenueOrPerformer& p, EndpointType t)
     return {};
 }
 
+//==============================================================================
+/** A precompiled layout descriptor for the fixed frame types which dominate
+    endpoint traffic: scalar and vector audio frames, and MIDI message structs.
+
+    A generic choc::value::ValueView interprets its type tree on every element
+    access, which is pure overhead when the layout never changes after linking.
+    This captures the layout once - sample format, channel count and frame
+    stride - and the accessors below then reinterpret a frame array's packed
+    data directly as a typed span, with no per-frame type walking at all.
+
+    The reinterpretation is safe because choc packs primitives, vectors and
+    uniform arrays contiguously with no padding, which is the same property the
+    venue code relies on when it memcpys whole blocks around.
+*/
+struct FixedFrameLayout
+{
+    enum class SampleFormat
+    {
+        unknown,
+        float32,
+        float64,
+        int32,
+        int64
+    };
+
+    /** Builds a layout for a frame or event type, returning an invalid layout
+        for anything whose shape can't be described by one.
+    */
+    static FixedFrameLayout fromFrameType (const choc::value::Type& frameType);
+
+    bool isValid() const     { return format != SampleFormat::unknown; }
+
+    /** Returns the number of frames in a packed frame array. */
+    uint32_t getNumFrames (const choc::value::ValueView& frameArray) const
+    {
+        return (uint32_t) (frameArray.getType().getValueDataSize() / bytesPerFrame);
+    }
+
+    /** Returns a frame array's packed samples as a flat typed span of
+        getNumFrames() * numChannels interleaved samples. The SampleType must
+        match the layout's format, which the caller checks once at setup.
+    */
+    template <typename SampleType>
+    SampleType* getSamples (const choc::value::ValueView& frameArray) const
+    {
+        SOUL_ASSERT (sizeof (SampleType) * numChannels == bytesPerFrame);
+        return static_cast<SampleType*> (const_cast<void*> (frameArray.getRawData()));
+    }
+
+    /** For a MIDI message struct, returns the packed int32 message bytes without
+        any member lookup.
+    */
+    int32_t getPackedMIDIMessage (const choc::value::ValueView& message) const
+    {
+        SOUL_ASSERT (isMIDIMessage && format == SampleFormat::int32);
+        int32_t packed;
+        memcpy (std::addressof (packed), message.getRawData(), sizeof (packed));
+        return packed;
+    }
+
+    SampleFormat format = SampleFormat::unknown;
+    uint32_t numChannels = 0;
+    uint32_t bytesPerFrame = 0;
+    bool isMIDIMessage = false;
+};
+
+//==============================================================================
+/** The direction and data flavour of a resolved EndpointAccessor. */
+enum class EndpointAccessorKind
+{
+    streamInput,
+    valueInput,
+    eventInput,
+    streamOutput,
+    valueOutput,
+    eventOutput
+};
+
+/** A pre-resolved, pre-validated accessor for a single endpoint.
+
+    These are created in bulk by resolveEndpointAccessors(), which captures the
+    handle, the data type and the frame stride once, up-front. The per-block
+    methods below therefore do no endpoint list searches and no type checks -
+    they pass the cached handle straight through to the performer, so touching
+    hundreds of endpoints per block costs no more than the underlying calls.
+
+    Each method is only valid for the matching kind - e.g. writeStreamFrames()
+    on a streamInput - which the caller checks once at resolution time rather
+    than per call.
+*/
+struct EndpointAccessor
+{
+    bool isValid() const     { return handle.isValid(); }
+
+    template <typename PerformerType>
+    void writeStreamFrames (PerformerType& p, const choc::value::ValueView& frameArray) const
+    {
+        p.setNextInputStreamFrames (handle, frameArray);
+    }
+
+    template <typename PerformerType>
+    void setSparseStreamTarget (PerformerType& p, const choc::value::ValueView& targetFrameValue, uint32_t numFramesToReachValue) const
+    {
+        p.setSparseInputStreamTarget (handle, targetFrameValue, numFramesToReachValue);
+    }
+
+    template <typename PerformerType>
+    void setValue (PerformerType& p, const choc::value::ValueView& newValue) const
+    {
+        p.setInputValue (handle, newValue);
+    }
+
+    template <typename PerformerType>
+    void sendEvent (PerformerType& p, const choc::value::ValueView& eventData) const
+    {
+        p.addInputEvent (handle, eventData);
+    }
+
+    template <typename PerformerType>
+    choc::value::ValueView readStreamFrames (PerformerType& p) const
+    {
+        return p.getOutputStreamFrames (handle);
+    }
+
+    template <typename PerformerType>
+    choc::value::ValueView readValue (PerformerType& p) const
+    {
+        return p.getOutputValue (handle);
+    }
+
+    template <typename PerformerType, typename HandleEventFn>
+    void iterateEvents (PerformerType& p, HandleEventFn&& handleEvent) const
+    {
+        p.iterateOutputEvents (handle, std::forward<HandleEventFn> (handleEvent));
+    }
+
+    EndpointID endpointID;
+    EndpointHandle handle;
+    EndpointAccessorKind kind = EndpointAccessorKind::streamInput;
+
+    /** The frame type for a stream, the value type for a value, or the first
+        event type for an event endpoint.
+    */
+    choc::value::Type dataType;
+
+    /** The packed byte size of one frame, for stream endpoints, or 0 otherwise. */
+    uint32_t bytesPerFrame = 0;
+
+    /** A precompiled layout for the endpoint's data type, valid when the type
+        is one of the fixed shapes FixedFrameLayout describes. When it is, block
+        data can be accessed as a typed span instead of through ValueView.
+    */
+    FixedFrameLayout frameLayout;
+};
+
+/** The result of a one-shot bulk endpoint resolution.
+    @see resolveEndpointAccessors
+*/
+struct EndpointAccessorList
+{
+    /** Returns the accessor for an endpoint, or nullptr if it wasn't resolved. */
+    const EndpointAccessor* find (const EndpointID& endpointID) const
+    {
+        auto found = indexes.find (endpointID.toString());
+
+        if (found == indexes.end())
+            return nullptr;
+
+        return std::addressof (accessors[found->second]);
+    }
+
+    std::vector<EndpointAccessor> accessors;
+    std::unordered_map<std::string, size_t> indexes;
+};
+
+/** Resolves every endpoint a performer exposes in a single pass, returning
+    validated, typed accessors for them all.
+
+    This must be called while the program is loaded but not yet linked, since
+    that's the only window in which handles can be fetched. The endpoint lists
+    are each walked exactly once, so the cost of setting up a session stays
+    linear in the number of endpoints rather than quadratic.
+*/
+template <typename PerformerType>
+EndpointAccessorList resolveEndpointAccessors (PerformerType& p)
+{
+    EndpointAccessorList result;
+
+    auto addAccessor = [&] (const EndpointDetails& details, bool isInput)
+    {
+        EndpointAccessor a;
+        a.endpointID = details.endpointID;
+        a.handle = p.getEndpointHandle (details.endpointID);
+
+        if (! a.handle.isValid())
+            return;
+
+        if (isEvent (details))
+            a.kind = isInput ? EndpointAccessorKind::eventInput : EndpointAccessorKind::eventOutput;
+        else if (isStream (details))
+            a.kind = isInput ? EndpointAccessorKind::streamInput : EndpointAccessorKind::streamOutput;
+        else
+            a.kind = isInput ? EndpointAccessorKind::valueInput : EndpointAccessorKind::valueOutput;
+
+        if (! details.dataTypes.empty())
+        {
+            a.dataType = details.dataTypes.front();
+            a.frameLayout = FixedFrameLayout::fromFrameType (a.dataType);
+
+            if (isStream (details))
+                a.bytesPerFrame = (uint32_t) a.dataType.getValueDataSize();
+        }
+
+        result.indexes[details.endpointID.toString()] = result.accessors.size();
+        result.accessors.push_back (std::move (a));
+    };
+
+    for (auto& details : p.getInputEndpoints())
+        addAccessor (details, true);
+
+    for (auto& details : p.getOutputEndpoints())
+        addAccessor (details, false);
+
+    return result;
+}
+
+//==============================================================================
+/** A flat, fixed-size record describing one endpoint, holding everything a host
+    needs when it enumerates a program's parameters.
+
+    EndpointDetails carries choc::value objects for its types and annotation,
+    and callers tend to re-convert those into strings and numbers every time a
+    parameter list is built. A descriptor captures the result of that work once:
+    every field is a plain number, a flag, or a reference into the owning
+    table's interned string pool, so walking a table of hundreds of these
+    touches two contiguous allocations and parses no value trees at all.
+
+    @see EndpointDescriptorTable, Performer::getEndpointDescriptorTable
+*/
+struct EndpointDescriptor
+{
+    /** Refers to an interned string in the owning table's string pool.
+        @see EndpointDescriptorTable::getString
+    */
+    struct StringRef
+    {
+        uint32_t offset = 0, length = 0;
+    };
+
+    StringRef endpointID;       /**< The endpoint's program-level ID. */
+    StringRef displayName;      /**< The annotation's "name", falling back to the endpoint's own name. */
+    StringRef unit;             /**< The annotation's "unit", or empty. */
+    StringRef group;            /**< The annotation's "group", or empty. */
+    StringRef textValues;       /**< The annotation's "text" list of discrete values, or empty. */
+
+    EndpointType endpointType = EndpointType::value;
+
+    float minValue = 0, maxValue = 1.0f, step = 0, initialValue = 0;
+    uint32_t rampFrames = 0;
+    uint32_t numAudioChannels = 0;
+
+    bool isInput = false;
+    bool isParameter = false;           /**< @see isParameterInput() */
+    bool isMIDI = false;                /**< @see isMIDIEventEndpoint() */
+    bool isConsole = false;
+    bool isExponentialRamp = false;     /**< True when the annotation's "rampShape" is "exponential". */
+    bool isAutomatable = false;
+    bool isBoolean = false;
+    bool isHidden = false;
+};
+
+/** The result of converting a set of EndpointDetails into flat descriptors.
+    @see buildEndpointDescriptorTable, Performer::getEndpointDescriptorTable
+*/
+struct EndpointDescriptorTable
+{
+    /** Resolves one of a descriptor's interned string references. */
+    std::string_view getString (EndpointDescriptor::StringRef s) const
+    {
+        return std::string_view (stringPool).substr (s.offset, s.length);
+    }
+
+    std::vector<EndpointDescriptor> descriptors;
+    std::string stringPool;
+};
+
+/** Converts a performer's endpoint lists into a flat descriptor table,
+    pre-parsing the annotation properties that parameter-building code keeps
+    re-deriving from the choc::value objects in EndpointDetails.
+
+    The numeric range fields follow the same conventions as the patch layer: a
+    "text" list of N discrete values implies a 0..N-1 range, and "step" defaults
+    to a thousandth of the range when the annotation doesn't give one.
+*/
+EndpointDescriptorTable buildEndpointDescriptorTable (ArrayView<const EndpointDetails> inputs,
+                                                      ArrayView<const EndpointDetails> outputs);
+
+//==============================================================================
 bool isMIDIMessageStruct (const choc::value::Type&);
 bool isMIDIEventEndpoint (const EndpointDetails&);
 Type createMIDIEventEndpointType();
+bool isUMPMessageStruct (const choc::value::Type&);
+bool isUMPEventEndpoint (const EndpointDetails&);
+Type createUMPEventEndpointType();
 bool isParameterInput (const EndpointDetails&);
 bool isConsoleEndpoint (const std::string& endpointName);
 
+//==============================================================================
+/** These recognise the structs from the soul::timeline library namespace by
+    their shape, the same way the MIDI message structs are recognised above,
+    so a host can spot the endpoints through which a program wants to receive
+    timeline updates. @see isTimelineEventEndpoint, TimelineEvent
+*/
+bool isTimelineTimeSignature (const choc::value::Type&);
+bool isTimelineTempo (const choc::value::Type&);
+bool isTimelineTempoRamp (const choc::value::Type&);
+bool isTimelineTransportState (const choc::value::Type&);
+bool isTimelinePosition (const choc::value::Type&);
+
+/** Returns true if this is an event input which accepts any of the
+    soul::timeline struct types.
+*/
+bool isTimelineEventEndpoint (const EndpointDetails&);
+
 } // namespace soul
@@ -22,6 +22,8 @@ namespace soul
 {
 
 class LinkerCache;
+class ProgramMemoryAllocator;
+class OffloadBackend;
 
 //==============================================================================
 /**
@@ -76,6 +78,68 @@ public:
     /** Set the value of an external in the loaded program. */
     virtual bool setExternalVariable (const char* name, const choc::value::ValueView& value) noexcept = 0;
 
+    /** An object which can supply the raw data for external variables on demand.
+        @see setExternalDataProvider
+    */
+    struct ExternalDataProvider
+    {
+        virtual ~ExternalDataProvider() = default;
+
+        /** Called by the performer when it needs the data for the named external.
+            The returned view is used in-place rather than copied, so the memory it
+            refers to (which could for example be a memory-mapped file, paged in
+            lazily as the running program touches it) must remain valid and
+            unmodified until the program is unloaded or a different provider is set.
+            Return a void value to indicate that this provider can't supply the
+            named external.
+        */
+        virtual choc::value::ValueView getExternalVariableData (const char* name) = 0;
+    };
+
+    /** Gives the performer an object which it can ask for external variable data
+        instead of the caller pushing fully-materialised values in through
+        setExternalVariable().
+
+        Because the data is referenced in place, a program whose externals are
+        backed by memory-mapped sample files can be linked without first loading
+        those files into RAM. The provider must outlive the loaded program.
+
+        The default implementation returns false, meaning that the performer
+        doesn't support providers and the caller should fall back to
+        setExternalVariable().
+    */
+    virtual bool setExternalDataProvider (ExternalDataProvider* provider) noexcept    { ignoreUnused (provider); return false; }
+
+    /** Returns the list of external functions whose implementations must be supplied
+        through setExternalFunction() before a loaded program can be linked.
+
+        The default implementation returns an empty list, for engines which don't
+        support external functions - a program which declares any can't be linked
+        by such an engine.
+    */
+    virtual ArrayView<const ExternalFunction> getExternalFunctions() noexcept        { return {}; }
+
+    /** Supplies the native implementation for one of the loaded program's external
+        functions, as a raw function pointer.
+
+        This must be called after load() and before link(): the engine binds the
+        pointer while linking, so that calls from the running program go straight
+        to the native function with no per-call marshalling or lookups.
+
+        The pointer must be to a function with the C calling convention whose
+        signature matches the declaration: primitives map to the obvious C types
+        (int32_t, int64_t, float, double, bool), a vector parameter is passed as a
+        pointer to its elements, and an array parameter is passed as a pointer to
+        its elements followed by an int32_t element count. The function will be
+        called from the rendering thread, so it must be real-time safe: no locks,
+        no allocation, no blocking, and no retaining of the pointers it's given
+        beyond the duration of the call.
+
+        Returns false if the engine doesn't support external functions, or if no
+        loaded program declares a function with this name.
+    */
+    virtual bool setExternalFunction (const char* name, void* functionPointer) noexcept  { ignoreUnused (name, functionPointer); return false; }
+
     /** After loading a program, and optionally connecting up to some of its endpoints,
         link() will complete any preparations needed before the code can be executed.
         If this returns true, then you can safely start calling advance(). If it
@@ -99,6 +163,18 @@ public:
     */
     virtual void reset() noexcept = 0;
 
+    /** Like reset(), but allowed to take a fast path.
+
+        An engine which captured an image of the state region when the program
+        was freshly linked can restore it with a single copy, rather than
+        re-running the init function - which makes reusing a pooled, already
+        linked performer for a new play session almost free. Engines whose
+        init semantics aren't reproducible by a copy (e.g. states seeded from
+        a real-time clock) should fall back to reset(), which is also the
+        default implementation.
+    */
+    virtual void resetToInitialState() noexcept     { reset(); }
+
     /** When a program has been loaded (but not yet linked), this returns
         a handle that can be used later by other methods which need to reference
         an input or output endpoint.
@@ -159,6 +235,53 @@ public:
     */
     virtual void addInputEvent (EndpointHandle, const choc::value::ValueView& eventData) noexcept = 0;
 
+    /** Adds a batch of events to an input queue with a single call.
+
+        This is equivalent to calling addInputEvent() for each element of the events
+        array in turn, but lets an implementation do its queue housekeeping once per
+        batch rather than once per event, which matters for dense streams such as MPE.
+
+        If frameOffsets is non-null, it supplies a frame offset within the next block
+        for each event, and the offsets must be in ascending order. The default
+        implementation delivers everything at the start of the block, but engines
+        which support intra-block dispatch can use the offsets to deliver the events
+        sample-accurately, allowing a caller to render a whole block in one advance()
+        instead of splitting it at every event boundary.
+    */
+    virtual void addInputEvents (EndpointHandle handle, const choc::value::ValueView* events,
+                                 const uint32_t* frameOffsets, uint32_t count) noexcept
+    {
+        ignoreUnused (frameOffsets);
+
+        for (uint32_t i = 0; i < count; ++i)
+            addInputEvent (handle, events[i]);
+    }
+
+    /** Adds a batch of standard MIDI messages to an input queue with a single call.
+
+        This may only be used for an endpoint whose event type is the standard
+        soul::midi::Message struct, whose fixed layout is a single packed int32,
+        so a caller can hand over a block's worth of messages as a plain array
+        of ints rather than wrapping each one in a choc::value object.
+
+        The frameOffsets argument follows the same rules as addInputEvents().
+        The default implementation boxes the messages into a reusable value and
+        delivers them one at a time, so an engine that wants the allocation-free
+        path should override this and copy the ints straight into its queue.
+    */
+    virtual void addInputMIDIMessages (EndpointHandle handle, const int32_t* packedMIDIMessages,
+                                       const uint32_t* frameOffsets, uint32_t count) noexcept
+    {
+        ignoreUnused (frameOffsets);
+        auto message = choc::value::createObject ("Message", "midiBytes", (int32_t) 0);
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            message.getObjectMemberAt (0).value.set (packedMIDIMessages[i]);
+            addInputEvent (handle, message);
+        }
+    }
+
     /** Retrieves the most recent block of frames from an output stream.
         After a successful call to advance(), this may be called to get the block of frames which
         were rendered during that call. A nullptr return value indicates an error.
@@ -212,6 +335,539 @@ public:
     /** Returns the error message for the performer - if no error is present, this returns nullptr
     */
     virtual const char* getError() noexcept = 0;
+
+    //==============================================================================
+    /** Attempts to pin a caller-owned buffer as the storage for an input stream endpoint.
+
+        When an implementation supports this, it removes the staging copy which
+        setNextInputStreamFrames() has to make: each call to advance() reads its input
+        frames directly from the pinned view. The memory must stay valid, and its
+        contents stable during calls to advance(), until the buffer is replaced, the
+        endpoint is pinned to something else, or the program is unloaded. The view must
+        hold at least as many frames as the block size specified when linking.
+
+        The default implementation returns false, meaning the endpoint can't use the
+        buffer directly and the caller should fall back to setNextInputStreamFrames().
+    */
+    virtual bool setInputStreamBuffer (EndpointHandle h, choc::buffer::InterleavedView<const float> buffer) noexcept     { ignoreUnused (h, buffer); return false; }
+
+    /** Pins a planar (channel-array) caller-owned buffer as input endpoint storage.
+        @see setInputStreamBuffer
+    */
+    virtual bool setInputStreamBuffer (EndpointHandle h, choc::buffer::ChannelArrayView<const float> buffer) noexcept   { ignoreUnused (h, buffer); return false; }
+
+    /** Attempts to pin a caller-owned buffer to receive an output stream endpoint's frames.
+
+        When supported, each call to advance() writes the rendered frames straight into
+        the pinned view instead of an internal buffer, so no getOutputStreamFrames()
+        copy is needed. The same lifetime and size requirements apply as for
+        setInputStreamBuffer(). Returns false if unsupported, in which case the caller
+        should read the block via getOutputStreamFrames() as usual.
+    */
+    virtual bool setOutputStreamBuffer (EndpointHandle h, choc::buffer::InterleavedView<float> buffer) noexcept          { ignoreUnused (h, buffer); return false; }
+
+    /** Pins a planar (channel-array) caller-owned buffer as output endpoint storage.
+        @see setOutputStreamBuffer
+    */
+    virtual bool setOutputStreamBuffer (EndpointHandle h, choc::buffer::ChannelArrayView<float> buffer) noexcept         { ignoreUnused (h, buffer); return false; }
+
+    //==============================================================================
+    /** Holds per-processor-instance timing statistics gathered during calls to advance().
+        The name refers to a module in the loaded Program, so the numbers can be mapped
+        back onto the source graph. @see enableProfiling, getProfile
+    */
+    struct ProcessorProfile
+    {
+        /** The full name of the processor instance, as returned by Module::getNameWithoutRootNamespace(). */
+        std::string processorName;
+        /** Total time spent inside this processor across all profiled blocks, in seconds. */
+        double totalSeconds = 0;
+        /** The number of blocks over which totalSeconds was accumulated. */
+        uint64_t numBlocks = 0;
+    };
+
+    /** Asks the performer to start or stop accumulating per-processor timing while rendering.
+
+        Not all implementations can attribute time to individual processors - the default
+        implementation simply returns false to indicate that no profile will be available.
+        Engines that do support it should aim to keep the per-block overhead low enough
+        that profiling can be left enabled on a live audio thread.
+    */
+    virtual bool enableProfiling (bool shouldBeEnabled) noexcept    { ignoreUnused (shouldBeEnabled); return false; }
+
+    /** Returns the timing statistics accumulated since profiling was enabled or resetProfile()
+        was last called, or an empty view if profiling is unavailable or disabled.
+        This must not be called concurrently with advance().
+    */
+    virtual ArrayView<const ProcessorProfile> getProfile() noexcept  { return {}; }
+
+    /** Zeroes any accumulated profiling counters.
+        This must not be called concurrently with advance().
+    */
+    virtual void resetProfile() noexcept   {}
+
+    //==============================================================================
+    /** An estimate of the worst-case stack needed to render one processor.
+        @see getStackUsageEstimates
+    */
+    struct ProcessorStackUsage
+    {
+        /** The full name of the processor's module, as returned by Module::getNameWithoutRootNamespace(). */
+        std::string processorName;
+        /** The deepest call sequence reachable from any of the processor's functions, in bytes. */
+        uint64_t maximumStackBytes = 0;
+    };
+
+    /** Returns an estimate of the worst-case render-thread stack usage of each processor
+        in the linked program, so that an embedded host can size its stacks exactly
+        instead of guessing. Implementations can derive the numbers from
+        CallFlowGraph::calculateProcessorStackUsage(), scaled by whatever per-call
+        overhead their code generator actually incurs. The default implementation
+        returns an empty list, meaning that no estimate is available.
+    */
+    virtual std::vector<ProcessorStackUsage> getStackUsageEstimates() noexcept    { return {}; }
+
+    //==============================================================================
+    /** A snapshot of the internal state of one processor instance in a loaded program.
+        @see saveProcessorStates, restoreProcessorState
+    */
+    struct ProcessorState
+    {
+        /** The full name of the processor's module, as returned by Module::getNameWithoutRootNamespace(). */
+        std::string processorName;
+
+        /** The processor's state, in whatever packed layout the performer uses internally
+            for its state struct. A snapshot can only be restored into a processor whose
+            name and state layout both match, so this is a vehicle for migrating state
+            between two versions of a program, not a general persistence format.
+        */
+        choc::value::Value state;
+    };
+
+    /** Takes a snapshot of the state of each processor instance in the running program.
+        This must not be called concurrently with advance(). The default implementation
+        returns an empty list, meaning that the performer can't snapshot its state.
+    */
+    virtual std::vector<ProcessorState> saveProcessorStates() noexcept    { return {}; }
+
+    /** Attempts to restore a snapshot taken from another performer into the processor
+        instance with a matching name, returning false if there's no such processor or
+        if its state layout doesn't match the snapshot. This must be called after
+        linking, and must not overlap with calls to advance().
+    */
+    virtual bool restoreProcessorState (const ProcessorState& state) noexcept    { ignoreUnused (state); return false; }
+
+    //==============================================================================
+    /** The fixed header which prefixes a whole-performer state blob.
+
+        Everything after the header is engine-specific - typically the packed state
+        structs, delay lines and queued events exactly as they sit in memory - but
+        every engine writes this header first, so a blob can be validated against
+        the format version and the linked program before any of the engine-specific
+        data is interpreted.
+
+        @see saveState, restoreState
+    */
+    struct SavedStateHeader
+    {
+        /** Bumped whenever the meaning of anything after the header changes. */
+        static constexpr uint32_t currentVersion = 1;
+
+        char magic[8];            /**< Always "SOULSTAT". */
+        uint32_t version;         /**< currentVersion at the time of writing. */
+        uint32_t headerSize;      /**< sizeof (SavedStateHeader) at the time of writing. */
+        uint64_t totalSize;       /**< The size of the whole blob, header included. */
+        uint64_t programHash;     /**< An engine-chosen hash covering the linked program and its state layout. */
+
+        void initialise (uint64_t blobSize, uint64_t hashOfProgram)
+        {
+            memcpy (magic, "SOULSTAT", sizeof (magic));
+            version = currentVersion;
+            headerSize = (uint32_t) sizeof (*this);
+            totalSize = blobSize;
+            programHash = hashOfProgram;
+        }
+
+        bool isValidFor (uint64_t availableSize, uint64_t hashOfProgram) const
+        {
+            return availableSize >= sizeof (*this)
+                    && memcmp (magic, "SOULSTAT", sizeof (magic)) == 0
+                    && version == currentVersion
+                    && headerSize == sizeof (*this)
+                    && totalSize >= sizeof (*this)
+                    && totalSize <= availableSize
+                    && programHash == hashOfProgram;
+        }
+    };
+
+    /** Returns the number of bytes needed to hold a complete snapshot of the running
+        program's mutable state, or 0 if this performer can't provide one.
+        @see saveState
+    */
+    virtual uint64_t getSavedStateSize() noexcept    { return 0; }
+
+    /** Copies a complete snapshot of the running program's mutable state - its state
+        structs, delay lines and any queued event data - into the given buffer as a
+        single blob, prefixed by a SavedStateHeader.
+
+        Unlike saveProcessorStates(), which unpacks each processor into a Value, this
+        captures the state in its native memory layout, so both directions cost little
+        more than a memcpy: a session with long delay networks can be recalled instantly
+        instead of waiting for everything to re-converge from silence. The blob can only
+        be restored into a freshly linked, identical program on the same engine, which
+        restoreState() checks via the header before touching anything.
+
+        This must be called on a linked performer, with a buffer of at least
+        getSavedStateSize() bytes, and must not overlap with calls to advance().
+        The default implementation returns false, meaning that state capture
+        isn't supported.
+    */
+    virtual bool saveState (void* dest, uint64_t destSize) noexcept    { ignoreUnused (dest, destSize); return false; }
+
+    /** Restores a blob captured by saveState() into this performer, which must be
+        freshly linked with an identical program - including after migration to a
+        different process. Returns false if the blob's header doesn't match this
+        engine and program, or if state restore isn't supported. This must not
+        overlap with calls to advance().
+    */
+    virtual bool restoreState (const void* source, uint64_t sourceSize) noexcept    { ignoreUnused (source, sourceSize); return false; }
+
+    //==============================================================================
+    /** The fixed header which prefixes a machine-code snapshot stored in a LinkerCache.
+
+        An engine which JIT-compiles its programs can use the LinkerCache passed to
+        link() to persist its finished code, so that a program it has seen before
+        skips code generation entirely on its next cold start - which is usually
+        the dominant cost of link() once the HEART itself is cached.
+
+        Everything after the header is engine-specific, but it should be laid out
+        to survive being loaded at a different address by a different process:
+        position-independent code, or code accompanied by whatever relocation
+        table the engine needs to patch it after loading.
+
+        The key from createCodeSnapshotKey() covers the linked program, this
+        machine's CPU features and the engine's version, so machines with
+        different instruction sets or engine builds sharing one cache directory
+        can never load each other's code. The header's programHash is a second
+        line of defence against key collisions and truncated entries.
+
+        @see createCodeSnapshotKey, LinkerCache
+    */
+    struct CodeSnapshotHeader
+    {
+        /** Bumped whenever the meaning of anything after the header changes. */
+        static constexpr uint32_t currentVersion = 1;
+
+        char magic[8];            /**< Always "SOULCODE". */
+        uint32_t version;         /**< currentVersion at the time of writing. */
+        uint32_t headerSize;      /**< sizeof (CodeSnapshotHeader) at the time of writing. */
+        uint64_t totalSize;       /**< The size of the whole blob, header included. */
+        uint64_t programHash;     /**< An engine-chosen hash covering the linked program. */
+
+        void initialise (uint64_t blobSize, uint64_t hashOfProgram)
+        {
+            memcpy (magic, "SOULCODE", sizeof (magic));
+            version = currentVersion;
+            headerSize = (uint32_t) sizeof (*this);
+            totalSize = blobSize;
+            programHash = hashOfProgram;
+        }
+
+        bool isValidFor (uint64_t availableSize, uint64_t hashOfProgram) const
+        {
+            return availableSize >= sizeof (*this)
+                    && memcmp (magic, "SOULCODE", sizeof (magic)) == 0
+                    && version == currentVersion
+                    && headerSize == sizeof (*this)
+                    && totalSize >= sizeof (*this)
+                    && totalSize <= availableSize
+                    && programHash == hashOfProgram;
+        }
+    };
+
+    /** Builds the LinkerCache key under which an engine should store a machine-code
+        snapshot of the given program, covering the program's content, the CPU
+        features of this machine and the engine's version string.
+        @see CodeSnapshotHeader
+    */
+    static std::string createCodeSnapshotKey (const std::string& engineVersion, const Program& program)
+    {
+        HashBuilder hash;
+        hash << engineVersion << '/' << getCPUFeatureDescription() << '/' << program.getHash();
+        return "SOULCODE_" + hash.toString();
+    }
+
+    /** Picks which of a ladder of ISA-variant kernels to install on this machine,
+        as a one-time dispatch decision at link time.
+
+        An engine honouring BuildSettings::maxCodeGenISAVariants generates its hot
+        run() kernels for up to that many tiers, ordered from the architecture
+        baseline upwards, and calls this once per function (or once per program)
+        to get the index of the widest variant the running CPU can execute. The
+        answer is stable for the life of the process, so the chosen variant can
+        be patched straight into call sites or function-pointer tables, with no
+        per-block dispatch left behind.
+
+        A machine-code snapshot should store only the chosen variants: the key
+        from createCodeSnapshotKey() already covers the machine's feature set, so
+        a snapshot never needs to carry kernels for CPUs it won't run on.
+    */
+    static uint32_t chooseISAVariant (ArrayView<const CPUISATier> ascendingVariantTiers)
+    {
+        auto widestSupported = getHighestSupportedISATier();
+        uint32_t chosen = 0;
+
+        for (uint32_t i = 0; i < ascendingVariantTiers.size(); ++i)
+            if (ascendingVariantTiers[i] <= widestSupported)
+                chosen = i;
+
+        return chosen;
+    }
+
+    //==============================================================================
+    /** Returns the alignment, in bytes, that this performer guarantees for each
+        processor instance's state allocation, or 0 if it makes no guarantee.
+
+        The compiler rounds the per-voice state of processor arrays up to a
+        cache-line multiple, so a performer which also places the first voice on
+        that boundary gives every voice its own set of cache lines - the
+        prerequisite for rendering voices of the same render stage on parallel
+        threads without false sharing. A venue planning multi-threaded voice
+        rendering can check this returns at least the cache-line size before
+        splitting work across threads.
+    */
+    virtual uint64_t getStateMemoryAlignment() noexcept    { return 0; }
+
+    //==============================================================================
+    /** Supplies an allocator for the linked program's state, constant and stream
+        buffer storage, replacing the engine's default heap allocation.
+
+        On large sessions the placement of these blocks is measurable: backing
+        them with huge pages cuts TLB misses, and locking them into memory stops
+        a long-idle session from taking page faults on the render thread when it
+        wakes. Call this before link() - memory already allocated is not
+        migrated - and keep the allocator alive until after unload(). Passing
+        nullptr restores the default allocation.
+
+        Returns false if this performer doesn't support custom allocation, in
+        which case it will carry on using the regular heap.
+
+        @see ProgramMemoryAllocator, PageBackedAllocator
+    */
+    virtual bool setMemoryAllocator (ProgramMemoryAllocator* allocator) noexcept   { ignoreUnused (allocator); return false; }
+
+    //==============================================================================
+    /** Supplies a backend for offloading the rendering of data-parallel
+        processor arrays to an accelerator.
+
+        Call this before link(). During linking, an engine which supports
+        offload offers each qualifying array in the program to the backend,
+        and any bank the backend claims is rendered through it instead of on
+        the CPU. Passing nullptr keeps everything on the CPU path.
+
+        Returns false if this performer doesn't support offload, in which case
+        the whole program renders on the CPU as usual.
+
+        @see OffloadBackend, heart::Utilities::findOffloadableArrays
+    */
+    virtual bool setOffloadBackend (OffloadBackend* backend) noexcept   { ignoreUnused (backend); return false; }
+
+    //==============================================================================
+    /** Attempts to create a new performer which shares this one's loaded program.
+
+        When an implementation supports this, hosting many instances of the same
+        program stops costing a full compile per instance: the clone refers to the
+        same immutable program image and read-only constant data as its source, and
+        only mutable processor state gets allocated per instance. The clone is
+        returned in the loaded state, so the caller connects up endpoints and calls
+        link() in the usual way - an engine which shares its compiled image can make
+        that step essentially free.
+
+        This must not be called concurrently with advance(). The default
+        implementation returns nullptr, meaning that the program can't be shared and
+        the caller should build a new instance from source.
+    */
+    virtual std::unique_ptr<Performer> cloneLoadedProgram() noexcept    { return {}; }
+
+    //==============================================================================
+    /** Returns a flat descriptor table for all of this performer's endpoints.
+
+        Implementations are expected to build the table once during link() and
+        return a copy of the cached result, so that a host enumerating hundreds
+        of parameters at session-open does no per-endpoint annotation parsing.
+        This default builds the table on demand from the endpoint lists, which
+        produces the same result at the cost of doing the conversion per call.
+
+        @see EndpointDescriptorTable, buildEndpointDescriptorTable
+    */
+    virtual EndpointDescriptorTable getEndpointDescriptorTable() noexcept
+    {
+        return buildEndpointDescriptorTable (getInputEndpoints(), getOutputEndpoints());
+    }
+
+    //==============================================================================
+    /** Attempts to change the maximum block size without relinking the program.
+
+        An engine which generates its render loop for each entry in
+        getStandardBlockSizeSet() can honour any request within that set by
+        switching which variant the next advance() dispatches to, so a live
+        change of the host's buffer size costs a branch instead of a relink.
+        Note that prepare() already accepts any frame count up to
+        getBlockSize(), so this is only needed when the new buffer size exceeds
+        the size the program was linked with.
+
+        Returns true if the change took effect, after which getBlockSize()
+        reports the new maximum. The default returns false, meaning the caller
+        must either split its buffers into getBlockSize() chunks or relink with
+        a larger BuildSettings::maxBlockSize. This must not be called
+        concurrently with advance().
+    */
+    virtual bool setBlockSize (uint32_t newMaxBlockSize) noexcept   { ignoreUnused (newMaxBlockSize); return false; }
+
+    /** Returns the standard set of block sizes for which an engine supporting
+        setBlockSize() is expected to generate render-loop variants: the powers
+        of two from 32 up to the given maximum, plus the maximum itself when it
+        isn't a power of two. Keeping the set small bounds the extra code size,
+        and sticking to one shared set means hosts can predict which
+        renegotiation requests will be cheap.
+    */
+    static ArrayWithPreallocation<uint32_t, 8> getStandardBlockSizeSet (uint32_t maxBlockSize)
+    {
+        ArrayWithPreallocation<uint32_t, 8> sizes;
+
+        for (uint32_t size = 32; size <= maxBlockSize; size *= 2)
+            sizes.push_back (size);
+
+        if (sizes.empty() || sizes.back() != maxBlockSize)
+            sizes.push_back (maxBlockSize);
+
+        return sizes;
+    }
+};
+
+//==============================================================================
+/**
+    Provides the backing memory that a Performer uses for its linked program's
+    data, so that a host can control alignment, page size and residency.
+
+    Engines which support this route their big, long-lived allocations through
+    it - the mutable processor state, the read-only constant data, and the
+    stream buffers that carry audio between endpoints - while ordinary
+    short-lived compiler allocations stay on the regular heap. The purpose tag
+    lets an implementation apply different policies per category, e.g. locking
+    only the state and stream buffers that the render thread touches while
+    leaving rarely-read constants pageable.
+
+    Every block returned by allocate() must be aligned to at least 64 bytes,
+    so that the cache-line layout guarantees described on
+    Performer::getStateMemoryAlignment() hold regardless of the allocator.
+
+    @see Performer::setMemoryAllocator, PageBackedAllocator
+*/
+class ProgramMemoryAllocator
+{
+public:
+    virtual ~ProgramMemoryAllocator() {}
+
+    /** Describes what a block of memory will be used for. */
+    enum class Purpose
+    {
+        state,           /**< Mutable processor state, read and written every block. */
+        constants,       /**< Read-only tables and external data. */
+        streamBuffers    /**< The buffers carrying stream data between endpoints. */
+    };
+
+    /** Returns a block of at least the given size, aligned to at least 64 bytes,
+        or nullptr if the allocation fails.
+    */
+    virtual void* allocate (uint64_t size, Purpose) = 0;
+
+    /** Frees a block returned by allocate(). The size and purpose are the ones
+        the block was allocated with.
+    */
+    virtual void deallocate (void* address, uint64_t size, Purpose) = 0;
+};
+
+//==============================================================================
+/**
+    An experimental interface for rendering a data-parallel bank of identical
+    processors on an accelerator such as a GPU or a wide-SIMD co-kernel.
+
+    A graph which instantiates a large array of one processor - the classic
+    case being a physical model built from hundreds of identical mass-spring
+    elements - spends nearly all its render time running the same code over
+    different per-instance state, which is exactly the shape that GPUs and
+    ISPC-style wide kernels are built for.
+    heart::Utilities::findOffloadableArrays identifies the arrays which fit
+    the restricted execution model: every instance shares the graph's clock,
+    and the processor has no event endpoints, so a whole block renders with no
+    mid-block host interaction and data crosses to the accelerator exactly
+    twice per block, however large the array is.
+
+    A host installs a backend with Performer::setOffloadBackend before link().
+    During linking the engine offers each qualifying array via prepareBank();
+    a backend returns false for shapes its compiler doesn't handle, which
+    leaves that bank on the normal CPU path, so partial implementations are
+    fine. For each claimed bank the engine then calls renderBank() once per
+    block and mixes the per-instance outputs back into the graph itself.
+*/
+class OffloadBackend
+{
+public:
+    virtual ~OffloadBackend() {}
+
+    /** Describes a bank of identical processor instances that the engine is
+        offering for offload.
+    */
+    struct ProcessorBank
+    {
+        /** The fully-qualified name of the processor being instanced. */
+        const char* processorName;
+
+        /** A HEART program containing the processor and everything it depends
+            on, for the backend to compile into its own kernel form. */
+        const char* heartProgram;
+
+        /** The number of instances in the array. */
+        uint32_t arraySize;
+
+        /** The number of float channels in each input stream, in endpoint order. */
+        const uint32_t* inputChannelCounts;
+        uint32_t numInputStreams;
+
+        /** The number of float channels in each output stream, in endpoint order. */
+        const uint32_t* outputChannelCounts;
+        uint32_t numOutputStreams;
+
+        double sampleRate;
+        uint32_t maxBlockSize;
+    };
+
+    /** Offers a bank to the backend during linking. Returning true claims the
+        bank, and the backend must be ready to render it by the time link()
+        completes. Returning false leaves the bank on the CPU path.
+    */
+    virtual bool prepareBank (uint32_t bankIndex, const ProcessorBank&) = 0;
+
+    /** Renders one block for every instance of a claimed bank.
+
+        Each entry of inputStreams points to numFrames frames of interleaved
+        channel data for one input stream, and every instance receives the
+        same input block. Each entry of outputStreams points to space for
+        arraySize * numFrames frames of interleaved channel data, laid out
+        instance-major, which the backend fills with every instance's output -
+        the engine performs whatever fan-in the graph's connections call for.
+        This is called from the render thread, so it must not block on
+        anything slower than the device transfer itself.
+    */
+    virtual void renderBank (uint32_t bankIndex,
+                             const float* const* inputStreams,
+                             float* const* outputStreams,
+                             uint32_t numFrames) = 0;
+
+    /** Resets the state of every instance in all claimed banks, mirroring
+        Performer::reset(). */
+    virtual void reset() = 0;
 };
 
 //==============================================================================
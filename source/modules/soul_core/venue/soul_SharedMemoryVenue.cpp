@@ -0,0 +1,848 @@
+/*
+    _____ _____ _____ __
+   |   __|     |  |  |  |      The SOUL language
+   |__   |  |  |  |  |  |__    Copyright (c) 2019 - ROLI Ltd.
+   |_____|_____|_____|_____|
+
+   The code in this file is provided under the terms of the ISC license:
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose
+   with or without fee is hereby granted, provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#if ! SOUL_INSIDE_CORE_CPP
+ #error "Don't add this cpp file to your build, it gets included indirectly by soul_core.cpp"
+#endif
+
+#if defined (__linux__) || defined (__APPLE__)
+ #include <sys/mman.h>
+ #include <sys/wait.h>
+ #include <unistd.h>
+ #include <signal.h>
+#endif
+
+namespace soul
+{
+
+#if defined (__linux__) || defined (__APPLE__)
+
+//==============================================================================
+/** A single-reader, single-writer ring of length-prefixed messages which lives
+    entirely inside a caller-supplied block of memory.
+
+    This is the soul_FIFO.h design generalised for use across a process boundary:
+    the read and write positions are monotonic counters on separate cache lines
+    inside the shared block itself, so the two processes need nothing but the
+    mapping to communicate. There's no condition variable - a mutex can't safely
+    be shared with a process that might be killed while holding it - so a side
+    which has to wait spins briefly and then backs off to short sleeps, polling a
+    caller-supplied function so it can give up if the other process has died.
+*/
+struct SharedMemoryRing
+{
+    struct Header
+    {
+        alignas (64) std::atomic<uint64_t> readPos;
+        alignas (64) std::atomic<uint64_t> writePos;
+        alignas (64) uint32_t capacity;
+    };
+
+    static size_t getBytesNeeded (uint32_t capacity)     { return sizeof (Header) + capacity; }
+
+    /** Must be called exactly once, before the memory is shared with the other side. */
+    void initialise (void* sharedBlock, uint32_t capacity)
+    {
+        header = new (sharedBlock) Header();
+        header->readPos = 0;
+        header->writePos = 0;
+        header->capacity = capacity;
+        data = static_cast<char*> (sharedBlock) + sizeof (Header);
+    }
+
+    bool writeMessage (const void* message, uint32_t size,
+                       std::chrono::milliseconds timeout, const std::function<bool()>& shouldKeepWaiting)
+    {
+        auto total = (uint64_t) size + sizeof (uint32_t);
+
+        if (total >= header->capacity)
+            return false;
+
+        auto writePos = header->writePos.load (std::memory_order_relaxed);
+
+        if (! waitUntil ([&] { return header->capacity - (writePos - header->readPos.load (std::memory_order_acquire)) > total; },
+                         timeout, shouldKeepWaiting))
+            return false;
+
+        copyIn (writePos, std::addressof (size), sizeof (uint32_t));
+        copyIn (writePos + sizeof (uint32_t), message, size);
+        header->writePos.store (writePos + total, std::memory_order_release);
+        return true;
+    }
+
+    bool readMessage (std::vector<char>& result,
+                      std::chrono::milliseconds timeout, const std::function<bool()>& shouldKeepWaiting)
+    {
+        auto readPos = header->readPos.load (std::memory_order_relaxed);
+
+        auto isAvailable = [&] (uint64_t numBytes)
+        {
+            return header->writePos.load (std::memory_order_acquire) - readPos >= numBytes;
+        };
+
+        if (! waitUntil ([&] { return isAvailable (sizeof (uint32_t)); }, timeout, shouldKeepWaiting))
+            return false;
+
+        uint32_t size;
+        copyOut (std::addressof (size), readPos, sizeof (uint32_t));
+
+        if (! waitUntil ([&] { return isAvailable (sizeof (uint32_t) + size); }, timeout, shouldKeepWaiting))
+            return false;
+
+        result.resize (size);
+        copyOut (result.data(), readPos + sizeof (uint32_t), size);
+        header->readPos.store (readPos + sizeof (uint32_t) + size, std::memory_order_release);
+        return true;
+    }
+
+private:
+    template <typename IsReadyFn>
+    bool waitUntil (IsReadyFn&& isReady, std::chrono::milliseconds timeout, const std::function<bool()>& shouldKeepWaiting)
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+
+        for (int spins = 0;; ++spins)
+        {
+            if (isReady())
+                return true;
+
+            if (! shouldKeepWaiting() || std::chrono::steady_clock::now() > deadline)
+                return false;
+
+            if (spins < 1000)
+                std::this_thread::yield();
+            else
+                std::this_thread::sleep_for (std::chrono::microseconds (100));
+        }
+    }
+
+    void copyIn (uint64_t position, const void* source, uint32_t size)
+    {
+        auto index = (uint32_t) (position % header->capacity);
+        auto firstPart = std::min (size, header->capacity - index);
+        memcpy (data + index, source, firstPart);
+        memcpy (data, static_cast<const char*> (source) + firstPart, size - firstPart);
+    }
+
+    void copyOut (void* dest, uint64_t position, uint32_t size)
+    {
+        auto index = (uint32_t) (position % header->capacity);
+        auto firstPart = std::min (size, header->capacity - index);
+        memcpy (dest, data + index, firstPart);
+        memcpy (static_cast<char*> (dest) + firstPart, data, size - firstPart);
+    }
+
+    Header* header = nullptr;
+    char* data = nullptr;
+};
+
+//==============================================================================
+/** A Performer which runs its linked program in a sandboxed child process.
+
+    Loading and linking happen in the host process - the compiler is trusted, the
+    generated code is not - and on a successful link the process forks, so the
+    child inherits the fully linked program and no program serialisation is
+    needed. After that, each advance() ships the block's input endpoint data to
+    the child over one shared-memory ring and waits for the rendered outputs on
+    another, which adds a single in-memory round trip per block.
+
+    If the child crashes or stops responding, the render call simply times out
+    and the performer reports an error: the host process is never harmed by
+    whatever the program did.
+*/
+struct SandboxedPerformer  : public Performer
+{
+    SandboxedPerformer (std::unique_ptr<Performer> p)  : inner (std::move (p))
+    {
+        SOUL_ASSERT (inner != nullptr);
+    }
+
+    ~SandboxedPerformer() override
+    {
+        shutDownChildProcess();
+        releaseSharedMemory();
+    }
+
+    //==============================================================================
+    bool load (CompileMessageList& messages, const Program& p) noexcept override
+    {
+        shutDownChildProcess();
+        activeInputs.clear();
+        activeOutputs.clear();
+        return inner->load (messages, p);
+    }
+
+    void unload() noexcept override
+    {
+        shutDownChildProcess();
+        inner->unload();
+    }
+
+    ArrayView<const EndpointDetails> getInputEndpoints() noexcept override      { return inner->getInputEndpoints(); }
+    ArrayView<const EndpointDetails> getOutputEndpoints() noexcept override     { return inner->getOutputEndpoints(); }
+    ArrayView<const ExternalVariable> getExternalVariables() noexcept override  { return inner->getExternalVariables(); }
+
+    bool setExternalVariable (const char* name, const choc::value::ValueView& value) noexcept override
+    {
+        return inner->setExternalVariable (name, value);
+    }
+
+    ArrayView<const ExternalFunction> getExternalFunctions() noexcept override  { return inner->getExternalFunctions(); }
+
+    bool setExternalFunction (const char* name, void* functionPointer) noexcept override
+    {
+        // binding happens before link(), in the host process, so the forked
+        // child inherits the bound pointer along with the linked program
+        return inner->setExternalFunction (name, functionPointer);
+    }
+
+    EndpointHandle getEndpointHandle (const EndpointID& endpointID) noexcept override
+    {
+        auto handle = inner->getEndpointHandle (endpointID);
+
+        if (handle.isValid())
+            recordActiveEndpoint (endpointID, handle);
+
+        return handle;
+    }
+
+    bool link (CompileMessageList& messages, const BuildSettings& settings, LinkerCache* cache) noexcept override
+    {
+        if (! inner->link (messages, settings, cache))
+            return false;
+
+        return startChildProcess();
+    }
+
+    bool isLoaded() noexcept override     { return inner->isLoaded(); }
+    bool isLinked() noexcept override     { return inner->isLinked(); }
+
+    void reset() noexcept override
+    {
+        MessageBuilder message;
+        message.writeByte ((uint8_t) OpCode::reset);
+        sendToChild (message);
+    }
+
+    //==============================================================================
+    void prepare (uint32_t numFramesToBeRendered) noexcept override
+    {
+        framesToRender = numFramesToBeRendered;
+        pendingInputs.data.clear();
+        numPendingInputItems = 0;
+    }
+
+    void setNextInputStreamFrames (EndpointHandle handle, const choc::value::ValueView& frameArray) noexcept override
+    {
+        appendInputItem (InputItemType::streamFrames, handle, frameArray);
+    }
+
+    void setSparseInputStreamTarget (EndpointHandle handle, const choc::value::ValueView& targetFrameValue,
+                                     uint32_t numFramesToReachValue) noexcept override
+    {
+        if (appendInputItem (InputItemType::sparseStreamTarget, handle, targetFrameValue))
+            pendingInputs.writeInt (numFramesToReachValue);
+    }
+
+    void setInputValue (EndpointHandle handle, const choc::value::ValueView& newValue) noexcept override
+    {
+        appendInputItem (InputItemType::value, handle, newValue);
+    }
+
+    void addInputEvent (EndpointHandle handle, const choc::value::ValueView& eventData) noexcept override
+    {
+        appendInputItem (InputItemType::event, handle, eventData);
+    }
+
+    void advance() noexcept override
+    {
+        outputValues.clear();
+        outputEvents.clear();
+
+        try
+        {
+            MessageBuilder message;
+            message.writeByte ((uint8_t) OpCode::renderBlock);
+            message.writeInt (framesToRender);
+            message.writeInt (numPendingInputItems);
+            message.write (pendingInputs.data.data(), pendingInputs.data.size());
+
+            if (! sendToChild (message))
+                return;
+
+            std::vector<char> response;
+
+            if (! responseRing.readMessage (response, renderTimeout, [this] { return isChildRunning(); }))
+            {
+                declareChildDead();
+                return;
+            }
+
+            MessageReader reader (response);
+
+            for (auto numValues = reader.readInt(); numValues != 0; --numValues)
+            {
+                auto handle = reader.readInt();
+                outputValues[handle] = reader.readValue();
+            }
+
+            for (auto numEvents = reader.readInt(); numEvents != 0; --numEvents)
+            {
+                auto handle = reader.readInt();
+                auto frameOffset = reader.readInt();
+                outputEvents.push_back ({ handle, frameOffset, reader.readValue() });
+            }
+
+            lastReportedXRuns = reader.readInt();
+        }
+        catch (...)
+        {
+            declareChildDead();
+        }
+    }
+
+    choc::value::ValueView getOutputStreamFrames (EndpointHandle handle) noexcept override
+    {
+        auto found = outputValues.find (handle.getRawHandle());
+
+        if (found == outputValues.end())
+            return {};
+
+        return found->second.getView();
+    }
+
+    choc::value::ValueView getOutputValue (EndpointHandle handle) noexcept override
+    {
+        return getOutputStreamFrames (handle);
+    }
+
+    void iterateOutputEvents (EndpointHandle handle, HandleNextOutputEventFn fn) noexcept override
+    {
+        for (auto& e : outputEvents)
+            if (e.handle == handle.getRawHandle())
+                if (! fn (e.frameOffset, e.event.getView()))
+                    return;
+    }
+
+    //==============================================================================
+    bool isEndpointActive (const EndpointID& e) noexcept override    { return inner->isEndpointActive (e); }
+    uint32_t getLatency() noexcept override                          { return inner->getLatency(); }
+    uint32_t getBlockSize() noexcept override                        { return inner->getBlockSize(); }
+    uint32_t getXRuns() noexcept override                            { return lastReportedXRuns; }
+
+    //==============================================================================
+    // The state blob lives in the child, so these each cost one round trip over
+    // the rings. A blob has to fit through the ring in a single message, so
+    // anything approaching the ring capacity is reported as unsupported.
+    uint64_t getSavedStateSize() noexcept override
+    {
+        MessageBuilder message;
+        message.writeByte ((uint8_t) OpCode::getStateSize);
+
+        std::vector<char> response;
+
+        if (! exchangeWithChild (message, response))
+            return 0;
+
+        try
+        {
+            return MessageReader (response).readInt();
+        }
+        catch (...) {}
+
+        return 0;
+    }
+
+    bool saveState (void* dest, uint64_t destSize) noexcept override
+    {
+        MessageBuilder message;
+        message.writeByte ((uint8_t) OpCode::saveState);
+
+        std::vector<char> response;
+
+        if (! exchangeWithChild (message, response))
+            return false;
+
+        try
+        {
+            MessageReader reader (response);
+
+            if (reader.readByte() == 0)
+                return false;
+
+            auto size = reader.readInt();
+
+            if (size > destSize || reader.input.start + size > reader.input.end)
+                return false;
+
+            memcpy (dest, reader.input.start, size);
+            return true;
+        }
+        catch (...) {}
+
+        return false;
+    }
+
+    bool restoreState (const void* source, uint64_t sourceSize) noexcept override
+    {
+        if (sourceSize + 64 >= ringCapacity)
+            return false;
+
+        MessageBuilder message;
+        message.writeByte ((uint8_t) OpCode::restoreState);
+        message.writeInt ((uint32_t) sourceSize);
+        message.write (source, (size_t) sourceSize);
+
+        std::vector<char> response;
+
+        if (! exchangeWithChild (message, response))
+            return false;
+
+        try
+        {
+            return MessageReader (response).readByte() != 0;
+        }
+        catch (...) {}
+
+        return false;
+    }
+
+    bool hasError() noexcept override       { return childHasDied || inner->hasError(); }
+
+    const char* getError() noexcept override
+    {
+        if (childHasDied)
+            return "Sandboxed render process stopped responding";
+
+        return inner->getError();
+    }
+
+private:
+    //==============================================================================
+    enum class OpCode  : uint8_t
+    {
+        renderBlock = 1,
+        reset,
+        terminate,
+        getStateSize,
+        saveState,
+        restoreState
+    };
+
+    enum class InputItemType  : uint8_t
+    {
+        streamFrames = 1,
+        sparseStreamTarget,
+        value,
+        event
+    };
+
+    //==============================================================================
+    struct MessageBuilder
+    {
+        void write (const void* d, size_t size)   { auto p = static_cast<const char*> (d); data.insert (data.end(), p, p + size); }
+        void writeByte (uint8_t b)                { data.push_back ((char) b); }
+        void writeInt (uint32_t i)                { write (std::addressof (i), sizeof (i)); }
+        void writeValue (const choc::value::ValueView& v)   { choc::value::Value (v).serialise (*this); }
+
+        std::vector<char> data;
+    };
+
+    struct MessageReader
+    {
+        MessageReader (const std::vector<char>& message)
+            : input { reinterpret_cast<const uint8_t*> (message.data()),
+                      reinterpret_cast<const uint8_t*> (message.data() + message.size()) }
+        {
+        }
+
+        uint8_t readByte()
+        {
+            choc::value::check (input.start < input.end, "Malformed message");
+            return *input.start++;
+        }
+
+        uint32_t readInt()
+        {
+            uint32_t result;
+            choc::value::check (input.start + sizeof (result) <= input.end, "Malformed message");
+            memcpy (std::addressof (result), input.start, sizeof (result));
+            input.start += sizeof (result);
+            return result;
+        }
+
+        choc::value::Value readValue()      { return choc::value::Value::deserialise (input); }
+
+        choc::value::InputData input;
+    };
+
+    //==============================================================================
+    bool appendInputItem (InputItemType type, EndpointHandle handle, const choc::value::ValueView& value)
+    {
+        try
+        {
+            pendingInputs.writeByte ((uint8_t) type);
+            pendingInputs.writeInt (handle.getRawHandle());
+            pendingInputs.writeValue (value);
+            ++numPendingInputItems;
+            return true;
+        }
+        catch (...)
+        {
+            return false;
+        }
+    }
+
+    bool exchangeWithChild (MessageBuilder& message, std::vector<char>& response)
+    {
+        if (! sendToChild (message))
+            return false;
+
+        if (responseRing.readMessage (response, renderTimeout, [this] { return isChildRunning(); }))
+            return true;
+
+        declareChildDead();
+        return false;
+    }
+
+    bool sendToChild (MessageBuilder& message)
+    {
+        if (! isChildRunning())
+            return false;
+
+        if (commandRing.writeMessage (message.data.data(), (uint32_t) message.data.size(),
+                                      renderTimeout, [this] { return isChildRunning(); }))
+            return true;
+
+        declareChildDead();
+        return false;
+    }
+
+    void recordActiveEndpoint (const EndpointID& endpointID, EndpointHandle handle)
+    {
+        for (auto& details : inner->getInputEndpoints())
+            if (details.endpointID == endpointID)
+                { activeInputs.push_back ({ handle, isStream (details), isEvent (details) }); return; }
+
+        for (auto& details : inner->getOutputEndpoints())
+            if (details.endpointID == endpointID)
+                { activeOutputs.push_back ({ handle, isStream (details), isEvent (details) }); return; }
+    }
+
+    //==============================================================================
+    bool startChildProcess()
+    {
+        shutDownChildProcess();
+        releaseSharedMemory();
+
+        auto ringBytes = SharedMemoryRing::getBytesNeeded (ringCapacity);
+        sharedMemorySize = ringBytes * 2;
+        sharedMemory = mmap (nullptr, sharedMemorySize, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+        if (sharedMemory == MAP_FAILED)
+        {
+            sharedMemory = nullptr;
+            return false;
+        }
+
+        commandRing.initialise (sharedMemory, ringCapacity);
+        responseRing.initialise (static_cast<char*> (sharedMemory) + ringBytes, ringCapacity);
+
+        auto pid = fork();
+
+        if (pid < 0)
+        {
+            releaseSharedMemory();
+            return false;
+        }
+
+        if (pid == 0)
+        {
+            // NB: only the forking thread exists in the child, so the child must touch
+            // nothing but its inherited performer and the rings - anything else could
+            // have been left mid-operation by another of the host's threads.
+            runChildRenderLoop();
+            _exit (0);
+        }
+
+        childPid = pid;
+        childHasDied = false;
+        return true;
+    }
+
+    void shutDownChildProcess()
+    {
+        if (childPid <= 0)
+            return;
+
+        MessageBuilder message;
+        message.writeByte ((uint8_t) OpCode::terminate);
+        commandRing.writeMessage (message.data.data(), (uint32_t) message.data.size(),
+                                  std::chrono::milliseconds (500), [] { return true; });
+
+        for (int attempts = 0; attempts < 20; ++attempts)
+        {
+            if (waitpid (childPid, nullptr, WNOHANG) != 0)
+            {
+                childPid = 0;
+                return;
+            }
+
+            std::this_thread::sleep_for (std::chrono::milliseconds (10));
+        }
+
+        kill (childPid, SIGKILL);
+        waitpid (childPid, nullptr, 0);
+        childPid = 0;
+    }
+
+    void releaseSharedMemory()
+    {
+        if (sharedMemory != nullptr)
+        {
+            munmap (sharedMemory, sharedMemorySize);
+            sharedMemory = nullptr;
+        }
+    }
+
+    bool isChildRunning()
+    {
+        if (childPid <= 0 || childHasDied)
+            return false;
+
+        if (waitpid (childPid, nullptr, WNOHANG) == 0)
+            return true;
+
+        childPid = 0;
+        childHasDied = true;
+        return false;
+    }
+
+    void declareChildDead()
+    {
+        childHasDied = true;
+    }
+
+    //==============================================================================
+    void runChildRenderLoop()
+    {
+        std::vector<char> message;
+        auto parentStillAlive = [original = getppid()] { return getppid() == original; };
+
+        try
+        {
+            for (;;)
+            {
+                if (! commandRing.readMessage (message, std::chrono::hours (1), parentStillAlive))
+                    return;
+
+                MessageReader reader (message);
+
+                switch ((OpCode) reader.readByte())
+                {
+                    case OpCode::terminate:     return;
+                    case OpCode::reset:         inner->reset(); break;
+                    case OpCode::renderBlock:   renderBlockInChild (reader, parentStillAlive); break;
+                    case OpCode::getStateSize:  sendStateSizeFromChild (parentStillAlive); break;
+                    case OpCode::saveState:     saveStateInChild (parentStillAlive); break;
+                    case OpCode::restoreState:  restoreStateInChild (reader, parentStillAlive); break;
+                    default:                    return;
+                }
+            }
+        }
+        catch (...) {}
+    }
+
+    void renderBlockInChild (MessageReader& reader, const std::function<bool()>& parentStillAlive)
+    {
+        inner->prepare (reader.readInt());
+
+        for (auto numItems = reader.readInt(); numItems != 0; --numItems)
+        {
+            auto type = (InputItemType) reader.readByte();
+            auto handle = EndpointHandle::create (reader.readInt());
+            auto value = reader.readValue();
+
+            switch (type)
+            {
+                case InputItemType::streamFrames:        inner->setNextInputStreamFrames (handle, value.getView()); break;
+                case InputItemType::sparseStreamTarget:  inner->setSparseInputStreamTarget (handle, value.getView(), reader.readInt()); break;
+                case InputItemType::value:               inner->setInputValue (handle, value.getView()); break;
+                case InputItemType::event:               inner->addInputEvent (handle, value.getView()); break;
+                default:                                 break;
+            }
+        }
+
+        inner->advance();
+
+        MessageBuilder response;
+        MessageBuilder values, events;
+        uint32_t numValues = 0, numEvents = 0;
+
+        for (auto& output : activeOutputs)
+        {
+            if (output.isEventKind)
+            {
+                inner->iterateOutputEvents (output.handle, [&] (uint32_t frameOffset, const choc::value::ValueView& event) -> bool
+                {
+                    events.writeInt (output.handle.getRawHandle());
+                    events.writeInt (frameOffset);
+                    events.writeValue (event);
+                    ++numEvents;
+                    return true;
+                });
+
+                continue;
+            }
+
+            auto value = output.isStreamKind ? inner->getOutputStreamFrames (output.handle)
+                                             : inner->getOutputValue (output.handle);
+
+            if (value.getType().isVoid())
+                continue;
+
+            values.writeInt (output.handle.getRawHandle());
+            values.writeValue (value);
+            ++numValues;
+        }
+
+        response.writeInt (numValues);
+        response.write (values.data.data(), values.data.size());
+        response.writeInt (numEvents);
+        response.write (events.data.data(), events.data.size());
+        response.writeInt (inner->getXRuns());
+
+        responseRing.writeMessage (response.data.data(), (uint32_t) response.data.size(),
+                                   std::chrono::seconds (10), parentStillAlive);
+    }
+
+    uint64_t getTransportableStateSize()
+    {
+        auto size = inner->getSavedStateSize();
+
+        // the whole blob has to cross the ring in one message, with a little
+        // room left over for the protocol around it
+        if (size + 64 >= ringCapacity)
+            return 0;
+
+        return size;
+    }
+
+    void sendStateSizeFromChild (const std::function<bool()>& parentStillAlive)
+    {
+        MessageBuilder response;
+        response.writeInt ((uint32_t) getTransportableStateSize());
+        responseRing.writeMessage (response.data.data(), (uint32_t) response.data.size(),
+                                   std::chrono::seconds (10), parentStillAlive);
+    }
+
+    void saveStateInChild (const std::function<bool()>& parentStillAlive)
+    {
+        MessageBuilder response;
+        auto size = getTransportableStateSize();
+
+        if (size != 0)
+        {
+            std::vector<char> blob ((size_t) size);
+
+            if (inner->saveState (blob.data(), size))
+            {
+                response.writeByte (1);
+                response.writeInt ((uint32_t) size);
+                response.write (blob.data(), blob.size());
+            }
+        }
+
+        if (response.data.empty())
+            response.writeByte (0);
+
+        responseRing.writeMessage (response.data.data(), (uint32_t) response.data.size(),
+                                   std::chrono::seconds (10), parentStillAlive);
+    }
+
+    void restoreStateInChild (MessageReader& reader, const std::function<bool()>& parentStillAlive)
+    {
+        auto size = reader.readInt();
+        choc::value::check (reader.input.start + size <= reader.input.end, "Malformed message");
+
+        MessageBuilder response;
+        response.writeByte (inner->restoreState (reader.input.start, size) ? 1 : 0);
+        responseRing.writeMessage (response.data.data(), (uint32_t) response.data.size(),
+                                   std::chrono::seconds (10), parentStillAlive);
+    }
+
+    //==============================================================================
+    struct ActiveEndpoint
+    {
+        EndpointHandle handle;
+        bool isStreamKind = false, isEventKind = false;
+    };
+
+    struct PendingOutputEvent
+    {
+        uint32_t handle, frameOffset;
+        choc::value::Value event;
+    };
+
+    static constexpr uint32_t ringCapacity = 4 * 1024 * 1024;
+    const std::chrono::milliseconds renderTimeout { 5000 };
+
+    std::unique_ptr<Performer> inner;
+    std::vector<ActiveEndpoint> activeInputs, activeOutputs;
+
+    void* sharedMemory = nullptr;
+    size_t sharedMemorySize = 0;
+    SharedMemoryRing commandRing, responseRing;
+    pid_t childPid = 0;
+    bool childHasDied = false;
+
+    uint32_t framesToRender = 0, numPendingInputItems = 0, lastReportedXRuns = 0;
+    MessageBuilder pendingInputs;
+    std::unordered_map<uint32_t, choc::value::Value> outputValues;
+    std::vector<PendingOutputEvent> outputEvents;
+};
+
+//==============================================================================
+struct SandboxedPerformerFactory  : public PerformerFactory
+{
+    SandboxedPerformerFactory (std::unique_ptr<PerformerFactory> f)  : inner (std::move (f)) {}
+
+    std::unique_ptr<Performer> createPerformer() override
+    {
+        return std::make_unique<SandboxedPerformer> (inner->createPerformer());
+    }
+
+    std::unique_ptr<PerformerFactory> inner;
+};
+
+#endif
+
+std::unique_ptr<Venue> createSandboxedProcessVenue (std::unique_ptr<PerformerFactory> performerFactory)
+{
+   #if defined (__linux__) || defined (__APPLE__)
+    return createThreadedVenue (std::make_unique<SandboxedPerformerFactory> (std::move (performerFactory)));
+   #else
+    ignoreUnused (performerFactory);
+    return {};
+   #endif
+}
+
+} // namespace soul
@@ -22,13 +22,197 @@
  #error "Don't add this cpp file to your build, it gets included indirectly by soul_core.cpp"
 #endif
 
+#ifdef __linux__
+ #include <pthread.h>
+ #include <sched.h>
+#endif
+
 namespace soul
 {
 
+//==============================================================================
+/** The shared pool behind RenderThreadPool::create.
+
+    Scheduling is earliest-deadline-first over a single shared ready list: each
+    attached session carries the wall-clock deadline of its next block, and an
+    idle worker always takes the ready session whose deadline is soonest. One
+    shared list rather than per-worker queues gives the work-stealing behaviour
+    directly - any idle thread picks up any due session - without a stealing
+    protocol, and at block granularity the cost of the shared lock is noise
+    next to the render work it hands out.
+
+    A session renders on at most one worker at a time, and its deadline
+    advances by one block period per block rendered. A session which has
+    fallen behind re-anchors to the present instead of bursting to catch up,
+    so one overloaded session degrades itself rather than stealing every
+    core's next block from the sessions that are still on time.
+*/
+struct RenderThreadPoolImpl final  : public RenderThreadPool
+{
+    RenderThreadPoolImpl (uint32_t numThreads)
+    {
+        for (uint32_t i = 0; i < numThreads; ++i)
+            workers.emplace_back ([this] { runWorker(); });
+    }
+
+    ~RenderThreadPoolImpl() override
+    {
+        {
+            std::lock_guard<std::mutex> lock (mutex);
+            SOUL_ASSERT (clients.empty());  // sessions must detach before the pool dies
+            shuttingDown = true;
+        }
+
+        wakeUp.notify_all();
+
+        for (auto& w : workers)
+            w.join();
+    }
+
+    struct Client
+    {
+        std::function<void()> renderBlock;
+        std::chrono::steady_clock::duration period {};
+        std::chrono::steady_clock::time_point deadline;
+        std::thread::id activeThread {};
+        bool active = false, removed = false;
+
+        // set when a client removes itself from inside its own render block -
+        // that's the only case where the worker owns the erase; an external
+        // remover is parked in removeClient() and does the erase itself
+        bool selfRemoved = false;
+    };
+
+    Client* addClient (std::function<void()> renderBlock, double secondsPerBlock)
+    {
+        // a session with no usable rate still gets a sane cadence rather than
+        // an always-due deadline which would monopolise a worker
+        if (secondsPerBlock <= 0)
+            secondsPerBlock = 0.001;
+
+        auto client = std::make_unique<Client>();
+        client->renderBlock = std::move (renderBlock);
+        client->period = std::chrono::duration_cast<std::chrono::steady_clock::duration> (std::chrono::duration<double> (secondsPerBlock));
+        client->deadline = std::chrono::steady_clock::now() + client->period;
+
+        auto rawPointer = client.get();
+
+        {
+            std::lock_guard<std::mutex> lock (mutex);
+            clients.push_back (std::move (client));
+        }
+
+        wakeUp.notify_all();
+        return rawPointer;
+    }
+
+    /** Detaches a client, waiting for any block it's currently rendering to
+        finish. When a session stops itself from inside its own render block the
+        wait would deadlock, so in that case the client is just marked and the
+        worker running it drops it when the block returns.
+    */
+    void removeClient (Client* client)
+    {
+        std::unique_lock<std::mutex> lock (mutex);
+        client->removed = true;
+
+        if (client->active && client->activeThread == std::this_thread::get_id())
+        {
+            client->selfRemoved = true;
+            return;
+        }
+
+        // the worker never erases an externally-removed client, so the pointer
+        // stays valid for this predicate and the erase below is the only one
+        wakeUp.wait (lock, [&] { return ! client->active; });
+        eraseClient (client);
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<Client>> clients;
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    bool shuttingDown = false;
+
+    void eraseClient (Client* client)
+    {
+        removeIf (clients, [=] (std::unique_ptr<Client>& c) { return c.get() == client; });
+    }
+
+    void runWorker()
+    {
+        TraceLogger::prepareCurrentThread();
+        std::unique_lock<std::mutex> lock (mutex);
+
+        while (! shuttingDown)
+        {
+            Client* next = nullptr;
+
+            for (auto& c : clients)
+                if (! c->active && ! c->removed)
+                    if (next == nullptr || c->deadline < next->deadline)
+                        next = c.get();
+
+            if (next == nullptr)
+            {
+                wakeUp.wait (lock);
+                continue;
+            }
+
+            // Release time is one period ahead of the deadline - rendering any
+            // earlier would just buffer blocks ahead of the consumer
+            auto releaseTime = next->deadline - next->period;
+
+            if (releaseTime > std::chrono::steady_clock::now())
+            {
+                wakeUp.wait_until (lock, releaseTime);
+                continue;
+            }
+
+            next->active = true;
+            next->activeThread = std::this_thread::get_id();
+            lock.unlock();
+
+            next->renderBlock();
+
+            auto finishTime = std::chrono::steady_clock::now();
+            lock.lock();
+            next->active = false;
+            next->activeThread = {};
+
+            if (next->removed)
+            {
+                // only a self-initiated removal is erased here; otherwise the
+                // thread blocked in removeClient() owns the erase, and just
+                // needs the notify below to see that the block has finished
+                if (next->selfRemoved)
+                    eraseClient (next);
+            }
+            else
+            {
+                next->deadline += next->period;
+
+                if (next->deadline < finishTime)
+                    next->deadline = finishTime + next->period;
+            }
+
+            wakeUp.notify_all();
+        }
+    }
+};
+
+std::shared_ptr<RenderThreadPool> RenderThreadPool::create (uint32_t numThreads)
+{
+    return std::make_shared<RenderThreadPoolImpl> (std::max (1u, numThreads));
+}
+
 //==============================================================================
 struct ThreadedVenue  : public soul::Venue
 {
-    ThreadedVenue (std::unique_ptr<PerformerFactory> p) : performerFactory (std::move (p)) {}
+    ThreadedVenue (std::unique_ptr<PerformerFactory> p, std::shared_ptr<RenderThreadPoolImpl> pool = {})
+        : performerFactory (std::move (p)), threadPool (std::move (pool)) {}
+
     ~ThreadedVenue() override {}
 
     std::unique_ptr<Venue::Session> createSession() override
@@ -74,192 +258,238 @@ struct ThreadedVenue  : public soul::Venue
         {
             stop();
             waitForThreadToFinish();
+            stopServiceThread();
+            asyncEventSinks.clear();
+            pendingSwap.reset();
+            swapReady = false;
+            retiredPerformer.reset();
+            cpuBudget = 0;
+            overloadEndpointID = {};
+            overloadEndpointHandle = {};
+            outputSnapshots.clear();
+            inputRecorder.reset();
+            inputReplay.reset();
+            traceRing.clear();
+            traceRingNext = 0;
+            traceRingUsed = 0;
+            traceLastXRuns = 0;
+            pmuSamplingRequested = false;
+
+            {
+                std::lock_guard<std::mutex> lock (traceLock);
+                frozenTrace.clear();
+            }
+
             performer->unload();
             setState (SessionState::empty);
         }
 
-        bool start() override
+        bool setCPUBudget (float maxLoadProportion, const EndpointID& overloadEndpoint) override
         {
-            if (state != SessionState::linked)
+            if (maxLoadProportion <= 0)
+            {
+                cpuBudget = 0;
+                overloadEndpointID = {};
+                overloadEndpointHandle = {};
+                return true;
+            }
+
+            if (! containsEndpoint (performer->getInputEndpoints(), overloadEndpoint))
                 return false;
 
-            SOUL_ASSERT (performer->isLinked());
-            waitForThreadToFinish();
-            shouldStop = false;
-            loadMeasurer.reset();
-            renderThread = std::thread ([this] { run(); });
-            setState (SessionState::running);
+            overloadEndpointID = overloadEndpoint;
+            overloadEndpointHandle = performer->getEndpointHandle (overloadEndpoint);
+            cpuBudget = maxLoadProportion;
+            overloadEventsSent = 0;
+            overloadPending = false;
+            overloadHoldoffBlocks = 0;
             return true;
         }
 
-        bool isRunning() override
-        {
-            return state == SessionState::running;
-        }
-
-        void stop() override
+        bool enableOutputValueSnapshot (const EndpointID& endpointID) override
         {
-            if (isRunning())
+            for (auto& details : performer->getOutputEndpoints())
             {
-                shouldStop = true;
-
-                if (std::this_thread::get_id() != renderThread.get_id())
-                    waitForThreadToFinish();
+                if (details.endpointID == endpointID)
+                {
+                    if (isEvent (details))
+                        return false;
 
-                totalFramesRendered = 0;
+                    auto snapshot = std::make_unique<OutputSnapshot>();
+                    snapshot->endpointID = endpointID;
+                    snapshot->isStream = isStream (details);
+                    snapshot->handle = performer->getEndpointHandle (endpointID);
+                    outputSnapshots.push_back (std::move (snapshot));
+                    return true;
+                }
             }
-        }
-
-        bool connectSessionInputEndpoint (EndpointID, EndpointID) override        { return false; }
-        bool connectSessionOutputEndpoint (EndpointID, EndpointID) override       { return false; }
-
-        ArrayView<const EndpointDetails> getInputEndpoints() override   { return performer->getInputEndpoints(); }
-        ArrayView<const EndpointDetails> getOutputEndpoints() override  { return performer->getOutputEndpoints(); }
 
-        void setEndpointActive (const EndpointID& endpointID) override  { performer->getEndpointHandle (endpointID); }
-
-        void setNextInputStreamFrames (EndpointHandle handle, const choc::value::ValueView& frameArray) override
-        {
-            performer->setNextInputStreamFrames (handle, frameArray);
+            return false;
         }
 
-        void setSparseInputStreamTarget (EndpointHandle handle, const choc::value::ValueView& targetFrameValue, uint32_t numFramesToReachValue) override
+        bool readOutputValueSnapshot (const EndpointID& endpointID, choc::value::Value& result, uint64_t& sequenceNumber) override
         {
-            performer->setSparseInputStreamTarget (handle, targetFrameValue, numFramesToReachValue);
-        }
+            for (auto& snapshotPtr : outputSnapshots)
+            {
+                auto& s = *snapshotPtr;
 
-        void setInputValue (EndpointHandle handle, const choc::value::ValueView& newValue) override
-        {
-            performer->setInputValue (handle, newValue);
-        }
+                if (s.endpointID != endpointID)
+                    continue;
 
-        void addInputEvent (EndpointHandle handle, const choc::value::ValueView& eventData) override
-        {
-            performer->addInputEvent (handle, eventData);
-        }
+                // A publish takes a memcpy per block, so a couple of retries is already
+                // a pathological case - in practice the first attempt succeeds.
+                for (int attempts = 0; attempts < 4; ++attempts)
+                {
+                    auto n1 = s.sequence.load (std::memory_order_acquire);
 
-        choc::value::ValueView getOutputStreamFrames (EndpointHandle handle) override
-        {
-            return performer->getOutputStreamFrames (handle);
-        }
+                    if (n1 == 0)
+                        return false;
 
-        void iterateOutputEvents (EndpointHandle handle, Performer::HandleNextOutputEventFn fn) override
-        {
-            performer->iterateOutputEvents (handle, std::move (fn));
-        }
+                    auto& buffer = s.buffers[(n1 - 1) & 1];
+                    choc::value::Value copy (choc::value::ValueView (s.type, (void*) buffer.data(), nullptr));
+                    auto n2 = s.sequence.load (std::memory_order_acquire);
 
-        bool isEndpointActive (const EndpointID& e) override
-        {
-            return performer->isEndpointActive (e);
-        }
+                    // The copy is only clean if no publish happened while we were copying:
+                    // a single publish (n1 + 1) already means the *next* one may be
+                    // overwriting the buffer we just read before bumping the counter again,
+                    // so anything other than an unchanged sequence has to be retried.
+                    if (n2 == n1)
+                    {
+                        result = std::move (copy);
+                        sequenceNumber = n1;
+                        return true;
+                    }
+                }
 
-        bool link (CompileMessageList& messageList, const BuildSettings& settings) override
-        {
-            if (state == SessionState::loaded && performer->link (messageList, settings, {}))
-            {
-                blockSize = performer->getBlockSize();
-                setState (SessionState::linked);
-                return true;
+                return false;
             }
 
             return false;
         }
 
-        Status getStatus() override
+        bool hotSwapProgram (CompileMessageList& messageList, const Program& p, const BuildSettings& settings) override
         {
-            Status s;
-            s.state = state;
-            s.cpu = loadMeasurer.getCurrentLoad();
-            s.xruns = performer->getXRuns();
-            return s;
-        }
+            if (p.isEmpty())
+                return false;
 
-        void setStateChangeCallback (StateChangeCallbackFn f) override     { stateChangeCallback = std::move (f); }
+            retiredPerformer.reset();
 
-        uint64_t getTotalFramesRendered() const override                   { return totalFramesRendered; }
+            if (! isRunning())
+                return load (messageList, p) && link (messageList, settings);
 
-        bool setInputEndpointServiceCallback (EndpointID endpoint, EndpointServiceFn callback) override
-        {
-            if (! containsEndpoint (performer->getInputEndpoints(), endpoint))
+            auto newPerformer = venue.performerFactory->createPerformer();
+
+            if (! newPerformer->load (messageList, p))
                 return false;
 
-            inputCallbacks.push_back ({ performer->getEndpointHandle (endpoint), std::move (callback) });
-            return true;
-        }
+            // Handles can only be fetched while the new program is loaded but not yet
+            // linked, so everything the caller hooked up to the old program has to be
+            // re-activated on the new performer now.
+            for (auto& endpointID : activeEndpointIDs)
+                newPerformer->getEndpointHandle (endpointID);
 
-        bool setOutputEndpointServiceCallback (EndpointID endpoint, EndpointServiceFn callback) override
-        {
-            if (! containsEndpoint (performer->getOutputEndpoints(), endpoint))
-                return false;
+            auto swap = std::make_unique<PendingSwap>();
 
-            outputCallbacks.push_back ({ performer->getEndpointHandle (endpoint), std::move (callback) });
-            return true;
-        }
+            for (auto& c : inputCallbacks)
+                swap->inputHandles.push_back (newPerformer->getEndpointHandle (c.endpointID));
 
-    private:
-        ThreadedVenue& venue;
-        std::unique_ptr<Performer> performer;
-        std::thread renderThread;
-        CPULoadMeasurer loadMeasurer;
-        StateChangeCallbackFn stateChangeCallback;
-        std::atomic<SessionState> state { SessionState::empty };
-        std::atomic<bool> shouldStop { false };
-        std::atomic<uint64_t> totalFramesRendered { 0 };
-        uint32_t blockSize = 0;
+            for (auto& c : outputCallbacks)
+                swap->outputHandles.push_back (newPerformer->getEndpointHandle (c.endpointID));
 
-        struct EndpointCallback
-        {
-            EndpointHandle endpointHandle;
-            EndpointServiceFn callback;
-        };
+            if (overloadEndpointID.isValid())
+                swap->overloadHandle = newPerformer->getEndpointHandle (overloadEndpointID);
 
-        std::vector<EndpointCallback> inputCallbacks, outputCallbacks;
+            for (auto& s : outputSnapshots)
+                swap->snapshotHandles.push_back (newPerformer->getEndpointHandle (s->endpointID));
 
-        void waitForThreadToFinish()
-        {
-            SOUL_ASSERT (std::this_thread::get_id() != renderThread.get_id());
+            for (auto& s : asyncEventSinks)
+                swap->asyncEventHandles.push_back (newPerformer->getEndpointHandle (s->endpointID));
+
+            if (! newPerformer->link (messageList, settings, {}))
+                return false;
+
+            swap->blockSize = newPerformer->getBlockSize();
+            swap->newPerformer = std::move (newPerformer);
 
-            if (renderThread.joinable())
             {
-                renderThread.join();
-                renderThread = {};
+                std::lock_guard<std::mutex> lock (swapLock);
+                pendingSwap = std::move (swap);
+                swapReady = true;
             }
+
+            return true;
         }
 
-        void setState (SessionState newState)
+        bool start() override
         {
-            if (state != newState)
-            {
-                state = newState;
+            if (state != SessionState::linked)
+                return false;
 
-                if (stateChangeCallback != nullptr)
-                    stateChangeCallback (state);
+            SOUL_ASSERT (performer->isLinked());
+            waitForThreadToFinish();
+            shouldStop = false;
+            loadMeasurer.reset();
+
+            if (! asyncEventSinks.empty())
+            {
+                serviceThreadShouldStop = false;
+                serviceThread = std::thread ([this] { runServiceThread(); });
             }
-        }
 
-        void handleError (const std::string&)
-        {
+            if (venue.threadPool != nullptr)
+                poolClient = venue.threadPool->addClient ([this] { renderPooledBlock(); },
+                                                          secondsPerFrame * blockSize);
+            else
+                renderThread = std::thread ([this] { run(); });
+
+            setState (SessionState::running);
+            return true;
         }
 
-        void run()
+        bool renderOffline (uint64_t numFramesToRender) override
         {
+            if (state != SessionState::linked)
+                return false;
+
+            SOUL_ASSERT (performer->isLinked());
+            waitForThreadToFinish();
+            shouldStop = false;
+            loadMeasurer.reset();
+            setState (SessionState::running);
+
             try
             {
-                while (! shouldStop.load())
+                while (numFramesToRender != 0 && ! shouldStop.load())
                 {
-                    loadMeasurer.startMeasurement();
-                    performer->prepare (blockSize);
+                    if (swapReady.load())
+                    {
+                        auto framesBeforeSwap = totalFramesRendered.load();
+                        renderCrossfadeBlock();
+                        numFramesToRender -= std::min (numFramesToRender, totalFramesRendered.load() - framesBeforeSwap);
+                        continue;
+                    }
 
-                    for (auto& c : inputCallbacks)
-                        c.callback (*this, c.endpointHandle);
+                    if (inputReplay != nullptr)
+                    {
+                        if (inputReplay->nextBlock >= inputReplay->blocks.size())
+                        {
+                            inputReplay.reset();   // log exhausted - back to normal servicing
+                            continue;
+                        }
 
-                    performer->advance();
+                        auto& block = inputReplay->blocks[inputReplay->nextBlock++];
+                        auto framesThisBlock = (uint32_t) std::min ((uint64_t) block.numFrames, numFramesToRender);
 
-                    for (auto& c : outputCallbacks)
-                        c.callback (*this, c.endpointHandle);
+                        if (framesThisBlock != 0)
+                            renderReplayBlock (block, framesThisBlock);
 
-                    totalFramesRendered += blockSize;
-                    loadMeasurer.stopMeasurement();
+                        numFramesToRender -= framesThisBlock;
+                        continue;
+                    }
+
+                    auto framesThisBlock = (uint32_t) std::min ((uint64_t) blockSize, numFramesToRender);
+                    renderNextBlock (framesThisBlock);
+                    numFramesToRender -= framesThisBlock;
                 }
             }
             catch (choc::value::Error e)
@@ -272,22 +502,1301 @@ struct ThreadedVenue  : public soul::Venue
             }
 
             setState (SessionState::linked);
+            return true;
         }
-    };
 
-private:
-    std::unique_ptr<PerformerFactory> performerFactory;
-    std::vector<Session*> sessions;
+        bool setTransportPosition (uint64_t frameNumber) override
+        {
+            if (isRunning())
+                return false;
 
-    void sessionDeleted (ThreadedVenueSession* session)
-    {
-        removeIf (sessions, [=] (Session* s) { return s == session; });
-    }
-};
+            totalFramesRendered = frameNumber;
+            return true;
+        }
 
-std::unique_ptr<Venue> createThreadedVenue (std::unique_ptr<PerformerFactory> performerFactory)
-{
-    return std::make_unique<ThreadedVenue> (std::move (performerFactory));
+        bool startInputRecording() override
+        {
+            if (isRunning())
+                return false;
+
+            inputRecorder = std::make_unique<InputRecorder>();
+            inputRecorder->write (inputLogMagic, inputLogMagicSize);
+            return true;
+        }
+
+        std::vector<char> stopInputRecording() override
+        {
+            if (isRunning() || inputRecorder == nullptr)
+                return {};
+
+            auto log = std::move (inputRecorder->log);
+            inputRecorder.reset();
+            return log;
+        }
+
+        bool prepareInputReplay (ArrayView<const char> log) override
+        {
+            auto replay = parseInputLog (log);
+
+            if (replay == nullptr)
+                return false;
+
+            inputReplay = std::move (replay);
+            return true;
+        }
+
+        bool enablePerformanceCounterSampling (bool shouldBeEnabled) override
+        {
+            if (isRunning())
+                return false;
+
+            if (! shouldBeEnabled)
+            {
+                pmuSamplingRequested = false;
+                return true;
+            }
+
+            // thread-scoped counters can't follow a pooled session's blocks as
+            // they migrate between workers
+            if (venue.threadPool != nullptr)
+                return false;
+
+            if (! PerformanceCounterSet::isSupported())
+                return false;
+
+            pmuSamplingRequested = true;
+            return true;
+        }
+
+        bool enableBlockTracing (uint32_t numBlocksToKeep) override
+        {
+            if (isRunning())
+                return false;
+
+            traceRing.clear();
+            traceRing.resize (numBlocksToKeep);
+            traceRingNext = 0;
+            traceRingUsed = 0;
+            traceLastXRuns = 0;
+
+            std::lock_guard<std::mutex> lock (traceLock);
+            frozenTrace.clear();
+            return true;
+        }
+
+        std::vector<BlockTraceEntry> getDeadlineMissTrace() override
+        {
+            std::lock_guard<std::mutex> lock (traceLock);
+            return frozenTrace;
+        }
+
+        bool isRunning() override
+        {
+            return state == SessionState::running;
+        }
+
+        void stop() override
+        {
+            if (isRunning())
+            {
+                shouldStop = true;
+
+                if (poolClient != nullptr)
+                {
+                    detachFromPool();
+                    stopServiceThread();
+                    totalFramesRendered = 0;
+                    setState (SessionState::linked);
+                    return;
+                }
+
+                if (std::this_thread::get_id() != renderThread.get_id())
+                    waitForThreadToFinish();
+
+                stopServiceThread();
+                totalFramesRendered = 0;
+            }
+        }
+
+        void detachFromPool()
+        {
+            if (poolClient != nullptr)
+            {
+                venue.threadPool->removeClient (poolClient);
+                poolClient = nullptr;
+            }
+        }
+
+        /** One scheduling quantum of the shared pool: the pooled equivalent of a
+            single iteration of the dedicated thread's run() loop.
+        */
+        void renderPooledBlock()
+        {
+            if (shouldStop.load())
+                return;
+
+            try
+            {
+                RealtimeSafetyChecker::ScopedRealtimeSection realtimeSection;
+
+                if (swapReady.load())
+                    return renderCrossfadeBlock();
+
+                loadMeasurer.startMeasurement();
+                renderNextBlock (blockSize);
+                loadMeasurer.stopMeasurement();
+                checkCPUBudget();
+            }
+            catch (choc::value::Error e)
+            {
+                handleError (e.description);
+                shouldStop = true;
+                detachFromPool();
+                setState (SessionState::linked);
+            }
+            catch (...)
+            {
+                handleError ("Uncaught exception");
+                shouldStop = true;
+                detachFromPool();
+                setState (SessionState::linked);
+            }
+        }
+
+        bool connectSessionInputEndpoint (EndpointID, EndpointID) override        { return false; }
+        bool connectSessionOutputEndpoint (EndpointID, EndpointID) override       { return false; }
+
+        ArrayView<const EndpointDetails> getInputEndpoints() override   { return performer->getInputEndpoints(); }
+        ArrayView<const EndpointDetails> getOutputEndpoints() override  { return performer->getOutputEndpoints(); }
+
+        void setEndpointActive (const EndpointID& endpointID) override
+        {
+            activeEndpointIDs.push_back (endpointID);
+            performer->getEndpointHandle (endpointID);
+        }
+
+        void setNextInputStreamFrames (EndpointHandle handle, const choc::value::ValueView& frameArray) override
+        {
+            performer->setNextInputStreamFrames (handle, frameArray);
+
+            if (duplicateInputPerformer != nullptr && duplicateInputHandle.isValid())
+                duplicateInputPerformer->setNextInputStreamFrames (duplicateInputHandle, frameArray);
+
+            if (inputRecorder != nullptr)
+                recordInputEntry ('S', handle, frameArray, 0);
+
+            if (isBlockTracingEnabled())
+                ++traceChunksThisBlock;
+        }
+
+        void setSparseInputStreamTarget (EndpointHandle handle, const choc::value::ValueView& targetFrameValue, uint32_t numFramesToReachValue) override
+        {
+            performer->setSparseInputStreamTarget (handle, targetFrameValue, numFramesToReachValue);
+
+            if (duplicateInputPerformer != nullptr && duplicateInputHandle.isValid())
+                duplicateInputPerformer->setSparseInputStreamTarget (duplicateInputHandle, targetFrameValue, numFramesToReachValue);
+
+            if (inputRecorder != nullptr)
+                recordInputEntry ('T', handle, targetFrameValue, numFramesToReachValue);
+
+            if (isBlockTracingEnabled())
+                ++traceChunksThisBlock;
+        }
+
+        void setInputValue (EndpointHandle handle, const choc::value::ValueView& newValue) override
+        {
+            performer->setInputValue (handle, newValue);
+
+            if (duplicateInputPerformer != nullptr && duplicateInputHandle.isValid())
+                duplicateInputPerformer->setInputValue (duplicateInputHandle, newValue);
+
+            if (inputRecorder != nullptr)
+                recordInputEntry ('V', handle, newValue, 0);
+
+            if (isBlockTracingEnabled())
+                ++traceChunksThisBlock;
+        }
+
+        void addInputEvent (EndpointHandle handle, const choc::value::ValueView& eventData) override
+        {
+            performer->addInputEvent (handle, eventData);
+
+            if (duplicateInputPerformer != nullptr && duplicateInputHandle.isValid())
+                duplicateInputPerformer->addInputEvent (duplicateInputHandle, eventData);
+
+            if (inputRecorder != nullptr)
+                recordInputEntry ('E', handle, eventData, 0);
+
+            if (isBlockTracingEnabled())
+                ++traceEventsThisBlock;
+        }
+
+        choc::value::ValueView getOutputStreamFrames (EndpointHandle handle) override
+        {
+            return performer->getOutputStreamFrames (handle);
+        }
+
+        void iterateOutputEvents (EndpointHandle handle, Performer::HandleNextOutputEventFn fn) override
+        {
+            performer->iterateOutputEvents (handle, std::move (fn));
+        }
+
+        bool isEndpointActive (const EndpointID& e) override
+        {
+            return performer->isEndpointActive (e);
+        }
+
+        bool setRenderThreadOptions (const RenderThreadOptions& options) override
+        {
+           #ifdef __linux__
+            renderThreadOptions = options;
+            return true;
+           #else
+            ignoreUnused (options);
+            return false;
+           #endif
+        }
+
+        bool link (CompileMessageList& messageList, const BuildSettings& settings) override
+        {
+            if (state != SessionState::loaded)
+                return false;
+
+            bool linked;
+
+            if (renderThreadOptions.preferNUMALocalMemory && ! renderThreadOptions.affinity.empty())
+            {
+                // Linking allocates the program's state and constant tables, and pages are
+                // physically placed on the NUMA node of the thread which first touches
+                // them - so borrow the render thread's affinity for the duration of the
+                // link, and the memory ends up local to wherever rendering will happen.
+                ScopedThreadAffinity numaLocalLink (renderThreadOptions.affinity);
+                linked = performer->link (messageList, settings, {});
+            }
+            else
+            {
+                linked = performer->link (messageList, settings, {});
+            }
+
+            if (linked)
+            {
+                blockSize = performer->getBlockSize();
+                secondsPerFrame = settings.sampleRate > 0 ? 1.0 / settings.sampleRate : 0;
+                setState (SessionState::linked);
+                return true;
+            }
+
+            return false;
+        }
+
+        Status getStatus() override
+        {
+            Status s;
+            s.state = state;
+            s.cpu = loadMeasurer.getCurrentLoad();
+            s.xruns = performer->getXRuns();
+            s.overloadEventsSent = overloadEventsSent;
+            return s;
+        }
+
+        void setStateChangeCallback (StateChangeCallbackFn f) override     { stateChangeCallback = std::move (f); }
+
+        uint64_t getTotalFramesRendered() const override                   { return totalFramesRendered; }
+
+        bool setInputEndpointServiceCallback (EndpointID endpoint, EndpointServiceFn callback) override
+        {
+            if (! containsEndpoint (performer->getInputEndpoints(), endpoint))
+                return false;
+
+            inputCallbacks.push_back ({ performer->getEndpointHandle (endpoint), endpoint, std::move (callback) });
+            return true;
+        }
+
+        bool setOutputEndpointServiceCallback (EndpointID endpoint, EndpointServiceFn callback) override
+        {
+            if (! containsEndpoint (performer->getOutputEndpoints(), endpoint))
+                return false;
+
+            outputCallbacks.push_back ({ performer->getEndpointHandle (endpoint), endpoint, std::move (callback) });
+            return true;
+        }
+
+        bool setAsyncOutputEventCallback (const EndpointID& endpointID, AsyncEventCallbackFn callback) override
+        {
+            if (isRunning() || callback == nullptr)
+                return false;
+
+            for (auto& details : performer->getOutputEndpoints())
+            {
+                if (details.endpointID == endpointID)
+                {
+                    // The queue's slots are sized for the endpoint's one event type, so
+                    // multi-type endpoints have to stick with the synchronous callback.
+                    if (! isEvent (details) || details.dataTypes.size() != 1)
+                        return false;
+
+                    auto eventSize = details.dataTypes.front().getValueDataSize();
+
+                    if (eventSize == 0)
+                        return false;
+
+                    auto sink = std::make_unique<AsyncEventSink>();
+                    sink->endpointID = endpointID;
+                    sink->handle = performer->getEndpointHandle (endpointID);
+                    sink->callback = std::move (callback);
+                    sink->type = details.dataTypes.front();
+                    sink->eventSize = (uint32_t) eventSize;
+
+                    for (auto& slot : sink->slots)
+                        slot.data.resize (eventSize);
+
+                    asyncEventSinks.push_back (std::move (sink));
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+    private:
+        ThreadedVenue& venue;
+        std::unique_ptr<Performer> performer;
+        std::thread renderThread;
+        RenderThreadPoolImpl::Client* poolClient = nullptr;
+        CPULoadMeasurer loadMeasurer;
+        StateChangeCallbackFn stateChangeCallback;
+        std::atomic<SessionState> state { SessionState::empty };
+        std::atomic<bool> shouldStop { false };
+        std::atomic<uint64_t> totalFramesRendered { 0 };
+        uint32_t blockSize = 0;
+
+        struct EndpointCallback
+        {
+            EndpointHandle endpointHandle;
+            EndpointID endpointID;
+            EndpointServiceFn callback;
+        };
+
+        std::vector<EndpointCallback> inputCallbacks, outputCallbacks;
+        std::vector<EndpointID> activeEndpointIDs;
+
+        //==============================================================================
+        RenderThreadOptions renderThreadOptions;
+
+        /** Applies a CPU affinity to the calling thread for the lifetime of the object,
+            restoring whatever it had before. Does nothing on platforms without thread
+            placement support.
+        */
+        struct ScopedThreadAffinity
+        {
+            ScopedThreadAffinity (ArrayView<const uint32_t> cpus)
+            {
+               #ifdef __linux__
+                restoreNeeded = pthread_getaffinity_np (pthread_self(), sizeof (previousSet), &previousSet) == 0
+                                  && applyThreadAffinity (cpus);
+               #else
+                ignoreUnused (cpus);
+               #endif
+            }
+
+            ~ScopedThreadAffinity()
+            {
+               #ifdef __linux__
+                if (restoreNeeded)
+                    pthread_setaffinity_np (pthread_self(), sizeof (previousSet), &previousSet);
+               #endif
+            }
+
+           #ifdef __linux__
+            cpu_set_t previousSet;
+           #endif
+            bool restoreNeeded = false;
+        };
+
+        /** Best-effort: pins the calling thread to the given CPU indexes, quietly
+            ignoring indexes outside the machine's range.
+        */
+        static bool applyThreadAffinity (ArrayView<const uint32_t> cpus)
+        {
+            if (cpus.empty())
+                return false;
+
+           #ifdef __linux__
+            cpu_set_t set;
+            CPU_ZERO (&set);
+
+            for (auto cpu : cpus)
+                if (cpu < CPU_SETSIZE)
+                    CPU_SET (cpu, &set);
+
+            return pthread_setaffinity_np (pthread_self(), sizeof (set), &set) == 0;
+           #else
+            return false;
+           #endif
+        }
+
+        /** Best-effort: asks for a real-time policy for the calling thread, which an
+            unprivileged process may not be permitted to have.
+        */
+        static bool applyRealtimeScheduling (int priority)
+        {
+           #ifdef __linux__
+            sched_param param = {};
+            param.sched_priority = std::clamp (priority,
+                                               sched_get_priority_min (SCHED_FIFO),
+                                               sched_get_priority_max (SCHED_FIFO));
+
+            return pthread_setschedparam (pthread_self(), SCHED_FIFO, &param) == 0;
+           #else
+            ignoreUnused (priority);
+            return false;
+           #endif
+        }
+
+        //==============================================================================
+        /** A fully-built replacement program, handed from hotSwapProgram() to the render
+            thread, which adopts it at the start of its next block.
+        */
+        struct PendingSwap
+        {
+            std::unique_ptr<Performer> newPerformer;
+            std::vector<EndpointHandle> inputHandles, outputHandles, snapshotHandles, asyncEventHandles;
+            EndpointHandle overloadHandle;
+            uint32_t blockSize = 0;
+        };
+
+        std::mutex swapLock;
+        std::unique_ptr<PendingSwap> pendingSwap;
+        std::atomic<bool> swapReady { false };
+
+        // The old performer gets parked here after a swap so that its destruction
+        // happens on a caller thread rather than on the render thread.
+        std::unique_ptr<Performer> retiredPerformer;
+
+        // Non-null only while the crossfade block's input callbacks are running, so that
+        // the session input methods feed the same data to both the old and new programs.
+        Performer* duplicateInputPerformer = nullptr;
+        EndpointHandle duplicateInputHandle;
+
+        //==============================================================================
+        /** A double-buffered, sequence-locked copy of one output endpoint's latest
+            value, published by the render thread and polled wait-free by other threads.
+        */
+        struct OutputSnapshot
+        {
+            EndpointID endpointID;
+            EndpointHandle handle;
+            bool isStream = false;
+            choc::value::Type type;
+            std::vector<char> buffers[2];
+            std::atomic<uint64_t> sequence { 0 };   // odd-free seqlock: the writer bumps this once per publish
+        };
+
+        std::vector<std::unique_ptr<OutputSnapshot>> outputSnapshots;
+
+        void publishOutputSnapshots()
+        {
+            for (auto& snapshotPtr : outputSnapshots)
+            {
+                auto& s = *snapshotPtr;
+
+                if (! s.handle.isValid())
+                    continue;
+
+                auto value = s.isStream ? performer->getOutputStreamFrames (s.handle)
+                                        : performer->getOutputValue (s.handle);
+
+                auto size = value.getType().getValueDataSize();
+
+                if (size == 0)
+                    continue;
+
+                auto n = s.sequence.load (std::memory_order_relaxed);
+
+                if (n == 0)
+                {
+                    // First publish: capture the type and allocate both buffers up-front.
+                    // Neither can change while the program stays linked, so every
+                    // subsequent block is a pure memcpy.
+                    s.type = value.getType();
+                    s.buffers[0].resize (size);
+                    s.buffers[1].resize (size);
+                }
+                else if (s.buffers[0].size() != size)
+                {
+                    continue;  // the endpoint changed shape in a hot-swap - leave the snapshot frozen
+                }
+
+                memcpy (s.buffers[n & 1].data(), value.getRawData(), size);
+                s.sequence.store (n + 1, std::memory_order_release);
+            }
+        }
+
+        //==============================================================================
+        /** One output event endpoint routed to the service thread: a single-producer
+            single-consumer ring of preallocated event slots, which the render thread
+            fills wait-free and the service thread drains. @see setAsyncOutputEventCallback
+        */
+        struct AsyncEventSink
+        {
+            EndpointID endpointID;
+            EndpointHandle handle;
+            AsyncEventCallbackFn callback;
+            choc::value::Type type;
+            uint32_t eventSize = 0;
+
+            static constexpr uint32_t capacity = 256;
+
+            struct Slot
+            {
+                uint64_t frame = 0;
+                std::vector<char> data;   // preallocated to eventSize at registration
+            };
+
+            Slot slots[capacity];
+
+            // Positions only ever increase, and each is written by exactly one
+            // thread, so a full/empty check needs no CAS on either side.
+            std::atomic<uint64_t> writePos { 0 }, readPos { 0 };
+            std::atomic<uint64_t> eventsDropped { 0 };
+        };
+
+        std::vector<std::unique_ptr<AsyncEventSink>> asyncEventSinks;
+        std::thread serviceThread;
+        std::atomic<bool> serviceThreadShouldStop { false };
+
+        /** Render-thread side: moves this block's events from the performer into the
+            sinks' queues. Each event is a bounded memcpy into a preallocated slot, and
+            a full queue drops rather than waits, so this can never block the block.
+        */
+        void captureAsyncOutputEvents()
+        {
+            if (asyncEventSinks.empty())
+                return;
+
+            auto blockStartFrame = totalFramesRendered.load();
+
+            for (auto& sinkPtr : asyncEventSinks)
+            {
+                auto& sink = *sinkPtr;
+
+                performer->iterateOutputEvents (sink.handle,
+                    [&] (uint32_t frameOffset, const choc::value::ValueView& event) -> bool
+                    {
+                        auto write = sink.writePos.load (std::memory_order_relaxed);
+
+                        if (write - sink.readPos.load (std::memory_order_acquire) >= AsyncEventSink::capacity)
+                        {
+                            sink.eventsDropped.fetch_add (1, std::memory_order_relaxed);
+                            return true;
+                        }
+
+                        auto& slot = sink.slots[write % AsyncEventSink::capacity];
+                        slot.frame = blockStartFrame + frameOffset;
+                        memcpy (slot.data.data(),
+                                event.getRawData(),
+                                std::min (event.getType().getValueDataSize(), (size_t) sink.eventSize));
+                        sink.writePos.store (write + 1, std::memory_order_release);
+                        return true;
+                    });
+            }
+        }
+
+        /** Service-thread side: delivers everything currently queued to the host
+            callbacks, returning true if anything was there.
+        */
+        bool drainAsyncEventSinks()
+        {
+            bool deliveredSomething = false;
+
+            for (auto& sinkPtr : asyncEventSinks)
+            {
+                auto& sink = *sinkPtr;
+
+                for (;;)
+                {
+                    auto read = sink.readPos.load (std::memory_order_relaxed);
+
+                    if (read == sink.writePos.load (std::memory_order_acquire))
+                        break;
+
+                    auto& slot = sink.slots[read % AsyncEventSink::capacity];
+                    sink.callback (slot.frame, choc::value::ValueView (sink.type, slot.data.data(), nullptr));
+                    sink.readPos.store (read + 1, std::memory_order_release);
+                    deliveredSomething = true;
+                }
+            }
+
+            return deliveredSomething;
+        }
+
+        /** The non-realtime housekeeping loop. Polling rather than signalling keeps
+            the render side free of anything that could wake a thread - its half of
+            the handoff is two atomic loads and a store per event.
+        */
+        void runServiceThread()
+        {
+            while (! serviceThreadShouldStop.load())
+                if (! drainAsyncEventSinks())
+                    std::this_thread::sleep_for (std::chrono::milliseconds (1));
+
+            // The render thread is already done by the time the stop flag is set,
+            // so one last pass delivers anything it queued after our final look.
+            drainAsyncEventSinks();
+        }
+
+        void stopServiceThread()
+        {
+            serviceThreadShouldStop = true;
+
+            if (serviceThread.joinable())
+                serviceThread.join();
+        }
+
+        //==============================================================================
+        // The input log is an 8-byte format tag followed by a flat sequence of
+        // tagged entries:
+        //   'B'  block boundary:        uint64 framePosition, uint32 numFrames
+        //   'D'  endpoint declaration:  uint32 index, uint32 nameLength, name chars
+        //   'S'  stream frames, 'T' sparse target (with a uint32 ramp length),
+        //   'V'  value, 'E' event:      uint32 endpoint index, a serialised Value
+        // All integers are stored in the machine's native byte order - the log is a
+        // debugging capture, not an interchange format.
+        static constexpr const char* inputLogMagic = "SOULINP1";
+        static constexpr size_t inputLogMagicSize = 8;
+
+        /** Accumulates the binary log while recording is active. Only the render
+            thread appends to it, and start/stop are refused while running, so no
+            locking is needed. @see startInputRecording
+        */
+        struct InputRecorder
+        {
+            std::vector<char> log;
+            std::vector<EndpointHandle> declaredEndpoints;
+
+            void write (const void* data, size_t size)
+            {
+                auto d = static_cast<const char*> (data);
+                log.insert (log.end(), d, d + size);
+            }
+
+            template <typename IntType>
+            void writeInt (IntType n)       { write (std::addressof (n), sizeof (n)); }
+            void writeOpcode (char c)       { log.push_back (c); }
+        };
+
+        /** A parsed input log, ready for renderOffline() to feed straight to the
+            performer. @see prepareInputReplay
+        */
+        struct InputReplay
+        {
+            struct Entry
+            {
+                char opcode;
+                EndpointHandle handle;
+                uint32_t rampFrames = 0;
+                choc::value::Value value;
+            };
+
+            struct Block
+            {
+                uint64_t framePosition = 0;
+                uint32_t numFrames = 0;
+                std::vector<Entry> entries;
+            };
+
+            std::vector<Block> blocks;
+            size_t nextBlock = 0;
+        };
+
+        std::unique_ptr<InputRecorder> inputRecorder;
+        std::unique_ptr<InputReplay> inputReplay;
+
+        void recordBlockBoundary (uint32_t numFrames)
+        {
+            if (inputRecorder == nullptr)
+                return;
+
+            inputRecorder->writeOpcode ('B');
+            inputRecorder->writeInt (totalFramesRendered.load());
+            inputRecorder->writeInt (numFrames);
+        }
+
+        void recordInputEntry (char opcode, EndpointHandle handle, const choc::value::ValueView& v, uint32_t rampFrames)
+        {
+            auto& recorder = *inputRecorder;
+            uint32_t index = 0;
+
+            while (index < recorder.declaredEndpoints.size() && ! (recorder.declaredEndpoints[index] == handle))
+                ++index;
+
+            if (index == recorder.declaredEndpoints.size())
+            {
+                // First sighting: declare the endpoint's ID, so that replay can
+                // resolve a handle for it in a freshly-loaded program.
+                EndpointID endpointID;
+
+                for (auto& c : inputCallbacks)
+                    if (c.endpointHandle == handle)
+                        endpointID = c.endpointID;
+
+                if (! endpointID.isValid())
+                    return;   // not an endpoint this session is servicing
+
+                recorder.declaredEndpoints.push_back (handle);
+                recorder.writeOpcode ('D');
+                recorder.writeInt (index);
+                auto& name = endpointID.toString();
+                recorder.writeInt (static_cast<uint32_t> (name.length()));
+                recorder.write (name.data(), name.length());
+            }
+
+            recorder.writeOpcode (opcode);
+            recorder.writeInt (index);
+
+            if (opcode == 'T')
+                recorder.writeInt (rampFrames);
+
+            choc::value::Value (v).serialise (recorder);
+        }
+
+        std::unique_ptr<InputReplay> parseInputLog (ArrayView<const char> log)
+        {
+            choc::value::InputData in { reinterpret_cast<const uint8_t*> (log.data()),
+                                        reinterpret_cast<const uint8_t*> (log.data()) + log.size() };
+
+            auto readBytes = [&in] (void* dest, size_t size) -> bool
+            {
+                if (in.start + size > in.end)
+                    return false;
+
+                memcpy (dest, in.start, size);
+                in.start += size;
+                return true;
+            };
+
+            char magic[inputLogMagicSize];
+
+            if (! readBytes (magic, inputLogMagicSize) || memcmp (magic, inputLogMagic, inputLogMagicSize) != 0)
+                return {};
+
+            auto replay = std::make_unique<InputReplay>();
+            std::vector<EndpointHandle> handles;
+
+            try
+            {
+                while (in.start < in.end)
+                {
+                    char opcode;
+
+                    if (! readBytes (std::addressof (opcode), 1))
+                        return {};
+
+                    if (opcode == 'B')
+                    {
+                        InputReplay::Block b;
+
+                        if (! (readBytes (std::addressof (b.framePosition), sizeof (b.framePosition))
+                                && readBytes (std::addressof (b.numFrames), sizeof (b.numFrames))))
+                            return {};
+
+                        replay->blocks.push_back (std::move (b));
+                        continue;
+                    }
+
+                    if (opcode == 'D')
+                    {
+                        uint32_t index, nameLength;
+
+                        if (! (readBytes (std::addressof (index), sizeof (index))
+                                && readBytes (std::addressof (nameLength), sizeof (nameLength))))
+                            return {};
+
+                        std::string name (nameLength, 0);
+
+                        if (index != handles.size() || ! readBytes (name.data(), nameLength))
+                            return {};
+
+                        auto endpointID = EndpointID::create (std::move (name));
+
+                        if (! containsEndpoint (performer->getInputEndpoints(), endpointID))
+                            return {};
+
+                        handles.push_back (performer->getEndpointHandle (endpointID));
+                        continue;
+                    }
+
+                    if (! (opcode == 'S' || opcode == 'T' || opcode == 'V' || opcode == 'E'))
+                        return {};
+
+                    InputReplay::Entry e;
+                    e.opcode = opcode;
+                    uint32_t index;
+
+                    if (! readBytes (std::addressof (index), sizeof (index)) || index >= handles.size())
+                        return {};
+
+                    e.handle = handles[index];
+
+                    if (opcode == 'T' && ! readBytes (std::addressof (e.rampFrames), sizeof (e.rampFrames)))
+                        return {};
+
+                    e.value = choc::value::Value::deserialise (in);
+
+                    if (replay->blocks.empty())
+                        return {};   // traffic before the first block boundary
+
+                    replay->blocks.back().entries.push_back (std::move (e));
+                }
+            }
+            catch (choc::value::Error)
+            {
+                return {};
+            }
+
+            return replay;
+        }
+
+        /** Renders one block taking its input from a parsed log instead of from the
+            input service callbacks. @see prepareInputReplay
+        */
+        void renderReplayBlock (const InputReplay::Block& block, uint32_t framesThisBlock)
+        {
+            traceBlockStart();
+            performer->prepare (framesThisBlock);
+
+            for (auto& e : block.entries)
+            {
+                switch (e.opcode)
+                {
+                    case 'S':   performer->setNextInputStreamFrames (e.handle, e.value); break;
+                    case 'T':   performer->setSparseInputStreamTarget (e.handle, e.value, e.rampFrames); break;
+                    case 'V':   performer->setInputValue (e.handle, e.value); break;
+                    case 'E':   performer->addInputEvent (e.handle, e.value); break;
+                    default:    break;
+                }
+            }
+
+            {
+                ScopedDisableDenormals ftz (renderThreadOptions.flushDenormalsToZero);
+                performer->advance();
+            }
+
+            for (auto& c : outputCallbacks)
+                c.callback (*this, c.endpointHandle);
+
+            captureAsyncOutputEvents();
+            publishOutputSnapshots();
+            traceBlockEnd (framesThisBlock);
+            totalFramesRendered += framesThisBlock;
+        }
+
+        //==============================================================================
+        // Flight recorder: a ring of the last few blocks' timings and input traffic,
+        // snapshotted whenever a block misses its deadline. @see enableBlockTracing
+        std::vector<BlockTraceEntry> traceRing;
+        size_t traceRingNext = 0, traceRingUsed = 0;
+        uint32_t traceChunksThisBlock = 0, traceEventsThisBlock = 0;
+        uint32_t traceLastXRuns = 0;
+        double secondsPerFrame = 0;
+        std::chrono::high_resolution_clock::time_point traceBlockStartTime;
+
+        // Registered at session construction so the render thread never has to
+        const uint32_t renderBlockTraceEventType = TraceLogger::registerEventType ("render_block");
+        const uint32_t pmuCyclesTraceEventType   = TraceLogger::registerEventType ("render_block_pmu_cycles_instructions");
+        const uint32_t pmuCacheTraceEventType    = TraceLogger::registerEventType ("render_block_pmu_l1d_llc_misses");
+        const uint32_t pmuBranchTraceEventType   = TraceLogger::registerEventType ("render_block_pmu_branch_mispredicts");
+
+        // Opt-in PMU sampling around each block. @see enablePerformanceCounterSampling
+        bool pmuSamplingRequested = false;
+        PerformanceCounterSet pmuCounters;
+
+        // Held by readers of the frozen trace, and taken by the render thread only
+        // in a block where a miss was detected - by which point the glitch has
+        // already happened, so a short wait here can't cause one.
+        std::mutex traceLock;
+        std::vector<BlockTraceEntry> frozenTrace;
+
+        bool isBlockTracingEnabled() const      { return ! traceRing.empty(); }
+
+        void traceBlockStart()
+        {
+            if (! isBlockTracingEnabled())
+                return;
+
+            traceBlockStartTime = std::chrono::high_resolution_clock::now();
+            traceChunksThisBlock = 0;
+            traceEventsThisBlock = 0;
+        }
+
+        void traceBlockEnd (uint32_t numFrames)
+        {
+            if (! isBlockTracingEnabled())
+                return;
+
+            auto toNanos = [] (std::chrono::high_resolution_clock::time_point t)
+            {
+                return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds> (t.time_since_epoch()).count();
+            };
+
+            BlockTraceEntry entry;
+            entry.framePosition = totalFramesRendered.load();
+            entry.startTimeTicks = toNanos (traceBlockStartTime);
+            entry.endTimeTicks = toNanos (std::chrono::high_resolution_clock::now());
+            entry.numFrames = numFrames;
+            entry.numInputChunks = traceChunksThisBlock;
+            entry.numEvents = traceEventsThisBlock;
+
+            auto elapsedSeconds = (double) (entry.endTimeTicks - entry.startTimeTicks) * 1.0e-9;
+            auto missed = secondsPerFrame > 0 && elapsedSeconds > numFrames * secondsPerFrame;
+            auto xruns = performer->getXRuns();
+
+            if (xruns != traceLastXRuns)
+            {
+                traceLastXRuns = xruns;
+                missed = true;
+            }
+
+            entry.deadlineMissed = missed;
+
+            traceRing[traceRingNext] = entry;
+            traceRingNext = (traceRingNext + 1) % traceRing.size();
+            traceRingUsed = std::min (traceRingUsed + 1, traceRing.size());
+
+            if (missed)
+                freezeTrace();
+        }
+
+        void freezeTrace()
+        {
+            std::lock_guard<std::mutex> lock (traceLock);
+            frozenTrace.clear();
+            frozenTrace.reserve (traceRingUsed);
+
+            auto oldest = (traceRingNext + traceRing.size() - traceRingUsed) % traceRing.size();
+
+            for (size_t i = 0; i < traceRingUsed; ++i)
+                frozenTrace.push_back (traceRing[(oldest + i) % traceRing.size()]);
+        }
+
+        //==============================================================================
+        float cpuBudget = 0;
+        EndpointID overloadEndpointID;
+        EndpointHandle overloadEndpointHandle;
+        std::atomic<uint32_t> overloadEventsSent { 0 };
+        bool overloadPending = false;
+        uint32_t overloadHoldoffBlocks = 0;
+
+        void checkCPUBudget()
+        {
+            if (cpuBudget <= 0 || ! overloadEndpointHandle.isValid())
+                return;
+
+            if (overloadHoldoffBlocks != 0)
+            {
+                --overloadHoldoffBlocks;
+                return;
+            }
+
+            if (loadMeasurer.getCurrentLoad() > cpuBudget)
+                overloadPending = true;
+        }
+
+        void deliverOverloadEvent()
+        {
+            performer->addInputEvent (overloadEndpointHandle, choc::value::createFloat32 (loadMeasurer.getCurrentLoad()));
+            ++overloadEventsSent;
+            overloadPending = false;
+
+            // Give the program a few blocks to act on the event (and the load figure
+            // time to settle) before considering sending another one.
+            overloadHoldoffBlocks = 16;
+        }
+
+        void waitForThreadToFinish()
+        {
+            SOUL_ASSERT (std::this_thread::get_id() != renderThread.get_id());
+
+            if (renderThread.joinable())
+            {
+                renderThread.join();
+                renderThread = {};
+            }
+        }
+
+        void setState (SessionState newState)
+        {
+            if (state != newState)
+            {
+                state = newState;
+
+                if (stateChangeCallback != nullptr)
+                    stateChangeCallback (state);
+            }
+        }
+
+        void handleError (const std::string&)
+        {
+        }
+
+        //==============================================================================
+        /** Renders one block through both the outgoing and incoming programs, fading the
+            output streams between them, then adopts the new program for subsequent blocks.
+        */
+        void renderCrossfadeBlock()
+        {
+            std::unique_ptr<PendingSwap> swap;
+
+            {
+                std::lock_guard<std::mutex> lock (swapLock);
+                swap = std::move (pendingSwap);
+                swapReady = false;
+            }
+
+            if (swap == nullptr)
+                return;
+
+            auto& newPerformer = *swap->newPerformer;
+
+            // Carry over the state of any processors which survived the edit unchanged,
+            // so things like delay lines and envelopes don't audibly reset.
+            for (auto& processorState : performer->saveProcessorStates())
+                newPerformer.restoreProcessorState (processorState);
+
+            loadMeasurer.startMeasurement();
+
+            auto fadeFrames = std::min (blockSize, swap->blockSize);
+
+            traceBlockStart();
+            recordBlockBoundary (fadeFrames);
+            performer->prepare (fadeFrames);
+            newPerformer.prepare (fadeFrames);
+
+            for (size_t i = 0; i < inputCallbacks.size(); ++i)
+            {
+                duplicateInputHandle = swap->inputHandles[i];
+                duplicateInputPerformer = std::addressof (newPerformer);
+                inputCallbacks[i].callback (*this, inputCallbacks[i].endpointHandle);
+            }
+
+            duplicateInputPerformer = nullptr;
+
+            {
+                ScopedDisableDenormals ftz (renderThreadOptions.flushDenormalsToZero);
+                performer->advance();
+                newPerformer.advance();
+            }
+
+            for (size_t i = 0; i < outputCallbacks.size(); ++i)
+                crossfadeOutputStreams (performer->getOutputStreamFrames (outputCallbacks[i].endpointHandle),
+                                        newPerformer.getOutputStreamFrames (swap->outputHandles[i]));
+
+            retiredPerformer = std::move (performer);
+            performer = std::move (swap->newPerformer);
+            blockSize = swap->blockSize;
+
+            for (size_t i = 0; i < inputCallbacks.size(); ++i)
+                inputCallbacks[i].endpointHandle = swap->inputHandles[i];
+
+            for (size_t i = 0; i < outputCallbacks.size(); ++i)
+                outputCallbacks[i].endpointHandle = swap->outputHandles[i];
+
+            if (overloadEndpointID.isValid())
+                overloadEndpointHandle = swap->overloadHandle;
+
+            for (size_t i = 0; i < outputSnapshots.size(); ++i)
+                outputSnapshots[i]->handle = swap->snapshotHandles[i];
+
+            for (size_t i = 0; i < asyncEventSinks.size(); ++i)
+                asyncEventSinks[i]->handle = swap->asyncEventHandles[i];
+
+            // The output callbacks read the faded frames, which were blended in place
+            // into the new performer's buffers.
+            for (auto& c : outputCallbacks)
+                c.callback (*this, c.endpointHandle);
+
+            captureAsyncOutputEvents();
+            publishOutputSnapshots();
+
+            // The xrun counter starts from scratch in the adopted performer, so resync
+            // before the end-of-block check to avoid reporting a phantom miss.
+            traceLastXRuns = performer->getXRuns();
+            traceBlockEnd (fadeFrames);
+
+            totalFramesRendered += fadeFrames;
+            loadMeasurer.stopMeasurement();
+        }
+
+        /** Blends the last rendered block of an old output stream into the corresponding
+            buffer of the new one, with a linear ramp across the block. Streams whose
+            types don't match up are left holding the new program's output, which fades
+            them in from silence-at-worst rather than producing a discontinuity spike.
+        */
+        static void crossfadeOutputStreams (choc::value::ValueView oldFrames, choc::value::ValueView newFrames)
+        {
+            auto& type = newFrames.getType();
+            auto& oldType = oldFrames.getType();
+
+            if (! (type.isArray() && oldType.isArray()
+                    && type.getNumElements() == oldType.getNumElements()
+                    && type.getValueDataSize() == oldType.getValueDataSize()))
+                return;
+
+            auto numFrames = type.getNumElements();
+
+            if (numFrames == 0)
+                return;
+
+            auto elementType = type.getElementType();
+
+            if (elementType.isVector())
+                elementType = elementType.getElementType();
+
+            if (elementType.isFloat32())
+                crossfadeChannelData (static_cast<const float*> (oldFrames.getRawData()),
+                                      static_cast<float*> (newFrames.getRawData()),
+                                      numFrames, (uint32_t) (type.getValueDataSize() / (sizeof (float) * numFrames)));
+            else if (elementType.isFloat64())
+                crossfadeChannelData (static_cast<const double*> (oldFrames.getRawData()),
+                                      static_cast<double*> (newFrames.getRawData()),
+                                      numFrames, (uint32_t) (type.getValueDataSize() / (sizeof (double) * numFrames)));
+        }
+
+        template <typename SampleType>
+        static void crossfadeChannelData (const SampleType* oldData, SampleType* newData,
+                                          uint32_t numFrames, uint32_t samplesPerFrame)
+        {
+            for (uint32_t frame = 0; frame < numFrames; ++frame)
+            {
+                auto gain = (SampleType) (frame + 1) / (SampleType) numFrames;
+
+                for (uint32_t i = 0; i < samplesPerFrame; ++i, ++oldData, ++newData)
+                    *newData = *oldData + gain * (*newData - *oldData);
+            }
+        }
+
+        /** Renders one block, driving the same callbacks regardless of whether the
+            realtime loop or an offline render is doing the driving.
+        */
+        void renderNextBlock (uint32_t framesThisBlock)
+        {
+            auto blockStartTime = std::chrono::high_resolution_clock::now();
+
+            if (pmuCounters.isOpen())
+                pmuCounters.begin();
+
+            traceBlockStart();
+            recordBlockBoundary (framesThisBlock);
+            performer->prepare (framesThisBlock);
+
+            if (overloadPending)
+                deliverOverloadEvent();
+
+            for (auto& c : inputCallbacks)
+                c.callback (*this, c.endpointHandle);
+
+            {
+                ScopedDisableDenormals ftz (renderThreadOptions.flushDenormalsToZero);
+                performer->advance();
+            }
+
+            for (auto& c : outputCallbacks)
+                c.callback (*this, c.endpointHandle);
+
+            captureAsyncOutputEvents();
+            publishOutputSnapshots();
+            traceBlockEnd (framesThisBlock);
+            totalFramesRendered += framesThisBlock;
+
+            // One structured record per block keeps timing telemetry available in
+            // production builds without the string-based logger near this thread
+            SOUL_TRACE (renderBlockTraceEventType,
+                        (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>
+                            (std::chrono::high_resolution_clock::now() - blockStartTime).count(),
+                        framesThisBlock);
+
+            if (pmuCounters.isOpen())
+            {
+                // These land next to the render_block record for the same block,
+                // which is what lets a consumer line counts up with timings
+                auto counts = pmuCounters.end();
+                SOUL_TRACE (pmuCyclesTraceEventType, counts.cycles, counts.instructions);
+                SOUL_TRACE (pmuCacheTraceEventType, counts.l1dCacheMisses, counts.lastLevelCacheMisses);
+                SOUL_TRACE (pmuBranchTraceEventType, counts.branchMispredicts, framesThisBlock);
+            }
+        }
+
+        void run()
+        {
+            applyThreadAffinity (renderThreadOptions.affinity);
+
+            if (renderThreadOptions.useRealtimeScheduling)
+                applyRealtimeScheduling (renderThreadOptions.realtimePriority);
+
+            // Registers this thread's trace ring now, so that the first traced
+            // block doesn't hit the one-off locking path inside emit()
+            TraceLogger::prepareCurrentThread();
+
+            // The counters are scoped to the thread that opens them, which is
+            // why this has to happen here rather than when sampling is enabled
+            if (pmuSamplingRequested)
+                pmuCounters.open();
+
+            try
+            {
+                while (! shouldStop.load())
+                {
+                    // Anything that happens while a block is rendered - including the
+                    // endpoint callbacks into the host - counts as the render path
+                    RealtimeSafetyChecker::ScopedRealtimeSection realtimeSection;
+
+                    if (swapReady.load())
+                    {
+                        renderCrossfadeBlock();
+                        continue;
+                    }
+
+                    loadMeasurer.startMeasurement();
+                    renderNextBlock (blockSize);
+                    loadMeasurer.stopMeasurement();
+                    checkCPUBudget();
+                }
+            }
+            catch (choc::value::Error e)
+            {
+                handleError (e.description);
+            }
+            catch (...)
+            {
+                handleError ("Uncaught exception");
+            }
+
+            pmuCounters.close();
+            setState (SessionState::linked);
+        }
+    };
+
+private:
+    std::unique_ptr<PerformerFactory> performerFactory;
+    std::shared_ptr<RenderThreadPoolImpl> threadPool;
+    std::vector<Session*> sessions;
+
+    void sessionDeleted (ThreadedVenueSession* session)
+    {
+        removeIf (sessions, [=] (Session* s) { return s == session; });
+    }
+};
+
+std::unique_ptr<Venue> createThreadedVenue (std::unique_ptr<PerformerFactory> performerFactory)
+{
+    return std::make_unique<ThreadedVenue> (std::move (performerFactory));
+}
+
+std::unique_ptr<Venue> createThreadedVenue (std::unique_ptr<PerformerFactory> performerFactory,
+                                            std::shared_ptr<RenderThreadPool> pool)
+{
+    return std::make_unique<ThreadedVenue> (std::move (performerFactory),
+                                            std::static_pointer_cast<RenderThreadPoolImpl> (std::move (pool)));
 }
 
 } // namespace soul
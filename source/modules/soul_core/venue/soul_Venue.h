@@ -70,6 +70,214 @@ public:
         */
         virtual bool link (CompileMessageList&, const BuildSettings&) = 0;
 
+        /** Replaces the running program with a newly-compiled one without stopping playback.
+
+            The new program is loaded and linked before the running one is touched, so all
+            the compilation cost stays off the audio thread. The venue then migrates the
+            state of any processors whose name and state layout are unchanged (see
+            Performer::saveProcessorStates()) and crossfades the output streams from the
+            old program to the new one over a single render block, letting a live-coding
+            workflow iterate with no audible gap.
+
+            Endpoints which were activated or given service callbacks keep working across
+            the swap, as long as the new program declares endpoints with the same IDs.
+            If the session isn't currently running, this just behaves like load() followed
+            by link(). Returns false - leaving the old program playing - if compilation
+            fails, or if the venue doesn't support hot-swapping, which is what the default
+            implementation does.
+        */
+        virtual bool hotSwapProgram (CompileMessageList&, const Program&, const BuildSettings&)    { return false; }
+
+        /** Asks the venue to enforce a CPU budget for this session.
+
+            When the proportion of available render time which the program is consuming
+            (the same figure reported by getStatus().cpu) rises above maxLoadProportion,
+            the venue posts an event carrying the measured load as a float32 to the given
+            input endpoint at the start of the next block, giving the program a chance to
+            shed work - typically by killing its quietest voices - instead of glitching.
+            After posting an event the venue waits a few blocks for the program to react
+            before re-arming, and getStatus().overloadEventsSent reports how many events
+            have been delivered.
+
+            This must be called after load() and before link(), because it has to attach
+            to the endpoint. Passing a load proportion of zero disables enforcement.
+            Returns false if the endpoint doesn't exist, or if the venue doesn't support
+            budget enforcement, which is what the default implementation does.
+        */
+        virtual bool setCPUBudget (float, const EndpointID&)    { return false; }
+
+        /** Asks the venue to publish an output endpoint's latest value in a wait-free
+            snapshot that can be polled from another thread.
+
+            This suits high-rate metering outputs, where marshalling every block through
+            an output service callback costs more than the values are worth: instead the
+            render thread memcpys the endpoint's latest block or value into one half of a
+            double buffer and bumps a sequence counter, and a UI thread reads it at its
+            own rate with readOutputValueSnapshot() without ever blocking the audio.
+
+            This must be called after load() and before link(), because it has to attach
+            to the endpoint. Only stream and value outputs can be snapshotted - events
+            are transient, so they still need a callback. Returns false if the endpoint
+            is unsuitable or doesn't exist, or if the venue doesn't support snapshots,
+            which is what the default implementation does.
+        */
+        virtual bool enableOutputValueSnapshot (const EndpointID&)    { return false; }
+
+        /** Copies the most recently published value of a snapshotted output endpoint.
+
+            This can be called from any thread at any rate. The sequence number increases
+            with each block the render thread publishes, so a poller can skip work when
+            the value hasn't changed since it last looked. Returns false if the endpoint
+            wasn't registered with enableOutputValueSnapshot() or nothing has been
+            published yet.
+        */
+        virtual bool readOutputValueSnapshot (const EndpointID&, choc::value::Value&, uint64_t& sequenceNumber)    { ignoreUnused (sequenceNumber); return false; }
+
+        /** A callback delivering one queued output event on the venue's service thread.
+
+            The frame number is the absolute transport position at which the event was
+            emitted, and the view is only valid for the duration of the call.
+        */
+        using AsyncEventCallbackFn = std::function<void (uint64_t frame, const choc::value::ValueView& event)>;
+
+        /** Routes an output event endpoint's traffic to a dedicated non-realtime
+            service thread instead of the render thread.
+
+            An event callback attached with setOutputEndpointServiceCallback() runs on
+            the render thread between blocks, so a slow consumer adds its cost straight
+            to the audio path. With this, the render thread only copies each event into
+            a preallocated wait-free queue - a bounded memcpy, with no host code on the
+            hot path - and the venue's service thread invokes the callback with the
+            buffered events at its leisure. If the consumer falls so far behind that
+            the queue fills, newer events are dropped rather than ever stalling the
+            render thread.
+
+            This must be called after load() and before link(), because it has to
+            attach to the endpoint. The endpoint must be an event output with a single
+            data type, so that the queue's slots can be sized up-front. Returns false
+            if the endpoint is unsuitable or doesn't exist, or if the venue has no
+            service thread, which is what the default implementation does.
+        */
+        virtual bool setAsyncOutputEventCallback (const EndpointID&, AsyncEventCallbackFn)    { return false; }
+
+        /** Controls how the venue schedules its render thread and where the linked
+            program's memory ends up on a multi-socket machine.
+            @see setRenderThreadOptions
+        */
+        struct RenderThreadOptions
+        {
+            /** The CPU indexes the render thread may run on. Leaving this empty keeps
+                the system's default affinity. Pinning to cores on a single socket also
+                keeps the program's working set in that socket's caches.
+            */
+            std::vector<uint32_t> affinity;
+
+            /** If true, the venue asks for a real-time scheduling policy (SCHED_FIFO
+                on POSIX systems) for the render thread. This is a best-effort request:
+                the OS may refuse it for an unprivileged process, in which case the
+                thread just keeps the default policy.
+            */
+            bool useRealtimeScheduling = false;
+
+            /** The priority to request when useRealtimeScheduling is set, in the
+                range the chosen policy supports.
+            */
+            int realtimePriority = 70;
+
+            /** If true (and an affinity is given), the venue also applies the affinity
+                to the thread which calls link(), so that the program's state and
+                constant tables are first-touched - and therefore allocated - on the
+                NUMA node that the render thread will run on.
+            */
+            bool preferNUMALocalMemory = false;
+
+            /** If true, the render thread sets the CPU's flush-to-zero and
+                denormals-are-zero flags around each advance(), restoring the previous
+                mode before calling back into the host. Decaying feedback loops
+                otherwise drop into subnormal range, where arithmetic can cost many
+                times its normal price. This changes numerics - subnormal values
+                become zero - which is why it's an option, but flushing is the norm
+                for audio work, so it defaults to on. On platforms with no FTZ
+                control register the flag has no effect.
+            */
+            bool flushDenormalsToZero = true;
+        };
+
+        /** Sets scheduling and placement options for the venue's render thread.
+
+            This must be called before link() for preferNUMALocalMemory to have any
+            effect, and before start() for the affinity and policy to apply to the
+            next run. Returns false if the venue or platform doesn't support thread
+            placement, which is what the default implementation does.
+        */
+        virtual bool setRenderThreadOptions (const RenderThreadOptions&)    { return false; }
+
+        /** Renders a fixed number of frames as fast as the machine allows, instead of
+            at the pace of a realtime clock.
+
+            This drives exactly the same machinery as realtime playback - the endpoint
+            service callbacks, output snapshots and hot-swapping all work as normal -
+            but synchronously on the calling thread, so it blocks until the requested
+            frames have been rendered or stop() is called from elsewhere. The frame
+            counter carries on from the current transport position, so a long bounce
+            can be rendered in separate calls, and a host wanting to use several cores
+            can run independent sessions offline on different threads.
+
+            Returns false if no program is linked, if the session is already running,
+            or if the venue doesn't support offline rendering, which is what the
+            default implementation does.
+        */
+        virtual bool renderOffline (uint64_t)    { return false; }
+
+        /** Starts recording all traffic arriving at the program's input endpoints.
+
+            Every stream block, sparse-stream target, value change and event which
+            is fed to an input endpoint is appended to a compact in-memory binary
+            log, along with the frame position and size of the block it arrived in.
+            Capture a live session with this, then hand the log to
+            prepareInputReplay() to re-render the same session offline - bit-exactly,
+            since the replay reproduces the original block boundaries - so engine
+            changes can be A/B tested against real sessions instead of synthetic input.
+
+            The log grows without bound while recording, and appending to it can
+            allocate on the render thread, so this is a profiling and debugging tool
+            rather than something to leave enabled in production. Recording can only
+            be started and stopped while the session isn't running. Returns false if
+            it is, or if the venue doesn't support recording, which is what the
+            default implementation does.
+        */
+        virtual bool startInputRecording()    { return false; }
+
+        /** Stops recording and returns the log which was captured.
+            Returns an empty log if startInputRecording() wasn't called, or if
+            nothing has been recorded. @see startInputRecording
+        */
+        virtual std::vector<char> stopInputRecording()    { return {}; }
+
+        /** Arms a log captured by startInputRecording() for offline replay.
+
+            This must be called after load() and before link(), because it has to
+            attach to the endpoints named in the log. Once armed, renderOffline()
+            takes its input from the log instead of from the input endpoint service
+            callbacks, feeding each recorded block's traffic to the same endpoints
+            with the original block sizes, and falls back to normal servicing when
+            the log runs out. Returns false if the log is malformed or names an
+            endpoint the loaded program doesn't have, or if the venue doesn't
+            support replay, which is what the default implementation does.
+        */
+        virtual bool prepareInputReplay (ArrayView<const char>)    { return false; }
+
+        /** Moves the session's transport to a given frame position.
+
+            The position is what getTotalFramesRendered() reports and what subsequent
+            rendering continues from, which lets an offline render start part-way
+            through a timeline with frame accuracy. The transport can only be moved
+            while the session isn't running. Returns false if it is, or if the venue
+            doesn't support repositioning, which is what the default implementation
+            does.
+        */
+        virtual bool setTransportPosition (uint64_t)    { return false; }
+
         /** Instructs the venue to begin playback.
             If no program is linked, this will fail and return false.
         */
@@ -142,6 +350,65 @@ public:
         */
         virtual bool isEndpointActive (const EndpointID&) = 0;
 
+        /** One block's worth of flight-recorder data. @see enableBlockTracing */
+        struct BlockTraceEntry
+        {
+            uint64_t framePosition;    /**< The transport position at the start of the block. */
+            uint64_t startTimeTicks;   /**< When rendering of the block began, in nanoseconds on an arbitrary monotonic clock. */
+            uint64_t endTimeTicks;     /**< When rendering of the block finished. */
+            uint32_t numFrames;        /**< The number of frames the block rendered. */
+            uint32_t numInputChunks;   /**< How many stream chunks, sparse targets and value changes arrived during the block. */
+            uint32_t numEvents;        /**< How many input events arrived during the block. */
+            bool deadlineMissed;       /**< True if this block overran its deadline or the performer reported a new xrun. */
+        };
+
+        /** Asks the venue to keep a flight-recorder trace of the last few blocks.
+
+            The render thread records each block's start and end times, frame count
+            and input traffic into a fixed-size ring of the given length. When a
+            block misses its deadline - it took longer to render than its frames
+            were worth at the session's sample rate, or the performer reported a
+            new xrun - a snapshot of the ring is frozen for getDeadlineMissTrace(),
+            giving a view of what the engine was doing in the run-up to each glitch
+            rather than just a counter.
+
+            Tracing costs two clock reads and a few stores per block. Passing zero
+            disables it. Tracing can only be reconfigured while the session isn't
+            running. Returns false if it is, or if the venue doesn't support
+            tracing, which is what the default implementation does.
+        */
+        virtual bool enableBlockTracing (uint32_t)    { return false; }
+
+        /** Returns the trace captured around the most recent deadline miss, oldest
+            block first, or an empty vector if tracing isn't enabled or no miss has
+            happened yet. The last entry is the block which missed.
+            @see enableBlockTracing
+        */
+        virtual std::vector<BlockTraceEntry> getDeadlineMissTrace()    { return {}; }
+
+        /** Asks the venue to sample hardware performance counters around each
+            rendered block.
+
+            Wall-clock timings can't tell a memory-bound processor from a
+            compute-bound one; cycles, retired instructions, cache misses and
+            branch mispredicts can. When enabled, the render thread opens a
+            thread-scoped PerformanceCounterSet and emits each block's deltas
+            into the structured trace ring as the "render_block_pmu_*" event
+            types, lining up record-for-record with the "render_block" timing
+            events - and, combined with the per-processor times from the
+            performer's profiling surface, the block-level counts can be
+            apportioned across processors after the fact.
+
+            Call this before start(). Returns false if the platform exposes no
+            usable PMU, if the session renders on a shared thread pool (the
+            counters are thread-scoped, and a pooled session's blocks migrate
+            between workers), or if the venue doesn't support sampling at all,
+            which is what the default implementation does.
+
+            @see PerformanceCounterSet, TraceLogger
+        */
+        virtual bool enablePerformanceCounterSampling (bool)    { return false; }
+
         /** Contains various indicators of what the venue is currently doing.
             @see getStatus
         */
@@ -152,6 +419,7 @@ public:
             uint32_t xruns;
             double sampleRate;
             uint32_t blockSize;
+            uint32_t overloadEventsSent;   /**< The number of overload events delivered since setCPUBudget() was called. */
         };
 
         /** Returns the venue's current status. */
@@ -196,5 +464,52 @@ public:
 /// Create a standard threaded venue where a separate render thread renders the performer
 std::unique_ptr<Venue> createThreadedVenue (std::unique_ptr<PerformerFactory> performerFactory);
 
+//==============================================================================
+/**
+    A fixed pool of render threads which any number of threaded venues can share.
+
+    A server hosting dozens of independent sessions, each with a dedicated
+    render thread, ends up oversubscribed: more runnable threads than cores
+    means the OS scheduler decides which session renders next, and tail latency
+    collapses under load. A shared pool replaces those competing threads with
+    cooperative scheduling - every attached session renders one block at a
+    time, and an idle worker always picks the ready session whose next block
+    deadline is earliest, so the session closest to glitching is the one that
+    gets the core.
+
+    Create one pool per machine, typically with one thread per physical core,
+    and pass it to createThreadedVenue() for each venue that should share it.
+    Sessions attached to a pool are paced by the pool at their linked block
+    rate, so their endpoint service callbacks must not block waiting for data.
+    The per-session thread placement options in Session::RenderThreadOptions
+    apply to dedicated render threads and are ignored in pooled mode.
+*/
+class RenderThreadPool
+{
+public:
+    virtual ~RenderThreadPool() {}
+
+    /** Creates a pool with a fixed number of render threads. */
+    static std::shared_ptr<RenderThreadPool> create (uint32_t numThreads);
+};
+
+/// Creates a threaded venue whose sessions are rendered cooperatively by a shared
+/// RenderThreadPool instead of each owning a dedicated render thread.
+std::unique_ptr<Venue> createThreadedVenue (std::unique_ptr<PerformerFactory> performerFactory,
+                                            std::shared_ptr<RenderThreadPool> pool);
+
+/** Creates a venue whose sessions render their linked programs in a sandboxed child
+    process, so a misbehaving program can't harm the host.
+
+    The venue behaves exactly like the threaded venue - the same endpoint service
+    callbacks, snapshots and offline rendering - but each session's performer forks
+    after linking, and the per-block endpoint data travels between the processes
+    over lock-free shared-memory rings, adding a single in-memory round trip of
+    latency per block. If the child process crashes or hangs, the session reports
+    an error and the host carries on. Returns nullptr on platforms without the
+    necessary process and shared-memory support.
+*/
+std::unique_ptr<Venue> createSandboxedProcessVenue (std::unique_ptr<PerformerFactory> performerFactory);
+
 
 } // namespace soul
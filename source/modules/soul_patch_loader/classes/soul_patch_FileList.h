@@ -36,6 +36,184 @@ struct FileState
     bool operator< (const FileState& other) const       { return path < other.path; }
 };
 
+//==============================================================================
+/** A process-wide cache of parsed, validated manifest objects, keyed by the
+    manifest's content hash.
+
+    During development a patch's manifest gets re-read constantly - every
+    instance change-check, and every rescan after a save - and each miss used
+    to mean a full JSON parse into a fresh value tree. Since identical content
+    always parses to an identical value, the parse result can be shared by
+    hash: a touched-but-unchanged manifest, or the same manifest opened by
+    several instances, now costs a read and a hash instead of a parse. Only
+    successful parses are stored, so validation errors still surface every
+    time, and the cache is capped by dropping its oldest entries.
+*/
+struct ManifestParseCache
+{
+    template <typename ParseFn>
+    static choc::value::Value getOrParse (const std::string& contentHash, ParseFn&& parse)
+    {
+        auto& cache = getInstance();
+        std::lock_guard<std::mutex> l (cache.lock);
+
+        for (auto& entry : cache.entries)
+            if (entry.contentHash == contentHash)
+                return entry.parsedManifest;
+
+        auto parsed = parse();
+
+        if (cache.entries.size() >= maxEntries)
+            cache.entries.erase (cache.entries.begin());
+
+        cache.entries.push_back ({ contentHash, parsed });
+        return parsed;
+    }
+
+private:
+    static constexpr size_t maxEntries = 16;
+
+    struct Entry
+    {
+        std::string contentHash;
+        choc::value::Value parsedManifest;
+    };
+
+    std::mutex lock;
+    std::vector<Entry> entries;
+
+    static ManifestParseCache& getInstance()
+    {
+        static ManifestParseCache cache;
+        return cache;
+    }
+};
+
+//==============================================================================
+/** Reads the content of a group of files by issuing every read up-front and
+    waiting for them all to finish.
+
+    Each file gets a single readAsync() call covering its whole length, so a
+    VirtualFile implementation backed by slow or remote storage can have all
+    the requests in flight at once, making the batch cost one round-trip of
+    latency instead of one per file. Files whose size isn't known up-front,
+    or whose async read comes back short, fall back to the ordinary streaming
+    loader - with the default synchronous readAsync() the whole thing simply
+    degenerates to reading the files one after another.
+*/
+struct ScatterFileReader
+{
+    struct Result
+    {
+        std::string content, error;
+    };
+
+    static std::vector<Result> readFiles (const std::vector<VirtualFile::Ptr>& files)
+    {
+        struct SharedState
+        {
+            std::mutex lock;
+            std::condition_variable finished;
+            size_t remaining = 0;
+        };
+
+        struct PendingRead final  : public RefCountHelper<VirtualFileReadCallback, PendingRead>
+        {
+            SharedState* state = nullptr;
+            int64_t bytesRead = -1;
+
+            void readComplete (int64_t numBytes) override
+            {
+                std::lock_guard<std::mutex> l (state->lock);
+                bytesRead = numBytes;
+
+                if (--state->remaining == 0)
+                    state->finished.notify_all();
+            }
+        };
+
+        std::vector<Result> results (files.size());
+        std::vector<size_t> pendingIndices;
+
+        // All the target buffers must be sized before anything is issued, as
+        // nothing may move while a read is outstanding
+        for (size_t i = 0; i < files.size(); ++i)
+            if (files[i] != nullptr && files[i]->getSize() > 0)
+                results[i].content.resize ((size_t) files[i]->getSize());
+
+        for (size_t i = 0; i < files.size(); ++i)
+            if (! results[i].content.empty())
+                pendingIndices.push_back (i);
+
+        SharedState state;
+        state.remaining = pendingIndices.size();
+
+        std::vector<RefCountingPtr<PendingRead>> pendingReads;
+        pendingReads.reserve (pendingIndices.size());
+
+        for (size_t j = 0; j < pendingIndices.size(); ++j)
+        {
+            pendingReads.push_back (RefCountingPtr<PendingRead> (new PendingRead()));
+            pendingReads.back()->state = &state;
+        }
+
+        for (size_t j = 0; j < pendingIndices.size(); ++j)
+        {
+            auto i = pendingIndices[j];
+            files[i]->readAsync (0, std::addressof (results[i].content[0]),
+                                 (uint64_t) results[i].content.size(), *pendingReads[j]);
+        }
+
+        if (! pendingIndices.empty())
+        {
+            std::unique_lock<std::mutex> l (state.lock);
+            state.finished.wait (l, [&] { return state.remaining == 0; });
+        }
+
+        for (size_t j = 0; j < pendingIndices.size(); ++j)
+        {
+            auto i = pendingIndices[j];
+
+            if (pendingReads[j]->bytesRead != (int64_t) results[i].content.size())
+                results[i] = readSynchronously (files[i]);
+        }
+
+        for (size_t i = 0; i < files.size(); ++i)
+            if (files[i] == nullptr || files[i]->getSize() < 0)
+                results[i] = readSynchronously (files[i]);
+
+        return results;
+    }
+
+    /** Like readFiles(), but also insists that each file is valid UTF8, to
+        match the behaviour of loadVirtualFileAsString().
+    */
+    static std::vector<Result> readFilesAsStrings (const std::vector<VirtualFile::Ptr>& files)
+    {
+        auto results = readFiles (files);
+
+        for (auto& r : results)
+            if (r.error.empty()
+                 && choc::text::findInvalidUTF8Data (r.content.data(), r.content.size()) != nullptr)
+                r = { {}, "Invalid UTF8 data" };
+
+        return results;
+    }
+
+private:
+    static Result readSynchronously (const VirtualFile::Ptr& file)
+    {
+        Result r;
+
+        if (file != nullptr)
+            r.content = loadVirtualFileAsMemoryBlock (*file, r.error);
+        else
+            r.error = "Failed to read from file";
+
+        return r;
+    }
+};
+
 //==============================================================================
 /** Manages a list of the known files in a patch, and provides methods for
     checking them for changes.
@@ -47,17 +225,38 @@ struct FileList
     FileState manifest;
     std::vector<FileState> sourceFiles, filesToWatch;
     choc::value::Value manifestJSON;
+    std::string manifestContentHash;
+    bool externalChangeFlagged = false;
 
     void reset()
     {
         manifest = {};
         manifestJSON = choc::value::Value();
+        manifestContentHash.clear();
         sourceFiles.clear();
         filesToWatch.clear();
     }
 
     void refresh()
     {
+        if (manifest.file != nullptr && ! manifestJSON.isVoid() && ! externalChangeFlagged)
+        {
+            // If the manifest's modification time hasn't moved since it was parsed,
+            // nothing that was derived from it can have changed, so a rescan is just
+            // a re-stat of the files it mentions rather than a re-read of everything.
+            if (! manifest.hasFileBeenModified())
+                return refreshModificationTimes();
+
+            // If it has been touched but its content hash is unchanged (editors and
+            // build tools love doing this), the parsed state is also still valid.
+            std::string error;
+            auto content = loadVirtualFileAsString (*manifest.file, error);
+
+            if (error.empty() && getContentHash (content) == manifestContentHash)
+                return refreshModificationTimes();
+        }
+
+        externalChangeFlagged = false;
         reset();
         findManifestFile();
         parseManifest();
@@ -65,6 +264,33 @@ struct FileList
         findViewFiles();
     }
 
+    /** Hosts which run a native file-watcher over the patch's folder can call this
+        when it fires: the next refresh will then do a full rescan instead of
+        trusting the cached modification times and manifest hash.
+    */
+    void notifyExternalChange()
+    {
+        externalChangeFlagged = true;
+    }
+
+    void refreshModificationTimes()
+    {
+        manifest.lastModificationTime = manifest.getLastModificationTime();
+
+        for (auto& f : sourceFiles)
+            f.lastModificationTime = f.getLastModificationTime();
+
+        for (auto& f : filesToWatch)
+            f.lastModificationTime = f.getLastModificationTime();
+    }
+
+    static std::string getContentHash (const std::string& content)
+    {
+        HashBuilder hash;
+        hash << content;
+        return hash.toString();
+    }
+
     VirtualFile::Ptr checkAndCreateVirtualFile (const std::string& relativePath) const
     {
         if (relativePath.empty())
@@ -96,12 +322,36 @@ struct FileList
     void parseManifest()
     {
         std::string error;
-        manifestJSON = parseManifestFile (*manifest.file, error);
+        auto content = loadVirtualFileAsString (*manifest.file, error);
 
         if (! error.empty())
             throwPatchLoadError (error);
 
-        checkExternalsList();
+        try
+        {
+            manifestContentHash = getContentHash (content);
+
+            manifestJSON = ManifestParseCache::getOrParse (manifestContentHash, [&]
+            {
+                auto topLevelObject = choc::json::parse (content);
+                auto contentObject = getManifestContentObject (topLevelObject);
+
+                if (! contentObject.isObject())
+                    throwPatchLoadError ("Expected an object called '" + std::string (getManifestTopLevelPropertyName()) + "'");
+
+                auto result = choc::value::Value (contentObject);
+
+                // validate before the result can enter the cache, so a bad manifest
+                // fails afresh on every attempt rather than being remembered
+                checkExternalsList (result);
+                return result;
+            });
+        }
+        catch (choc::json::ParseError e)
+        {
+            throwPatchLoadError (String::Ptr (manifest.file->getAbsolutePath()).toString<std::string>()
+                                  + ":" + std::to_string (e.line) + ":" + std::to_string (e.column) + ": error: " + e.message);
+        }
     }
 
     std::vector<FileState> getFileListProperty (const std::string& propertyName)
@@ -161,9 +411,9 @@ struct FileList
         return manifestJSON["externals"];
     }
 
-    void checkExternalsList()
+    static void checkExternalsList (const choc::value::ValueView& manifestObject)
     {
-        auto externals = getExternalsList();
+        auto externals = manifestObject["externals"];
 
         if (externals.isVoid())
             return;
@@ -188,6 +438,9 @@ struct FileList
 
     bool hasChanged() const
     {
+        if (externalChangeFlagged)
+            return true;
+
         FileList newList;
         newList.root = root;
         newList.manifestName = manifestName;
@@ -77,26 +77,135 @@ struct PatchInstanceImpl final  : public RefCountHelper<PatchInstance, PatchInst
         return fileList.getMostRecentModificationTime();
     }
 
+    void notifyExternalFileChange() override
+    {
+        std::lock_guard<std::mutex> lock (compileLock);
+        fileList.notifyExternalChange();
+    }
+
     PatchPlayer* compileNewPlayer (const PatchPlayerConfiguration& config,
                                        CompilerCache* cache,
                                        SourceFilePreprocessor* preprocessor,
                                        ExternalDataProvider* externalDataProvider,
                                        ConsoleMessageHandler* consoleHandler) override
     {
+        auto patch = buildNewPlayer (config, cache, preprocessor, externalDataProvider, consoleHandler, nullptr);
+        return patch.incrementAndGetPointer();
+    }
+
+    void compileNewPlayerAsync (const PatchPlayerConfiguration& config,
+                                CompilerCache* cache,
+                                SourceFilePreprocessor* preprocessor,
+                                ExternalDataProvider* externalDataProvider,
+                                ConsoleMessageHandler* consoleHandler,
+                                CompilationProgressListener* progressListener,
+                                PatchPlayerReadyCallback& callback) override
+    {
+        getCompileThreadPool().addJob ([this,
+                                        self = retain (static_cast<PatchInstance*> (this)),
+                                        config,
+                                        cache = retain (cache),
+                                        preprocessor = retain (preprocessor),
+                                        externalDataProvider = retain (externalDataProvider),
+                                        consoleHandler = retain (consoleHandler),
+                                        progressListener = retain (progressListener),
+                                        callback = retain (std::addressof (callback))]
+        {
+            BuildStageMonitor monitor;
+
+            if (progressListener != nullptr)
+            {
+                monitor.stageChanged = [&] (const char* stageName)  { progressListener->compilationStageChanged (stageName); };
+                monitor.shouldCancel = [&]                          { return progressListener->isCancelled(); };
+            }
+
+            auto player = buildNewPlayer (config, cache.get(), preprocessor.get(), externalDataProvider.get(),
+                                          consoleHandler.get(), progressListener != nullptr ? std::addressof (monitor) : nullptr);
+
+            callback->playerReady (player.incrementAndGetPointer());
+        });
+    }
+
+    PatchPlayer::Ptr buildNewPlayer (const PatchPlayerConfiguration& config,
+                                     CompilerCache* cache,
+                                     SourceFilePreprocessor* preprocessor,
+                                     ExternalDataProvider* externalDataProvider,
+                                     ConsoleMessageHandler* consoleHandler,
+                                     const BuildStageMonitor* monitor)
+    {
+        // Serialises builds of this instance, so that the cached program and the
+        // prototype performer can't race when several builds are in flight
+        std::lock_guard<std::mutex> lock (compileLock);
         PatchPlayer::Ptr patch;
 
         try
         {
             refreshFileList();
 
-            auto patchImpl = new PatchPlayerImpl (fileList, config, performerFactory->createPerformer());
+            auto modificationTime = fileList.getMostRecentModificationTime();
+
+            if (compiledProgram.isEmpty() || ! (config == compiledConfig) || modificationTime != compiledModificationTime)
+            {
+                compiledProgram = {};
+                loadedPerformerPrototype = {};
+                clearPerformerPool();
+            }
+
+            PatchPlayerImpl* patchImpl = nullptr;
+
+            // A pooled performer is already linked for this exact program and config,
+            // so reusing it turns a start/stop cycle into a state reset
+            if (auto pooledPerformer = takePooledPerformer())
+            {
+                patchImpl = new PatchPlayerImpl (fileList, config, std::move (pooledPerformer),
+                                                 PatchPlayerImpl::PerformerState::pooledAndLinked);
+            }
+            else
+            {
+                auto clonedPerformer = loadedPerformerPrototype != nullptr ? loadedPerformerPrototype->cloneLoadedProgram()
+                                                                           : nullptr;
+
+                patchImpl = clonedPerformer != nullptr ? new PatchPlayerImpl (fileList, config, std::move (clonedPerformer),
+                                                                              PatchPlayerImpl::PerformerState::programPreloaded)
+                                                       : new PatchPlayerImpl (fileList, config, performerFactory->createPerformer());
+            }
+
             patch = PatchPlayer::Ptr (patchImpl);
 
             soul::BuildSettings settings;
             settings.sampleRate = config.sampleRate;
             settings.maxBlockSize = config.maxFramesPerBlock;
 
-            patchImpl->compile (settings, cache, preprocessor, externalDataProvider, consoleHandler);
+            patchImpl->compile (settings, cache, preprocessor, externalDataProvider, consoleHandler, compiledProgram, monitor);
+
+            if (PatchPlayerImpl::buildWasCancelled (monitor))
+                return {};
+
+            if (patchImpl->isPlayable() && ! patchImpl->compiledProgram.isEmpty())
+            {
+                // Keep hold of the compiled program (and a performer that can clone its
+                // loaded image, if the engine supports that), so that further instances
+                // of the same patch can skip the compile and share the immutable program.
+                compiledProgram = patchImpl->compiledProgram;
+                compiledConfig = config;
+                compiledModificationTime = modificationTime;
+
+                if (loadedPerformerPrototype == nullptr)
+                    loadedPerformerPrototype = patchImpl->performer->cloneLoadedProgram();
+
+                // When this player is destroyed, its linked performer comes back here
+                // so the next play session can skip the whole build. The generation
+                // check quietly drops returns that arrive after a rebuild.
+                patchImpl->returnPerformerToPool = [self = retain (static_cast<PatchInstance*> (this)), this,
+                                                    generation = currentPoolGeneration()]
+                                                   (std::unique_ptr<soul::Performer> released)
+                {
+                    std::lock_guard<std::mutex> poolGuard (poolLock);
+
+                    if (generation == poolGeneration)
+                        performerPool.push_back (std::move (released));
+                };
+            }
         }
         catch (const PatchLoadError& e)
         {
@@ -112,13 +221,89 @@ struct PatchInstanceImpl final  : public RefCountHelper<PatchInstance, PatchInst
             patchImpl->updateCompileMessageStatus();
         }
 
-        return patch.incrementAndGetPointer();
+        return patch;
+    }
+
+    //==============================================================================
+    /** Removes and returns a warm performer from the session pool, or nullptr if
+        the pool is empty.
+    */
+    std::unique_ptr<soul::Performer> takePooledPerformer()
+    {
+        std::lock_guard<std::mutex> poolGuard (poolLock);
+
+        if (performerPool.empty())
+            return {};
+
+        auto pooled = std::move (performerPool.back());
+        performerPool.pop_back();
+        return pooled;
+    }
+
+    /** Discards all pooled performers - called whenever the program, config or
+        source files change, since a pooled performer is only valid for the exact
+        build it was linked against.
+    */
+    void clearPerformerPool()
+    {
+        std::lock_guard<std::mutex> poolGuard (poolLock);
+        ++poolGeneration;
+
+        for (auto& pooled : performerPool)
+        {
+            pooled->unload();
+            pooled.release();
+        }
+
+        performerPool.clear();
+    }
+
+    uint64_t currentPoolGeneration()
+    {
+        std::lock_guard<std::mutex> poolGuard (poolLock);
+        return poolGeneration;
+    }
+
+    //==============================================================================
+    /** Takes out a new reference on one of the COM-style objects, so that it can
+        be safely captured by a background compile job.
+    */
+    template <typename ObjectType>
+    static RefCountingPtr<ObjectType> retain (ObjectType* object)
+    {
+        if (object != nullptr)
+            object->addRef();
+
+        return RefCountingPtr<ObjectType> (object);
+    }
+
+    /** All PatchInstances share one pool of compile threads, so that a host which
+        loads many patches at once gets overlapping builds without spawning a
+        thread per patch.
+    */
+    static ThreadPool& getCompileThreadPool()
+    {
+        static ThreadPool pool (ThreadPool::getRecommendedNumberOfThreads (16));
+        return pool;
     }
 
     std::unique_ptr<soul::PerformerFactory> performerFactory;
     const VirtualFile::Ptr root;
     FileList fileList;
     Description::Ptr description;
+
+    soul::Program compiledProgram;
+    std::unique_ptr<soul::Performer> loadedPerformerPrototype;
+    PatchPlayerConfiguration compiledConfig;
+    int64_t compiledModificationTime = 0;
+    std::mutex compileLock;
+
+    // The session pool: linked performers handed back by destroyed players,
+    // ready to be re-issued after a fast state reset. Guarded by its own lock
+    // because players can be destroyed while a build holds compileLock.
+    std::vector<std::unique_ptr<soul::Performer>> performerPool;
+    uint64_t poolGeneration = 0;
+    std::mutex poolLock;
 };
 
 } // namespace soul::patch
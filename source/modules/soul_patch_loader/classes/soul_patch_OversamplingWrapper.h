@@ -0,0 +1,152 @@
+/*
+    _____ _____ _____ __
+   |   __|     |  |  |  |      The SOUL language
+   |__   |  |  |  |  |  |__    Copyright (c) 2019 - ROLI Ltd.
+   |_____|_____|_____|_____|
+
+   The code in this file is provided under the terms of the ISC license:
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose
+   with or without fee is hereby granted, provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+namespace soul::patch
+{
+    /** Generates a wrapper graph which runs a patch's main processor oversampled.
+
+        Hand-writing an oversampling graph around a nonlinear patch is a common and
+        easy-to-get-wrong chore, so this centralises it: the wrapper mirrors the main
+        processor's endpoints, instantiates it with a clock multiplier so the whole
+        inner graph is linked at the higher rate, and lets the runtime's sinc-based
+        polyphase rate converters do the up/down sampling at the boundary. Streams
+        which look like parameters are latched across the boundary instead of being
+        sinc-interpolated, and event endpoints pass straight through.
+    */
+    struct OversamplingWrapper
+    {
+        static constexpr const char* wrapperName = "OversampledWrapper";
+
+        static std::string build (const soul::Program& program, uint32_t factor)
+        {
+            OversamplingWrapper wrapper (program);
+            return wrapper.buildWrapper (factor);
+        }
+
+    private:
+        OversamplingWrapper (const soul::Program& p) : program (p) {}
+
+        std::string buildWrapper (uint32_t factor)
+        {
+            auto& mainProcessor = program.getMainProcessor();
+
+            for (auto& input : mainProcessor.inputs)
+            {
+                if (input->isConsoleEndpoint())
+                    continue;
+
+                auto& name = input->name.toString();
+
+                endpoints << "input " << getEndpointTypeName (input->endpointType) << " "
+                          << getTypesString (input) << " " << name << getArraySuffix (input)
+                          << input->annotation.toHEART() << ";" << newLine;
+
+                connections << getInterpolationModifier (input)
+                            << name << " -> wrappedModule." << name << ";" << newLine;
+            }
+
+            for (auto& output : mainProcessor.outputs)
+            {
+                if (output->isConsoleEndpoint())
+                    continue;
+
+                auto& name = output->name.toString();
+
+                endpoints << "output " << getEndpointTypeName (output->endpointType) << " "
+                          << getTypesString (output) << " " << name << getArraySuffix (output)
+                          << output->annotation.toHEART() << ";" << newLine;
+
+                connections << "wrappedModule." << name << " -> " << name << ";" << newLine;
+            }
+
+            choc::text::CodePrinter graph;
+
+            graph << "graph " << wrapperName << " [[ main ]]" << newLine;
+
+            {
+                auto indent1 = graph.createIndentWithBraces();
+
+                graph << endpoints.toString()
+                      << blankLine
+                      << "let wrappedModule = " << Program::stripRootNamespaceFromQualifiedPath (mainProcessor.fullName)
+                      << " * " << std::to_string (factor) << ";" << newLine
+                      << blankLine
+                      << "connection" << newLine;
+
+                {
+                    auto indent2 = graph.createIndentWithBraces();
+                    graph << connections.toString();
+                }
+
+                graph << newLine;
+            }
+
+            graph << newLine;
+
+            return graph.toString();
+        }
+
+        std::string getTypesString (const soul::heart::IODeclaration& io)
+        {
+            auto types = joinStrings (io.dataTypes, ", ", [this] (const Type& type) -> std::string
+            {
+                if (type.isStruct())
+                    return program.getStructNameWithQualificationIfNeeded (program.getMainProcessor(), *type.getStruct());
+
+                return type.getDescription();
+            });
+
+            if (io.dataTypes.size() > 1)
+                return "(" + types + ")";
+
+            return types;
+        }
+
+        static std::string getArraySuffix (const soul::heart::IODeclaration& io)
+        {
+            if (io.arraySize.has_value())
+                return "[" + std::to_string (*io.arraySize) + "]";
+
+            return {};
+        }
+
+        /** Streams which carry parameter-style annotations are latched across the rate
+            boundary, since sinc-interpolating a control signal up to the oversampled
+            rate is pure waste - audio streams keep the default sinc interpolation.
+        */
+        static std::string getInterpolationModifier (const soul::heart::InputDeclaration& input)
+        {
+            if (input.isStreamEndpoint()
+                 && (input.annotation.hasValue ("name")
+                      || input.annotation.hasValue ("min")
+                      || input.annotation.hasValue ("max")))
+                return "[latch] ";
+
+            return {};
+        }
+
+        const soul::Program& program;
+
+        choc::text::CodePrinter endpoints, connections;
+
+        static constexpr choc::text::CodePrinter::NewLine newLine = {};
+        static constexpr choc::text::CodePrinter::BlankLine blankLine = {};
+    };
+}
@@ -26,15 +26,35 @@ namespace soul::patch
 */
 struct PatchPlayerImpl final  : public RefCountHelper<PatchPlayer, PatchPlayerImpl>
 {
-    PatchPlayerImpl (FileList f, PatchPlayerConfiguration c, std::unique_ptr<soul::Performer> p)
-        : fileList (std::move (f)), config (c), performer (std::move (p)), wrapper (*performer)
+    /** Describes how much work the performer handed to the constructor has already done. */
+    enum class PerformerState
+    {
+        freshlyCreated,     /**< Needs a full compile, load and link. */
+        programPreloaded,   /**< A clone which shares another instance's loaded program, but still needs linking. */
+        pooledAndLinked     /**< A fully linked performer from the session pool, just needing a state reset. */
+    };
+
+    PatchPlayerImpl (FileList f, PatchPlayerConfiguration c, std::unique_ptr<soul::Performer> p,
+                     PerformerState stateOfPerformer = PerformerState::freshlyCreated)
+        : fileList (std::move (f)), config (c), performer (std::move (p)), wrapper (*performer),
+          performerState (stateOfPerformer)
     {
     }
 
     ~PatchPlayerImpl()
     {
+        disconnectParametersFromChangeQueue();
+
         if (performer != nullptr)
         {
+            // A playable performer can go back into its instance's session pool,
+            // keeping it linked and warm for the next play session
+            if (returnPerformerToPool != nullptr && ! anyErrors)
+            {
+                returnPerformerToPool (std::move (performer));
+                return;
+            }
+
             performer->unload();
             performer.release();
         }
@@ -58,6 +78,9 @@ struct PatchPlayerImpl final  : public RefCountHelper<PatchPlayer, PatchPlayerIm
     //==============================================================================
     void addSource (BuildBundle& build, SourceFilePreprocessor* preprocessor)
     {
+        std::vector<VirtualFile::Ptr> sources;
+        sources.reserve (fileList.sourceFiles.size());
+
         for (auto& fileState : fileList.sourceFiles)
         {
             VirtualFile::Ptr source;
@@ -68,33 +91,40 @@ struct PatchPlayerImpl final  : public RefCountHelper<PatchPlayer, PatchPlayerIm
             if (source == nullptr)
                 source = fileState.file;
 
-            std::string readError;
-            auto content = loadVirtualFileAsString (*source, readError);
+            sources.push_back (source);
+        }
+
+        // The reads all go out as one concurrent batch, so a patch with many
+        // source files on high-latency storage isn't opened one file at a time
+        auto loaded = ScatterFileReader::readFilesAsStrings (sources);
 
-            if (! readError.empty())
-                throwPatchLoadError (readError);
+        for (size_t i = 0; i < loaded.size(); ++i)
+        {
+            if (! loaded[i].error.empty())
+                throwPatchLoadError (loaded[i].error);
 
-            build.sourceFiles.push_back ({ fileState.path, std::move (content) });
+            build.sourceFiles.push_back ({ fileList.sourceFiles[i].path, std::move (loaded[i].content) });
         }
     }
 
     soul::Program compileSources (soul::CompileMessageList& messageList,
                                   const BuildSettings& settings,
-                                  SourceFilePreprocessor* preprocessor)
+                                  CompilerCache* cache,
+                                  SourceFilePreprocessor* preprocessor,
+                                  const BuildStageMonitor* buildMonitor)
     {
+        auto profile = TargetProfile::fromManifest (fileList.manifestJSON);
+
         BuildBundle build;
         addSource (build, preprocessor);
         build.settings = settings;
-        auto program = Compiler::build (messageList, build);
+        profile.applyToBuildSettings (build.settings);
 
-       #if JUCE_BELA
-        {
-            auto wrappedBuild = build;
-            wrappedBuild.sourceFiles.push_back ({ "BelaWrapper", soul::patch::BelaWrapper::build (program) });
-            wrappedBuild.settings.mainProcessor = "BelaWrapper";
-            program = Compiler::build (messageList, wrappedBuild);
-        }
-       #endif
+        auto cacheConverter = CacheConverter::create (cache);
+        auto program = Compiler::buildWithCache (messageList, build, cacheConverter.get(), buildMonitor);
+
+        if (profile.isAnyTransformationEnabled())
+            program = profile.transform (messageList, build, std::move (program));
 
         return program;
     }
@@ -104,23 +134,51 @@ struct PatchPlayerImpl final  : public RefCountHelper<PatchPlayer, PatchPlayerIm
                   CompilerCache* cache,
                   SourceFilePreprocessor* preprocessor,
                   ExternalDataProvider* externalDataProvider,
-                  ConsoleMessageHandler* consoleHandler)
+                  ConsoleMessageHandler* consoleHandler,
+                  soul::Program precompiledProgram = {},
+                  const BuildStageMonitor* buildMonitor = nullptr)
     {
         if (performer == nullptr)
             return messageList.addError ("Failed to initialise JIT engine", {});
 
-        auto program = compileSources (messageList, settings, preprocessor);
-
-        if (program.isEmpty())
+        if (performerState == PerformerState::pooledAndLinked)
         {
-            if (! messageList.hasErrors())
-                messageList.addError ("Empty program", {});
-
+            // The performer is back from the session pool already linked, with its
+            // externals resolved - it just needs its state returned to the freshly
+            // linked image and the per-player wrapper plumbing rebuilt.
+            compiledProgram = precompiledProgram;
+            performer->resetToInitialState();
+
+            createBuses();
+            createRenderOperations (consoleHandler);
+            latency = performer->getLatency();
             return;
         }
 
-        if (! performer->load (messageList, program))
-            return messageList.addError ("Failed to load program", {});
+        if (performerState == PerformerState::programPreloaded)
+        {
+            // The performer is a clone which already shares another instance's
+            // loaded program, so there's nothing to compile or load.
+            compiledProgram = precompiledProgram;
+        }
+        else
+        {
+            auto program = precompiledProgram.isEmpty() ? compileSources (messageList, settings, cache, preprocessor, buildMonitor)
+                                                        : precompiledProgram;
+
+            if (program.isEmpty())
+            {
+                if (! messageList.hasErrors() && ! buildWasCancelled (buildMonitor))
+                    messageList.addError ("Empty program", {});
+
+                return;
+            }
+
+            if (! performer->load (messageList, program))
+                return messageList.addError ("Failed to load program", {});
+
+            compiledProgram = program;
+        }
 
         createBuses();
         createRenderOperations (consoleHandler);
@@ -137,10 +195,17 @@ struct PatchPlayerImpl final  : public RefCountHelper<PatchPlayer, PatchPlayerIm
                   CompilerCache* cache,
                   SourceFilePreprocessor* preprocessor,
                   ExternalDataProvider* externalDataProvider,
-                  ConsoleMessageHandler* consoleHandler)
+                  ConsoleMessageHandler* consoleHandler,
+                  soul::Program precompiledProgram = {},
+                  const BuildStageMonitor* buildMonitor = nullptr)
     {
         soul::CompileMessageList messageList;
-        compile (messageList, settings, cache, preprocessor, externalDataProvider, consoleHandler);
+
+        if (fileList.manifestJSON["logBuildTimes"].getWithDefault<bool> (false))
+            messageList.timingReport = std::make_shared<BuildTimingReport>();
+
+        compile (messageList, settings, cache, preprocessor, externalDataProvider, consoleHandler,
+                 std::move (precompiledProgram), buildMonitor);
 
         compileMessages.reserve (messageList.messages.size());
 
@@ -155,7 +220,7 @@ struct PatchPlayerImpl final  : public RefCountHelper<PatchPlayer, PatchPlayerIm
                 cm.fullMessage = makeString (m.getFullDescription() + "\n" + sourceLine);
 
             cm.filename = makeString (m.location.getFilename());
-            cm.description = makeString (m.description);
+            cm.description = makeString (m.getDescription());
             auto lc = m.location.getLineAndColumn();
             cm.line = lc.line;
             cm.column = lc.column;
@@ -164,9 +229,29 @@ struct PatchPlayerImpl final  : public RefCountHelper<PatchPlayer, PatchPlayerIm
             compileMessages.push_back (cm);
         }
 
+        if (messageList.timingReport != nullptr && ! messageList.timingReport->isEmpty())
+        {
+            auto report = "Build time breakdown:\n" + messageList.timingReport->toString();
+            SOUL_LOG ("build times", [&] { return report; });
+
+            // The report rides along as a non-error compile message, so that hosts can
+            // show it (and bug reports can include it) without any new API surface.
+            CompilationMessage cm;
+            cm.fullMessage = makeString (report);
+            cm.description = cm.fullMessage;
+            cm.filename = makeString (std::string());
+            cm.isError = false;
+            compileMessages.push_back (cm);
+        }
+
         updateCompileMessageStatus();
     }
 
+    static bool buildWasCancelled (const BuildStageMonitor* buildMonitor)
+    {
+        return buildMonitor != nullptr && buildMonitor->shouldCancel != nullptr && buildMonitor->shouldCancel();
+    }
+
     void updateCompileMessageStatus()
     {
         compileMessagesSpan = makeSpan (compileMessages);
@@ -178,8 +263,24 @@ struct PatchPlayerImpl final  : public RefCountHelper<PatchPlayer, PatchPlayerIm
 
     void resolveExternalVariables (ExternalDataProvider* externalDataProvider)
     {
+        retainedExternalData.clear();
+
         for (auto& ev : performer->getExternalVariables())
         {
+            // The common case for sample data is a plain audio file reference, which
+            // can be handed to the performer as a view of the process-wide cached
+            // copy, without first cloning it per instance.
+            if (auto shared = resolveExternalAudioFile (externalDataProvider, ev))
+            {
+                if (! shared->isVoid())
+                {
+                    retainedExternalData.push_back (shared);
+                    performer->setExternalVariable (ev.name.c_str(), shared->getView());
+                }
+
+                continue;
+            }
+
             auto value = resolveExternalVariable (externalDataProvider, ev);
 
             if (! value.isVoid())
@@ -187,6 +288,38 @@ struct PatchPlayerImpl final  : public RefCountHelper<PatchPlayer, PatchPlayerIm
         }
     }
 
+    /** Resolves an external which refers directly to a single audio file, returning
+        the shared decoded data, or nullptr for anything needing the general path.
+    */
+    AudioDataCache::DecodedAudio resolveExternalAudioFile (ExternalDataProvider* externalDataProvider, const ExternalVariable& ev)
+    {
+        if (externalDataProvider != nullptr)
+            if (auto file = externalDataProvider->getExternalFile (ev.name.c_str()))
+                return AudioFileToValue::loadShared (VirtualFile::Ptr (file), ev.annotation);
+
+        auto externals = fileList.getExternalsList();
+
+        if (externals.isObject() && externals.hasObjectMember (ev.name))
+        {
+            const auto& entry = externals[ev.name];
+
+            if (entry.isString())
+            {
+                try
+                {
+                    if (auto file = fileList.checkAndCreateVirtualFile (std::string (entry.getString())))
+                        return AudioFileToValue::loadShared (std::move (file), ev.annotation);
+                }
+                catch (const PatchLoadError& error)
+                {
+                    throwPatchLoadError ("Error resolving external " + quoteName (ev.name) + ": " + error.message);
+                }
+            }
+        }
+
+        return {};
+    }
+
     inline choc::value::Value replaceStringsWithFileContent (const choc::value::ValueView& value,
                                                              const std::function<choc::value::Value(std::string_view)>& convertStringToValue)
     {
@@ -276,6 +409,7 @@ struct PatchPlayerImpl final  : public RefCountHelper<PatchPlayer, PatchPlayerIm
 
     void createRenderOperations (ConsoleMessageHandler* consoleHandler)
     {
+        disconnectParametersFromChangeQueue();
         parameters.clear();
         checkSampleRateAndBlockSize();
 
@@ -297,14 +431,33 @@ struct PatchPlayerImpl final  : public RefCountHelper<PatchPlayer, PatchPlayerIm
                                         [&] (const EndpointDetails& endpoint) -> std::function<const float*()>
                                         {
                                             auto param = new ParameterImpl (endpoint);
+                                            param->changeIndex = (uint32_t) parameters.size();
                                             parameters.push_back (Parameter::Ptr (param));
                                             return [param] { return param->getValueIfChanged(); };
                                         },
-                                        [] (const EndpointDetails& endpoint) -> uint32_t
+                                        [] (const EndpointDetails& endpoint) -> AudioMIDIWrapper::RampProperties
                                         {
-                                            return checkRampLength (endpoint.annotation.getValue ("rampFrames"));
+                                            AudioMIDIWrapper::RampProperties ramp;
+                                            ramp.rampFrames = checkRampLength (endpoint.annotation.getValue ("rampFrames"));
+                                            ramp.isExponential = (endpoint.annotation.getString ("rampShape") == "exponential");
+                                            return ramp;
                                         },
-                                        std::move (handleUnusedEvents));
+                                        std::move (handleUnusedEvents),
+                                        [this] (const std::function<void(uint32_t)>& applyChangedParameter)
+                                        {
+                                            parameterChangeQueue.drain (applyChangedParameter);
+                                        });
+
+        // The parameters were all constructed with their changed flags set, so each
+        // one gets its matching queue entry to make the initial values go out
+        parameterChangeQueue.initialise ((uint32_t) parameters.size());
+
+        for (auto& p : parameters)
+        {
+            auto& param = static_cast<ParameterImpl&> (*p);
+            param.changeQueue = std::addressof (parameterChangeQueue);
+            parameterChangeQueue.push (param.changeIndex);
+        }
 
         parameterSpan = makeSpan (parameters);
     }
@@ -315,7 +468,13 @@ struct PatchPlayerImpl final  : public RefCountHelper<PatchPlayer, PatchPlayerIm
         performer->reset();
 
         for (auto& p : parameters)
-            static_cast<ParameterImpl&>(*p).changed = true;
+            static_cast<ParameterImpl&>(*p).markChanged();
+    }
+
+    void disconnectParametersFromChangeQueue()
+    {
+        for (auto& p : parameters)
+            static_cast<ParameterImpl&>(*p).changeQueue = nullptr;
     }
 
     RenderResult render (RenderContext& rc) override
@@ -331,17 +490,84 @@ struct PatchPlayerImpl final  : public RefCountHelper<PatchPlayer, PatchPlayerIm
         // the public patch API headers, so this just checks that the layout is actually the same.
         static_assert (sizeof (MIDIEvent) == sizeof (soul::patch::MIDIMessage));
 
+        // the public API declares its own copy of the timeline event struct, so
+        // check the layouts haven't drifted apart before casting between them
+        static_assert (sizeof (soul::TimelineEvent) == sizeof (soul::patch::TimelineEvent));
+        static_assert (offsetof (soul::TimelineEvent, lastBarStartQuarterNote) == offsetof (soul::patch::TimelineEvent, lastBarStartQuarterNote));
+
         wrapper.render (choc::buffer::createChannelArrayView (rc.inputChannels, rc.numInputChannels, rc.numFrames),
                         choc::buffer::createChannelArrayView (rc.outputChannels, rc.numOutputChannels, rc.numFrames),
                         reinterpret_cast<const MIDIEvent*> (rc.incomingMIDI),
                         reinterpret_cast<MIDIEvent*> (rc.outgoingMIDI),
                         rc.numMIDIMessagesIn,
                         rc.maximumMIDIMessagesOut,
-                        rc.numMIDIMessagesOut);
+                        rc.numMIDIMessagesOut,
+                        reinterpret_cast<const soul::TimelineEvent*> (rc.incomingTimelineEvents),
+                        rc.numTimelineEvents);
 
         return RenderResult::ok;
     }
 
+    //==============================================================================
+    /** A wait-free dirty-set of parameter indices, written by whichever threads
+        call Parameter::setValue() and drained by the render thread.
+
+        The per-parameter 'changed' flag deduplicates entries - an index is only
+        pushed on the flag's false-to-true transition, and the flag only goes
+        false again when the render thread applies the change - so at most one
+        entry per parameter is ever outstanding and the ring can never overflow.
+        This lets a patch with hundreds of parameters drain just the ones that
+        moved, instead of polling every parameter on every block.
+    */
+    struct ParameterChangeQueue
+    {
+        void initialise (uint32_t numParameters)
+        {
+            size_t capacity = 4;
+
+            while (capacity < numParameters * 2u + 2u)
+                capacity *= 2;
+
+            slots = std::vector<std::atomic<uint32_t>> (capacity);
+            capacityMask = (uint32_t) capacity - 1;
+            writeCount.store (0);
+            readCount = 0;
+
+            for (auto& s : slots)
+                s.store (0);
+        }
+
+        void push (uint32_t parameterIndex) noexcept
+        {
+            auto pos = writeCount.fetch_add (1, std::memory_order_relaxed);
+            slots[pos & capacityMask].store (parameterIndex + 1, std::memory_order_release);
+        }
+
+        template <typename ApplyFn>
+        void drain (ApplyFn&& apply) noexcept
+        {
+            auto written = writeCount.load (std::memory_order_acquire);
+
+            while (readCount != written)
+            {
+                auto entry = slots[readCount & capacityMask].exchange (0, std::memory_order_acquire);
+
+                // A writer has claimed this slot but hasn't filled it in yet - leave
+                // it and anything after it to be picked up on the next drain
+                if (entry == 0)
+                    break;
+
+                ++readCount;
+                apply (entry - 1);
+            }
+        }
+
+        std::vector<std::atomic<uint32_t>> slots;
+        std::atomic<uint64_t> writeCount { 0 };
+        uint64_t readCount = 0;            // owned by the render thread
+        uint32_t capacityMask = 0;
+    };
+
     //==============================================================================
     struct ParameterImpl final  : public RefCountHelper<Parameter, ParameterImpl>
     {
@@ -380,10 +606,17 @@ struct PatchPlayerImpl final  : public RefCountHelper<PatchPlayer, PatchPlayerIm
             if (value != newValue)
             {
                 value = newValue;
-                changed = true;
+                markChanged();
             }
         }
 
+        void markChanged()
+        {
+            if (! changed.exchange (true))
+                if (auto queue = changeQueue.load (std::memory_order_relaxed))
+                    queue->push (changeIndex);
+        }
+
         const float* getValueIfChanged()
         {
             if (! changed)
@@ -413,6 +646,10 @@ struct PatchPlayerImpl final  : public RefCountHelper<PatchPlayer, PatchPlayerIm
 
         float value = 0;
         std::atomic<bool> changed { true };
+        // Held as an atomic because a host can keep a Parameter::Ptr alive after
+        // the player that owns the queue has been destroyed
+        std::atomic<ParameterChangeQueue*> changeQueue { nullptr };
+        uint32_t changeIndex = 0;
         Annotation annotation;
         std::vector<std::string> propertyNameStrings;
         std::vector<const char*> propertyNameRawStrings;
@@ -452,6 +689,7 @@ struct PatchPlayerImpl final  : public RefCountHelper<PatchPlayer, PatchPlayerIm
 
     std::vector<Bus> inputBuses, outputBuses;
     std::vector<Parameter::Ptr> parameters;
+    ParameterChangeQueue parameterChangeQueue;
 
     Span<Bus> inputBusesSpan = {}, outputBusesSpan = {};
     Span<Parameter::Ptr> parameterSpan = {};
@@ -459,7 +697,18 @@ struct PatchPlayerImpl final  : public RefCountHelper<PatchPlayer, PatchPlayerIm
 
     PatchPlayerConfiguration config;
     std::unique_ptr<soul::Performer> performer;
+
+    // Keeps this instance's share of any cached decoded audio alive, which also
+    // keeps the AudioDataCache entries warm for the next instance of the patch.
+    std::vector<AudioDataCache::DecodedAudio> retainedExternalData;
     AudioMIDIWrapper wrapper;
+    soul::Program compiledProgram;
+    PerformerState performerState = PerformerState::freshlyCreated;
+
+    /** When set, the destructor hands the (still linked) performer to this
+        instead of unloading it, so the owning instance can pool it.
+    */
+    std::function<void(std::unique_ptr<soul::Performer>)> returnPerformerToPool;
 
     static constexpr int64_t maxRampLength = 0x7fffffff;
 };
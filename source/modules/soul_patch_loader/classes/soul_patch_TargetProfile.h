@@ -0,0 +1,171 @@
+/*
+    _____ _____ _____ __
+   |   __|     |  |  |  |      The SOUL language
+   |__   |  |  |  |  |  |__    Copyright (c) 2019 - ROLI Ltd.
+   |_____|_____|_____|_____|
+
+   The code in this file is provided under the terms of the ISC license:
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose
+   with or without fee is hereby granted, provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+namespace soul::patch
+{
+
+//==============================================================================
+/** Describes a set of target-specific transformations that are applied to a
+    patch after it has been compiled, so that embedded deployments get their
+    platform tweaks without the patch source being hand-edited.
+
+    A profile is declared in the manifest's "targetProfile" property, either as
+    the name of a built-in profile (currently just "bela"), or as an object:
+
+    @code
+    "targetProfile": {
+        "name":                       "myBoard",
+        "maxBlockSize":               16,
+        "narrowFloat64Maths":         true,
+        "tableLookupTranscendentals": 1024,
+        "stateStructureOfArrays":     true,
+        "oversampling":               4,
+        "wrapForBela":                false
+    }
+    @endcode
+
+    "tableLookupTranscendentals" may also just be a boolean, which uses a
+    default table size.
+*/
+struct TargetProfile
+{
+    std::string name;
+    uint32_t maxBlockSize = 0;               /**< If non-zero, caps the block size the program is specialised for. */
+    uint32_t transcendentalTableSize = 0;    /**< If non-zero, float32 sin/cos become interpolated table lookups of this size. */
+    bool narrowFloat64Maths = false;         /**< If true, float64 transcendental intrinsics are narrowed to float32. */
+    bool stateStructureOfArrays = false;     /**< If true, arrays-of-structs in processor state are transposed to structs-of-arrays. */
+    uint32_t oversampling = 0;               /**< If 2 or greater, the main processor is wrapped to run oversampled by this factor. */
+    bool wrapForBela = false;                /**< If true, the program is wrapped in the Bela I/O graph. */
+
+    static constexpr uint32_t defaultTableSize = 2048;
+
+    bool isAnyTransformationEnabled() const
+    {
+        return maxBlockSize != 0 || transcendentalTableSize != 0 || narrowFloat64Maths
+                || stateStructureOfArrays || oversampling > 1 || wrapForBela;
+    }
+
+    static TargetProfile getBuiltInProfile (std::string_view profileName)
+    {
+        TargetProfile p;
+        p.name = std::string (profileName);
+
+        if (profileName == "bela")
+        {
+            p.wrapForBela = true;
+            p.narrowFloat64Maths = true;
+        }
+
+        return p;
+    }
+
+    static TargetProfile fromManifest (const choc::value::ValueView& manifestJSON)
+    {
+        auto value = manifestJSON["targetProfile"];
+        TargetProfile p;
+
+        if (value.isString())
+        {
+            p = getBuiltInProfile (value.getString());
+        }
+        else if (value.isObject())
+        {
+            p.name               = value["name"].getWithDefault<std::string> ({});
+            p.maxBlockSize       = value["maxBlockSize"].getWithDefault<uint32_t> (0);
+            p.narrowFloat64Maths      = value["narrowFloat64Maths"].getWithDefault<bool> (false);
+            p.stateStructureOfArrays  = value["stateStructureOfArrays"].getWithDefault<bool> (false);
+            p.oversampling            = value["oversampling"].getWithDefault<uint32_t> (0);
+            p.wrapForBela             = value["wrapForBela"].getWithDefault<bool> (false);
+
+            auto tables = value["tableLookupTranscendentals"];
+
+            if (tables.isBool())
+                p.transcendentalTableSize = tables.get<bool>() ? defaultTableSize : 0;
+            else
+                p.transcendentalTableSize = tables.getWithDefault<uint32_t> (0);
+        }
+
+       #if JUCE_BELA
+        p.wrapForBela = true;
+       #endif
+
+        return p;
+    }
+
+    void applyToBuildSettings (BuildSettings& settings) const
+    {
+        if (maxBlockSize != 0)
+            settings.maxBlockSize = settings.maxBlockSize != 0 ? std::min (settings.maxBlockSize, maxBlockSize)
+                                                               : maxBlockSize;
+    }
+
+    /** Applies the profile's post-compile transformations, returning the new
+        program (which will be empty if a re-build failed).
+    */
+    soul::Program transform (soul::CompileMessageList& messageList,
+                             const BuildBundle& originalBuild,
+                             soul::Program program) const
+    {
+        if (program.isEmpty())
+            return program;
+
+        auto wrappedBuild = originalBuild;
+
+        if (oversampling > 1)
+        {
+            if (oversampling > 512 || ! choc::math::isPowerOf2 (oversampling))
+            {
+                messageList.addError ("The oversampling factor must be a power of 2, between 2 and 512", {});
+                return {};
+            }
+
+            wrappedBuild.sourceFiles.push_back ({ OversamplingWrapper::wrapperName,
+                                                  OversamplingWrapper::build (program, oversampling) });
+            wrappedBuild.settings.mainProcessor = OversamplingWrapper::wrapperName;
+            program = Compiler::build (messageList, wrappedBuild);
+
+            if (program.isEmpty())
+                return program;
+        }
+
+        if (wrapForBela)
+        {
+            wrappedBuild.sourceFiles.push_back ({ "BelaWrapper", BelaWrapper::build (program) });
+            wrappedBuild.settings.mainProcessor = "BelaWrapper";
+            program = Compiler::build (messageList, wrappedBuild);
+
+            if (program.isEmpty())
+                return program;
+        }
+
+        if (narrowFloat64Maths)
+            Optimisations::narrowFloat64Intrinsics (program);
+
+        if (stateStructureOfArrays)
+            Optimisations::convertStateArraysToStructureOfArrays (program);
+
+        if (transcendentalTableSize != 0)
+            Optimisations::replaceTranscendentalsWithTableLookups (program, transcendentalTableSize);
+
+        return program;
+    }
+};
+
+} // namespace soul::patch
@@ -53,6 +53,73 @@ struct PatchLoadError
     throwPatchLoadError (file + ": error: " + message);
 }
 
+//==============================================================================
+/** A process-wide cache of decoded, format-converted audio file data.
+
+    Twenty instances of the same sampler patch all load the same multisamples, and
+    without this each of them decodes, resamples and converts the files again,
+    costing both load time and a duplicate copy of the data in memory. Entries are
+    keyed by a hash of the file's content plus the annotation settings that affect
+    decoding, and handed out as refcounted read-only values, so every instance
+    resolving the same file shares one decoded copy.
+*/
+struct AudioDataCache
+{
+    using DecodedAudio = std::shared_ptr<const choc::value::Value>;
+
+    static AudioDataCache& get()
+    {
+        static AudioDataCache cache;
+        return cache;
+    }
+
+    DecodedAudio getOrDecode (const std::string& contentHashKey,
+                              const std::function<choc::value::Value()>& decode)
+    {
+        {
+            std::lock_guard<std::mutex> l (lock);
+
+            auto found = entries.find (contentHashKey);
+
+            if (found != entries.end())
+                if (auto existing = found->second.lock())
+                    return existing;
+        }
+
+        // Decoding happens outside the lock, so that one instance chewing through a
+        // big file can't serialise every other instance's load behind it. If two
+        // instances race on the same file they both decode it, and the loser's
+        // copy just gets dropped.
+        auto decoded = std::make_shared<const choc::value::Value> (decode());
+
+        std::lock_guard<std::mutex> l (lock);
+        purgeExpiredEntries();
+
+        auto& entry = entries[contentHashKey];
+
+        if (auto existing = entry.lock())
+            return existing;
+
+        entry = decoded;
+        return decoded;
+    }
+
+private:
+    AudioDataCache() = default;
+
+    // The cache itself only holds weak references: an entry lives exactly as long
+    // as some patch instance still holds the decoded data, so a process whose
+    // patches have all been unloaded isn't left sitting on the sample data.
+    std::mutex lock;
+    std::unordered_map<std::string, std::weak_ptr<const choc::value::Value>> entries;
+
+    void purgeExpiredEntries()
+    {
+        for (auto i = entries.begin(); i != entries.end();)
+            i = i->second.expired() ? entries.erase (i) : std::next (i);
+    }
+};
+
 //==============================================================================
 /** Attempts to read some sort of audio file and convert it into a suitable Value
     contains the content.
@@ -63,20 +130,66 @@ struct PatchLoadError
 struct AudioFileToValue
 {
     static choc::value::Value load (VirtualFile::Ptr file, const choc::value::ValueView& annotation)
+    {
+        return choc::value::Value (loadShared (std::move (file), annotation)->getView());
+    }
+
+    /** Returns a refcounted read-only copy of the decoded file, shared through the
+        AudioDataCache with every other instance loading the same content with the
+        same decode settings.
+    */
+    static AudioDataCache::DecodedAudio loadShared (VirtualFile::Ptr file, const choc::value::ValueView& annotation)
     {
         SOUL_ASSERT (file != nullptr);
         std::string fileName (file->getAbsolutePath()->getCharPointer());
+        auto fileSize = file->getSize();
 
-        if (auto reader = createAudioFileReader (file))
-            return loadAudioFileAsValue (*reader, fileName, annotation);
+        if (fileSize > 0 && fileSize < (int64_t) maxCacheableFileSize)
+        {
+            std::vector<char> content ((size_t) fileSize);
 
-        throwPatchLoadError ("Failed to read file " + quoteName (fileName));
-        return {};
+            if (file->read (0, content.data(), (uint64_t) fileSize) == fileSize)
+            {
+                // The content gets hashed rather than the path, so renamed copies of
+                // the same sample still share an entry, and an edited file doesn't
+                // serve stale data. A decode on a miss reads from the bytes already
+                // in hand, so the file is only pulled off the disk once either way.
+                HashBuilder hash;
+                hash << ArrayView<char> (content);
+                hash << std::to_string (annotation["resample"].getWithDefault<double> (0));
+                hash << annotation["sourceChannel"].getWithDefault<int64_t> (-1);
+
+                return AudioDataCache::get().getOrDecode (hash.toString(), [&]
+                {
+                    return decode (std::make_unique<juce::MemoryInputStream> (content.data(), content.size(), false),
+                                   fileName, annotation);
+                });
+            }
+        }
+
+        // Files which won't report a size or read cleanly can't be content-hashed,
+        // so they fall back to an uncached streaming decode.
+        return std::make_shared<const choc::value::Value> (decode (std::make_unique<VirtualFileInputStream> (std::move (file)),
+                                                                   fileName, annotation));
     }
 
 private:
     static constexpr unsigned int maxNumChannels = 8;
     static constexpr uint64_t maxNumFrames = 48000 * 60;
+    static constexpr uint64_t maxCacheableFileSize = 256 * 1024 * 1024;
+
+    static choc::value::Value decode (std::unique_ptr<juce::InputStream> stream,
+                                      const std::string& fileName, const choc::value::ValueView& annotation)
+    {
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+
+        if (auto reader = std::unique_ptr<juce::AudioFormatReader> (formats.createReaderFor (std::move (stream))))
+            return loadAudioFileAsValue (*reader, fileName, annotation);
+
+        throwPatchLoadError ("Failed to read file " + quoteName (fileName));
+        return {};
+    }
 
     static choc::value::Value loadAudioFileAsValue (juce::AudioFormatReader& reader, const std::string& fileName, const choc::value::ValueView& annotation)
     {
@@ -160,19 +273,6 @@ private:
             throwPatchLoadError ("The value of the 'sourceChannel' annotation was out of range");
         }
     }
-
-    static std::unique_ptr<juce::AudioFormatReader> createAudioFileReader (VirtualFile::Ptr file)
-    {
-        SOUL_ASSERT (file != nullptr);
-
-        juce::AudioFormatManager formats;
-        formats.registerBasicFormats();
-
-        if (auto* reader = formats.createReaderFor (std::make_unique<VirtualFileInputStream> (file)))
-            return std::unique_ptr<juce::AudioFormatReader> (reader);
-
-        return {};
-    }
 };
 
 //==============================================================================
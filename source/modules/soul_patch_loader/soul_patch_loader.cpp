@@ -26,6 +26,8 @@
 #include "classes/soul_patch_helpers.h"
 #include "classes/soul_patch_FileList.h"
 #include "classes/soul_patch_BelaTransformation.h"
+#include "classes/soul_patch_OversamplingWrapper.h"
+#include "classes/soul_patch_TargetProfile.h"
 #include "classes/soul_patch_PlayerImpl.h"
 #include "classes/soul_patch_InstanceImpl.h"
 #include "classes/soul_patch_DefaultFile.h"
@@ -34,9 +34,11 @@ struct AudioMIDISystem  : private juce::AudioIODeviceCallback,
         if (requirements.blockSize < 1 || requirements.blockSize > 2048)
             requirements.blockSize = 0;
 
-        constexpr uint32_t midiFIFOSize = 1024;
-        inputMIDIBuffer.reserve (midiFIFOSize);
-        midiFIFO.reset (midiFIFOSize);
+        inputMIDIBuffer.reserve (midiFIFOSize * maxMIDIDevices);
+
+        for (auto& slot : midiDeviceSlots)
+            slot.fifo.reset (midiFIFOSize);
+
         openAudioDevice();
         startTimerHz (3);
     }
@@ -114,7 +116,26 @@ private:
         choc::midi::ShortMessage message;
     };
 
-    choc::fifo::SingleReaderSingleWriterFIFO<IncomingMIDIEvent> midiFIFO;
+    /** Each MIDI device gets its own capture ring, so every FIFO has exactly one
+        writer (that device's callback thread) and one reader (the audio callback),
+        which is the contract the lock-free FIFO needs. The slots themselves are
+        never reallocated - a device rescan just reassigns the owner pointers - so
+        the audio callback can walk them without any locking or lifetime worries.
+    */
+    struct MIDIDeviceSlot
+    {
+        std::atomic<juce::MidiInput*> owner { nullptr };
+        choc::fifo::SingleReaderSingleWriterFIFO<IncomingMIDIEvent> fifo;
+
+        // The head of this slot's event stream during the merge - audio thread only
+        IncomingMIDIEvent nextEvent;
+        bool hasNextEvent = false;
+    };
+
+    static constexpr uint32_t maxMIDIDevices = 16;
+    static constexpr uint32_t midiFIFOSize = 1024;
+
+    MIDIDeviceSlot midiDeviceSlots[maxMIDIDevices];
     std::vector<MIDIEvent> inputMIDIBuffer;
     MIDIClock::time_point lastMIDIBlockTime;
 
@@ -138,7 +159,9 @@ private:
 
         lastCallbackCount = 0;
         audioCallbackCount = 0;
-        midiFIFO.reset();
+
+        // The capture rings aren't flushed here - resetting them would race with
+        // the device threads, and anything stale is dropped by the merge's age check
 
         loadMeasurer.reset();
 
@@ -193,7 +216,7 @@ private:
        #endif
     }
 
-    void handleIncomingMidiMessage (juce::MidiInput*, const juce::MidiMessage& message) override
+    void handleIncomingMidiMessage (juce::MidiInput* source, const juce::MidiMessage& message) override
     {
         if (message.getRawDataSize() < 4)  // long messages are ignored for now...
         {
@@ -201,13 +224,24 @@ private:
             auto m = choc::midi::ShortMessage (bytes[0], bytes[1], bytes[2]);
 
            #if JUCE_BELA
+            ignoreUnused (source);
             inputMIDIBuffer.push_back ({ 0, m });
            #else
-            midiFIFO.push ({ MIDIClock::now(), m });
+            for (auto& slot : midiDeviceSlots)
+            {
+                if (slot.owner.load (std::memory_order_acquire) == source)
+                {
+                    slot.fifo.push ({ MIDIClock::now(), m });
+                    break;
+                }
+            }
            #endif
         }
     }
 
+    /** Merges the per-device capture rings into inputMIDIBuffer, ordered by
+        timestamp, and converts each timestamp to a frame offset within the block.
+    */
     void fillMIDIInputBuffer (uint32_t numFrames)
     {
         inputMIDIBuffer.clear();
@@ -216,28 +250,43 @@ private:
         auto startOfFrame = lastMIDIBlockTime;
         lastMIDIBlockTime = now;
 
-        if (midiFIFO.getUsedSlots() != 0)
+        auto frameLength = TimeSeconds (1.0 / sampleRate);
+
+        for (;;)
         {
-            auto frameLength = TimeSeconds (1.0 / sampleRate);
-            IncomingMIDIEvent e;
+            // k-way merge: each slot holds the head of its stream, and the
+            // earliest of those heads is the next event overall
+            MIDIDeviceSlot* earliest = nullptr;
 
-            while (midiFIFO.pop (e))
+            for (auto& slot : midiDeviceSlots)
             {
-                TimeSeconds timeSinceBufferStart = e.time - startOfFrame;
-                auto frame = static_cast<int> (timeSinceBufferStart.count() / frameLength.count());
+                if (! slot.hasNextEvent)
+                    slot.hasNextEvent = slot.fifo.pop (slot.nextEvent);
 
-                if (frame < 0)
-                {
-                    if (frame < -40000)
-                        break;
+                if (slot.hasNextEvent && (earliest == nullptr || slot.nextEvent.time < earliest->nextEvent.time))
+                    earliest = std::addressof (slot);
+            }
 
-                    frame = 0;
-                }
+            if (earliest == nullptr)
+                break;
+
+            auto e = earliest->nextEvent;
+            earliest->hasNextEvent = false;
+
+            TimeSeconds timeSinceBufferStart = e.time - startOfFrame;
+            auto frame = static_cast<int> (timeSinceBufferStart.count() / frameLength.count());
+
+            if (frame < 0)
+            {
+                if (frame < -40000)
+                    continue;  // ancient events (e.g. captured while the device was stopped) get dropped
 
-                auto frameIndex = static_cast<uint32_t> (frame) < numFrames ? static_cast<uint32_t> (frame)
-                                                                            : static_cast<uint32_t> (numFrames - 1);
-                inputMIDIBuffer.push_back ({ frameIndex, e.message });
+                frame = 0;
             }
+
+            auto frameIndex = static_cast<uint32_t> (frame) < numFrames ? static_cast<uint32_t> (frame)
+                                                                        : static_cast<uint32_t> (numFrames - 1);
+            inputMIDIBuffer.push_back ({ frameIndex, e.message });
         }
     }
 
@@ -357,6 +406,11 @@ private:
         {
             lastMidiDevices = devices;
 
+            // Unhook the capture slots before closing the devices, so that by the
+            // time a slot is reassigned its old device can no longer be pushing
+            for (auto& slot : midiDeviceSlots)
+                slot.owner.store (nullptr, std::memory_order_release);
+
             for (auto& mi : midiInputs)
             {
                 log (("Closing MIDI device: " + mi->getName()).toStdString());
@@ -369,8 +423,17 @@ private:
                 if (auto mi = juce::MidiInput::openDevice (i, this))
                     midiInputs.emplace_back (std::move (mi));
 
+            size_t slotIndex = 0;
+
             for (auto& mi : midiInputs)
             {
+                if (slotIndex >= maxMIDIDevices)
+                {
+                    log (("Too many MIDI devices - ignoring: " + mi->getName()).toStdString());
+                    continue;
+                }
+
+                midiDeviceSlots[slotIndex++].owner.store (mi.get(), std::memory_order_release);
                 log (("Opening MIDI device: " + mi->getName()).toStdString());
                 mi->start();
             }
@@ -21,6 +21,80 @@
 namespace soul::audioplayer
 {
 
+//==============================================================================
+/** A linear-interpolating rate converter used while a session's device is
+    running at a different sample rate from the one its program was linked at.
+
+    Unlike the windowed-sinc resampler in soul_Resampler.h, which tabulates a
+    filter kernel on every call, this keeps just one sample of history per
+    channel and a fractional read position, so process() is allocation-free
+    and cheap enough to sit in the render callback. The quality trade-off is
+    deliberate: this is a bridging measure which keeps a session audible and
+    its state intact across a device change, until the host gets around to
+    re-linking at the new rate.
+*/
+struct DeviceRateConverter
+{
+    void prepare (choc::buffer::ChannelCount numChannels, double sourceRate, double destRate)
+    {
+        history.assign (numChannels, 0);
+        increment = sourceRate / destRate;
+        position = 0;
+    }
+
+    void reset()
+    {
+        std::fill (history.begin(), history.end(), 0.0f);
+        position = 0;
+    }
+
+    /** Returns the number of destination frames that a block of source frames
+        will produce, given the current fractional read position. */
+    uint32_t getNumDestFramesFor (uint32_t numSourceFrames) const
+    {
+        auto count = std::ceil ((static_cast<double> (numSourceFrames) - position) / increment);
+        return count > 0 ? static_cast<uint32_t> (count) : 0;
+    }
+
+    template <typename SourceView>
+    void process (choc::buffer::ChannelArrayView<float> dest, const SourceView& source)
+    {
+        auto numDestFrames = dest.getNumFrames();
+        auto numSourceFrames = source.getNumFrames();
+        SOUL_ASSERT (dest.getNumChannels() == source.getNumChannels());
+
+        if (numDestFrames == 0 || numSourceFrames == 0)
+            return;
+
+        for (choc::buffer::ChannelCount channel = 0; channel < dest.getNumChannels(); ++channel)
+        {
+            auto pos = position;
+
+            for (choc::buffer::FrameCount i = 0; i < numDestFrames; ++i)
+            {
+                auto index = static_cast<int64_t> (std::floor (pos));
+                auto frac = static_cast<float> (pos - static_cast<double> (index));
+                auto nextIndex = std::min (index + 1, static_cast<int64_t> (numSourceFrames) - 1);
+
+                auto s0 = index < 0 ? history[channel] : source.getSample (channel, static_cast<choc::buffer::FrameCount> (index));
+                auto s1 = nextIndex < 0 ? history[channel] : source.getSample (channel, static_cast<choc::buffer::FrameCount> (nextIndex));
+
+                dest.getSample (channel, i) = s0 + frac * (s1 - s0);
+                pos += increment;
+            }
+
+            history[channel] = source.getSample (channel, numSourceFrames - 1);
+        }
+
+        // the fractional remainder is carried over, so the read position stays
+        // continuous from one device block to the next
+        position += numDestFrames * increment - numSourceFrames;
+    }
+
+    std::vector<float> history;
+    double increment = 1.0, position = 0;
+};
+
 //==============================================================================
 class AudioPlayerVenue   : public soul::Venue,
                            private AudioMIDISystem::Callback
@@ -131,6 +205,10 @@ public:
         bool link (CompileMessageList& messageList, const BuildSettings& settings) override
         {
             maxBlockSize = settings.maxBlockSize;
+            linkedSampleRate = settings.sampleRate;
+            configuredDeviceRate = 0;
+            configuredDeviceBlockSize = 0;
+            rateConversionActive = false;
             buildOperationList();
 
             if (state == SessionState::loaded && performer->link (messageList, settings, {}))
@@ -179,6 +257,7 @@ public:
             inputCallbacks.clear();
             outputCallbacks.clear();
             connections.clear();
+            rateConversionActive = false;
             setState (SessionState::empty);
         }
 
@@ -250,6 +329,59 @@ public:
 
         void deviceStopped()
         {
+            inputRateConverter.reset();
+            outputRateConverter.reset();
+        }
+
+        /** Called (always with the venue's session lock held, so never
+            concurrently with processBlock) when the audio device starts up or
+            comes back with a different sample rate or buffer size.
+
+            The linked program and its state are kept rather than the session
+            being torn down: a buffer-size increase is first offered to the
+            performer through its block-size renegotiation hook, falling back
+            to the existing sub-block chunking if it's refused, and a
+            sample-rate mismatch switches rendering onto a rate-converted path
+            which carries on running the program at its linked rate. The only
+            audible gap is the device restart itself.
+
+            This runs from the device's about-to-start notification, not the
+            render callback, so the buffer allocations here are safe.
+        */
+        void deviceParametersChanged (double deviceRate, uint32_t deviceBlockSize)
+        {
+            if (deviceRate == configuredDeviceRate && deviceBlockSize == configuredDeviceBlockSize)
+                return;
+
+            configuredDeviceRate = deviceRate;
+            configuredDeviceBlockSize = deviceBlockSize;
+
+            if (! performer->isLinked())
+                return;
+
+            if (deviceBlockSize > maxBlockSize && performer->setBlockSize (deviceBlockSize))
+            {
+                // the performer accepted the bigger block, so the scratch buffers
+                // in the operation list have to grow to match it
+                maxBlockSize = deviceBlockSize;
+                buildOperationList();
+            }
+
+            rateConversionActive = linkedSampleRate > 0 && deviceRate > 0
+                                     && std::abs (deviceRate - linkedSampleRate) > 0.001;
+
+            if (rateConversionActive)
+            {
+                deviceToProgramRatio = linkedSampleRate / deviceRate;
+                auto maxProgramFrames = static_cast<uint32_t> (std::ceil (deviceBlockSize * deviceToProgramRatio)) + 2u;
+
+                programRateInput  = choc::buffer::ChannelArrayBuffer<float> (static_cast<choc::buffer::ChannelCount> (venue.audioSystem.getNumInputChannels()),  maxProgramFrames);
+                programRateOutput = choc::buffer::ChannelArrayBuffer<float> (static_cast<choc::buffer::ChannelCount> (venue.audioSystem.getNumOutputChannels()), maxProgramFrames);
+                scaledMIDIEvents.resize (1024);
+
+                inputRateConverter.prepare (programRateInput.getNumChannels(), deviceRate, linkedSampleRate);
+                outputRateConverter.prepare (programRateOutput.getNumChannels(), linkedSampleRate, deviceRate);
+            }
         }
 
         bool connectInputEndpoint (const EndpointInfo& externalEndpoint, EndpointID inputID)
@@ -370,9 +502,20 @@ public:
         void processBlock (AudioMIDIWrapper::RenderContext context)
         {
             SOUL_ASSERT (maxBlockSize > 0);
-            auto maxFramesPerBlock = std::min (512u, maxBlockSize);
             context.totalFramesRendered = totalFramesRendered;
 
+            if (rateConversionActive)
+                renderRateConverted (context);
+            else
+                renderAtProgramRate (context);
+
+            totalFramesRendered += context.outputChannels.getNumFrames();
+        }
+
+        void renderAtProgramRate (RenderContext& context)
+        {
+            auto maxFramesPerBlock = std::min (512u, maxBlockSize);
+
             context.iterateInBlocks (maxFramesPerBlock, [&] (RenderContext& rc)
             {
                 performer->prepare (rc.inputChannels.getNumFrames());
@@ -391,8 +534,55 @@ public:
                 for (auto& c : outputCallbacks)
                     c.callback (*this, c.endpointHandle);
             });
+        }
 
-            totalFramesRendered += context.outputChannels.getNumFrames();
+        /** Renders a device-rate block by converting the inputs to the linked
+            rate, running the program there, and converting the outputs back.
+            MIDI timestamps are mapped onto the program-rate timeline so event
+            timing survives the conversion.
+        */
+        void renderRateConverted (RenderContext& context)
+        {
+            auto numDeviceFrames = context.outputChannels.getNumFrames();
+
+            if (numDeviceFrames == 0)
+                return;
+
+            auto numProgramFrames = std::min (inputRateConverter.getNumDestFramesFor (numDeviceFrames),
+                                              programRateInput.getNumFrames());
+
+            if (numProgramFrames == 0)
+                return;
+
+            auto programInput  = programRateInput.getView().getFrameRange ({ 0, numProgramFrames });
+            auto programOutput = programRateOutput.getView().getFrameRange ({ 0, numProgramFrames });
+
+            inputRateConverter.process (programInput, context.inputChannels);
+
+            auto numMIDIEvents = std::min (context.midiInCount, static_cast<uint32_t> (scaledMIDIEvents.size()));
+
+            for (uint32_t i = 0; i < numMIDIEvents; ++i)
+            {
+                auto e = context.midiIn[i];
+                e.frameIndex = std::min (static_cast<uint32_t> (e.frameIndex * deviceToProgramRatio),
+                                         numProgramFrames - 1);
+                scaledMIDIEvents[i] = e;
+            }
+
+            auto programContext = context;
+            programContext.inputChannels = programInput;
+            programContext.outputChannels = programOutput;
+            programContext.midiIn = scaledMIDIEvents.data();
+            programContext.midiInCount = numMIDIEvents;
+            programContext.frameOffset = 0;
+
+            // the device path gets pre-cleared buffers from the audio system, so
+            // unconnected channels in the scratch buffer have to match that
+            programOutput.clear();
+
+            renderAtProgramRate (programContext);
+
+            outputRateConverter.process (context.outputChannels, programOutput);
         }
 
         AudioPlayerVenue& venue;
@@ -401,6 +591,16 @@ public:
         std::atomic<uint64_t> totalFramesRendered { 0 };
         StateChangeCallbackFn stateChangeCallback;
 
+        double linkedSampleRate = 0;
+        double configuredDeviceRate = 0;
+        uint32_t configuredDeviceBlockSize = 0;
+
+        bool rateConversionActive = false;
+        double deviceToProgramRatio = 1.0;
+        DeviceRateConverter inputRateConverter, outputRateConverter;
+        choc::buffer::ChannelArrayBuffer<float> programRateInput, programRateOutput;
+        std::vector<MIDIEvent> scaledMIDIEvents;
+
         struct EndpointCallback
         {
             EndpointHandle endpointHandle;
@@ -432,6 +632,12 @@ public:
             activeSessions.push_back (s);
 
         audioSystem.setCallback (this);
+
+        // if the device is already up, the session gets its parameters straight
+        // away instead of waiting for the next device restart
+        if (currentDeviceSampleRate > 0)
+            s->deviceParametersChanged (currentDeviceSampleRate, currentDeviceBlockSize);
+
         return true;
     }
 
@@ -457,6 +663,9 @@ private:
     std::recursive_mutex activeSessionLock;
     std::vector<AudioPlayerSession*> activeSessions;
 
+    double currentDeviceSampleRate = 0;
+    uint32_t currentDeviceBlockSize = 0;
+
     //==============================================================================
     void createDeviceEndpoints (int numInputChannels, int numOutputChannels)
     {
@@ -512,8 +721,32 @@ private:
         return result;
     }
 
-    void renderStarting (double, uint32_t) override {}
-    void renderStopped() override {}
+    /** A device restart with new parameters reaches every active session here,
+        so a rate or buffer-size change reconfigures the sessions in place -
+        their programs, state and connections all survive, and playback resumes
+        on the first block from the restarted device.
+    */
+    void renderStarting (double newSampleRate, uint32_t newBlockSize) override
+    {
+        std::lock_guard<decltype(activeSessionLock)> lock (activeSessionLock);
+
+        currentDeviceSampleRate = newSampleRate;
+        currentDeviceBlockSize = newBlockSize;
+
+        for (auto& s : activeSessions)
+            s->deviceParametersChanged (newSampleRate, newBlockSize);
+    }
+
+    void renderStopped() override
+    {
+        std::lock_guard<decltype(activeSessionLock)> lock (activeSessionLock);
+
+        currentDeviceSampleRate = 0;
+        currentDeviceBlockSize = 0;
+
+        for (auto& s : activeSessions)
+            s->deviceStopped();
+    }
 
     void render (choc::buffer::ChannelArrayView<const float> input,
                  choc::buffer::ChannelArrayView<float> output,